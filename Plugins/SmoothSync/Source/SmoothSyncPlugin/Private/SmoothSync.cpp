@@ -19,6 +19,15 @@ void USmoothSync::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
+	if (transformUpdatedHandle.IsValid())
+	{
+		if (USceneComponent* sceneComponent = getSceneComponentToSync())
+		{
+			sceneComponent->TransformUpdated.Remove(transformUpdatedHandle);
+		}
+		transformUpdatedHandle.Reset();
+	}
+
 	// Check if we have a stateBuffer variable we need to cleanup.
 	if (stateBuffer != NULL)
 	{
@@ -67,6 +76,8 @@ void USmoothSync::BeginPlay()
 		useExtrapolationTimeLimit = false;
 	}
 
+	stateCodec.setConfiguration(SmoothStateCodec::getConfiguration(this));
+
 	// We need to do this in order to send unreliable RPCs?
 	SetIsReplicated(true);
 }
@@ -92,24 +103,14 @@ void USmoothSync::setSceneComponentToSync(USceneComponent *componentToSync)
 template <class T>
 void USmoothSync::copyToBuffer(T thing)
 {
-	uint8* thingAsChars = (uint8*)&thing;
-	for (int i = 0; i < sizeof(T); i++)
-	{
-		sendingCharArray.Add(thingAsChars[i]);
-	}
-
+	sendingCharArray.Append((uint8*)&thing, sizeof(T));
 	sendingCharArraySize += sizeof(T);
 }
 
 template <class T>
 void USmoothSync::readFromBuffer(T* thing)
 {
-	uint8* thingAsChars = (uint8*)thing;
-	for (int i = 0; i < sizeof(T); i++)
-	{
-		thingAsChars[i] = readingCharArray[readingCharArraySize + i];
-	}
-
+	FMemory::Memcpy(thing, readingCharArray.GetData() + readingCharArraySize, sizeof(T));
 	readingCharArraySize += sizeof(T);
 }
 
@@ -401,52 +402,25 @@ void USmoothSync::ServerSendsTransformToEveryone_Implementation(const TArray<uin
 	if (!realObjectToSync)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("Could not find target for network state message."));
+		delete stateToAdd;
 		return;
 	}
 
 	if (receivedStatesCounter < sendRate) receivedStatesCounter++;
 
-	// Read position.
-	if (deserializePosition)
+	// Sync settings can be changed at runtime, this only rebuilds the codec if they were.
+	stateCodec.setConfiguration(SmoothStateCodec::getConfiguration(this));
+	uint8 sections = (uint8)syncInfoByte & SmoothStateCodec::ALL_SECTIONS;
+	if (readingCharArraySize + stateCodec.getBodySize(sections) > readingCharArray.Num())
 	{
-		if (isPositionCompressed)
-		{
-			FFloat16 tempX, tempY, tempZ;
-			if (isSyncingXPosition())
-			{
-				readFromBuffer(&(tempX));
-				stateToAdd->position.X = float(tempX);
-			}
-			if (isSyncingYPosition())
-			{
-				readFromBuffer(&(tempY));
-				stateToAdd->position.Y = float(tempY);
-			}
-			if (isSyncingZPosition())
-			{
-				readFromBuffer(&(tempZ));
-				stateToAdd->position.Z = float(tempZ);
-			}
-			// Multiply by 100 to fully decompress since we divided by 100 when sending.
-			stateToAdd->position = stateToAdd->position * 100.0f;
-		}
-		else
-		{
-			if (isSyncingXPosition())
-			{
-				readFromBuffer(&(stateToAdd->position.X));
-			}
-			if (isSyncingYPosition())
-			{
-				readFromBuffer(&(stateToAdd->position.Y));
-			}
-			if (isSyncingZPosition())
-			{
-				readFromBuffer(&(stateToAdd->position.Z));
-			}
-		}
+		UE_LOG(LogTemp, Warning, TEXT("Received a network state that doesn't match the sync settings."));
+		delete stateToAdd;
+		return;
 	}
-	else
+	readingCharArraySize = stateCodec.decode(readingCharArray.GetData() + readingCharArraySize, stateToAdd, sections) - readingCharArray.GetData();
+
+	// Fill in whatever wasn't sent.
+	if (!deserializePosition)
 	{
 		if (stateCount > 0)
 		{
@@ -457,52 +431,7 @@ void USmoothSync::ServerSendsTransformToEveryone_Implementation(const TArray<uin
 			stateToAdd->position = getPosition();
 		}
 	}
-	// Read rotation.
-	if (deserializeRotation)
-	{
-		float rotX = 0;
-		float rotY = 0;
-		float rotZ = 0;
-		if (isRotationCompressed)
-		{
-			FFloat16 tempX, tempY, tempZ;
-			if (isSyncingXRotation())
-			{
-				readFromBuffer(&(tempX));
-				rotX = float(tempX);
-			}
-			if (isSyncingYRotation())
-			{
-				readFromBuffer(&(tempY));
-				rotY = float(tempY);
-			}
-			if (isSyncingZRotation())
-			{
-				readFromBuffer(&(tempZ));
-				rotZ = float(tempZ);
-			}
-			FVector rot = FVector(rotX, rotY, rotZ);
-			stateToAdd->rotation = FQuat::MakeFromEuler(rot);
-		}
-		else
-		{
-			if (isSyncingXRotation())
-			{
-				readFromBuffer(&rotX);
-			}
-			if (isSyncingYRotation())
-			{
-				readFromBuffer(&rotY);
-			}
-			if (isSyncingZRotation())
-			{
-				readFromBuffer(&rotZ);
-			}
-			FVector rot = FVector(rotX, rotY, rotZ);
-			stateToAdd->rotation = FQuat::MakeFromEuler(rot);
-		}
-	}
-	else
+	if (!deserializeRotation)
 	{
 		if (stateCount > 0)
 		{
@@ -513,45 +442,7 @@ void USmoothSync::ServerSendsTransformToEveryone_Implementation(const TArray<uin
 			stateToAdd->rotation = getRotation();
 		}
 	}
-	// Read scale.
-	if (deserializeScale)
-	{
-		if (isScaleCompressed)
-		{
-			FFloat16 tempX, tempY, tempZ;
-			if (isSyncingXScale())
-			{
-				readFromBuffer(&(tempX));
-				stateToAdd->scale.X = float(tempX);
-			}
-			if (isSyncingYScale())
-			{
-				readFromBuffer(&(tempY));
-				stateToAdd->scale.Y = float(tempY);
-			}
-			if (isSyncingZScale())
-			{
-				readFromBuffer(&(tempZ));
-				stateToAdd->scale.Z = float(tempZ);
-			}
-		}
-		else
-		{
-			if (isSyncingXScale())
-			{
-				readFromBuffer(&(stateToAdd->scale.X));
-			}
-			if (isSyncingYScale())
-			{
-				readFromBuffer(&(stateToAdd->scale.Y));
-			}
-			if (isSyncingZScale())
-			{
-				readFromBuffer(&(stateToAdd->scale.Z));
-			}
-		}
-	}
-	else
+	if (!deserializeScale)
 	{
 		if (stateCount > 0)
 		{
@@ -562,43 +453,8 @@ void USmoothSync::ServerSendsTransformToEveryone_Implementation(const TArray<uin
 			stateToAdd->scale = getScale();
 		}
 	}
-	// Read velocity.
 	if (deserializeVelocity)
 	{
-		if (isVelocityCompressed)
-		{
-			FFloat16 tempX, tempY, tempZ;
-			if (isSyncingXVelocity())
-			{
-				readFromBuffer(&(tempX));
-				stateToAdd->velocity.X = float(tempX);
-			}
-			if (isSyncingYVelocity())
-			{
-				readFromBuffer(&(tempY));
-				stateToAdd->velocity.Y = float(tempY);
-			}
-			if (isSyncingZVelocity())
-			{
-				readFromBuffer(&(tempZ));
-				stateToAdd->velocity.Z = float(tempZ);
-			}
-		}
-		else
-		{
-			if (isSyncingXVelocity())
-			{
-				readFromBuffer(&(stateToAdd->velocity.X));
-			}
-			if (isSyncingYVelocity())
-			{
-				readFromBuffer(&(stateToAdd->velocity.Y));
-			}
-			if (isSyncingZVelocity())
-			{
-				readFromBuffer(&(stateToAdd->velocity.Z));
-			}
-		}
 		latestReceivedVelocity = stateToAdd->velocity;
 	}
 	else
@@ -606,43 +462,8 @@ void USmoothSync::ServerSendsTransformToEveryone_Implementation(const TArray<uin
 		// If we didn't receive an updated velocity, use the latest received velocity.
 		stateToAdd->velocity = latestReceivedVelocity;
 	}
-	// Read anguluar velocity.
 	if (deserializeAngularVelocity)
 	{
-		if (isAngularVelocityCompressed)
-		{
-			FFloat16 tempX, tempY, tempZ;
-			if (isSyncingXAngularVelocity())
-			{
-				readFromBuffer(&(tempX));
-				stateToAdd->angularVelocity.X = float(tempX);
-			}
-			if (isSyncingYAngularVelocity())
-			{
-				readFromBuffer(&(tempY));
-				stateToAdd->angularVelocity.Y = float(tempY);
-			}
-			if (isSyncingZAngularVelocity())
-			{
-				readFromBuffer(&(tempZ));
-				stateToAdd->angularVelocity.Z = float(tempZ);
-			}
-		}
-		else
-		{
-			if (isSyncingXAngularVelocity())
-			{
-				readFromBuffer(&(stateToAdd->angularVelocity.X));
-			}
-			if (isSyncingYAngularVelocity())
-			{
-				readFromBuffer(&(stateToAdd->angularVelocity.Y));
-			}
-			if (isSyncingZAngularVelocity())
-			{
-				readFromBuffer(&(stateToAdd->angularVelocity.Z));
-			}
-		}
 		latestReceivedAngularVelocity = stateToAdd->angularVelocity;
 	}
 	else
@@ -710,6 +531,97 @@ void USmoothSync::TickComponent(float DeltaTime, ELevelTick TickType, FActorComp
 	}
 	// Reset back to default bools.
 	resetFlags();
+
+	// Stop ticking once there is nothing left to send or move towards.
+	if (useDormancy && (sendTransform ? sentAtRestState && isAtRest() : hasSettledOnRestState()))
+	{
+		goDormant();
+	}
+}
+
+/// <summary>Whether every synced part of the transform is at rest on the owner.</summary>
+bool USmoothSync::isAtRest()
+{
+	if (extrapolationMode == ExtrapolationMode::NONE || forceStateSend) return false;
+	if (syncPosition != SyncMode::NONE && restStatePosition != RestState::AT_REST) return false;
+	if (syncRotation != SyncMode::NONE && restStateRotation != RestState::AT_REST) return false;
+	return true;
+}
+
+/// <summary>Whether a non-owner has reached the latest State and that State is at rest.</summary>
+bool USmoothSync::hasSettledOnRestState()
+{
+	if (stateCount == 0 || extrapolationMode == ExtrapolationMode::NONE) return false;
+
+	SmoothState *latestState = stateBuffer[0];
+	// Unsynced parts are never flagged at rest, same as on the owner.
+	if (syncPosition != SyncMode::NONE && !latestState->atPositionalRest) return false;
+	if (syncRotation != SyncMode::NONE && !latestState->atRotationalRest) return false;
+
+	// Still playing back States from before the rest State.
+	if (getApproximateNetworkTimeOnOwner() - interpolationBackTime < latestState->ownerTimestamp) return false;
+
+	if (syncPosition != SyncMode::NONE &&
+		!sameVector(getPosition(), latestState->rebasedPosition(GetWorld()->OriginLocation), atRestPositionThreshold)) return false;
+	if (syncRotation != SyncMode::NONE &&
+		!sameVector(getRotation().Euler(), latestState->rotation.Euler(), atRestRotationThreshold)) return false;
+	return true;
+}
+
+void USmoothSync::goDormant()
+{
+	if (dormant) return;
+
+	USceneComponent* sceneComponent = getSceneComponentToSync();
+	if (sceneComponent == nullptr) return;
+
+	dormant = true;
+	SetComponentTickEnabled(false);
+
+	// Any movement wakes us back up, moves made while awake don't come through here.
+	transformUpdatedHandle = sceneComponent->TransformUpdated.AddUObject(this, &USmoothSync::onSyncedTransformUpdated);
+}
+
+/// <summary>
+/// Wake up from dormancy.
+/// </summary>
+void USmoothSync::wakeUp()
+{
+	if (!dormant) return;
+
+	dormant = false;
+	sentAtRestState = false;
+
+	if (transformUpdatedHandle.IsValid())
+	{
+		if (USceneComponent* sceneComponent = getSceneComponentToSync())
+		{
+			sceneComponent->TransformUpdated.Remove(transformUpdatedHandle);
+		}
+		transformUpdatedHandle.Reset();
+	}
+
+	// Don't count the time spent asleep as time at rest or extrapolating.
+	samePositionCount = 0;
+	sameRotationCount = 0;
+	extrapolatedLastFrame = false;
+
+	SetComponentTickEnabled(true);
+}
+
+void USmoothSync::onSyncedTransformUpdated(USceneComponent* updatedComponent, EUpdateTransformFlags updateTransformFlags, ETeleportType teleport)
+{
+	wakeUp();
+}
+
+USceneComponent* USmoothSync::getSceneComponentToSync()
+{
+	if (realComponentToSync != nullptr)
+	{
+		return realComponentToSync;
+	}
+
+	return realObjectToSync != nullptr ? realObjectToSync->GetRootComponent() : nullptr;
 }
 
 /// <summary>Used to turn Smooth Sync on and off. True to enable Smooth Sync. False to disable Smooth Sync.</summary>
@@ -731,6 +643,8 @@ void USmoothSync::enableSmoothSync(bool enable)
 
 void USmoothSync::internalEnableSmoothSync(bool enable)
 {
+	wakeUp();
+
 	if (enable)
 	{
 		isBeingUsed = true;
@@ -962,7 +876,7 @@ void USmoothSync::resetFlags()
 void USmoothSync::SerializeState(SmoothState *sendingState)
 {
 	sendingCharArraySize = 0;
-	sendingCharArray.Empty();
+	sendingCharArray.Reset();
 
 	if (sendPosition) lastPositionWhenStateWasSent = sendingState->position;
 	if (sendRotation) lastRotationWhenStateWasSent = sendingState->rotation;
@@ -970,8 +884,13 @@ void USmoothSync::SerializeState(SmoothState *sendingState)
 	if (sendVelocity) lastVelocityWhenStateWasSent = sendingState->velocity;
 	if (sendAngularVelocity) lastAngularVelocityWhenStateWasSent = sendingState->angularVelocity;
 
-	copyToBuffer(encodeSyncInformation(sendPosition, sendRotation, sendScale,
-		sendVelocity, sendAngularVelocity, sendAtPositionalRestMessage, sendAtRotationalRestMessage, sendMovementMode));
+	char syncInformation = encodeSyncInformation(sendPosition, sendRotation, sendScale,
+		sendVelocity, sendAngularVelocity, sendAtPositionalRestMessage, sendAtRotationalRestMessage, sendMovementMode);
+	copyToBuffer(syncInformation);
+
+	// Non-owners will settle on this State, so the owner can stop ticking once it is out.
+	sentAtRestState = (sendAtPositionalRestMessage || syncPosition == SyncMode::NONE) &&
+		(sendAtRotationalRestMessage || syncRotation == SyncMode::NONE);
 
 	if (isUsingOriginRebasing)
 	{
@@ -1003,179 +922,15 @@ void USmoothSync::SerializeState(SmoothState *sendingState)
 		}
 	}
 
-	// Write position.
-	if (sendPosition)
-	{
-		if (isPositionCompressed)
-		{
-			// Divide by 100 before sending to make compression more accurate for larger numbers
-			sendingState->position = sendingState->position / 100.0f;
-			if (isSyncingXPosition())
-			{
-				copyToBuffer(FFloat16(sendingState->position.X));
-			}
-			if (isSyncingYPosition())
-			{
-				copyToBuffer(FFloat16(sendingState->position.Y));
-			}
-			if (isSyncingZPosition())
-			{
-				copyToBuffer(FFloat16(sendingState->position.Z));
-			}
-		}
-		else
-		{
-			if (isSyncingXPosition())
-			{
-				copyToBuffer(sendingState->position.X);
-			}
-			if (isSyncingYPosition())
-			{
-				copyToBuffer(sendingState->position.Y);
-			}
-			if (isSyncingZPosition())
-			{
-				copyToBuffer(sendingState->position.Z);
-			}
-		}
-	}
-	// Write rotation.
-	if (sendRotation)
-	{
-		FVector rot = sendingState->rotation.Euler();
-		if (isRotationCompressed)
-		{
-			if (isSyncingXRotation())
-			{
-				copyToBuffer(FFloat16(rot.X));
-			}
-			if (isSyncingYRotation())
-			{
-				copyToBuffer(FFloat16(rot.Y));
-			}
-			if (isSyncingZRotation())
-			{
-				copyToBuffer(FFloat16(rot.Z));
-			}
-		}
-		else
-		{
-			if (isSyncingXRotation())
-			{
-				copyToBuffer(rot.X);
-			}
-			if (isSyncingYRotation())
-			{
-				copyToBuffer(rot.Y);
-			}
-			if (isSyncingZRotation())
-			{
-				copyToBuffer(rot.Z);
-			}
-		}
-	}
-	// Write scale.
-	if (sendScale)
-	{
-		if (isScaleCompressed)
-		{
-			if (isSyncingXScale())
-			{
-				copyToBuffer(FFloat16(sendingState->scale.X));
-			}
-			if (isSyncingYScale())
-			{
-				copyToBuffer(FFloat16(sendingState->scale.Y));
-			}
-			if (isSyncingZScale())
-			{
-				copyToBuffer(FFloat16(sendingState->scale.Z));
-			}
-		}
-		else
-		{
-			if (isSyncingXScale())
-			{
-				copyToBuffer(sendingState->scale.X);
-			}
-			if (isSyncingYScale())
-			{
-				copyToBuffer(sendingState->scale.Y);
-			}
-			if (isSyncingZScale())
-			{
-				copyToBuffer(sendingState->scale.Z);
-			}
-		}
-	}
-	// Write velocity.
-	if (sendVelocity)
-	{
-		if (isVelocityCompressed)
-		{
-			if (isSyncingXVelocity())
-			{
-				copyToBuffer(FFloat16(sendingState->velocity.X));
-			}
-			if (isSyncingYVelocity())
-			{
-				copyToBuffer(FFloat16(sendingState->velocity.Y));
-			}
-			if (isSyncingZVelocity())
-			{
-				copyToBuffer(FFloat16(sendingState->velocity.Z));
-			}
-		}
-		else
-		{
-			if (isSyncingXVelocity())
-			{
-				copyToBuffer(sendingState->velocity.X);
-			}
-			if (isSyncingYVelocity())
-			{
-				copyToBuffer(sendingState->velocity.Y);
-			}
-			if (isSyncingZVelocity())
-			{
-				copyToBuffer(sendingState->velocity.Z);
-			}
-		}
-	}
-	// Write angular velocity.
-	if (sendAngularVelocity)
-	{
-		if (isAngularVelocityCompressed)
-		{
-			if (isSyncingXAngularVelocity())
-			{
-				copyToBuffer(FFloat16(sendingState->angularVelocity.X));
-			}
-			if (isSyncingYAngularVelocity())
-			{
-				copyToBuffer(FFloat16(sendingState->angularVelocity.Y));
-			}
-			if (isSyncingZAngularVelocity())
-			{
-				copyToBuffer(FFloat16(sendingState->angularVelocity.Z));
-			}
-		}
-		else
-		{
-			if (isSyncingXAngularVelocity())
-			{
-				copyToBuffer(sendingState->angularVelocity.X);
-			}
-			if (isSyncingYAngularVelocity())
-			{
-				copyToBuffer(sendingState->angularVelocity.Y);
-			}
-			if (isSyncingZAngularVelocity())
-			{
-				copyToBuffer(sendingState->angularVelocity.Z);
-			}
-		}
-	}
+	// Write position, rotation, scale, velocity and angular velocity.
+	stateCodec.setConfiguration(SmoothStateCodec::getConfiguration(this));
+	int bodyStart = sendingCharArray.Num();
+	sendingCharArray.AddUninitialized(SmoothStateCodec::maxBodySize);
+	uint8 *bodyEnd = stateCodec.encode(sendingCharArray.GetData() + bodyStart, sendingState, (uint8)syncInformation & SmoothStateCodec::ALL_SECTIONS);
+	sendingCharArray.SetNum(bodyEnd - sendingCharArray.GetData(), false);
+	sendingCharArraySize = sendingCharArray.Num();
+	statesSentCount++;
+	stateBytesSentCount += sendingCharArraySize;
 
 	if (realObjectToSync->GetWorld()->IsServer())
 	{
@@ -1746,9 +1501,20 @@ void USmoothSync::addState(SmoothState *state)
 	{
 		// This state arrived out of order and we already have a newer state.
 		//UE_LOG(LogTemp, Warning, TEXT("Received state out of order for"));
+		delete state;
 		return;
 	}
 
+	if (dormant)
+	{
+		wakeUp();
+
+		// The owner time wasn't adjusted while at rest, jump straight to the new State so playback resumes from the 
+		// rest State instead of lerping through the time we were asleep.
+		_ownerTime = state->ownerTimestamp;
+		lastTimeOwnerTimeWasSet = UGameplayStatics::GetRealTimeSeconds(GetOwner()->GetWorld());
+	}
+
 	if (UGameplayStatics::GetRealTimeSeconds(GetOwner()->GetWorld()) - lastTimeStateWasReceived > receiveSnapTimeThreshold * 5.0f)
 	{
 		_ownerTime = state->ownerTimestamp;
@@ -1800,6 +1566,7 @@ void USmoothSync::teleport()
 		UE_LOG(LogTemp, Warning, TEXT("Trying to teleport from an unowned object. You can only teleport from an owned object. Look up Unreal networking object ownership."));
 		return;
 	}
+	wakeUp();
 	latestTeleportedFromPosition = getPosition();
 	latestTeleportedFromRotation = getRotation();
 	if (realObjectToSync->GetWorld()->IsServer())
@@ -1818,6 +1585,8 @@ void USmoothSync::teleport()
 /// </summary>
 void USmoothSync::addTeleportState(SmoothState *teleportState)
 {
+	wakeUp();
+
 	int stateBufferLength = std::max(calculatedStateBufferSize, 30);
 
 	// If the teleport State is the newest received State.
@@ -1869,6 +1638,7 @@ void USmoothSync::addTeleportState(SmoothState *teleportState)
 void USmoothSync::forceStateSendNextFrame()
 {
 	forceStateSend = true;
+	wakeUp();
 }
 
 bool USmoothSync::sameVector(FVector one, FVector two, float threshold)
@@ -2345,6 +2115,7 @@ bool USmoothSync::ReplicateSubobjects(class UActorChannel *Channel, class FOutBu
 		// Note that we can not call SerializeState directly here because we are already in the middle of the replication process
 		// So instead we set the resentLatestStateFromServer flag so that the state will be serialized next Tick.
 		resendLatestStateFromServer = true;
+		wakeUp();
 	}
 
 	return UActorComponent::ReplicateSubobjects(Channel, Bunch, RepFlags);
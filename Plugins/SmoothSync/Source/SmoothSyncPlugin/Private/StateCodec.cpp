@@ -0,0 +1,303 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "StateCodec.h"
+#include "SmoothSync.h"
+#include "State.h"
+
+namespace
+{
+	const uint8 AXIS_X = 1;
+	const uint8 AXIS_Y = 2;
+	const uint8 AXIS_Z = 4;
+	const uint8 AXIS_XYZ = AXIS_X | AXIS_Y | AXIS_Z;
+
+	/// <summary>The synced axes of each SyncMode, in the order they are declared.</summary>
+	const uint8 syncModeAxes[] = { AXIS_XYZ, AXIS_X | AXIS_Y, AXIS_X | AXIS_Z, AXIS_Y | AXIS_Z, AXIS_X, AXIS_Y, AXIS_Z, 0 };
+
+	/// <summary>
+	/// Each section takes four bits of the configuration key, three for the axes and one for compression.
+	/// Compression is dropped for sections without axes so it doesn't split otherwise identical configurations.
+	/// </summary>
+	constexpr uint32 makeSectionKey(int section, uint8 axes, bool compressed)
+	{
+		return (uint32)(axes | (axes != 0 && compressed ? 8 : 0)) << (section * 4);
+	}
+
+	constexpr uint32 makeConfiguration(uint8 positionAxes, uint8 rotationAxes, uint8 scaleAxes, uint8 velocityAxes, uint8 angularVelocityAxes, bool compressed)
+	{
+		return makeSectionKey(0, positionAxes, compressed) | makeSectionKey(1, rotationAxes, compressed) |
+			makeSectionKey(2, scaleAxes, compressed) | makeSectionKey(3, velocityAxes, compressed) |
+			makeSectionKey(4, angularVelocityAxes, compressed);
+	}
+
+	template <bool Compressed>
+	FORCEINLINE uint8* writeAxis(uint8 *buffer, float value)
+	{
+		if (Compressed)
+		{
+			const FFloat16 half(value);
+			FMemory::Memcpy(buffer, &half, sizeof(FFloat16));
+			return buffer + sizeof(FFloat16);
+		}
+		FMemory::Memcpy(buffer, &value, sizeof(float));
+		return buffer + sizeof(float);
+	}
+
+	template <bool Compressed>
+	FORCEINLINE const uint8* readAxis(const uint8 *buffer, float &value)
+	{
+		if (Compressed)
+		{
+			FFloat16 half;
+			FMemory::Memcpy(&half, buffer, sizeof(FFloat16));
+			value = float(half);
+			return buffer + sizeof(FFloat16);
+		}
+		FMemory::Memcpy(&value, buffer, sizeof(float));
+		return buffer + sizeof(float);
+	}
+
+	template <uint8 Axes, bool Compressed>
+	FORCEINLINE uint8* writeVector(uint8 *buffer, const FVector &value)
+	{
+		if (Axes & AXIS_X) buffer = writeAxis<Compressed>(buffer, value.X);
+		if (Axes & AXIS_Y) buffer = writeAxis<Compressed>(buffer, value.Y);
+		if (Axes & AXIS_Z) buffer = writeAxis<Compressed>(buffer, value.Z);
+		return buffer;
+	}
+
+	template <uint8 Axes, bool Compressed>
+	FORCEINLINE const uint8* readVector(const uint8 *buffer, FVector &value)
+	{
+		if (Axes & AXIS_X) buffer = readAxis<Compressed>(buffer, value.X);
+		if (Axes & AXIS_Y) buffer = readAxis<Compressed>(buffer, value.Y);
+		if (Axes & AXIS_Z) buffer = readAxis<Compressed>(buffer, value.Z);
+		return buffer;
+	}
+
+	// Position is divided by 100 before compressing to make compression more accurate for larger numbers.
+	template <uint8 Axes, bool Compressed>
+	uint8* writePosition(uint8 *buffer, const SmoothState *state)
+	{
+		return writeVector<Axes, Compressed>(buffer, Compressed ? state->position / 100.0f : state->position);
+	}
+
+	template <uint8 Axes, bool Compressed>
+	const uint8* readPosition(const uint8 *buffer, SmoothState *state)
+	{
+		buffer = readVector<Axes, Compressed>(buffer, state->position);
+		if (Compressed) state->position = state->position * 100.0f;
+		return buffer;
+	}
+
+	// Rotation goes over the network as euler angles, axes that aren't synced come back as 0.
+	template <uint8 Axes, bool Compressed>
+	uint8* writeRotation(uint8 *buffer, const SmoothState *state)
+	{
+		return writeVector<Axes, Compressed>(buffer, state->rotation.Euler());
+	}
+
+	template <uint8 Axes, bool Compressed>
+	const uint8* readRotation(const uint8 *buffer, SmoothState *state)
+	{
+		FVector rot = FVector::ZeroVector;
+		buffer = readVector<Axes, Compressed>(buffer, rot);
+		state->rotation = FQuat::MakeFromEuler(rot);
+		return buffer;
+	}
+
+	template <uint8 Axes, bool Compressed>
+	uint8* writeScale(uint8 *buffer, const SmoothState *state)
+	{
+		return writeVector<Axes, Compressed>(buffer, state->scale);
+	}
+
+	template <uint8 Axes, bool Compressed>
+	const uint8* readScale(const uint8 *buffer, SmoothState *state)
+	{
+		return readVector<Axes, Compressed>(buffer, state->scale);
+	}
+
+	template <uint8 Axes, bool Compressed>
+	uint8* writeVelocity(uint8 *buffer, const SmoothState *state)
+	{
+		return writeVector<Axes, Compressed>(buffer, state->velocity);
+	}
+
+	template <uint8 Axes, bool Compressed>
+	const uint8* readVelocity(const uint8 *buffer, SmoothState *state)
+	{
+		return readVector<Axes, Compressed>(buffer, state->velocity);
+	}
+
+	template <uint8 Axes, bool Compressed>
+	uint8* writeAngularVelocity(uint8 *buffer, const SmoothState *state)
+	{
+		return writeVector<Axes, Compressed>(buffer, state->angularVelocity);
+	}
+
+	template <uint8 Axes, bool Compressed>
+	const uint8* readAngularVelocity(const uint8 *buffer, SmoothState *state)
+	{
+		return readVector<Axes, Compressed>(buffer, state->angularVelocity);
+	}
+
+	template <uint8 PositionAxes, uint8 RotationAxes, uint8 ScaleAxes, uint8 VelocityAxes, uint8 AngularVelocityAxes, bool Compressed>
+	uint8* encodeSpecialized(const SmoothStateCodec &codec, uint8 *buffer, const SmoothState *state, uint8 sections)
+	{
+		if (sections & SmoothStateCodec::POSITION) buffer = writePosition<PositionAxes, Compressed>(buffer, state);
+		if (sections & SmoothStateCodec::ROTATION) buffer = writeRotation<RotationAxes, Compressed>(buffer, state);
+		if (sections & SmoothStateCodec::SCALE) buffer = writeScale<ScaleAxes, Compressed>(buffer, state);
+		if (sections & SmoothStateCodec::VELOCITY) buffer = writeVelocity<VelocityAxes, Compressed>(buffer, state);
+		if (sections & SmoothStateCodec::ANGULAR_VELOCITY) buffer = writeAngularVelocity<AngularVelocityAxes, Compressed>(buffer, state);
+		return buffer;
+	}
+
+	template <uint8 PositionAxes, uint8 RotationAxes, uint8 ScaleAxes, uint8 VelocityAxes, uint8 AngularVelocityAxes, bool Compressed>
+	const uint8* decodeSpecialized(const SmoothStateCodec &codec, const uint8 *buffer, SmoothState *state, uint8 sections)
+	{
+		if (sections & SmoothStateCodec::POSITION) buffer = readPosition<PositionAxes, Compressed>(buffer, state);
+		if (sections & SmoothStateCodec::ROTATION) buffer = readRotation<RotationAxes, Compressed>(buffer, state);
+		if (sections & SmoothStateCodec::SCALE) buffer = readScale<ScaleAxes, Compressed>(buffer, state);
+		if (sections & SmoothStateCodec::VELOCITY) buffer = readVelocity<VelocityAxes, Compressed>(buffer, state);
+		if (sections & SmoothStateCodec::ANGULAR_VELOCITY) buffer = readAngularVelocity<AngularVelocityAxes, Compressed>(buffer, state);
+		return buffer;
+	}
+
+	struct SpecializedCodec
+	{
+		uint32 configuration;
+		SmoothStateCodec::EncodeFunction encode;
+		SmoothStateCodec::DecodeFunction decode;
+	};
+
+#define SPECIALIZED_CODEC(PositionAxes, RotationAxes, ScaleAxes, VelocityAxes, AngularVelocityAxes, Compressed) \
+	{ makeConfiguration(PositionAxes, RotationAxes, ScaleAxes, VelocityAxes, AngularVelocityAxes, Compressed), \
+		&encodeSpecialized<PositionAxes, RotationAxes, ScaleAxes, VelocityAxes, AngularVelocityAxes, Compressed>, \
+		&decodeSpecialized<PositionAxes, RotationAxes, ScaleAxes, VelocityAxes, AngularVelocityAxes, Compressed> }
+
+#define SPECIALIZED_CODECS(PositionAxes, RotationAxes, ScaleAxes, VelocityAxes, AngularVelocityAxes) \
+	SPECIALIZED_CODEC(PositionAxes, RotationAxes, ScaleAxes, VelocityAxes, AngularVelocityAxes, false), \
+	SPECIALIZED_CODEC(PositionAxes, RotationAxes, ScaleAxes, VelocityAxes, AngularVelocityAxes, true), \
+	SPECIALIZED_CODEC(PositionAxes, RotationAxes, ScaleAxes, 0, 0, false), \
+	SPECIALIZED_CODEC(PositionAxes, RotationAxes, ScaleAxes, 0, 0, true)
+
+	/// <summary>The common configurations, each with and without velocity and with and without compression.</summary>
+	const SpecializedCodec specializedCodecs[] =
+	{
+		// Full transform, the default settings.
+		SPECIALIZED_CODECS(AXIS_XYZ, AXIS_XYZ, AXIS_XYZ, AXIS_XYZ, AXIS_XYZ),
+		// Full transform without scale.
+		SPECIALIZED_CODECS(AXIS_XYZ, AXIS_XYZ, 0, AXIS_XYZ, AXIS_XYZ),
+		// Position only.
+		SPECIALIZED_CODECS(AXIS_XYZ, 0, 0, AXIS_XYZ, 0),
+		// Position and yaw, characters and most ground based movement.
+		SPECIALIZED_CODECS(AXIS_XYZ, AXIS_Z, 0, AXIS_XYZ, AXIS_Z)
+	};
+
+#undef SPECIALIZED_CODECS
+#undef SPECIALIZED_CODEC
+
+#define SECTION_FUNCTION_ROW(Function, Axes) { &Function<Axes, false>, &Function<Axes, true> }
+#define SECTION_FUNCTION_TABLE(Function) \
+	{ SECTION_FUNCTION_ROW(Function, 0), SECTION_FUNCTION_ROW(Function, 1), SECTION_FUNCTION_ROW(Function, 2), SECTION_FUNCTION_ROW(Function, 3), \
+	SECTION_FUNCTION_ROW(Function, 4), SECTION_FUNCTION_ROW(Function, 5), SECTION_FUNCTION_ROW(Function, 6), SECTION_FUNCTION_ROW(Function, 7) }
+
+	/// <summary>Per section functions for the generic codec, indexed by [section][axes][compressed].</summary>
+	const SmoothStateCodec::SectionEncodeFunction sectionEncodeTable[SmoothStateCodec::sectionCount][8][2] =
+	{
+		SECTION_FUNCTION_TABLE(writePosition),
+		SECTION_FUNCTION_TABLE(writeRotation),
+		SECTION_FUNCTION_TABLE(writeScale),
+		SECTION_FUNCTION_TABLE(writeVelocity),
+		SECTION_FUNCTION_TABLE(writeAngularVelocity)
+	};
+
+	const SmoothStateCodec::SectionDecodeFunction sectionDecodeTable[SmoothStateCodec::sectionCount][8][2] =
+	{
+		SECTION_FUNCTION_TABLE(readPosition),
+		SECTION_FUNCTION_TABLE(readRotation),
+		SECTION_FUNCTION_TABLE(readScale),
+		SECTION_FUNCTION_TABLE(readVelocity),
+		SECTION_FUNCTION_TABLE(readAngularVelocity)
+	};
+
+#undef SECTION_FUNCTION_TABLE
+#undef SECTION_FUNCTION_ROW
+}
+
+SmoothStateCodec::SmoothStateCodec()
+{
+	// Start out invalid so the first setConfiguration() always builds the tables.
+	configuration = MAX_uint32;
+	setConfiguration(0);
+}
+
+uint32 SmoothStateCodec::getConfiguration(const USmoothSync *smoothSync)
+{
+	return makeSectionKey(0, syncModeAxes[(uint8)smoothSync->syncPosition], smoothSync->isPositionCompressed) |
+		makeSectionKey(1, syncModeAxes[(uint8)smoothSync->syncRotation], smoothSync->isRotationCompressed) |
+		makeSectionKey(2, syncModeAxes[(uint8)smoothSync->syncScale], smoothSync->isScaleCompressed) |
+		makeSectionKey(3, syncModeAxes[(uint8)smoothSync->syncVelocity], smoothSync->isVelocityCompressed) |
+		makeSectionKey(4, syncModeAxes[(uint8)smoothSync->syncAngularVelocity], smoothSync->isAngularVelocityCompressed);
+}
+
+void SmoothStateCodec::setConfiguration(uint32 newConfiguration)
+{
+	if (newConfiguration == configuration) return;
+
+	configuration = newConfiguration;
+
+	for (int i = 0; i < sectionCount; i++)
+	{
+		const uint8 axes = (configuration >> (i * 4)) & AXIS_XYZ;
+		const bool compressed = ((configuration >> (i * 4)) & 8) != 0;
+
+		sectionEncoders[i] = sectionEncodeTable[i][axes][compressed];
+		sectionDecoders[i] = sectionDecodeTable[i][axes][compressed];
+		sectionSizes[i] = FMath::CountBits(axes) * (compressed ? sizeof(FFloat16) : sizeof(float));
+	}
+
+	specialized = false;
+	encodeFunction = &SmoothStateCodec::encodeGeneric;
+	decodeFunction = &SmoothStateCodec::decodeGeneric;
+
+	for (const SpecializedCodec &specializedCodec : specializedCodecs)
+	{
+		if (specializedCodec.configuration == configuration)
+		{
+			specialized = true;
+			encodeFunction = specializedCodec.encode;
+			decodeFunction = specializedCodec.decode;
+			break;
+		}
+	}
+}
+
+int SmoothStateCodec::getBodySize(uint8 sections) const
+{
+	int size = 0;
+	for (int i = 0; i < sectionCount; i++)
+	{
+		if (sections & (1 << i)) size += sectionSizes[i];
+	}
+	return size;
+}
+
+uint8* SmoothStateCodec::encodeGeneric(const SmoothStateCodec &codec, uint8 *buffer, const SmoothState *state, uint8 sections)
+{
+	for (int i = 0; i < sectionCount; i++)
+	{
+		if (sections & (1 << i)) buffer = codec.sectionEncoders[i](buffer, state);
+	}
+	return buffer;
+}
+
+const uint8* SmoothStateCodec::decodeGeneric(const SmoothStateCodec &codec, const uint8 *buffer, SmoothState *state, uint8 sections)
+{
+	for (int i = 0; i < sectionCount; i++)
+	{
+		if (sections & (1 << i)) buffer = codec.sectionDecoders[i](buffer, state);
+	}
+	return buffer;
+}
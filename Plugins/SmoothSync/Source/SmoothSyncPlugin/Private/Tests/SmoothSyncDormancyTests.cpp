@@ -0,0 +1,247 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+#include "HAL/PlatformTime.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/WorldSettings.h"
+#include "Components/SceneComponent.h"
+#include "SmoothSync.h"
+#include "State.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace SmoothSyncDormancyTests
+{
+	const float frameTime = 1.0f / 60.0f;
+
+	/// <summary>Standalone game world, nothing is networked so every SmoothSync in it is an owner.</summary>
+	struct FScopedTestWorld
+	{
+		UWorld *world;
+
+		FScopedTestWorld()
+		{
+			world = UWorld::CreateWorld(EWorldType::Game, false);
+			FWorldContext &context = GEngine->CreateNewWorldContext(EWorldType::Game);
+			context.SetCurrentWorld(world);
+			world->InitializeActorsForPlay(FURL());
+			world->GetWorldSettings()->NotifyBeginPlay();
+		}
+
+		~FScopedTestWorld()
+		{
+			GEngine->DestroyWorldContext(world);
+			world->DestroyWorld(false);
+		}
+
+		/// <summary>Moves the clocks SmoothSync reads its send interval and timestamps from.</summary>
+		void advance(float deltaTime)
+		{
+			world->RealTimeSeconds += deltaTime;
+			world->TimeSeconds += deltaTime;
+		}
+	};
+
+	USmoothSync* spawnSynced(UWorld *world, const FVector &location, bool useDormancy)
+	{
+		AActor *actor = world->SpawnActor<AActor>();
+		USceneComponent *root = NewObject<USceneComponent>(actor, TEXT("Root"));
+		actor->SetRootComponent(root);
+		root->RegisterComponent();
+		root->SetWorldLocation(location);
+
+		USmoothSync *smoothSync = NewObject<USmoothSync>(actor, TEXT("SmoothSync"));
+		smoothSync->useDormancy = useDormancy;
+		smoothSync->RegisterComponent();
+		return smoothSync;
+	}
+
+	/// <summary>One frame for every owner whose tick is still enabled, returns how many ticked.</summary>
+	int tick(FScopedTestWorld &testWorld, const TArray<USmoothSync*> &smoothSyncs)
+	{
+		testWorld.advance(frameTime);
+
+		int ticked = 0;
+		for (USmoothSync *smoothSync : smoothSyncs)
+		{
+			if (!smoothSync->IsComponentTickEnabled()) continue;
+			smoothSync->TickComponent(frameTime, LEVELTICK_All, &smoothSync->PrimaryComponentTick);
+			ticked++;
+		}
+		return ticked;
+	}
+
+	/// <summary>Ticks a single owner until it goes dormant or the time runs out.</summary>
+	bool tickUntilDormant(FScopedTestWorld &testWorld, USmoothSync *smoothSync, float maxTime)
+	{
+		const TArray<USmoothSync*> smoothSyncs = { smoothSync };
+		for (float time = 0; time < maxTime && !smoothSync->isDormant(); time += frameTime)
+		{
+			tick(testWorld, smoothSyncs);
+		}
+		return smoothSync->isDormant();
+	}
+
+	struct FSessionResult
+	{
+		int ticks = 0;
+		int statesSent = 0;
+		int64 bytesSent = 0;
+		double seconds = 0;
+	};
+
+	/// <summary>
+	/// A room full of props where a few are always moving and the rest sit still, with a handful of the resting ones
+	/// knocked every couple of seconds.
+	/// </summary>
+	FSessionResult runSession(int numObjects, float movingFraction, float duration, bool useDormancy)
+	{
+		FScopedTestWorld testWorld;
+		FRandomStream random(1234);
+
+		TArray<USmoothSync*> smoothSyncs;
+		for (int i = 0; i < numObjects; i++)
+		{
+			smoothSyncs.Add(spawnSynced(testWorld.world, FVector(i * 100.0f, 0, 0), useDormancy));
+		}
+		const int numMoving = FMath::CeilToInt(numObjects * movingFraction);
+
+		FSessionResult result;
+		const double startTime = FPlatformTime::Seconds();
+		const int numFrames = FMath::RoundToInt(duration / frameTime);
+		for (int frame = 0; frame < numFrames; frame++)
+		{
+			const float time = frame * frameTime;
+			for (int i = 0; i < numMoving; i++)
+			{
+				USceneComponent *root = smoothSyncs[i]->GetOwner()->GetRootComponent();
+				root->SetWorldLocation(FVector(i * 100.0f + FMath::Sin(time) * 200.0f, FMath::Cos(time) * 200.0f, 0));
+			}
+
+			if (frame > 0 && frame % 120 == 0)
+			{
+				for (int knock = 0; knock < FMath::Max(1, numObjects / 20); knock++)
+				{
+					USceneComponent *root = smoothSyncs[random.RandRange(numMoving, numObjects - 1)]->GetOwner()->GetRootComponent();
+					root->AddWorldOffset(FVector(0, 0, random.FRandRange(5.0f, 20.0f)));
+				}
+			}
+
+			result.ticks += tick(testWorld, smoothSyncs);
+		}
+		result.seconds = FPlatformTime::Seconds() - startTime;
+
+		for (USmoothSync *smoothSync : smoothSyncs)
+		{
+			result.statesSent += smoothSync->statesSentCount;
+			result.bytesSent += smoothSync->stateBytesSentCount;
+		}
+		return result;
+	}
+}
+
+using namespace SmoothSyncDormancyTests;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSmoothSyncDormancyTransitionsTest, "SmoothSync.Dormancy.Transitions", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSmoothSyncDormancyTransitionsTest::RunTest(const FString& Parameters)
+{
+	TestFalse(TEXT("Dormancy is opt in"), GetDefault<USmoothSync>()->useDormancy);
+
+	FScopedTestWorld testWorld;
+
+	// Left off, an owner at rest keeps ticking
+	{
+		USmoothSync *smoothSync = spawnSynced(testWorld.world, FVector(0, 0, 0), false);
+		TestFalse(TEXT("Opted out owner never goes dormant"), tickUntilDormant(testWorld, smoothSync, 2.0f));
+		TestTrue(TEXT("Opted out owner keeps ticking"), smoothSync->IsComponentTickEnabled());
+	}
+
+	// Opted in, the owner sleeps once the rest State is out and wakes on movement
+	{
+		USmoothSync *smoothSync = spawnSynced(testWorld.world, FVector(500, 0, 0), true);
+		TestTrue(TEXT("Owner at rest goes dormant"), tickUntilDormant(testWorld, smoothSync, 2.0f));
+		TestFalse(TEXT("Dormant owner stops ticking"), smoothSync->IsComponentTickEnabled());
+		TestTrue(TEXT("Rest State went out before sleeping"), smoothSync->sentAtRestState);
+
+		const int sentBeforeMove = smoothSync->statesSentCount;
+		smoothSync->GetOwner()->GetRootComponent()->AddWorldOffset(FVector(0, 50, 0));
+		TestFalse(TEXT("Moving the synced component wakes the owner"), smoothSync->isDormant());
+		TestTrue(TEXT("Woken owner ticks again"), smoothSync->IsComponentTickEnabled());
+		TestFalse(TEXT("Waking clears the sent rest State"), smoothSync->sentAtRestState);
+
+		tick(testWorld, { smoothSync });
+		TestTrue(TEXT("Woken owner sends the move"), smoothSync->statesSentCount > sentBeforeMove);
+
+		TestTrue(TEXT("Owner settles and sleeps again"), tickUntilDormant(testWorld, smoothSync, 2.0f));
+
+		smoothSync->wakeUp();
+		TestFalse(TEXT("wakeUp() wakes"), smoothSync->isDormant());
+		smoothSync->wakeUp();
+		TestTrue(TEXT("Repeated wakeUp() is harmless"), smoothSync->IsComponentTickEnabled());
+
+		smoothSync->goDormant();
+		smoothSync->teleport();
+		TestFalse(TEXT("teleport() wakes the owner"), smoothSync->isDormant());
+	}
+
+	// A received State wakes a sleeping component and jumps playback to it
+	{
+		USmoothSync *smoothSync = spawnSynced(testWorld.world, FVector(1000, 0, 0), true);
+		smoothSync->goDormant();
+		TestTrue(TEXT("goDormant() sleeps"), smoothSync->isDormant());
+		smoothSync->goDormant();
+		TestTrue(TEXT("Repeated goDormant() is harmless"), smoothSync->isDormant());
+
+		SmoothState *state = new SmoothState();
+		state->ownerTimestamp = 42.0f;
+		state->position = FVector(1000, 0, 0);
+		state->atPositionalRest = true;
+		state->atRotationalRest = true;
+		smoothSync->addState(state);
+
+		TestFalse(TEXT("Received State wakes the component"), smoothSync->isDormant());
+		TestTrue(TEXT("Received State re-enables the tick"), smoothSync->IsComponentTickEnabled());
+		TestEqual(TEXT("Playback jumps to the received State"), smoothSync->_ownerTime, 42.0f);
+		TestEqual(TEXT("Received State is buffered"), smoothSync->stateCount, 1);
+	}
+
+	// Rest is never detected without extrapolation, so it never sleeps
+	{
+		USmoothSync *smoothSync = spawnSynced(testWorld.world, FVector(1500, 0, 0), true);
+		smoothSync->extrapolationMode = ExtrapolationMode::NONE;
+		TestFalse(TEXT("No extrapolation never goes dormant"), tickUntilDormant(testWorld, smoothSync, 2.0f));
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSmoothSyncDormancyBenchmarkTest, "SmoothSync.Dormancy.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSmoothSyncDormancyBenchmarkTest::RunTest(const FString& Parameters)
+{
+	const float duration = 10.0f;
+	const int objectCounts[] = { 50, 200, 500 };
+
+	for (int numObjects : objectCounts)
+	{
+		const FSessionResult awake = runSession(numObjects, 0.1f, duration, false);
+		const FSessionResult dormant = runSession(numObjects, 0.1f, duration, true);
+
+		AddInfo(FString::Printf(TEXT("%d objects, 10%% moving, %.0fs: awake %d ticks %d States %lld bytes (%.0f B/s) %.2f ms | dormant %d ticks %d States %lld bytes (%.0f B/s) %.2f ms"),
+			numObjects, duration,
+			awake.ticks, awake.statesSent, awake.bytesSent, awake.bytesSent / duration, awake.seconds * 1000.0,
+			dormant.ticks, dormant.statesSent, dormant.bytesSent, dormant.bytesSent / duration, dormant.seconds * 1000.0));
+
+		TestTrue(FString::Printf(TEXT("%d objects: dormancy ticks less"), numObjects), dormant.ticks < awake.ticks);
+		TestTrue(FString::Printf(TEXT("%d objects: dormancy sends no more"), numObjects), dormant.bytesSent <= awake.bytesSent);
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
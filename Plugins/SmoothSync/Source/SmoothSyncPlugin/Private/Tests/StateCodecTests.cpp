@@ -0,0 +1,327 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+#include "HAL/PlatformTime.h"
+#include "StateCodec.h"
+#include "State.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace StateCodecTests
+{
+	/// <summary>Same layout as the configuration key, four bits per section with the axes in the low three.</summary>
+	uint32 makeConfiguration(const uint8 axes[SmoothStateCodec::sectionCount], const bool compressed[SmoothStateCodec::sectionCount])
+	{
+		uint32 configuration = 0;
+		for (int i = 0; i < SmoothStateCodec::sectionCount; i++)
+		{
+			configuration |= (uint32)(axes[i] | (axes[i] != 0 && compressed[i] ? 8 : 0)) << (i * 4);
+		}
+		return configuration;
+	}
+
+	void writeAxis(TArray<uint8> &buffer, float value, bool compressed)
+	{
+		if (compressed)
+		{
+			const FFloat16 half(value);
+			buffer.Append((const uint8*)&half, sizeof(FFloat16));
+		}
+		else
+		{
+			buffer.Append((const uint8*)&value, sizeof(float));
+		}
+	}
+
+	const uint8* readAxis(const uint8 *buffer, float &value, bool compressed)
+	{
+		if (compressed)
+		{
+			FFloat16 half;
+			FMemory::Memcpy(&half, buffer, sizeof(FFloat16));
+			value = float(half);
+			return buffer + sizeof(FFloat16);
+		}
+		FMemory::Memcpy(&value, buffer, sizeof(float));
+		return buffer + sizeof(float);
+	}
+
+	/// <summary>The field by field serialization the codec replaced, one axis at a time in section order.</summary>
+	void referenceEncode(TArray<uint8> &buffer, const SmoothState &state, const uint8 axes[SmoothStateCodec::sectionCount], const bool compressed[SmoothStateCodec::sectionCount], uint8 sections)
+	{
+		const FVector values[SmoothStateCodec::sectionCount] =
+		{
+			compressed[0] ? state.position / 100.0f : state.position,
+			state.rotation.Euler(),
+			state.scale,
+			state.velocity,
+			state.angularVelocity
+		};
+
+		for (int i = 0; i < SmoothStateCodec::sectionCount; i++)
+		{
+			if (!(sections & (1 << i))) continue;
+			if (axes[i] & 1) writeAxis(buffer, values[i].X, compressed[i]);
+			if (axes[i] & 2) writeAxis(buffer, values[i].Y, compressed[i]);
+			if (axes[i] & 4) writeAxis(buffer, values[i].Z, compressed[i]);
+		}
+	}
+
+	const uint8* referenceDecode(const uint8 *buffer, SmoothState &state, const uint8 axes[SmoothStateCodec::sectionCount], const bool compressed[SmoothStateCodec::sectionCount], uint8 sections)
+	{
+		FVector *targets[SmoothStateCodec::sectionCount] = { &state.position, nullptr, &state.scale, &state.velocity, &state.angularVelocity };
+
+		for (int i = 0; i < SmoothStateCodec::sectionCount; i++)
+		{
+			if (!(sections & (1 << i))) continue;
+
+			// Unsynced rotation axes come back as 0, every other section keeps what it had
+			FVector rotation = FVector::ZeroVector;
+			FVector &value = targets[i] ? *targets[i] : rotation;
+
+			if (axes[i] & 1) buffer = readAxis(buffer, value.X, compressed[i]);
+			if (axes[i] & 2) buffer = readAxis(buffer, value.Y, compressed[i]);
+			if (axes[i] & 4) buffer = readAxis(buffer, value.Z, compressed[i]);
+
+			if (i == 0 && compressed[i]) state.position = state.position * 100.0f;
+			if (i == 1) state.rotation = FQuat::MakeFromEuler(rotation);
+		}
+		return buffer;
+	}
+
+	void randomizeState(FRandomStream &random, SmoothState &state)
+	{
+		state.position = random.VRand() * random.FRandRange(0.0f, 100000.0f);
+		state.rotation = FRotator(random.FRandRange(-89.0f, 89.0f), random.FRandRange(-180.0f, 180.0f), random.FRandRange(-180.0f, 180.0f)).Quaternion();
+		state.scale = FVector(random.FRandRange(0.1f, 10.0f), random.FRandRange(0.1f, 10.0f), random.FRandRange(0.1f, 10.0f));
+		state.velocity = random.VRand() * random.FRandRange(0.0f, 5000.0f);
+		state.angularVelocity = random.VRand() * random.FRandRange(0.0f, 720.0f);
+	}
+
+	bool statesMatch(const SmoothState &a, const SmoothState &b)
+	{
+		return a.position == b.position && a.rotation == b.rotation && a.scale == b.scale &&
+			a.velocity == b.velocity && a.angularVelocity == b.angularVelocity;
+	}
+
+	/// <summary>Full transform, position and rotation, position only and position plus yaw.</summary>
+	const int specializedShapeCount = 4;
+	const TCHAR *specializedShapeNames[specializedShapeCount] = { TEXT("Full transform"), TEXT("Position and rotation"), TEXT("Position only"), TEXT("Position and yaw") };
+
+	/// <summary>One of the specialized shapes, variant bit 0 drops the velocities and bit 1 compresses everything.</summary>
+	void makeSpecializedShape(int shape, int variant, uint8 axes[SmoothStateCodec::sectionCount], bool compressed[SmoothStateCodec::sectionCount])
+	{
+		const uint8 xyz = 7;
+		const uint8 shapes[specializedShapeCount][SmoothStateCodec::sectionCount] =
+		{
+			{ xyz, xyz, xyz, xyz, xyz },
+			{ xyz, xyz, 0, xyz, xyz },
+			{ xyz, 0, 0, xyz, 0 },
+			{ xyz, 4, 0, xyz, 4 }
+		};
+
+		const bool withVelocity = (variant & 1) == 0;
+		const bool isCompressed = (variant & 2) != 0;
+
+		for (int i = 0; i < SmoothStateCodec::sectionCount; i++)
+		{
+			axes[i] = (i >= 3 && !withVelocity) ? 0 : shapes[shape][i];
+			compressed[i] = isCompressed;
+		}
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSmoothStateCodecByteCompatibilityTest, "SmoothSync.StateCodec.ByteCompatibility", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSmoothStateCodecByteCompatibilityTest::RunTest(const FString& Parameters)
+{
+	using namespace StateCodecTests;
+
+	FRandomStream random(0x5A17);
+	SmoothStateCodec codec;
+	TArray<uint8> expected;
+	uint8 encoded[SmoothStateCodec::maxBodySize];
+	int numFailures = 0;
+
+	// Every combination of synced axes, with the compression flags cycling through every combination alongside
+	for (int32 combination = 0; combination < (1 << (3 * SmoothStateCodec::sectionCount)) && numFailures < 10; combination++)
+	{
+		uint8 axes[SmoothStateCodec::sectionCount];
+		bool compressed[SmoothStateCodec::sectionCount];
+		for (int i = 0; i < SmoothStateCodec::sectionCount; i++)
+		{
+			axes[i] = (combination >> (i * 3)) & 7;
+			compressed[i] = ((combination % 32) & (1 << i)) != 0;
+		}
+
+		codec.setConfiguration(makeConfiguration(axes, compressed));
+
+		SmoothState state;
+		state.defaultTheVariables();
+		randomizeState(random, state);
+
+		// All sections plus a random subset, rest states only send some of them
+		const uint8 sectionSets[] = { (uint8)SmoothStateCodec::ALL_SECTIONS, (uint8)random.RandRange(0, SmoothStateCodec::ALL_SECTIONS) };
+		for (uint8 sections : sectionSets)
+		{
+			expected.Reset();
+			referenceEncode(expected, state, axes, compressed, sections);
+
+			const uint8 *end = codec.encode(encoded, &state, sections);
+			const int size = (int)(end - encoded);
+
+			if (size != expected.Num() || size != codec.getBodySize(sections) || FMemory::Memcmp(encoded, expected.GetData(), size) != 0)
+			{
+				AddError(FString::Printf(TEXT("Configuration 0x%05x sections %d encoded %d bytes, expected %d"), codec.getCurrentConfiguration(), sections, size, expected.Num()));
+				numFailures++;
+				continue;
+			}
+
+			SmoothState prefill, decoded, reference;
+			prefill.defaultTheVariables();
+			randomizeState(random, prefill);
+			decoded.copyFromState(&prefill);
+			reference.copyFromState(&prefill);
+
+			const uint8 *decodedEnd = codec.decode(encoded, &decoded, sections);
+			referenceDecode(expected.GetData(), reference, axes, compressed, sections);
+
+			if (decodedEnd != end || !statesMatch(decoded, reference))
+			{
+				AddError(FString::Printf(TEXT("Configuration 0x%05x sections %d decoded differently from the field by field read"), codec.getCurrentConfiguration(), sections));
+				numFailures++;
+			}
+		}
+	}
+
+	// The common configurations have to actually get their specialized pair
+	for (int shape = 0; shape < specializedShapeCount; shape++)
+	{
+		for (int variant = 0; variant < 4; variant++)
+		{
+			uint8 axes[SmoothStateCodec::sectionCount];
+			bool compressed[SmoothStateCodec::sectionCount];
+			makeSpecializedShape(shape, variant, axes, compressed);
+
+			codec.setConfiguration(makeConfiguration(axes, compressed));
+			TestTrue(FString::Printf(TEXT("Configuration 0x%05x is specialized"), codec.getCurrentConfiguration()), codec.isSpecialized());
+		}
+	}
+
+	return numFailures == 0;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSmoothStateCodecBenchmark, "SmoothSync.StateCodec.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSmoothStateCodecBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace StateCodecTests;
+
+	const int numStates = 1 << 21;
+	const int numDistinctStates = 4096;
+
+	FRandomStream random(0xBE7C);
+	TArray<SmoothState> states;
+	states.SetNum(numDistinctStates);
+	for (SmoothState &state : states)
+	{
+		state.defaultTheVariables();
+		randomizeState(random, state);
+	}
+
+	SmoothStateCodec codec;
+	TArray<uint8> referenceBuffer;
+	referenceBuffer.Reserve(SmoothStateCodec::maxBodySize);
+	uint8 encoded[SmoothStateCodec::maxBodySize];
+	SmoothState decoded;
+	decoded.defaultTheVariables();
+
+	// Every specialized configuration, then a couple the generic table handles
+	for (int shape = 0; shape <= specializedShapeCount; shape++)
+	{
+		for (int variant = 0; variant < 4; variant++)
+		{
+			uint8 axes[SmoothStateCodec::sectionCount];
+			bool compressed[SmoothStateCodec::sectionCount];
+
+			if (shape < specializedShapeCount)
+			{
+				makeSpecializedShape(shape, variant, axes, compressed);
+			}
+			else
+			{
+				// Planar position and pitch only, with scale, compressed or not
+				if (variant >= 2) break;
+				const uint8 genericAxes[SmoothStateCodec::sectionCount] = { 3, 1, 7, 3, 1 };
+				for (int i = 0; i < SmoothStateCodec::sectionCount; i++)
+				{
+					axes[i] = genericAxes[i];
+					compressed[i] = variant == 1;
+				}
+			}
+
+			codec.setConfiguration(makeConfiguration(axes, compressed));
+			const int bodySize = codec.getBodySize(SmoothStateCodec::ALL_SECTIONS);
+
+			// The checksums keep the optimizer from dropping the work and catch the two paths drifting apart
+			uint32 checksum = 0;
+			uint32 referenceChecksum = 0;
+
+			double start = FPlatformTime::Seconds();
+			for (int i = 0; i < numStates; i++)
+			{
+				codec.encode(encoded, &states[i & (numDistinctStates - 1)], SmoothStateCodec::ALL_SECTIONS);
+				checksum += encoded[i % bodySize];
+			}
+			const double encodeSeconds = FPlatformTime::Seconds() - start;
+
+			start = FPlatformTime::Seconds();
+			for (int i = 0; i < numStates; i++)
+			{
+				referenceBuffer.Reset();
+				referenceEncode(referenceBuffer, states[i & (numDistinctStates - 1)], axes, compressed, SmoothStateCodec::ALL_SECTIONS);
+				referenceChecksum += referenceBuffer[i % bodySize];
+			}
+			const double referenceEncodeSeconds = FPlatformTime::Seconds() - start;
+
+			TestEqual(FString::Printf(TEXT("Configuration 0x%05x encodes the same bytes"), codec.getCurrentConfiguration()), checksum, referenceChecksum);
+
+			// Decode the last encoded state over and over, the read path doesn't depend on the values
+			codec.encode(encoded, &states[0], SmoothStateCodec::ALL_SECTIONS);
+			float decodedSum = 0.0f;
+			float referenceDecodedSum = 0.0f;
+
+			start = FPlatformTime::Seconds();
+			for (int i = 0; i < numStates; i++)
+			{
+				codec.decode(encoded, &decoded, SmoothStateCodec::ALL_SECTIONS);
+				decodedSum += decoded.position.X;
+			}
+			const double decodeSeconds = FPlatformTime::Seconds() - start;
+
+			start = FPlatformTime::Seconds();
+			for (int i = 0; i < numStates; i++)
+			{
+				referenceDecode(encoded, decoded, axes, compressed, SmoothStateCodec::ALL_SECTIONS);
+				referenceDecodedSum += decoded.position.X;
+			}
+			const double referenceDecodeSeconds = FPlatformTime::Seconds() - start;
+
+			TestEqual(FString::Printf(TEXT("Configuration 0x%05x decodes the same values"), codec.getCurrentConfiguration()), decodedSum, referenceDecodedSum);
+
+			const FString name = shape < specializedShapeCount ?
+				FString::Printf(TEXT("%s%s%s"), specializedShapeNames[shape], (variant & 1) ? TEXT(" without velocity") : TEXT(""), (variant & 2) ? TEXT(" compressed") : TEXT("")) :
+				FString::Printf(TEXT("Generic%s"), variant == 1 ? TEXT(" compressed") : TEXT(""));
+
+			AddInfo(FString::Printf(TEXT("%s (%d bytes%s): encode %.1f ns/state (field by field %.1f), decode %.1f ns/state (field by field %.1f)"),
+				*name, bodySize, codec.isSpecialized() ? TEXT("") : TEXT(", generic"),
+				encodeSeconds * 1e9 / numStates, referenceEncodeSeconds * 1e9 / numStates, decodeSeconds * 1e9 / numStates, referenceDecodeSeconds * 1e9 / numStates));
+		}
+	}
+
+	return true;
+}
+
+#endif
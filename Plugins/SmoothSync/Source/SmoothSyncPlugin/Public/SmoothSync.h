@@ -7,6 +7,7 @@
 #include "Runtime/Engine/Classes/GameFramework/MovementComponent.h"
 #include "Runtime/Engine/Classes/GameFramework/Character.h"
 #include "Runtime/Engine/Classes/GameFramework/CharacterMovementComponent.h"
+#include "StateCodec.h"
 #include "SmoothSync.generated.h"
 
 
@@ -352,6 +353,16 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Important)
 		bool isUsingOriginRebasing = false;
 
+	/// <summary>Whether or not to stop ticking while at rest.</summary>
+	/// <remarks>
+	/// Owners stop ticking once the at rest State has been sent, non-owners once they have settled on it. 
+	/// Owners wake up when the synced transform changes, on teleport() or wakeUp(). Non-owners wake up on the next 
+	/// received State. Only used when extrapolationMode is not NONE as rest is not detected otherwise.
+	/// Off by default, turn it on for objects that spend most of their time at rest.
+	/// </remarks>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Important)
+		bool useDormancy = false;
+
 	/// <summary>Non-owners keep a list of recent States received over the network for interpolating.</summary>
 	/// <remarks>Index 0 is the newest received State.</remarks>
 	SmoothState **stateBuffer;
@@ -376,6 +387,12 @@ public:
 	/// <summary>Last time owner sent a SmoothState.</summary>
 	float lastTimeStateWasSent;
 
+	/// <summary>Number of States the owner has sent.</summary>
+	int statesSentCount = 0;
+
+	/// <summary>Number of bytes of State the owner has sent, not counting RPC overhead.</summary>
+	int64 stateBytesSentCount = 0;
+
 	/// <summary>Last time a SmoothState was received on non-owner.</summary>
 	float lastTimeStateWasReceived;
 
@@ -536,6 +553,15 @@ public:
 		///	Will automatically send RPCs across the network. Is meant to be called on the owned version of the Actor.
 		void enableSmoothSync(bool enable);
 
+	UFUNCTION(BlueprintCallable, Category = "SmoothSync")
+		/// Wakes Smooth Sync up if it went dormant at rest. Dormant components wake up on their own when moved or when a 
+		/// State is received, call this if something changes that Smooth Sync can't see, like the velocity on a movement component.
+		void wakeUp();
+
+	UFUNCTION(BlueprintPure, Category = "SmoothSync")
+		/// Whether Smooth Sync has stopped ticking because the object is at rest.
+		bool isDormant() const { return dormant; }
+
 	UFUNCTION(BlueprintCallable, Category = "SmoothSync")
 		/// Forces the SmoothState (Transform) to be sent on owned objects the next time it goes through TickComponent(). 
 		/// The SmoothState (Transform) will get sent next frame regardless of all limitations.
@@ -579,6 +605,18 @@ public:
 	void resetFlags();
 	void sendState();
 
+	/// <summary>Set while at rest with the tick disabled.</summary>
+	bool dormant = false;
+	/// <summary>Gets set when the owner sends a State with every synced rest flag set.</summary>
+	bool sentAtRestState = false;
+	/// <summary>Bound to TransformUpdated on the synced component while dormant.</summary>
+	FDelegateHandle transformUpdatedHandle;
+	bool isAtRest();
+	bool hasSettledOnRestState();
+	void goDormant();
+	USceneComponent* getSceneComponentToSync();
+	void onSyncedTransformUpdated(USceneComponent* updatedComponent, EUpdateTransformFlags updateTransformFlags, ETeleportType teleport);
+
 	FVector latestReceivedVelocity;
 	FVector latestReceivedAngularVelocity;
 	bool sameVector(FVector one, FVector two, float threshold);
@@ -610,6 +648,8 @@ public:
 	void readFromBuffer(T* thing);
 
 	void SerializeState(SmoothState *sendingState);
+	/// <summary>Writes and reads the per axis part of States, kept in line with the sync modes and compression settings.</summary>
+	SmoothStateCodec stateCodec;
 	char encodeSyncInformation(bool sendPositionFlag, bool sendRotationFlag, bool sendScaleFlag, bool sendVelocityFlag, bool sendAngularVelocityFlag, bool atPositionalRestFlag, bool atRotationalRestFlag, bool sendMovementModeFlag);
 	bool shouldDeserializePosition(char syncInformation);
 	bool shouldDeserializeRotation(char syncInformation);
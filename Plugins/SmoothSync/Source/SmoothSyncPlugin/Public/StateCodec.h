@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class USmoothSync;
+class SmoothState;
+
+/// <summary>
+/// Writes and reads the position, rotation, scale, velocity and angular velocity part of a network State.
+/// </summary>
+/// <remarks>
+/// The sync modes and compression settings are resolved once into an encoder / decoder pair. Common
+/// configurations get a fully specialized pair, everything else goes through a table of per section functions.
+/// Both produce exactly the bytes the field by field serialization did, so older builds can still read them.
+/// </remarks>
+class SMOOTHSYNCPLUGIN_API SmoothStateCodec
+{
+public:
+	/// <summary>The sections of the body, these match the masks in the sync info byte.</summary>
+	enum Section : uint8
+	{
+		POSITION = 1,
+		ROTATION = 2,
+		SCALE = 4,
+		VELOCITY = 8,
+		ANGULAR_VELOCITY = 16,
+		ALL_SECTIONS = 31
+	};
+
+	static const int sectionCount = 5;
+	/// <summary>The largest possible body, every axis of every section uncompressed.</summary>
+	static const int maxBodySize = sectionCount * 3 * sizeof(float);
+
+	typedef uint8* (*EncodeFunction)(const SmoothStateCodec &codec, uint8 *buffer, const SmoothState *state, uint8 sections);
+	typedef const uint8* (*DecodeFunction)(const SmoothStateCodec &codec, const uint8 *buffer, SmoothState *state, uint8 sections);
+	typedef uint8* (*SectionEncodeFunction)(uint8 *buffer, const SmoothState *state);
+	typedef const uint8* (*SectionDecodeFunction)(const uint8 *buffer, SmoothState *state);
+
+	SmoothStateCodec();
+
+	/// <summary>Packs the sync modes and compression settings of a SmoothSync into a configuration key.</summary>
+	static uint32 getConfiguration(const USmoothSync *smoothSync);
+
+	/// <summary>Picks the encoder and decoder for a configuration. Does nothing if it is already the current one.</summary>
+	void setConfiguration(uint32 newConfiguration);
+
+	uint32 getCurrentConfiguration() const { return configuration; }
+
+	/// <summary>Whether the current configuration has its own encoder and decoder instead of the generic one.</summary>
+	bool isSpecialized() const { return specialized; }
+
+	/// <summary>The number of bytes the given sections take up with the current configuration.</summary>
+	int getBodySize(uint8 sections) const;
+
+	/// <summary>Writes the given sections of state to buffer and returns the end of what was written.</summary>
+	FORCEINLINE uint8* encode(uint8 *buffer, const SmoothState *state, uint8 sections) const
+	{
+		return encodeFunction(*this, buffer, state, sections);
+	}
+
+	/// <summary>Reads the given sections from buffer into state and returns the end of what was read.</summary>
+	/// <remarks>Sections that aren't in sections are left untouched on state.</remarks>
+	FORCEINLINE const uint8* decode(const uint8 *buffer, SmoothState *state, uint8 sections) const
+	{
+		return decodeFunction(*this, buffer, state, sections);
+	}
+
+private:
+	static uint8* encodeGeneric(const SmoothStateCodec &codec, uint8 *buffer, const SmoothState *state, uint8 sections);
+	static const uint8* decodeGeneric(const SmoothStateCodec &codec, const uint8 *buffer, SmoothState *state, uint8 sections);
+
+	uint32 configuration;
+	bool specialized;
+	EncodeFunction encodeFunction;
+	DecodeFunction decodeFunction;
+
+	/// <summary>Used by the generic encoder and decoder, one per section in sync info order.</summary>
+	SectionEncodeFunction sectionEncoders[sectionCount];
+	SectionDecodeFunction sectionDecoders[sectionCount];
+	uint8 sectionSizes[sectionCount];
+};
@@ -0,0 +1,524 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "OpenVRCameraStreamComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/Texture2D.h"
+#include "RenderUtils.h"
+#include "IXRTrackingSystem.h"
+#include "Misc/App.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/PlatformProcess.h"
+
+DECLARE_STATS_GROUP(TEXT("OpenVRCameraStream"), STATGROUP_OpenVRCameraStream, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("OpenVRCameraStream GameThread"), STAT_OpenVRCameraStream_GameThread, STATGROUP_OpenVRCameraStream);
+DECLARE_CYCLE_STAT(TEXT("OpenVRCameraStream ReadFrame"), STAT_OpenVRCameraStream_ReadFrame, STATGROUP_OpenVRCameraStream);
+
+#if STEAMVR_SUPPORTED_PLATFORM
+class FOpenVRRuntimeCameraFrameSource : public IOpenVRCameraFrameSource
+{
+public:
+
+	FOpenVRRuntimeCameraFrameSource() :
+		FrameType(vr::VRTrackedCameraFrameType_Distorted)
+	{}
+
+	virtual bool Open(EOpenVRCameraFrameType InFrameType, uint32 & OutWidth, uint32 & OutHeight) override
+	{
+		EBPOVRResultSwitch Result;
+		UOpenVRExpansionFunctionLibrary::AcquireVRCamera(CameraHandle, Result);
+
+		if (Result != EBPOVRResultSwitch::OnSucceeded)
+			return false;
+
+		vr::IVRTrackedCamera* VRCamera = vr::VRTrackedCamera();
+
+		if (!VRCamera)
+			return false;
+
+		FrameType = (vr::EVRTrackedCameraFrameType)InFrameType;
+
+		uint32 FrameBufferSize;
+		vr::EVRTrackedCameraError CamError = VRCamera->GetCameraFrameSize(vr::k_unTrackedDeviceIndex_Hmd, FrameType, &OutWidth, &OutHeight, &FrameBufferSize);
+
+		return CamError == vr::EVRTrackedCameraError::VRTrackedCameraError_None && FrameBufferSize == OutWidth * OutHeight * GPixelFormats[EPixelFormat::PF_R8G8B8A8].BlockBytes;
+	}
+
+	virtual void Close() override
+	{
+		if (CameraHandle.IsValid())
+		{
+			EBPOVRResultSwitch Result;
+			UOpenVRExpansionFunctionLibrary::ReleaseVRCamera(CameraHandle, Result);
+		}
+	}
+
+	virtual bool GetFrameHeader(FOpenVRCameraFrameHeader & OutHeader) override
+	{
+		// Null buffer only fills in the header
+		return ReadFrame(nullptr, 0, OutHeader);
+	}
+
+	virtual bool ReadFrame(uint8 * Buffer, uint32 BufferSize, FOpenVRCameraFrameHeader & OutHeader) override
+	{
+		vr::IVRTrackedCamera* VRCamera = vr::VRTrackedCamera();
+
+		if (!VRCamera)
+			return false;
+
+		vr::CameraVideoStreamFrameHeader_t CamHeader;
+		vr::EVRTrackedCameraError CamError = VRCamera->GetVideoStreamFrameBuffer(CameraHandle.pCameraHandle, FrameType, Buffer, BufferSize, &CamHeader, sizeof(vr::CameraVideoStreamFrameHeader_t));
+
+		// No frame available = still on spin / wake up
+		if (CamError != vr::EVRTrackedCameraError::VRTrackedCameraError_None)
+			return false;
+
+		OutHeader.FrameSequence = CamHeader.nFrameSequence;
+		OutHeader.Width = CamHeader.nWidth;
+		OutHeader.Height = CamHeader.nHeight;
+		OutHeader.ExposureTime = CamHeader.ulFrameExposureTime;
+		OutHeader.bPoseIsValid = CamHeader.standingTrackedDevicePose.bPoseIsValid;
+
+		if (OutHeader.bPoseIsValid)
+		{
+			// OpenVR space to UE4 space
+			FMatrix PoseMatrix = UOpenVRExpansionFunctionLibrary::ToFMatrix(CamHeader.standingTrackedDevicePose.mDeviceToAbsoluteTracking);
+			FQuat Orientation(PoseMatrix);
+			FVector Position = PoseMatrix.GetOrigin();
+
+			OutHeader.Pose.SetRotation(FQuat(-Orientation.Z, Orientation.X, Orientation.Y, -Orientation.W));
+			OutHeader.Pose.SetTranslation(FVector(-Position.Z, Position.X, Position.Y));
+		}
+
+		return true;
+	}
+
+private:
+
+	FBPOpenVRCameraHandle CameraHandle;
+	vr::EVRTrackedCameraFrameType FrameType;
+};
+#endif
+
+FOpenVRSyntheticCameraFrameSource::FOpenVRSyntheticCameraFrameSource(uint32 InWidth, uint32 InHeight, float InFrameRate, int32 InStallEveryNFrames, float InStallDuration) :
+	Width(InWidth),
+	Height(InHeight),
+	FrameRate(InFrameRate),
+	StallEveryNFrames(InStallEveryNFrames),
+	StallDuration(InStallDuration),
+	StartTime(0.0)
+{
+}
+
+bool FOpenVRSyntheticCameraFrameSource::Open(EOpenVRCameraFrameType FrameType, uint32 & OutWidth, uint32 & OutHeight)
+{
+	StartTime = FPlatformTime::Seconds();
+	OutWidth = Width;
+	OutHeight = Height;
+	return Width > 0 && Height > 0;
+}
+
+void FOpenVRSyntheticCameraFrameSource::Close()
+{
+}
+
+uint32 FOpenVRSyntheticCameraFrameSource::CurrentSequence() const
+{
+	if (FrameRate <= 0.0f)
+		return 1;
+
+	return (uint32)((FPlatformTime::Seconds() - StartTime) * FrameRate) + 1;
+}
+
+bool FOpenVRSyntheticCameraFrameSource::GetFrameHeader(FOpenVRCameraFrameHeader & OutHeader)
+{
+	OutHeader.FrameSequence = CurrentSequence();
+	OutHeader.Width = Width;
+	OutHeader.Height = Height;
+	OutHeader.ExposureTime = FrameRate > 0.0f ? (uint64)(OutHeader.FrameSequence * (1000000.0 / FrameRate)) : 0;
+	OutHeader.bPoseIsValid = true;
+	OutHeader.Pose = FTransform(FRotator(0.0f, (float)(OutHeader.FrameSequence % 360), 0.0f), FVector(0.0f, 0.0f, 1.7f));
+	return true;
+}
+
+bool FOpenVRSyntheticCameraFrameSource::ReadFrame(uint8 * Buffer, uint32 BufferSize, FOpenVRCameraFrameHeader & OutHeader)
+{
+	if (!Buffer || BufferSize < Width * Height * 4)
+		return false;
+
+	GetFrameHeader(OutHeader);
+
+	if (StallEveryNFrames > 0 && OutHeader.FrameSequence % StallEveryNFrames == 0)
+		FPlatformProcess::Sleep(StallDuration);
+
+	const uint32 Sequence = OutHeader.FrameSequence;
+	uint8 * Pixel = Buffer;
+
+	for (uint32 y = 0; y < Height; ++y)
+	{
+		for (uint32 x = 0; x < Width; ++x)
+		{
+			Pixel[0] = (uint8)(x + Sequence);
+			Pixel[1] = (uint8)(y + Sequence);
+			Pixel[2] = (uint8)Sequence;
+			Pixel[3] = 255;
+			Pixel += 4;
+		}
+	}
+
+	// So whoever is reading the frames can check that they come out in order
+	FMemory::Memcpy(Buffer, &Sequence, sizeof(uint32));
+	return true;
+}
+
+class FOpenVRCameraStreamWorker : public FRunnable
+{
+public:
+
+	FOpenVRCameraStreamWorker(TSharedPtr<IOpenVRCameraFrameSource, ESPMode::ThreadSafe> InSource, TSharedPtr<FOpenVRCameraStreamBuffers, ESPMode::ThreadSafe> InBuffers, float TargetFrameRate, EOpenVRCameraFrameDropPolicy InDropPolicy, float InPollInterval) :
+		Source(InSource),
+		Buffers(InBuffers),
+		MinFrameInterval(TargetFrameRate > 0.0f ? 1.0 / TargetFrameRate : 0.0),
+		DropPolicy(InDropPolicy),
+		PollInterval(FMath::Max(InPollInterval, 0.001f)),
+		Thread(nullptr)
+	{
+		Thread = FRunnableThread::Create(this, TEXT("OpenVRCameraStream"), 0, TPri_Normal);
+	}
+
+	~FOpenVRCameraStreamWorker()
+	{
+		if (Thread)
+		{
+			// Calls Stop and waits for Run to return
+			Thread->Kill(true);
+			delete Thread;
+			Thread = nullptr;
+		}
+	}
+
+	virtual uint32 Run() override
+	{
+		bool bHasFrame = false;
+		uint32 LastSequence = 0;
+		double NextReadTime = 0.0;
+
+		while (!bStopping)
+		{
+			FOpenVRCameraFrameHeader Header;
+			if (!Source->GetFrameHeader(Header) || (bHasFrame && Header.FrameSequence == LastSequence) || FPlatformTime::Seconds() < NextReadTime)
+			{
+				FPlatformProcess::Sleep(PollInterval);
+				continue;
+			}
+
+			int32 SlotIndex = AcquireSlot();
+
+			if (SlotIndex == INDEX_NONE)
+			{
+				// Everything is waiting on the game or render thread, this frame is lost
+				Buffers->FramesDropped.Increment();
+				bHasFrame = true;
+				LastSequence = Header.FrameSequence;
+				FPlatformProcess::Sleep(PollInterval);
+				continue;
+			}
+
+			// The slot is ours until it is marked ready so the pixels are written outside of the lock
+			FOpenVRCameraStreamBuffers::FSlot & Slot = Buffers->Slots[SlotIndex];
+			FOpenVRCameraFrameHeader ReadHeader;
+			bool bRead = false;
+			{
+				SCOPE_CYCLE_COUNTER(STAT_OpenVRCameraStream_ReadFrame);
+				bRead = Source->ReadFrame(Slot.Pixels.GetData(), Slot.Pixels.Num(), ReadHeader);
+			}
+
+			FScopeLock Lock(&Buffers->SlotLock);
+
+			if (!bRead || (bHasFrame && ReadHeader.FrameSequence == LastSequence))
+			{
+				Slot.State = FOpenVRCameraStreamBuffers::ESlotState::Free;
+				continue;
+			}
+
+			// Frames skipped to hold the target rate are on purpose and aren't counted
+			if (bHasFrame && MinFrameInterval <= 0.0 && ReadHeader.FrameSequence > LastSequence + 1)
+				Buffers->FramesDropped.Add(ReadHeader.FrameSequence - LastSequence - 1);
+
+			// Only the newest finished frame waits for the game thread
+			for (FOpenVRCameraStreamBuffers::FSlot & OtherSlot : Buffers->Slots)
+			{
+				if (OtherSlot.State == FOpenVRCameraStreamBuffers::ESlotState::Ready)
+				{
+					OtherSlot.State = FOpenVRCameraStreamBuffers::ESlotState::Free;
+					Buffers->FramesDropped.Increment();
+				}
+			}
+
+			Slot.Header = ReadHeader;
+			Slot.State = FOpenVRCameraStreamBuffers::ESlotState::Ready;
+			Buffers->FramesReceived.Increment();
+
+			bHasFrame = true;
+			LastSequence = ReadHeader.FrameSequence;
+			NextReadTime = FPlatformTime::Seconds() + MinFrameInterval;
+		}
+
+		return 0;
+	}
+
+	virtual void Stop() override
+	{
+		bStopping = true;
+	}
+
+private:
+
+	int32 AcquireSlot()
+	{
+		FScopeLock Lock(&Buffers->SlotLock);
+
+		int32 ReadySlot = INDEX_NONE;
+		for (int32 i = 0; i < Buffers->Slots.Num(); ++i)
+		{
+			FOpenVRCameraStreamBuffers::FSlot & Slot = Buffers->Slots[i];
+
+			if (Slot.State == FOpenVRCameraStreamBuffers::ESlotState::Free)
+			{
+				Slot.State = FOpenVRCameraStreamBuffers::ESlotState::Writing;
+				return i;
+			}
+			else if (Slot.State == FOpenVRCameraStreamBuffers::ESlotState::Ready)
+			{
+				ReadySlot = i;
+			}
+		}
+
+		if (DropPolicy == EOpenVRCameraFrameDropPolicy::KeepLatest && ReadySlot != INDEX_NONE)
+		{
+			Buffers->Slots[ReadySlot].State = FOpenVRCameraStreamBuffers::ESlotState::Writing;
+			Buffers->FramesDropped.Increment();
+			return ReadySlot;
+		}
+
+		return INDEX_NONE;
+	}
+
+	TSharedPtr<IOpenVRCameraFrameSource, ESPMode::ThreadSafe> Source;
+	TSharedPtr<FOpenVRCameraStreamBuffers, ESPMode::ThreadSafe> Buffers;
+	double MinFrameInterval;
+	EOpenVRCameraFrameDropPolicy DropPolicy;
+	float PollInterval;
+	FThreadSafeBool bStopping;
+	FRunnableThread * Thread;
+};
+
+//=============================================================================
+UOpenVRCameraStreamComponent::UOpenVRCameraStreamComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.TickGroup = TG_PrePhysics;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+
+	FrameType = EOpenVRCameraFrameType::VRFrameType_Distorted;
+	TargetFrameRate = 0.0f;
+	DropPolicy = EOpenVRCameraFrameDropPolicy::KeepLatest;
+	NumStagingBuffers = 2;
+	PollInterval = 0.002f;
+	bAutoStartStreaming = false;
+
+	CameraTexture = nullptr;
+	NumFramesDisplayed = 0;
+	Worker = nullptr;
+}
+
+void UOpenVRCameraStreamComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (bAutoStartStreaming)
+	{
+		EBPOVRResultSwitch Result;
+		StartStreaming(Result);
+	}
+}
+
+void UOpenVRCameraStreamComponent::OnUnregister()
+{
+	StopStreaming();
+	Super::OnUnregister();
+}
+
+void UOpenVRCameraStreamComponent::SetFrameSource(TSharedPtr<IOpenVRCameraFrameSource, ESPMode::ThreadSafe> NewSource)
+{
+	FrameSource = NewSource;
+}
+
+bool UOpenVRCameraStreamComponent::IsStreaming() const
+{
+	return Worker != nullptr;
+}
+
+void UOpenVRCameraStreamComponent::GetFrameStats(int32 & FramesReceived, int32 & FramesDropped, int32 & FramesDisplayed) const
+{
+	FramesReceived = Buffers.IsValid() ? Buffers->FramesReceived.GetValue() : 0;
+	FramesDropped = Buffers.IsValid() ? Buffers->FramesDropped.GetValue() : 0;
+	FramesDisplayed = NumFramesDisplayed;
+}
+
+void UOpenVRCameraStreamComponent::StartStreaming(EBPOVRResultSwitch & Result)
+{
+	if (IsStreaming())
+	{
+		Result = EBPOVRResultSwitch::OnSucceeded;
+		return;
+	}
+
+	Result = EBPOVRResultSwitch::OnFailed;
+
+	ActiveSource = FrameSource;
+
+#if STEAMVR_SUPPORTED_PLATFORM
+	if (!ActiveSource.IsValid())
+	{
+		// Don't run anything if no HMD and if the HMD is not a steam type
+		if (!GEngine->XRSystem.IsValid() || (GEngine->XRSystem->GetSystemName() != SteamVRSystemName))
+			return;
+
+		ActiveSource = MakeShared<FOpenVRRuntimeCameraFrameSource, ESPMode::ThreadSafe>();
+	}
+#endif
+
+	if (!ActiveSource.IsValid())
+		return;
+
+	uint32 Width = 0;
+	uint32 Height = 0;
+	if (!ActiveSource->Open(FrameType, Width, Height) || Width == 0 || Height == 0)
+	{
+		ActiveSource->Close();
+		ActiveSource.Reset();
+		return;
+	}
+
+	Buffers = MakeShared<FOpenVRCameraStreamBuffers, ESPMode::ThreadSafe>();
+	Buffers->Slots.SetNum(FMath::Clamp(NumStagingBuffers, 2, 4));
+
+	for (FOpenVRCameraStreamBuffers::FSlot & Slot : Buffers->Slots)
+	{
+		Slot.Pixels.SetNumUninitialized(Width * Height * GPixelFormats[EPixelFormat::PF_R8G8B8A8].BlockBytes);
+	}
+
+	// Without rendering the frames are still streamed and counted, there is just nothing to upload them to
+	if (FApp::CanEverRender() && (!CameraTexture || CameraTexture->GetSizeX() != Width || CameraTexture->GetSizeY() != Height))
+	{
+		CameraTexture = UTexture2D::CreateTransient(Width, Height, EPixelFormat::PF_R8G8B8A8);
+
+		if (CameraTexture)
+		{
+			CameraTexture->PlatformData->NumSlices = 1;
+			CameraTexture->NeverStream = true;
+			CameraTexture->UpdateResource();
+		}
+	}
+
+	NumFramesDisplayed = 0;
+	LatestFrameInfo = FBPOpenVRCameraFrameInfo();
+	LatestFrameHeader = FOpenVRCameraFrameHeader();
+
+	Worker = new FOpenVRCameraStreamWorker(ActiveSource, Buffers, TargetFrameRate, DropPolicy, PollInterval);
+	this->SetComponentTickEnabled(true);
+	Result = EBPOVRResultSwitch::OnSucceeded;
+}
+
+void UOpenVRCameraStreamComponent::StopStreaming()
+{
+	if (Worker)
+	{
+		delete Worker;
+		Worker = nullptr;
+	}
+
+	if (ActiveSource.IsValid())
+	{
+		ActiveSource->Close();
+		ActiveSource.Reset();
+	}
+
+	// Any queued texture updates hold their own reference
+	Buffers.Reset();
+	this->SetComponentTickEnabled(false);
+}
+
+void UOpenVRCameraStreamComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	SCOPE_CYCLE_COUNTER(STAT_OpenVRCameraStream_GameThread);
+
+	if (!Buffers.IsValid())
+		return;
+
+	int32 ReadySlot = INDEX_NONE;
+	{
+		FScopeLock Lock(&Buffers->SlotLock);
+
+		for (int32 i = 0; i < Buffers->Slots.Num(); ++i)
+		{
+			if (Buffers->Slots[i].State == FOpenVRCameraStreamBuffers::ESlotState::Ready)
+			{
+				ReadySlot = i;
+				break;
+			}
+		}
+
+		if (ReadySlot == INDEX_NONE)
+			return;
+
+		FOpenVRCameraStreamBuffers::FSlot & Slot = Buffers->Slots[ReadySlot];
+		LatestFrameHeader = Slot.Header;
+
+		// Nothing to upload to, hand the buffer straight back
+		Slot.State = (CameraTexture && CameraTexture->Resource) ? FOpenVRCameraStreamBuffers::ESlotState::Uploading : FOpenVRCameraStreamBuffers::ESlotState::Free;
+	}
+
+	++NumFramesDisplayed;
+
+	const float WorldToMetersScale = GetWorld() ? GetWorld()->GetWorldSettings()->WorldToMeters : 100.0f;
+
+	LatestFrameInfo.FrameSequence = (int32)LatestFrameHeader.FrameSequence;
+	LatestFrameInfo.Width = (int32)LatestFrameHeader.Width;
+	LatestFrameInfo.Height = (int32)LatestFrameHeader.Height;
+	LatestFrameInfo.bPoseIsValid = LatestFrameHeader.bPoseIsValid;
+	LatestFrameInfo.Pose = LatestFrameHeader.Pose;
+	LatestFrameInfo.Pose.ScaleTranslation(WorldToMetersScale);
+	LatestFrameInfo.ExposureTime = (float)(LatestFrameHeader.ExposureTime / 1000000.0);
+
+	if (CameraTexture && CameraTexture->Resource)
+	{
+		FTextureResource * TextureResource = CameraTexture->Resource;
+		TSharedPtr<FOpenVRCameraStreamBuffers, ESPMode::ThreadSafe> UploadBuffers = Buffers;
+		// The texture was created at the size the staging buffers were allocated for
+		const uint32 UploadWidth = CameraTexture->GetSizeX();
+		const uint32 UploadHeight = CameraTexture->GetSizeY();
+
+		ENQUEUE_RENDER_COMMAND(OpenVRCameraStream_UpdateTexture)(
+			[TextureResource, UploadBuffers, ReadySlot, UploadWidth, UploadHeight](FRHICommandListImmediate& RHICmdList)
+		{
+			FOpenVRCameraStreamBuffers::FSlot & Slot = UploadBuffers->Slots[ReadySlot];
+			FTexture2DRHIRef TextureRHI = ((FTexture2DResource*)TextureResource)->GetTexture2DRHI();
+
+			if (TextureRHI.IsValid() && UploadWidth > 0 && UploadHeight > 0)
+			{
+				FUpdateTextureRegion2D Region(0, 0, 0, 0, UploadWidth, UploadHeight);
+				RHIUpdateTexture2D(TextureRHI, 0, Region, UploadWidth * GPixelFormats[EPixelFormat::PF_R8G8B8A8].BlockBytes, Slot.Pixels.GetData());
+			}
+
+			FScopeLock Lock(&UploadBuffers->SlotLock);
+			Slot.State = FOpenVRCameraStreamBuffers::ESlotState::Free;
+		});
+	}
+
+	OnCameraFrameUpdated.Broadcast(LatestFrameInfo);
+}
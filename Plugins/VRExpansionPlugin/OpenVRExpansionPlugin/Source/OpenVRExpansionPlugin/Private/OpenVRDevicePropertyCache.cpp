@@ -0,0 +1,658 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+#include "OpenVRDevicePropertyCache.h"
+#include "OpenVRExpansionFunctionLibrary.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "CoreGlobals.h"
+
+namespace OpenVRDevicePropertyCacheCVars
+{
+	static float ConnectionPollInterval = 0.5f;
+	FAutoConsoleVariableRef CVarConnectionPollInterval(
+		TEXT("vr.OpenVR.DeviceConnectionPollInterval"),
+		ConnectionPollInterval,
+		TEXT("Seconds between sweeps of the OpenVR device slots for connections, disconnections and class changes.\n")
+		TEXT("Source events and Invalidate() update the connection state right away, the sweep catches what has no event.\n")
+		TEXT("0: Sweep once a frame so connection state and device lists are never older than the current frame\n")
+		TEXT(">0: Sweep less often, connection state and device lists can be up to this old (default 0.5)"),
+		ECVF_Default);
+
+	static float VolatilePropertyRefreshInterval = 1.0f;
+	FAutoConsoleVariableRef CVarVolatilePropertyRefreshInterval(
+		TEXT("vr.OpenVR.VolatilePropertyRefreshInterval"),
+		VolatilePropertyRefreshInterval,
+		TEXT("Seconds that bool and float properties (battery, charging, IPD, display frequency and the like), the role hint, watched properties and failed lookups are cached for before being fetched again."),
+		ECVF_Default);
+}
+
+// Raw vr::ETrackedDeviceProperty / vr::ETrackedDeviceClass values, kept here so that the cache doesn't need the OpenVR headers
+namespace OpenVRDevicePropertyIds
+{
+	static const int32 DeviceIsCharging = 1011;
+	static const int32 DeviceBatteryPercentage = 1012;
+	static const int32 ControllerRoleHint = 3007;
+
+	static const uint8 ClassController = 2;
+	static const uint8 ClassGenericTracker = 3;
+}
+
+#if STEAMVR_SUPPORTED_PLATFORM
+class FOpenVRRuntimeDevicePropertySource : public IOpenVRDevicePropertySource
+{
+public:
+
+	virtual bool IsAvailable() override
+	{
+		return vr::VRSystem() != nullptr;
+	}
+
+	virtual int32 GetMaxDeviceCount() override
+	{
+		return vr::k_unMaxTrackedDeviceCount;
+	}
+
+	virtual bool IsDeviceConnected(int32 DeviceIndex) override
+	{
+		vr::IVRSystem* VRSystem = vr::VRSystem();
+		return VRSystem && VRSystem->IsTrackedDeviceConnected(DeviceIndex);
+	}
+
+	virtual uint8 GetDeviceClass(int32 DeviceIndex) override
+	{
+		vr::IVRSystem* VRSystem = vr::VRSystem();
+		return VRSystem ? (uint8)VRSystem->GetTrackedDeviceClass(DeviceIndex) : (uint8)vr::TrackedDeviceClass_Invalid;
+	}
+
+	virtual bool GetStringProperty(int32 DeviceIndex, int32 PropertyId, FString & OutValue) override
+	{
+		vr::IVRSystem* VRSystem = vr::VRSystem();
+		if (!VRSystem)
+			return false;
+
+		vr::TrackedPropertyError pError = vr::TrackedPropertyError::TrackedProp_Success;
+		char charvalue[vr::k_unMaxPropertyStringSize];
+		VRSystem->GetStringTrackedDeviceProperty(DeviceIndex, (vr::ETrackedDeviceProperty)PropertyId, charvalue, vr::k_unMaxPropertyStringSize, &pError);
+
+		if (pError != vr::TrackedPropertyError::TrackedProp_Success)
+			return false;
+
+		OutValue = FString(ANSI_TO_TCHAR(charvalue));
+		return true;
+	}
+
+	virtual bool GetBoolProperty(int32 DeviceIndex, int32 PropertyId, bool & OutValue) override
+	{
+		vr::IVRSystem* VRSystem = vr::VRSystem();
+		if (!VRSystem)
+			return false;
+
+		vr::TrackedPropertyError pError = vr::TrackedPropertyError::TrackedProp_Success;
+		OutValue = VRSystem->GetBoolTrackedDeviceProperty(DeviceIndex, (vr::ETrackedDeviceProperty)PropertyId, &pError);
+		return pError == vr::TrackedPropertyError::TrackedProp_Success;
+	}
+
+	virtual bool GetFloatProperty(int32 DeviceIndex, int32 PropertyId, float & OutValue) override
+	{
+		vr::IVRSystem* VRSystem = vr::VRSystem();
+		if (!VRSystem)
+			return false;
+
+		vr::TrackedPropertyError pError = vr::TrackedPropertyError::TrackedProp_Success;
+		OutValue = VRSystem->GetFloatTrackedDeviceProperty(DeviceIndex, (vr::ETrackedDeviceProperty)PropertyId, &pError);
+		return pError == vr::TrackedPropertyError::TrackedProp_Success;
+	}
+
+	virtual bool GetInt32Property(int32 DeviceIndex, int32 PropertyId, int32 & OutValue) override
+	{
+		vr::IVRSystem* VRSystem = vr::VRSystem();
+		if (!VRSystem)
+			return false;
+
+		vr::TrackedPropertyError pError = vr::TrackedPropertyError::TrackedProp_Success;
+		OutValue = VRSystem->GetInt32TrackedDeviceProperty(DeviceIndex, (vr::ETrackedDeviceProperty)PropertyId, &pError);
+		return pError == vr::TrackedPropertyError::TrackedProp_Success;
+	}
+
+	virtual bool GetUInt64Property(int32 DeviceIndex, int32 PropertyId, uint64 & OutValue) override
+	{
+		vr::IVRSystem* VRSystem = vr::VRSystem();
+		if (!VRSystem)
+			return false;
+
+		vr::TrackedPropertyError pError = vr::TrackedPropertyError::TrackedProp_Success;
+		OutValue = VRSystem->GetUint64TrackedDeviceProperty(DeviceIndex, (vr::ETrackedDeviceProperty)PropertyId, &pError);
+		return pError == vr::TrackedPropertyError::TrackedProp_Success;
+	}
+
+	virtual bool GetMatrix34Property(int32 DeviceIndex, int32 PropertyId, FMatrix & OutValue) override
+	{
+		vr::IVRSystem* VRSystem = vr::VRSystem();
+		if (!VRSystem)
+			return false;
+
+		vr::TrackedPropertyError pError = vr::TrackedPropertyError::TrackedProp_Success;
+		vr::HmdMatrix34_t ret = VRSystem->GetMatrix34TrackedDeviceProperty(DeviceIndex, (vr::ETrackedDeviceProperty)PropertyId, &pError);
+
+		if (pError != vr::TrackedPropertyError::TrackedProp_Success)
+			return false;
+
+		OutValue = UOpenVRExpansionFunctionLibrary::ToFMatrix(ret);
+		return true;
+	}
+};
+#endif
+
+bool FOpenVRDevicePropertyCache::FCachedProperty::ValueEquals(const FCachedProperty & Other) const
+{
+	if (Type != Other.Type || bSucceeded != Other.bSucceeded)
+		return false;
+
+	if (!bSucceeded)
+		return true;
+
+	switch (Type)
+	{
+	case EPropertyType::String: return StringValue.Equals(Other.StringValue, ESearchCase::CaseSensitive);
+	case EPropertyType::Matrix34: return MatrixValue.Equals(Other.MatrixValue, 0.0f);
+	default: return ScalarValue == Other.ScalarValue;
+	}
+}
+
+FOpenVRDevicePropertyCache & FOpenVRDevicePropertyCache::Get()
+{
+	static FOpenVRDevicePropertyCache Singleton;
+	return Singleton;
+}
+
+FOpenVRDevicePropertyCache::FOpenVRDevicePropertyCache() :
+	LastSweepTime(0.0),
+	LastSweepFrame(MAX_uint64),
+	LastWatchRefreshTime(0.0),
+	bWasAvailable(false),
+	bSweepRequested(false),
+	bIsShutdown(false)
+{
+	TickHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FOpenVRDevicePropertyCache::Tick), 0.0f);
+}
+
+bool FOpenVRDevicePropertyCache::Tick(float DeltaTime)
+{
+	Update();
+	return true;
+}
+
+bool FOpenVRDevicePropertyCache::EnsureSource()
+{
+	if (bIsShutdown)
+		return false;
+
+#if STEAMVR_SUPPORTED_PLATFORM
+	if (!Source.IsValid())
+		Source = MakeShareable(new FOpenVRRuntimeDevicePropertySource());
+#endif
+
+	return Source.IsValid();
+}
+
+bool FOpenVRDevicePropertyCache::IsAvailable()
+{
+	Update();
+	return bWasAvailable;
+}
+
+void FOpenVRDevicePropertyCache::Update(bool bForceSweep)
+{
+	if (!EnsureSource())
+		return;
+
+	if (!Source->IsAvailable())
+	{
+		// Everything went away with the runtime
+		if (bWasAvailable)
+		{
+			bWasAvailable = false;
+
+			TArray<int32> Disconnected;
+			for (int32 i = 0; i < Devices.Num(); ++i)
+			{
+				if (Devices[i].bConnected)
+					Disconnected.Add(i);
+			}
+
+			ResetDevices();
+
+			for (int32 DeviceIndex : Disconnected)
+			{
+				OnDeviceConnectionChanged.Broadcast(DeviceIndex, false);
+			}
+		}
+
+		return;
+	}
+
+	if (!bWasAvailable || bSweepRequested)
+	{
+		bWasAvailable = true;
+		bSweepRequested = false;
+		bForceSweep = true;
+	}
+
+	ProcessEvents();
+
+	const double CurrentTime = FPlatformTime::Seconds();
+
+	const bool bSweepDue = OpenVRDevicePropertyCacheCVars::ConnectionPollInterval > 0.0f ?
+		CurrentTime - LastSweepTime >= OpenVRDevicePropertyCacheCVars::ConnectionPollInterval :
+		LastSweepFrame != GFrameCounter;
+
+	if (bForceSweep || bSweepDue)
+		SweepConnections();
+
+	if (WatchedProperties.Num() && CurrentTime - LastWatchRefreshTime >= OpenVRDevicePropertyCacheCVars::VolatilePropertyRefreshInterval)
+		RefreshWatchedProperties();
+}
+
+void FOpenVRDevicePropertyCache::SweepConnections()
+{
+	LastSweepTime = FPlatformTime::Seconds();
+	LastSweepFrame = GFrameCounter;
+
+	const int32 MaxDevices = FMath::Max(Source->GetMaxDeviceCount(), 0);
+	if (Devices.Num() != MaxDevices)
+		Devices.SetNum(MaxDevices);
+
+	TArray<int32> Connected;
+	TArray<int32> Disconnected;
+	bool bClassesChanged = false;
+
+	for (int32 i = 0; i < MaxDevices; ++i)
+	{
+		FDeviceEntry & Device = Devices[i];
+		const bool bConnected = Source->IsDeviceConnected(i);
+		const uint8 DeviceClass = Source->GetDeviceClass(i);
+
+		if (bConnected != Device.bConnected || DeviceClass != Device.DeviceClass)
+		{
+			// Whatever is in the slot now isn't what we cached properties for
+			Device.Properties.Reset();
+			bClassesChanged |= DeviceClass != Device.DeviceClass;
+
+			if (bConnected != Device.bConnected)
+				(bConnected ? Connected : Disconnected).Add(i);
+
+			Device.bConnected = bConnected;
+			Device.DeviceClass = DeviceClass;
+		}
+	}
+
+	if (bClassesChanged || !DevicesByClass.Num())
+		RebuildClassIndex();
+
+	for (int32 DeviceIndex : Disconnected)
+	{
+		OnDeviceConnectionChanged.Broadcast(DeviceIndex, false);
+	}
+
+	for (int32 DeviceIndex : Connected)
+	{
+		OnDeviceConnectionChanged.Broadcast(DeviceIndex, true);
+	}
+}
+
+void FOpenVRDevicePropertyCache::ProcessEvents()
+{
+	TArray<FOpenVRDeviceEvent> Events;
+	Source->PollEvents(Events);
+
+	if (!Events.Num())
+		return;
+
+	if (Devices.Num() != Source->GetMaxDeviceCount())
+		Devices.SetNum(FMath::Max(Source->GetMaxDeviceCount(), 0));
+
+	for (const FOpenVRDeviceEvent & Event : Events)
+	{
+		if (!Devices.IsValidIndex(Event.DeviceIndex))
+			continue;
+
+		FDeviceEntry & Device = Devices[Event.DeviceIndex];
+
+		switch (Event.Type)
+		{
+		case EOpenVRDeviceEventType::Connected:
+		case EOpenVRDeviceEventType::Disconnected:
+		{
+			const bool bConnected = Event.Type == EOpenVRDeviceEventType::Connected;
+			Device.Properties.Reset();
+			Device.DeviceClass = Source->GetDeviceClass(Event.DeviceIndex);
+			RebuildClassIndex();
+
+			if (Device.bConnected != bConnected)
+			{
+				Device.bConnected = bConnected;
+				OnDeviceConnectionChanged.Broadcast(Event.DeviceIndex, bConnected);
+			}
+		}break;
+		case EOpenVRDeviceEventType::PropertyChanged:
+		{
+			FCachedProperty * Cached = Device.Properties.Find(Event.PropertyId);
+			if (!Cached)
+				break;
+
+			if (WatchedProperties.Contains(Event.PropertyId))
+			{
+				FCachedProperty Fresh;
+				Fetch(Event.DeviceIndex, Event.PropertyId, Cached->Type, Fresh);
+				const bool bChanged = !Fresh.ValueEquals(*Cached);
+				*Cached = Fresh;
+
+				if (bChanged)
+					OnPropertyChanged.Broadcast(Event.DeviceIndex, Event.PropertyId);
+			}
+			else
+			{
+				Device.Properties.Remove(Event.PropertyId);
+			}
+		}break;
+		}
+	}
+}
+
+void FOpenVRDevicePropertyCache::RefreshWatchedProperties()
+{
+	LastWatchRefreshTime = FPlatformTime::Seconds();
+
+	for (int32 i = 0; i < Devices.Num(); ++i)
+	{
+		FDeviceEntry & Device = Devices[i];
+		if (!Device.bConnected)
+			continue;
+
+		for (const TPair<int32, int32> & Watch : WatchedProperties)
+		{
+			// Only ones that have been read once, there is nothing to compare against otherwise
+			FCachedProperty * Cached = Device.Properties.Find(Watch.Key);
+			if (!Cached)
+				continue;
+
+			FCachedProperty Fresh;
+			Fetch(i, Watch.Key, Cached->Type, Fresh);
+			const bool bChanged = !Fresh.ValueEquals(*Cached);
+			*Cached = Fresh;
+
+			if (bChanged)
+				OnPropertyChanged.Broadcast(i, Watch.Key);
+		}
+	}
+}
+
+void FOpenVRDevicePropertyCache::RebuildClassIndex()
+{
+	DevicesByClass.Reset();
+
+	for (int32 i = 0; i < Devices.Num(); ++i)
+	{
+		if (Devices[i].DeviceClass != 0)
+			DevicesByClass.FindOrAdd(Devices[i].DeviceClass).Add(i);
+	}
+}
+
+void FOpenVRDevicePropertyCache::ResetDevices()
+{
+	Devices.Reset();
+	DevicesByClass.Reset();
+	LastSweepTime = 0.0;
+	LastSweepFrame = MAX_uint64;
+}
+
+bool FOpenVRDevicePropertyCache::IsVolatileProperty(int32 PropertyId, EPropertyType Type)
+{
+	// Bools and floats are where the runtime state lives (IPD, display frequency, photon latency, head to eye depth, presence flags),
+	// there is no event to catch them changing so they are all treated as volatile
+	if (Type == EPropertyType::Bool || Type == EPropertyType::Float)
+		return true;
+
+	return PropertyId == OpenVRDevicePropertyIds::DeviceIsCharging ||
+		PropertyId == OpenVRDevicePropertyIds::DeviceBatteryPercentage ||
+		PropertyId == OpenVRDevicePropertyIds::ControllerRoleHint;
+}
+
+bool FOpenVRDevicePropertyCache::IsStale(int32 PropertyId, const FCachedProperty & Property, double CurrentTime) const
+{
+	// Failed lookups are retried as devices don't always have everything filled in right as they connect
+	if (!Property.bSucceeded || IsVolatileProperty(PropertyId, Property.Type) || WatchedProperties.Contains(PropertyId))
+		return CurrentTime - Property.FetchTime >= OpenVRDevicePropertyCacheCVars::VolatilePropertyRefreshInterval;
+
+	return false;
+}
+
+bool FOpenVRDevicePropertyCache::Fetch(int32 DeviceIndex, int32 PropertyId, EPropertyType Type, FCachedProperty & OutProperty)
+{
+	OutProperty.Type = Type;
+	OutProperty.FetchTime = FPlatformTime::Seconds();
+	OutProperty.ScalarValue = 0;
+
+	switch (Type)
+	{
+	case EPropertyType::String:
+	{
+		OutProperty.bSucceeded = Source->GetStringProperty(DeviceIndex, PropertyId, OutProperty.StringValue);
+	}break;
+	case EPropertyType::Bool:
+	{
+		bool Value = false;
+		OutProperty.bSucceeded = Source->GetBoolProperty(DeviceIndex, PropertyId, Value);
+		OutProperty.ScalarValue = Value ? 1 : 0;
+	}break;
+	case EPropertyType::Float:
+	{
+		float Value = 0.0f;
+		OutProperty.bSucceeded = Source->GetFloatProperty(DeviceIndex, PropertyId, Value);
+		FMemory::Memcpy(&OutProperty.ScalarValue, &Value, sizeof(float));
+	}break;
+	case EPropertyType::Int32:
+	{
+		int32 Value = 0;
+		OutProperty.bSucceeded = Source->GetInt32Property(DeviceIndex, PropertyId, Value);
+		FMemory::Memcpy(&OutProperty.ScalarValue, &Value, sizeof(int32));
+	}break;
+	case EPropertyType::UInt64:
+	{
+		OutProperty.bSucceeded = Source->GetUInt64Property(DeviceIndex, PropertyId, OutProperty.ScalarValue);
+	}break;
+	case EPropertyType::Matrix34:
+	{
+		OutProperty.MatrixValue = FMatrix::Identity;
+		OutProperty.bSucceeded = Source->GetMatrix34Property(DeviceIndex, PropertyId, OutProperty.MatrixValue);
+	}break;
+	}
+
+	return OutProperty.bSucceeded;
+}
+
+const FOpenVRDevicePropertyCache::FCachedProperty * FOpenVRDevicePropertyCache::FindOrFetch(int32 DeviceIndex, int32 PropertyId, EPropertyType Type)
+{
+	Update();
+
+	if (!bWasAvailable || !Devices.IsValidIndex(DeviceIndex))
+		return nullptr;
+
+	FDeviceEntry & Device = Devices[DeviceIndex];
+	FCachedProperty * Cached = Device.Properties.Find(PropertyId);
+
+	if (Cached && Cached->Type == Type && !IsStale(PropertyId, *Cached, FPlatformTime::Seconds()))
+		return Cached;
+
+	FCachedProperty & Entry = Device.Properties.FindOrAdd(PropertyId);
+	Fetch(DeviceIndex, PropertyId, Type, Entry);
+	return &Entry;
+}
+
+bool FOpenVRDevicePropertyCache::IsDeviceConnected(int32 DeviceIndex)
+{
+	Update();
+	return Devices.IsValidIndex(DeviceIndex) && Devices[DeviceIndex].bConnected;
+}
+
+uint8 FOpenVRDevicePropertyCache::GetDeviceClass(int32 DeviceIndex)
+{
+	Update();
+	return Devices.IsValidIndex(DeviceIndex) ? Devices[DeviceIndex].DeviceClass : 0;
+}
+
+void FOpenVRDevicePropertyCache::GetDevices(TArray<int32> & OutDeviceIndexes)
+{
+	Update();
+
+	for (int32 i = 0; i < Devices.Num(); ++i)
+	{
+		if (Devices[i].DeviceClass != 0)
+			OutDeviceIndexes.Add(i);
+	}
+}
+
+void FOpenVRDevicePropertyCache::GetDevicesByClass(uint8 DeviceClass, TArray<int32> & OutDeviceIndexes)
+{
+	Update();
+
+	if (const TArray<int32> * Indexes = DevicesByClass.Find(DeviceClass))
+		OutDeviceIndexes.Append(*Indexes);
+}
+
+void FOpenVRDevicePropertyCache::GetDevicesByRole(int32 RoleHint, TArray<int32> & OutDeviceIndexes)
+{
+	Update();
+
+	// Copied out first, fetching a property runs Update() which can rebuild the class index or reset the devices
+	// and broadcasts can call back into the cache
+	TArray<int32, TInlineAllocator<16>> Candidates;
+	for (uint8 DeviceClass : { OpenVRDevicePropertyIds::ClassController, OpenVRDevicePropertyIds::ClassGenericTracker })
+	{
+		if (const TArray<int32> * Indexes = DevicesByClass.Find(DeviceClass))
+			Candidates.Append(*Indexes);
+	}
+
+	for (int32 DeviceIndex : Candidates)
+	{
+		int32 DeviceRole = 0;
+		if (GetInt32Property(DeviceIndex, OpenVRDevicePropertyIds::ControllerRoleHint, DeviceRole) && DeviceRole == RoleHint)
+			OutDeviceIndexes.Add(DeviceIndex);
+	}
+
+	OutDeviceIndexes.Sort();
+}
+
+bool FOpenVRDevicePropertyCache::GetStringProperty(int32 DeviceIndex, int32 PropertyId, FString & OutValue)
+{
+	const FCachedProperty * Cached = FindOrFetch(DeviceIndex, PropertyId, EPropertyType::String);
+	if (!Cached || !Cached->bSucceeded)
+		return false;
+
+	OutValue = Cached->StringValue;
+	return true;
+}
+
+bool FOpenVRDevicePropertyCache::GetBoolProperty(int32 DeviceIndex, int32 PropertyId, bool & OutValue)
+{
+	const FCachedProperty * Cached = FindOrFetch(DeviceIndex, PropertyId, EPropertyType::Bool);
+	if (!Cached || !Cached->bSucceeded)
+		return false;
+
+	OutValue = Cached->ScalarValue != 0;
+	return true;
+}
+
+bool FOpenVRDevicePropertyCache::GetFloatProperty(int32 DeviceIndex, int32 PropertyId, float & OutValue)
+{
+	const FCachedProperty * Cached = FindOrFetch(DeviceIndex, PropertyId, EPropertyType::Float);
+	if (!Cached || !Cached->bSucceeded)
+		return false;
+
+	FMemory::Memcpy(&OutValue, &Cached->ScalarValue, sizeof(float));
+	return true;
+}
+
+bool FOpenVRDevicePropertyCache::GetInt32Property(int32 DeviceIndex, int32 PropertyId, int32 & OutValue)
+{
+	const FCachedProperty * Cached = FindOrFetch(DeviceIndex, PropertyId, EPropertyType::Int32);
+	if (!Cached || !Cached->bSucceeded)
+		return false;
+
+	FMemory::Memcpy(&OutValue, &Cached->ScalarValue, sizeof(int32));
+	return true;
+}
+
+bool FOpenVRDevicePropertyCache::GetUInt64Property(int32 DeviceIndex, int32 PropertyId, uint64 & OutValue)
+{
+	const FCachedProperty * Cached = FindOrFetch(DeviceIndex, PropertyId, EPropertyType::UInt64);
+	if (!Cached || !Cached->bSucceeded)
+		return false;
+
+	OutValue = Cached->ScalarValue;
+	return true;
+}
+
+bool FOpenVRDevicePropertyCache::GetMatrix34Property(int32 DeviceIndex, int32 PropertyId, FMatrix & OutValue)
+{
+	const FCachedProperty * Cached = FindOrFetch(DeviceIndex, PropertyId, EPropertyType::Matrix34);
+	if (!Cached || !Cached->bSucceeded)
+		return false;
+
+	OutValue = Cached->MatrixValue;
+	return true;
+}
+
+void FOpenVRDevicePropertyCache::AddWatchedProperty(int32 PropertyId)
+{
+	WatchedProperties.FindOrAdd(PropertyId)++;
+}
+
+void FOpenVRDevicePropertyCache::RemoveWatchedProperty(int32 PropertyId)
+{
+	if (int32 * Count = WatchedProperties.Find(PropertyId))
+	{
+		if (--(*Count) <= 0)
+			WatchedProperties.Remove(PropertyId);
+	}
+}
+
+void FOpenVRDevicePropertyCache::Invalidate(int32 DeviceIndex)
+{
+	if (DeviceIndex == INDEX_NONE)
+	{
+		for (FDeviceEntry & Device : Devices)
+		{
+			Device.Properties.Reset();
+		}
+	}
+	else if (Devices.IsValidIndex(DeviceIndex))
+	{
+		Devices[DeviceIndex].Properties.Reset();
+	}
+
+	// Not left to the sweep timing, the interval can be longer than the time since the last sweep
+	bSweepRequested = true;
+}
+
+void FOpenVRDevicePropertyCache::SetSource(TSharedPtr<IOpenVRDevicePropertySource> NewSource)
+{
+	Source = NewSource;
+	ResetDevices();
+	bWasAvailable = false;
+}
+
+void FOpenVRDevicePropertyCache::Shutdown()
+{
+	if (TickHandle.IsValid())
+	{
+		FTicker::GetCoreTicker().RemoveTicker(TickHandle);
+		TickHandle.Reset();
+	}
+
+	bIsShutdown = true;
+	Source.Reset();
+	ResetDevices();
+	WatchedProperties.Reset();
+	OnPropertyChanged.Clear();
+	OnDeviceConnectionChanged.Clear();
+}
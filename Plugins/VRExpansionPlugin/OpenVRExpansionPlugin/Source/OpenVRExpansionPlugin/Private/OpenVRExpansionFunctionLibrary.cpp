@@ -7,6 +7,8 @@
 #include "RenderUtils.h"
 #include "IXRTrackingSystem.h"
 #include "IHeadMountedDisplay.h"
+#include "OpenVRRenderModelLoader.h"
+#include "OpenVRDevicePropertyCache.h"
 
 #if WITH_EDITOR
 #include "Editor/UnrealEd/Classes/Editor/EditorEngine.h"
@@ -530,6 +532,23 @@ void UOpenVRExpansionFunctionLibrary::GetVRCameraFrame(UPARAM(ref) FBPOpenVRCame
 #endif
 }
 
+#if STEAMVR_SUPPORTED_PLATFORM
+// Resolving the property id parses the enum entry name, so each entry is only looked up once per call site
+static vr::ETrackedDeviceProperty GetCachedDeviceProperty(TMap<uint8, vr::ETrackedDeviceProperty> & PropertyIds, const TCHAR * EnumName, uint8 EnumValue)
+{
+	if (const vr::ETrackedDeviceProperty * Found = PropertyIds.Find(EnumValue))
+		return *Found;
+
+	vr::ETrackedDeviceProperty Property = VREnumToString(EnumName, EnumValue);
+
+	// Don't remember failures, the enum may just not be loaded yet
+	if (Property != vr::ETrackedDeviceProperty::Prop_Invalid)
+		PropertyIds.Add(EnumValue, Property);
+
+	return Property;
+}
+#endif
+
 void UOpenVRExpansionFunctionLibrary::GetVRDevicePropertyString(EVRDeviceProperty_String PropertyToRetrieve, int32 DeviceID, FString & StringValue, EBPOVRResultSwitch & Result)
 {
 
@@ -544,34 +563,22 @@ void UOpenVRExpansionFunctionLibrary::GetVRDevicePropertyString(EVRDevicePropert
 		return;
 	}
 
-	vr::IVRSystem* VRSystem = vr::VRSystem();
-
-	if (!VRSystem)
-	{
-		Result = EBPOVRResultSwitch::OnFailed;
-		return;
-	}
-
-	vr::TrackedPropertyError pError = vr::TrackedPropertyError::TrackedProp_Success;
-
-	vr::ETrackedDeviceProperty EnumPropertyValue = VREnumToString(TEXT("EVRDeviceProperty_String"), static_cast<uint8>(PropertyToRetrieve));
+	static TMap<uint8, vr::ETrackedDeviceProperty> PropertyIds;
+	vr::ETrackedDeviceProperty EnumPropertyValue = GetCachedDeviceProperty(PropertyIds, TEXT("EVRDeviceProperty_String"), static_cast<uint8>(PropertyToRetrieve));
 	if (EnumPropertyValue == vr::ETrackedDeviceProperty::Prop_Invalid)
 	{
 		Result = EBPOVRResultSwitch::OnFailed;
 		return;
 	}
 
-	char charvalue[vr::k_unMaxPropertyStringSize];
-	uint32_t buffersize = vr::k_unMaxPropertyStringSize;
-	uint32_t ret = VRSystem->GetStringTrackedDeviceProperty(DeviceID, EnumPropertyValue, charvalue, buffersize, &pError);
-
-	if (pError != vr::TrackedPropertyError::TrackedProp_Success)
+	FString Value;
+	if (!FOpenVRDevicePropertyCache::Get().GetStringProperty(DeviceID, EnumPropertyValue, Value))
 	{
 		Result = EBPOVRResultSwitch::OnFailed;
 		return;
 	}
 
-	StringValue = FString(ANSI_TO_TCHAR(charvalue));
+	StringValue = Value;
 	Result = EBPOVRResultSwitch::OnSucceeded;
 	return;
 
@@ -591,32 +598,22 @@ void UOpenVRExpansionFunctionLibrary::GetVRDevicePropertyBool(EVRDeviceProperty_
 		return;
 	}
 
-	vr::IVRSystem* VRSystem = vr::VRSystem();
-
-	if (!VRSystem)
-	{
-		Result = EBPOVRResultSwitch::OnFailed;
-		return;
-	}
-
-	vr::TrackedPropertyError pError = vr::TrackedPropertyError::TrackedProp_Success;
-
-	vr::ETrackedDeviceProperty EnumPropertyValue = VREnumToString(TEXT("EVRDeviceProperty_Bool"), static_cast<uint8>(PropertyToRetrieve));
+	static TMap<uint8, vr::ETrackedDeviceProperty> PropertyIds;
+	vr::ETrackedDeviceProperty EnumPropertyValue = GetCachedDeviceProperty(PropertyIds, TEXT("EVRDeviceProperty_Bool"), static_cast<uint8>(PropertyToRetrieve));
 	if (EnumPropertyValue == vr::ETrackedDeviceProperty::Prop_Invalid)
 	{
 		Result = EBPOVRResultSwitch::OnFailed;
 		return;
 	}
 
-	bool ret = VRSystem->GetBoolTrackedDeviceProperty(DeviceID, EnumPropertyValue, &pError);
-
-	if (pError != vr::TrackedPropertyError::TrackedProp_Success)
+	bool Value = false;
+	if (!FOpenVRDevicePropertyCache::Get().GetBoolProperty(DeviceID, EnumPropertyValue, Value))
 	{
 		Result = EBPOVRResultSwitch::OnFailed;
 		return;
 	}
 
-	BoolValue = ret;
+	BoolValue = Value;
 	Result = EBPOVRResultSwitch::OnSucceeded;
 	return;
 
@@ -636,32 +633,22 @@ void UOpenVRExpansionFunctionLibrary::GetVRDevicePropertyFloat(EVRDeviceProperty
 		return;
 	}
 
-	vr::IVRSystem* VRSystem = vr::VRSystem();
-
-	if (!VRSystem)
-	{
-		Result = EBPOVRResultSwitch::OnFailed;
-		return;
-	}
-
-	vr::TrackedPropertyError pError = vr::TrackedPropertyError::TrackedProp_Success;
-
-	vr::ETrackedDeviceProperty EnumPropertyValue = VREnumToString(TEXT("EVRDeviceProperty_Float"), static_cast<uint8>(PropertyToRetrieve));
+	static TMap<uint8, vr::ETrackedDeviceProperty> PropertyIds;
+	vr::ETrackedDeviceProperty EnumPropertyValue = GetCachedDeviceProperty(PropertyIds, TEXT("EVRDeviceProperty_Float"), static_cast<uint8>(PropertyToRetrieve));
 	if (EnumPropertyValue == vr::ETrackedDeviceProperty::Prop_Invalid)
 	{
 		Result = EBPOVRResultSwitch::OnFailed;
 		return;
 	}
 
-	float ret = VRSystem->GetFloatTrackedDeviceProperty(DeviceID, EnumPropertyValue, &pError);
-
-	if (pError != vr::TrackedPropertyError::TrackedProp_Success)
+	float Value = 0.0f;
+	if (!FOpenVRDevicePropertyCache::Get().GetFloatProperty(DeviceID, EnumPropertyValue, Value))
 	{
 		Result = EBPOVRResultSwitch::OnFailed;
 		return;
 	}
 
-	FloatValue = ret;
+	FloatValue = Value;
 	Result = EBPOVRResultSwitch::OnSucceeded;
 	return;
 
@@ -681,32 +668,22 @@ void UOpenVRExpansionFunctionLibrary::GetVRDevicePropertyInt32(EVRDeviceProperty
 		return;
 	}
 
-	vr::IVRSystem* VRSystem = vr::VRSystem();
-
-	if (!VRSystem)
-	{
-		Result = EBPOVRResultSwitch::OnFailed;
-		return;
-	}
-
-	vr::TrackedPropertyError pError = vr::TrackedPropertyError::TrackedProp_Success;
-
-	vr::ETrackedDeviceProperty EnumPropertyValue = VREnumToString(TEXT("EVRDeviceProperty_Int32"), static_cast<uint8>(PropertyToRetrieve));
+	static TMap<uint8, vr::ETrackedDeviceProperty> PropertyIds;
+	vr::ETrackedDeviceProperty EnumPropertyValue = GetCachedDeviceProperty(PropertyIds, TEXT("EVRDeviceProperty_Int32"), static_cast<uint8>(PropertyToRetrieve));
 	if (EnumPropertyValue == vr::ETrackedDeviceProperty::Prop_Invalid)
 	{
 		Result = EBPOVRResultSwitch::OnFailed;
 		return;
 	}
 
-	int32 ret = VRSystem->GetInt32TrackedDeviceProperty(DeviceID, EnumPropertyValue, &pError);
-
-	if (pError != vr::TrackedPropertyError::TrackedProp_Success)
+	int32 Value = 0;
+	if (!FOpenVRDevicePropertyCache::Get().GetInt32Property(DeviceID, EnumPropertyValue, Value))
 	{
 		Result = EBPOVRResultSwitch::OnFailed;
 		return;
 	}
 
-	IntValue = ret;
+	IntValue = Value;
 	Result = EBPOVRResultSwitch::OnSucceeded;
 	return;
 
@@ -726,32 +703,22 @@ void UOpenVRExpansionFunctionLibrary::GetVRDevicePropertyUInt64(EVRDevicePropert
 		return;
 	}
 
-	vr::IVRSystem* VRSystem = vr::VRSystem();
-
-	if (!VRSystem)
-	{
-		Result = EBPOVRResultSwitch::OnFailed;
-		return;
-	}
-
-	vr::TrackedPropertyError pError = vr::TrackedPropertyError::TrackedProp_Success;
-
-	vr::ETrackedDeviceProperty EnumPropertyValue = VREnumToString(TEXT("EVRDeviceProperty_UInt64"), static_cast<uint8>(PropertyToRetrieve));
+	static TMap<uint8, vr::ETrackedDeviceProperty> PropertyIds;
+	vr::ETrackedDeviceProperty EnumPropertyValue = GetCachedDeviceProperty(PropertyIds, TEXT("EVRDeviceProperty_UInt64"), static_cast<uint8>(PropertyToRetrieve));
 	if (EnumPropertyValue == vr::ETrackedDeviceProperty::Prop_Invalid)
 	{
 		Result = EBPOVRResultSwitch::OnFailed;
 		return;
 	}
 
-	uint64 ret = VRSystem->GetUint64TrackedDeviceProperty(DeviceID, EnumPropertyValue, &pError);
-
-	if (pError != vr::TrackedPropertyError::TrackedProp_Success)
+	uint64 Value = 0;
+	if (!FOpenVRDevicePropertyCache::Get().GetUInt64Property(DeviceID, EnumPropertyValue, Value))
 	{
 		Result = EBPOVRResultSwitch::OnFailed;
 		return;
 	}
 
-	UInt64Value = FString::Printf(TEXT("%llu"), ret);
+	UInt64Value = FString::Printf(TEXT("%llu"), Value);
 	Result = EBPOVRResultSwitch::OnSucceeded;
 	return;
 
@@ -771,32 +738,22 @@ void UOpenVRExpansionFunctionLibrary::GetVRDevicePropertyMatrix34AsTransform(EVR
 		return;
 	}
 
-	vr::IVRSystem* VRSystem = vr::VRSystem();
-
-	if (!VRSystem)
-	{
-		Result = EBPOVRResultSwitch::OnFailed;
-		return;
-	}
-
-	vr::TrackedPropertyError pError = vr::TrackedPropertyError::TrackedProp_Success;
-
-	vr::ETrackedDeviceProperty EnumPropertyValue = VREnumToString(TEXT("EVRDeviceProperty_Matrix34"), static_cast<uint8>(PropertyToRetrieve));
+	static TMap<uint8, vr::ETrackedDeviceProperty> PropertyIds;
+	vr::ETrackedDeviceProperty EnumPropertyValue = GetCachedDeviceProperty(PropertyIds, TEXT("EVRDeviceProperty_Matrix34"), static_cast<uint8>(PropertyToRetrieve));
 	if (EnumPropertyValue == vr::ETrackedDeviceProperty::Prop_Invalid)
 	{
 		Result = EBPOVRResultSwitch::OnFailed;
 		return;
 	}
 
-	vr::HmdMatrix34_t ret = VRSystem->GetMatrix34TrackedDeviceProperty(DeviceID, EnumPropertyValue, &pError);
-
-	if (pError != vr::TrackedPropertyError::TrackedProp_Success)
+	FMatrix Value;
+	if (!FOpenVRDevicePropertyCache::Get().GetMatrix34Property(DeviceID, EnumPropertyValue, Value))
 	{
 		Result = EBPOVRResultSwitch::OnFailed;
 		return;
 	}
 
-	TransformValue = FTransform(ToFMatrix(ret));
+	TransformValue = FTransform(Value);
 	Result = EBPOVRResultSwitch::OnSucceeded;
 	return;
 
@@ -813,15 +770,15 @@ EBPOpenVRTrackedDeviceClass UOpenVRExpansionFunctionLibrary::GetOpenVRDeviceType
 	if (OpenVRDeviceIndex < 0 || OpenVRDeviceIndex > (vr::k_unMaxTrackedDeviceCount - 1))
 		return EBPOpenVRTrackedDeviceClass::TrackedDeviceClass_Invalid;
 
-	vr::IVRSystem* VRSystem = vr::VRSystem();
+	FOpenVRDevicePropertyCache & DeviceCache = FOpenVRDevicePropertyCache::Get();
 
-	if (!VRSystem)
+	if (!DeviceCache.IsAvailable())
 	{
 		UE_LOG(OpenVRExpansionFunctionLibraryLog, Warning, TEXT("VRSystem InterfaceErrored in GetOpenVRDevices"));
 		return EBPOpenVRTrackedDeviceClass::TrackedDeviceClass_Invalid;
 	}
 
-	return (EBPOpenVRTrackedDeviceClass)VRSystem->GetTrackedDeviceClass(OpenVRDeviceIndex);
+	return (EBPOpenVRTrackedDeviceClass)DeviceCache.GetDeviceClass(OpenVRDeviceIndex);
 #endif
 }
 
@@ -830,21 +787,20 @@ void UOpenVRExpansionFunctionLibrary::GetOpenVRDevices(TArray<EBPOpenVRTrackedDe
 #if !STEAMVR_SUPPORTED_PLATFORM
 #else
 
-	vr::IVRSystem* VRSystem = vr::VRSystem();
+	FOpenVRDevicePropertyCache & DeviceCache = FOpenVRDevicePropertyCache::Get();
 
-	if (!VRSystem)
+	if (!DeviceCache.IsAvailable())
 	{
 		UE_LOG(OpenVRExpansionFunctionLibraryLog, Warning, TEXT("VRSystem InterfaceErrored in GetOpenVRDevices"));
 		return;
 	}
 
-	vr::ETrackedDeviceClass DeviceClass = vr::ETrackedDeviceClass::TrackedDeviceClass_Invalid;
-	for (vr::TrackedDeviceIndex_t deviceIndex = vr::k_unTrackedDeviceIndex_Hmd; deviceIndex < vr::k_unMaxTrackedDeviceCount; ++deviceIndex)
-	{
-		DeviceClass = VRSystem->GetTrackedDeviceClass(deviceIndex);
+	TArray<int32> DeviceIndexes;
+	DeviceCache.GetDevices(DeviceIndexes);
 
-		if (VRSystem->GetTrackedDeviceClass(deviceIndex) != vr::ETrackedDeviceClass::TrackedDeviceClass_Invalid)
-			FoundDevices.Add((EBPOpenVRTrackedDeviceClass)DeviceClass);
+	for (int32 deviceIndex : DeviceIndexes)
+	{
+		FoundDevices.Add((EBPOpenVRTrackedDeviceClass)DeviceCache.GetDeviceClass(deviceIndex));
 	}
 #endif
 }
@@ -854,19 +810,15 @@ void UOpenVRExpansionFunctionLibrary::GetOpenVRDevicesByType(EBPOpenVRTrackedDev
 #if !STEAMVR_SUPPORTED_PLATFORM
 #else
 
-	vr::IVRSystem* VRSystem = vr::VRSystem();
+	FOpenVRDevicePropertyCache & DeviceCache = FOpenVRDevicePropertyCache::Get();
 
-	if (!VRSystem)
+	if (!DeviceCache.IsAvailable())
 	{
 		UE_LOG(OpenVRExpansionFunctionLibraryLog, Warning, TEXT("VRSystem InterfaceErrored in GetOpenVRDevices"));
 		return;
 	}
 
-	for (vr::TrackedDeviceIndex_t deviceIndex = vr::k_unTrackedDeviceIndex_Hmd; deviceIndex < vr::k_unMaxTrackedDeviceCount; ++deviceIndex)
-	{
-		if (VRSystem->GetTrackedDeviceClass(deviceIndex) == (vr::ETrackedDeviceClass)TypeToRetreive)
-			FoundIndexs.Add(deviceIndex);
-	}
+	DeviceCache.GetDevicesByClass((uint8)TypeToRetreive, FoundIndexs);
 #endif
 }
 
@@ -876,15 +828,15 @@ bool UOpenVRExpansionFunctionLibrary::IsOpenVRDeviceConnected(int32 OpenVRDevice
 	return false;
 #else
 
-	vr::IVRSystem* VRSystem = vr::VRSystem();
+	FOpenVRDevicePropertyCache & DeviceCache = FOpenVRDevicePropertyCache::Get();
 
-	if (!VRSystem)
+	if (!DeviceCache.IsAvailable())
 	{
 		UE_LOG(OpenVRExpansionFunctionLibraryLog, Warning, TEXT("VRSystem InterfaceErrored in IsOpenVRDeviceConnected"));
 		return false;
 	}
 
-	return VRSystem->IsTrackedDeviceConnected(OpenVRDeviceIndex);
+	return DeviceCache.IsDeviceConnected(OpenVRDeviceIndex);
 
 #endif
 }
@@ -977,149 +929,43 @@ UTexture2D * UOpenVRExpansionFunctionLibrary::GetVRDeviceModelAndTexture(UObject
 	//UE_LOG(OpenVRExpansionFunctionLibraryLog, Warning, TEXT("NumComponents: %i"), (int32)numComponents);
 	// if numComponents > 0 load each, otherwise load the main one only
 
-	vr::RenderModel_t *RenderModel = NULL;
+	// Loading and converting happens on a worker, keep calling this while it returns AsyncLoading
+	FOpenVRRenderModelDataPtr RenderModel;
+	EOpenVRRenderModelPollResult PollResult = FOpenVRRenderModelLoader::Get().PollModel(RenderModelNameOut, RenderModel);
 
-	//VRRenderModels->LoadRenderModel()
-	vr::EVRRenderModelError ModelErrorCode = VRRenderModels->LoadRenderModel_Async(RenderModelName, &RenderModel);
-	
-	if (ModelErrorCode != vr::EVRRenderModelError::VRRenderModelError_None)
+	if (PollResult == EOpenVRRenderModelPollResult::Loading)
 	{
-		if (ModelErrorCode != vr::EVRRenderModelError::VRRenderModelError_Loading)
-		{
-			UE_LOG(OpenVRExpansionFunctionLibraryLog, Warning, TEXT("Couldn't Load Model!!"));
-			Result = EAsyncBlueprintResultSwitch::OnFailure;
-		}
-		else
-			Result = EAsyncBlueprintResultSwitch::AsyncLoading;
-
+		Result = EAsyncBlueprintResultSwitch::AsyncLoading;
 		return nullptr;
 	}
 
-	if (!RenderModel)
+	if (PollResult == EOpenVRRenderModelPollResult::Failed || !RenderModel.IsValid())
 	{
 		UE_LOG(OpenVRExpansionFunctionLibraryLog, Warning, TEXT("Couldn't Load Model!!"));
 		Result = EAsyncBlueprintResultSwitch::OnFailure;
 		return nullptr;
 	}
 
-	vr::TextureID_t texID = RenderModel->diffuseTextureId;
-	vr::RenderModel_TextureMap_t * texture = NULL;
-	UTexture2D* OutTexture = nullptr;
-
-	if (texID != vr::INVALID_TEXTURE_ID)
-	{
-		//UTexture2DDynamic * OutTexture = nullptr;
-		vr::EVRRenderModelError TextureErrorCode = VRRenderModels->LoadTexture_Async(texID, &texture);
-
-		if (TextureErrorCode != vr::EVRRenderModelError::VRRenderModelError_None)
-		{
-			if (TextureErrorCode != vr::EVRRenderModelError::VRRenderModelError_Loading)
-			{
-				UE_LOG(OpenVRExpansionFunctionLibraryLog, Warning, TEXT("Couldn't Load Texture!!"));
-				Result = EAsyncBlueprintResultSwitch::OnFailure;
-			}
-			else
-				Result = EAsyncBlueprintResultSwitch::AsyncLoading;
-
-			return nullptr;
-		}
-
-		if (!texture)
-		{
-			UE_LOG(OpenVRExpansionFunctionLibraryLog, Warning, TEXT("Couldn't Load Texture!!"));
-			Result = EAsyncBlueprintResultSwitch::OnFailure;
-			return nullptr;
-		}
-	}
-
 	if (ProceduralMeshComponentsToFill.Num() > 0)
 	{
-		TArray<FVector> vertices;
-		TArray<int32> triangles;
-		TArray<FVector> normals;
-		TArray<FVector2D> UV0;
 		TArray<FColor> vertexColors;
 		TArray<FProcMeshTangent> tangents;
-		
-		vr::HmdVector3_t vPosition;
-		vr::HmdVector3_t vNormal;
-
-		vertices.Reserve(RenderModel->unVertexCount);
-		normals.Reserve(RenderModel->unVertexCount);
-		UV0.Reserve(RenderModel->unVertexCount);
-	
-		for (uint32_t i = 0; i < RenderModel->unVertexCount; ++i)
-		{
-			vPosition = RenderModel->rVertexData[i].vPosition;
-			// OpenVR y+ Up, +x Right, -z Going away
-			// UE4 z+ up, +y right, +x forward
-
-			vertices.Add(FVector(-vPosition.v[2], vPosition.v[0], vPosition.v[1]));
-
-			vNormal = RenderModel->rVertexData[i].vNormal;
-
-			normals.Add(FVector(-vNormal.v[2], vNormal.v[0], vNormal.v[1]));
-
-			UV0.Add(FVector2D(RenderModel->rVertexData[i].rfTextureCoord[0], RenderModel->rVertexData[i].rfTextureCoord[1]));
-		}
-
-		triangles.Reserve(RenderModel->unTriangleCount);
-		for (uint32_t i = 0; i < RenderModel->unTriangleCount * 3; i += 3)
-		{
-			triangles.Add(RenderModel->rIndexData[i]);
-			triangles.Add(RenderModel->rIndexData[i + 1]);
-			triangles.Add(RenderModel->rIndexData[i + 2]);
-		}
 
 		float scale = UHeadMountedDisplayFunctionLibrary::GetWorldToMetersScale(WorldContextObject);
 		for (int i = 0; i < ProceduralMeshComponentsToFill.Num(); ++i)
 		{
+			if (!ProceduralMeshComponentsToFill[i])
+				continue;
+
 			ProceduralMeshComponentsToFill[i]->ClearAllMeshSections();
-			ProceduralMeshComponentsToFill[i]->CreateMeshSection(0, vertices, triangles, normals, UV0, vertexColors, tangents, bCreateCollision);
+			ProceduralMeshComponentsToFill[i]->CreateMeshSection(0, RenderModel->Vertices, RenderModel->Triangles, RenderModel->Normals, RenderModel->UV0, vertexColors, tangents, bCreateCollision);
 			ProceduralMeshComponentsToFill[i]->SetMeshSectionVisible(0, true);
 			ProceduralMeshComponentsToFill[i]->SetWorldScale3D(FVector(scale, scale, scale));
 		}
 	}
 
-	if (texture != nullptr)
-	{
-		uint32 Width = texture->unWidth;
-		uint32 Height = texture->unHeight;
-
-
-		//OutTexture = UTexture2DDynamic::Create(Width, Height, PF_R8G8B8A8);
-		OutTexture = UTexture2D::CreateTransient(Width, Height, PF_R8G8B8A8);
-
-
-		//FTexture2DDynamicResource * TexResource = static_cast<FTexture2DDynamicResource*>(OutTexture->Resource);
-		//FTexture2DRHIParamRef TextureRHI = TexResource->GetTexture2DRHI();
-
-		//uint32 DestStride = 0;
-		//uint8* MipData = reinterpret_cast<uint8*>(RHILockTexture2D(TextureRHI, 0, RLM_WriteOnly, DestStride, false, false));
-
-		uint8* MipData = (uint8*)OutTexture->PlatformData->Mips[0].BulkData.Lock(LOCK_READ_WRITE);
-		FMemory::Memcpy(MipData, (void*)texture->rubTextureMapData, Height * Width * 4);
-		OutTexture->PlatformData->Mips[0].BulkData.Unlock();
-		//RHIUnlockTexture2D(TextureRHI, 0, false, false);
-
-
-		//Setting some Parameters for the Texture and finally returning it
-		OutTexture->PlatformData->NumSlices = 1;
-		OutTexture->NeverStream = true;
-		OutTexture->UpdateResource();
-
-		/*if (bReturnRawTexture)
-		{
-			OutRawTexture.AddUninitialized(Height * Width * 4);
-			FMemory::Memcpy(OutRawTexture.GetData(), (void*)texture->rubTextureMapData, Height * Width * 4);
-		}*/
-
-		Result = EAsyncBlueprintResultSwitch::OnSuccess;
-		VRRenderModels->FreeTexture(texture);
-	}
-
-	VRRenderModels->FreeRenderModel(RenderModel);
-	return OutTexture;
+	Result = EAsyncBlueprintResultSwitch::OnSuccess;
+	return FOpenVRRenderModelLoader::Get().GetOrCreateTexture(RenderModel);
 #endif
 }
 
@@ -2,6 +2,8 @@
 
 #include "OpenVRExpansionPlugin.h"
 #include "OpenVRExpansionFunctionLibrary.h"
+#include "OpenVRRenderModelLoader.h"
+#include "OpenVRDevicePropertyCache.h"
 
 #define LOCTEXT_NAMESPACE "FVRExpansionPluginModule"
 
@@ -9,6 +11,8 @@ void FOpenVRExpansionPluginModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
 	//LoadOpenVRModule();
+
+	FOpenVRRenderModelLoader::Get().Initialize();
 }
 
 void FOpenVRExpansionPluginModule::ShutdownModule()
@@ -16,6 +20,9 @@ void FOpenVRExpansionPluginModule::ShutdownModule()
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
 //	UnloadOpenVRModule();
+
+	FOpenVRRenderModelLoader::Get().Shutdown();
+	FOpenVRDevicePropertyCache::Get().Shutdown();
 }
 
 /*bool FOpenVRExpansionPluginModule::LoadOpenVRModule()
@@ -0,0 +1,497 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+#include "OpenVRRenderModelLoader.h"
+#include "OpenVRExpansionFunctionLibrary.h"
+#include "Engine/Texture2D.h"
+#include "Async/Async.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/Paths.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace OpenVRRenderModelLoaderCVars
+{
+	static int32 UseDiskCache = 0;
+	FAutoConsoleVariableRef CVarUseDiskCache(
+		TEXT("vr.OpenVR.RenderModelDiskCache"),
+		UseDiskCache,
+		TEXT("When on, converted render models are saved to and loaded from Saved/OpenVRRenderModels.\n")
+		TEXT("Delete the folder (or call ClearCache) after a SteamVR update changes the models.\n")
+		TEXT("0: Disable, 1: Enable"),
+		ECVF_Default);
+
+	static float PollInterval = 0.01f;
+	FAutoConsoleVariableRef CVarPollInterval(
+		TEXT("vr.OpenVR.RenderModelPollInterval"),
+		PollInterval,
+		TEXT("Seconds the render model worker waits between polls of a model that is still loading."),
+		ECVF_Default);
+
+	static float ShutdownTimeout = 1.0f;
+	FAutoConsoleVariableRef CVarShutdownTimeout(
+		TEXT("vr.OpenVR.RenderModelShutdownTimeout"),
+		ShutdownTimeout,
+		TEXT("Max seconds Shutdown waits for running render model loads to exit, loads still inside the provider after that are abandoned."),
+		ECVF_Default);
+}
+
+// Bump whenever FOpenVRRenderModelData changes layout
+static const int32 RenderModelDiskCacheVersion = 1;
+
+FArchive& operator<<(FArchive& Ar, FOpenVRRenderModelData& Data)
+{
+	Ar << Data.RenderModelName;
+	Ar << Data.Vertices;
+	Ar << Data.Normals;
+	Ar << Data.UV0;
+	Ar << Data.Triangles;
+	Ar << Data.TextureWidth;
+	Ar << Data.TextureHeight;
+	Ar << Data.TextureData;
+	return Ar;
+}
+
+#if STEAMVR_SUPPORTED_PLATFORM
+class FOpenVRRuntimeRenderModelProvider : public IOpenVRRenderModelProvider
+{
+public:
+
+	FOpenVRRuntimeRenderModelProvider() :
+		VRRenderModels(nullptr)
+	{}
+
+	virtual bool IsAvailable() override
+	{
+		// Grabbed on the game thread, the interface accessors lazily initialize and aren't safe to call from workers
+		VRRenderModels = vr::VRRenderModels();
+		return VRRenderModels != nullptr;
+	}
+
+	virtual EOpenVRRenderModelPollResult PollRenderModel(const FString & RenderModelName, FOpenVRRenderModelData & OutData) override
+	{
+		vr::IVRRenderModels* RenderModels = VRRenderModels;
+
+		if (!RenderModels)
+			return EOpenVRRenderModelPollResult::Failed;
+
+		vr::RenderModel_t *RenderModel = nullptr;
+		vr::EVRRenderModelError ModelErrorCode = RenderModels->LoadRenderModel_Async(TCHAR_TO_ANSI(*RenderModelName), &RenderModel);
+
+		if (ModelErrorCode == vr::EVRRenderModelError::VRRenderModelError_Loading)
+			return EOpenVRRenderModelPollResult::Loading;
+
+		if (ModelErrorCode != vr::EVRRenderModelError::VRRenderModelError_None || !RenderModel)
+		{
+			UE_LOG(OpenVRExpansionFunctionLibraryLog, Warning, TEXT("Couldn't Load Model %s!!"), *RenderModelName);
+			return EOpenVRRenderModelPollResult::Failed;
+		}
+
+		vr::RenderModel_TextureMap_t * Texture = nullptr;
+		if (RenderModel->diffuseTextureId != vr::INVALID_TEXTURE_ID)
+		{
+			vr::EVRRenderModelError TextureErrorCode = RenderModels->LoadTexture_Async(RenderModel->diffuseTextureId, &Texture);
+
+			if (TextureErrorCode != vr::EVRRenderModelError::VRRenderModelError_None || !Texture)
+			{
+				RenderModels->FreeRenderModel(RenderModel);
+
+				if (TextureErrorCode == vr::EVRRenderModelError::VRRenderModelError_Loading)
+					return EOpenVRRenderModelPollResult::Loading;
+
+				UE_LOG(OpenVRExpansionFunctionLibraryLog, Warning, TEXT("Couldn't Load Texture for %s!!"), *RenderModelName);
+				return EOpenVRRenderModelPollResult::Failed;
+			}
+		}
+
+		OutData.RenderModelName = RenderModelName;
+		OutData.Vertices.Reset(RenderModel->unVertexCount);
+		OutData.Normals.Reset(RenderModel->unVertexCount);
+		OutData.UV0.Reset(RenderModel->unVertexCount);
+
+		for (uint32_t i = 0; i < RenderModel->unVertexCount; ++i)
+		{
+			const vr::RenderModel_Vertex_t & Vertex = RenderModel->rVertexData[i];
+
+			// OpenVR y+ Up, +x Right, -z Going away
+			// UE4 z+ up, +y right, +x forward
+			OutData.Vertices.Add(FVector(-Vertex.vPosition.v[2], Vertex.vPosition.v[0], Vertex.vPosition.v[1]));
+			OutData.Normals.Add(FVector(-Vertex.vNormal.v[2], Vertex.vNormal.v[0], Vertex.vNormal.v[1]));
+			OutData.UV0.Add(FVector2D(Vertex.rfTextureCoord[0], Vertex.rfTextureCoord[1]));
+		}
+
+		const int32 NumIndices = RenderModel->unTriangleCount * 3;
+		OutData.Triangles.SetNumUninitialized(NumIndices);
+		for (int32 i = 0; i < NumIndices; ++i)
+		{
+			OutData.Triangles[i] = RenderModel->rIndexData[i];
+		}
+
+		if (Texture)
+		{
+			OutData.TextureWidth = Texture->unWidth;
+			OutData.TextureHeight = Texture->unHeight;
+			OutData.TextureData.SetNumUninitialized(OutData.TextureWidth * OutData.TextureHeight * 4);
+			FMemory::Memcpy(OutData.TextureData.GetData(), Texture->rubTextureMapData, OutData.TextureData.Num());
+			RenderModels->FreeTexture(Texture);
+		}
+
+		RenderModels->FreeRenderModel(RenderModel);
+		return EOpenVRRenderModelPollResult::Loaded;
+	}
+
+private:
+	vr::IVRRenderModels* VRRenderModels;
+};
+#endif
+
+// Runs on a pool thread
+static FOpenVRRenderModelDataPtr LoadRenderModelOnWorker(IOpenVRRenderModelProvider & Provider, const FString & RenderModelName, const FThreadSafeBool & bCancelled, const FString & DiskCachePath, float PollInterval)
+{
+	// Cancelled while it sat in the queue
+	if (bCancelled)
+		return nullptr;
+
+	TSharedPtr<FOpenVRRenderModelData, ESPMode::ThreadSafe> Model = MakeShared<FOpenVRRenderModelData, ESPMode::ThreadSafe>();
+
+	if (!DiskCachePath.IsEmpty())
+	{
+		TArray<uint8> FileData;
+		if (FFileHelper::LoadFileToArray(FileData, *DiskCachePath, FILEREAD_Silent))
+		{
+			FMemoryReader Reader(FileData);
+			int32 Version = 0;
+			Reader << Version;
+
+			if (Version == RenderModelDiskCacheVersion)
+			{
+				Reader << *Model;
+
+				if (!Reader.IsError() && Model->RenderModelName == RenderModelName)
+					return Model;
+			}
+
+			*Model = FOpenVRRenderModelData();
+		}
+	}
+
+	EOpenVRRenderModelPollResult PollResult = EOpenVRRenderModelPollResult::Loading;
+	while (!bCancelled)
+	{
+		PollResult = Provider.PollRenderModel(RenderModelName, *Model);
+
+		if (PollResult != EOpenVRRenderModelPollResult::Loading)
+			break;
+
+		FPlatformProcess::Sleep(PollInterval);
+	}
+
+	if (PollResult != EOpenVRRenderModelPollResult::Loaded)
+		return nullptr;
+
+	if (!DiskCachePath.IsEmpty())
+	{
+		TArray<uint8> FileData;
+		FMemoryWriter Writer(FileData);
+		int32 Version = RenderModelDiskCacheVersion;
+		Writer << Version;
+		Writer << *Model;
+		FFileHelper::SaveArrayToFile(FileData, *DiskCachePath);
+	}
+
+	return Model;
+}
+
+// Queued work rather than Async() so that Shutdown can pull loads back out of the pool before they start
+class FOpenVRRenderModelLoadTask : public FNonAbandonableTask
+{
+	friend class FAsyncTask<FOpenVRRenderModelLoadTask>;
+
+public:
+
+	FOpenVRRenderModelLoadTask(TSharedPtr<IOpenVRRenderModelProvider, ESPMode::ThreadSafe> InProvider, const FString & InRenderModelName, FOpenVRRenderModelLoader::FPendingLoadPtr InLoad, const FString & InDiskCachePath, float InPollInterval) :
+		Provider(InProvider),
+		RenderModelName(InRenderModelName),
+		Load(InLoad),
+		DiskCachePath(InDiskCachePath),
+		PollInterval(InPollInterval)
+	{}
+
+	void DoWork()
+	{
+		FOpenVRRenderModelDataPtr Model = LoadRenderModelOnWorker(*Provider, RenderModelName, Load->bCancelled, DiskCachePath, PollInterval);
+
+		FString Name = RenderModelName;
+		FOpenVRRenderModelLoader::FPendingLoadPtr FinishedLoad = Load;
+		AsyncTask(ENamedThreads::GameThread, [Name, FinishedLoad, Model]()
+		{
+			FOpenVRRenderModelLoader::Get().FinishLoad(Name, FinishedLoad, Model);
+		});
+	}
+
+	FORCEINLINE TStatId GetStatId() const
+	{
+		RETURN_QUICK_DECLARE_CYCLE_STAT(FOpenVRRenderModelLoadTask, STATGROUP_ThreadPoolAsyncTasks);
+	}
+
+private:
+	TSharedPtr<IOpenVRRenderModelProvider, ESPMode::ThreadSafe> Provider;
+	FString RenderModelName;
+	FOpenVRRenderModelLoader::FPendingLoadPtr Load;
+	FString DiskCachePath;
+	float PollInterval;
+};
+
+FOpenVRRenderModelLoader & FOpenVRRenderModelLoader::Get()
+{
+	static FOpenVRRenderModelLoader Loader;
+	return Loader;
+}
+
+FOpenVRRenderModelLoader::FOpenVRRenderModelLoader() :
+	NextRequestHandle(0),
+	Generation(0),
+	bIsShutdown(false)
+{
+	Initialize();
+}
+
+void FOpenVRRenderModelLoader::Initialize()
+{
+	bIsShutdown = false;
+
+#if STEAMVR_SUPPORTED_PLATFORM
+	if (!Provider.IsValid())
+		Provider = MakeShared<FOpenVRRuntimeRenderModelProvider, ESPMode::ThreadSafe>();
+#endif
+}
+
+FOpenVRRenderModelDataPtr FOpenVRRenderModelLoader::FindCachedModel(const FString & RenderModelName) const
+{
+	const FOpenVRRenderModelDataPtr * CachedModel = Cache.Find(RenderModelName);
+	return CachedModel ? *CachedModel : nullptr;
+}
+
+int32 FOpenVRRenderModelLoader::RequestModel(const FString & RenderModelName, FOnOpenVRRenderModelLoaded Callback)
+{
+	check(IsInGameThread());
+
+	if (FOpenVRRenderModelDataPtr CachedModel = FindCachedModel(RenderModelName))
+	{
+		Callback.ExecuteIfBound(CachedModel);
+		return INDEX_NONE;
+	}
+
+	FPendingLoadPtr * ExistingLoad = PendingLoads.Find(RenderModelName);
+	FPendingLoadPtr Load = ExistingLoad ? *ExistingLoad : nullptr;
+
+	if (!Load.IsValid())
+	{
+		if (bIsShutdown || !Provider.IsValid() || !Provider->IsAvailable())
+		{
+			UE_LOG(OpenVRExpansionFunctionLibraryLog, Warning, TEXT("Render model provider unavailable, can't load %s"), *RenderModelName);
+			Callback.ExecuteIfBound(nullptr);
+			return INDEX_NONE;
+		}
+
+		Load = MakeShared<FPendingLoad, ESPMode::ThreadSafe>();
+		Load->Generation = Generation;
+		PendingLoads.Add(RenderModelName, Load);
+		StartLoad(RenderModelName, Load);
+	}
+
+	const int32 RequestHandle = NextRequestHandle++;
+	Load->Waiters.Add(TPair<int32, FOnOpenVRRenderModelLoaded>(RequestHandle, Callback));
+	return RequestHandle;
+}
+
+void FOpenVRRenderModelLoader::CancelRequest(int32 RequestHandle)
+{
+	check(IsInGameThread());
+
+	if (RequestHandle == INDEX_NONE)
+		return;
+
+	for (auto It = PendingLoads.CreateIterator(); It; ++It)
+	{
+		FPendingLoad & Load = *It.Value();
+		const int32 WaiterIndex = Load.Waiters.IndexOfByPredicate([RequestHandle](const TPair<int32, FOnOpenVRRenderModelLoaded> & Waiter)
+		{
+			return Waiter.Key == RequestHandle;
+		});
+
+		if (WaiterIndex == INDEX_NONE)
+			continue;
+
+		Load.Waiters.RemoveAt(WaiterIndex);
+
+		// Nobody left to hand the model to, let the worker bail out
+		if (Load.Waiters.Num() == 0)
+		{
+			Load.bCancelled = true;
+			It.RemoveCurrent();
+		}
+		return;
+	}
+}
+
+EOpenVRRenderModelPollResult FOpenVRRenderModelLoader::PollModel(const FString & RenderModelName, FOpenVRRenderModelDataPtr & OutModel)
+{
+	OutModel = FindCachedModel(RenderModelName);
+	if (OutModel.IsValid())
+		return EOpenVRRenderModelPollResult::Loaded;
+
+	if (FailedLoads.Remove(RenderModelName) > 0)
+		return EOpenVRRenderModelPollResult::Failed;
+
+	if (!PendingLoads.Contains(RenderModelName))
+	{
+		// Held until the next poll so the caller sees the failure once
+		RequestModel(RenderModelName, FOnOpenVRRenderModelLoaded::CreateLambda([this, RenderModelName](FOpenVRRenderModelDataPtr Model)
+		{
+			if (!Model.IsValid())
+				FailedLoads.Add(RenderModelName);
+		}));
+
+		// The provider wasn't available, the callback already ran
+		if (FailedLoads.Remove(RenderModelName) > 0)
+			return EOpenVRRenderModelPollResult::Failed;
+	}
+
+	return EOpenVRRenderModelPollResult::Loading;
+}
+
+bool FOpenVRRenderModelLoader::IsLoading(const FString & RenderModelName) const
+{
+	return PendingLoads.Contains(RenderModelName);
+}
+
+void FOpenVRRenderModelLoader::StartLoad(const FString & RenderModelName, FPendingLoadPtr Load)
+{
+	TSharedPtr<IOpenVRRenderModelProvider, ESPMode::ThreadSafe> LoadProvider = Provider;
+	const FString DiskCachePath = OpenVRRenderModelLoaderCVars::UseDiskCache ? GetDiskCachePath(RenderModelName) : FString();
+	const float PollInterval = FMath::Max(OpenVRRenderModelLoaderCVars::PollInterval, 0.001f);
+
+	// Finished workers are only cleared out here, Shutdown deals with whatever is left
+	InFlightLoads.RemoveAll([](const TUniquePtr<FAsyncTask<FOpenVRRenderModelLoadTask>> & InFlightLoad) { return InFlightLoad->IsDone(); });
+
+	// The poll loop sleeps so it goes to the thread pool rather than blocking a task graph worker
+	InFlightLoads.Add(MakeUnique<FAsyncTask<FOpenVRRenderModelLoadTask>>(LoadProvider, RenderModelName, Load, DiskCachePath, PollInterval));
+	InFlightLoads.Last()->StartBackgroundTask();
+}
+
+void FOpenVRRenderModelLoader::FinishLoad(const FString & RenderModelName, FPendingLoadPtr Load, FOpenVRRenderModelDataPtr Model)
+{
+	if (bIsShutdown || Load->Generation != Generation)
+		return;
+
+	// A cancelled load can still have finished, no reason to throw the model away
+	if (Model.IsValid())
+		Cache.Add(RenderModelName, Model);
+
+	FPendingLoadPtr * CurrentLoad = PendingLoads.Find(RenderModelName);
+	if (!CurrentLoad || *CurrentLoad != Load)
+		return;
+
+	// Waiters can queue new requests from their callbacks, so take them out first
+	TArray<TPair<int32, FOnOpenVRRenderModelLoaded>> Waiters = MoveTemp(Load->Waiters);
+	PendingLoads.Remove(RenderModelName);
+
+	for (TPair<int32, FOnOpenVRRenderModelLoaded> & Waiter : Waiters)
+	{
+		Waiter.Value.ExecuteIfBound(Model);
+	}
+}
+
+UTexture2D * FOpenVRRenderModelLoader::GetOrCreateTexture(const FOpenVRRenderModelDataPtr & Model)
+{
+	if (!Model.IsValid() || !Model->HasTexture())
+		return nullptr;
+
+	TWeakObjectPtr<UTexture2D> & CachedTexture = Textures.FindOrAdd(Model->RenderModelName);
+	if (CachedTexture.IsValid())
+		return CachedTexture.Get();
+
+	UTexture2D * OutTexture = UTexture2D::CreateTransient(Model->TextureWidth, Model->TextureHeight, PF_R8G8B8A8);
+
+	if (!OutTexture)
+		return nullptr;
+
+	uint8* MipData = (uint8*)OutTexture->PlatformData->Mips[0].BulkData.Lock(LOCK_READ_WRITE);
+	FMemory::Memcpy(MipData, Model->TextureData.GetData(), Model->TextureData.Num());
+	OutTexture->PlatformData->Mips[0].BulkData.Unlock();
+
+	//Setting some Parameters for the Texture and finally returning it
+	OutTexture->PlatformData->NumSlices = 1;
+	OutTexture->NeverStream = true;
+	OutTexture->UpdateResource();
+
+	CachedTexture = OutTexture;
+	return OutTexture;
+}
+
+void FOpenVRRenderModelLoader::SetProvider(TSharedPtr<IOpenVRRenderModelProvider, ESPMode::ThreadSafe> NewProvider)
+{
+	// Running loads keep their own reference to the old provider
+	Provider = NewProvider;
+}
+
+void FOpenVRRenderModelLoader::ClearCache(bool bIncludeDiskCache)
+{
+	Cache.Empty();
+	Textures.Empty();
+	FailedLoads.Empty();
+
+	if (bIncludeDiskCache)
+	{
+		IFileManager::Get().DeleteDirectory(*(FPaths::ProjectSavedDir() / TEXT("OpenVRRenderModels")), false, true);
+	}
+}
+
+void FOpenVRRenderModelLoader::Shutdown()
+{
+	bIsShutdown = true;
+	++Generation;
+
+	TMap<FString, FPendingLoadPtr> LoadsToFail = MoveTemp(PendingLoads);
+	PendingLoads.Reset();
+
+	for (TPair<FString, FPendingLoadPtr> & LoadPair : LoadsToFail)
+	{
+		LoadPair.Value->bCancelled = true;
+
+		for (TPair<int32, FOnOpenVRRenderModelLoaded> & Waiter : LoadPair.Value->Waiters)
+		{
+			Waiter.Value.ExecuteIfBound(nullptr);
+		}
+	}
+
+	// Loads the pool hasn't picked up yet never start
+	InFlightLoads.RemoveAll([](const TUniquePtr<FAsyncTask<FOpenVRRenderModelLoadTask>> & InFlightLoad) { return InFlightLoad->Cancel(); });
+
+	// Running workers leave at their next poll, but one can still be inside the provider or writing the disk cache
+	const double WaitUntil = FPlatformTime::Seconds() + FMath::Max(OpenVRRenderModelLoaderCVars::ShutdownTimeout, 0.0f);
+	for (TUniquePtr<FAsyncTask<FOpenVRRenderModelLoadTask>> & InFlightLoad : InFlightLoads)
+	{
+		while (!InFlightLoad->IsDone() && FPlatformTime::Seconds() < WaitUntil)
+		{
+			FPlatformProcess::Sleep(0.001f);
+		}
+
+		if (!InFlightLoad->IsDone())
+		{
+			// Deleting a running task isn't allowed, it holds its own provider reference and its result is dropped by the generation check
+			UE_LOG(OpenVRExpansionFunctionLibraryLog, Warning, TEXT("Render model load still running after %.2fs, abandoning it"), OpenVRRenderModelLoaderCVars::ShutdownTimeout);
+			InFlightLoad.Release();
+		}
+	}
+	InFlightLoads.Empty();
+
+	ClearCache(false);
+	Provider.Reset();
+}
+
+FString FOpenVRRenderModelLoader::GetDiskCachePath(const FString & RenderModelName)
+{
+	return FPaths::ProjectSavedDir() / TEXT("OpenVRRenderModels") / (FPaths::MakeValidFileName(RenderModelName) + TEXT(".bin"));
+}
@@ -0,0 +1,312 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/WorldSettings.h"
+#include "RenderingThread.h"
+#include "OpenVRCameraStreamComponent.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace OpenVRCameraStreamTests
+{
+	// Checks every frame it hands over against its header, the sequence is written into the first pixel
+	class FCheckedSyntheticFrameSource : public FOpenVRSyntheticCameraFrameSource
+	{
+	public:
+
+		using FOpenVRSyntheticCameraFrameSource::FOpenVRSyntheticCameraFrameSource;
+
+		FThreadSafeCounter NumReads;
+		FThreadSafeCounter NumMismatchedReads;
+
+		virtual bool ReadFrame(uint8 * Buffer, uint32 BufferSize, FOpenVRCameraFrameHeader & OutHeader) override
+		{
+			if (!FOpenVRSyntheticCameraFrameSource::ReadFrame(Buffer, BufferSize, OutHeader))
+				return false;
+
+			uint32 PixelSequence = 0;
+			FMemory::Memcpy(&PixelSequence, Buffer, sizeof(uint32));
+
+			NumReads.Increment();
+			if (PixelSequence != OutHeader.FrameSequence)
+				NumMismatchedReads.Increment();
+
+			return true;
+		}
+	};
+
+	typedef TSharedPtr<FCheckedSyntheticFrameSource, ESPMode::ThreadSafe> FCheckedSyntheticFrameSourcePtr;
+
+	// Game world with a single actor to register the stream component on
+	struct FScopedStreamWorld
+	{
+		UWorld * World;
+		AActor * Actor;
+
+		FScopedStreamWorld()
+		{
+			World = UWorld::CreateWorld(EWorldType::Game, false);
+			FWorldContext & Context = GEngine->CreateNewWorldContext(EWorldType::Game);
+			Context.SetCurrentWorld(World);
+			World->InitializeActorsForPlay(FURL());
+			World->GetWorldSettings()->NotifyBeginPlay();
+			Actor = World->SpawnActor<AActor>();
+		}
+
+		~FScopedStreamWorld()
+		{
+			// Queued texture uploads hold their own buffers, but not the texture
+			FlushRenderingCommands();
+			GEngine->DestroyWorldContext(World);
+			World->DestroyWorld(false);
+		}
+
+		UOpenVRCameraStreamComponent * AddStream(TSharedPtr<IOpenVRCameraFrameSource, ESPMode::ThreadSafe> Source)
+		{
+			UOpenVRCameraStreamComponent * Stream = NewObject<UOpenVRCameraStreamComponent>(Actor);
+			Stream->SetFrameSource(Source);
+			Stream->PollInterval = 0.001f;
+			Stream->RegisterComponent();
+			return Stream;
+		}
+	};
+
+	struct FStreamResult
+	{
+		int32 NumTicks = 0;
+		int32 FramesReceived = 0;
+		int32 FramesDropped = 0;
+		int32 FramesDisplayed = 0;
+		int32 NumOutOfOrder = 0;
+		int32 NumBadHeaders = 0;
+
+		// Frames the displayed one was behind the camera when it was picked up
+		int32 MaxLatency = 0;
+		double AverageLatency = 0.0;
+		double TickMicroseconds = 0.0;
+	};
+
+	// Ticks the stream at a fixed rate for a while, checking every displayed frame against the one before it
+	FStreamResult RunStream(UOpenVRCameraStreamComponent * Stream, FCheckedSyntheticFrameSource & Source, float Duration, float TickInterval)
+	{
+		FStreamResult Result;
+		uint32 LastSequence = 0;
+		int32 NumLatencySamples = 0;
+		double TotalLatency = 0.0;
+		double TickSeconds = 0.0;
+
+		const double EndTime = FPlatformTime::Seconds() + Duration;
+		while (FPlatformTime::Seconds() < EndTime)
+		{
+			FPlatformProcess::Sleep(TickInterval);
+
+			int32 Received, Dropped, DisplayedCountBefore;
+			Stream->GetFrameStats(Received, Dropped, DisplayedCountBefore);
+
+			const double TickStart = FPlatformTime::Seconds();
+			Stream->TickComponent(TickInterval, LEVELTICK_All, &Stream->PrimaryComponentTick);
+			TickSeconds += FPlatformTime::Seconds() - TickStart;
+			++Result.NumTicks;
+
+			int32 DisplayedCount;
+			Stream->GetFrameStats(Received, Dropped, DisplayedCount);
+			if (DisplayedCount == DisplayedCountBefore)
+				continue;
+
+			const FOpenVRCameraFrameHeader & Header = Stream->GetLatestFrameHeader();
+			if (LastSequence != 0 && Header.FrameSequence <= LastSequence)
+				++Result.NumOutOfOrder;
+
+			// The synthetic source derives everything in the header from the sequence
+			const float YawError = FMath::FindDeltaAngleDegrees(Header.Pose.Rotator().Yaw, (float)(Header.FrameSequence % 360));
+			if (!Header.bPoseIsValid || FMath::Abs(YawError) > 0.01f || Stream->GetLatestFrameInfo().FrameSequence != (int32)Header.FrameSequence)
+				++Result.NumBadHeaders;
+
+			FOpenVRCameraFrameHeader CurrentHeader;
+			Source.GetFrameHeader(CurrentHeader);
+			const int32 Latency = (int32)CurrentHeader.FrameSequence - (int32)Header.FrameSequence;
+			Result.MaxLatency = FMath::Max(Result.MaxLatency, Latency);
+			TotalLatency += Latency;
+			++NumLatencySamples;
+
+			LastSequence = Header.FrameSequence;
+		}
+
+		Stream->GetFrameStats(Result.FramesReceived, Result.FramesDropped, Result.FramesDisplayed);
+		Result.AverageLatency = NumLatencySamples ? TotalLatency / NumLatencySamples : 0.0;
+		Result.TickMicroseconds = Result.NumTicks ? TickSeconds * 1000000.0 / Result.NumTicks : 0.0;
+		return Result;
+	}
+
+	FString Describe(const FStreamResult & Result)
+	{
+		return FString::Printf(TEXT("%d ticks, %d received, %d dropped, %d displayed, latency avg %.2f max %d frames, %.2f us per tick"),
+			Result.NumTicks, Result.FramesReceived, Result.FramesDropped, Result.FramesDisplayed, Result.AverageLatency, Result.MaxLatency, Result.TickMicroseconds);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FOpenVRCameraStreamOrderingTest, "OpenVRExpansionPlugin.CameraStream.Ordering", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FOpenVRCameraStreamOrderingTest::RunTest(const FString& Parameters)
+{
+	using namespace OpenVRCameraStreamTests;
+
+	FScopedStreamWorld StreamWorld;
+
+	const int32 BufferCounts[] = { 2, 3, 4 };
+	for (int32 NumBuffers : BufferCounts)
+	{
+		FCheckedSyntheticFrameSourcePtr Source = MakeShared<FCheckedSyntheticFrameSource, ESPMode::ThreadSafe>(64, 48, 90.0f);
+		UOpenVRCameraStreamComponent * Stream = StreamWorld.AddStream(Source);
+		Stream->NumStagingBuffers = NumBuffers;
+
+		EBPOVRResultSwitch StartResult;
+		Stream->StartStreaming(StartResult);
+		TestTrue(TEXT("The synthetic source streams"), StartResult == EBPOVRResultSwitch::OnSucceeded && Stream->IsStreaming());
+
+		const FStreamResult Result = RunStream(Stream, *Source, 0.5f, 1.0f / 90.0f);
+		AddInfo(FString::Printf(TEXT("%d buffers: %s"), NumBuffers, *Describe(Result)));
+
+		TestTrue(FString::Printf(TEXT("%d buffers: frames are displayed"), NumBuffers), Result.FramesDisplayed > 0);
+		TestEqual(FString::Printf(TEXT("%d buffers: displayed frames never go backwards"), NumBuffers), Result.NumOutOfOrder, 0);
+		TestEqual(FString::Printf(TEXT("%d buffers: every displayed frame keeps its own header"), NumBuffers), Result.NumBadHeaders, 0);
+		TestEqual(FString::Printf(TEXT("%d buffers: every read frame matches its header"), NumBuffers), Source->NumMismatchedReads.GetValue(), 0);
+		TestTrue(FString::Printf(TEXT("%d buffers: nothing is displayed that wasn't received"), NumBuffers), Result.FramesDisplayed <= Result.FramesReceived);
+
+		// Each received frame is displayed, dropped for a newer one, or still waiting in a slot
+		TestTrue(FString::Printf(TEXT("%d buffers: every received frame is accounted for"), NumBuffers), Result.FramesDisplayed + Result.FramesDropped >= Result.FramesReceived - NumBuffers);
+
+		const FOpenVRCameraFrameHeader & Header = Stream->GetLatestFrameHeader();
+		const FBPOpenVRCameraFrameInfo Info = Stream->GetLatestFrameInfo();
+		TestEqual(TEXT("The frame info carries the header size"), Info.Width, 64);
+		TestTrue(TEXT("The frame info pose is scaled to world units"), Info.Pose.GetTranslation().Equals(Header.Pose.GetTranslation() * 100.0f, 0.01f));
+
+		Stream->StopStreaming();
+		TestFalse(TEXT("Stopping ends the stream"), Stream->IsStreaming());
+		TestFalse(TEXT("Stopping turns the tick off"), Stream->IsComponentTickEnabled());
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FOpenVRCameraStreamDropTest, "OpenVRExpansionPlugin.CameraStream.Drops", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FOpenVRCameraStreamDropTest::RunTest(const FString& Parameters)
+{
+	using namespace OpenVRCameraStreamTests;
+
+	FScopedStreamWorld StreamWorld;
+
+	// The game thread stalls, only the newest frame may be waiting when it comes back
+	for (EOpenVRCameraFrameDropPolicy DropPolicy : { EOpenVRCameraFrameDropPolicy::KeepLatest, EOpenVRCameraFrameDropPolicy::KeepOldest })
+	{
+		const TCHAR * PolicyName = DropPolicy == EOpenVRCameraFrameDropPolicy::KeepLatest ? TEXT("KeepLatest") : TEXT("KeepOldest");
+
+		FCheckedSyntheticFrameSourcePtr Source = MakeShared<FCheckedSyntheticFrameSource, ESPMode::ThreadSafe>(64, 48, 120.0f);
+		UOpenVRCameraStreamComponent * Stream = StreamWorld.AddStream(Source);
+		Stream->DropPolicy = DropPolicy;
+
+		EBPOVRResultSwitch StartResult;
+		Stream->StartStreaming(StartResult);
+		RunStream(Stream, *Source, 0.1f, 1.0f / 90.0f);
+		FlushRenderingCommands();
+
+		int32 ReceivedBefore, DroppedBefore, DisplayedBefore;
+		Stream->GetFrameStats(ReceivedBefore, DroppedBefore, DisplayedBefore);
+
+		FPlatformProcess::Sleep(0.25f);
+		Stream->TickComponent(0.25f, LEVELTICK_All, &Stream->PrimaryComponentTick);
+
+		int32 Received, Dropped, Displayed;
+		Stream->GetFrameStats(Received, Dropped, Displayed);
+
+		FOpenVRCameraFrameHeader CurrentHeader;
+		Source->GetFrameHeader(CurrentHeader);
+		const int32 Latency = (int32)CurrentHeader.FrameSequence - (int32)Stream->GetLatestFrameHeader().FrameSequence;
+
+		AddInfo(FString::Printf(TEXT("%s, 250ms game thread stall: %d received %d dropped during it, displayed frame %d behind"), PolicyName, Received - ReceivedBefore, Dropped - DroppedBefore, Latency));
+
+		TestTrue(FString::Printf(TEXT("%s: the stream keeps reading through a stall"), PolicyName), Received - ReceivedBefore > 10);
+		TestEqual(FString::Printf(TEXT("%s: one frame is shown after the stall"), PolicyName), Displayed - DisplayedBefore, 1);
+		TestTrue(FString::Printf(TEXT("%s: frames replaced during the stall are counted as dropped"), PolicyName), Dropped - DroppedBefore >= Received - ReceivedBefore - 1);
+		TestTrue(FString::Printf(TEXT("%s: the frame shown after the stall is recent"), PolicyName), Latency <= 3);
+
+		Stream->StopStreaming();
+	}
+
+	// A source that stalls inside the read skips frames, those are dropped too
+	{
+		FCheckedSyntheticFrameSourcePtr Source = MakeShared<FCheckedSyntheticFrameSource, ESPMode::ThreadSafe>(64, 48, 120.0f, 10, 0.05f);
+		UOpenVRCameraStreamComponent * Stream = StreamWorld.AddStream(Source);
+
+		EBPOVRResultSwitch StartResult;
+		Stream->StartStreaming(StartResult);
+		const FStreamResult Result = RunStream(Stream, *Source, 0.5f, 1.0f / 90.0f);
+		AddInfo(FString::Printf(TEXT("Stalling source: %s"), *Describe(Result)));
+
+		TestTrue(TEXT("Frames the source skipped past are counted as dropped"), Result.FramesDropped > 0);
+		TestEqual(TEXT("A stalling source still displays in order"), Result.NumOutOfOrder, 0);
+		TestEqual(TEXT("A stalling source still hands back whole frames"), Source->NumMismatchedReads.GetValue(), 0);
+
+		Stream->StopStreaming();
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FOpenVRCameraStreamTimingTest, "OpenVRExpansionPlugin.CameraStream.Timing", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FOpenVRCameraStreamTimingTest::RunTest(const FString& Parameters)
+{
+	using namespace OpenVRCameraStreamTests;
+
+	FScopedStreamWorld StreamWorld;
+	const float Duration = 1.0f;
+
+	// Reading every frame, the stream keeps up with the camera
+	{
+		FCheckedSyntheticFrameSourcePtr Source = MakeShared<FCheckedSyntheticFrameSource, ESPMode::ThreadSafe>(640, 480, 60.0f);
+		UOpenVRCameraStreamComponent * Stream = StreamWorld.AddStream(Source);
+
+		EBPOVRResultSwitch StartResult;
+		Stream->StartStreaming(StartResult);
+		const FStreamResult Result = RunStream(Stream, *Source, Duration, 1.0f / 90.0f);
+		AddInfo(FString::Printf(TEXT("60 fps camera, 90 fps game, every frame: %s"), *Describe(Result)));
+
+		TestTrue(TEXT("Close to every camera frame is received"), Result.FramesReceived >= FMath::FloorToInt(60.0f * Duration * 0.8f));
+		TestTrue(TEXT("A game thread faster than the camera shows the frames it gets"), Result.FramesDisplayed >= Result.FramesReceived - Result.FramesDropped - 2);
+		TestTrue(TEXT("Displayed frames are at most a couple of camera frames old"), Result.MaxLatency <= 3);
+
+		Stream->StopStreaming();
+	}
+
+	// A target rate below the camera rate reads at that rate, and the skipped frames aren't counted as drops
+	{
+		FCheckedSyntheticFrameSourcePtr Source = MakeShared<FCheckedSyntheticFrameSource, ESPMode::ThreadSafe>(640, 480, 120.0f);
+		UOpenVRCameraStreamComponent * Stream = StreamWorld.AddStream(Source);
+		Stream->TargetFrameRate = 30.0f;
+
+		EBPOVRResultSwitch StartResult;
+		Stream->StartStreaming(StartResult);
+		const FStreamResult Result = RunStream(Stream, *Source, Duration, 1.0f / 90.0f);
+		AddInfo(FString::Printf(TEXT("120 fps camera, 30 fps target: %s"), *Describe(Result)));
+
+		TestTrue(TEXT("The target rate caps the frames read"), Result.FramesReceived <= FMath::CeilToInt(30.0f * Duration) + 2);
+		TestTrue(TEXT("The target rate is still met"), Result.FramesReceived >= FMath::FloorToInt(30.0f * Duration * 0.8f));
+		TestTrue(TEXT("Frames skipped for the target rate aren't drops"), Result.FramesDropped <= 1);
+		TestTrue(TEXT("Every received frame was read from the source"), Source->NumReads.GetValue() >= Result.FramesReceived);
+
+		Stream->StopStreaming();
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,410 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "OpenVRDevicePropertyCache.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace OpenVRDevicePropertyCacheTests
+{
+	// Raw OpenVR values
+	static const int32 PropModelNumber = 1001;
+	static const int32 PropSerialNumber = 1002;
+	static const int32 PropRenderModelName = 1003;
+	static const int32 PropBatteryPercentage = 1012;
+	static const int32 PropRoleHint = 3007;
+
+	static const uint8 ClassHMD = 1;
+	static const uint8 ClassController = 2;
+	static const uint8 ClassTracker = 3;
+
+	// Devices without a runtime, every call into it is counted
+	class FMockDevicePropertySource : public IOpenVRDevicePropertySource
+	{
+	public:
+
+		struct FMockDevice
+		{
+			bool bConnected = false;
+			uint8 DeviceClass = 0;
+			TMap<int32, int32> Ints;
+			TMap<int32, float> Floats;
+			TMap<int32, FString> Strings;
+		};
+
+		bool bAvailable = true;
+		TArray<FMockDevice> Devices;
+		TArray<FOpenVRDeviceEvent> PendingEvents;
+
+		int32 NumConnectionReads = 0;
+		int32 NumPropertyReads = 0;
+
+		// Runs on every property read, lets a test change the devices while the cache is mid query
+		TFunction<void(int32, int32)> OnPropertyRead;
+
+		FMockDevicePropertySource(int32 NumSlots)
+		{
+			Devices.SetNum(NumSlots);
+		}
+
+		void SetDevice(int32 DeviceIndex, bool bConnected, uint8 DeviceClass, bool bSendEvent)
+		{
+			Devices[DeviceIndex].bConnected = bConnected;
+			Devices[DeviceIndex].DeviceClass = bConnected ? DeviceClass : 0;
+
+			if (bSendEvent)
+				PendingEvents.Add(FOpenVRDeviceEvent(bConnected ? EOpenVRDeviceEventType::Connected : EOpenVRDeviceEventType::Disconnected, DeviceIndex));
+		}
+
+		virtual bool IsAvailable() override { return bAvailable; }
+		virtual int32 GetMaxDeviceCount() override { return Devices.Num(); }
+
+		virtual bool IsDeviceConnected(int32 DeviceIndex) override
+		{
+			++NumConnectionReads;
+			return Devices.IsValidIndex(DeviceIndex) && Devices[DeviceIndex].bConnected;
+		}
+
+		virtual uint8 GetDeviceClass(int32 DeviceIndex) override
+		{
+			++NumConnectionReads;
+			return Devices.IsValidIndex(DeviceIndex) ? Devices[DeviceIndex].DeviceClass : 0;
+		}
+
+		template<typename ValueType>
+		bool Read(int32 DeviceIndex, int32 PropertyId, const TMap<int32, ValueType> FMockDevice::* Values, ValueType & OutValue)
+		{
+			++NumPropertyReads;
+
+			if (OnPropertyRead)
+				OnPropertyRead(DeviceIndex, PropertyId);
+
+			if (!Devices.IsValidIndex(DeviceIndex) || !Devices[DeviceIndex].bConnected)
+				return false;
+
+			const ValueType * Value = (Devices[DeviceIndex].*Values).Find(PropertyId);
+			if (Value)
+				OutValue = *Value;
+
+			return Value != nullptr;
+		}
+
+		virtual bool GetStringProperty(int32 DeviceIndex, int32 PropertyId, FString & OutValue) override { return Read(DeviceIndex, PropertyId, &FMockDevice::Strings, OutValue); }
+		virtual bool GetFloatProperty(int32 DeviceIndex, int32 PropertyId, float & OutValue) override { return Read(DeviceIndex, PropertyId, &FMockDevice::Floats, OutValue); }
+		virtual bool GetInt32Property(int32 DeviceIndex, int32 PropertyId, int32 & OutValue) override { return Read(DeviceIndex, PropertyId, &FMockDevice::Ints, OutValue); }
+		virtual bool GetBoolProperty(int32 DeviceIndex, int32 PropertyId, bool & OutValue) override { ++NumPropertyReads; return false; }
+		virtual bool GetUInt64Property(int32 DeviceIndex, int32 PropertyId, uint64 & OutValue) override { ++NumPropertyReads; return false; }
+		virtual bool GetMatrix34Property(int32 DeviceIndex, int32 PropertyId, FMatrix & OutValue) override { ++NumPropertyReads; return false; }
+
+		virtual void PollEvents(TArray<FOpenVRDeviceEvent> & OutEvents) override
+		{
+			OutEvents.Append(PendingEvents);
+			PendingEvents.Reset();
+		}
+	};
+
+	// An HMD, two controllers (left and right role) and a tracker without a role
+	TSharedPtr<FMockDevicePropertySource> MakeRig(int32 NumSlots = 16)
+	{
+		TSharedPtr<FMockDevicePropertySource> Mock = MakeShareable(new FMockDevicePropertySource(NumSlots));
+		Mock->SetDevice(0, true, ClassHMD, false);
+		Mock->SetDevice(1, true, ClassController, false);
+		Mock->SetDevice(2, true, ClassController, false);
+		Mock->SetDevice(3, true, ClassTracker, false);
+
+		Mock->Devices[1].Ints.Add(PropRoleHint, 1);
+		Mock->Devices[2].Ints.Add(PropRoleHint, 2);
+		Mock->Devices[3].Ints.Add(PropRoleHint, 0);
+
+		for (int32 i = 0; i < 4; ++i)
+		{
+			Mock->Devices[i].Strings.Add(PropModelNumber, FString::Printf(TEXT("Model %d"), i));
+			Mock->Devices[i].Strings.Add(PropSerialNumber, FString::Printf(TEXT("SN-%04d"), i));
+			Mock->Devices[i].Floats.Add(PropBatteryPercentage, 0.5f + (i * 0.1f));
+		}
+
+		return Mock;
+	}
+
+	// Sets a console variable for the length of a test
+	struct FScopedCVar
+	{
+		IConsoleVariable * Variable;
+		FString OldValue;
+
+		FScopedCVar(const TCHAR * Name, const TCHAR * Value)
+		{
+			Variable = IConsoleManager::Get().FindConsoleVariable(Name);
+			if (Variable)
+			{
+				OldValue = Variable->GetString();
+				Variable->Set(Value, ECVF_SetByCode);
+			}
+		}
+
+		~FScopedCVar()
+		{
+			if (Variable)
+				Variable->Set(*OldValue, ECVF_SetByCode);
+		}
+	};
+
+	// Points the shared cache at a mock for the length of a test, then back at the runtime
+	struct FScopedMockSource
+	{
+		FScopedMockSource(TSharedPtr<FMockDevicePropertySource> Mock)
+		{
+			FOpenVRDevicePropertyCache::Get().SetSource(Mock);
+		}
+
+		~FScopedMockSource()
+		{
+			FOpenVRDevicePropertyCache::Get().SetSource(nullptr);
+		}
+	};
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FOpenVRDevicePropertyCacheQueryTest, "OpenVRExpansionPlugin.DevicePropertyCache.Queries", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FOpenVRDevicePropertyCacheQueryTest::RunTest(const FString& Parameters)
+{
+	using namespace OpenVRDevicePropertyCacheTests;
+
+	FScopedCVar PollInterval(TEXT("vr.OpenVR.DeviceConnectionPollInterval"), TEXT("1000"));
+	FScopedCVar VolatileInterval(TEXT("vr.OpenVR.VolatilePropertyRefreshInterval"), TEXT("1000"));
+
+	TSharedPtr<FMockDevicePropertySource> Mock = MakeRig();
+	FScopedMockSource ScopedSource(Mock);
+	FOpenVRDevicePropertyCache & Cache = FOpenVRDevicePropertyCache::Get();
+
+	TestTrue(TEXT("The mock is available"), Cache.IsAvailable());
+
+	TArray<int32> Found;
+	Cache.GetDevices(Found);
+	TestTrue(TEXT("Every occupied slot is listed in order"), Found == TArray<int32>({ 0, 1, 2, 3 }));
+
+	Found.Reset();
+	Cache.GetDevicesByClass(ClassController, Found);
+	TestTrue(TEXT("Controllers are indexed by class"), Found == TArray<int32>({ 1, 2 }));
+
+	Found.Reset();
+	Cache.GetDevicesByRole(1, Found);
+	TestTrue(TEXT("The left hand role is found"), Found == TArray<int32>({ 1 }));
+
+	Found.Reset();
+	Cache.GetDevicesByRole(0, Found);
+	TestTrue(TEXT("A tracker with no role hint has the invalid role"), Found == TArray<int32>({ 3 }));
+
+	FString Serial;
+	const int32 ReadsBefore = Mock->NumPropertyReads;
+	TestTrue(TEXT("A string property is read"), Cache.GetStringProperty(2, PropSerialNumber, Serial) && Serial == TEXT("SN-0002"));
+	TestTrue(TEXT("Reading it again hits the cache"), Cache.GetStringProperty(2, PropSerialNumber, Serial) && Mock->NumPropertyReads == ReadsBefore + 1);
+
+	FString Missing;
+	TestFalse(TEXT("A property the device doesn't have fails"), Cache.GetStringProperty(2, PropRenderModelName, Missing));
+	TestFalse(TEXT("An empty slot has no properties"), Cache.GetStringProperty(9, PropSerialNumber, Missing));
+	TestFalse(TEXT("Out of range slots are rejected"), Cache.GetStringProperty(64, PropSerialNumber, Missing));
+
+	// A silent change with no event is only seen by the next sweep
+	Mock->SetDevice(5, true, ClassTracker, false);
+	TestFalse(TEXT("A connect without an event waits for the sweep"), Cache.IsDeviceConnected(5));
+	Cache.Invalidate();
+	TestTrue(TEXT("Invalidate sweeps on the next query"), Cache.IsDeviceConnected(5));
+
+	// Events are picked up on the next query without a sweep
+	const int32 ConnectionReads = Mock->NumConnectionReads;
+	Mock->SetDevice(6, true, ClassController, true);
+	TestTrue(TEXT("A connect event is seen right away"), Cache.IsDeviceConnected(6) && Cache.GetDeviceClass(6) == ClassController);
+	TestTrue(TEXT("An event doesn't sweep every slot"), Mock->NumConnectionReads - ConnectionReads < Mock->Devices.Num());
+
+	Mock->SetDevice(2, false, 0, true);
+	TestFalse(TEXT("A disconnect event is seen right away"), Cache.IsDeviceConnected(2));
+	TestFalse(TEXT("A disconnected devices properties are dropped"), Cache.GetStringProperty(2, PropSerialNumber, Serial));
+
+	Mock->bAvailable = false;
+	TestFalse(TEXT("Losing the runtime drops every device"), Cache.IsAvailable() || Cache.IsDeviceConnected(0));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FOpenVRDevicePropertyCacheEventTest, "OpenVRExpansionPlugin.DevicePropertyCache.Events", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FOpenVRDevicePropertyCacheEventTest::RunTest(const FString& Parameters)
+{
+	using namespace OpenVRDevicePropertyCacheTests;
+
+	FScopedCVar PollInterval(TEXT("vr.OpenVR.DeviceConnectionPollInterval"), TEXT("1000"));
+	FScopedCVar VolatileInterval(TEXT("vr.OpenVR.VolatilePropertyRefreshInterval"), TEXT("1000"));
+
+	TSharedPtr<FMockDevicePropertySource> Mock = MakeRig();
+	FScopedMockSource ScopedSource(Mock);
+	FOpenVRDevicePropertyCache & Cache = FOpenVRDevicePropertyCache::Get();
+
+	TArray<TPair<int32, bool>> ConnectionLog;
+	TArray<TPair<int32, int32>> PropertyLog;
+	FDelegateHandle ConnectionHandle = Cache.OnDeviceConnectionChanged.AddLambda([&ConnectionLog](int32 DeviceIndex, bool bConnected) { ConnectionLog.Add(TPair<int32, bool>(DeviceIndex, bConnected)); });
+	FDelegateHandle PropertyHandle = Cache.OnPropertyChanged.AddLambda([&PropertyLog](int32 DeviceIndex, int32 PropertyId) { PropertyLog.Add(TPair<int32, int32>(DeviceIndex, PropertyId)); });
+
+	TestTrue(TEXT("The mock is available"), Cache.IsAvailable());
+	TestEqual(TEXT("The first sweep reports every device"), ConnectionLog.Num(), 4);
+
+	// Within a sweep disconnects go out before connects
+	ConnectionLog.Reset();
+	Mock->SetDevice(7, true, ClassTracker, false);
+	Mock->SetDevice(3, false, 0, false);
+	Cache.Update(true);
+	TestTrue(TEXT("A sweep reports disconnects first"), ConnectionLog.Num() == 2 && ConnectionLog[0] == TPair<int32, bool>(3, false) && ConnectionLog[1] == TPair<int32, bool>(7, true));
+
+	// Watched properties report changes, the first read is not a change
+	Cache.AddWatchedProperty(PropModelNumber);
+	FString Model;
+	Cache.GetStringProperty(1, PropModelNumber, Model);
+	TestEqual(TEXT("The first read of a watched property is not a change"), PropertyLog.Num(), 0);
+
+	Mock->Devices[1].Strings[PropModelNumber] = TEXT("Model 1b");
+	Mock->PendingEvents.Add(FOpenVRDeviceEvent(EOpenVRDeviceEventType::PropertyChanged, 1, PropModelNumber));
+	Cache.Update();
+	TestTrue(TEXT("A watched property changed by an event is reported"), PropertyLog.Num() == 1 && PropertyLog[0] == TPair<int32, int32>(1, PropModelNumber));
+	TestTrue(TEXT("And the new value is cached"), Cache.GetStringProperty(1, PropModelNumber, Model) && Model == TEXT("Model 1b"));
+
+	// Unwatched properties are dropped by an event and re-read on next use
+	FString Serial;
+	Cache.GetStringProperty(1, PropSerialNumber, Serial);
+	Mock->Devices[1].Strings[PropSerialNumber] = TEXT("SN-9999");
+	Mock->PendingEvents.Add(FOpenVRDeviceEvent(EOpenVRDeviceEventType::PropertyChanged, 1, PropSerialNumber));
+	TestTrue(TEXT("An unwatched property is re-read after its event"), Cache.GetStringProperty(1, PropSerialNumber, Serial) && Serial == TEXT("SN-9999"));
+	TestEqual(TEXT("Unwatched changes are not broadcast"), PropertyLog.Num(), 1);
+
+	Cache.RemoveWatchedProperty(PropModelNumber);
+	Cache.OnDeviceConnectionChanged.Remove(ConnectionHandle);
+	Cache.OnPropertyChanged.Remove(PropertyHandle);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FOpenVRDevicePropertyCacheReentrancyTest, "OpenVRExpansionPlugin.DevicePropertyCache.Reentrancy", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FOpenVRDevicePropertyCacheReentrancyTest::RunTest(const FString& Parameters)
+{
+	using namespace OpenVRDevicePropertyCacheTests;
+
+	FScopedCVar PollInterval(TEXT("vr.OpenVR.DeviceConnectionPollInterval"), TEXT("1000"));
+	FScopedCVar VolatileInterval(TEXT("vr.OpenVR.VolatilePropertyRefreshInterval"), TEXT("1000"));
+
+	TSharedPtr<FMockDevicePropertySource> Mock = MakeRig();
+	Mock->SetDevice(4, true, ClassTracker, false);
+	Mock->Devices[4].Ints.Add(PropRoleHint, 1);
+
+	FScopedMockSource ScopedSource(Mock);
+	FOpenVRDevicePropertyCache & Cache = FOpenVRDevicePropertyCache::Get();
+	TestTrue(TEXT("The mock is available"), Cache.IsAvailable());
+
+	// Reading the first role hint unplugs the other controller, the next read processes that and rebuilds the class index
+	FMockDevicePropertySource * MockPtr = Mock.Get();
+	Mock->OnPropertyRead = [MockPtr](int32 DeviceIndex, int32 PropertyId)
+	{
+		if (DeviceIndex == 1 && PropertyId == PropRoleHint)
+			MockPtr->SetDevice(2, false, 0, true);
+	};
+
+	// Listeners that query the cache from the broadcast
+	int32 NumReentrantQueries = 0;
+	FDelegateHandle Handle = Cache.OnDeviceConnectionChanged.AddLambda([&Cache, &NumReentrantQueries](int32 DeviceIndex, bool bConnected)
+	{
+		TArray<int32> Controllers;
+		Cache.GetDevicesByClass(ClassController, Controllers);
+		Cache.Invalidate(DeviceIndex);
+		++NumReentrantQueries;
+	});
+
+	TArray<int32> Found;
+	Cache.GetDevicesByRole(1, Found);
+	TestTrue(TEXT("Devices changing mid lookup still gives the devices with the role"), Found == TArray<int32>({ 1, 4 }));
+	TestTrue(TEXT("The disconnect was broadcast during the lookup"), NumReentrantQueries > 0);
+
+	Mock->OnPropertyRead = nullptr;
+	Found.Reset();
+	Cache.GetDevicesByRole(2, Found);
+	TestEqual(TEXT("The unplugged controller no longer has a role"), Found.Num(), 0);
+
+	// The runtime going away mid lookup resets every device
+	Mock->OnPropertyRead = [MockPtr](int32 DeviceIndex, int32 PropertyId) { MockPtr->bAvailable = false; };
+	Cache.Invalidate();
+	Found.Reset();
+	Cache.GetDevicesByRole(1, Found);
+	TestTrue(TEXT("Losing the runtime mid lookup is survived"), Found.Num() <= 1);
+
+	Cache.OnDeviceConnectionChanged.Remove(Handle);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FOpenVRDevicePropertyCacheBenchmark, "OpenVRExpansionPlugin.DevicePropertyCache.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FOpenVRDevicePropertyCacheBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace OpenVRDevicePropertyCacheTests;
+
+	FScopedCVar VolatileInterval(TEXT("vr.OpenVR.VolatilePropertyRefreshInterval"), TEXT("1.0"));
+
+	// A full 64 slot runtime with a busy room, queried the way the function library is every frame
+	TSharedPtr<FMockDevicePropertySource> Mock = MakeRig(64);
+	for (int32 i = 4; i < 16; ++i)
+	{
+		Mock->SetDevice(i, true, ClassTracker, false);
+		Mock->Devices[i].Ints.Add(PropRoleHint, 0);
+		Mock->Devices[i].Strings.Add(PropModelNumber, TEXT("Tracker"));
+		Mock->Devices[i].Strings.Add(PropSerialNumber, FString::Printf(TEXT("SN-%04d"), i));
+		Mock->Devices[i].Floats.Add(PropBatteryPercentage, 0.8f);
+	}
+
+	FScopedMockSource ScopedSource(Mock);
+	FOpenVRDevicePropertyCache & Cache = FOpenVRDevicePropertyCache::Get();
+	Cache.IsAvailable();
+
+	FScopedCVar PollInterval(TEXT("vr.OpenVR.DeviceConnectionPollInterval"), TEXT("0.5"));
+	const int32 NumFrames = 1000;
+
+	// Sweeping every frame is what a poll interval of 0 does, the default interval leaves it to events
+	for (bool bSweepEveryFrame : { true, false })
+	{
+		Mock->NumConnectionReads = 0;
+		Mock->NumPropertyReads = 0;
+		int32 NumQueries = 0;
+
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			Cache.Update(bSweepEveryFrame);
+
+			TArray<int32> Found;
+			Cache.GetDevicesByRole(1, Found);
+			++NumQueries;
+
+			for (int32 DeviceIndex = 0; DeviceIndex < 16; ++DeviceIndex)
+			{
+				FString Value;
+				float Battery = 0.0f;
+				Cache.GetStringProperty(DeviceIndex, PropModelNumber, Value);
+				Cache.GetStringProperty(DeviceIndex, PropSerialNumber, Value);
+				Cache.GetFloatProperty(DeviceIndex, PropBatteryPercentage, Battery);
+				NumQueries += 3;
+			}
+		}
+		const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+		AddInfo(FString::Printf(TEXT("%s: %.3f us per query, %.2f slot reads and %.2f property reads per frame against %d uncached"),
+			bSweepEveryFrame ? TEXT("Sweeping every frame") : TEXT("Sweeping every 0.5s"), (Seconds * 1000000.0) / NumQueries,
+			(float)Mock->NumConnectionReads / NumFrames, (float)Mock->NumPropertyReads / NumFrames, NumQueries / NumFrames));
+
+		TestTrue(TEXT("Most property reads are served from the cache"), Mock->NumPropertyReads < NumQueries / 10);
+
+		if (!bSweepEveryFrame)
+			TestTrue(TEXT("The interval sweeps far less than once a frame"), Mock->NumConnectionReads < NumFrames * 2);
+	}
+
+	return true;
+}
+
+#endif
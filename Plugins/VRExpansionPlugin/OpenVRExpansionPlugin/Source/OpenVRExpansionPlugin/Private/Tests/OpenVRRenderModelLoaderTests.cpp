@@ -0,0 +1,504 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/ScopeLock.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "OpenVRRenderModelLoader.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace OpenVRRenderModelLoaderTests
+{
+	// Serves a triangle for every model name after a few polls, every poll is counted
+	class FFakeRenderModelProvider : public IOpenVRRenderModelProvider
+	{
+	public:
+
+		FThreadSafeBool bAvailable;
+		// Closed, every poll reports Loading
+		FThreadSafeBool bGateOpen;
+		// Holds the worker inside the poll, stands in for a runtime call that never returns
+		FThreadSafeBool bStuck;
+
+		// Polls of a model that report Loading before it is handed over
+		int32 PollsBeforeLoaded;
+
+		// Fixed before any load starts, only read from the workers
+		TSet<FString> FailingModels;
+
+		FThreadSafeCounter NumPolls;
+		FThreadSafeCounter NumActivePolls;
+
+		FFakeRenderModelProvider() :
+			bAvailable(true),
+			bGateOpen(true),
+			bStuck(false),
+			PollsBeforeLoaded(2)
+		{}
+
+		virtual bool IsAvailable() override { return bAvailable; }
+
+		virtual EOpenVRRenderModelPollResult PollRenderModel(const FString & RenderModelName, FOpenVRRenderModelData & OutData) override
+		{
+			NumPolls.Increment();
+			NumActivePolls.Increment();
+
+			int32 ModelPolls = 0;
+			{
+				FScopeLock ScopeLock(&Lock);
+				ModelPolls = ++PollsPerModel.FindOrAdd(RenderModelName);
+			}
+
+			while (bStuck)
+			{
+				FPlatformProcess::Sleep(0.001f);
+			}
+
+			EOpenVRRenderModelPollResult Result = EOpenVRRenderModelPollResult::Loading;
+			if (FailingModels.Contains(RenderModelName))
+			{
+				Result = EOpenVRRenderModelPollResult::Failed;
+			}
+			else if (bGateOpen && ModelPolls > PollsBeforeLoaded)
+			{
+				OutData.RenderModelName = RenderModelName;
+				OutData.Vertices = { FVector(0, 0, 0), FVector(0, 10, 0), FVector(0, 0, 10) };
+				OutData.Normals = { FVector(-1, 0, 0), FVector(-1, 0, 0), FVector(-1, 0, 0) };
+				OutData.UV0 = { FVector2D(0, 0), FVector2D(1, 0), FVector2D(0, 1) };
+				OutData.Triangles = { 0, 1, 2 };
+
+				FScopeLock ScopeLock(&Lock);
+				++LoadsPerModel.FindOrAdd(RenderModelName);
+				Result = EOpenVRRenderModelPollResult::Loaded;
+			}
+
+			NumActivePolls.Decrement();
+			return Result;
+		}
+
+		int32 GetPolls(const FString & RenderModelName)
+		{
+			FScopeLock ScopeLock(&Lock);
+			const int32 * Polls = PollsPerModel.Find(RenderModelName);
+			return Polls ? *Polls : 0;
+		}
+
+		int32 GetLoads(const FString & RenderModelName)
+		{
+			FScopeLock ScopeLock(&Lock);
+			const int32 * Loads = LoadsPerModel.Find(RenderModelName);
+			return Loads ? *Loads : 0;
+		}
+
+	private:
+		FCriticalSection Lock;
+		TMap<FString, int32> PollsPerModel;
+		TMap<FString, int32> LoadsPerModel;
+	};
+
+	typedef TSharedPtr<FFakeRenderModelProvider, ESPMode::ThreadSafe> FFakeRenderModelProviderPtr;
+
+	struct FScopedCVar
+	{
+		IConsoleVariable * Variable;
+		FString OldValue;
+
+		FScopedCVar(const TCHAR * Name, const TCHAR * Value)
+		{
+			Variable = IConsoleManager::Get().FindConsoleVariable(Name);
+			if (Variable)
+			{
+				OldValue = Variable->GetString();
+				Variable->Set(Value, ECVF_SetByCode);
+			}
+		}
+
+		~FScopedCVar()
+		{
+			if (Variable)
+				Variable->Set(*OldValue, ECVF_SetByCode);
+		}
+	};
+
+	// Starts the shared loader clean on a fake with no disk cache and fast polls, then hands it back to the runtime
+	struct FScopedFakeProvider
+	{
+		FScopedCVar DiskCache;
+		FScopedCVar PollInterval;
+
+		FScopedFakeProvider(FFakeRenderModelProviderPtr Fake) :
+			DiskCache(TEXT("vr.OpenVR.RenderModelDiskCache"), TEXT("0")),
+			PollInterval(TEXT("vr.OpenVR.RenderModelPollInterval"), TEXT("0.001"))
+		{
+			FOpenVRRenderModelLoader & Loader = FOpenVRRenderModelLoader::Get();
+			Loader.Shutdown();
+			Loader.Initialize();
+			Loader.SetProvider(Fake);
+		}
+
+		~FScopedFakeProvider()
+		{
+			FOpenVRRenderModelLoader & Loader = FOpenVRRenderModelLoader::Get();
+			Loader.Shutdown();
+			Loader.Initialize();
+		}
+	};
+
+	// Finished loads come back through the game thread task queue, which nothing pumps while a test runs
+	bool PumpUntil(TFunctionRef<bool()> Condition, double Timeout = 5.0)
+	{
+		const double EndTime = FPlatformTime::Seconds() + Timeout;
+		while (!Condition())
+		{
+			if (FPlatformTime::Seconds() > EndTime)
+				return false;
+
+			FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+			FPlatformProcess::Sleep(0.001f);
+		}
+		return true;
+	}
+
+	struct FRequestResult
+	{
+		int32 NumCalls = 0;
+		FOpenVRRenderModelDataPtr Model;
+	};
+
+	FOnOpenVRRenderModelLoaded MakeCallback(TSharedPtr<FRequestResult> Result)
+	{
+		return FOnOpenVRRenderModelLoaded::CreateLambda([Result](FOpenVRRenderModelDataPtr Model)
+		{
+			++Result->NumCalls;
+			Result->Model = Model;
+		});
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FOpenVRRenderModelLoaderLoadTest, "OpenVRExpansionPlugin.RenderModelLoader.Load", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FOpenVRRenderModelLoaderLoadTest::RunTest(const FString& Parameters)
+{
+	using namespace OpenVRRenderModelLoaderTests;
+
+	FFakeRenderModelProviderPtr Fake = MakeShared<FFakeRenderModelProvider, ESPMode::ThreadSafe>();
+	Fake->FailingModels.Add(TEXT("broken"));
+	FScopedFakeProvider ScopedProvider(Fake);
+	FOpenVRRenderModelLoader & Loader = FOpenVRRenderModelLoader::Get();
+
+	// A fresh model loads off the game thread and is cached
+	{
+		TSharedPtr<FRequestResult> Result = MakeShared<FRequestResult>();
+		const int32 Handle = Loader.RequestModel(TEXT("controller"), MakeCallback(Result));
+
+		TestTrue(TEXT("A model that isn't cached gets a handle"), Handle != INDEX_NONE);
+		TestTrue(TEXT("The model is loading"), Loader.IsLoading(TEXT("controller")));
+		TestEqual(TEXT("The callback waits for the worker"), Result->NumCalls, 0);
+
+		TestTrue(TEXT("The load finishes"), PumpUntil([&]() { return Result->NumCalls > 0; }));
+		TestEqual(TEXT("The callback runs once"), Result->NumCalls, 1);
+		TestTrue(TEXT("The callback gets the model"), Result->Model.IsValid() && Result->Model->RenderModelName == TEXT("controller"));
+		TestEqual(TEXT("The model keeps its triangles"), Result->Model.IsValid() ? Result->Model->Triangles.Num() : 0, 3);
+		TestEqual(TEXT("The provider was polled until it was ready"), Fake->GetPolls(TEXT("controller")), Fake->PollsBeforeLoaded + 1);
+		TestFalse(TEXT("Nothing is loading after it finishes"), Loader.IsLoading(TEXT("controller")));
+		TestTrue(TEXT("The model is cached"), Loader.FindCachedModel(TEXT("controller")) == Result->Model);
+	}
+
+	// A cached model is handed back straight away without touching the provider
+	{
+		const int32 PollsBefore = Fake->NumPolls.GetValue();
+		TSharedPtr<FRequestResult> Result = MakeShared<FRequestResult>();
+		const int32 Handle = Loader.RequestModel(TEXT("controller"), MakeCallback(Result));
+
+		TestEqual(TEXT("A cached model has no handle"), Handle, (int32)INDEX_NONE);
+		TestEqual(TEXT("A cached model calls back inline"), Result->NumCalls, 1);
+		TestEqual(TEXT("A cached model isn't polled"), Fake->NumPolls.GetValue(), PollsBefore);
+
+		FOpenVRRenderModelDataPtr Polled;
+		TestTrue(TEXT("PollModel reports a cached model as loaded"), Loader.PollModel(TEXT("controller"), Polled) == EOpenVRRenderModelPollResult::Loaded);
+		TestTrue(TEXT("PollModel hands back the cached model"), Polled == Result->Model);
+	}
+
+	// PollModel reports a failure once, the next poll tries again
+	{
+		FOpenVRRenderModelDataPtr Polled;
+		TestTrue(TEXT("PollModel starts a load"), Loader.PollModel(TEXT("broken"), Polled) == EOpenVRRenderModelPollResult::Loading);
+		TestTrue(TEXT("The failed load finishes"), PumpUntil([&]() { return !Loader.IsLoading(TEXT("broken")); }));
+		TestTrue(TEXT("PollModel reports the failure"), Loader.PollModel(TEXT("broken"), Polled) == EOpenVRRenderModelPollResult::Failed);
+		TestFalse(TEXT("A failed poll has no model"), Polled.IsValid());
+		TestTrue(TEXT("The next poll retries"), Loader.PollModel(TEXT("broken"), Polled) == EOpenVRRenderModelPollResult::Loading);
+		PumpUntil([&]() { return !Loader.IsLoading(TEXT("broken")); });
+	}
+
+	// Without a provider the request fails inline
+	{
+		Fake->bAvailable = false;
+		TSharedPtr<FRequestResult> Result = MakeShared<FRequestResult>();
+		const int32 Handle = Loader.RequestModel(TEXT("tracker"), MakeCallback(Result));
+
+		TestEqual(TEXT("An unavailable provider gives no handle"), Handle, (int32)INDEX_NONE);
+		TestEqual(TEXT("An unavailable provider calls back inline"), Result->NumCalls, 1);
+		TestFalse(TEXT("An unavailable provider passes a null model"), Result->Model.IsValid());
+
+		FOpenVRRenderModelDataPtr Polled;
+		TestTrue(TEXT("PollModel fails inline without a provider"), Loader.PollModel(TEXT("tracker"), Polled) == EOpenVRRenderModelPollResult::Failed);
+		Fake->bAvailable = true;
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FOpenVRRenderModelLoaderDedupeTest, "OpenVRExpansionPlugin.RenderModelLoader.Dedupe", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FOpenVRRenderModelLoaderDedupeTest::RunTest(const FString& Parameters)
+{
+	using namespace OpenVRRenderModelLoaderTests;
+
+	FFakeRenderModelProviderPtr Fake = MakeShared<FFakeRenderModelProvider, ESPMode::ThreadSafe>();
+	Fake->bGateOpen = false;
+	FScopedFakeProvider ScopedProvider(Fake);
+	FOpenVRRenderModelLoader & Loader = FOpenVRRenderModelLoader::Get();
+
+	const int32 NumRequests = 8;
+	TArray<TSharedPtr<FRequestResult>> Results;
+	TSet<int32> Handles;
+	for (int32 i = 0; i < NumRequests; ++i)
+	{
+		Results.Add(MakeShared<FRequestResult>());
+		Handles.Add(Loader.RequestModel(TEXT("controller"), MakeCallback(Results.Last())));
+	}
+
+	// A second model loads alongside without joining the first
+	TSharedPtr<FRequestResult> OtherResult = MakeShared<FRequestResult>();
+	Loader.RequestModel(TEXT("hmd"), MakeCallback(OtherResult));
+
+	TestEqual(TEXT("Every request gets its own handle"), Handles.Num(), NumRequests);
+	TestTrue(TEXT("The shared load is polling"), PumpUntil([&]() { return Fake->GetPolls(TEXT("controller")) > 0; }));
+
+	Fake->bGateOpen = true;
+	TestTrue(TEXT("Every waiter is called"), PumpUntil([&]()
+	{
+		return OtherResult->NumCalls > 0 && Results.FindByPredicate([](const TSharedPtr<FRequestResult> & Result) { return Result->NumCalls == 0; }) == nullptr;
+	}));
+
+	TestEqual(TEXT("One provider load for every request of the same model"), Fake->GetLoads(TEXT("controller")), 1);
+	TestEqual(TEXT("The other model loads on its own"), Fake->GetLoads(TEXT("hmd")), 1);
+
+	bool bAllShareModel = true;
+	for (const TSharedPtr<FRequestResult> & Result : Results)
+	{
+		bAllShareModel &= Result->NumCalls == 1 && Result->Model.IsValid() && Result->Model == Results[0]->Model;
+	}
+	TestTrue(TEXT("Every waiter is called once with the same model"), bAllShareModel);
+	TestTrue(TEXT("The other model isn't shared"), OtherResult->Model.IsValid() && OtherResult->Model != Results[0]->Model);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FOpenVRRenderModelLoaderCancelTest, "OpenVRExpansionPlugin.RenderModelLoader.Cancel", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FOpenVRRenderModelLoaderCancelTest::RunTest(const FString& Parameters)
+{
+	using namespace OpenVRRenderModelLoaderTests;
+
+	FFakeRenderModelProviderPtr Fake = MakeShared<FFakeRenderModelProvider, ESPMode::ThreadSafe>();
+	Fake->bGateOpen = false;
+	FScopedFakeProvider ScopedProvider(Fake);
+	FOpenVRRenderModelLoader & Loader = FOpenVRRenderModelLoader::Get();
+
+	// The load keeps going while anyone still waits on it
+	{
+		TSharedPtr<FRequestResult> First = MakeShared<FRequestResult>();
+		TSharedPtr<FRequestResult> Second = MakeShared<FRequestResult>();
+		const int32 FirstHandle = Loader.RequestModel(TEXT("controller"), MakeCallback(First));
+		Loader.RequestModel(TEXT("controller"), MakeCallback(Second));
+		PumpUntil([&]() { return Fake->GetPolls(TEXT("controller")) > 0; });
+
+		Loader.CancelRequest(FirstHandle);
+		TestTrue(TEXT("A load with waiters left keeps loading"), Loader.IsLoading(TEXT("controller")));
+
+		Fake->bGateOpen = true;
+		TestTrue(TEXT("The remaining waiter is called"), PumpUntil([&]() { return Second->NumCalls > 0; }));
+		TestEqual(TEXT("The cancelled waiter is never called"), First->NumCalls, 0);
+		TestTrue(TEXT("The remaining waiter gets the model"), Second->Model.IsValid());
+
+		Loader.CancelRequest(FirstHandle);
+		Loader.CancelRequest(INDEX_NONE);
+	}
+
+	// Once the last waiter leaves the worker stops polling
+	{
+		Fake->bGateOpen = false;
+		TSharedPtr<FRequestResult> First = MakeShared<FRequestResult>();
+		TSharedPtr<FRequestResult> Second = MakeShared<FRequestResult>();
+		const int32 FirstHandle = Loader.RequestModel(TEXT("hmd"), MakeCallback(First));
+		const int32 SecondHandle = Loader.RequestModel(TEXT("hmd"), MakeCallback(Second));
+		PumpUntil([&]() { return Fake->GetPolls(TEXT("hmd")) > 0; });
+
+		Loader.CancelRequest(FirstHandle);
+		Loader.CancelRequest(SecondHandle);
+		TestFalse(TEXT("A load with no waiters isn't pending"), Loader.IsLoading(TEXT("hmd")));
+
+		// One poll can already be running when the flag flips
+		FPlatformProcess::Sleep(0.02f);
+		const int32 PollsAfterCancel = Fake->GetPolls(TEXT("hmd"));
+		FPlatformProcess::Sleep(0.05f);
+		TestEqual(TEXT("The cancelled worker stops polling"), Fake->GetPolls(TEXT("hmd")), PollsAfterCancel);
+
+		Fake->bGateOpen = true;
+		PumpUntil([&]() { return false; }, 0.05);
+		TestEqual(TEXT("Cancelled waiters are never called"), First->NumCalls + Second->NumCalls, 0);
+		TestFalse(TEXT("A cancelled load caches nothing"), Loader.FindCachedModel(TEXT("hmd")).IsValid());
+
+		// Asking again starts a new load
+		TSharedPtr<FRequestResult> Again = MakeShared<FRequestResult>();
+		Loader.RequestModel(TEXT("hmd"), MakeCallback(Again));
+		TestTrue(TEXT("A new request after a cancel loads"), PumpUntil([&]() { return Again->NumCalls > 0; }) && Again->Model.IsValid());
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FOpenVRRenderModelLoaderShutdownTest, "OpenVRExpansionPlugin.RenderModelLoader.Shutdown", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FOpenVRRenderModelLoaderShutdownTest::RunTest(const FString& Parameters)
+{
+	using namespace OpenVRRenderModelLoaderTests;
+
+	FScopedCVar ShutdownTimeout(TEXT("vr.OpenVR.RenderModelShutdownTimeout"), TEXT("0.1"));
+	FOpenVRRenderModelLoader & Loader = FOpenVRRenderModelLoader::Get();
+
+	// More loads than pool threads, so some are still queued when Shutdown runs
+	{
+		FFakeRenderModelProviderPtr Fake = MakeShared<FFakeRenderModelProvider, ESPMode::ThreadSafe>();
+		Fake->bGateOpen = false;
+		FScopedFakeProvider ScopedProvider(Fake);
+
+		const int32 NumModels = 64;
+		TArray<TSharedPtr<FRequestResult>> Results;
+		for (int32 i = 0; i < NumModels; ++i)
+		{
+			Results.Add(MakeShared<FRequestResult>());
+			Loader.RequestModel(FString::Printf(TEXT("model_%d"), i), MakeCallback(Results.Last()));
+		}
+		PumpUntil([&]() { return Fake->NumPolls.GetValue() > 0; });
+
+		const double StartTime = FPlatformTime::Seconds();
+		Loader.Shutdown();
+		const double Elapsed = FPlatformTime::Seconds() - StartTime;
+		AddInfo(FString::Printf(TEXT("Shutdown with %d loads in flight took %.2f ms"), NumModels, Elapsed * 1000.0));
+
+		bool bAllFailed = true;
+		for (const TSharedPtr<FRequestResult> & Result : Results)
+		{
+			bAllFailed &= Result->NumCalls == 1 && !Result->Model.IsValid();
+		}
+		TestTrue(TEXT("Shutdown fails every waiter once"), bAllFailed);
+		TestTrue(TEXT("Shutdown doesn't wait out the timeout for workers that stop at their next poll"), Elapsed < 0.1);
+		TestEqual(TEXT("No worker is still polling"), Fake->NumActivePolls.GetValue(), 0);
+
+		const int32 PollsAfterShutdown = Fake->NumPolls.GetValue();
+		FPlatformProcess::Sleep(0.05f);
+		TestEqual(TEXT("Queued loads never start"), Fake->NumPolls.GetValue(), PollsAfterShutdown);
+
+		TSharedPtr<FRequestResult> AfterShutdown = MakeShared<FRequestResult>();
+		TestEqual(TEXT("Requests after Shutdown fail inline"), Loader.RequestModel(TEXT("model_0"), MakeCallback(AfterShutdown)), (int32)INDEX_NONE);
+		TestEqual(TEXT("Requests after Shutdown call back"), AfterShutdown->NumCalls, 1);
+	}
+
+	// A provider call that hangs only holds Shutdown up for the timeout
+	{
+		FFakeRenderModelProviderPtr Fake = MakeShared<FFakeRenderModelProvider, ESPMode::ThreadSafe>();
+		FScopedFakeProvider ScopedProvider(Fake);
+
+		Fake->bStuck = true;
+		TSharedPtr<FRequestResult> Result = MakeShared<FRequestResult>();
+		Loader.RequestModel(TEXT("stuck"), MakeCallback(Result));
+		PumpUntil([&]() { return Fake->NumActivePolls.GetValue() > 0; });
+
+		const double StartTime = FPlatformTime::Seconds();
+		Loader.Shutdown();
+		const double Elapsed = FPlatformTime::Seconds() - StartTime;
+		AddInfo(FString::Printf(TEXT("Shutdown with a hung provider took %.2f ms"), Elapsed * 1000.0));
+
+		TestTrue(TEXT("Shutdown gives up on a hung worker"), Elapsed < 0.5);
+		TestEqual(TEXT("The hung load's waiter is failed"), Result->NumCalls, 1);
+
+		// The abandoned worker still finishes, and its result is dropped
+		Loader.Initialize();
+		Loader.SetProvider(Fake);
+		Fake->bStuck = false;
+		PumpUntil([&]() { return Fake->NumActivePolls.GetValue() == 0; });
+		PumpUntil([&]() { return false; }, 0.05);
+		TestFalse(TEXT("An abandoned load caches nothing"), Loader.FindCachedModel(TEXT("stuck")).IsValid());
+		TestEqual(TEXT("An abandoned load doesn't call back again"), Result->NumCalls, 1);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FOpenVRRenderModelLoaderBenchmarkTest, "OpenVRExpansionPlugin.RenderModelLoader.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FOpenVRRenderModelLoaderBenchmarkTest::RunTest(const FString& Parameters)
+{
+	using namespace OpenVRRenderModelLoaderTests;
+
+	const int32 ModelCounts[] = { 1, 16, 64 };
+	const int32 RequestsPerModel = 16;
+
+	for (int32 NumModels : ModelCounts)
+	{
+		FFakeRenderModelProviderPtr Fake = MakeShared<FFakeRenderModelProvider, ESPMode::ThreadSafe>();
+		FScopedFakeProvider ScopedProvider(Fake);
+		FOpenVRRenderModelLoader & Loader = FOpenVRRenderModelLoader::Get();
+
+		int32 NumCalls = 0;
+		FOnOpenVRRenderModelLoaded Callback = FOnOpenVRRenderModelLoaded::CreateLambda([&NumCalls](FOpenVRRenderModelDataPtr) { ++NumCalls; });
+		const int32 NumRequests = NumModels * RequestsPerModel;
+
+		// Cold, every model goes through the provider once
+		const double ColdStart = FPlatformTime::Seconds();
+		for (int32 Request = 0; Request < RequestsPerModel; ++Request)
+		{
+			for (int32 i = 0; i < NumModels; ++i)
+			{
+				Loader.RequestModel(FString::Printf(TEXT("model_%d"), i), Callback);
+			}
+		}
+		const double RequestSeconds = FPlatformTime::Seconds() - ColdStart;
+		TestTrue(FString::Printf(TEXT("%d models: every request is answered"), NumModels), PumpUntil([&]() { return NumCalls == NumRequests; }, 30.0));
+		const double ColdSeconds = FPlatformTime::Seconds() - ColdStart;
+
+		int32 NumProviderLoads = 0;
+		for (int32 i = 0; i < NumModels; ++i)
+		{
+			NumProviderLoads += Fake->GetLoads(FString::Printf(TEXT("model_%d"), i));
+		}
+		TestEqual(FString::Printf(TEXT("%d models: one provider load per model"), NumModels), NumProviderLoads, NumModels);
+
+		// Warm, everything is served from the cache
+		NumCalls = 0;
+		const double WarmStart = FPlatformTime::Seconds();
+		for (int32 Request = 0; Request < RequestsPerModel; ++Request)
+		{
+			for (int32 i = 0; i < NumModels; ++i)
+			{
+				Loader.RequestModel(FString::Printf(TEXT("model_%d"), i), Callback);
+			}
+		}
+		const double WarmSeconds = FPlatformTime::Seconds() - WarmStart;
+		TestEqual(FString::Printf(TEXT("%d models: cached requests call back inline"), NumModels), NumCalls, NumRequests);
+
+		AddInfo(FString::Printf(TEXT("%d models x %d requests: cold %.2f ms (%.2f us per request queued, %d polls) | cached %.3f us per request"),
+			NumModels, RequestsPerModel, ColdSeconds * 1000.0, RequestSeconds * 1000000.0 / NumRequests, Fake->NumPolls.GetValue(), WarmSeconds * 1000000.0 / NumRequests));
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
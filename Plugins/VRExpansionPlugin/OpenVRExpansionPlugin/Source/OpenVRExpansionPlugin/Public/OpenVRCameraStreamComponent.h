@@ -0,0 +1,241 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "OpenVRExpansionFunctionLibrary.h"
+#include "OpenVRCameraStreamComponent.generated.h"
+
+class UTexture2D;
+class FOpenVRCameraStreamWorker;
+
+// Header of a camera frame, pose is in UE4 axis but still in meters
+struct OPENVREXPANSIONPLUGIN_API FOpenVRCameraFrameHeader
+{
+	uint32 FrameSequence;
+	uint32 Width;
+	uint32 Height;
+	bool bPoseIsValid;
+	FTransform Pose;
+
+	// Microseconds, in the runtimes clock
+	uint64 ExposureTime;
+
+	FOpenVRCameraFrameHeader() :
+		FrameSequence(0),
+		Width(0),
+		Height(0),
+		bPoseIsValid(false),
+		Pose(FTransform::Identity),
+		ExposureTime(0)
+	{}
+};
+
+/**
+* Where the camera stream gets its frames from, the default one reads the HMD camera through the OpenVR runtime.
+* Can be swapped out with UOpenVRCameraStreamComponent::SetFrameSource, FOpenVRSyntheticCameraFrameSource generates test frames.
+* Open and Close are called on the game thread, the frame functions from the streaming thread. Frames are RGBA8.
+*/
+class OPENVREXPANSIONPLUGIN_API IOpenVRCameraFrameSource
+{
+public:
+	virtual ~IOpenVRCameraFrameSource() {}
+
+	virtual bool Open(EOpenVRCameraFrameType FrameType, uint32 & OutWidth, uint32 & OutHeight) = 0;
+	virtual void Close() = 0;
+
+	// Fills in the header of the current frame without reading any pixels, false if there is no frame yet
+	virtual bool GetFrameHeader(FOpenVRCameraFrameHeader & OutHeader) = 0;
+
+	// Reads the current frame, OutHeader is the header of the frame actually read which can be newer than the last GetFrameHeader
+	virtual bool ReadFrame(uint8 * Buffer, uint32 BufferSize, FOpenVRCameraFrameHeader & OutHeader) = 0;
+};
+
+/**
+* Generates a scrolling gradient at a fixed rate, with the frame sequence written into the first pixel.
+* Every StallEveryNFrames frames the read blocks for StallDuration to act like a driver that is slow to hand a frame back.
+*/
+class OPENVREXPANSIONPLUGIN_API FOpenVRSyntheticCameraFrameSource : public IOpenVRCameraFrameSource
+{
+public:
+
+	FOpenVRSyntheticCameraFrameSource(uint32 InWidth = 640, uint32 InHeight = 480, float InFrameRate = 60.0f, int32 InStallEveryNFrames = 0, float InStallDuration = 0.0f);
+
+	virtual bool Open(EOpenVRCameraFrameType FrameType, uint32 & OutWidth, uint32 & OutHeight) override;
+	virtual void Close() override;
+	virtual bool GetFrameHeader(FOpenVRCameraFrameHeader & OutHeader) override;
+	virtual bool ReadFrame(uint8 * Buffer, uint32 BufferSize, FOpenVRCameraFrameHeader & OutHeader) override;
+
+private:
+
+	uint32 CurrentSequence() const;
+
+	uint32 Width;
+	uint32 Height;
+	float FrameRate;
+	int32 StallEveryNFrames;
+	float StallDuration;
+	double StartTime;
+};
+
+// Latest displayed camera frame
+USTRUCT(BlueprintType, Category = "VRExpansionFunctions|SteamVR|VRCamera")
+struct OPENVREXPANSIONPLUGIN_API FBPOpenVRCameraFrameInfo
+{
+	GENERATED_BODY()
+public:
+
+	UPROPERTY(BlueprintReadOnly, Category = "VRCamera")
+		int32 FrameSequence;
+
+	UPROPERTY(BlueprintReadOnly, Category = "VRCamera")
+		int32 Width;
+
+	UPROPERTY(BlueprintReadOnly, Category = "VRCamera")
+		int32 Height;
+
+	// Tracking space pose of the HMD when the frame was exposed
+	UPROPERTY(BlueprintReadOnly, Category = "VRCamera")
+		bool bPoseIsValid;
+
+	UPROPERTY(BlueprintReadOnly, Category = "VRCamera")
+		FTransform Pose;
+
+	// Seconds in the runtimes clock, only useful for comparing frames against each other
+	UPROPERTY(BlueprintReadOnly, Category = "VRCamera")
+		float ExposureTime;
+
+	FBPOpenVRCameraFrameInfo() :
+		FrameSequence(0),
+		Width(0),
+		Height(0),
+		bPoseIsValid(false),
+		Pose(FTransform::Identity),
+		ExposureTime(0.0f)
+	{}
+};
+
+UENUM(BlueprintType)
+enum class EOpenVRCameraFrameDropPolicy : uint8
+{
+	// When every staging buffer is full, overwrite the frame that is waiting to be displayed
+	KeepLatest,
+	// When every staging buffer is full, throw the new frame away
+	KeepOldest
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOpenVRCameraFrameUpdatedSignature, const FBPOpenVRCameraFrameInfo &, FrameInfo);
+
+// Shared between the component, the streaming thread and queued texture updates so that the buffers outlive whichever of them goes first
+struct FOpenVRCameraStreamBuffers
+{
+	enum class ESlotState : uint8
+	{
+		Free,
+		Writing,
+		Ready,
+		Uploading
+	};
+
+	struct FSlot
+	{
+		TArray<uint8> Pixels;
+		FOpenVRCameraFrameHeader Header;
+		ESlotState State;
+
+		FSlot() :
+			State(ESlotState::Free)
+		{}
+	};
+
+	FCriticalSection SlotLock;
+	TArray<FSlot> Slots;
+
+	// Frames that were read but never displayed, and ones the source skipped past
+	FThreadSafeCounter FramesReceived;
+	FThreadSafeCounter FramesDropped;
+};
+
+/**
+* Streams the HMD camera into a texture without touching the pixels on the game thread.
+* A streaming thread polls the frame headers, skips frames it has already seen and reads new ones into a ring of staging buffers,
+* the game thread then only picks up the newest finished buffer and queues the texture update for it.
+*/
+UCLASS(Blueprintable, meta = (BlueprintSpawnableComponent), ClassGroup = (VRExpansionPlugin))
+class OPENVREXPANSIONPLUGIN_API UOpenVRCameraStreamComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UOpenVRCameraStreamComponent(const FObjectInitializer& ObjectInitializer);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRCameraStream")
+		EOpenVRCameraFrameType FrameType;
+
+	// Frames per second to read from the camera, 0 reads every frame the camera produces
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRCameraStream", meta = (ClampMin = "0", UIMin = "0"))
+		float TargetFrameRate;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRCameraStream")
+		EOpenVRCameraFrameDropPolicy DropPolicy;
+
+	// Staging buffers in the ring, two is enough unless the render thread regularly falls behind
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRCameraStream", meta = (ClampMin = "2", ClampMax = "4", UIMin = "2", UIMax = "4"))
+		int32 NumStagingBuffers;
+
+	// How long the streaming thread waits before checking for a new frame again
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRCameraStream", meta = (ClampMin = "0.001", UIMin = "0.001"))
+		float PollInterval;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRCameraStream")
+		bool bAutoStartStreaming;
+
+	UPROPERTY(BlueprintAssignable, Category = "VRCameraStream")
+		FOpenVRCameraFrameUpdatedSignature OnCameraFrameUpdated;
+
+	UFUNCTION(BlueprintCallable, Category = "VRCameraStream", meta = (ExpandEnumAsExecs = "Result"))
+		void StartStreaming(EBPOVRResultSwitch & Result);
+
+	UFUNCTION(BlueprintCallable, Category = "VRCameraStream")
+		void StopStreaming();
+
+	UFUNCTION(BlueprintPure, Category = "VRCameraStream")
+		bool IsStreaming() const;
+
+	// Texture the frames are streamed into, created by StartStreaming
+	UFUNCTION(BlueprintPure, Category = "VRCameraStream")
+		UTexture2D * GetCameraTexture() const { return CameraTexture; }
+
+	UFUNCTION(BlueprintPure, Category = "VRCameraStream")
+		FBPOpenVRCameraFrameInfo GetLatestFrameInfo() const { return LatestFrameInfo; }
+
+	UFUNCTION(BlueprintPure, Category = "VRCameraStream")
+		void GetFrameStats(int32 & FramesReceived, int32 & FramesDropped, int32 & FramesDisplayed) const;
+
+	// Header of the latest displayed frame with the full precision exposure time, for native code that doesn't want the copy
+	const FOpenVRCameraFrameHeader & GetLatestFrameHeader() const { return LatestFrameHeader; }
+
+	// Replaces the OpenVR camera as the frame source, only takes effect on the next StartStreaming
+	void SetFrameSource(TSharedPtr<IOpenVRCameraFrameSource, ESPMode::ThreadSafe> NewSource);
+
+	virtual void BeginPlay() override;
+	virtual void OnUnregister() override;
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction) override;
+
+private:
+
+	UPROPERTY(Transient)
+		UTexture2D * CameraTexture;
+
+	FBPOpenVRCameraFrameInfo LatestFrameInfo;
+	FOpenVRCameraFrameHeader LatestFrameHeader;
+	int32 NumFramesDisplayed;
+
+	TSharedPtr<IOpenVRCameraFrameSource, ESPMode::ThreadSafe> FrameSource;
+	TSharedPtr<IOpenVRCameraFrameSource, ESPMode::ThreadSafe> ActiveSource;
+	TSharedPtr<FOpenVRCameraStreamBuffers, ESPMode::ThreadSafe> Buffers;
+	FOpenVRCameraStreamWorker * Worker;
+};
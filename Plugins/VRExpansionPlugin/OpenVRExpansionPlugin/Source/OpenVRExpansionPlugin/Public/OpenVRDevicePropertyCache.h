@@ -0,0 +1,185 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+
+// Device index, OpenVR property id
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnOpenVRDevicePropertyChanged, int32, int32);
+
+// Device index, is now connected
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnOpenVRDeviceConnectionChanged, int32, bool);
+
+enum class EOpenVRDeviceEventType : uint8
+{
+	Connected,
+	Disconnected,
+	PropertyChanged
+};
+
+struct FOpenVRDeviceEvent
+{
+	EOpenVRDeviceEventType Type;
+	int32 DeviceIndex;
+
+	// Only set for PropertyChanged
+	int32 PropertyId;
+
+	FOpenVRDeviceEvent(EOpenVRDeviceEventType InType, int32 InDeviceIndex, int32 InPropertyId = 0) :
+		Type(InType),
+		DeviceIndex(InDeviceIndex),
+		PropertyId(InPropertyId)
+	{}
+};
+
+/**
+* Where the cache gets its device state from, the default one talks to the OpenVR system interface.
+* Can be swapped out with FOpenVRDevicePropertyCache::SetSource to serve devices without a runtime.
+* Property ids are the raw vr::ETrackedDeviceProperty values and device classes the raw vr::ETrackedDeviceClass values.
+*/
+class OPENVREXPANSIONPLUGIN_API IOpenVRDevicePropertySource
+{
+public:
+	virtual ~IOpenVRDevicePropertySource() {}
+
+	virtual bool IsAvailable() = 0;
+	virtual int32 GetMaxDeviceCount() = 0;
+	virtual bool IsDeviceConnected(int32 DeviceIndex) = 0;
+	virtual uint8 GetDeviceClass(int32 DeviceIndex) = 0;
+
+	virtual bool GetStringProperty(int32 DeviceIndex, int32 PropertyId, FString & OutValue) = 0;
+	virtual bool GetBoolProperty(int32 DeviceIndex, int32 PropertyId, bool & OutValue) = 0;
+	virtual bool GetFloatProperty(int32 DeviceIndex, int32 PropertyId, float & OutValue) = 0;
+	virtual bool GetInt32Property(int32 DeviceIndex, int32 PropertyId, int32 & OutValue) = 0;
+	virtual bool GetUInt64Property(int32 DeviceIndex, int32 PropertyId, uint64 & OutValue) = 0;
+	virtual bool GetMatrix34Property(int32 DeviceIndex, int32 PropertyId, FMatrix & OutValue) = 0;
+
+	// Device events since the last call, in the order they happened.
+	// The runtime source doesn't provide any as polling the OpenVR event queue would steal the events from the SteamVR plugin,
+	// the cache sweeps the connection state on an interval instead.
+	virtual void PollEvents(TArray<FOpenVRDeviceEvent> & OutEvents) {}
+};
+
+/**
+* Caches OpenVR device state and properties so that polling them every frame doesn't cross into the runtime every time.
+*	Connection state and device classes are swept every vr.OpenVR.DeviceConnectionPollInterval (once a frame if 0) and indexed by class,
+*	source events and Invalidate() bring them up to date in between.
+*	Properties are fetched on first use and kept until the device disconnects or changes class, or a source event invalidates them.
+*	Volatile properties (every bool and float, the role hint) and watched properties are re-fetched every vr.OpenVR.VolatilePropertyRefreshInterval.
+* Within a sweep disconnects are broadcast before connects, and a devices connect is broadcast before any of its property changes.
+* Initial fetches of a property are not reported as changes. Game thread only.
+*/
+class OPENVREXPANSIONPLUGIN_API FOpenVRDevicePropertyCache
+{
+public:
+
+	static FOpenVRDevicePropertyCache & Get();
+
+	bool IsAvailable();
+
+	bool IsDeviceConnected(int32 DeviceIndex);
+
+	// Raw vr::ETrackedDeviceClass, 0 (invalid) if there is no device in the slot
+	uint8 GetDeviceClass(int32 DeviceIndex);
+
+	// Every slot with a device in it, in slot order
+	void GetDevices(TArray<int32> & OutDeviceIndexes);
+
+	void GetDevicesByClass(uint8 DeviceClass, TArray<int32> & OutDeviceIndexes);
+
+	// Devices whose controller role hint matches, only controllers and generic trackers have one
+	void GetDevicesByRole(int32 RoleHint, TArray<int32> & OutDeviceIndexes);
+
+	bool GetStringProperty(int32 DeviceIndex, int32 PropertyId, FString & OutValue);
+	bool GetBoolProperty(int32 DeviceIndex, int32 PropertyId, bool & OutValue);
+	bool GetFloatProperty(int32 DeviceIndex, int32 PropertyId, float & OutValue);
+	bool GetInt32Property(int32 DeviceIndex, int32 PropertyId, int32 & OutValue);
+	bool GetUInt64Property(int32 DeviceIndex, int32 PropertyId, uint64 & OutValue);
+	bool GetMatrix34Property(int32 DeviceIndex, int32 PropertyId, FMatrix & OutValue);
+
+	// Starts re-fetching the property on every device at the volatile cadence, OnPropertyChanged fires when it changes.
+	// Watches are counted, every AddWatchedProperty needs a RemoveWatchedProperty.
+	void AddWatchedProperty(int32 PropertyId);
+	void RemoveWatchedProperty(int32 PropertyId);
+
+	FOnOpenVRDevicePropertyChanged OnPropertyChanged;
+	FOnOpenVRDeviceConnectionChanged OnDeviceConnectionChanged;
+
+	// Drops the cached properties of the device, or of every device with INDEX_NONE, and sweeps the connection state on the next query
+	void Invalidate(int32 DeviceIndex = INDEX_NONE);
+
+	void SetSource(TSharedPtr<IOpenVRDevicePropertySource> NewSource);
+
+	// Sweeps, processes source events and refreshes watched properties, runs off of the core ticker once the cache is in use
+	void Update(bool bForceSweep = false);
+
+	void Shutdown();
+
+private:
+
+	FOpenVRDevicePropertyCache();
+
+	enum class EPropertyType : uint8
+	{
+		String,
+		Bool,
+		Float,
+		Int32,
+		UInt64,
+		Matrix34
+	};
+
+	struct FCachedProperty
+	{
+		EPropertyType Type;
+		bool bSucceeded;
+		double FetchTime;
+		FString StringValue;
+
+		// Bool, float, int32 and uint64 values are bit copied in here
+		uint64 ScalarValue;
+		FMatrix MatrixValue;
+
+		bool ValueEquals(const FCachedProperty & Other) const;
+	};
+
+	struct FDeviceEntry
+	{
+		bool bConnected;
+		uint8 DeviceClass;
+		TMap<int32, FCachedProperty> Properties;
+
+		FDeviceEntry() :
+			bConnected(false),
+			DeviceClass(0)
+		{}
+	};
+
+	bool EnsureSource();
+	void SweepConnections();
+	void ProcessEvents();
+	void RefreshWatchedProperties();
+	void RebuildClassIndex();
+	void ResetDevices();
+
+	// Returns the cached entry, fetching it first if it is missing or stale
+	const FCachedProperty * FindOrFetch(int32 DeviceIndex, int32 PropertyId, EPropertyType Type);
+	bool Fetch(int32 DeviceIndex, int32 PropertyId, EPropertyType Type, FCachedProperty & OutProperty);
+	bool IsStale(int32 PropertyId, const FCachedProperty & Property, double CurrentTime) const;
+	static bool IsVolatileProperty(int32 PropertyId, EPropertyType Type);
+
+	bool Tick(float DeltaTime);
+
+	TSharedPtr<IOpenVRDevicePropertySource> Source;
+	TArray<FDeviceEntry> Devices;
+	TMap<uint8, TArray<int32>> DevicesByClass;
+	TMap<int32, int32> WatchedProperties;
+
+	double LastSweepTime;
+	uint64 LastSweepFrame;
+	double LastWatchRefreshTime;
+	bool bWasAvailable;
+	bool bSweepRequested;
+	bool bIsShutdown;
+	FDelegateHandle TickHandle;
+};
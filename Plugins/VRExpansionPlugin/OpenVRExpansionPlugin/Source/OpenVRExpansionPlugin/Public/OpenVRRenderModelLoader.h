@@ -0,0 +1,145 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtr.h"
+#include "HAL/ThreadSafeBool.h"
+#include "Async/AsyncWork.h"
+
+class UTexture2D;
+class FOpenVRRenderModelLoadTask;
+
+// A render model converted to UE4 space, shared between everyone that asked for it so it is never modified after loading
+struct OPENVREXPANSIONPLUGIN_API FOpenVRRenderModelData
+{
+	FString RenderModelName;
+
+	TArray<FVector> Vertices;
+	TArray<FVector> Normals;
+	TArray<FVector2D> UV0;
+	TArray<int32> Triangles;
+
+	// RGBA8, empty if the model has no diffuse texture
+	int32 TextureWidth;
+	int32 TextureHeight;
+	TArray<uint8> TextureData;
+
+	FOpenVRRenderModelData() :
+		TextureWidth(0),
+		TextureHeight(0)
+	{}
+
+	bool HasTexture() const
+	{
+		return TextureWidth > 0 && TextureHeight > 0 && TextureData.Num() == TextureWidth * TextureHeight * 4;
+	}
+
+	friend FArchive& operator<<(FArchive& Ar, FOpenVRRenderModelData& Data);
+};
+
+typedef TSharedPtr<const FOpenVRRenderModelData, ESPMode::ThreadSafe> FOpenVRRenderModelDataPtr;
+
+// Passed a null model if the load failed or the loader was shut down
+DECLARE_DELEGATE_OneParam(FOnOpenVRRenderModelLoaded, FOpenVRRenderModelDataPtr);
+
+enum class EOpenVRRenderModelPollResult : uint8
+{
+	Loading,
+	Loaded,
+	Failed
+};
+
+/**
+* Where the loader gets its render models from, the default one talks to the OpenVR runtime.
+* Can be swapped out with FOpenVRRenderModelLoader::SetProvider to serve models without a runtime.
+*/
+class OPENVREXPANSIONPLUGIN_API IOpenVRRenderModelProvider
+{
+public:
+	virtual ~IOpenVRRenderModelProvider() {}
+
+	// Called on the game thread before a load is queued, return false to fail the load right away
+	virtual bool IsAvailable() { return true; }
+
+	// Called repeatedly from a worker thread until it stops returning Loading, fills OutData when it returns Loaded
+	virtual EOpenVRRenderModelPollResult PollRenderModel(const FString & RenderModelName, FOpenVRRenderModelData & OutData) = 0;
+};
+
+/**
+* Loads render models off of the game thread and keeps the converted results around keyed by render model name.
+* Every request for a model that is already loading waits on that same load instead of starting a new one.
+* All of the public functions are game thread only, callbacks also fire on the game thread.
+*/
+class OPENVREXPANSIONPLUGIN_API FOpenVRRenderModelLoader
+{
+public:
+
+	static FOpenVRRenderModelLoader & Get();
+
+	// Returns the model if it is already in memory, never starts a load
+	FOpenVRRenderModelDataPtr FindCachedModel(const FString & RenderModelName) const;
+
+	// Queues a load of the model, Callback is run right away if it is cached.
+	// Returns a handle to pass to CancelRequest, INDEX_NONE if the callback already ran.
+	int32 RequestModel(const FString & RenderModelName, FOnOpenVRRenderModelLoaded Callback);
+
+	// Drops the request, the load itself is stopped once nothing is waiting on it anymore
+	void CancelRequest(int32 RequestHandle);
+
+	// For callers that check back every frame instead of binding a callback.
+	// Starts the load if needed, a failure is only reported once so the next poll retries.
+	EOpenVRRenderModelPollResult PollModel(const FString & RenderModelName, FOpenVRRenderModelDataPtr & OutModel);
+
+	bool IsLoading(const FString & RenderModelName) const;
+
+	// Returns a texture for the model, re-used for as long as something else keeps it alive
+	UTexture2D * GetOrCreateTexture(const FOpenVRRenderModelDataPtr & Model);
+
+	void SetProvider(TSharedPtr<IOpenVRRenderModelProvider, ESPMode::ThreadSafe> NewProvider);
+
+	// Empties the memory cache and optionally the on disk one, running loads are left to finish
+	void ClearCache(bool bIncludeDiskCache = false);
+
+	// Brings the loader back up after a Shutdown, puts the runtime provider back if there isn't one
+	void Initialize();
+
+	// Cancels every running load, fails their waiters and empties the cache.
+	// Loads still queued on the thread pool are pulled back, running ones get up to vr.OpenVR.RenderModelShutdownTimeout to exit.
+	void Shutdown();
+
+private:
+	friend class FOpenVRRenderModelLoadTask;
+
+	FOpenVRRenderModelLoader();
+
+	struct FPendingLoad
+	{
+		FThreadSafeBool bCancelled;
+		// Loads started before a Shutdown are dropped when they finish
+		uint32 Generation;
+		TArray<TPair<int32, FOnOpenVRRenderModelLoaded>> Waiters;
+
+		FPendingLoad() :
+			Generation(0)
+		{}
+	};
+	typedef TSharedPtr<FPendingLoad, ESPMode::ThreadSafe> FPendingLoadPtr;
+
+	void StartLoad(const FString & RenderModelName, FPendingLoadPtr Load);
+	void FinishLoad(const FString & RenderModelName, FPendingLoadPtr Load, FOpenVRRenderModelDataPtr Model);
+
+	static FString GetDiskCachePath(const FString & RenderModelName);
+
+	TMap<FString, FOpenVRRenderModelDataPtr> Cache;
+	TMap<FString, FPendingLoadPtr> PendingLoads;
+	TMap<FString, TWeakObjectPtr<UTexture2D>> Textures;
+	TSet<FString> FailedLoads;
+
+	// Worker tasks that may still be queued or running, Shutdown retracts or waits on them
+	TArray<TUniquePtr<FAsyncTask<FOpenVRRenderModelLoadTask>>> InFlightLoads;
+
+	TSharedPtr<IOpenVRRenderModelProvider, ESPMode::ThreadSafe> Provider;
+	int32 NextRequestHandle;
+	uint32 Generation;
+	bool bIsShutdown;
+};
@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AnimGraphNode_VRArmSolver.h"
+
+#define LOCTEXT_NAMESPACE "AnimGraphNode_VRArmSolver"
+
+UAnimGraphNode_VRArmSolver::UAnimGraphNode_VRArmSolver(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+}
+
+FText UAnimGraphNode_VRArmSolver::GetControllerDescription() const
+{
+	return LOCTEXT("VRArmSolver", "VR Arm Solver");
+}
+
+FText UAnimGraphNode_VRArmSolver::GetTooltipText() const
+{
+	return LOCTEXT("VRArmSolverTooltip", "Poses the clavicles, arms and hands from the owners VRArmSolverComponent. The solve itself is batched per world before animation runs.");
+}
+
+FText UAnimGraphNode_VRArmSolver::GetNodeTitle(ENodeTitleType::Type TitleType) const
+{
+	return GetControllerDescription();
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,18 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#include "VRExpansionEditor.h"
+
+#define LOCTEXT_NAMESPACE "FVRExpansionEditorModule"
+
+void FVRExpansionEditorModule::StartupModule()
+{
+	// Only holds the anim graph nodes for the runtime modules anim nodes currently, nothing to set up
+}
+
+void FVRExpansionEditorModule::ShutdownModule()
+{
+}
+
+#undef LOCTEXT_NAMESPACE
+	
+IMPLEMENT_MODULE(FVRExpansionEditorModule, VRExpansionEditor)
@@ -0,0 +1,28 @@
+// Some copyright should be here...
+using UnrealBuildTool;
+
+public class VRExpansionEditor : ModuleRules
+{
+    public VRExpansionEditor(ReadOnlyTargetRules Target) : base(Target)
+    {
+        PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+        PublicDependencyModuleNames.AddRange(
+        new string[]
+        {
+                    "Core",
+                    "CoreUObject",
+                    "Engine",
+                    "AnimGraph",
+                    "AnimGraphRuntime",
+                    "BlueprintGraph",
+                    "VRExpansionPlugin"
+        });
+
+        PrivateDependencyModuleNames.AddRange(
+            new string[]
+            {
+                "UnrealEd"
+            });
+    }
+}
@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Animation/AnimNode_VRArmSolver.h"
+#include "Animation/AnimInstance.h"
+#include "Animation/AnimInstanceProxy.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "GameFramework/Actor.h"
+
+FAnimNode_VRArmSolver::FAnimNode_VRArmSolver() :
+	bApplyHandRotation(true),
+	CachedComponentTransform(FTransform::Identity)
+{
+}
+
+void FAnimNode_VRArmSolver::PreUpdate(const UAnimInstance* InAnimInstance)
+{
+	CachedResult.bIsValid = false;
+
+	const USkeletalMeshComponent * SkelMesh = InAnimInstance ? InAnimInstance->GetSkelMeshComponent() : nullptr;
+	if (!SkelMesh)
+		return;
+
+	if (!SolverComponent.IsValid())
+	{
+		if (AActor * Owner = SkelMesh->GetOwner())
+			SolverComponent = Owner->FindComponentByClass<UVRArmSolverComponent>();
+	}
+
+	if (UVRArmSolverComponent * Solver = SolverComponent.Get())
+	{
+		CachedResult = Solver->GetResult();
+		CachedComponentTransform = SkelMesh->GetComponentTransform();
+	}
+}
+
+void FAnimNode_VRArmSolver::InitializeBoneReferences(const FBoneContainer& RequiredBones)
+{
+	LeftArm.Initialize(RequiredBones);
+	RightArm.Initialize(RequiredBones);
+}
+
+bool FAnimNode_VRArmSolver::IsValidToEvaluate(const USkeleton* Skeleton, const FBoneContainer& RequiredBones)
+{
+	return LeftArm.IsValid(RequiredBones) || RightArm.IsValid(RequiredBones);
+}
+
+// Swings every transform in the chain around Pivot
+static void RotateChain(FTransform ** Chain, int32 NumInChain, const FVector & Pivot, const FQuat & Rotation)
+{
+	for (int32 i = 0; i < NumInChain; ++i)
+	{
+		Chain[i]->SetLocation(Pivot + Rotation.RotateVector(Chain[i]->GetLocation() - Pivot));
+		Chain[i]->SetRotation((Rotation * Chain[i]->GetRotation()).GetNormalized());
+	}
+}
+
+// Aims the first transform of the chain so that the second points at Target
+static void AimChain(FTransform ** Chain, int32 NumInChain, const FVector & Target)
+{
+	const FVector Pivot = Chain[0]->GetLocation();
+	const FVector CurrentDir = (Chain[1]->GetLocation() - Pivot).GetSafeNormal();
+	const FVector TargetDir = (Target - Pivot).GetSafeNormal();
+
+	if (CurrentDir.IsZero() || TargetDir.IsZero())
+		return;
+
+	RotateChain(Chain, NumInChain, Pivot, FQuat::FindBetweenNormals(CurrentDir, TargetDir));
+}
+
+void FAnimNode_VRArmSolver::SolveArm(FComponentSpacePoseContext& Output, const FVRArmSolverArmBones & Bones, int32 Side, TArray<FBoneTransform>& OutBoneTransforms) const
+{
+	const FBoneContainer& BoneContainer = Output.Pose.GetPose().GetBoneContainer();
+
+	if (!Bones.IsValid(BoneContainer))
+		return;
+
+	const FCompactPoseBoneIndex ClavicleIndex = Bones.Clavicle.GetCompactPoseIndex(BoneContainer);
+	const FCompactPoseBoneIndex UpperArmIndex = Bones.UpperArm.GetCompactPoseIndex(BoneContainer);
+	const FCompactPoseBoneIndex LowerArmIndex = Bones.LowerArm.GetCompactPoseIndex(BoneContainer);
+	const FCompactPoseBoneIndex HandIndex = Bones.Hand.GetCompactPoseIndex(BoneContainer);
+
+	FTransform ClavicleTransform = Output.Pose.GetComponentSpaceTransform(ClavicleIndex);
+	FTransform UpperArmTransform = Output.Pose.GetComponentSpaceTransform(UpperArmIndex);
+	FTransform LowerArmTransform = Output.Pose.GetComponentSpaceTransform(LowerArmIndex);
+	FTransform HandTransform = Output.Pose.GetComponentSpaceTransform(HandIndex);
+
+	FTransform * Chain[4] = { &ClavicleTransform, &UpperArmTransform, &LowerArmTransform, &HandTransform };
+
+	const FVector ShoulderTarget = CachedComponentTransform.InverseTransformPosition(CachedResult.ShoulderPositions[Side]);
+	const FVector ElbowTarget = CachedComponentTransform.InverseTransformPosition(CachedResult.ElbowPositions[Side]);
+	const FVector HandTarget = CachedComponentTransform.InverseTransformPosition(CachedResult.HandPositions[Side]);
+
+	// Each joint is aimed at the next target in turn, the meshes bone lengths decide where the children actually end up
+	AimChain(&Chain[0], 4, ShoulderTarget);
+	AimChain(&Chain[1], 3, ElbowTarget);
+	AimChain(&Chain[2], 2, HandTarget);
+
+	if (bApplyHandRotation)
+	{
+		const FQuat HandRotation = CachedComponentTransform.InverseTransformRotation(CachedResult.HandRotations[Side]);
+		HandTransform.SetRotation((HandRotation * Bones.HandRotationOffset.Quaternion()).GetNormalized());
+	}
+
+	OutBoneTransforms.Add(FBoneTransform(ClavicleIndex, ClavicleTransform));
+	OutBoneTransforms.Add(FBoneTransform(UpperArmIndex, UpperArmTransform));
+	OutBoneTransforms.Add(FBoneTransform(LowerArmIndex, LowerArmTransform));
+	OutBoneTransforms.Add(FBoneTransform(HandIndex, HandTransform));
+}
+
+void FAnimNode_VRArmSolver::EvaluateSkeletalControl_AnyThread(FComponentSpacePoseContext& Output, TArray<FBoneTransform>& OutBoneTransforms)
+{
+	check(OutBoneTransforms.Num() == 0);
+
+	if (!CachedResult.bIsValid)
+		return;
+
+	SolveArm(Output, LeftArm, 0, OutBoneTransforms);
+	SolveArm(Output, RightArm, 1, OutBoneTransforms);
+
+	// The arms can interleave in the hierarchy, the base expects parents first
+	OutBoneTransforms.Sort(FCompareBoneTransformIndex());
+}
@@ -0,0 +1,217 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Animation/ArmSolver.h"
+#include "Async/ParallelFor.h"
+
+DECLARE_CYCLE_STAT(TEXT("ArmSolver SolveBatch"), STAT_ArmSolverSolveBatch, STATGROUP_Game);
+
+int32 FArmSolverBatch::Add()
+{
+	const int32 Index = Num();
+	ForEachArray([](auto & Array) { Array.AddDefaulted(); });
+
+	HeadTransforms[Index] = FTransform::Identity;
+	HandTransforms[0][Index] = FTransform::Identity;
+	HandTransforms[1][Index] = FTransform::Identity;
+	UpperArmLengths[Index] = 30.0f;
+	LowerArmLengths[Index] = 30.0f;
+	ShoulderHalfWidths[Index] = 18.0f;
+	NeckDrops[Index] = 25.0f;
+	NeckBackOffsets[Index] = 8.0f;
+	BodyYaws[Index] = 0.0f;
+	HasState[Index] = false;
+
+	for (int32 Side = 0; Side < 2; ++Side)
+	{
+		ElbowAngles[Side][Index] = 0.0f;
+		ClaviclePositions[Side][Index] = FVector::ZeroVector;
+		ShoulderPositions[Side][Index] = FVector::ZeroVector;
+		ElbowPositions[Side][Index] = FVector::ZeroVector;
+		HandPositions[Side][Index] = FVector::ZeroVector;
+		ReachClamped[Side][Index] = false;
+	}
+
+	return Index;
+}
+
+void FArmSolverBatch::RemoveAtSwap(int32 Index)
+{
+	ForEachArray([Index](auto & Array) { Array.RemoveAtSwap(Index, 1, false); });
+}
+
+void FArmSolverBatch::Reset()
+{
+	ForEachArray([](auto & Array) { Array.Reset(); });
+}
+
+float ArmSolver::ClampElbowAngle(float Angle) const
+{
+	if (!clampElbowAngle)
+		return Angle;
+
+	if (!softClampElbowAngle || softClampRange <= 0.0f)
+		return FMath::Clamp(Angle, minAngle, maxAngle);
+
+	// Past the start of the range the remaining distance decays towards the limit, matching the slope at the start so there is no kink
+	const float SoftMin = minAngle + softClampRange;
+	const float SoftMax = maxAngle - softClampRange;
+
+	if (Angle < SoftMin)
+		return minAngle + softClampRange * FMath::Exp((Angle - SoftMin) / softClampRange);
+	else if (Angle > SoftMax)
+		return maxAngle - softClampRange * FMath::Exp((SoftMax - Angle) / softClampRange);
+
+	return Angle;
+}
+
+float ArmSolver::GetElbowTargetAngle(const FVector & LocalHandPosNormalized, bool bIsLeft) const
+{
+	if (!calcElbowAngle)
+		return offsetAngle;
+
+	// Angle from y
+	float Angle = yWeight * LocalHandPosNormalized.Y + offsetAngle;
+
+	// Angle from z, only while the hand is close to the body
+	Angle += FMath::Lerp(zWeightBottom, zWeightTop, FMath::Clamp((LocalHandPosNormalized.Y + 1.0f) - zBorderY, 0.0f, 1.0f)) *
+		FMath::Max(zDistanceStart - LocalHandPosNormalized.Z, 0.0f);
+
+	// Angle from x, when the hand crosses over to the other side
+	Angle += xWeight * FMath::Max(LocalHandPosNormalized.X * (bIsLeft ? 1.0f : -1.0f) + xDistanceStart, 0.0f);
+
+	return ClampElbowAngle(Angle);
+}
+
+void ArmSolver::SolveRig(FArmSolverBatch & Batch, int32 RigIndex, float DeltaTime)
+{
+	const ArmSolver Solver(Batch.Settings[RigIndex]);
+	const FTransform & HeadTransform = Batch.HeadTransforms[RigIndex];
+	const bool bHasState = Batch.HasState[RigIndex];
+
+	// Body yaw from the head, looking straight up or down the head up vector still knows which way it faces
+	FVector HeadForward = HeadTransform.GetUnitAxis(EAxis::X);
+	FVector FlatForward(HeadForward.X, HeadForward.Y, 0.0f);
+
+	if (FlatForward.SizeSquared() < 0.01f)
+	{
+		const FVector HeadUp = HeadTransform.GetUnitAxis(EAxis::Z);
+		FlatForward = FVector(HeadUp.X, HeadUp.Y, 0.0f) * (HeadForward.Z > 0.0f ? -1.0f : 1.0f);
+	}
+
+	float TargetYaw = FMath::RadiansToDegrees(FMath::Atan2(FlatForward.Y, FlatForward.X));
+	float BodyYaw = TargetYaw;
+
+	if (bHasState && Solver.bodyYawInterpSpeed > 0.0f)
+	{
+		const float PrevYaw = Batch.BodyYaws[RigIndex];
+		BodyYaw = PrevYaw + FMath::FindDeltaAngleDegrees(PrevYaw, TargetYaw) * FMath::Clamp(DeltaTime * Solver.bodyYawInterpSpeed, 0.0f, 1.0f);
+		BodyYaw = FRotator::NormalizeAxis(BodyYaw);
+	}
+
+	Batch.BodyYaws[RigIndex] = BodyYaw;
+
+	float YawSin, YawCos;
+	FMath::SinCos(&YawSin, &YawCos, FMath::DegreesToRadians(BodyYaw));
+	const FVector BodyForward(YawCos, YawSin, 0.0f);
+	const FVector BodyRight(-YawSin, YawCos, 0.0f);
+	const FVector BodyUp = FVector::UpVector;
+
+	const FVector Chest = HeadTransform.GetLocation() - (BodyUp * Batch.NeckDrops[RigIndex]) - (BodyForward * Batch.NeckBackOffsets[RigIndex]);
+
+	const float UpperLength = FMath::Max(Batch.UpperArmLengths[RigIndex], KINDA_SMALL_NUMBER);
+	const float LowerLength = FMath::Max(Batch.LowerArmLengths[RigIndex], KINDA_SMALL_NUMBER);
+	const float ArmLength = UpperLength + LowerLength;
+	const float HalfWidth = Batch.ShoulderHalfWidths[RigIndex];
+
+	for (int32 Side = 0; Side < 2; ++Side)
+	{
+		const bool bIsLeft = Side == 0;
+		const float SideSign = bIsLeft ? -1.0f : 1.0f;
+		const FVector Outward = BodyRight * SideSign;
+		const FVector HandTarget = Batch.HandTransforms[Side][RigIndex].GetLocation();
+
+		// Clavicle, rotates forward and up as the hand reaches past half an arm length
+		const FVector RestShoulder = Chest + Outward * HalfWidth;
+		const FVector RestOffset = HandTarget - RestShoulder;
+		const float ForwardRatio = FVector::DotProduct(RestOffset, BodyForward) / ArmLength;
+		const float UpwardRatio = FVector::DotProduct(RestOffset, BodyUp) / ArmLength;
+
+		float ForwardAngle = 0.0f;
+		if (ForwardRatio > 0.0f)
+			ForwardAngle = FMath::Clamp((ForwardRatio - 0.5f) * Solver.shoulderRotationMultiplier, 0.0f, Solver.shoulderRotationLimitForward);
+		else
+			ForwardAngle = FMath::Clamp(-(ForwardRatio + 0.08f) * Solver.shoulderRotationMultiplier * 10.0f, -Solver.shoulderRotationLimitBackward, 0.0f);
+
+		const float UpwardAngle = FMath::Clamp((UpwardRatio - 0.5f) * Solver.shoulderRotationMultiplier, 0.0f, Solver.shoulderRotationLimitUpward);
+
+		float ForwardSin, ForwardCos, UpSin, UpCos;
+		FMath::SinCos(&ForwardSin, &ForwardCos, FMath::DegreesToRadians(ForwardAngle));
+		FMath::SinCos(&UpSin, &UpCos, FMath::DegreesToRadians(UpwardAngle));
+
+		const FVector ClavicleDir = ((Outward * ForwardCos + BodyForward * ForwardSin) * UpCos) + (BodyUp * UpSin);
+		const FVector Shoulder = Chest + ClavicleDir * HalfWidth;
+
+		// Reach limit
+		FVector ToHand = HandTarget - Shoulder;
+		float HandDistance = ToHand.Size();
+		FVector Axis = HandDistance > KINDA_SMALL_NUMBER ? ToHand / HandDistance : BodyForward;
+		bool bReachClamped = false;
+
+		if (HandDistance > ArmLength)
+		{
+			HandDistance = ArmLength;
+			bReachClamped = true;
+		}
+
+		const FVector Hand = Shoulder + Axis * HandDistance;
+
+		// Elbow angle from where the hand sits relative to the shoulder, in the settings convention
+		const FVector LocalHand = FVector(FVector::DotProduct(ToHand, BodyRight), FVector::DotProduct(ToHand, BodyUp), FVector::DotProduct(ToHand, BodyForward)) / ArmLength;
+		float ElbowAngle = Solver.GetElbowTargetAngle(LocalHand, bIsLeft);
+
+		if (bHasState && Solver.elbowAngleInterpSpeed > 0.0f)
+			ElbowAngle = FMath::FixedTurn(Batch.ElbowAngles[Side][RigIndex], ElbowAngle, Solver.elbowAngleInterpSpeed * DeltaTime);
+
+		Batch.ElbowAngles[Side][RigIndex] = ElbowAngle;
+
+		// Two bone solve, the elbow sits on the circle around the shoulder to hand axis
+		const float SolveDistance = FMath::Clamp(HandDistance, FMath::Abs(UpperLength - LowerLength) + KINDA_SMALL_NUMBER, ArmLength);
+		const float AlongAxis = (FMath::Square(UpperLength) - FMath::Square(LowerLength) + FMath::Square(SolveDistance)) / (2.0f * SolveDistance);
+		const float Radius = FMath::Sqrt(FMath::Max(FMath::Square(UpperLength) - FMath::Square(AlongAxis), 0.0f));
+
+		FVector UpPerp = BodyUp - Axis * FVector::DotProduct(BodyUp, Axis);
+		if (!UpPerp.Normalize())
+		{
+			// Arm pointing straight up or down, the body forward stands in for up
+			UpPerp = BodyForward - Axis * FVector::DotProduct(BodyForward, Axis);
+			UpPerp.Normalize();
+		}
+
+		const FVector SidePerp = bIsLeft ? FVector::CrossProduct(Axis, UpPerp) : FVector::CrossProduct(UpPerp, Axis);
+
+		float AngleSin, AngleCos;
+		FMath::SinCos(&AngleSin, &AngleCos, FMath::DegreesToRadians(ElbowAngle));
+
+		Batch.ClaviclePositions[Side][RigIndex] = Chest;
+		Batch.ShoulderPositions[Side][RigIndex] = Shoulder;
+		Batch.ElbowPositions[Side][RigIndex] = Shoulder + (Axis * AlongAxis) + ((UpPerp * AngleCos + SidePerp * AngleSin) * Radius);
+		Batch.HandPositions[Side][RigIndex] = Hand;
+		Batch.ReachClamped[Side][RigIndex] = bReachClamped;
+	}
+
+	Batch.HasState[RigIndex] = true;
+}
+
+void ArmSolver::SolveBatch(FArmSolverBatch & Batch, float DeltaTime, int32 ParallelThreshold)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ArmSolverSolveBatch);
+
+	const int32 NumRigs = Batch.Num();
+	const bool bSingleThreaded = ParallelThreshold <= 0 || NumRigs < ParallelThreshold;
+
+	// Rigs only touch their own index so they can be split up freely
+	ParallelFor(NumRigs, [&Batch, DeltaTime](int32 RigIndex)
+	{
+		SolveRig(Batch, RigIndex, DeltaTime);
+	}, bSingleThreaded);
+}
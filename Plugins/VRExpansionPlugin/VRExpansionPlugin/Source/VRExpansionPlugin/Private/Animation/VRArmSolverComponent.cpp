@@ -0,0 +1,105 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Animation/VRArmSolverComponent.h"
+#include "Animation/VRArmSolverManager.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "VRBaseCharacter.h"
+#include "ReplicatedVRCameraComponent.h"
+#include "GripMotionControllerComponent.h"
+
+UVRArmSolverComponent::UVRArmSolverComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	PrimaryComponentTick.bCanEverTick = false;
+
+	UpperArmLength = 30.0f;
+	LowerArmLength = 30.0f;
+	ShoulderHalfWidth = 18.0f;
+	NeckDrop = 25.0f;
+	NeckBackOffset = 8.0f;
+
+	TargetMesh = nullptr;
+	HeadComponent = nullptr;
+	LeftHandComponent = nullptr;
+	RightHandComponent = nullptr;
+
+	SolverIndex = INDEX_NONE;
+	bResetState = false;
+}
+
+void UVRArmSolverComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	FindDefaultComponents();
+
+	if (UVRArmSolverManager * SolverManager = UVRArmSolverManager::Get(GetWorld()))
+		SolverManager->RegisterSolver(this);
+}
+
+void UVRArmSolverComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (Manager.IsValid())
+		Manager->UnregisterSolver(this);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UVRArmSolverComponent::FindDefaultComponents()
+{
+	AActor * Owner = GetOwner();
+	if (!Owner)
+		return;
+
+	if (AVRBaseCharacter * VRCharacter = Cast<AVRBaseCharacter>(Owner))
+	{
+		if (!HeadComponent)
+			HeadComponent = VRCharacter->VRReplicatedCamera;
+
+		if (!LeftHandComponent)
+			LeftHandComponent = VRCharacter->LeftMotionController;
+
+		if (!RightHandComponent)
+			RightHandComponent = VRCharacter->RightMotionController;
+	}
+
+	if (!TargetMesh)
+		TargetMesh = Owner->FindComponentByClass<USkeletalMeshComponent>();
+}
+
+void UVRArmSolverComponent::SetTrackedComponents(USceneComponent * NewHead, USceneComponent * NewLeftHand, USceneComponent * NewRightHand, USkeletalMeshComponent * NewTargetMesh)
+{
+	UVRArmSolverManager * SolverManager = Manager.Get();
+
+	// Drop the old tick ordering before the components it was made against are replaced
+	if (SolverManager)
+		SolverManager->UnregisterSolver(this);
+
+	HeadComponent = NewHead;
+	LeftHandComponent = NewLeftHand;
+	RightHandComponent = NewRightHand;
+
+	if (NewTargetMesh)
+		TargetMesh = NewTargetMesh;
+
+	if (SolverManager)
+		SolverManager->RegisterSolver(this);
+}
+
+void UVRArmSolverComponent::ResetSolverState()
+{
+	bResetState = true;
+}
+
+bool UVRArmSolverComponent::GetArmResult(bool bLeftArm, FVector & Clavicle, FVector & Shoulder, FVector & Elbow, FVector & Hand, bool & bReachClamped) const
+{
+	const int32 Side = bLeftArm ? 0 : 1;
+
+	Clavicle = Result.ClaviclePositions[Side];
+	Shoulder = Result.ShoulderPositions[Side];
+	Elbow = Result.ElbowPositions[Side];
+	Hand = Result.HandPositions[Side];
+	bReachClamped = Result.bReachClamped[Side];
+
+	return Result.bIsValid;
+}
@@ -0,0 +1,216 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Animation/VRArmSolverManager.h"
+#include "Animation/VRArmSolverComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "Engine/Level.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("ArmSolver TickBatch"), STAT_ArmSolverTickBatch, STATGROUP_Game);
+
+namespace VRArmSolverCVars
+{
+	static int32 ParallelThreshold = 16;
+	FAutoConsoleVariableRef CVarParallelThreshold(
+		TEXT("vr.ArmSolver.ParallelThreshold"),
+		ParallelThreshold,
+		TEXT("Number of arm rigs in a world at which the batch solve is split across task graph workers, 0 always solves on the game thread."),
+		ECVF_Default);
+}
+
+void FVRArmSolverTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Target && !Target->IsPendingKill() && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Target->TickBatch(DeltaTime);
+	}
+}
+
+FString FVRArmSolverTickFunction::DiagnosticMessage()
+{
+	return TEXT("UVRArmSolverManager[TickBatch]");
+}
+
+UVRArmSolverManager::UVRArmSolverManager(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	BatchTickFunction.Target = this;
+	BatchTickFunction.bCanEverTick = true;
+	BatchTickFunction.bStartWithTickEnabled = false;
+	BatchTickFunction.bTickEvenWhenPaused = false;
+	BatchTickFunction.TickGroup = TG_PrePhysics;
+	BatchTickFunction.EndTickGroup = TG_PrePhysics;
+}
+
+UVRArmSolverManager * UVRArmSolverManager::Get(UWorld * World, bool bCreateIfMissing)
+{
+	if (!World || !World->IsGameWorld() || !World->PersistentLevel)
+		return nullptr;
+
+	for (UObject * DataObject : World->PerModuleDataObjects)
+	{
+		if (UVRArmSolverManager * Manager = Cast<UVRArmSolverManager>(DataObject))
+			return Manager;
+	}
+
+	if (!bCreateIfMissing || World->bIsTearingDown)
+		return nullptr;
+
+	UVRArmSolverManager * NewManager = NewObject<UVRArmSolverManager>(World);
+	World->PerModuleDataObjects.Add(NewManager);
+	NewManager->BatchTickFunction.RegisterTickFunction(World->PersistentLevel);
+
+	return NewManager;
+}
+
+void UVRArmSolverManager::BeginDestroy()
+{
+	if (BatchTickFunction.IsTickFunctionRegistered())
+		BatchTickFunction.UnRegisterTickFunction();
+
+	BatchTickFunction.Target = nullptr;
+
+	for (UVRArmSolverComponent * Solver : Solvers)
+	{
+		if (Solver)
+			Solver->SolverIndex = INDEX_NONE;
+	}
+
+	Solvers.Empty();
+	Batch.Reset();
+	Super::BeginDestroy();
+}
+
+void UVRArmSolverManager::RegisterSolver(UVRArmSolverComponent * Solver)
+{
+	if (!Solver || Solver->SolverIndex != INDEX_NONE)
+		return;
+
+	Solver->SolverIndex = Batch.Add();
+	Solver->Manager = this;
+	Solvers.Add(Solver);
+	check(Solvers.Num() == Batch.Num());
+
+	AddPrerequisites(Solver);
+
+	if (BatchTickFunction.IsTickFunctionRegistered())
+		BatchTickFunction.SetTickFunctionEnable(true);
+}
+
+void UVRArmSolverManager::UnregisterSolver(UVRArmSolverComponent * Solver)
+{
+	if (!Solver || !Solvers.IsValidIndex(Solver->SolverIndex) || Solvers[Solver->SolverIndex] != Solver)
+		return;
+
+	RemovePrerequisites(Solver);
+
+	const int32 Index = Solver->SolverIndex;
+	Solvers.RemoveAtSwap(Index, 1, false);
+	Batch.RemoveAtSwap(Index);
+
+	if (Solvers.IsValidIndex(Index) && Solvers[Index])
+		Solvers[Index]->SolverIndex = Index;
+
+	Solver->SolverIndex = INDEX_NONE;
+	Solver->Manager.Reset();
+
+	if (!Solvers.Num() && BatchTickFunction.IsTickFunctionRegistered())
+		BatchTickFunction.SetTickFunctionEnable(false);
+}
+
+void UVRArmSolverManager::AddPrerequisites(UVRArmSolverComponent * Solver)
+{
+	for (USceneComponent * Tracked : { Solver->HeadComponent, Solver->LeftHandComponent, Solver->RightHandComponent })
+	{
+		if (Tracked)
+			BatchTickFunction.AddPrerequisite(Tracked, Tracked->PrimaryComponentTick);
+	}
+
+	if (Solver->TargetMesh)
+		Solver->TargetMesh->PrimaryComponentTick.AddPrerequisite(this, BatchTickFunction);
+}
+
+void UVRArmSolverManager::RemovePrerequisites(UVRArmSolverComponent * Solver)
+{
+	for (USceneComponent * Tracked : { Solver->HeadComponent, Solver->LeftHandComponent, Solver->RightHandComponent })
+	{
+		if (Tracked)
+			BatchTickFunction.RemovePrerequisite(Tracked, Tracked->PrimaryComponentTick);
+	}
+
+	if (Solver->TargetMesh)
+		Solver->TargetMesh->PrimaryComponentTick.RemovePrerequisite(this, BatchTickFunction);
+}
+
+void UVRArmSolverManager::TickBatch(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ArmSolverTickBatch);
+
+	// Drop anything that went away without unregistering so its rig isn't solved for nothing
+	for (int32 i = Solvers.Num() - 1; i >= 0; --i)
+	{
+		if (!Solvers[i])
+		{
+			Solvers.RemoveAtSwap(i, 1, false);
+			Batch.RemoveAtSwap(i);
+
+			if (Solvers.IsValidIndex(i) && Solvers[i])
+				Solvers[i]->SolverIndex = i;
+		}
+	}
+
+	if (!Solvers.Num())
+	{
+		if (BatchTickFunction.IsTickFunctionRegistered())
+			BatchTickFunction.SetTickFunctionEnable(false);
+
+		return;
+	}
+
+	// Gather, the solve itself never touches a UObject so it can leave the game thread
+	for (int32 i = 0; i < Solvers.Num(); ++i)
+	{
+		UVRArmSolverComponent * Solver = Solvers[i];
+		if (!Solver || !Solver->HeadComponent || !Solver->LeftHandComponent || !Solver->RightHandComponent)
+			continue;
+
+		Batch.HeadTransforms[i] = Solver->HeadComponent->GetComponentTransform();
+		Batch.HandTransforms[0][i] = Solver->LeftHandComponent->GetComponentTransform();
+		Batch.HandTransforms[1][i] = Solver->RightHandComponent->GetComponentTransform();
+		Batch.UpperArmLengths[i] = Solver->UpperArmLength;
+		Batch.LowerArmLengths[i] = Solver->LowerArmLength;
+		Batch.ShoulderHalfWidths[i] = Solver->ShoulderHalfWidth;
+		Batch.NeckDrops[i] = Solver->NeckDrop;
+		Batch.NeckBackOffsets[i] = Solver->NeckBackOffset;
+		Batch.Settings[i] = Solver->ElbowSettings;
+
+		if (Solver->bResetState)
+		{
+			Batch.ResetState(i);
+			Solver->bResetState = false;
+		}
+	}
+
+	ArmSolver::SolveBatch(Batch, DeltaTime, VRArmSolverCVars::ParallelThreshold);
+
+	for (int32 i = 0; i < Solvers.Num(); ++i)
+	{
+		UVRArmSolverComponent * Solver = Solvers[i];
+		if (!Solver || !Solver->HeadComponent || !Solver->LeftHandComponent || !Solver->RightHandComponent)
+			continue;
+
+		FVRArmSolverResult & Result = Solver->Result;
+		Result.bIsValid = true;
+
+		for (int32 Side = 0; Side < 2; ++Side)
+		{
+			Result.ClaviclePositions[Side] = Batch.ClaviclePositions[Side][i];
+			Result.ShoulderPositions[Side] = Batch.ShoulderPositions[Side][i];
+			Result.ElbowPositions[Side] = Batch.ElbowPositions[Side][i];
+			Result.HandPositions[Side] = Batch.HandPositions[Side][i];
+			Result.HandRotations[Side] = Batch.HandTransforms[Side][i].GetRotation();
+			Result.bReachClamped[Side] = Batch.ReachClamped[Side][i];
+		}
+	}
+}
@@ -20,6 +20,7 @@
 #include "VRBaseCharacter.h"
 
 #include "GripScripts/GS_Default.h"
+#include "GripScripts/VRGripScriptScheduler.h"
 
 #include "PhysicsPublic.h"
 #include "PhysicsEngine/BodySetup.h"
@@ -219,6 +220,11 @@ void UGripMotionControllerComponent::OnUnregister()
 
 	ObjectsWaitingForSocketUpdate.Empty();
 
+	if (UVRGripScriptScheduler * GripScriptScheduler = UVRGripScriptScheduler::Get(GetWorld(), false))
+	{
+		GripScriptScheduler->UnregisterController(this);
+	}
+
 	Super::OnUnregister();
 }
 
@@ -242,6 +248,12 @@ void UGripMotionControllerComponent::BeginDestroy()
 void UGripMotionControllerComponent::BeginPlay()
 {
 	Super::BeginPlay();
+
+	// Orders the grip script phases around our grip handling
+	if (UVRGripScriptScheduler * GripScriptScheduler = UVRGripScriptScheduler::Get(GetWorld()))
+	{
+		GripScriptScheduler->RegisterController(this);
+	}
 }
 
 void UGripMotionControllerComponent::CreateRenderState_Concurrent()
@@ -1932,6 +1944,7 @@ void UGripMotionControllerComponent::DropAndSocket_Implementation(const FBPActor
 							if (NewDrop.SecondaryGripInfo.bHasSecondaryAttachment)
 								Script->OnSecondaryGripRelease(this, NewDrop.SecondaryGripInfo.SecondaryAttachment, NewDrop);
 
+							Script->SetOwnerHeld(false);
 							Script->OnGripRelease(this, NewDrop, true);
 						}
 					}
@@ -1994,6 +2007,7 @@ void UGripMotionControllerComponent::DropAndSocket_Implementation(const FBPActor
 							if (NewDrop.SecondaryGripInfo.bHasSecondaryAttachment)
 								Script->OnSecondaryGripRelease(this, NewDrop.SecondaryGripInfo.SecondaryAttachment, NewDrop);
 
+							Script->SetOwnerHeld(false);
 							Script->OnGripRelease(this, NewDrop, true);
 						}
 					}
@@ -2082,6 +2096,7 @@ bool UGripMotionControllerComponent::NotifyGrip(FBPActorGripInformation &NewGrip
 					{
 						if (Script)
 						{
+							Script->SetOwnerHeld(true);
 							Script->OnGrip(this, NewGrip);
 						}
 					}
@@ -2128,6 +2143,7 @@ bool UGripMotionControllerComponent::NotifyGrip(FBPActorGripInformation &NewGrip
 					{
 						if (Script)
 						{
+							Script->SetOwnerHeld(true);
 							Script->OnGrip(this, NewGrip);
 						}
 					}
@@ -2454,6 +2470,7 @@ void UGripMotionControllerComponent::Drop_Implementation(const FBPActorGripInfor
 							if (NewDrop.SecondaryGripInfo.bHasSecondaryAttachment)
 								Script->OnSecondaryGripRelease(this, NewDrop.SecondaryGripInfo.SecondaryAttachment, NewDrop);
 
+							Script->SetOwnerHeld(false);
 							Script->OnGripRelease(this, NewDrop, false);
 						}
 					}
@@ -2565,6 +2582,7 @@ void UGripMotionControllerComponent::Drop_Implementation(const FBPActorGripInfor
 							if (NewDrop.SecondaryGripInfo.bHasSecondaryAttachment)
 								Script->OnSecondaryGripRelease(this, NewDrop.SecondaryGripInfo.SecondaryAttachment, NewDrop);
 
+							Script->SetOwnerHeld(false);
 							Script->OnGripRelease(this, NewDrop, false);
 						}
 					}
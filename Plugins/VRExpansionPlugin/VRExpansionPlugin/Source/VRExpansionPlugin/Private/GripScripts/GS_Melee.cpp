@@ -6,6 +6,23 @@
 #include "PhysicsEngine/PhysicsConstraintActor.h"
 #include "PhysicsEngine/PhysicsConstraintComponent.h"
 #include "GripMotionControllerComponent.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "Components/SkinnedMeshComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("GS_Melee ~ Strike Sweeps"), STAT_MeleeStrikeSweeps, STATGROUP_TickGrip);
+
+namespace GSMelee
+{
+	static float MinimumPenetrationVelocity = 1000.0f;
+	static float DensityToVelocityScaler = 0.5f;
+
+	// Sweeps can't rotate, every segment moves at its end rotation, so contact made by the rotation since the last segment
+	// comes back as an initial overlap. Only the first segment's is ignored, it is as likely to be something we were already resting on.
+	static bool IsStrikeHit(const FHitResult & HitResult, int32 Segment)
+	{
+		return HitResult.bBlockingHit && (!HitResult.bStartPenetrating || Segment > 0);
+	}
+}
 
 UGS_Melee::UGS_Melee(const FObjectInitializer& ObjectInitializer) :
 	Super(ObjectInitializer)
@@ -19,7 +36,9 @@ UGS_Melee::UGS_Melee(const FObjectInitializer& ObjectInitializer) :
 	bTraceComplex = false;
 
 	bSubstepTrace = false;
-	MaxSubsteps = 1.0f;
+	MaxSubsteps = 8;
+	SubstepAngle = 15.0f;
+	bUseAsyncTraces = false;
 
 	BaseDamage = 100.0f;
 	VelocityDamageScaler = 1.0f;
@@ -48,30 +67,42 @@ bool UGS_Melee::GetWorldTransform_Implementation
 
 	if (bLodged)
 	{
-
+		PendingSweeps.Reset();
 		return true;
 	}
 
+	SCOPE_CYCLE_COUNTER(STAT_MeleeStrikeSweeps);
+
 	//root->OnComponentHit.AddUObject(this, &UGS_Melee::OnComponentHit);
 
 	// Blade edge / angle take into account
 	// Should we use the custom values of a physical material instead of the density?
 
+	// Last frames strike comes in first, it gets to lodge before we move on
+	if (PendingSweeps.Num())
+	{
+		TArray<FMeleeSweepHit> AsyncHits;
+		if (GatherAsyncHits(AsyncHits))
+		{
+			TArray<FMeleeSweepSegment> Segments = MoveTemp(PendingSweeps);
+			PendingSweeps.Reset();
+
+			if (!HandleStrikeHits(AsyncHits, Segments, root))
+				return false;
+		}
+	}
+
 	FVector Difference = (WorldTransform.GetLocation() - root->GetComponentLocation());
 	StrikeVelocity = Difference / DeltaTime;
 
-	static float MinimumPenetrationVelocity = 1000.0f;
-	static float DensityToVelocityScaler = 0.5f;
-
 	// Only even consider penetration if the velocity is at least this size, later we scale the density of the material to see if we can penetrate a specific other material.
-	if (bAllowPenetration && StrikeVelocity.SizeSquared() > FMath::Square(MinimumPenetrationVelocity))
+	if (bAllowPenetration && StrikeVelocity.SizeSquared() > FMath::Square(GSMelee::MinimumPenetrationVelocity))
 	{
 
 		// World transform is already set for us
 		const float MinMovementDistSq = (FMath::Square(4.f*KINDA_SMALL_NUMBER));
 		if (Difference.SizeSquared() > MinMovementDistSq)
 		{
-			TArray<FHitResult> SweepHits;
 			FComponentQueryParams Params(NAME_None, GetOwner());
 			Params.bReturnPhysicalMaterial = true;
 			Params.bTraceComplex = bTraceComplex;
@@ -80,94 +111,262 @@ bool UGS_Melee::GetWorldTransform_Implementation
 			Params.AddIgnoredActor(GrippingController->GetOwner());
 			Params.AddIgnoredActors(root->MoveIgnoreActors);
 
-			// Should we sub step this across rotation?
-			GetWorld()->ComponentSweepMulti(SweepHits, root, root->GetComponentLocation(), WorldTransform.GetLocation(), WorldTransform.GetRotation(), Params);
+			TArray<FMeleeSweepSegment> Segments;
+			BuildSweepChain(root->GetComponentTransform(), WorldTransform, Segments);
+
+			TArray<FMeleeSweepShape, TInlineAllocator<4>> AsyncShapes;
+			if (bUseAsyncTraces && GetAsyncSweepShapes(root, Params, AsyncShapes))
+			{
+				// Don't stack up a second strike if the last one hasn't come back yet
+				if (!PendingSweeps.Num())
+				{
+					QueueAsyncSweeps(Segments, AsyncShapes, root, Params);
+					PendingSweeps = MoveTemp(Segments);
+				}
+			}
+			else
+			{
+				TArray<FMeleeSweepHit> SweepHits;
+				SweepChain(Segments, root, Params, SweepHits);
+
+				if (!HandleStrikeHits(SweepHits, Segments, root))
+					return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+void UGS_Melee::BuildSweepChain(const FTransform & From, const FTransform & To, TArray<FMeleeSweepSegment> & OutSegments) const
+{
+	int32 NumSegments = 1;
+
+	if (bSubstepTrace && SubstepAngle > 0.0f)
+	{
+		float SweptAngle = FMath::RadiansToDegrees(From.GetRotation().AngularDistance(To.GetRotation()));
+		NumSegments = FMath::Clamp(FMath::CeilToInt(SweptAngle / SubstepAngle), 1, FMath::Max(1, MaxSubsteps));
+	}
+
+	OutSegments.Reset(NumSegments);
+
+	FTransform SegmentStart = From;
+	for (int32 i = 1; i <= NumSegments; ++i)
+	{
+		FTransform SegmentEnd = To;
+		if (i < NumSegments)
+		{
+			const float Alpha = (float)i / (float)NumSegments;
+			SegmentEnd.Blend(From, To, Alpha);
+
+			// Blend normalizes a straight lerp of the rotation, which bunches the segments up in the middle of wide swings
+			SegmentEnd.SetRotation(FQuat::Slerp(From.GetRotation(), To.GetRotation(), Alpha));
+		}
+
+		FMeleeSweepSegment & Segment = OutSegments.AddDefaulted_GetRef();
+		Segment.Start = SegmentStart;
+		Segment.End = SegmentEnd;
+		SegmentStart = SegmentEnd;
+	}
+}
+
+void UGS_Melee::SweepChain(TArray<FMeleeSweepSegment> & Segments, UPrimitiveComponent * root, const FComponentQueryParams & Params, TArray<FMeleeSweepHit> & OutHits)
+{
+	TArray<FHitResult> SweepHits;
+	for (int32 i = 0; i < Segments.Num(); ++i)
+	{
+		SweepHits.Reset();
+		GetWorld()->ComponentSweepMulti(SweepHits, root, Segments[i].Start.GetLocation(), Segments[i].End.GetLocation(), Segments[i].End.GetRotation(), Params);
+
+		bool bHadBlockingHit = false;
+		for (FHitResult & HitResult : SweepHits)
+		{
+			if (!GSMelee::IsStrikeHit(HitResult, i))
+				continue;
+
+			OutHits.Add({ HitResult, i, (i + HitResult.Time) / (float)Segments.Num() });
+			bHadBlockingHit = true;
+		}
+
+		// Anything further along the arc is behind what we already hit
+		if (bHadBlockingHit)
+			break;
+	}
+}
+
+bool UGS_Melee::GetAsyncSweepShapes(UPrimitiveComponent * root, const FComponentQueryParams & Params, TArray<FMeleeSweepShape, TInlineAllocator<4>> & OutShapes) const
+{
+	OutShapes.Reset();
+
+	// GetCollisionShape is only the bounds box for anything that isn't a shape component, so sweep the bodies own elements instead
+	UBodySetup * BodySetup = root->GetBodySetup();
+	if (!BodySetup || Params.bTraceComplex || root->IsA<USkinnedMeshComponent>())
+		return false;
+
+	const FKAggregateGeom & AggGeom = BodySetup->AggGeom;
+	if (AggGeom.ConvexElems.Num() || AggGeom.TaperedCapsuleElems.Num() || !AggGeom.GetElementCount())
+		return false;
+
+	const FVector Scale3D = root->GetComponentScale();
+
+	for (const FKSphereElem & SphereElem : AggGeom.SphereElems)
+	{
+		const FKSphereElem Scaled = SphereElem.GetFinalScaled(Scale3D, FTransform::Identity);
+		OutShapes.Add({ FCollisionShape::MakeSphere(Scaled.Radius), FTransform(Scaled.Center) });
+	}
+
+	for (const FKBoxElem & BoxElem : AggGeom.BoxElems)
+	{
+		const FKBoxElem Scaled = BoxElem.GetFinalScaled(Scale3D, FTransform::Identity);
+		OutShapes.Add({ FCollisionShape::MakeBox(FVector(Scaled.X, Scaled.Y, Scaled.Z) * 0.5f), FTransform(Scaled.Rotation, Scaled.Center) });
+	}
+
+	for (const FKSphylElem & SphylElem : AggGeom.SphylElems)
+	{
+		const FKSphylElem Scaled = SphylElem.GetFinalScaled(Scale3D, FTransform::Identity);
+		OutShapes.Add({ FCollisionShape::MakeCapsule(Scaled.Radius, (Scaled.Length * 0.5f) + Scaled.Radius), FTransform(Scaled.Rotation, Scaled.Center) });
+	}
+
+	return OutShapes.Num() > 0;
+}
+
+void UGS_Melee::QueueAsyncSweeps(TArray<FMeleeSweepSegment> & Segments, const TArray<FMeleeSweepShape, TInlineAllocator<4>> & Shapes, UPrimitiveComponent * root, const FComponentQueryParams & Params)
+{
+	UWorld * World = GetWorld();
+	FCollisionResponseParams ResponseParams(root->GetCollisionResponseToChannels());
+	ECollisionChannel Channel = root->GetCollisionObjectType();
+
+	for (FMeleeSweepSegment & Segment : Segments)
+	{
+		// The element offsets are already scaled
+		const FTransform Start(Segment.Start.GetRotation(), Segment.Start.GetLocation());
+		const FTransform End(Segment.End.GetRotation(), Segment.End.GetLocation());
+
+		Segment.Handles.Reset();
+		for (const FMeleeSweepShape & Shape : Shapes)
+		{
+			const FTransform ShapeEnd = Shape.LocalTransform * End;
+			Segment.Handles.Add(World->AsyncSweepByChannel(EAsyncTraceType::Multi, Start.TransformPosition(Shape.LocalTransform.GetLocation()), ShapeEnd.GetLocation(), ShapeEnd.GetRotation(), Channel, Shape.Shape, Params, ResponseParams));
+		}
+	}
+}
+
+bool UGS_Melee::GatherAsyncHits(TArray<FMeleeSweepHit> & OutHits)
+{
+	UWorld * World = GetWorld();
+	FTraceDatum TraceData;
+
+	for (int32 i = 0; i < PendingSweeps.Num(); ++i)
+	{
+		for (const FTraceHandle & Handle : PendingSweeps[i].Handles)
+		{
+			// Results only live for the frame after they were queued, past that the strike is stale anyway
+			if (!World->QueryTraceData(Handle, TraceData))
+			{
+				PendingSweeps.Reset();
+				OutHits.Reset();
+				return false;
+			}
+
+			for (FHitResult & HitResult : TraceData.OutHits)
+			{
+				if (GSMelee::IsStrikeHit(HitResult, i))
+					OutHits.Add({ HitResult, i, (i + HitResult.Time) / (float)PendingSweeps.Num() });
+			}
+		}
+	}
+
+	return true;
+}
+
+bool UGS_Melee::HandleStrikeHits(const TArray<FMeleeSweepHit> & Hits, const TArray<FMeleeSweepSegment> & Segments, UPrimitiveComponent * root)
+{
+	if (!Hits.Num())
+		return true;
+
+	// Handle them in the order that the arc reached them
+	TArray<FMeleeSweepHit> SortedHits = Hits;
+	SortedHits.StableSort([](const FMeleeSweepHit & A, const FMeleeSweepHit & B)
+	{
+		return A.TimeOfImpact < B.TimeOfImpact;
+	});
+
+	for (FMeleeSweepHit & SweepHit : SortedHits)
+	{
+		FHitResult & HitResult = SweepHit.Hit;
 
+		if (!HitResult.bBlockingHit || !HitResult.Component.IsValid())
+			continue;
 
-			/*
-				// Now sweep collision separately so we can get hits but not have the location altered
-					if (UPrimitiveComponent * primComp = Cast<UPrimitiveComponent>(Prim))
-					{
-					CheckComponentWithSweep(primComp, move, primComp->GetComponentRotation(), false);
-			*/
+		// Impart force when being pushed in / pulled out
 
+		//FVector VelocityOnNormalPlane;
+		if (HitResult.PhysMaterial != nullptr) //&& SurfaceTypesToPenetrate.Contains(HitResult.PhysMaterial->SurfaceType.GetValue()))
+		{
+			float ModifiedPenetrationVelocity = GSMelee::MinimumPenetrationVelocity * (GSMelee::DensityToVelocityScaler * HitResult.PhysMaterial->Density);
+			bLodged = true;
+			OnMeleeLodgedChanged.Broadcast(bLodged);
+			LodgeParent = HitResult.Component;
+			
 
-			//if (FHitResult::GetNumBlockingHits(SweepHits) > 0)
+			if (HitResult.Component->GetMass() < 1000.0f)
 			{
-				for (FHitResult & HitResult : SweepHits)
-				{
-					if (!HitResult.IsValidBlockingHit())
-						continue;
-
-
-					// Impart force when being pushed in / pulled out
-
-					//FVector VelocityOnNormalPlane;
-					if (HitResult.PhysMaterial != nullptr) //&& SurfaceTypesToPenetrate.Contains(HitResult.PhysMaterial->SurfaceType.GetValue()))
-					{
-						float ModifiedPenetrationVelocity = MinimumPenetrationVelocity* (DensityToVelocityScaler * HitResult.PhysMaterial->Density);
-						bLodged = true;
-						OnMeleeLodgedChanged.Broadcast(bLodged);
-						LodgeParent = HitResult.Component;
-						
-
-						if (HitResult.Component->GetMass() < 1000.0f)
-						{
-							FTransform HitTransform = HitResult.Component->GetComponentTransform();
-							HitTransform.AddToTranslation((HitResult.ImpactNormal) * 20.0f);
-
-							// Should also handle backing out if it goes outside of the body
-							HitResult.Component->SetWorldTransform(HitTransform);
-
-							//AttachmentRules.bWeldSimulatedBodies = true;
-							//FAttachmentTransformRules AttachmentRules = FAttachmentTransformRules::KeepWor
-							//HitResult.Component->AttachToComponent(root, AttachmentRules);
-							
-							
-							/*FVector SpawnLoc = HitResult.ImpactPoint;
-							FRotator SpawnRot = FRotator::ZeroRotator;
-							APhysicsConstraintActor * aConstraint = Cast<APhysicsConstraintActor>(GetWorld()->SpawnActor(APhysicsConstraintActor::StaticClass(), &SpawnLoc, &SpawnRot));
-							aConstraint->GetConstraintComp()->SetConstrainedComponents(root, NAME_None, HitResult.Component.Get(), HitResult.BoneName);
-							aConstraint->GetConstraintComp()->SetDisableCollision(true);*/
-						}
-						else
-						{
-							// If the mass of the object hit is < threshold of the weapon, then we attach the hit object to the weapon instead of attaching the weapon
-							// to the hit object, could also add a constraint between the two...mmm
-							// would need a velocity for breaking this hold as well.
-							HitResult.Component->AddForceAtLocation((-HitResult.ImpactNormal * 10000.0f) * ModifiedPenetrationVelocity, HitResult.ImpactPoint, HitResult.BoneName);
-							//HitResult.Component->AddImpulseAtLocation((-HitResult.ImpactNormal) * ModifiedPenetrationVelocity, HitResult.ImpactPoint, HitResult.BoneName);
-
-							// If we penetrated, then project forward by the penetration at the same angle.
-
-							FVector HitNormal = HitResult.ImpactNormal;
-							FTransform HitTransform = root->GetComponentTransform();
-							HitTransform.SetRotation(WorldTransform.GetRotation());
-							HitTransform.Blend(HitTransform, WorldTransform, HitResult.Time);
-
-							// Blend in penetration depth by hit normal
-							HitTransform.AddToTranslation((-HitNormal) * 20.0f);
-
-							// Should also handle backing out if it goes outside of the body
-							root->SetWorldTransform(HitTransform);
-							FAttachmentTransformRules AttachmentRules = FAttachmentTransformRules::KeepWorldTransform;
-							AttachmentRules.bWeldSimulatedBodies = true;
-							root->AttachToComponent(HitResult.Component.Get(), AttachmentRules, HitResult.BoneName);
-
-							// If other is simulating, then attach to the sword?
-							// Otherwise just penetrate?
-
-							// We can penetrate it
-							// Sample density
-							return false;
-						}
-					}
-
-					//FHitResult.Normal
-					//FHitResult.PenetrationDepth
-				}
+				FTransform HitTransform = HitResult.Component->GetComponentTransform();
+				HitTransform.AddToTranslation((HitResult.ImpactNormal) * 20.0f);
+
+				// Should also handle backing out if it goes outside of the body
+				HitResult.Component->SetWorldTransform(HitTransform);
+
+				//AttachmentRules.bWeldSimulatedBodies = true;
+				//FAttachmentTransformRules AttachmentRules = FAttachmentTransformRules::KeepWor
+				//HitResult.Component->AttachToComponent(root, AttachmentRules);
+				
+				
+				/*FVector SpawnLoc = HitResult.ImpactPoint;
+				FRotator SpawnRot = FRotator::ZeroRotator;
+				APhysicsConstraintActor * aConstraint = Cast<APhysicsConstraintActor>(GetWorld()->SpawnActor(APhysicsConstraintActor::StaticClass(), &SpawnLoc, &SpawnRot));
+				aConstraint->GetConstraintComp()->SetConstrainedComponents(root, NAME_None, HitResult.Component.Get(), HitResult.BoneName);
+				aConstraint->GetConstraintComp()->SetDisableCollision(true);*/
+
+				// Lodged into the first thing the arc reached, anything after it was behind it
+				return true;
+			}
+			else
+			{
+				// If the mass of the object hit is < threshold of the weapon, then we attach the hit object to the weapon instead of attaching the weapon
+				// to the hit object, could also add a constraint between the two...mmm
+				// would need a velocity for breaking this hold as well.
+				HitResult.Component->AddForceAtLocation((-HitResult.ImpactNormal * 10000.0f) * ModifiedPenetrationVelocity, HitResult.ImpactPoint, HitResult.BoneName);
+				//HitResult.Component->AddImpulseAtLocation((-HitResult.ImpactNormal) * ModifiedPenetrationVelocity, HitResult.ImpactPoint, HitResult.BoneName);
+
+				// If we penetrated, then project forward by the penetration at the same angle.
+
+				FVector HitNormal = HitResult.ImpactNormal;
+				const FMeleeSweepSegment & Segment = Segments[SweepHit.Segment];
+				FTransform HitTransform = Segment.Start;
+				HitTransform.SetRotation(Segment.End.GetRotation());
+				HitTransform.Blend(HitTransform, Segment.End, HitResult.Time);
+
+				// Blend in penetration depth by hit normal
+				HitTransform.AddToTranslation((-HitNormal) * 20.0f);
+
+				// Should also handle backing out if it goes outside of the body
+				root->SetWorldTransform(HitTransform);
+				FAttachmentTransformRules AttachmentRules = FAttachmentTransformRules::KeepWorldTransform;
+				AttachmentRules.bWeldSimulatedBodies = true;
+				root->AttachToComponent(HitResult.Component.Get(), AttachmentRules, HitResult.BoneName);
+
+				// If other is simulating, then attach to the sword?
+				// Otherwise just penetrate?
+
+				// We can penetrate it
+				// Sample density
+				return false;
 			}
 		}
+
+		//FHitResult.Normal
+		//FHitResult.PenetrationDepth
 	}
 
 	return true;
@@ -4,6 +4,9 @@
 #include "GripMotionControllerComponent.h"
 #include "Engine/BlueprintGeneratedClass.h"
 #include "Engine/NetDriver.h"
+#include "Engine/ActorChannel.h"
+#include "Net/DataReplication.h"
+#include "UObject/UnrealType.h"
 
  
 UVRGripScriptBase::UVRGripScriptBase(const FObjectInitializer& ObjectInitializer)
@@ -20,6 +23,14 @@ UVRGripScriptBase::UVRGripScriptBase(const FObjectInitializer& ObjectInitializer
 
 	bCanEverTick = false;
 	bAllowTicking = false;
+	bTickWhileHeld = false;
+	TickPhase = EVRGripScriptTickPhase::PostPhysics;
+
+	SchedulerBatchIndex = INDEX_NONE;
+	SchedulerSlot = INDEX_NONE;
+	HeldCount = 0;
+	ReplicationRevision = 0;
+	bReplicationShadowInitialized = false;
 }
 
 void UVRGripScriptBase::OnEndPlay_Implementation(const EEndPlayReason::Type EndPlayReason) {};
@@ -53,47 +64,226 @@ void UVRGripScriptBase::GetLifetimeReplicatedProps(TArray< class FLifetimeProper
 	}
 }
 
-void UVRGripScriptBase::Tick(float DeltaTime)
+void UVRGripScriptBase::MarkScriptReplicationDirty()
 {
-	// Do nothing by default
+	++ReplicationRevision;
 }
 
-bool UVRGripScriptBase::IsTickable() const
+void UVRGripScriptBase::RefreshReplicationRevision()
 {
-	return bAllowTicking;
+	// Only blueprint scripts have replicated properties
+	UBlueprintGeneratedClass* BPClass = Cast<UBlueprintGeneratedClass>(GetClass());
+	if (!BPClass)
+		return;
+
+	if (!bReplicationShadowInitialized)
+	{
+		bReplicationShadowInitialized = true;
+
+		int32 ShadowSize = 0;
+		for (TFieldIterator<UProperty> It(BPClass); It; ++It)
+		{
+			if (!It->HasAnyPropertyFlags(CPF_Net))
+				continue;
+
+			ShadowSize = Align(ShadowSize, It->GetMinAlignment());
+			ReplicationShadowProperties.Add({ *It, ShadowSize });
+			ShadowSize += It->GetSize();
+		}
+
+		ReplicationShadow.SetNumZeroed(ShadowSize);
+
+		for (const FReplicationShadowProperty & Shadow : ReplicationShadowProperties)
+		{
+			Shadow.Property->InitializeValue(ReplicationShadow.GetData() + Shadow.Offset);
+			Shadow.Property->CopyCompleteValue(ReplicationShadow.GetData() + Shadow.Offset, Shadow.Property->ContainerPtrToValuePtr<void>(this));
+		}
+
+		return;
+	}
+
+	bool bChanged = false;
+	for (const FReplicationShadowProperty & Shadow : ReplicationShadowProperties)
+	{
+		UProperty * Property = Shadow.Property;
+		uint8 * ShadowValue = ReplicationShadow.GetData() + Shadow.Offset;
+
+		for (int32 i = 0; i < Property->ArrayDim; ++i)
+		{
+			void * Value = Property->ContainerPtrToValuePtr<void>(this, i);
+			void * ShadowElement = ShadowValue + (i * Property->ElementSize);
+
+			if (!Property->Identical(ShadowElement, Value))
+			{
+				Property->CopySingleValue(ShadowElement, Value);
+				bChanged = true;
+			}
+		}
+	}
+
+	if (bChanged)
+		++ReplicationRevision;
 }
 
-UWorld* UVRGripScriptBase::GetTickableGameObjectWorld() const
+void UVRGripScriptBase::DestroyReplicationShadow()
 {
-	return GetWorld();
+	for (const FReplicationShadowProperty & Shadow : ReplicationShadowProperties)
+	{
+		Shadow.Property->DestroyValue(ReplicationShadow.GetData() + Shadow.Offset);
+	}
+
+	ReplicationShadowProperties.Empty();
+	ReplicationShadow.Empty();
+	bReplicationShadowInitialized = false;
 }
 
-bool UVRGripScriptBase::IsTickableInEditor() const
+namespace GripScriptReplicationCVars
 {
-	return false;
+	static int32 TrackScriptReplication = 1;
+	FAutoConsoleVariableRef CVarTrackScriptReplication(
+		TEXT("vr.GripScripts.TrackReplication"),
+		TrackScriptReplication,
+		TEXT("When on, grippables skip replicating grip scripts to connections that already acknowledged them until a script changes.\n")
+		TEXT("0: Replicate every script every pass, 1: Enable"),
+		ECVF_Default);
 }
 
-bool UVRGripScriptBase::IsTickableWhenPaused() const
+uint32 FVRGripScriptReplicationTracker::GetRevision(const TArray<UVRGripScriptBase*> & Scripts)
 {
-	return false;
+	// Once per frame, every connection in the pass shares it
+	if (CachedRevisionFrame != GFrameCounter)
+	{
+		CachedRevisionFrame = GFrameCounter;
+		CachedRevision = GetTypeHash(Scripts.Num());
+
+		for (UVRGripScriptBase * Script : Scripts)
+		{
+			CachedRevision = HashCombine(CachedRevision, GetTypeHash(Script));
+			if (Script)
+			{
+				Script->RefreshReplicationRevision();
+				CachedRevision = HashCombine(CachedRevision, Script->GetReplicationRevision());
+			}
+		}
+
+		// Closed channels lose their actor, pooled ones get a fresh record when they re-open
+		for (auto Itr = ChannelRecords.CreateIterator(); Itr; ++Itr)
+		{
+			UActorChannel * RecordChannel = Itr.Key().Get();
+			if (!RecordChannel || !RecordChannel->Actor)
+				Itr.RemoveCurrent();
+		}
+	}
+
+	return CachedRevision;
 }
 
-ETickableTickType UVRGripScriptBase::GetTickableTickType() const
+bool FVRGripScriptReplicationTracker::ReplicateScripts(const TArray<UVRGripScriptBase*> & Scripts, const FVRGripScriptReplicationSettings & Settings, UActorChannel * Channel, FOutBunch * Bunch, FReplicationFlags * RepFlags)
 {
-	if(IsTemplate(RF_ClassDefaultObject))
-		return ETickableTickType::Never;
+	bool WroteSomething = false;
 
-	return bCanEverTick ? ETickableTickType::Conditional : ETickableTickType::Never;
+	if (!GripScriptReplicationCVars::TrackScriptReplication)
+	{
+		for (UVRGripScriptBase* Script : Scripts)
+		{
+			if (Script && !Script->IsPendingKill())
+			{
+				WroteSomething |= Channel->ReplicateSubobject(Script, *Bunch, *RepFlags);
+			}
+		}
+
+		return WroteSomething;
+	}
+
+	if (!BeginReplication(Scripts, Settings, Channel, RepFlags->bNetInitial))
+		return false;
+
+	// Keep sending until every script replicator has no outstanding changes, lost packets are resent in the meantime
+	bool bAllAcknowledged = true;
+	for (UVRGripScriptBase* Script : Scripts)
+	{
+		if (Script && !Script->IsPendingKill())
+		{
+			WroteSomething |= Channel->ReplicateSubobject(Script, *Bunch, *RepFlags);
+
+			const TSharedRef<FObjectReplicator> * Replicator = Channel->ReplicationMap.Find(Script);
+			bAllAcknowledged &= Replicator && (*Replicator)->ReadyForDormancy(true);
+		}
+	}
+
+	EndReplication(Channel, bAllAcknowledged);
+
+	return WroteSomething;
 }
 
-TStatId UVRGripScriptBase::GetStatId() const
+bool FVRGripScriptReplicationTracker::BeginReplication(const TArray<UVRGripScriptBase*> & Scripts, const FVRGripScriptReplicationSettings & Settings, UActorChannel * Channel, bool bNetInitial)
 {
-	RETURN_QUICK_DECLARE_CYCLE_STAT(UVRGripScriptBase, STATGROUP_Tickables);
+	const uint32 Revision = GetRevision(Scripts);
+	FChannelRecord & Record = ChannelRecords.FindOrAdd(Channel);
+
+	if (Record.OpenPacketId != Channel->OpenPacketId.First || bNetInitial)
+	{
+		Record = FChannelRecord();
+		Record.OpenPacketId = Channel->OpenPacketId.First;
+	}
+
+	if (Record.bAcknowledged && (Record.Revision == Revision || Settings.bReplicateScriptsOnce))
+		return false;
+
+	if (Record.Revision != Revision)
+	{
+		Record.Revision = Revision;
+		Record.bAcknowledged = false;
+	}
+
+	return true;
+}
+
+void FVRGripScriptReplicationTracker::EndReplication(UActorChannel * Channel, bool bAllAcknowledged)
+{
+	if (FChannelRecord * Record = ChannelRecords.Find(Channel))
+		Record->bAcknowledged = bAllAcknowledged;
+}
+
+void UVRGripScriptBase::Tick(float DeltaTime)
+{
+	// Do nothing by default
+}
+
+bool UVRGripScriptBase::IsTickable() const
+{
+	return bAllowTicking;
+}
+
+bool UVRGripScriptBase::ShouldBeAwake() const
+{
+	return bCanEverTick && (IsTickable() || (bTickWhileHeld && HeldCount > 0));
 }
 
 void UVRGripScriptBase::SetTickEnabled(bool bTickEnabled)
 {
+	if (bAllowTicking == bTickEnabled)
+		return;
+
 	bAllowTicking = bTickEnabled;
+	RefreshTickState();
+}
+
+void UVRGripScriptBase::SetOwnerHeld(bool bIsHeld)
+{
+	HeldCount = FMath::Max(0, HeldCount + (bIsHeld ? 1 : -1));
+
+	if (bTickWhileHeld)
+		RefreshTickState();
+}
+
+void UVRGripScriptBase::RefreshTickState()
+{
+	// Only flips the slot in our class batch, registration stays put until EndPlay
+	if (UVRGripScriptScheduler * MyScheduler = Scheduler.Get())
+	{
+		MyScheduler->RefreshScript(this);
+	}
 }
 
 
@@ -224,15 +414,40 @@ bool UVRGripScriptBase::IsServer()
 
 void UVRGripScriptBase::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
+	if (UVRGripScriptScheduler * MyScheduler = Scheduler.Get())
+	{
+		MyScheduler->UnregisterScript(this);
+	}
+
+	HeldCount = 0;
 	OnEndPlay(EndPlayReason);
 }
 
 void UVRGripScriptBase::BeginPlay(UObject * CallingOwner)
 {
+	if (bCanEverTick && !IsTemplate())
+	{
+		if (UVRGripScriptScheduler * WorldScheduler = UVRGripScriptScheduler::Get(GetWorld()))
+		{
+			WorldScheduler->RegisterScript(this);
+		}
+	}
+
 	// Notify the subscripts about begin play
 	OnBeginPlay(CallingOwner);
 }
 
+void UVRGripScriptBase::BeginDestroy()
+{
+	if (UVRGripScriptScheduler * MyScheduler = Scheduler.Get())
+	{
+		MyScheduler->UnregisterScript(this);
+	}
+
+	DestroyReplicationShadow();
+	Super::BeginDestroy();
+}
+
 void UVRGripScriptBaseBP::Tick(float DeltaTime)
 {
 	ReceiveTick(DeltaTime);
@@ -0,0 +1,272 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GripScripts/VRGripScriptScheduler.h"
+#include "GripScripts/VRGripScriptBase.h"
+#include "GripMotionControllerComponent.h"
+#include "Engine/World.h"
+#include "Engine/Level.h"
+
+DECLARE_CYCLE_STAT(TEXT("GripScripts ~ PreGrip"), STAT_GripScriptsPreGrip, STATGROUP_TickGrip);
+DECLARE_CYCLE_STAT(TEXT("GripScripts ~ PostGrip"), STAT_GripScriptsPostGrip, STATGROUP_TickGrip);
+DECLARE_CYCLE_STAT(TEXT("GripScripts ~ PostPhysics"), STAT_GripScriptsPostPhysics, STATGROUP_TickGrip);
+
+void FVRGripScriptPhaseTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Target && !Target->IsPendingKill() && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Target->TickPhase(Phase, DeltaTime);
+	}
+}
+
+FString FVRGripScriptPhaseTickFunction::DiagnosticMessage()
+{
+	return FString::Printf(TEXT("UVRGripScriptScheduler[Phase %d]"), (int32)Phase);
+}
+
+UVRGripScriptScheduler::UVRGripScriptScheduler(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	bIsTickingPhase = false;
+	bHasNulledEntries = false;
+
+	for (uint8 i = 0; i < (uint8)EVRGripScriptTickPhase::MAX; ++i)
+	{
+		FVRGripScriptPhaseTickFunction & TickFunction = PhaseTickFunctions[i];
+		TickFunction.Target = this;
+		TickFunction.Phase = (EVRGripScriptTickPhase)i;
+		TickFunction.bCanEverTick = true;
+		TickFunction.bStartWithTickEnabled = false;
+		TickFunction.bTickEvenWhenPaused = false;
+		TickFunction.TickGroup = TickFunction.Phase == EVRGripScriptTickPhase::PostPhysics ? TG_PostPhysics : TG_PrePhysics;
+		TickFunction.EndTickGroup = TickFunction.TickGroup;
+		NumAwakeScripts[i] = 0;
+	}
+}
+
+UVRGripScriptScheduler * UVRGripScriptScheduler::Get(UWorld * World, bool bCreateIfMissing)
+{
+	if (!World || !World->IsGameWorld() || !World->PersistentLevel)
+		return nullptr;
+
+	// Held by the world so it shares its lifetime, there is only ever one per world so a scan is fine
+	for (UObject * DataObject : World->PerModuleDataObjects)
+	{
+		if (UVRGripScriptScheduler * Scheduler = Cast<UVRGripScriptScheduler>(DataObject))
+			return Scheduler;
+	}
+
+	if (!bCreateIfMissing || World->bIsTearingDown)
+		return nullptr;
+
+	UVRGripScriptScheduler * NewScheduler = NewObject<UVRGripScriptScheduler>(World);
+	World->PerModuleDataObjects.Add(NewScheduler);
+
+	for (FVRGripScriptPhaseTickFunction & TickFunction : NewScheduler->PhaseTickFunctions)
+	{
+		TickFunction.RegisterTickFunction(World->PersistentLevel);
+	}
+
+	return NewScheduler;
+}
+
+void UVRGripScriptScheduler::BeginDestroy()
+{
+	for (FVRGripScriptPhaseTickFunction & TickFunction : PhaseTickFunctions)
+	{
+		if (TickFunction.IsTickFunctionRegistered())
+			TickFunction.UnRegisterTickFunction();
+
+		TickFunction.Target = nullptr;
+	}
+
+	for (FVRGripScriptClassBatch & Batch : Batches)
+	{
+		for (UVRGripScriptBase * Script : Batch.AwakeScripts)
+		{
+			if (Script)
+			{
+				Script->SchedulerBatchIndex = INDEX_NONE;
+				Script->SchedulerSlot = INDEX_NONE;
+			}
+		}
+	}
+
+	Batches.Empty();
+	Super::BeginDestroy();
+}
+
+void UVRGripScriptScheduler::RegisterScript(UVRGripScriptBase * Script)
+{
+	if (!Script || Script->SchedulerBatchIndex != INDEX_NONE)
+		return;
+
+	UClass * ScriptClass = Script->GetClass();
+	const EVRGripScriptTickPhase ScriptPhase = Script->TickPhase;
+	int32 BatchIndex = Batches.IndexOfByPredicate([ScriptClass, ScriptPhase](const FVRGripScriptClassBatch & Batch)
+	{
+		return Batch.ScriptClass == ScriptClass && Batch.Phase == ScriptPhase;
+	});
+
+	if (BatchIndex == INDEX_NONE)
+	{
+		BatchIndex = Batches.AddDefaulted();
+		Batches[BatchIndex].ScriptClass = ScriptClass;
+		Batches[BatchIndex].Phase = ScriptPhase;
+	}
+
+	Script->Scheduler = this;
+	Script->SchedulerBatchIndex = BatchIndex;
+	Script->SchedulerSlot = INDEX_NONE;
+
+	RefreshScript(Script);
+}
+
+void UVRGripScriptScheduler::UnregisterScript(UVRGripScriptBase * Script)
+{
+	if (!Script || Script->SchedulerBatchIndex == INDEX_NONE)
+		return;
+
+	SleepScript(Script);
+	Script->SchedulerBatchIndex = INDEX_NONE;
+	Script->Scheduler.Reset();
+}
+
+void UVRGripScriptScheduler::RefreshScript(UVRGripScriptBase * Script)
+{
+	if (!Script || !Batches.IsValidIndex(Script->SchedulerBatchIndex))
+		return;
+
+	if (Script->ShouldBeAwake())
+		WakeScript(Script);
+	else
+		SleepScript(Script);
+}
+
+void UVRGripScriptScheduler::WakeScript(UVRGripScriptBase * Script)
+{
+	if (Script->SchedulerSlot != INDEX_NONE)
+		return;
+
+	FVRGripScriptClassBatch & Batch = Batches[Script->SchedulerBatchIndex];
+
+	// Appended past the count the running phase captured, so a wake never ticks until the next frame
+	Script->SchedulerSlot = Batch.AwakeScripts.Add(Script);
+
+	if (++NumAwakeScripts[(uint8)Batch.Phase] == 1)
+		UpdatePhaseTickEnabled(Batch.Phase);
+}
+
+void UVRGripScriptScheduler::SleepScript(UVRGripScriptBase * Script)
+{
+	if (Script->SchedulerSlot == INDEX_NONE)
+		return;
+
+	FVRGripScriptClassBatch & Batch = Batches[Script->SchedulerBatchIndex];
+	const int32 Slot = Script->SchedulerSlot;
+	Script->SchedulerSlot = INDEX_NONE;
+
+	if (bIsTickingPhase)
+	{
+		// Can't shuffle the batch under the running loop, null it out and compact after the phase
+		Batch.AwakeScripts[Slot] = nullptr;
+		bHasNulledEntries = true;
+	}
+	else
+	{
+		Batch.AwakeScripts.RemoveAtSwap(Slot, 1, false);
+
+		if (Batch.AwakeScripts.IsValidIndex(Slot) && Batch.AwakeScripts[Slot])
+			Batch.AwakeScripts[Slot]->SchedulerSlot = Slot;
+	}
+
+	if (--NumAwakeScripts[(uint8)Batch.Phase] == 0)
+		UpdatePhaseTickEnabled(Batch.Phase);
+}
+
+void UVRGripScriptScheduler::CompactBatches()
+{
+	bHasNulledEntries = false;
+
+	for (FVRGripScriptClassBatch & Batch : Batches)
+	{
+		if (Batch.AwakeScripts.Remove(nullptr) > 0)
+		{
+			for (int32 i = 0; i < Batch.AwakeScripts.Num(); ++i)
+			{
+				Batch.AwakeScripts[i]->SchedulerSlot = i;
+			}
+		}
+	}
+}
+
+void UVRGripScriptScheduler::UpdatePhaseTickEnabled(EVRGripScriptTickPhase Phase)
+{
+	FVRGripScriptPhaseTickFunction & TickFunction = PhaseTickFunctions[(uint8)Phase];
+
+	// Keeps empty phases out of the tick task graph entirely
+	if (TickFunction.IsTickFunctionRegistered())
+		TickFunction.SetTickFunctionEnable(NumAwakeScripts[(uint8)Phase] > 0);
+}
+
+void UVRGripScriptScheduler::RegisterController(UGripMotionControllerComponent * Controller)
+{
+	if (!Controller)
+		return;
+
+	Controller->PrimaryComponentTick.AddPrerequisite(this, PhaseTickFunctions[(uint8)EVRGripScriptTickPhase::PreGrip]);
+	PhaseTickFunctions[(uint8)EVRGripScriptTickPhase::PostGrip].AddPrerequisite(Controller, Controller->PrimaryComponentTick);
+}
+
+void UVRGripScriptScheduler::UnregisterController(UGripMotionControllerComponent * Controller)
+{
+	if (!Controller)
+		return;
+
+	Controller->PrimaryComponentTick.RemovePrerequisite(this, PhaseTickFunctions[(uint8)EVRGripScriptTickPhase::PreGrip]);
+	PhaseTickFunctions[(uint8)EVRGripScriptTickPhase::PostGrip].RemovePrerequisite(Controller, Controller->PrimaryComponentTick);
+}
+
+void UVRGripScriptScheduler::TickPhase(EVRGripScriptTickPhase Phase, float DeltaTime)
+{
+	TStatId PhaseStat;
+	switch (Phase)
+	{
+	case EVRGripScriptTickPhase::PreGrip: PhaseStat = GET_STATID(STAT_GripScriptsPreGrip); break;
+	case EVRGripScriptTickPhase::PostGrip: PhaseStat = GET_STATID(STAT_GripScriptsPostGrip); break;
+	default: PhaseStat = GET_STATID(STAT_GripScriptsPostPhysics); break;
+	}
+	FScopeCycleCounter PhaseCounter(PhaseStat);
+
+	bIsTickingPhase = true;
+
+	// Batches run in the order their class first registered, scripts within a batch in the order they woke
+	// A tick can register a new class and grow Batches or wake a script and grow a batch, so nothing is held by reference.
+	// Counts are taken up front so anything added during the phase, in any batch, first ticks next frame
+	TArray<int32, TInlineAllocator<16>> NumToTick;
+	for (const FVRGripScriptClassBatch & Batch : Batches)
+	{
+		NumToTick.Add(Batch.Phase == Phase ? Batch.AwakeScripts.Num() : 0);
+	}
+
+	for (int32 BatchIndex = 0; BatchIndex < NumToTick.Num(); ++BatchIndex)
+	{
+		for (int32 i = 0; i < NumToTick[BatchIndex]; ++i)
+		{
+			UVRGripScriptBase * Script = Batches[BatchIndex].AwakeScripts[i];
+			if (Script && !Script->IsPendingKill())
+			{
+				Script->Tick(DeltaTime);
+			}
+		}
+	}
+
+	bIsTickingPhase = false;
+
+	if (bHasNulledEntries)
+		CompactBatches();
+}
+
+int32 UVRGripScriptScheduler::GetNumAwakeScripts(EVRGripScriptTickPhase Phase) const
+{
+	return Phase < EVRGripScriptTickPhase::MAX ? NumAwakeScripts[(uint8)Phase] : 0;
+}
@@ -64,13 +64,7 @@ bool AGrippableActor::ReplicateSubobjects(UActorChannel* Channel, class FOutBunc
 {
 	bool WroteSomething = Super::ReplicateSubobjects(Channel, Bunch, RepFlags);
 
-	for (UVRGripScriptBase* Script : GripLogicScripts)
-	{
-		if (Script && !Script->IsPendingKill())
-		{
-			WroteSomething |= Channel->ReplicateSubobject(Script, *Bunch, *RepFlags);
-		}
-	}
+	WroteSomething |= GripScriptReplicationTracker.ReplicateScripts(GripLogicScripts, GripScriptReplication, Channel, Bunch, RepFlags);
 
 	return WroteSomething;
 }
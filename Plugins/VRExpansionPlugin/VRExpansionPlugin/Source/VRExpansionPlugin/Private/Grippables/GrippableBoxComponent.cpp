@@ -61,13 +61,7 @@ bool UGrippableBoxComponent::ReplicateSubobjects(UActorChannel* Channel, class F
 {
 	bool WroteSomething = Super::ReplicateSubobjects(Channel, Bunch, RepFlags);
 
-	for (UVRGripScriptBase* Script : GripLogicScripts)
-	{
-		if (Script && !Script->IsPendingKill())
-		{
-			WroteSomething |= Channel->ReplicateSubobject(Script, *Bunch, *RepFlags);
-		}
-	}
+	WroteSomething |= GripScriptReplicationTracker.ReplicateScripts(GripLogicScripts, GripScriptReplication, Channel, Bunch, RepFlags);
 
 	return WroteSomething;
 }
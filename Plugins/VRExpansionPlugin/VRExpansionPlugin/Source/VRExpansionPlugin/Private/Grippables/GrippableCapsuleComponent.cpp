@@ -57,13 +57,7 @@ bool UGrippableCapsuleComponent::ReplicateSubobjects(UActorChannel* Channel, cla
 {
 	bool WroteSomething = Super::ReplicateSubobjects(Channel, Bunch, RepFlags);
 
-	for (UVRGripScriptBase* Script : GripLogicScripts)
-	{
-		if (Script && !Script->IsPendingKill())
-		{
-			WroteSomething |= Channel->ReplicateSubobject(Script, *Bunch, *RepFlags);
-		}
-	}
+	WroteSomething |= GripScriptReplicationTracker.ReplicateScripts(GripLogicScripts, GripScriptReplication, Channel, Bunch, RepFlags);
 
 	return WroteSomething;
 }
@@ -9,15 +9,390 @@
 namespace VRPhysicsReplicationStatics
 {
 	static bool bHasVRPhysicsReplication = false;
+
+	// Every live instance, so a scenes replication can be checked before it is cast to ours
+	static TSet<const FPhysicsReplication *> Instances;
 }
 
 FPhysicsReplicationVR::FPhysicsReplicationVR(FPhysScene* PhysScene) :
 	FPhysicsReplication(PhysScene)
 {
 	VRPhysicsReplicationStatics::bHasVRPhysicsReplication = true;
+	VRPhysicsReplicationStatics::Instances.Add(this);
+}
+
+FPhysicsReplicationVR::~FPhysicsReplicationVR()
+{
+	VRPhysicsReplicationStatics::Instances.Remove(this);
 }
 
 bool FPhysicsReplicationVR::IsInitialized()
 {
 	return VRPhysicsReplicationStatics::bHasVRPhysicsReplication;
-}
\ No newline at end of file
+}
+#if WITH_PHYSX
+namespace VRPhysicsReplicationCVars
+{
+	static int32 UseOwnerPing = 1;
+	FAutoConsoleVariableRef CVarUseOwnerPing(
+		TEXT("vr.PhysicsReplication.UseOwnerPing"),
+		UseOwnerPing,
+		TEXT("When on, client authed physics targets are extrapolated by the owning connections ping before correcting.\n")
+		TEXT("0: Disable (assume zero latency), 1: Enable"),
+		ECVF_Default);
+
+	// Engine overrides for the project error correction settings, negative (or zero for the ping limit) means use the settings
+	static float GetFloatOverride(const TCHAR * Name, float SettingsValue, bool bZeroIsUnset = false)
+	{
+		if (IConsoleVariable * CVar = IConsoleManager::Get().FindConsoleVariable(Name))
+		{
+			const float Value = CVar->GetFloat();
+			if (bZeroIsUnset ? Value > 0.0f : Value >= 0.0f)
+				return Value;
+		}
+
+		return SettingsValue;
+	}
+
+	static int32 GetIntValue(const TCHAR * Name)
+	{
+		IConsoleVariable * CVar = IConsoleManager::Get().FindConsoleVariable(Name);
+		return CVar ? CVar->GetInt() : 0;
+	}
+}
+
+void FPhysicsReplicationVR::FCachedErrorCorrection::Gather(const FRigidBodyErrorCorrection & ErrorCorrection)
+{
+	using namespace VRPhysicsReplicationCVars;
+
+	PingExtrapolation = GetFloatOverride(TEXT("p.NetPingExtrapolation"), ErrorCorrection.PingExtrapolation);
+	PingLimit = GetFloatOverride(TEXT("p.NetPingLimit"), ErrorCorrection.PingLimit, true);
+	ErrorPerLinearDiff = GetFloatOverride(TEXT("p.ErrorPerLinearDifference"), ErrorCorrection.ErrorPerLinearDifference);
+	ErrorPerAngularDiff = GetFloatOverride(TEXT("p.ErrorPerAngularDifference"), ErrorCorrection.ErrorPerAngularDifference);
+	MaxRestoredStateError = GetFloatOverride(TEXT("p.MaxRestoredStateError"), ErrorCorrection.MaxRestoredStateError);
+	ErrorAccumulationSeconds = GetFloatOverride(TEXT("p.ErrorAccumulationSeconds"), ErrorCorrection.ErrorAccumulationSeconds);
+	ErrorAccumulationDistanceSq = GetFloatOverride(TEXT("p.ErrorAccumulationDistanceSq"), ErrorCorrection.ErrorAccumulationDistanceSq);
+	ErrorAccumulationSimilarity = GetFloatOverride(TEXT("p.ErrorAccumulationSimilarity"), ErrorCorrection.ErrorAccumulationSimilarity);
+	PositionLerp = GetFloatOverride(TEXT("p.PositionLerp"), ErrorCorrection.PositionLerp);
+	LinearVelocityCoefficient = GetFloatOverride(TEXT("p.LinearVelocityCoefficient"), ErrorCorrection.LinearVelocityCoefficient);
+	AngleLerp = GetFloatOverride(TEXT("p.AngleLerp"), ErrorCorrection.AngleLerp);
+	AngularVelocityCoefficient = GetFloatOverride(TEXT("p.AngularVelocityCoefficient"), ErrorCorrection.AngularVelocityCoefficient);
+	MaxLinearHardSnapDistance = GetFloatOverride(TEXT("p.MaxLinearHardSnapDistance"), ErrorCorrection.MaxLinearHardSnapDistance);
+	bAlwaysHardSnap = GetIntValue(TEXT("p.AlwaysHardSnap")) != 0;
+	bSkipSkeletalRepOptimization = GetIntValue(TEXT("p.SkipSkeletalRepOptimization")) != 0;
+}
+
+void FPhysicsReplicationVR::FCorrectionBatch::Reset()
+{
+	Keys.Reset();
+	Components.Reset();
+	Bodies.Reset();
+	Targets.Reset();
+	PingSecondsOneWay.Reset();
+	CurrentStates.Reset();
+	TargetPositions.Reset();
+	TargetRotations.Reset();
+	NewTransforms.Reset();
+	NewLinearVelocities.Reset();
+	NewAngularVelocities.Reset();
+	Results.Reset();
+}
+
+int32 FPhysicsReplicationVR::FCorrectionBatch::Add(const TWeakObjectPtr<UPrimitiveComponent> & Key, UPrimitiveComponent * Component, FBodyInstance * Body, FReplicatedPhysicsTarget * Target, float PingOneWay, const FRigidBodyState & CurrentState)
+{
+	Keys.Add(Key);
+	Components.Add(Component);
+	Bodies.Add(Body);
+	Targets.Add(Target);
+	PingSecondsOneWay.Add(PingOneWay);
+	CurrentStates.Add(CurrentState);
+
+	TargetPositions.AddUninitialized();
+	TargetRotations.AddUninitialized();
+	NewTransforms.AddUninitialized();
+	NewLinearVelocities.AddUninitialized();
+	NewAngularVelocities.AddUninitialized();
+	return Results.Add(Correction_None);
+}
+
+bool FPhysicsReplicationVR::GetErrorStats(const UPrimitiveComponent * Component, FVRPhysicsReplicationErrorStats & OutStats)
+{
+	if (!IsInitialized() || !Component)
+		return false;
+
+	UWorld * World = Component->GetWorld();
+	FPhysScene * PhysScene = World ? World->GetPhysicsScene() : nullptr;
+
+	if (!PhysScene)
+		return false;
+
+	// Another factory can have been installed over ours, only cast once we know the scenes replication is one of ours
+	FPhysicsReplication * SceneReplication = PhysScene->GetPhysicsReplication();
+	if (SceneReplication && VRPhysicsReplicationStatics::Instances.Contains(SceneReplication))
+	{
+		FPhysicsReplicationVR * Replication = static_cast<FPhysicsReplicationVR*>(SceneReplication);
+
+		if (const FVRPhysicsReplicationErrorStats * Stats = Replication->ErrorStats.Find(Component))
+		{
+			OutStats = *Stats;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+float FPhysicsReplicationVR::GetCachedOwnerPing(const AActor * OwningActor)
+{
+	UPlayer * OwningPlayer = OwningActor ? OwningActor->GetNetOwningPlayer() : nullptr;
+	if (!OwningPlayer)
+		return 0.0f;
+
+	if (const float * CachedPing = CachedOwnerPings.Find(OwningPlayer))
+		return *CachedPing;
+
+	// ExactPing is already averaged by the player state so it is used as the smoothed estimate
+	float OwnerPing = 0.0f;
+	if (APlayerController * PlayerController = OwningPlayer->GetPlayerController(GetOwningWorld()))
+	{
+		if (APlayerState * PlayerState = PlayerController->PlayerState)
+		{
+			OwnerPing = PlayerState->ExactPing;
+		}
+	}
+
+	CachedOwnerPings.Add(OwningPlayer, OwnerPing);
+	return OwnerPing;
+}
+
+void FPhysicsReplicationVR::OnTick(float DeltaSeconds, TMap<TWeakObjectPtr<UPrimitiveComponent>, FReplicatedPhysicsTarget>& ComponentsToTargets)
+{
+	// Skip all of the custom logic if we aren't the server
+	const UWorld* World = GetOwningWorld();
+	if (World && World->GetNetMode() == ENetMode::NM_Client)
+	{
+		return FPhysicsReplication::OnTick(DeltaSeconds, ComponentsToTargets);
+	}
+
+	CachedSettings.Gather(UPhysicsSettings::Get()->PhysicErrorCorrection);
+	CachedOwnerPings.Reset();
+	Batch.Reset();
+	TargetsToRemove.Reset();
+
+	const bool bUseOwnerPing = VRPhysicsReplicationCVars::UseOwnerPing != 0;
+	const float LocalPing = bUseOwnerPing ? GetLocalPing() : 0.0f;
+	const float CurrentTimeSeconds = World ? World->GetTimeSeconds() : 0.0f;
+
+	// Gather
+	for (auto Itr = ComponentsToTargets.CreateIterator(); Itr; ++Itr)
+	{
+		// Its been more than half a second since the last update, lets cease using the target as a failsafe
+		// Clients will never update with that much latency, and if they somehow are, then they are dropping so many
+		// packets that it will be useless to use their data anyway
+		if ((CurrentTimeSeconds - Itr.Value().ArrivedTimeSeconds) > 0.5f)
+		{
+			TargetsToRemove.Add(Itr.Key());
+			continue;
+		}
+
+		UPrimitiveComponent* PrimComp = Itr.Key().Get();
+		if (!PrimComp)
+			continue;
+
+		FReplicatedPhysicsTarget& PhysicsTarget = Itr.Value();
+		if (!(PhysicsTarget.TargetState.Flags & ERigidBodyFlags::NeedsUpdate))
+			continue;
+
+		FBodyInstance* BI = PrimComp->GetBodyInstance(PhysicsTarget.BoneName);
+		AActor* OwningActor = PrimComp->GetOwner();
+
+		if (!BI || !OwningActor || !BI->IsInstanceSimulatingPhysics())
+			continue;
+
+		// Get the total ping - this approximates the time since the update was
+		// actually generated on the machine that is doing the authoritative sim.
+		// NOTE: We divide by 2 to approximate 1-way ping from 2-way ping.
+		const float OwnerPing = bUseOwnerPing ? GetCachedOwnerPing(OwningActor) : 0.0f;
+
+		FRigidBodyState CurrentState;
+		BI->GetRigidBodyState(CurrentState);
+		Batch.Add(Itr.Key(), PrimComp, BI, &PhysicsTarget, (LocalPing + OwnerPing) * 0.5f * 0.001f, CurrentState);
+	}
+
+	SolveBatch(DeltaSeconds);
+	ApplyBatch();
+
+	// Targets are only removed after the passes, the batch holds pointers into the map
+	for (const TWeakObjectPtr<UPrimitiveComponent> & Key : TargetsToRemove)
+	{
+		if (FReplicatedPhysicsTarget * Target = ComponentsToTargets.Find(Key))
+		{
+			OnTargetRestored(Key.Get(), *Target);
+			ComponentsToTargets.Remove(Key);
+		}
+	}
+
+	// Drop stats for destroyed components and ones that are no longer being corrected
+	for (auto StatItr = ErrorStats.CreateIterator(); StatItr; ++StatItr)
+	{
+		if (!StatItr.Key().IsValid() || !ComponentsToTargets.Contains(StatItr.Key()))
+			StatItr.RemoveCurrent();
+	}
+}
+
+void FPhysicsReplicationVR::SolveBatch(float DeltaSeconds)
+{
+	const FCachedErrorCorrection & Settings = CachedSettings;
+
+	for (int32 i = 0; i < Batch.Results.Num(); ++i)
+	{
+		FReplicatedPhysicsTarget & PhysicsTarget = *Batch.Targets[i];
+		const FRigidBodyState & NewState = PhysicsTarget.TargetState;
+		const FRigidBodyState & CurrentState = Batch.CurrentStates[i];
+
+		const float NewQuatSizeSqr = NewState.Quaternion.SizeSquared();
+		if (NewQuatSizeSqr < KINDA_SMALL_NUMBER || FMath::Abs(NewQuatSizeSqr - 1.f) > KINDA_SMALL_NUMBER)
+		{
+			// Bad target rotation, leave the body alone and wait for the next update
+			continue;
+		}
+
+		// Extrapolate the authoritative state by the latency it took to arrive
+		// PingLimit is a round trip in milliseconds like the engines, the batch holds one way seconds
+		const float PingSeconds = FMath::Clamp(Batch.PingSecondsOneWay[i], 0.f, Settings.PingLimit * 0.5f * 0.001f);
+		const float ExtrapolationDeltaSeconds = PingSeconds * Settings.PingExtrapolation;
+		const FVector TargetPos = NewState.Position + (NewState.LinVel * ExtrapolationDeltaSeconds);
+
+		FQuat TargetQuat = NewState.Quaternion;
+		const float NewAngVelSize = NewState.AngVel.Size();
+		if (NewAngVelSize > SMALL_NUMBER)
+		{
+			// AngVel is in degrees per second
+			const float ExtrapolationDeltaAngle = FMath::DegreesToRadians(NewAngVelSize * ExtrapolationDeltaSeconds);
+			TargetQuat = FQuat(NewState.AngVel / NewAngVelSize, ExtrapolationDeltaAngle) * NewState.Quaternion;
+		}
+
+		Batch.TargetPositions[i] = TargetPos;
+		Batch.TargetRotations[i] = TargetQuat;
+
+		const FVector LinDiff = TargetPos - CurrentState.Position;
+		const float LinDiffSize = LinDiff.Size();
+
+		const FQuat InvCurrentQuat = CurrentState.Quaternion.Inverse();
+		const FQuat DeltaQuat = TargetQuat * InvCurrentQuat;
+		FVector AngDiffAxis;
+		float AngDiff;
+		DeltaQuat.ToAxisAndAngle(AngDiffAxis, AngDiff);
+		AngDiff = FMath::RadiansToDegrees(FMath::UnwindRadians(AngDiff));
+		const float AngDiffSize = FMath::Abs(AngDiff);
+
+		const bool bShouldSleep = (NewState.Flags & ERigidBodyFlags::Sleeping) != 0;
+		const float Error = (LinDiffSize * Settings.ErrorPerLinearDiff) + (AngDiffSize * Settings.ErrorPerAngularDiff);
+		uint8 Result = Correction_None;
+
+		if (Error < Settings.MaxRestoredStateError)
+		{
+			PhysicsTarget.AccumulatedErrorSeconds = 0.0f;
+			Result |= Correction_Restored;
+		}
+		else
+		{
+			// Accumulate error while the previous correction failed to make progress in the same direction
+			const FVector PrevLinError = PhysicsTarget.PrevPosTarget - PhysicsTarget.PrevPos;
+			const float PrevProgress = FVector::DotProduct(FVector(CurrentState.Position) - PhysicsTarget.PrevPos, PrevLinError.GetSafeNormal());
+			const float PrevSimilarity = FVector::DotProduct(LinDiff, PrevLinError);
+
+			if (PrevProgress < Settings.ErrorAccumulationDistanceSq && PrevSimilarity > Settings.ErrorAccumulationSimilarity)
+				PhysicsTarget.AccumulatedErrorSeconds += DeltaSeconds;
+			else
+				PhysicsTarget.AccumulatedErrorSeconds = FMath::Max(PhysicsTarget.AccumulatedErrorSeconds - DeltaSeconds, 0.0f);
+
+			if (LinDiffSize > Settings.MaxLinearHardSnapDistance || PhysicsTarget.AccumulatedErrorSeconds > Settings.ErrorAccumulationSeconds || Settings.bAlwaysHardSnap)
+			{
+				// Too much error so just snap state here and be done with it
+				PhysicsTarget.AccumulatedErrorSeconds = 0.0f;
+				Batch.NewTransforms[i] = FTransform(TargetQuat, TargetPos);
+				Batch.NewLinearVelocities[i] = NewState.LinVel;
+				Batch.NewAngularVelocities[i] = NewState.AngVel;
+				Result |= Correction_HardSnap | Correction_Restored;
+			}
+			else
+			{
+				Batch.NewTransforms[i] = FTransform(FQuat::Slerp(CurrentState.Quaternion, TargetQuat, Settings.AngleLerp), FMath::Lerp(FVector(CurrentState.Position), TargetPos, Settings.PositionLerp));
+				Batch.NewLinearVelocities[i] = FVector(NewState.LinVel) + (LinDiff * Settings.LinearVelocityCoefficient * DeltaSeconds);
+				Batch.NewAngularVelocities[i] = FVector(NewState.AngVel) + (AngDiffAxis * AngDiff * Settings.AngularVelocityCoefficient * DeltaSeconds);
+				Result |= Correction_Interpolate;
+			}
+		}
+
+		if (bShouldSleep)
+			Result |= Correction_Sleep;
+
+		PhysicsTarget.PrevPosTarget = TargetPos;
+		PhysicsTarget.PrevPos = FVector(CurrentState.Position);
+
+		FVRPhysicsReplicationErrorStats & Stats = ErrorStats.FindOrAdd(Batch.Keys[i]);
+		Stats.LinearError = LinDiffSize;
+		Stats.AngularError = AngDiffSize;
+		Stats.MaxLinearError = FMath::Max(Stats.MaxLinearError, LinDiffSize);
+		Stats.PingSecondsOneWay = PingSeconds;
+		Stats.AccumulatedErrorSeconds = PhysicsTarget.AccumulatedErrorSeconds;
+		Stats.NumCorrections++;
+
+		if (Result & Correction_HardSnap)
+			Stats.NumHardSnaps++;
+
+		Batch.Results[i] = Result;
+	}
+}
+
+void FPhysicsReplicationVR::ApplyBatch()
+{
+	const bool bAutoWake = false;
+	const FVector ZeroVector(ForceInitToZero);
+
+	for (int32 i = 0; i < Batch.Results.Num(); ++i)
+	{
+		const uint8 Result = Batch.Results[i];
+		if (Result == Correction_None)
+			continue;
+
+		FBodyInstance * BI = Batch.Bodies[i];
+		UPrimitiveComponent * PrimComp = Batch.Components[i];
+
+		if (Result & Correction_HardSnap)
+		{
+			BI->SetBodyTransform(Batch.NewTransforms[i], ETeleportType::ResetPhysics, bAutoWake);
+			BI->SetLinearVelocity(Batch.NewLinearVelocities[i], false, bAutoWake);
+			BI->SetAngularVelocityInRadians(FMath::DegreesToRadians(Batch.NewAngularVelocities[i]), false, bAutoWake);
+		}
+		else if (Result & Correction_Interpolate)
+		{
+			BI->SetBodyTransform(Batch.NewTransforms[i], ETeleportType::ResetPhysics);
+			BI->SetLinearVelocity(Batch.NewLinearVelocities[i], false);
+			BI->SetAngularVelocityInRadians(FMath::DegreesToRadians(Batch.NewAngularVelocities[i]), false);
+		}
+
+		if (Result & Correction_Sleep)
+		{
+			// In the sleep case we need to zero out the movement and put the body back to sleep
+			BI->SetLinearVelocity(ZeroVector, false, false);
+			BI->SetAngularVelocityInRadians(ZeroVector, false, false);
+			BI->PutInstanceToSleep();
+		}
+
+		// Need to update the component to match new position.
+		// Simulated skeletal meshes do their own polling of physics results so we don't need to call this for them
+		if (!CachedSettings.bSkipSkeletalRepOptimization || Cast<USkeletalMeshComponent>(PrimComp) == nullptr)
+		{
+			PrimComp->SyncComponentToRBPhysics();
+		}
+
+		// We always want to cease activity on sleep
+		if (Result & (Correction_Restored | Correction_Sleep))
+		{
+			TargetsToRemove.Add(Batch.Keys[i]);
+		}
+	}
+}
+#endif
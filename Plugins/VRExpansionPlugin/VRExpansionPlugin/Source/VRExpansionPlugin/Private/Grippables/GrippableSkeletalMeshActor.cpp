@@ -86,13 +86,7 @@ bool AGrippableSkeletalMeshActor::ReplicateSubobjects(UActorChannel* Channel, cl
 {
 	bool WroteSomething = Super::ReplicateSubobjects(Channel, Bunch, RepFlags);
 
-	for (UVRGripScriptBase* Script : GripLogicScripts)
-	{
-		if (Script && !Script->IsPendingKill())
-		{
-			WroteSomething |= Channel->ReplicateSubobject(Script, *Bunch, *RepFlags);
-		}
-	}
+	WroteSomething |= GripScriptReplicationTracker.ReplicateScripts(GripLogicScripts, GripScriptReplication, Channel, Bunch, RepFlags);
 
 	return WroteSomething;
 }
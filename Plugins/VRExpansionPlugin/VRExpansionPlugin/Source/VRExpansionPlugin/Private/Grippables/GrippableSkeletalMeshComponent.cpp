@@ -57,13 +57,7 @@ bool UGrippableSkeletalMeshComponent::ReplicateSubobjects(UActorChannel* Channel
 {
 	bool WroteSomething = Super::ReplicateSubobjects(Channel, Bunch, RepFlags);
 
-	for (UVRGripScriptBase* Script : GripLogicScripts)
-	{
-		if (Script && !Script->IsPendingKill())
-		{
-			WroteSomething |= Channel->ReplicateSubobject(Script, *Bunch, *RepFlags);
-		}
-	}
+	WroteSomething |= GripScriptReplicationTracker.ReplicateScripts(GripLogicScripts, GripScriptReplication, Channel, Bunch, RepFlags);
 
 	return WroteSomething;
 }
@@ -63,9 +63,16 @@ void UVRButtonComponent::PreReplication(IRepChangedPropertyTracker & ChangedProp
 void UVRButtonComponent::OnRegister()
 {
 	Super::OnRegister();
+	SleepState.Register(this);
 	ResetInitialButtonLocation();
 }
 
+void UVRButtonComponent::OnUnregister()
+{
+	SleepState.Unregister();
+	Super::OnUnregister();
+}
+
 void UVRButtonComponent::BeginPlay()
 {
 	// Call the base class 
@@ -134,7 +141,7 @@ void UVRButtonComponent::TickComponent(float DeltaTime, enum ELevelTick TickType
 		// Std precision tolerance should be fine
 		if (this->RelativeLocation.Equals(GetTargetRelativeLocation()))
 		{
-			this->SetComponentTickEnabled(false);
+			SleepState.Sleep(this);
 
 			OnButtonEndInteraction.Broadcast(LocalLastInteractingActor.Get(), LocalLastInteractingComponent.Get());
 			ReceiveButtonEndInteraction(LocalLastInteractingActor.Get(), LocalLastInteractingComponent.Get());
@@ -289,7 +296,7 @@ void UVRButtonComponent::OnOverlapBegin(UPrimitiveComponent* OverlappedComp, AAc
 		InitialComponentLoc = OriginalBaseTransform.InverseTransformPosition(this->GetComponentLocation());
 		bToggledThisTouch = false;
 
-		this->SetComponentTickEnabled(true);
+		SleepState.Wake(this);
 
 		if (LocalInteractingComponent != LocalLastInteractingComponent.Get())
 		{
@@ -345,7 +352,7 @@ void UVRButtonComponent::SetButtonToRestingPosition(bool bLerpToPosition)
 			this->SetRelativeLocation(InitialRelativeTransform.TransformPosition(SetAxisValue(NewDepth)), false);
 		}
 		else
-			this->SetComponentTickEnabled(true); // This will trigger the lerp to resting position
+			SleepState.Wake(this); // This will trigger the lerp to resting position
 
 	}break;
 	default:break;
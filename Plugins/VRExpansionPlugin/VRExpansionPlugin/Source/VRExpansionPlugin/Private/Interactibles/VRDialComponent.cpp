@@ -76,9 +76,16 @@ void UVRDialComponent::PreReplication(IRepChangedPropertyTracker & ChangedProper
 void UVRDialComponent::OnRegister()
 {
 	Super::OnRegister();
+	SleepState.Register(this);
 	ResetInitialDialLocation(); // Load the original dial location
 }
 
+void UVRDialComponent::OnUnregister()
+{
+	SleepState.Unregister();
+	Super::OnUnregister();
+}
+
 void UVRDialComponent::BeginPlay()
 {
 	// Call the base class 
@@ -100,7 +107,7 @@ void UVRDialComponent::TickComponent(float DeltaTime, enum ELevelTick TickType,
 
 		if (CurRotBackEnd == 0.f)
 		{
-			this->SetComponentTickEnabled(false);
+			SleepState.Sleep(this);
 			bIsLerping = false;
 			OnDialFinishedLerping.Broadcast();
 			ReceiveDialFinishedLerping();
@@ -108,7 +115,7 @@ void UVRDialComponent::TickComponent(float DeltaTime, enum ELevelTick TickType,
 	}
 	else
 	{
-		this->SetComponentTickEnabled(false); 
+		SleepState.Sleep(this);
 	}
 }
 
@@ -182,10 +189,10 @@ void UVRDialComponent::OnGripRelease_Implementation(UGripMotionControllerCompone
 	if (bLerpBackOnRelease)
 	{
 		bIsLerping = true;
-		this->SetComponentTickEnabled(true);
+		SleepState.Wake(this);
 	}
 	else
-		this->SetComponentTickEnabled(false);
+		SleepState.Sleep(this);
 }
 
 void UVRDialComponent::OnChildGrip_Implementation(UGripMotionControllerComponent * GrippingController, const FBPActorGripInformation & GripInformation) {}
@@ -3,4 +3,92 @@
 #include "Engine/Engine.h"
 
 //General Log
-DEFINE_LOG_CATEGORY(VRInteractibleFunctionLibraryLog);
\ No newline at end of file
+DEFINE_LOG_CATEGORY(VRInteractibleFunctionLibraryLog);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Awake Interactibles"), STAT_VRInteractiblesAwake, STATGROUP_VRInteractibles);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Sleeping Interactibles"), STAT_VRInteractiblesSleeping, STATGROUP_VRInteractibles);
+
+int32 FVRInteractibleSleepState::NumAwake = 0;
+int32 FVRInteractibleSleepState::NumSleeping = 0;
+
+void FVRInteractibleSleepState::Register(UActorComponent * Interactible)
+{
+	if (bIsRegistered || !Interactible)
+		return;
+
+	bIsRegistered = true;
+	bIsAwake = Interactible->PrimaryComponentTick.bStartWithTickEnabled || Interactible->IsComponentTickEnabled();
+
+	if (bIsAwake)
+	{
+		++NumAwake;
+		INC_DWORD_STAT(STAT_VRInteractiblesAwake);
+	}
+	else
+	{
+		++NumSleeping;
+		INC_DWORD_STAT(STAT_VRInteractiblesSleeping);
+	}
+}
+
+void FVRInteractibleSleepState::Unregister()
+{
+	if (!bIsRegistered)
+		return;
+
+	if (bIsAwake)
+	{
+		--NumAwake;
+		DEC_DWORD_STAT(STAT_VRInteractiblesAwake);
+	}
+	else
+	{
+		--NumSleeping;
+		DEC_DWORD_STAT(STAT_VRInteractiblesSleeping);
+	}
+
+	bIsRegistered = false;
+}
+
+void FVRInteractibleSleepState::Wake(UActorComponent * Interactible)
+{
+	if (!Interactible)
+		return;
+
+	Interactible->SetComponentTickEnabled(true);
+	SetAwake(true);
+}
+
+void FVRInteractibleSleepState::Sleep(UActorComponent * Interactible)
+{
+	if (!Interactible)
+		return;
+
+	Interactible->SetComponentTickEnabled(false);
+	SetAwake(false);
+}
+
+void FVRInteractibleSleepState::SetAwake(bool bNewAwake)
+{
+	if (bIsAwake == bNewAwake)
+		return;
+
+	bIsAwake = bNewAwake;
+
+	if (!bIsRegistered)
+		return;
+
+	if (bIsAwake)
+	{
+		++NumAwake;
+		--NumSleeping;
+		INC_DWORD_STAT(STAT_VRInteractiblesAwake);
+		DEC_DWORD_STAT(STAT_VRInteractiblesSleeping);
+	}
+	else
+	{
+		--NumAwake;
+		++NumSleeping;
+		DEC_DWORD_STAT(STAT_VRInteractiblesAwake);
+		INC_DWORD_STAT(STAT_VRInteractiblesSleeping);
+	}
+}
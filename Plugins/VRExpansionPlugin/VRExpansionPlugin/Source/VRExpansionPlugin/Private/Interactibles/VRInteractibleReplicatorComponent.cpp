@@ -0,0 +1,441 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Interactibles/VRInteractibleReplicatorComponent.h"
+#include "Interactibles/VRLeverComponent.h"
+#include "Interactibles/VRDialComponent.h"
+#include "Interactibles/VRSliderComponent.h"
+#include "Interactibles/VRButtonComponent.h"
+#include "Net/UnrealNetwork.h"
+#include "GameFramework/Actor.h"
+
+DECLARE_CYCLE_STAT(TEXT("Interactible Replicator ~ Gathering States"), STAT_InteractibleReplicatorGather, STATGROUP_VRInteractibles);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Interactible Replicator ~ Changed States"), STAT_InteractibleReplicatorChanged, STATGROUP_VRInteractibles);
+
+namespace InteractibleReplicator
+{
+	static bool IsHeld(USceneComponent * Interactible)
+	{
+		if (UVRLeverComponent * Lever = Cast<UVRLeverComponent>(Interactible))
+			return Lever->bIsHeld;
+		else if (UVRDialComponent * Dial = Cast<UVRDialComponent>(Interactible))
+			return Dial->bIsHeld;
+		else if (UVRSliderComponent * Slider = Cast<UVRSliderComponent>(Interactible))
+			return Slider->bIsHeld;
+
+		return false;
+	}
+
+	// Dials live between -CClockwiseMaximumDialAngle and ClockwiseMaximumDialAngle, wrapped into 0 - 360 on the back end.
+	// Dials that can go all the way around keep the plain 0 - 360 range.
+	static void GetDialRange(UVRDialComponent * Dial, float & OutMin, float & OutMax)
+	{
+		if (Dial->ClockwiseMaximumDialAngle + Dial->CClockwiseMaximumDialAngle >= 360.0f - KINDA_SMALL_NUMBER)
+		{
+			OutMin = 0.0f;
+			OutMax = 360.0f;
+		}
+		else
+		{
+			OutMin = -Dial->CClockwiseMaximumDialAngle;
+			OutMax = Dial->ClockwiseMaximumDialAngle;
+		}
+	}
+
+	static float GetDialValueInRange(UVRDialComponent * Dial, float MinValue)
+	{
+		return (MinValue < 0.0f && Dial->CurRotBackEnd > Dial->ClockwiseMaximumDialAngle) ? Dial->CurRotBackEnd - 360.0f : Dial->CurRotBackEnd;
+	}
+}
+
+bool FVRInteractibleQuantizedState::NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+{
+	bOutSuccess = true;
+
+	uint32 Index = ComponentIndex;
+	Ar.SerializeIntPacked(Index);
+
+	// 2 bits of value count and 5 bits of (bits per value - 1)
+	uint32 Header = (NumValues & 0x3) | (((BitsPerValue - 1) & 0x1F) << 2);
+	Ar.SerializeBits(&Header, 7);
+
+	if (Ar.IsLoading())
+	{
+		ComponentIndex = (uint16)Index;
+		NumValues = (uint8)FMath::Min<uint32>(Header & 0x3, MaxValues);
+		BitsPerValue = (uint8)(((Header >> 2) & 0x1F) + 1);
+		FMemory::Memzero(Values);
+	}
+
+	for (int32 i = 0; i < NumValues; ++i)
+	{
+		Ar.SerializeBits(&Values[i], BitsPerValue);
+	}
+
+	return true;
+}
+
+void FVRInteractibleStateItem::PostReplicatedAdd(const FVRInteractibleStateArray & InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+		InArraySerializer.Owner->ApplyState(State, true);
+}
+
+void FVRInteractibleStateItem::PostReplicatedChange(const FVRInteractibleStateArray & InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+		InArraySerializer.Owner->ApplyState(State, false);
+}
+
+UVRInteractibleReplicatorComponent::UVRInteractibleReplicatorComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	PrimaryComponentTick.bCanEverTick = false;
+	this->SetIsReplicated(true);
+
+	DefaultStepCount = 1023;
+	bTakeOverComponentReplication = true;
+	ReplicatedStates.Owner = this;
+}
+
+void UVRInteractibleReplicatorComponent::GetLifetimeReplicatedProps(TArray< class FLifetimeProperty > & OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(UVRInteractibleReplicatorComponent, ReplicatedStates);
+}
+
+void UVRInteractibleReplicatorComponent::BeginPlay()
+{
+	Super::BeginPlay();
+	ReplicatedStates.Owner = this;
+	RefreshInteractibles();
+}
+
+void UVRInteractibleReplicatorComponent::RefreshInteractibles()
+{
+	Interactibles.Reset();
+
+	AActor * OwningActor = GetOwner();
+	if (!OwningActor)
+		return;
+
+	TInlineComponentArray<USceneComponent*> SceneComponents;
+	OwningActor->GetComponents(SceneComponents);
+
+	for (USceneComponent * SceneComponent : SceneComponents)
+	{
+		if (!SceneComponent || !SceneComponent->IsNameStableForNetworking())
+			continue;
+
+		if (SceneComponent->IsA<UVRLeverComponent>() || SceneComponent->IsA<UVRDialComponent>() ||
+			SceneComponent->IsA<UVRSliderComponent>() || SceneComponent->IsA<UVRButtonComponent>())
+		{
+			Interactibles.Add(SceneComponent);
+		}
+	}
+
+	// Component order isn't guaranteed to match between the server and clients, their names are
+	Interactibles.Sort([](const TWeakObjectPtr<USceneComponent> & A, const TWeakObjectPtr<USceneComponent> & B)
+	{
+		return A->GetName() < B->GetName();
+	});
+
+	if (GetOwnerRole() == ROLE_Authority)
+	{
+		if (bTakeOverComponentReplication)
+		{
+			for (TWeakObjectPtr<USceneComponent> & Interactible : Interactibles)
+			{
+				if (UVRLeverComponent * Lever = Cast<UVRLeverComponent>(Interactible.Get()))
+				{
+					Lever->bReplicateMovement = Lever->bOriginalReplicatesMovement = false;
+					if (!Lever->bRepGameplayTags)
+						Lever->SetIsReplicated(false);
+				}
+				else if (UVRDialComponent * Dial = Cast<UVRDialComponent>(Interactible.Get()))
+				{
+					Dial->bReplicateMovement = Dial->bOriginalReplicatesMovement = false;
+					if (!Dial->bRepGameplayTags)
+						Dial->SetIsReplicated(false);
+				}
+				else if (UVRSliderComponent * Slider = Cast<UVRSliderComponent>(Interactible.Get()))
+				{
+					Slider->bReplicateMovement = Slider->bOriginalReplicatesMovement = false;
+					if (!Slider->bRepGameplayTags)
+						Slider->SetIsReplicated(false);
+				}
+				else if (UVRButtonComponent * Button = Cast<UVRButtonComponent>(Interactible.Get()))
+				{
+					// Buttons stay replicated, their authority type and initial transform aren't carried here
+					Button->bReplicateMovement = false;
+				}
+			}
+		}
+
+		UpdateReplicatedStates(true);
+	}
+	else
+	{
+		// Anything that came in before we could match it up
+		for (const FVRInteractibleStateItem & Item : ReplicatedStates.Items)
+		{
+			ApplyState(Item.State, true);
+		}
+	}
+}
+
+void UVRInteractibleReplicatorComponent::PreReplication(IRepChangedPropertyTracker & ChangedPropertyTracker)
+{
+	Super::PreReplication(ChangedPropertyTracker);
+
+	// Once per replication pass rather than once per connection
+	UpdateReplicatedStates(false);
+}
+
+void UVRInteractibleReplicatorComponent::UpdateReplicatedStates(bool bForceAll)
+{
+	SCOPE_CYCLE_COUNTER(STAT_InteractibleReplicatorGather);
+
+	if (bForceAll)
+	{
+		ReplicatedStates.Items.Reset(Interactibles.Num());
+		ReplicatedStates.MarkArrayDirty();
+	}
+
+	for (int32 i = 0; i < Interactibles.Num(); ++i)
+	{
+		// Everyone drives held interactibles locally, the state they end up in goes out on release
+		if (!bForceAll && InteractibleReplicator::IsHeld(Interactibles[i].Get()))
+			continue;
+
+		FVRInteractibleQuantizedState NewState;
+		if (!QuantizeInteractible(Interactibles[i].Get(), NewState))
+			continue;
+
+		NewState.ComponentIndex = (uint16)i;
+
+		if (bForceAll)
+		{
+			FVRInteractibleStateItem & NewItem = ReplicatedStates.Items.AddDefaulted_GetRef();
+			NewItem.State = NewState;
+			ReplicatedStates.MarkItemDirty(NewItem);
+			continue;
+		}
+
+		// Items are added in interactible order, only fall back to searching if one was skipped
+		FVRInteractibleStateItem * Item = nullptr;
+		if (ReplicatedStates.Items.IsValidIndex(i) && ReplicatedStates.Items[i].State.ComponentIndex == i)
+		{
+			Item = &ReplicatedStates.Items[i];
+		}
+		else
+		{
+			Item = ReplicatedStates.Items.FindByPredicate([i](const FVRInteractibleStateItem & Entry)
+			{
+				return Entry.State.ComponentIndex == i;
+			});
+		}
+
+		if (Item && Item->State != NewState)
+		{
+			Item->State = NewState;
+			ReplicatedStates.MarkItemDirty(*Item);
+			INC_DWORD_STAT(STAT_InteractibleReplicatorChanged);
+		}
+	}
+}
+
+uint32 UVRInteractibleReplicatorComponent::GetStepCount(USceneComponent * Interactible) const
+{
+	// When an interactible always snaps its snap increment is the only precision that matters
+	if (UVRDialComponent * Dial = Cast<UVRDialComponent>(Interactible))
+	{
+		if (Dial->bDialUsesAngleSnap && Dial->SnapAngleIncrement > 0.0f && Dial->SnapAngleThreshold >= Dial->SnapAngleIncrement)
+		{
+			float MinAngle, MaxAngle;
+			InteractibleReplicator::GetDialRange(Dial, MinAngle, MaxAngle);
+
+			// The snap grid starts at 0, so the low end has to sit on it as well
+			int32 Steps = FMath::RoundToInt((MaxAngle - MinAngle) / Dial->SnapAngleIncrement);
+			int32 LowSteps = FMath::RoundToInt(MinAngle / Dial->SnapAngleIncrement);
+			if (FMath::IsNearlyEqual(Steps * Dial->SnapAngleIncrement, MaxAngle - MinAngle, KINDA_SMALL_NUMBER * 100.0f) &&
+				FMath::IsNearlyEqual(LowSteps * Dial->SnapAngleIncrement, MinAngle, KINDA_SMALL_NUMBER * 100.0f))
+				return (uint32)FMath::Max(Steps, 1);
+		}
+	}
+	else if (UVRSliderComponent * Slider = Cast<UVRSliderComponent>(Interactible))
+	{
+		if (Slider->bSliderUsesSnapPoints && Slider->SnapIncrement > 0.0f && Slider->SnapThreshold >= Slider->SnapIncrement)
+		{
+			int32 Steps = FMath::RoundToInt(1.0f / Slider->SnapIncrement);
+			if (FMath::IsNearlyEqual(Steps * Slider->SnapIncrement, 1.0f, KINDA_SMALL_NUMBER))
+				return (uint32)Steps;
+		}
+	}
+
+	return (uint32)FMath::Clamp(DefaultStepCount, 1, 65535);
+}
+
+bool UVRInteractibleReplicatorComponent::QuantizeInteractible(USceneComponent * Interactible, FVRInteractibleQuantizedState & OutState) const
+{
+	if (!Interactible)
+		return false;
+
+	if (UVRButtonComponent * Button = Cast<UVRButtonComponent>(Interactible))
+	{
+		OutState.NumValues = 1;
+		OutState.BitsPerValue = 1;
+		OutState.Values[0] = Button->bButtonState ? 1 : 0;
+		return true;
+	}
+
+	const uint32 Steps = GetStepCount(Interactible);
+	OutState.BitsPerValue = (uint8)GetBitsForSteps(Steps);
+
+	if (UVRLeverComponent * Lever = Cast<UVRLeverComponent>(Interactible))
+	{
+		switch (Lever->LeverRotationAxis)
+		{
+		case EVRInteractibleLeverAxis::Axis_XY:
+		case EVRInteractibleLeverAxis::FlightStick_XY:
+		{
+			// Dual axis levers are sent as the pitch / roll of their rotation from the initial transform, plus the yaw for flight sticks
+			FTransform CurRelativeTransform = Lever->GetComponentTransform().GetRelativeTransform(UVRInteractibleFunctionLibrary::Interactible_GetCurrentParentTransform(Lever));
+			FRotator DeltaRot = CurRelativeTransform.GetRelativeTransform(Lever->InitialRelativeTransform).Rotator();
+			float Limit = FMath::Max(Lever->LeverLimitPositive, 1.0f);
+
+			OutState.NumValues = Lever->LeverRotationAxis == EVRInteractibleLeverAxis::FlightStick_XY ? 3 : 2;
+			OutState.Values[0] = QuantizeValue(DeltaRot.Pitch, -Limit, Limit, Steps);
+			OutState.Values[1] = QuantizeValue(DeltaRot.Roll, -Limit, Limit, Steps);
+			OutState.Values[2] = QuantizeValue(DeltaRot.Yaw, -180.0f, 180.0f, Steps);
+		}break;
+		default:
+		{
+			OutState.NumValues = 1;
+			OutState.Values[0] = QuantizeValue(Lever->FullCurrentAngle, -Lever->LeverLimitNegative, Lever->LeverLimitPositive, Steps);
+		}break;
+		}
+
+		return true;
+	}
+	else if (UVRDialComponent * Dial = Cast<UVRDialComponent>(Interactible))
+	{
+		float MinAngle, MaxAngle;
+		InteractibleReplicator::GetDialRange(Dial, MinAngle, MaxAngle);
+
+		OutState.NumValues = 1;
+		OutState.Values[0] = QuantizeValue(InteractibleReplicator::GetDialValueInRange(Dial, MinAngle), MinAngle, MaxAngle, Steps);
+		return true;
+	}
+	else if (UVRSliderComponent * Slider = Cast<UVRSliderComponent>(Interactible))
+	{
+		OutState.NumValues = 1;
+		OutState.Values[0] = QuantizeValue(Slider->CurrentSliderProgress, 0.0f, 1.0f, Steps);
+		return true;
+	}
+
+	return false;
+}
+
+void UVRInteractibleReplicatorComponent::ApplyState(const FVRInteractibleQuantizedState & State, bool bIsInitial)
+{
+	// BeginPlay applies everything once the interactibles are gathered
+	if (!HasBegunPlay() || GetOwnerRole() == ROLE_Authority || !Interactibles.IsValidIndex(State.ComponentIndex))
+		return;
+
+	USceneComponent * Interactible = Interactibles[State.ComponentIndex].Get();
+	if (!Interactible || State.NumValues < 1)
+		return;
+
+	if (UVRButtonComponent * Button = Cast<UVRButtonComponent>(Interactible))
+	{
+		// Other authority types change state locally, matching the initial only replication of the button itself
+		if (bIsInitial || Button->StateChangeAuthorityType == EVRStateChangeAuthorityType::CanChangeState_Server)
+			Button->SetButtonState(State.Values[0] != 0, !bIsInitial, bIsInitial);
+
+		return;
+	}
+
+	const uint32 Steps = GetStepCount(Interactible);
+
+	// Mismatched configuration, better to drop it than to land somewhere random
+	if (State.BitsPerValue != GetBitsForSteps(Steps))
+		return;
+
+	if (UVRLeverComponent * Lever = Cast<UVRLeverComponent>(Interactible))
+	{
+		// Held ones are driven locally, same as when the lever turns off its movement replication
+		if (Lever->bIsHeld)
+			return;
+
+		FQuat DeltaQuat;
+		switch (Lever->LeverRotationAxis)
+		{
+		case EVRInteractibleLeverAxis::Axis_XY:
+		case EVRInteractibleLeverAxis::FlightStick_XY:
+		{
+			float Limit = FMath::Max(Lever->LeverLimitPositive, 1.0f);
+			FRotator DeltaRot(
+				DequantizeValue(State.Values[0], -Limit, Limit, Steps),
+				State.NumValues > 2 ? DequantizeValue(State.Values[2], -180.0f, 180.0f, Steps) : 0.0f,
+				State.NumValues > 1 ? DequantizeValue(State.Values[1], -Limit, Limit, Steps) : 0.0f
+			);
+			DeltaQuat = DeltaRot.Quaternion();
+		}break;
+		default:
+		{
+			// Inverse of GetDeltaAngle, the X and Y axis' are measured with the opposite sign
+			float Angle = DequantizeValue(State.Values[0], -Lever->LeverLimitNegative, Lever->LeverLimitPositive, Steps);
+			FVector Axis = UVRInteractibleFunctionLibrary::SetAxisValueVec((EVRInteractibleAxis)Lever->LeverRotationAxis, 1.0f);
+			DeltaQuat = FQuat(Axis, FMath::DegreesToRadians(Lever->LeverRotationAxis == EVRInteractibleLeverAxis::Axis_Z ? Angle : -Angle));
+		}break;
+		}
+
+		Lever->SetRelativeRotation((FTransform(DeltaQuat) * Lever->InitialRelativeTransform).GetRotation());
+		Lever->ReCalculateCurrentAngle();
+
+		if (!Lever->SleepState.IsAwake())
+			Lever->SleepState.Wake(Lever);
+	}
+	else if (UVRDialComponent * Dial = Cast<UVRDialComponent>(Interactible))
+	{
+		if (Dial->bIsHeld)
+			return;
+
+		float MinAngle, MaxAngle;
+		InteractibleReplicator::GetDialRange(Dial, MinAngle, MaxAngle);
+
+		const float Angle = DequantizeValue(State.Values[0], MinAngle, MaxAngle, Steps);
+		Dial->SetDialAngle(Angle < 0.0f ? Angle + 360.0f : Angle);
+	}
+	else if (UVRSliderComponent * Slider = Cast<UVRSliderComponent>(Interactible))
+	{
+		if (Slider->bIsHeld)
+			return;
+
+		Slider->SetSliderProgress(DequantizeValue(State.Values[0], 0.0f, 1.0f, Steps));
+	}
+}
+
+uint32 UVRInteractibleReplicatorComponent::GetBitsForSteps(uint32 Steps)
+{
+	// Steps + 1 values, both ends of the range are representable
+	return FMath::Clamp<uint32>(FMath::CeilLogTwo(Steps + 1), 1, 32);
+}
+
+uint32 UVRInteractibleReplicatorComponent::QuantizeValue(float Value, float MinValue, float MaxValue, uint32 Steps)
+{
+	if (MaxValue <= MinValue || Steps == 0)
+		return 0;
+
+	float Alpha = FMath::Clamp((Value - MinValue) / (MaxValue - MinValue), 0.0f, 1.0f);
+	return (uint32)FMath::RoundToInt(Alpha * Steps);
+}
+
+float UVRInteractibleReplicatorComponent::DequantizeValue(uint32 Quantized, float MinValue, float MaxValue, uint32 Steps)
+{
+	if (MaxValue <= MinValue || Steps == 0)
+		return MinValue;
+
+	return MinValue + (MaxValue - MinValue) * ((float)FMath::Min(Quantized, Steps) / (float)Steps);
+}
@@ -105,6 +105,7 @@ void UVRLeverComponent::PreReplication(IRepChangedPropertyTracker & ChangedPrope
 void UVRLeverComponent::OnRegister()
 {
 	Super::OnRegister();
+	SleepState.Register(this);
 	ResetInitialLeverLocation(); // Load the original lever location
 }
 
@@ -144,7 +145,7 @@ void UVRLeverComponent::TickComponent(float DeltaTime, enum ELevelTick TickType,
 
 			if (LerpedQuat.IsIdentity())
 			{
-				this->SetComponentTickEnabled(false);
+				SleepState.Sleep(this);
 				bIsLerping = false;
 				bReplicateMovement = bOriginalReplicatesMovement;
 				this->SetRelativeRotation(InitialRelativeTransform.Rotator());
@@ -203,11 +204,25 @@ void UVRLeverComponent::TickComponent(float DeltaTime, enum ELevelTick TickType,
 		OnLeverFinishedLerping.Broadcast(CurrentLeverAngle);
 		ReceiveLeverFinishedLerping(CurrentLeverAngle);
 	}
+
+	// Settled, nothing left to track until we are gripped or get a replicated update
+	if (!bIsLerping && !bIsHeld)
+		SleepState.Sleep(this);
+}
+
+void UVRLeverComponent::PostRepNotifies()
+{
+	Super::PostRepNotifies();
+
+	// Wake up for a tick to refresh the angle and lever state from the replicated rotation
+	if (bReplicateMovement && !bIsHeld && !SleepState.IsAwake())
+		SleepState.Wake(this);
 }
 
 void UVRLeverComponent::OnUnregister()
 {
 	DestroyConstraint();
+	SleepState.Unregister();
 	Super::OnUnregister();
 }
 
@@ -369,7 +384,7 @@ void UVRLeverComponent::OnGrip_Implementation(UGripMotionControllerComponent * G
 	bIsInFirstTick = true;
 	MomentumAtDrop = 0.0f;
 
-	this->SetComponentTickEnabled(true);
+	SleepState.Wake(this);
 }
 
 void UVRLeverComponent::OnGripRelease_Implementation(UGripMotionControllerComponent * ReleasingController, const FBPActorGripInformation & GripInformation, bool bWasSocketed) 
@@ -384,13 +399,13 @@ void UVRLeverComponent::OnGripRelease_Implementation(UGripMotionControllerCompon
 	if (LeverReturnTypeWhenReleased != EVRInteractibleLeverReturnType::Stay)
 	{		
 		bIsLerping = true;
-		this->SetComponentTickEnabled(true);
+		SleepState.Wake(this);
 		if (MovementReplicationSetting != EGripMovementReplicationSettings::ForceServerSideMovement)
 			bReplicateMovement = false;
 	}
 	else
 	{
-		this->SetComponentTickEnabled(false);
+		SleepState.Sleep(this);
 		bReplicateMovement = bOriginalReplicatesMovement;
 	}
 }
@@ -820,7 +835,7 @@ void UVRLeverComponent::LerpAxis(float CurrentAngle, float DeltaTime)
 		if (FMath::IsNearlyZero(MomentumAtDrop * DeltaTime, 0.1f))
 		{
 			MomentumAtDrop = 0.0f;
-			this->SetComponentTickEnabled(false);
+			SleepState.Sleep(this);
 			bIsLerping = false;
 			bReplicateMovement = bOriginalReplicatesMovement;
 			return;
@@ -856,7 +871,7 @@ void UVRLeverComponent::LerpAxis(float CurrentAngle, float DeltaTime)
 		}
 		else
 		{
-			this->SetComponentTickEnabled(false);
+			SleepState.Sleep(this);
 			bIsLerping = false;
 			bReplicateMovement = bOriginalReplicatesMovement;
 			FTransform CalcTransform = (FTransform(UVRInteractibleFunctionLibrary::SetAxisValueRot((EVRInteractibleAxis)LeverRotationAxis, TargetAngle, FRotator::ZeroRotator)) * InitialRelativeTransform);
@@ -70,6 +70,7 @@ void UVRMountComponent::PreReplication(IRepChangedPropertyTracker & ChangedPrope
 void UVRMountComponent::OnRegister()
 {
 	Super::OnRegister();
+	SleepState.Register(this);
 	ResetInitialMountLocation(); // Load the original mount location
 }
 
@@ -88,6 +89,7 @@ void UVRMountComponent::TickComponent(float DeltaTime, enum ELevelTick TickType,
 
 void UVRMountComponent::OnUnregister()
 {
+	SleepState.Unregister();
 	Super::OnUnregister();
 }
 
@@ -408,12 +410,12 @@ void UVRMountComponent::OnGrip_Implementation(UGripMotionControllerComponent * G
 		
 
 
-	this->SetComponentTickEnabled(true);
+	SleepState.Wake(this);
 }
 
 void UVRMountComponent::OnGripRelease_Implementation(UGripMotionControllerComponent * ReleasingController, const FBPActorGripInformation & GripInformation, bool bWasSocketed)
 {
-		this->SetComponentTickEnabled(false);
+		SleepState.Sleep(this);
 }
 
 void UVRMountComponent::OnChildGrip_Implementation(UGripMotionControllerComponent * GrippingController, const FBPActorGripInformation & GripInformation) {}
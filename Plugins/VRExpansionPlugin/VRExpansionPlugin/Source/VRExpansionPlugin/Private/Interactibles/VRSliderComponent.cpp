@@ -2,6 +2,222 @@
 
 #include "Interactibles/VRSliderComponent.h"
 #include "Net/UnrealNetwork.h"
+#include "Algo/BinarySearch.h"
+
+namespace VRSliderSplineLookup
+{
+	// Upper limit on the samples of a single lookup table, spacing is increased to fit long splines into it
+	static const int32 MaxSamples = 8192;
+
+	// Segments per leaf of the segment hierarchy
+	static const int32 LeafSegments = 4;
+
+	// Newton iterations on the spline curve after the closest sampled segment is found
+	static const int32 RefinementIterations = 2;
+}
+
+bool FVRSliderSplineLookup::IsValidFor(const USplineComponent * Spline, float DesiredSampleSpacing) const
+{
+	return Spline != nullptr &&
+		SourceSpline.Get() == Spline &&
+		SampleSpacing == DesiredSampleSpacing &&
+		SplineVersion == Spline->SplineCurves.Version &&
+		NumSplinePoints == Spline->SplineCurves.Position.Points.Num() &&
+		bClosedLoop == Spline->IsClosedLoop() &&
+		SplineLength == Spline->GetSplineLength();
+}
+
+void FVRSliderSplineLookup::Reset()
+{
+	SampleLocations.Reset();
+	SampleKeys.Reset();
+	Nodes.Reset();
+	SourceSpline.Reset();
+	SplineLength = 0.0f;
+	SampleSpacing = 0.0f;
+	SplineVersion = 0;
+	NumSplinePoints = 0;
+	bClosedLoop = false;
+}
+
+void FVRSliderSplineLookup::Build(const USplineComponent * Spline, float DesiredSampleSpacing)
+{
+	Reset();
+
+	if (!Spline || DesiredSampleSpacing <= 0.0f)
+		return;
+
+	const FSplineCurves & SplineCurves = Spline->SplineCurves;
+
+	// Stored even if we can't sample the spline so that we don't try to rebuild every frame
+	SourceSpline = Spline;
+	SampleSpacing = DesiredSampleSpacing;
+	SplineVersion = SplineCurves.Version;
+	NumSplinePoints = SplineCurves.Position.Points.Num();
+	bClosedLoop = Spline->IsClosedLoop();
+	SplineLength = Spline->GetSplineLength();
+
+	if (NumSplinePoints < 2 || SplineLength <= KINDA_SMALL_NUMBER)
+		return;
+
+	const int32 NumSamples = FMath::Clamp(FMath::CeilToInt(SplineLength / DesiredSampleSpacing) + 1, 2, VRSliderSplineLookup::MaxSamples);
+
+	SampleLocations.SetNumUninitialized(NumSamples);
+	SampleKeys.SetNumUninitialized(NumSamples);
+
+	for (int32 i = 0; i < NumSamples; ++i)
+	{
+		const float Distance = SplineLength * ((float)i / (float)(NumSamples - 1));
+		SampleKeys[i] = SplineCurves.ReparamTable.Eval(Distance, 0.0f);
+		SampleLocations[i] = SplineCurves.Position.Eval(SampleKeys[i], FVector::ZeroVector);
+	}
+
+	const int32 NumSegments = NumSamples - 1;
+	Nodes.Reserve(2 * FMath::DivideAndRoundUp(NumSegments, VRSliderSplineLookup::LeafSegments));
+	Nodes.AddDefaulted();
+	BuildNode(0, 0, NumSegments);
+}
+
+void FVRSliderSplineLookup::BuildNode(int32 NodeIndex, int32 FirstSegment, int32 NumSegments)
+{
+	// Segments are ordered along the spline so halving the range keeps neighboring segments together
+	Nodes[NodeIndex].FirstSegment = FirstSegment;
+	Nodes[NodeIndex].NumSegments = NumSegments;
+
+	if (NumSegments <= VRSliderSplineLookup::LeafSegments)
+	{
+		Nodes[NodeIndex].ChildIndex = INDEX_NONE;
+		Nodes[NodeIndex].Bounds = FBox(&SampleLocations[FirstSegment], NumSegments + 1);
+		return;
+	}
+
+	const int32 ChildIndex = Nodes.AddDefaulted(2);
+	const int32 NumLeftSegments = NumSegments / 2;
+
+	BuildNode(ChildIndex, FirstSegment, NumLeftSegments);
+	BuildNode(ChildIndex + 1, FirstSegment + NumLeftSegments, NumSegments - NumLeftSegments);
+
+	Nodes[NodeIndex].ChildIndex = ChildIndex;
+	Nodes[NodeIndex].Bounds = Nodes[ChildIndex].Bounds + Nodes[ChildIndex + 1].Bounds;
+}
+
+void FVRSliderSplineLookup::TestSegment(int32 SegmentIndex, const FVector & LocalLocation, float & BestDistSq, int32 & BestSegment, float & BestAlpha) const
+{
+	const FVector & SegmentStart = SampleLocations[SegmentIndex];
+	const FVector Segment = SampleLocations[SegmentIndex + 1] - SegmentStart;
+	const float SegmentLengthSq = Segment.SizeSquared();
+
+	const float Alpha = SegmentLengthSq > SMALL_NUMBER ? FMath::Clamp(FVector::DotProduct(LocalLocation - SegmentStart, Segment) / SegmentLengthSq, 0.0f, 1.0f) : 0.0f;
+	const float DistSq = FVector::DistSquared(LocalLocation, SegmentStart + (Segment * Alpha));
+
+	if (DistSq < BestDistSq)
+	{
+		BestDistSq = DistSq;
+		BestSegment = SegmentIndex;
+		BestAlpha = Alpha;
+	}
+}
+
+int32 FVRSliderSplineLookup::FindSegmentForKey(float InputKey) const
+{
+	// Keys increase along the spline
+	return FMath::Clamp(Algo::UpperBound(SampleKeys, InputKey) - 1, 0, SampleKeys.Num() - 2);
+}
+
+float FVRSliderSplineLookup::FindInputKeyClosestToLocalLocation(const FVector & LocalLocation, float HintKey) const
+{
+	if (!HasSamples())
+		return 0.0f;
+
+	const int32 NumSegments = SampleKeys.Num() - 1;
+
+	float BestDistSq = BIG_NUMBER;
+	int32 BestSegment = 0;
+	float BestAlpha = 0.0f;
+
+	// The slider rarely moves far in a frame, seeding with the segments around the last key gives a
+	// tight bound up front so that the hierarchy walk can skip nearly everything else
+	if (HintKey >= 0.0f)
+	{
+		const int32 HintSegment = FindSegmentForKey(HintKey);
+		const int32 LastSegment = FMath::Min(NumSegments - 1, HintSegment + 1);
+
+		for (int32 i = FMath::Max(0, HintSegment - 1); i <= LastSegment; ++i)
+		{
+			TestSegment(i, LocalLocation, BestDistSq, BestSegment, BestAlpha);
+		}
+	}
+
+	TArray<int32, TInlineAllocator<64>> NodeStack;
+	NodeStack.Add(0);
+
+	while (NodeStack.Num() > 0)
+	{
+		const FBVHNode & Node = Nodes[NodeStack.Pop(false)];
+
+		if (Node.Bounds.ComputeSquaredDistanceToPoint(LocalLocation) >= BestDistSq)
+			continue;
+
+		if (Node.ChildIndex == INDEX_NONE)
+		{
+			const int32 EndSegment = Node.FirstSegment + Node.NumSegments;
+			for (int32 i = Node.FirstSegment; i < EndSegment; ++i)
+			{
+				TestSegment(i, LocalLocation, BestDistSq, BestSegment, BestAlpha);
+			}
+		}
+		else
+		{
+			// Visit the closer child first so that it tightens the bound for the other one
+			if (Nodes[Node.ChildIndex].Bounds.ComputeSquaredDistanceToPoint(LocalLocation) <= Nodes[Node.ChildIndex + 1].Bounds.ComputeSquaredDistanceToPoint(LocalLocation))
+			{
+				NodeStack.Add(Node.ChildIndex + 1);
+				NodeStack.Add(Node.ChildIndex);
+			}
+			else
+			{
+				NodeStack.Add(Node.ChildIndex);
+				NodeStack.Add(Node.ChildIndex + 1);
+			}
+		}
+	}
+
+	const float MinKey = SampleKeys[BestSegment];
+	const float MaxKey = SampleKeys[BestSegment + 1];
+	float ClosestKey = FMath::Lerp(MinKey, MaxKey, BestAlpha);
+
+	// The samples are a polyline approximation, a few newton steps on the curve itself remove the chord error
+	if (const USplineComponent * Spline = SourceSpline.Get())
+	{
+		const FInterpCurveVector & Position = Spline->SplineCurves.Position;
+
+		for (int32 Iteration = 0; Iteration < VRSliderSplineLookup::RefinementIterations; ++Iteration)
+		{
+			const FVector Delta = Position.Eval(ClosestKey, FVector::ZeroVector) - LocalLocation;
+			const FVector Tangent = Position.EvalDerivative(ClosestKey, FVector::ZeroVector);
+			const FVector Curvature = Position.EvalSecondDerivative(ClosestKey, FVector::ZeroVector);
+
+			const float Denominator = FVector::DotProduct(Curvature, Delta) + Tangent.SizeSquared();
+			if (FMath::Abs(Denominator) < KINDA_SMALL_NUMBER)
+				break;
+
+			ClosestKey = FMath::Clamp(ClosestKey - (FVector::DotProduct(Tangent, Delta) / Denominator), MinKey, MaxKey);
+		}
+	}
+
+	return ClosestKey;
+}
+
+float FVRSliderSplineLookup::GetInputKeyAtDistance(float Distance) const
+{
+	if (!HasSamples())
+		return 0.0f;
+
+	const float SamplePosition = FMath::Clamp(Distance / SplineLength, 0.0f, 1.0f) * (float)(SampleKeys.Num() - 1);
+	const int32 SampleIndex = FMath::Min(FMath::FloorToInt(SamplePosition), SampleKeys.Num() - 2);
+
+	return FMath::Lerp(SampleKeys[SampleIndex], SampleKeys[SampleIndex + 1], SamplePosition - (float)SampleIndex);
+}
 
   //=============================================================================
 UVRSliderComponent::UVRSliderComponent(const FObjectInitializer& ObjectInitializer)
@@ -43,6 +259,7 @@ UVRSliderComponent::UVRSliderComponent(const FObjectInitializer& ObjectInitializ
 	bFollowSplineRotationAndScale = false;
 	SplineLerpType = EVRInteractibleSliderLerpType::Lerp_None;
 	SplineLerpValue = 8.f;
+	SplineLookupSampleSpacing = 10.0f;
 
 	GripPriority = 1;
 	LastSliderProgressState = -1.0f;
@@ -96,6 +313,7 @@ void UVRSliderComponent::PreReplication(IRepChangedPropertyTracker & ChangedProp
 void UVRSliderComponent::OnRegister()
 {
 	Super::OnRegister();
+	SleepState.Register(this);
 
 	// Init the slider settings
 	if (USplineComponent * ParentSpline = Cast<USplineComponent>(GetAttachParent()))
@@ -108,6 +326,12 @@ void UVRSliderComponent::OnRegister()
 	}
 }
 
+void UVRSliderComponent::OnUnregister()
+{
+	SleepState.Unregister();
+	Super::OnUnregister();
+}
+
 void UVRSliderComponent::BeginPlay()
 {
 	// Call the base class 
@@ -175,13 +399,17 @@ void UVRSliderComponent::TickComponent(float DeltaTime, enum ELevelTick TickType
 			OnSliderFinishedLerping.Broadcast(CurrentSliderProgress);
 			ReceiveSliderFinishedLerping(CurrentSliderProgress);
 
-			this->SetComponentTickEnabled(false);
+			SleepState.Sleep(this);
 			bReplicateMovement = bOriginalReplicatesMovement;
 		}
 		
 		// Check for the hit point always
 		CheckSliderProgress();
 	}
+	else
+	{
+		SleepState.Sleep(this);
+	}
 }
 
 void UVRSliderComponent::TickGrip_Implementation(UGripMotionControllerComponent * GrippingController, const FBPActorGripInformation & GripInformation, float DeltaTime) 
@@ -197,7 +425,7 @@ void UVRSliderComponent::TickGrip_Implementation(UGripMotionControllerComponent
 	if (SplineComponentToFollow != nullptr)
 	{
 		FVector WorldCalculatedLocation = CurrentRelativeTransform.TransformPosition(CalculatedLocation);
-		float ClosestKey = SplineComponentToFollow->FindInputKeyClosestToWorldLocation(WorldCalculatedLocation);
+		float ClosestKey = FindSplineInputKeyClosestToWorldLocation(WorldCalculatedLocation, LastInputKey);
 
 		if (bSliderUsesSnapPoints)
 		{
@@ -210,7 +438,7 @@ void UVRSliderComponent::TickGrip_Implementation(UGripMotionControllerComponent
 
 			if (SplineComponentToFollow->SplineCurves.Position.Points.Num() > 1)
 			{
-				ClosestKey = SplineComponentToFollow->SplineCurves.ReparamTable.Eval(SplineProgress * SplineLength, 0.0f);
+				ClosestKey = GetSplineInputKeyAtDistance(SplineProgress * SplineLength);
 			}
 
 			WorldCalculatedLocation = SplineComponentToFollow->GetLocationAtSplineInputKey(ClosestKey, ESplineCoordinateSpace::World);
@@ -242,7 +470,8 @@ void UVRSliderComponent::TickGrip_Implementation(UGripMotionControllerComponent
 			}
 			else if (bLerpToNewKey)
 			{
-				trans = SplineComponentToFollow->FindTransformClosestToWorldLocation(WorldCalculatedLocation, ESplineCoordinateSpace::World, true);
+				// ClosestKey is already the closest key to the calculated location, no need to search again
+				trans = SplineComponentToFollow->GetTransformAtSplineInputKey(ClosestKey, ESplineCoordinateSpace::World, true);
 				bChangedLocation = true;
 			}
 
@@ -264,7 +493,7 @@ void UVRSliderComponent::TickGrip_Implementation(UGripMotionControllerComponent
 			}
 			else if (bLerpToNewKey)
 			{
-				WorldLocation = SplineComponentToFollow->FindLocationClosestToWorldLocation(WorldCalculatedLocation, ESplineCoordinateSpace::World);
+				WorldLocation = SplineComponentToFollow->GetLocationAtSplineInputKey(ClosestKey, ESplineCoordinateSpace::World);
 				bChangedLocation = true;
 			}
 
@@ -373,14 +602,14 @@ void UVRSliderComponent::OnGripRelease_Implementation(UGripMotionControllerCompo
 	if (SliderBehaviorWhenReleased != EVRInteractibleSliderDropBehavior::Stay)
 	{
 		bIsLerping = true;
-		this->SetComponentTickEnabled(true);
+		SleepState.Wake(this);
 
 		if(MovementReplicationSetting != EGripMovementReplicationSettings::ForceServerSideMovement)
 			bReplicateMovement = false;
 	}
 	else
 	{
-		this->SetComponentTickEnabled(false);
+		SleepState.Sleep(this);
 		bReplicateMovement = bOriginalReplicatesMovement;
 	}
 }
@@ -571,7 +800,7 @@ float UVRSliderComponent::GetCurrentSliderProgress(FVector CurLocation, bool bUs
 		float ClosestKey = CurKey;
 
 		if (!bUseKeyInstead)
-			ClosestKey = SplineComponentToFollow->FindInputKeyClosestToWorldLocation(CurLocation);
+			ClosestKey = FindSplineInputKeyClosestToWorldLocation(CurLocation);
 
 		int32 primaryKey = FMath::TruncToInt(ClosestKey);
 
@@ -603,6 +832,39 @@ void UVRSliderComponent::GetLerpedKey(float &ClosestKey, float DeltaTime)
 	}
 }
 
+bool UVRSliderComponent::UpdateSplineLookup()
+{
+	if (SplineComponentToFollow == nullptr || SplineLookupSampleSpacing <= 0.0f)
+	{
+		if (SplineLookup.HasSamples())
+			SplineLookup.Reset();
+
+		return false;
+	}
+
+	if (!SplineLookup.IsValidFor(SplineComponentToFollow, SplineLookupSampleSpacing))
+		SplineLookup.Build(SplineComponentToFollow, SplineLookupSampleSpacing);
+
+	return SplineLookup.HasSamples();
+}
+
+float UVRSliderComponent::FindSplineInputKeyClosestToWorldLocation(const FVector & WorldLocation, float HintKey)
+{
+	if (!UpdateSplineLookup())
+		return SplineComponentToFollow->FindInputKeyClosestToWorldLocation(WorldLocation);
+
+	const FVector LocalLocation = SplineComponentToFollow->GetComponentTransform().InverseTransformPosition(WorldLocation);
+	return SplineLookup.FindInputKeyClosestToLocalLocation(LocalLocation, HintKey);
+}
+
+float UVRSliderComponent::GetSplineInputKeyAtDistance(float Distance)
+{
+	if (!UpdateSplineLookup())
+		return SplineComponentToFollow->SplineCurves.ReparamTable.Eval(Distance, 0.0f);
+
+	return SplineLookup.GetInputKeyAtDistance(Distance);
+}
+
 void UVRSliderComponent::SetSplineComponentToFollow(USplineComponent * SplineToFollow)
 {
 	SplineComponentToFollow = SplineToFollow;
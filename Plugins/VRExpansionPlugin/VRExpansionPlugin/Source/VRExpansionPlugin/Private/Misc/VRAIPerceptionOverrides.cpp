@@ -34,11 +34,15 @@ DECLARE_CYCLE_STAT(TEXT("Perception Sense: Sight, Listener Update"), STAT_AI_Sen
 DECLARE_CYCLE_STAT(TEXT("Perception Sense: Sight, Register Target"), STAT_AI_Sense_Sight_RegisterTarget, STATGROUP_AI);
 DECLARE_CYCLE_STAT(TEXT("Perception Sense: Sight, Remove By Listener"), STAT_AI_Sense_Sight_RemoveByListener, STATGROUP_AI);
 DECLARE_CYCLE_STAT(TEXT("Perception Sense: Sight, Remove To Target"), STAT_AI_Sense_Sight_RemoveToTarget, STATGROUP_AI);
+DECLARE_CYCLE_STAT(TEXT("Perception Sense: Sight, Broadphase"), STAT_AI_Sense_Sight_Broadphase, STATGROUP_AI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Perception Sense: Sight, Live Queries"), STAT_AI_Sense_Sight_LiveQueries, STATGROUP_AI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Perception Sense: Sight, Theoretical Pairs"), STAT_AI_Sense_Sight_TheoreticalPairs, STATGROUP_AI);
 
 
 static const int32 DefaultMaxTracesPerTick = 6;
 static const int32 DefaultMinQueriesPerTimeSliceCheck = 40;
 
+
 //----------------------------------------------------------------------//
 // helpers
 //----------------------------------------------------------------------//
@@ -53,6 +57,72 @@ FORCEINLINE_DEBUGGABLE bool CheckIsTargetInSightPie(const FPerceptionListener& L
 	return false;
 }
 
+FORCEINLINE uint64 MakeSightPairKey(uint32 ListenerId, uint32 TargetId)
+{
+	return ((uint64)ListenerId << 32) | (uint64)TargetId;
+}
+
+FORCEINLINE int32 GetSightScoreBucket(float Score)
+{
+	return FMath::Clamp(FMath::FloorToInt(Score * UAISense_Sight_VR::SortBucketsPerScoreUnit), 0, UAISense_Sight_VR::NumSortBuckets - 1);
+}
+
+//----------------------------------------------------------------------//
+// FAISightTargetGridVR
+//----------------------------------------------------------------------//
+void FAISightTargetGridVR::Reset(float InCellSize)
+{
+	CellSize = FMath::Max(InCellSize, 1.f);
+
+	// Keep the cell arrays allocated, targets tend to stay in the same area between updates
+	for (TPair<FIntVector, TArray<FAISightTargetVR::FTargetId>>& Cell : Cells)
+	{
+		Cell.Value.Reset();
+	}
+}
+
+void FAISightTargetGridVR::AddTarget(FAISightTargetVR::FTargetId TargetId, const FVector& Location)
+{
+	Cells.FindOrAdd(GetCell(Location)).Add(TargetId);
+}
+
+void FAISightTargetGridVR::GatherTargetsInRadius(const FVector& Center, float Radius, TArray<FAISightTargetVR::FTargetId>& OutTargets) const
+{
+	const FIntVector MinCell = GetCell(Center - FVector(Radius));
+	const FIntVector MaxCell = GetCell(Center + FVector(Radius));
+
+	// If the radius covers more cells than we have populated then walking the map is cheaper
+	const int64 NumCellsInRange = (int64)(MaxCell.X - MinCell.X + 1) * (int64)(MaxCell.Y - MinCell.Y + 1) * (int64)(MaxCell.Z - MinCell.Z + 1);
+	if (NumCellsInRange > Cells.Num())
+	{
+		for (const TPair<FIntVector, TArray<FAISightTargetVR::FTargetId>>& Cell : Cells)
+		{
+			if (Cell.Key.X >= MinCell.X && Cell.Key.X <= MaxCell.X &&
+				Cell.Key.Y >= MinCell.Y && Cell.Key.Y <= MaxCell.Y &&
+				Cell.Key.Z >= MinCell.Z && Cell.Key.Z <= MaxCell.Z)
+			{
+				OutTargets.Append(Cell.Value);
+			}
+		}
+
+		return;
+	}
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+			{
+				if (const TArray<FAISightTargetVR::FTargetId>* CellTargets = Cells.Find(FIntVector(X, Y, Z)))
+				{
+					OutTargets.Append(*CellTargets);
+				}
+			}
+		}
+	}
+}
+
 //----------------------------------------------------------------------//
 // FAISightTargetVR
 //----------------------------------------------------------------------//
@@ -78,6 +148,7 @@ UAISense_Sight_VR::FDigestedSightProperties::FDigestedSightProperties(const UAIS
 {
 	SightRadiusSq = FMath::Square(SenseConfig.SightRadius);
 	LoseSightRadiusSq = FMath::Square(SenseConfig.LoseSightRadius);
+	BroadphaseRadius = FMath::Max(SenseConfig.SightRadius, SenseConfig.LoseSightRadius);
 	PeripheralVisionAngleCos = FMath::Cos(FMath::Clamp(FMath::DegreesToRadians(SenseConfig.PeripheralVisionAngleDegrees), 0.f, PI));
 	AffiliationFlags = SenseConfig.DetectionByAffiliation.GetAsFlags();
 	// keep the special value of FAISystem::InvalidRange (-1.f) if it's set.
@@ -85,7 +156,7 @@ UAISense_Sight_VR::FDigestedSightProperties::FDigestedSightProperties(const UAIS
 }
 
 UAISense_Sight_VR::FDigestedSightProperties::FDigestedSightProperties()
-	: PeripheralVisionAngleCos(0.f), SightRadiusSq(-1.f), AutoSuccessRangeSqFromLastSeenLocation(FAISystem::InvalidRange), LoseSightRadiusSq(-1.f), AffiliationFlags(-1)
+	: PeripheralVisionAngleCos(0.f), SightRadiusSq(-1.f), BroadphaseRadius(-1.f), AutoSuccessRangeSqFromLastSeenLocation(FAISystem::InvalidRange), LoseSightRadiusSq(-1.f), AffiliationFlags(-1)
 {}
 
 //----------------------------------------------------------------------//
@@ -99,6 +170,11 @@ UAISense_Sight_VR::UAISense_Sight_VR(const FObjectInitializer& ObjectInitializer
 	, HighImportanceQueryDistanceThreshold(300.f)
 	, MaxQueryImportance(60.f)
 	, SightLimitQueryImportance(10.f)
+	, bUseSightBroadphase(true)
+	, BroadphaseCellSize(1000.f)
+	, BroadphaseRangePadding(250.f)
+	, BroadphaseUpdateInterval(0.25f)
+	, LastBroadphaseUpdateTime(0.0)
 {
 	if (HasAnyFlags(RF_ClassDefaultObject) == false)
 	{
@@ -125,6 +201,170 @@ FORCEINLINE_DEBUGGABLE float UAISense_Sight_VR::CalcQueryImportance(const FPerce
 		: FMath::Clamp((SightLimitQueryImportance - MaxQueryImportance) / SightRadiusSq * DistanceSq + MaxQueryImportance, 0.f, MaxQueryImportance);
 }
 
+FORCEINLINE_DEBUGGABLE bool UAISense_Sight_VR::IsInBroadphaseRange(const FVector& ListenerLocation, const FDigestedSightProperties& PropDigest, const FVector& TargetLocation) const
+{
+	if (!bUseSightBroadphase || PropDigest.BroadphaseRadius < 0.f)
+	{
+		return true;
+	}
+
+	return FVector::DistSquared(ListenerLocation, TargetLocation) <= FMath::Square(PropDigest.BroadphaseRadius + BroadphaseRangePadding);
+}
+
+FORCEINLINE_DEBUGGABLE bool UAISense_Sight_VR::IsInBroadphaseRange(const FPerceptionListener& Listener, const FDigestedSightProperties& PropDigest, const FVector& TargetLocation) const
+{
+	return IsInBroadphaseRange(Listener.CachedLocation, PropDigest, TargetLocation);
+}
+
+bool UAISense_Sight_VR::CanDropOutOfRangeQuery(const FAISightQueryVR& SightQuery, const FVector& ListenerLocation, const FDigestedSightProperties& PropDigest, const FVector& TargetLocation) const
+{
+	// A target still considered seen needs its query to report the loss, one with a last seen location can still be automatically seen
+	if (SightQuery.bLastResult)
+	{
+		return false;
+	}
+
+	if (PropDigest.AutoSuccessRangeSqFromLastSeenLocation != FAISystem::InvalidRange && SightQuery.LastSeenLocation != FAISystem::InvalidLocation)
+	{
+		return false;
+	}
+
+	return !IsInBroadphaseRange(ListenerLocation, PropDigest, TargetLocation);
+}
+
+void UAISense_Sight_VR::SortQueries()
+{
+	const int32 NumQueries = SightQueryQueue.Num();
+
+	if (NumQueries < 2)
+	{
+		return;
+	}
+
+	SortBucketOffsets.Reset(NumSortBuckets);
+	SortBucketOffsets.AddZeroed(NumSortBuckets);
+
+	for (const FAISightQueryVR& SightQuery : SightQueryQueue)
+	{
+		++SortBucketOffsets[GetSightScoreBucket(SightQuery.Score)];
+	}
+
+	// Highest score first
+	int32 Offset = 0;
+	for (int32 BucketIndex = NumSortBuckets - 1; BucketIndex >= 0; --BucketIndex)
+	{
+		const int32 BucketCount = SortBucketOffsets[BucketIndex];
+		SortBucketOffsets[BucketIndex] = Offset;
+		Offset += BucketCount;
+	}
+
+	SortScratchQueue.Reset(NumQueries);
+	SortScratchQueue.AddUninitialized(NumQueries);
+
+	for (const FAISightQueryVR& SightQuery : SightQueryQueue)
+	{
+		SortScratchQueue[SortBucketOffsets[GetSightScoreBucket(SightQuery.Score)]++] = SightQuery;
+	}
+
+	Swap(SightQueryQueue, SortScratchQueue);
+}
+
+void UAISense_Sight_VR::UpdateBroadphase()
+{
+	SCOPE_CYCLE_COUNTER(STAT_AI_Sense_Sight_Broadphase);
+
+	AIPerception::FListenerMap& ListenersMap = *GetListeners();
+
+	TargetGrid.Reset(BroadphaseCellSize);
+	for (FTargetsContainer::TConstIterator ItTarget(ObservedTargets); ItTarget; ++ItTarget)
+	{
+		if (ItTarget->Value.Target.IsValid())
+		{
+			TargetGrid.AddTarget(ItTarget->Key, ItTarget->Value.GetLocationSimple());
+		}
+	}
+
+	// Drop queries for pairs that left the range
+	BroadphaseExistingPairs.Reset();
+	const int32 NumRemoved = SightQueryQueue.RemoveAll([&](const FAISightQueryVR& SightQuery) -> bool
+	{
+		const FPerceptionListener* Listener = ListenersMap.Find(SightQuery.ObserverId);
+		const FDigestedSightProperties* PropDigest = DigestedProperties.Find(SightQuery.ObserverId);
+		const FAISightTargetVR* Target = ObservedTargets.Find(SightQuery.TargetId);
+
+		if (Listener && PropDigest && Target && Target->Target.IsValid() &&
+			CanDropOutOfRangeQuery(SightQuery, Listener->CachedLocation, *PropDigest, Target->GetLocationSimple()))
+		{
+			return true;
+		}
+
+		const uint32 ObserverId = SightQuery.ObserverId;
+		BroadphaseExistingPairs.Add(MakeSightPairKey(ObserverId, SightQuery.TargetId));
+		return false;
+	});
+
+	bool bNewQueriesAdded = false;
+
+	for (AIPerception::FListenerMap::TConstIterator ItListener(ListenersMap); ItListener; ++ItListener)
+	{
+		const FPerceptionListener& Listener = ItListener->Value;
+		const FDigestedSightProperties* PropDigest = DigestedProperties.Find(ItListener->Key);
+
+		if (!PropDigest || !Listener.HasSense(GetSenseID()))
+		{
+			continue;
+		}
+
+		const IGenericTeamAgentInterface* ListenersTeamAgent = Listener.GetTeamAgent();
+		const AActor* Avatar = Listener.GetBodyActor();
+		const uint32 ListenerId = ItListener->Key;
+
+		BroadphaseCandidates.Reset();
+		TargetGrid.GatherTargetsInRadius(Listener.CachedLocation, PropDigest->BroadphaseRadius + BroadphaseRangePadding, BroadphaseCandidates);
+
+		for (const FAISightTargetVR::FTargetId& TargetId : BroadphaseCandidates)
+		{
+			if (BroadphaseExistingPairs.Contains(MakeSightPairKey(ListenerId, TargetId)))
+			{
+				continue;
+			}
+
+			const FAISightTargetVR* Target = ObservedTargets.Find(TargetId);
+			const AActor* TargetActor = Target ? Target->GetTargetActor() : nullptr;
+			if (TargetActor == nullptr || TargetActor == Avatar)
+			{
+				continue;
+			}
+
+			const FVector TargetLocation = Target->GetLocationSimple();
+			if (IsInBroadphaseRange(Listener, *PropDigest, TargetLocation) && FAISenseAffiliationFilter::ShouldSenseTeam(ListenersTeamAgent, *TargetActor, PropDigest->AffiliationFlags))
+			{
+				// create a sight query		
+				FAISightQueryVR& AddedQuery = SightQueryQueue.AddDefaulted_GetRef();
+				AddedQuery.ObserverId = ItListener->Key;
+				AddedQuery.TargetId = TargetId;
+				AddedQuery.Importance = CalcQueryImportance(Listener, TargetLocation, PropDigest->SightRadiusSq);
+				bNewQueriesAdded = true;
+			}
+		}
+	}
+
+	if (bNewQueriesAdded || NumRemoved > 0)
+	{
+		SortQueries();
+	}
+}
+
+void UAISense_Sight_VR::UpdateQueryStats()
+{
+	QueryStats.LiveQueries = SightQueryQueue.Num();
+	// One digest per listener with this sense
+	QueryStats.TheoreticalPairs = DigestedProperties.Num() * ObservedTargets.Num();
+
+	SET_DWORD_STAT(STAT_AI_Sense_Sight_LiveQueries, QueryStats.LiveQueries);
+	SET_DWORD_STAT(STAT_AI_Sense_Sight_TheoreticalPairs, QueryStats.TheoreticalPairs);
+}
+
 void UAISense_Sight_VR::PostInitProperties()
 {
 	Super::PostInitProperties();
@@ -178,6 +418,16 @@ float UAISense_Sight_VR::Update()
 		return SuspendNextUpdate;
 	}
 
+	if (bUseSightBroadphase)
+	{
+		const double CurrentTime = World->GetTimeSeconds();
+		if (CurrentTime < LastBroadphaseUpdateTime || (CurrentTime - LastBroadphaseUpdateTime) >= BroadphaseUpdateInterval)
+		{
+			LastBroadphaseUpdateTime = CurrentTime;
+			UpdateBroadphase();
+		}
+	}
+
 	int32 TracesCount = 0;
 	int32 NumQueriesProcessed = 0;
 	double TimeSliceEnd = FPlatformTime::Seconds() + MaxTimeSlicePerTick;
@@ -376,6 +626,8 @@ float UAISense_Sight_VR::Update()
 		SortQueries();
 	}
 
+	UpdateQueryStats();
+
 	//return SightQueryQueue.Num() > 0 ? 1.f/6 : FLT_MAX;
 	return 0.f;
 }
@@ -405,22 +657,23 @@ void UAISense_Sight_VR::UnregisterSource(AActor& SourceActor)
 			// notify all interested observers that this source is no longer
 			// visible		
 			AIPerception::FListenerMap& ListenersMap = *GetListeners();
-			const FAISightQueryVR* SightQuery = &SightQueryQueue[SightQueryQueue.Num() - 1];
-			for (int32 QueryIndex = SightQueryQueue.Num() - 1; QueryIndex >= 0; --QueryIndex, --SightQuery)
+			SightQueryQueue.RemoveAll([&](const FAISightQueryVR& SightQuery) -> bool
 			{
-				if (SightQuery->TargetId == AsTargetId)
+				if (SightQuery.TargetId == AsTargetId)
 				{
-					if (SightQuery->bLastResult == true)
+					if (SightQuery.bLastResult == true)
 					{
-						FPerceptionListener& Listener = ListenersMap[SightQuery->ObserverId];
+						FPerceptionListener& Listener = ListenersMap[SightQuery.ObserverId];
 						ensure(Listener.Listener.IsValid());
 
-						Listener.RegisterStimulus(TargetActor, FAIStimulus(*this, 0.f, SightQuery->LastSeenLocation, Listener.CachedLocation, FAIStimulus::SensingFailed));
+						Listener.RegisterStimulus(TargetActor, FAIStimulus(*this, 0.f, SightQuery.LastSeenLocation, Listener.CachedLocation, FAIStimulus::SensingFailed));
 					}
 
-					SightQueryQueue.RemoveAt(QueryIndex, 1, /*bAllowShrinking=*/false);
+					return true;
 				}
-			}
+
+				return false;
+			});
 			// no point in sorting, we haven't change the order of other queries
 		}
 	}
@@ -504,7 +757,7 @@ bool UAISense_Sight_VR::RegisterTarget(AActor & TargetActor, FQueriesOperationPo
 		if (Listener.HasSense(GetSenseID()) && Listener.GetBodyActor() != &TargetActor)
 		{
 			const FDigestedSightProperties& PropDigest = DigestedProperties[Listener.GetListenerID()];
-			if (FAISenseAffiliationFilter::ShouldSenseTeam(ListenersTeamAgent, TargetActor, PropDigest.AffiliationFlags))
+			if (IsInBroadphaseRange(Listener, PropDigest, TargetLocation) && FAISenseAffiliationFilter::ShouldSenseTeam(ListenersTeamAgent, TargetActor, PropDigest.AffiliationFlags))
 			{
 				// create a sight query		
 				FAISightQueryVR& AddedQuery = SightQueryQueue.AddDefaulted_GetRef();
@@ -561,13 +814,14 @@ void UAISense_Sight_VR::GenerateQueriesForListener(const FPerceptionListener & L
 			continue;
 		}
 
-		if (FAISenseAffiliationFilter::ShouldSenseTeam(ListenersTeamAgent, *TargetActor, PropertyDigest.AffiliationFlags))
+		const FVector TargetLocation = ItTarget->Value.GetLocationSimple();
+		if (IsInBroadphaseRange(Listener, PropertyDigest, TargetLocation) && FAISenseAffiliationFilter::ShouldSenseTeam(ListenersTeamAgent, *TargetActor, PropertyDigest.AffiliationFlags))
 		{
 			// create a sight query		
 			FAISightQueryVR& AddedQuery = SightQueryQueue.AddDefaulted_GetRef();
 			AddedQuery.ObserverId = Listener.GetListenerID();
 			AddedQuery.TargetId = ItTarget->Key;
-			AddedQuery.Importance = CalcQueryImportance(Listener, ItTarget->Value.GetLocationSimple(), PropertyDigest.SightRadiusSq);
+			AddedQuery.Importance = CalcQueryImportance(Listener, TargetLocation, PropertyDigest.SightRadiusSq);
 
 			OnAddedFunc(AddedQuery);
 			bNewQueriesAdded = true;
@@ -607,10 +861,26 @@ void UAISense_Sight_VR::OnListenerUpdateImpl(const FPerceptionListener& UpdatedL
 				}
 			});
 
-			RegisterTarget(*(AsTarget->Target.Get()), DontSort, [&LastVisibleObservers](FAISightQueryVR & Query)
+			AActor* AsTargetActor = AsTarget->Target.Get();
+			const FVector AsTargetLocation = AsTarget->GetLocationSimple();
+
+			RegisterTarget(*AsTargetActor, DontSort, [&LastVisibleObservers](FAISightQueryVR & Query)
 			{
-				Query.bLastResult = LastVisibleObservers.Contains(Query.ObserverId);
+				Query.bLastResult = LastVisibleObservers.Remove(Query.ObserverId) > 0;
 			});
+
+			// Observers that saw the target but didn't get a new query (out of broadphase range) have to be told they lost it
+			if (LastVisibleObservers.Num() > 0)
+			{
+				AIPerception::FListenerMap& ListenersMap = *GetListeners();
+				for (const FPerceptionListenerID& ObserverId : LastVisibleObservers)
+				{
+					if (FPerceptionListener* Observer = ListenersMap.Find(ObserverId))
+					{
+						Observer->RegisterStimulus(AsTargetActor, FAIStimulus(*this, 0.f, AsTargetLocation, Observer->CachedLocation, FAIStimulus::SensingFailed));
+					}
+				}
+			}
 		}
 		else
 		{
@@ -639,8 +909,24 @@ void UAISense_Sight_VR::OnListenerUpdateImpl(const FPerceptionListener& UpdatedL
 
 		GenerateQueriesForListener(UpdatedListener, PropertiesDigest, [&LastVisibleTargets](FAISightQueryVR & Query)
 		{
-			Query.bLastResult = LastVisibleTargets.Contains(Query.TargetId);
+			Query.bLastResult = LastVisibleTargets.Remove(Query.TargetId) > 0;
 		});
+
+		// Targets that were visible but didn't get a new query (out of broadphase range) have to be reported as lost
+		if (LastVisibleTargets.Num() > 0)
+		{
+			if (FPerceptionListener* Listener = GetListeners()->Find(ListenerID))
+			{
+				for (const FAISightTargetVR::FTargetId& TargetId : LastVisibleTargets)
+				{
+					const FAISightTargetVR* Target = ObservedTargets.Find(TargetId);
+					if (AActor* TargetActor = Target ? Target->Target.Get() : nullptr)
+					{
+						Listener->RegisterStimulus(TargetActor, FAIStimulus(*this, 0.f, Target->GetLocationSimple(), Listener->CachedLocation, FAIStimulus::SensingFailed));
+					}
+				}
+			}
+		}
 	}
 	else
 	{
@@ -676,19 +962,18 @@ void UAISense_Sight_VR::RemoveAllQueriesByListener(const FPerceptionListener& Li
 	}
 
 	const uint32 ListenerId = Listener.GetListenerID();
-	bool bQueriesRemoved = false;
 
-	for (int32 QueryIndex = SightQueryQueue.Num() - 1; QueryIndex >= 0; --QueryIndex)
+	// Single order preserving pass instead of a RemoveAt (and shift) per matching query
+	const bool bQueriesRemoved = SightQueryQueue.RemoveAll([&](const FAISightQueryVR& SightQuery) -> bool
 	{
-		const FAISightQueryVR& SightQuery = SightQueryQueue[QueryIndex];
-
 		if (SightQuery.ObserverId == ListenerId)
 		{
 			OnRemoveFunc(SightQuery);
-			SightQueryQueue.RemoveAt(QueryIndex, 1, /*bAllowShrinking=*/false);
-			bQueriesRemoved = true;
+			return true;
 		}
-	}
+
+		return false;
+	}) > 0;
 
 	if (PostProcess == Sort && bQueriesRemoved)
 	{
@@ -710,19 +995,16 @@ void UAISense_Sight_VR::RemoveAllQueriesToTarget(const FAISightTargetVR::FTarget
 		return;
 	}
 
-	bool bQueriesRemoved = false;
-
-	for (int32 QueryIndex = SightQueryQueue.Num() - 1; QueryIndex >= 0; --QueryIndex)
+	const bool bQueriesRemoved = SightQueryQueue.RemoveAll([&](const FAISightQueryVR& SightQuery) -> bool
 	{
-		const FAISightQueryVR& SightQuery = SightQueryQueue[QueryIndex];
-
 		if (SightQuery.TargetId == TargetId)
 		{
 			OnRemoveFunc(SightQuery);
-			SightQueryQueue.RemoveAt(QueryIndex, 1, /*bAllowShrinking=*/false);
-			bQueriesRemoved = true;
+			return true;
 		}
-	}
+
+		return false;
+	}) > 0;
 
 	if (PostProcess == Sort && bQueriesRemoved)
 	{
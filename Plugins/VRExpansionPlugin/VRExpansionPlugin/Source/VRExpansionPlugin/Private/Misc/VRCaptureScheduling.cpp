@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/VRCaptureScheduling.h"
+
+float FVRCaptureScheduler::GetViewRanking(const FVRCaptureScheduleView & View, const FVRCaptureScheduleEntry & Entry)
+{
+	if (!View.bIsValid)
+		return 0.0f;
+
+	const FVector ToCapture = Entry.Center - View.Location;
+	const float Distance = ToCapture.Size();
+
+	// Inside of the bounds, the surface fills the view no matter where we look
+	if (Distance <= Entry.Radius || Distance < KINDA_SMALL_NUMBER)
+		return Entry.Settings.CoverageWeight + Entry.Settings.ViewAngleWeight + Entry.Settings.DistanceWeight;
+
+	const FVector Direction = ToCapture / Distance;
+	const float CosAngle = View.Forward | Direction;
+
+	// Widen the view cone by the angular size of the bounds so partially visible surfaces still count
+	const float AngularRadius = FMath::Asin(FMath::Clamp(Entry.Radius / Distance, 0.0f, 1.0f));
+	const float HalfFOV = FMath::Atan(View.TanHalfFOV);
+	if (FMath::Acos(FMath::Clamp(CosAngle, -1.0f, 1.0f)) > HalfFOV + AngularRadius)
+		return 0.0f;
+
+	const float Coverage = FMath::Clamp(Entry.Radius / (Distance * FMath::Max(View.TanHalfFOV, KINDA_SMALL_NUMBER)), 0.0f, 1.0f);
+	const float Facing = FMath::Max(CosAngle, 0.0f);
+	const float Nearness = 1.0f - FMath::Clamp(Distance / FMath::Max(Entry.Settings.MaxRankingDistance, 1.0f), 0.0f, 1.0f);
+
+	return (Coverage * Entry.Settings.CoverageWeight) + (Facing * Entry.Settings.ViewAngleWeight) + (Nearness * Entry.Settings.DistanceWeight);
+}
+
+void FVRCaptureScheduler::SelectCaptures(const FVRCaptureScheduleView & View, float CurrentTime, int32 MaxCaptures, TArray<int32> & OutSelected)
+{
+	OutSelected.Reset();
+	Candidates.Reset();
+
+	if (MaxCaptures <= 0)
+		return;
+
+	for (int32 i = 0; i < Entries.Num(); ++i)
+	{
+		const FVRCaptureScheduleEntry & Entry = Entries[i];
+
+		if (!Entry.bHasCaptured)
+		{
+			Candidates.Add({ i, BIG_NUMBER, true });
+			continue;
+		}
+
+		const float TimeSinceCapture = CurrentTime - Entry.LastCaptureTime;
+
+		if (Entry.Settings.MaxRefreshRate > 0.0f && TimeSinceCapture < 1.0f / Entry.Settings.MaxRefreshRate)
+			continue;
+
+		if (Entry.Settings.MinRefreshRate > 0.0f && TimeSinceCapture >= 1.0f / Entry.Settings.MinRefreshRate)
+		{
+			// Intervals late, comparable across different min rates
+			Candidates.Add({ i, TimeSinceCapture * Entry.Settings.MinRefreshRate, true });
+			continue;
+		}
+
+		const float Ranking = GetViewRanking(View, Entry);
+		if (Ranking > 0.0f)
+			Candidates.Add({ i, Ranking * TimeSinceCapture, false });
+	}
+
+	Candidates.Sort();
+
+	if (Candidates.Num() > MaxCaptures)
+		Candidates.SetNum(MaxCaptures, false);
+
+	for (const FCandidate & Candidate : Candidates)
+	{
+		FVRCaptureScheduleEntry & Entry = Entries[Candidate.Index];
+		Entry.bHasCaptured = true;
+		Entry.LastCaptureTime = CurrentTime;
+		OutSelected.Add(Candidate.Index);
+	}
+}
@@ -0,0 +1,17 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/VRClimbingHandholdComponent.h"
+
+UVRClimbingHandholdComponent::UVRClimbingHandholdComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	PrimaryComponentTick.bCanEverTick = false;
+	bCanBeClimbed = true;
+	HandholdExtent = FVector(5.0f, 50.0f, 5.0f);
+}
+
+FVector UVRClimbingHandholdComponent::GetLocalAnchor(FVector WorldGripLocation) const
+{
+	const FVector LocalLocation = GetComponentTransform().InverseTransformPosition(WorldGripLocation);
+	return LocalLocation.BoundToBox(-HandholdExtent, HandholdExtent);
+}
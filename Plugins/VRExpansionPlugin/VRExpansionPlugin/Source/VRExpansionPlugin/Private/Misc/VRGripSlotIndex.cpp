@@ -0,0 +1,266 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/VRGripSlotIndex.h"
+#include "Components/SceneComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/SkeletalMesh.h"
+#include "UObject/UObjectGlobals.h"
+
+TMap<const UObject *, FVRGripSlotMeshIndex> FVRGripSlotIndexCache::MeshIndices;
+
+#if WITH_EDITOR
+FDelegateHandle FVRGripSlotIndexCache::OnObjectPropertyChangedHandle;
+#endif
+
+int32 FVRGripSlotTypeIndex::FindClosestInRange(const FVector& ComponentSpaceLocation, float MaxRangeSq) const
+{
+	const int32 NumSlots = ComponentSpaceLocations.Num();
+	if (NumSlots < 1)
+		return INDEX_NONE;
+
+	const float MaxRange = FMath::Sqrt(MaxRangeSq);
+	const float MinX = ComponentSpaceLocation.X - MaxRange;
+	const float MaxX = ComponentSpaceLocation.X + MaxRange;
+
+	// Lower bound on X, the slots are sorted on it
+	int32 Low = 0;
+	int32 High = NumSlots;
+	while (Low < High)
+	{
+		const int32 Mid = (Low + High) / 2;
+		if (ComponentSpaceLocations[Mid].X < MinX)
+		{
+			Low = Mid + 1;
+		}
+		else
+		{
+			High = Mid;
+		}
+	}
+
+	int32 ClosestIndex = INDEX_NONE;
+	float ClosestDistSq = MaxRangeSq;
+
+	for (int32 i = Low; i < NumSlots && ComponentSpaceLocations[i].X <= MaxX; ++i)
+	{
+		const float DistSq = FVector::DistSquared(ComponentSpaceLocation, ComponentSpaceLocations[i]);
+		if (DistSq <= ClosestDistSq && (ClosestIndex == INDEX_NONE || DistSq < ClosestDistSq))
+		{
+			ClosestDistSq = DistSq;
+			ClosestIndex = i;
+		}
+	}
+
+	return ClosestIndex;
+}
+
+const UObject * FVRGripSlotIndexCache::GetIndexableMesh(const USceneComponent * Component, bool & bOutHasStaticSocketTransforms, int32 & OutNumSockets)
+{
+	bOutHasStaticSocketTransforms = false;
+	OutNumSockets = 0;
+
+	if (const UStaticMeshComponent * StaticMeshComp = Cast<UStaticMeshComponent>(Component))
+	{
+		if (UStaticMesh * StaticMesh = StaticMeshComp->GetStaticMesh())
+		{
+			// Static mesh sockets are fixed relative to the component
+			bOutHasStaticSocketTransforms = true;
+			OutNumSockets = StaticMesh->Sockets.Num();
+			return StaticMesh;
+		}
+	}
+	else if (const USkeletalMeshComponent * SkeletalMeshComp = Cast<USkeletalMeshComponent>(Component))
+	{
+		if (USkeletalMesh * SkeletalMesh = SkeletalMeshComp->SkeletalMesh)
+		{
+			// Bones are part of the socket list for skeletal meshes and they move with the pose
+			OutNumSockets = SkeletalMesh->NumSockets() + SkeletalMesh->RefSkeleton.GetNum();
+			return SkeletalMesh;
+		}
+	}
+
+	return nullptr;
+}
+
+const FVRGripSlotTypeIndex * FVRGripSlotIndexCache::FindOrBuildSlotTypeIndex(USceneComponent * Component, FName SlotType, bool & bOutHasStaticSocketTransforms)
+{
+	int32 NumSockets = 0;
+	const UObject * Mesh = GetIndexableMesh(Component, bOutHasStaticSocketTransforms, NumSockets);
+
+	if (!Mesh)
+		return nullptr;
+
+	FVRGripSlotMeshIndex & MeshIndex = MeshIndices.FindOrAdd(Mesh);
+
+	// Address was re-used by a new mesh or the sockets changed, start over
+	if (MeshIndex.Mesh.Get() != Mesh || MeshIndex.NumSockets != NumSockets || MeshIndex.bHasStaticSocketTransforms != bOutHasStaticSocketTransforms)
+	{
+		MeshIndex.Mesh = Mesh;
+		MeshIndex.NumSockets = NumSockets;
+		MeshIndex.bHasStaticSocketTransforms = bOutHasStaticSocketTransforms;
+		MeshIndex.SlotTypes.Reset();
+	}
+
+	for (const FVRGripSlotTypeIndex & SlotTypeIndex : MeshIndex.SlotTypes)
+	{
+		if (SlotTypeIndex.SlotType == SlotType)
+			return &SlotTypeIndex;
+	}
+
+	FVRGripSlotTypeIndex & NewIndex = MeshIndex.SlotTypes.AddDefaulted_GetRef();
+	NewIndex.SlotType = SlotType;
+
+	const FString GripIdentifier = SlotType.ToString();
+	TArray<FName> SocketNames = Component->GetAllSocketNames();
+
+	for (const FName & SocketName : SocketNames)
+	{
+		if (SocketName.ToString().Contains(GripIdentifier, ESearchCase::IgnoreCase, ESearchDir::FromStart))
+		{
+			NewIndex.SocketNames.Add(SocketName);
+		}
+	}
+
+	if (bOutHasStaticSocketTransforms && NewIndex.SocketNames.Num() > 0)
+	{
+		TArray<TPair<FVector, FName>> SortedSlots;
+		SortedSlots.Reserve(NewIndex.SocketNames.Num());
+
+		for (const FName & SocketName : NewIndex.SocketNames)
+		{
+			SortedSlots.Add(TPair<FVector, FName>(Component->GetSocketTransform(SocketName, ERelativeTransformSpace::RTS_Component).GetLocation(), SocketName));
+		}
+
+		SortedSlots.StableSort([](const TPair<FVector, FName> & A, const TPair<FVector, FName> & B)
+		{
+			return A.Key.X < B.Key.X;
+		});
+
+		NewIndex.SocketNames.Reset();
+		NewIndex.ComponentSpaceLocations.Reset(SortedSlots.Num());
+
+		for (const TPair<FVector, FName> & Slot : SortedSlots)
+		{
+			NewIndex.ComponentSpaceLocations.Add(Slot.Key);
+			NewIndex.SocketNames.Add(Slot.Value);
+		}
+	}
+
+	return &NewIndex;
+}
+
+bool FVRGripSlotIndexCache::GetClosestSlotInRange(FName SlotType, USceneComponent * Component, const FVector& WorldLocation, float MaxRange, FTransform & SlotWorldTransform)
+{
+	if (!Component)
+		return false;
+
+	const FVector RelativeWorldLocation = Component->GetComponentTransform().InverseTransformPosition(WorldLocation);
+	const float MaxRangeSq = FMath::Square(MaxRange);
+
+	bool bHasStaticSocketTransforms = false;
+	FName FoundSocket = NAME_None;
+
+	if (const FVRGripSlotTypeIndex * SlotTypeIndex = FindOrBuildSlotTypeIndex(Component, SlotType, bHasStaticSocketTransforms))
+	{
+		if (bHasStaticSocketTransforms)
+		{
+			const int32 FoundIndex = SlotTypeIndex->FindClosestInRange(RelativeWorldLocation, MaxRangeSq);
+			if (FoundIndex != INDEX_NONE)
+			{
+				FoundSocket = SlotTypeIndex->SocketNames[FoundIndex];
+			}
+		}
+		else
+		{
+			// Names are pre-filtered, transforms still have to come from the current pose
+			float ClosestSlotDistance = -0.1f;
+			for (const FName & SocketName : SlotTypeIndex->SocketNames)
+			{
+				const float vecLen = FVector::DistSquared(RelativeWorldLocation, Component->GetSocketTransform(SocketName, ERelativeTransformSpace::RTS_Component).GetLocation());
+
+				if (MaxRangeSq >= vecLen && (ClosestSlotDistance < 0.0f || vecLen < ClosestSlotDistance))
+				{
+					ClosestSlotDistance = vecLen;
+					FoundSocket = SocketName;
+				}
+			}
+		}
+	}
+	else
+	{
+		// No mesh asset to index on, walk the sockets directly
+		float ClosestSlotDistance = -0.1f;
+		TArray<FName> SocketNames = Component->GetAllSocketNames();
+		const FString GripIdentifier = SlotType.ToString();
+
+		for (const FName & SocketName : SocketNames)
+		{
+			if (SocketName.ToString().Contains(GripIdentifier, ESearchCase::IgnoreCase, ESearchDir::FromStart))
+			{
+				const float vecLen = FVector::DistSquared(RelativeWorldLocation, Component->GetSocketTransform(SocketName, ERelativeTransformSpace::RTS_Component).GetLocation());
+
+				if (MaxRangeSq >= vecLen && (ClosestSlotDistance < 0.0f || vecLen < ClosestSlotDistance))
+				{
+					ClosestSlotDistance = vecLen;
+					FoundSocket = SocketName;
+				}
+			}
+		}
+	}
+
+	if (FoundSocket.IsNone())
+		return false;
+
+	SlotWorldTransform = Component->GetSocketTransform(FoundSocket);
+	SlotWorldTransform.SetScale3D(FVector(1.0f));
+	return true;
+}
+
+void FVRGripSlotIndexCache::PrewarmComponent(USceneComponent * Component, FName SlotType)
+{
+	if (!Component)
+		return;
+
+	bool bHasStaticSocketTransforms = false;
+	FindOrBuildSlotTypeIndex(Component, SlotType, bHasStaticSocketTransforms);
+}
+
+void FVRGripSlotIndexCache::InvalidateMesh(const UObject * Mesh)
+{
+	MeshIndices.Remove(Mesh);
+}
+
+void FVRGripSlotIndexCache::Reset()
+{
+	MeshIndices.Empty();
+}
+
+void FVRGripSlotIndexCache::StartupCache()
+{
+#if WITH_EDITOR
+	OnObjectPropertyChangedHandle = FCoreUObjectDelegates::OnObjectPropertyChanged.AddStatic(&FVRGripSlotIndexCache::OnObjectPropertyChanged);
+#endif
+}
+
+void FVRGripSlotIndexCache::ShutdownCache()
+{
+#if WITH_EDITOR
+	FCoreUObjectDelegates::OnObjectPropertyChanged.Remove(OnObjectPropertyChangedHandle);
+	OnObjectPropertyChangedHandle.Reset();
+#endif
+
+	Reset();
+}
+
+#if WITH_EDITOR
+void FVRGripSlotIndexCache::OnObjectPropertyChanged(UObject * Object, FPropertyChangedEvent & PropertyChangedEvent)
+{
+	// Socket edits and re-imports don't always change the socket count, drop the index on any edit of an indexed mesh
+	if (Object && MeshIndices.Num() > 0)
+	{
+		InvalidateMesh(Object);
+	}
+}
+#endif
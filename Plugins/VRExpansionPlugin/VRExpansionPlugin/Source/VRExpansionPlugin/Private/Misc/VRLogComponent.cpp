@@ -13,6 +13,7 @@ UVRLogComponent::UVRLogComponent(const FObjectInitializer& ObjectInitializer)
 	PrimaryComponentTick.bCanEverTick = false;
 	MaxLineLength = 130;
 	MaxStoredMessages = 10000;
+	LastDrawnScrollPos = INDEX_NONE;
 }
 
 //=============================================================================
@@ -66,9 +67,16 @@ void UVRLogComponent::AppendTextToConsole(FString Text, bool bReturnAtEnd)
 
 bool UVRLogComponent::DrawConsoleToRenderTarget2D(EBPVRConsoleDrawType DrawType, UTextureRenderTarget2D * Texture, float ScrollOffset, bool bForceDraw)
 {
-	if (!bForceDraw && DrawType == EBPVRConsoleDrawType::VRConsole_Draw_OutputLogOnly && !OutputLogHistory.bIsDirty)
+	if (DrawType == EBPVRConsoleDrawType::VRConsole_Draw_OutputLogOnly)
 	{
-		return false;
+		// Normally already flushed by the ticker, this picks up anything logged since earlier in the frame
+		OutputLogHistory.FlushPendingMessages();
+
+		// Only redraw when new lines came in or the visible window moved
+		if (!bForceDraw && !OutputLogHistory.bIsDirty && GetOutputLogScrollPos(ScrollOffset) == LastDrawnScrollPos)
+		{
+			return false;
+		}
 	}
 	//LastRenderedOutputLogSize 
 
@@ -163,18 +171,17 @@ void UVRLogComponent::DrawOutputLog(bool bUpperHalf, UCanvas* Canvas, float Scro
 
 	FCanvasTextItem ConsoleText(FVector2D(0, 0 + Height - 5 - yl), FText::FromString(TEXT("")), Font, FColor::Emerald);
 
-	const TArray< TSharedPtr<FVRLogMessage> > LoggedMessages = OutputLogHistory.GetMessages();
-	
-	int32 ScrollPos = 0;
-
-	if(ScrollOffset > 0 && LoggedMessages.Num() > 1)
-		ScrollPos = FMath::Clamp(FMath::RoundToInt(LoggedMessages.Num() * ScrollOffset ) , 0, LoggedMessages.Num() - 1);
+	const int32 NumLines = OutputLogHistory.NumLines();
+	const int32 ScrollPos = GetOutputLogScrollPos(ScrollOffset);
 
+	// Only walks the lines that fit on the texture
 	float Xpos = 0.0f;
 	float Ypos = 0.0f;
-	for (int i = LoggedMessages.Num() - (1 + ScrollPos); i >= 0 && Ypos <= Height - yl; i--)//auto &Message : LoggedMessages)
+	for (int i = NumLines - (1 + ScrollPos); i >= 0 && Ypos <= Height - yl; i--)//auto &Message : LoggedMessages)
 	{
-		switch (LoggedMessages[i]->Verbosity)
+		const FVRLogMessage& LogLine = OutputLogHistory.GetLine(i);
+
+		switch (LogLine.Verbosity)
 		{
 
 		case ELogVerbosity::Error:
@@ -186,11 +193,22 @@ void UVRLogComponent::DrawOutputLog(bool bUpperHalf, UCanvas* Canvas, float Scro
 		}
 
 		Ypos += yl;
-		ConsoleText.Text = FText::Format(NSLOCTEXT("VRLogComponent", "ConsoleFormat", "{0}"), FText::FromString(*LoggedMessages[i]->Message));
+		ConsoleText.Text = LogLine.DisplayText;
 		Canvas->DrawItem(ConsoleText, 0, Height - Ypos);
 	}
 
 	OutputLogHistory.bIsDirty = false;
+	LastDrawnScrollPos = ScrollPos;
+}
+
+int32 UVRLogComponent::GetOutputLogScrollPos(float ScrollOffset) const
+{
+	const int32 NumLines = OutputLogHistory.NumLines();
+
+	if (ScrollOffset > 0 && NumLines > 1)
+		return FMath::Clamp(FMath::RoundToInt(NumLines * ScrollOffset), 0, NumLines - 1);
+
+	return 0;
 }
 
 
@@ -0,0 +1,211 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/VRMinimumAreaRectangle.h"
+
+namespace MinimumAreaRectangle
+{
+	// Positive if C is to the left of A->B
+	static FORCEINLINE float Cross(const FVector2D & A, const FVector2D & B, const FVector2D & C)
+	{
+		return ((B.X - A.X) * (C.Y - A.Y)) - ((B.Y - A.Y) * (C.X - A.X));
+	}
+
+	void ComputeHull(TArrayView<const FVector2D> Points, TArray<FVector2D> & SortScratch, TArray<FVector2D> & OutHull)
+	{
+		const int32 NumPoints = Points.Num();
+
+		SortScratch.Reset(NumPoints);
+		SortScratch.Append(Points.GetData(), NumPoints);
+		SortScratch.Sort([](const FVector2D & A, const FVector2D & B)
+		{
+			return A.X < B.X || (A.X == B.X && A.Y < B.Y);
+		});
+
+		OutHull.SetNumUninitialized(FMath::Max(NumPoints * 2, 1), false);
+
+		if (NumPoints < 2)
+		{
+			OutHull.SetNum(NumPoints, false);
+			if (NumPoints)
+				OutHull[0] = SortScratch[0];
+			return;
+		}
+
+		// Dropping on <= 0 removes collinear and duplicate points along with the concave ones
+		int32 k = 0;
+		for (int32 i = 0; i < NumPoints; ++i)
+		{
+			while (k >= 2 && Cross(OutHull[k - 2], OutHull[k - 1], SortScratch[i]) <= 0.0f)
+				--k;
+
+			OutHull[k++] = SortScratch[i];
+		}
+
+		for (int32 i = NumPoints - 2, LowerEnd = k + 1; i >= 0; --i)
+		{
+			while (k >= LowerEnd && Cross(OutHull[k - 2], OutHull[k - 1], SortScratch[i]) <= 0.0f)
+				--k;
+
+			OutHull[k++] = SortScratch[i];
+		}
+
+		// The last point is the first one again, and if every point was the same both chains still left it in once
+		int32 NumHull = FMath::Max(k - 1, 1);
+		if (NumHull == 2 && OutHull[0] == OutHull[1])
+			NumHull = 1;
+
+		OutHull.SetNum(NumHull, false);
+	}
+
+	FMinAreaRect2D FitHull(const TArray<FVector2D> & Hull)
+	{
+		FMinAreaRect2D Result;
+		const int32 NumHull = Hull.Num();
+
+		if (NumHull == 0)
+			return Result;
+
+		Result.bIsValid = true;
+
+		if (NumHull == 1)
+		{
+			Result.Center = Hull[0];
+			return Result;
+		}
+
+		if (NumHull == 2)
+		{
+			const FVector2D Edge = Hull[1] - Hull[0];
+			const float Length = Edge.Size();
+			Result.Center = (Hull[0] + Hull[1]) * 0.5f;
+			Result.Axis = Length > SMALL_NUMBER ? Edge / Length : FVector2D(1.0f, 0.0f);
+			Result.Extent = FVector2D(Length * 0.5f, 0.0f);
+			return Result;
+		}
+
+		auto Next = [NumHull](int32 Index) { return Index + 1 == NumHull ? 0 : Index + 1; };
+
+		// Extreme points for the first edge, from here on they only ever move forward around the hull
+		FVector2D U = (Hull[1] - Hull[0]).GetSafeNormal();
+		FVector2D V(-U.Y, U.X);
+
+		int32 MaxU = 0, MinU = 0, MaxV = 0;
+		for (int32 i = 1; i < NumHull; ++i)
+		{
+			const FVector2D Offset = Hull[i] - Hull[0];
+
+			if ((Offset | U) > ((Hull[MaxU] - Hull[0]) | U))
+				MaxU = i;
+
+			if ((Offset | U) < ((Hull[MinU] - Hull[0]) | U))
+				MinU = i;
+
+			if ((Offset | V) > ((Hull[MaxV] - Hull[0]) | V))
+				MaxV = i;
+		}
+
+		float BestArea = -1.0f;
+
+		for (int32 Edge = 0; Edge < NumHull; ++Edge)
+		{
+			const FVector2D & Origin = Hull[Edge];
+			U = (Hull[Next(Edge)] - Origin).GetSafeNormal();
+			V = FVector2D(-U.Y, U.X);
+
+			// The hull is strictly convex, so each of these walks a unimodal sequence and stops within one lap in total
+			while (((Hull[Next(MaxU)] - Origin) | U) > ((Hull[MaxU] - Origin) | U))
+				MaxU = Next(MaxU);
+
+			while (((Hull[Next(MaxV)] - Origin) | V) > ((Hull[MaxV] - Origin) | V))
+				MaxV = Next(MaxV);
+
+			while (((Hull[Next(MinU)] - Origin) | U) < ((Hull[MinU] - Origin) | U))
+				MinU = Next(MinU);
+
+			const float MaxUDist = (Hull[MaxU] - Origin) | U;
+			const float MinUDist = (Hull[MinU] - Origin) | U;
+			const float Height = (Hull[MaxV] - Origin) | V;
+			const float Area = (MaxUDist - MinUDist) * Height;
+
+			if (BestArea < 0.0f || Area < BestArea)
+			{
+				BestArea = Area;
+				Result.Axis = U;
+				Result.Extent = FVector2D((MaxUDist - MinUDist) * 0.5f, Height * 0.5f);
+				Result.Center = Origin + (U * ((MaxUDist + MinUDist) * 0.5f)) + (V * (Height * 0.5f));
+			}
+		}
+
+		return Result;
+	}
+
+	FMinAreaRect2D Fit(TArrayView<const FVector2D> Points, FMinAreaRectScratch & Scratch)
+	{
+		ComputeHull(Points, Scratch.Sorted, Scratch.Hull);
+		return FitHull(Scratch.Hull);
+	}
+
+	FMatrix ComputeBasis(const TArray<FVector> & InVerts, const FVector & SampleSurfaceNormal)
+	{
+		FVector PolyNormal = SampleSurfaceNormal;
+
+		// Compute the approximate normal of the poly, using the direction of SampleSurfaceNormal for guidance
+		if (InVerts.Num() >= 3)
+		{
+			const FVector SampledNormal = (InVerts[InVerts.Num() / 3] - InVerts[0]) ^ (InVerts[InVerts.Num() * 2 / 3] - InVerts[InVerts.Num() / 3]);
+
+			// Collinear samples give nothing to go on
+			if (!SampledNormal.IsNearlyZero())
+				PolyNormal = (SampledNormal | SampleSurfaceNormal) < 0.f ? -SampledNormal : SampledNormal;
+		}
+
+		if (PolyNormal.IsNearlyZero())
+			PolyNormal = FVector::UpVector;
+
+		return FRotationMatrix::MakeFromZX(PolyNormal, FVector(1.f, 0.f, 0.f));
+	}
+
+	bool Fit(const TArray<FVector> & InVerts, const FMatrix & Basis, FVRMinimumAreaRectangle & OutRect, FMinAreaRectScratch & Scratch)
+	{
+		OutRect.bIsValid = false;
+		OutRect.Corners.Reset();
+
+		if (InVerts.Num() == 0)
+			return false;
+
+		// Transform the sample points to 2D
+		Scratch.Points.Reset(InVerts.Num());
+		float PlaneHeight = 0.0f;
+		for (const FVector & Vert : InVerts)
+		{
+			const FVector Local = Basis.InverseTransformVector(Vert);
+			Scratch.Points.Add(FVector2D(Local.X, Local.Y));
+			PlaneHeight += Local.Z;
+		}
+		PlaneHeight /= InVerts.Num();
+
+		const FMinAreaRect2D Rect = Fit(Scratch.Points, Scratch);
+		if (!Rect.bIsValid)
+			return false;
+
+		const FVector2D AxisY(-Rect.Axis.Y, Rect.Axis.X);
+		const FVector2D SideX = Rect.Axis * Rect.Extent.X;
+		const FVector2D SideY = AxisY * Rect.Extent.Y;
+
+		auto ToWorld = [&Basis, PlaneHeight](const FVector2D & Point) { return Basis.TransformVector(FVector(Point.X, Point.Y, PlaneHeight)); };
+
+		OutRect.bIsValid = true;
+		OutRect.Center = ToWorld(Rect.Center);
+		OutRect.Rotation = FRotationMatrix::MakeFromZX(Basis.GetUnitAxis(EAxis::Z), Basis.TransformVector(FVector(Rect.Axis.X, Rect.Axis.Y, 0.f))).Rotator();
+		OutRect.SideLengthX = Rect.Extent.X * 2.0f;
+		OutRect.SideLengthY = Rect.Extent.Y * 2.0f;
+
+		OutRect.Corners.Reserve(4);
+		OutRect.Corners.Add(ToWorld(Rect.Center - SideX - SideY));
+		OutRect.Corners.Add(ToWorld(Rect.Center + SideX - SideY));
+		OutRect.Corners.Add(ToWorld(Rect.Center + SideX + SideY));
+		OutRect.Corners.Add(ToWorld(Rect.Center - SideX + SideY));
+
+		return true;
+	}
+}
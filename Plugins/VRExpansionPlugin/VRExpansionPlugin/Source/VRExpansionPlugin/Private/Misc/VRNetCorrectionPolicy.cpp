@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/VRNetCorrectionPolicy.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Coalesced Client Corrections"), STAT_VRCoalescedClientCorrections, STATGROUP_Game);
+
+void FVRAdaptiveSmoothingSettings::Evaluate(float ErrorDistance, float HistoryWeight, float & OutSmoothTime, float & OutMaxCorrectionSpeed) const
+{
+	const float ErrorAlpha = LargeErrorDistance > SmallErrorDistance ?
+		FMath::Clamp((ErrorDistance - SmallErrorDistance) / (LargeErrorDistance - SmallErrorDistance), 0.0f, 1.0f) :
+		(ErrorDistance > SmallErrorDistance ? 1.0f : 0.0f);
+
+	const float HistoryScale = 1.0f + HistorySmoothTimeScale * FMath::Clamp(HistoryWeight, 0.0f, MaxHistoryWeight);
+
+	OutSmoothTime = FMath::Lerp(SmallErrorSmoothTime, LargeErrorSmoothTime, ErrorAlpha) * HistoryScale;
+
+	// Unlimited on either end stays unlimited rather than blending towards zero
+	if (SmallErrorMaxCorrectionSpeed <= 0.0f || LargeErrorMaxCorrectionSpeed <= 0.0f)
+		OutMaxCorrectionSpeed = 0.0f;
+	else
+		OutMaxCorrectionSpeed = FMath::Lerp(SmallErrorMaxCorrectionSpeed, LargeErrorMaxCorrectionSpeed, ErrorAlpha) / HistoryScale;
+}
+
+float FVRCorrectionHistory::GetWeight(float CurrentTime, float DecayTime) const
+{
+	if (DecayTime <= 0.0f)
+		return 0.0f;
+
+	return Weight * FMath::Max(0.0f, 1.0f - ((CurrentTime - LastCorrectionTime) / DecayTime));
+}
+
+void FVRCorrectionHistory::AddCorrection(float CurrentTime, float DecayTime)
+{
+	Weight = GetWeight(CurrentTime, DecayTime) + 1.0f;
+	LastCorrectionTime = CurrentTime;
+}
+
+bool FVRCorrectionThrottle::ShouldSendCorrection(const FVRCorrectionThrottleSettings & Settings, float ErrorDistance, bool bForceUpdate, float CurrentTime)
+{
+	if (!Settings.bCoalesceSmallCorrections || bForceUpdate || bForcedCorrectionPending || ErrorDistance >= Settings.SmallCorrectionDistance)
+	{
+		Reset();
+		return true;
+	}
+
+	if (!bHasDeferredCorrection)
+	{
+		bHasDeferredCorrection = true;
+		DeferredSince = CurrentTime;
+		NumCoalesced = 1;
+		INC_DWORD_STAT(STAT_VRCoalescedClientCorrections);
+		return false;
+	}
+
+	if (CurrentTime - DeferredSince >= Settings.CoalesceWindow)
+	{
+		Reset();
+		return true;
+	}
+
+	++NumCoalesced;
+	INC_DWORD_STAT(STAT_VRCoalescedClientCorrections);
+	return false;
+}
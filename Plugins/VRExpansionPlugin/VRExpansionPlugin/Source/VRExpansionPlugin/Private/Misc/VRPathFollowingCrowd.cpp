@@ -0,0 +1,223 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/VRPathFollowingCrowd.h"
+#include "VRPathFollowingComponent.h"
+#include "Engine/World.h"
+#include "Engine/Level.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("PathFollowingCrowd Tick"), STAT_PathFollowingCrowdTick, STATGROUP_Game);
+DECLARE_CYCLE_STAT(TEXT("PathFollowingCrowd Evaluate"), STAT_PathFollowingCrowdEvaluate, STATGROUP_Game);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Crowd Path Following Agents"), STAT_PathFollowingCrowdAgents, STATGROUP_Game);
+
+namespace VRPathFollowingCrowdCVars
+{
+	static int32 Batched = 1;
+	FAutoConsoleVariableRef CVarBatched(
+		TEXT("vr.PathFollowingCrowd.Batched"),
+		Batched,
+		TEXT("Evaluate crowd path following agents in one batched pass.\n")
+		TEXT("0: Run each registered agents regular per agent update from the crowd tick, for comparison\n")
+		TEXT("1: Batched (default)"),
+		ECVF_Default);
+}
+
+void FVRPathFollowingCrowdBatch::Evaluate()
+{
+	const int32 NumAgents = Num();
+
+	ToTargets.SetNumUninitialized(NumAgents, false);
+	MoveDirections.SetNumUninitialized(NumAgents, false);
+	ReachResults.SetNumUninitialized(NumAgents, false);
+
+	const FVector * Feet = FeetLocations.GetData();
+	const FVector * Targets = SegmentTargets.GetData();
+	const FVector * Directions = SegmentDirections.GetData();
+	const float * Radii = ReachRadii.GetData();
+
+	for (int32 i = 0; i < NumAgents; ++i)
+	{
+		const FVector ToTarget = Targets[i] - Feet[i];
+		ToTargets[i] = ToTarget;
+		MoveDirections[i] = ToTarget.GetSafeNormal();
+
+		// Same moved too far test as HasReachedCurrentTarget, the radius only rejects so the exact test still decides near the target
+		if (FVector::DotProduct(ToTarget, Directions[i]) < 0.0f)
+			ReachResults[i] = EVRCrowdReachResult::Reached;
+		else if (ToTarget.SizeSquared2D() > FMath::Square(Radii[i]))
+			ReachResults[i] = EVRCrowdReachResult::NotReached;
+		else
+			ReachResults[i] = EVRCrowdReachResult::NeedsExactTest;
+	}
+}
+
+void FVRPathFollowingCrowdTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Target && !Target->IsPendingKill() && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Target->TickCrowd(DeltaTime);
+	}
+}
+
+FString FVRPathFollowingCrowdTickFunction::DiagnosticMessage()
+{
+	return TEXT("UVRPathFollowingCrowdManager[TickCrowd]");
+}
+
+UVRPathFollowingCrowdManager::UVRPathFollowingCrowdManager(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	// Same group the path following components tick in
+	CrowdTickFunction.Target = this;
+	CrowdTickFunction.bCanEverTick = true;
+	CrowdTickFunction.bStartWithTickEnabled = false;
+	CrowdTickFunction.bTickEvenWhenPaused = false;
+	CrowdTickFunction.TickGroup = TG_PrePhysics;
+}
+
+UVRPathFollowingCrowdManager * UVRPathFollowingCrowdManager::Get(UWorld * World, bool bCreateIfMissing)
+{
+	if (!World || !World->IsGameWorld() || !World->PersistentLevel)
+		return nullptr;
+
+	for (UObject * DataObject : World->PerModuleDataObjects)
+	{
+		if (UVRPathFollowingCrowdManager * Manager = Cast<UVRPathFollowingCrowdManager>(DataObject))
+			return Manager;
+	}
+
+	if (!bCreateIfMissing || World->bIsTearingDown)
+		return nullptr;
+
+	UVRPathFollowingCrowdManager * NewManager = NewObject<UVRPathFollowingCrowdManager>(World);
+	World->PerModuleDataObjects.Add(NewManager);
+	NewManager->CrowdTickFunction.RegisterTickFunction(World->PersistentLevel);
+
+	return NewManager;
+}
+
+void UVRPathFollowingCrowdManager::BeginDestroy()
+{
+	if (CrowdTickFunction.IsTickFunctionRegistered())
+		CrowdTickFunction.UnRegisterTickFunction();
+
+	CrowdTickFunction.Target = nullptr;
+
+	for (UVRPathFollowingComponent * Agent : Agents)
+	{
+		if (Agent)
+			Agent->CrowdIndex = INDEX_NONE;
+	}
+
+	Agents.Empty();
+	BatchAgents.Empty();
+	FallbackAgents.Empty();
+	Super::BeginDestroy();
+}
+
+void UVRPathFollowingCrowdManager::RegisterAgent(UVRPathFollowingComponent * Agent)
+{
+	if (!Agent || Agent->CrowdIndex != INDEX_NONE)
+		return;
+
+	Agent->CrowdIndex = Agents.Add(Agent);
+	Agent->CrowdManager = this;
+
+	if (CrowdTickFunction.IsTickFunctionRegistered())
+		CrowdTickFunction.SetTickFunctionEnable(true);
+}
+
+void UVRPathFollowingCrowdManager::UnregisterAgent(UVRPathFollowingComponent * Agent)
+{
+	if (!Agent || !Agents.IsValidIndex(Agent->CrowdIndex) || Agents[Agent->CrowdIndex] != Agent)
+		return;
+
+	const int32 Index = Agent->CrowdIndex;
+	Agents.RemoveAtSwap(Index, 1, false);
+
+	if (Agents.IsValidIndex(Index) && Agents[Index])
+		Agents[Index]->CrowdIndex = Index;
+
+	Agent->CrowdIndex = INDEX_NONE;
+	Agent->CrowdManager.Reset();
+
+	if (!Agents.Num() && CrowdTickFunction.IsTickFunctionRegistered())
+		CrowdTickFunction.SetTickFunctionEnable(false);
+}
+
+void UVRPathFollowingCrowdManager::TickCrowd(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_PathFollowingCrowdTick);
+
+	// Drop anything that went away without unregistering
+	for (int32 i = Agents.Num() - 1; i >= 0; --i)
+	{
+		if (!Agents[i])
+		{
+			Agents.RemoveAtSwap(i, 1, false);
+
+			if (Agents.IsValidIndex(i) && Agents[i])
+				Agents[i]->CrowdIndex = i;
+		}
+	}
+
+	SET_DWORD_STAT(STAT_PathFollowingCrowdAgents, Agents.Num());
+
+	// Finishing a path fires delegates that can register or unregister agents, so work from a copy
+	BatchAgents.Reset();
+	FallbackAgents.Reset();
+	Batch.Reset();
+
+	if (!VRPathFollowingCrowdCVars::Batched)
+	{
+		BatchAgents.Append(Agents);
+		for (UVRPathFollowingComponent * Agent : BatchAgents)
+		{
+			if (Agent->CrowdIndex != INDEX_NONE && !Agent->IsPendingKill())
+				Agent->UpdatePerAgent(DeltaTime);
+		}
+
+		return;
+	}
+
+	FVector FeetLocation, SegmentTarget, SegmentDirection;
+	float ReachRadius;
+
+	for (UVRPathFollowingComponent * Agent : Agents)
+	{
+		if (Agent->GetStatus() != EPathFollowingStatus::Moving)
+			continue;
+
+		// Invalid paths and missing movement go through the regular update so that they abort the same way
+		if (!Agent->GetCrowdSegment(FeetLocation, SegmentTarget, SegmentDirection, ReachRadius))
+		{
+			FallbackAgents.Add(Agent);
+			continue;
+		}
+
+		BatchAgents.Add(Agent);
+		Batch.FeetLocations.Add(FeetLocation);
+		Batch.SegmentTargets.Add(SegmentTarget);
+		Batch.SegmentDirections.Add(SegmentDirection);
+		Batch.ReachRadii.Add(ReachRadius);
+	}
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_PathFollowingCrowdEvaluate);
+		Batch.Evaluate();
+	}
+
+	for (int32 i = 0; i < BatchAgents.Num(); ++i)
+	{
+		UVRPathFollowingComponent * Agent = BatchAgents[i];
+
+		if (Agent->CrowdIndex != INDEX_NONE && !Agent->IsPendingKill())
+			Agent->UpdateFromCrowd(DeltaTime, Batch.FeetLocations[i], Batch.SegmentTargets[i], Batch.ReachResults[i], Batch.ToTargets[i], Batch.MoveDirections[i]);
+	}
+
+	for (UVRPathFollowingComponent * Agent : FallbackAgents)
+	{
+		if (Agent->CrowdIndex != INDEX_NONE && !Agent->IsPendingKill())
+			Agent->UpdatePerAgent(DeltaTime);
+	}
+}
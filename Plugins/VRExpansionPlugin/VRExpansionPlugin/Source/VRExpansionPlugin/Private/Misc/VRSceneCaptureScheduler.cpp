@@ -0,0 +1,214 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/VRSceneCaptureScheduler.h"
+#include "Misc/VRScheduledSceneCaptureComponent2D.h"
+#include "Components/PrimitiveComponent.h"
+#include "Camera/PlayerCameraManager.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "Engine/Level.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("CaptureScheduler Tick"), STAT_CaptureSchedulerTick, STATGROUP_Game);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Scheduled Scene Captures"), STAT_ScheduledSceneCaptures, STATGROUP_Game);
+
+namespace VRCaptureSchedulerCVars
+{
+	static int32 MaxCapturesPerFrame = 2;
+	FAutoConsoleVariableRef CVarMaxCapturesPerFrame(
+		TEXT("vr.CaptureScheduler.MaxCapturesPerFrame"),
+		MaxCapturesPerFrame,
+		TEXT("Maximum number of scheduled scene captures issued per frame."),
+		ECVF_Default);
+}
+
+void FVRSceneCaptureSchedulerTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Target && !Target->IsPendingKill() && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Target->TickScheduler(DeltaTime);
+	}
+}
+
+FString FVRSceneCaptureSchedulerTickFunction::DiagnosticMessage()
+{
+	return TEXT("UVRSceneCaptureScheduler[TickScheduler]");
+}
+
+UVRSceneCaptureScheduler::UVRSceneCaptureScheduler(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	SchedulerTickFunction.Target = this;
+	SchedulerTickFunction.bCanEverTick = true;
+	SchedulerTickFunction.bStartWithTickEnabled = false;
+	SchedulerTickFunction.bTickEvenWhenPaused = false;
+	SchedulerTickFunction.TickGroup = TG_PostUpdateWork;
+	SchedulerTickFunction.EndTickGroup = TG_PostUpdateWork;
+
+	CachedViewTransform = FTransform::Identity;
+}
+
+UVRSceneCaptureScheduler * UVRSceneCaptureScheduler::Get(UWorld * World, bool bCreateIfMissing)
+{
+	if (!World || !World->IsGameWorld() || !World->PersistentLevel)
+		return nullptr;
+
+	for (UObject * DataObject : World->PerModuleDataObjects)
+	{
+		if (UVRSceneCaptureScheduler * Scheduler = Cast<UVRSceneCaptureScheduler>(DataObject))
+			return Scheduler;
+	}
+
+	if (!bCreateIfMissing || World->bIsTearingDown)
+		return nullptr;
+
+	UVRSceneCaptureScheduler * NewScheduler = NewObject<UVRSceneCaptureScheduler>(World);
+	World->PerModuleDataObjects.Add(NewScheduler);
+	NewScheduler->SchedulerTickFunction.RegisterTickFunction(World->PersistentLevel);
+
+	return NewScheduler;
+}
+
+void UVRSceneCaptureScheduler::BeginDestroy()
+{
+	if (SchedulerTickFunction.IsTickFunctionRegistered())
+		SchedulerTickFunction.UnRegisterTickFunction();
+
+	SchedulerTickFunction.Target = nullptr;
+
+	for (UVRScheduledSceneCaptureComponent2D * Capture : Captures)
+	{
+		if (Capture)
+			Capture->ScheduleIndex = INDEX_NONE;
+	}
+
+	Captures.Empty();
+	Scheduler.Entries.Empty();
+	Super::BeginDestroy();
+}
+
+void UVRSceneCaptureScheduler::RegisterCapture(UVRScheduledSceneCaptureComponent2D * Capture)
+{
+	if (!Capture || Capture->ScheduleIndex != INDEX_NONE)
+		return;
+
+	// The scheduler decides when this updates from now on
+	Capture->bCaptureEveryFrame = false;
+	Capture->bCaptureOnMovement = false;
+
+	Capture->ScheduleIndex = Scheduler.Entries.AddDefaulted();
+	Capture->Scheduler = this;
+	Captures.Add(Capture);
+	check(Captures.Num() == Scheduler.Entries.Num());
+
+	if (SchedulerTickFunction.IsTickFunctionRegistered())
+		SchedulerTickFunction.SetTickFunctionEnable(true);
+}
+
+void UVRSceneCaptureScheduler::UnregisterCapture(UVRScheduledSceneCaptureComponent2D * Capture)
+{
+	if (!Capture || !Captures.IsValidIndex(Capture->ScheduleIndex) || Captures[Capture->ScheduleIndex] != Capture)
+		return;
+
+	const int32 Index = Capture->ScheduleIndex;
+	Captures.RemoveAtSwap(Index, 1, false);
+	Scheduler.Entries.RemoveAtSwap(Index, 1, false);
+
+	if (Captures.IsValidIndex(Index) && Captures[Index])
+		Captures[Index]->ScheduleIndex = Index;
+
+	Capture->ScheduleIndex = INDEX_NONE;
+	Capture->Scheduler.Reset();
+
+	if (!Captures.Num() && SchedulerTickFunction.IsTickFunctionRegistered())
+		SchedulerTickFunction.SetTickFunctionEnable(false);
+}
+
+void UVRSceneCaptureScheduler::RequestCapture(UVRScheduledSceneCaptureComponent2D * Capture)
+{
+	if (Capture && Captures.IsValidIndex(Capture->ScheduleIndex) && Captures[Capture->ScheduleIndex] == Capture)
+		Scheduler.Entries[Capture->ScheduleIndex].bHasCaptured = false;
+}
+
+float UVRSceneCaptureScheduler::GetTimeSinceLastCapture(const UVRScheduledSceneCaptureComponent2D * Capture) const
+{
+	if (!Capture || !Captures.IsValidIndex(Capture->ScheduleIndex) || Captures[Capture->ScheduleIndex] != Capture)
+		return -1.0f;
+
+	const FVRCaptureScheduleEntry & Entry = Scheduler.Entries[Capture->ScheduleIndex];
+	if (!Entry.bHasCaptured)
+		return -1.0f;
+
+	UWorld * World = GetTypedOuter<UWorld>();
+	return World ? World->GetTimeSeconds() - Entry.LastCaptureTime : -1.0f;
+}
+
+void UVRSceneCaptureScheduler::UpdateCachedView()
+{
+	CachedView.bIsValid = false;
+
+	UWorld * World = GetTypedOuter<UWorld>();
+	APlayerController * Player = World ? World->GetFirstPlayerController() : nullptr;
+
+	if (!Player || !Player->IsLocalController() || !Player->PlayerCameraManager)
+		return;
+
+	// The camera manager already has the HMD applied to the camera component by this tick group
+	const FRotator ViewRotation = Player->PlayerCameraManager->GetCameraRotation();
+	CachedView.Location = Player->PlayerCameraManager->GetCameraLocation();
+	CachedView.Forward = ViewRotation.Vector();
+	CachedView.TanHalfFOV = FMath::Tan(FMath::DegreesToRadians(FMath::Clamp(Player->PlayerCameraManager->GetFOVAngle(), 1.0f, 170.0f) * 0.5f));
+	CachedView.bIsValid = true;
+
+	CachedViewTransform = FTransform(ViewRotation, CachedView.Location);
+}
+
+void UVRSceneCaptureScheduler::TickScheduler(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_CaptureSchedulerTick);
+
+	UpdateCachedView();
+
+	// Drop anything that went away without unregistering so it can't take up the budget
+	for (int32 i = Captures.Num() - 1; i >= 0; --i)
+	{
+		if (!Captures[i])
+		{
+			Captures.RemoveAtSwap(i, 1, false);
+			Scheduler.Entries.RemoveAtSwap(i, 1, false);
+
+			if (Captures.IsValidIndex(i) && Captures[i])
+				Captures[i]->ScheduleIndex = i;
+		}
+	}
+
+	for (int32 i = 0; i < Captures.Num(); ++i)
+	{
+		UVRScheduledSceneCaptureComponent2D * Capture = Captures[i];
+		FVRCaptureScheduleEntry & Entry = Scheduler.Entries[i];
+
+		Entry.Settings = Capture->ScheduleSettings;
+
+		if (Capture->DisplaySurface)
+		{
+			Entry.Center = Capture->DisplaySurface->Bounds.Origin;
+			Entry.Radius = Capture->DisplaySurface->Bounds.SphereRadius;
+		}
+		else
+		{
+			Entry.Center = Capture->GetComponentLocation();
+			Entry.Radius = Capture->DefaultDisplayRadius;
+		}
+	}
+
+	UWorld * World = GetTypedOuter<UWorld>();
+	const float CurrentTime = World ? World->GetTimeSeconds() : 0.0f;
+
+	Scheduler.SelectCaptures(CachedView, CurrentTime, VRCaptureSchedulerCVars::MaxCapturesPerFrame, SelectedCaptures);
+
+	for (int32 Index : SelectedCaptures)
+	{
+		Captures[Index]->CaptureSceneDeferred();
+		INC_DWORD_STAT(STAT_ScheduledSceneCaptures);
+	}
+}
@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/VRScheduledSceneCaptureComponent2D.h"
+#include "Misc/VRSceneCaptureScheduler.h"
+
+UVRScheduledSceneCaptureComponent2D::UVRScheduledSceneCaptureComponent2D(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	DisplaySurface = nullptr;
+	DefaultDisplayRadius = 50.0f;
+	ScheduleIndex = INDEX_NONE;
+}
+
+void UVRScheduledSceneCaptureComponent2D::OnRegister()
+{
+	Super::OnRegister();
+
+	if (UVRSceneCaptureScheduler * CaptureScheduler = UVRSceneCaptureScheduler::Get(GetWorld()))
+		CaptureScheduler->RegisterCapture(this);
+}
+
+void UVRScheduledSceneCaptureComponent2D::OnUnregister()
+{
+	if (Scheduler.IsValid())
+		Scheduler->UnregisterCapture(this);
+
+	Super::OnUnregister();
+}
+
+void UVRScheduledSceneCaptureComponent2D::RequestCapture()
+{
+	if (Scheduler.IsValid())
+		Scheduler->RequestCapture(this);
+	else
+		CaptureSceneDeferred();
+}
+
+float UVRScheduledSceneCaptureComponent2D::GetTimeSinceLastCapture() const
+{
+	return Scheduler.IsValid() ? Scheduler->GetTimeSinceLastCapture(this) : -1.0f;
+}
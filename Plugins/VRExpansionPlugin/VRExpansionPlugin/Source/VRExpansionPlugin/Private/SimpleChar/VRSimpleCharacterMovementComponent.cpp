@@ -1307,6 +1307,8 @@ void UVRSimpleCharacterMovementComponent::ReplicateMoveToServer(float DeltaTime,
 		return;
 	}
 
+	PrewarmSavedMovePoolOnce(*ClientData);
+
 	// Update our delta time for physics simulation.
 	DeltaTime = ClientData->UpdateTimeStampAndDeltaTime(DeltaTime, *CharacterOwner, *this);
 
@@ -1736,6 +1738,7 @@ void UVRSimpleCharacterMovementComponent::ServerMoveVR_Implementation(
 
 		CustomVRInputVector = ConditionalReps.CustomVRInputVector;//CustVRInputVector;
 		MoveActionArray = ConditionalReps.MoveActionArray;
+		ClimbingGrips = ConditionalReps.ClimbingGrips;
 
 		MoveAutonomous(TimeStamp, DeltaTime, MoveFlags, Accel);
 		bHasRequestedVelocity = false;
@@ -0,0 +1,501 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+#include "HAL/PlatformTime.h"
+#include "Animation/ArmSolver.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace ArmSolverTests
+{
+	const float Tolerance = 1.e-2f;
+
+	// One rig with the head at standing height looking down +X, upper and lower arm lengths differ so each bone is checked on its own
+	int32 AddRig(FArmSolverBatch & Batch, const FArmSolverElbowSettings & Settings = FArmSolverElbowSettings())
+	{
+		const int32 Index = Batch.Add();
+		Batch.HeadTransforms[Index] = FTransform(FVector(0.0f, 0.0f, 170.0f));
+		Batch.UpperArmLengths[Index] = 32.0f;
+		Batch.LowerArmLengths[Index] = 28.0f;
+		Batch.Settings[Index] = Settings;
+		return Index;
+	}
+
+	bool ContainsNaN(const FArmSolverBatch & Batch, int32 Side, int32 Index)
+	{
+		return Batch.ShoulderPositions[Side][Index].ContainsNaN() || Batch.ElbowPositions[Side][Index].ContainsNaN() || Batch.HandPositions[Side][Index].ContainsNaN();
+	}
+
+	struct FPoseSample
+	{
+		FTransform Head;
+		FTransform Hands[2];
+	};
+
+	const float RecordRate = 90.0f;
+
+	// Hand positions relative to the head for the left hand, x forward, y right, z up. The right hand mirrors them
+	const FVector KeyPoses[] = {
+		FVector(10.0f, -25.0f, -75.0f),		// Resting at the side
+		FVector(55.0f, -20.0f, -25.0f),		// Reaching out front, just past the arm length
+		FVector(25.0f, -20.0f, 20.0f),		// Up above the head
+		FVector(30.0f, 20.0f, -35.0f),		// Across the chest
+		FVector(5.0f, -65.0f, -30.0f),		// Out to the side
+		FVector(-15.0f, -22.0f, -70.0f),	// Behind the hip
+		FVector(90.0f, -20.0f, -20.0f),		// Well out of reach
+		FVector(10.0f, -25.0f, -75.0f)
+	};
+
+	/*
+	* Stands in for a capture of a player, walking and looking around while the hands move through the key poses
+	* with a little tracking noise. Ends on a couple of seconds of standing still so every replay settles the same.
+	*/
+	TArray<FPoseSample> RecordPoseStream(uint32 Seed)
+	{
+		FRandomStream Random(Seed);
+		const float PoseTime = 1.5f;
+		const int32 NumPoses = ARRAY_COUNT(KeyPoses);
+		const float MoveDuration = PoseTime * (NumPoses - 1);
+		const int32 NumSamples = FMath::CeilToInt((MoveDuration + 2.0f) * RecordRate);
+
+		TArray<FPoseSample> Samples;
+		Samples.SetNum(NumSamples);
+
+		for (int32 i = 0; i < NumSamples; ++i)
+		{
+			const float Time = FMath::Min(i / RecordRate, MoveDuration);
+			const int32 Pose = FMath::Min(FMath::FloorToInt(Time / PoseTime), NumPoses - 2);
+			const float Alpha = FMath::SmoothStep(0.0f, 1.0f, (Time - Pose * PoseTime) / PoseTime);
+			const FVector LocalLeft = FMath::Lerp(KeyPoses[Pose], KeyPoses[Pose + 1], Alpha);
+
+			const FRotator HeadRotation(10.0f * FMath::Sin(Time * 0.7f), 40.0f * FMath::Sin(Time * 0.5f), 0.0f);
+			const FVector HeadLocation(Time * 30.0f, 20.0f * FMath::Sin(Time * 0.3f), 170.0f + 3.0f * FMath::Sin(Time * 4.0f));
+			const FRotator HeadYaw(0.0f, HeadRotation.Yaw, 0.0f);
+
+			FPoseSample & Sample = Samples[i];
+			Sample.Head = FTransform(HeadRotation, HeadLocation + Random.VRand() * 0.05f);
+			Sample.Hands[0] = FTransform(HeadLocation + HeadYaw.RotateVector(LocalLeft) + Random.VRand() * 0.05f);
+			Sample.Hands[1] = FTransform(HeadLocation + HeadYaw.RotateVector(FVector(LocalLeft.X, -LocalLeft.Y, LocalLeft.Z)) + Random.VRand() * 0.05f);
+		}
+
+		return Samples;
+	}
+
+	void ApplySample(FArmSolverBatch & Batch, int32 Rig, const FPoseSample & Sample)
+	{
+		Batch.HeadTransforms[Rig] = Sample.Head;
+		Batch.HandTransforms[0][Rig] = Sample.Hands[0];
+		Batch.HandTransforms[1][Rig] = Sample.Hands[1];
+	}
+
+	struct FContinuityResult
+	{
+		int32 NumFrames = 0;
+		int32 NumAngleJumps = 0;
+		int32 NumElbowPops = 0;
+		float MaxElbowStep = 0.0f;
+		bool bHasNaN = false;
+		FVector FinalElbows[2];
+	};
+
+	/*
+	* Replays a stream frame by frame, checking that the elbow angle never moves faster than its interp speed and that the elbow
+	* never moves much further than the shoulder and hand that carry it. A flip of the elbow around the arm shows up as a pop.
+	*/
+	FContinuityResult ReplayStream(const TArray<FPoseSample> & Samples, TFunctionRef<float(int32)> GetDeltaTime)
+	{
+		FArmSolverBatch Batch;
+		const int32 Rig = AddRig(Batch);
+		const FArmSolverElbowSettings & Settings = Batch.Settings[Rig];
+		const float UpperLength = Batch.UpperArmLengths[Rig];
+
+		FContinuityResult Result;
+		float Time = 0.0f;
+		const float EndTime = (Samples.Num() - 1) / RecordRate;
+
+		ApplySample(Batch, Rig, Samples[0]);
+		ArmSolver::SolveBatch(Batch, 0.0f);
+
+		while (Time < EndTime)
+		{
+			const float DeltaTime = GetDeltaTime(Result.NumFrames);
+			Time = FMath::Min(Time + DeltaTime, EndTime);
+
+			FVector PrevShoulders[2], PrevElbows[2], PrevHands[2];
+			float PrevAngles[2];
+			for (int32 Side = 0; Side < 2; ++Side)
+			{
+				PrevShoulders[Side] = Batch.ShoulderPositions[Side][Rig];
+				PrevElbows[Side] = Batch.ElbowPositions[Side][Rig];
+				PrevHands[Side] = Batch.HandPositions[Side][Rig];
+				PrevAngles[Side] = Batch.ElbowAngles[Side][Rig];
+			}
+
+			ApplySample(Batch, Rig, Samples[FMath::Min(FMath::RoundToInt(Time * RecordRate), Samples.Num() - 1)]);
+			ArmSolver::SolveBatch(Batch, DeltaTime);
+			++Result.NumFrames;
+
+			const float MaxAngleStep = Settings.elbowAngleInterpSpeed * DeltaTime;
+			for (int32 Side = 0; Side < 2; ++Side)
+			{
+				Result.bHasNaN |= ContainsNaN(Batch, Side, Rig);
+
+				const float AngleStep = FMath::Abs(FMath::FindDeltaAngleDegrees(PrevAngles[Side], Batch.ElbowAngles[Side][Rig]));
+				if (AngleStep > MaxAngleStep + KINDA_SMALL_NUMBER)
+					++Result.NumAngleJumps;
+
+				const float CarrierStep = FVector::Dist(PrevShoulders[Side], Batch.ShoulderPositions[Side][Rig]) + FVector::Dist(PrevHands[Side], Batch.HandPositions[Side][Rig]);
+				const float ElbowStep = FVector::Dist(PrevElbows[Side], Batch.ElbowPositions[Side][Rig]);
+				Result.MaxElbowStep = FMath::Max(Result.MaxElbowStep, ElbowStep);
+
+				if (ElbowStep > CarrierStep * 4.0f + UpperLength * FMath::DegreesToRadians(MaxAngleStep) + 0.1f)
+					++Result.NumElbowPops;
+			}
+		}
+
+		Result.FinalElbows[0] = Batch.ElbowPositions[0][Rig];
+		Result.FinalElbows[1] = Batch.ElbowPositions[1][Rig];
+		return Result;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FArmSolverReachTest, "VRExpansionPlugin.ArmSolver.Reach", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FArmSolverReachTest::RunTest(const FString& Parameters)
+{
+	using namespace ArmSolverTests;
+
+	FArmSolverBatch Batch;
+	const int32 Rig = AddRig(Batch);
+	const float UpperLength = Batch.UpperArmLengths[Rig];
+	const float LowerLength = Batch.LowerArmLengths[Rig];
+	const float ArmLength = UpperLength + LowerLength;
+
+	{
+		// Straight out in front and far past what either arm can reach
+		Batch.HandTransforms[0][Rig] = FTransform(FVector(500.0f, -18.0f, 145.0f));
+		Batch.HandTransforms[1][Rig] = FTransform(FVector(500.0f, 18.0f, 145.0f));
+		ArmSolver::SolveBatch(Batch, 0.0f);
+
+		for (int32 Side = 0; Side < 2; ++Side)
+		{
+			const FVector & Shoulder = Batch.ShoulderPositions[Side][Rig];
+			const FVector & Hand = Batch.HandPositions[Side][Rig];
+			const FVector ToTarget = (Batch.HandTransforms[Side][Rig].GetLocation() - Shoulder).GetSafeNormal();
+
+			TestTrue(TEXT("Out of reach hands are flagged"), Batch.ReachClamped[Side][Rig]);
+			TestEqual(TEXT("Out of reach hands stop at the arm length"), FVector::Dist(Shoulder, Hand), ArmLength, Tolerance);
+			TestTrue(TEXT("Out of reach hands stay on the line to the target"), ((Hand - Shoulder).GetSafeNormal() | ToTarget) > 1.0f - KINDA_SMALL_NUMBER);
+			TestEqual(TEXT("A fully stretched arm keeps its upper length"), FVector::Dist(Shoulder, Batch.ElbowPositions[Side][Rig]), UpperLength, Tolerance);
+			TestEqual(TEXT("A fully stretched arm keeps its lower length"), FVector::Dist(Batch.ElbowPositions[Side][Rig], Hand), LowerLength, Tolerance);
+		}
+	}
+
+	{
+		// Every direction and distance around the body, both in and out of reach
+		FRandomStream Random(0xA12);
+		int32 NumFailures = 0;
+
+		for (int32 Iteration = 0; Iteration < 2000 && NumFailures < 10; ++Iteration)
+		{
+			const FVector Chest(-8.0f, 0.0f, 145.0f);
+			Batch.HandTransforms[0][Rig] = FTransform(Chest + Random.VRand() * Random.FRandRange(0.0f, ArmLength * 1.5f));
+			Batch.HandTransforms[1][Rig] = FTransform(Chest + Random.VRand() * Random.FRandRange(0.0f, ArmLength * 1.5f));
+			ArmSolver::SolveBatch(Batch, 0.0f);
+
+			for (int32 Side = 0; Side < 2; ++Side)
+			{
+				const FVector & Shoulder = Batch.ShoulderPositions[Side][Rig];
+				const FVector & Elbow = Batch.ElbowPositions[Side][Rig];
+				const FVector & Hand = Batch.HandPositions[Side][Rig];
+				const FVector Target = Batch.HandTransforms[Side][Rig].GetLocation();
+				const float TargetDistance = FVector::Dist(Shoulder, Target);
+
+				bool bFailed = ContainsNaN(Batch, Side, Rig);
+				bFailed |= Batch.ReachClamped[Side][Rig] != (TargetDistance > ArmLength);
+				bFailed |= FVector::Dist(Shoulder, Hand) > ArmLength + Tolerance;
+				bFailed |= !FMath::IsNearlyEqual(FVector::Dist(Shoulder, Elbow), UpperLength, Tolerance);
+
+				// The hand is only moved when it is out of reach
+				if (!Batch.ReachClamped[Side][Rig])
+					bFailed |= !Hand.Equals(Target, Tolerance);
+
+				// Closer in than the difference of the bones the lower arm can't meet the hand
+				if (TargetDistance >= FMath::Abs(UpperLength - LowerLength) + Tolerance)
+					bFailed |= !FMath::IsNearlyEqual(FVector::Dist(Elbow, Hand), LowerLength, Tolerance);
+
+				if (bFailed)
+				{
+					AddError(FString::Printf(TEXT("Side %d with the target %.2f from the shoulder solved upper %.3f lower %.3f reach %.3f"), Side, TargetDistance,
+						FVector::Dist(Shoulder, Elbow), FVector::Dist(Elbow, Hand), FVector::Dist(Shoulder, Hand)));
+					++NumFailures;
+				}
+			}
+		}
+	}
+
+	{
+		// Hand right on the shoulder, the two bone solve has nothing to work with
+		ArmSolver::SolveBatch(Batch, 0.0f);
+		Batch.HandTransforms[1][Rig] = FTransform(Batch.ShoulderPositions[1][Rig]);
+		Batch.ResetState(Rig);
+		ArmSolver::SolveBatch(Batch, 0.0f);
+
+		TestFalse(TEXT("A hand on the shoulder solves without NaNs"), ContainsNaN(Batch, 1, Rig));
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FArmSolverElbowClampTest, "VRExpansionPlugin.ArmSolver.ElbowClamp", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FArmSolverElbowClampTest::RunTest(const FString& Parameters)
+{
+	using namespace ArmSolverTests;
+
+	FArmSolverElbowSettings Settings;
+
+	{
+		Settings.softClampElbowAngle = false;
+		const ArmSolver Solver(Settings);
+
+		TestEqual(TEXT("Hard clamp stops at the min angle"), Solver.ClampElbowAngle(Settings.minAngle - 50.0f), Settings.minAngle);
+		TestEqual(TEXT("Hard clamp stops at the max angle"), Solver.ClampElbowAngle(Settings.maxAngle + 50.0f), Settings.maxAngle);
+		TestEqual(TEXT("Hard clamp leaves angles inside the limits alone"), Solver.ClampElbowAngle(90.0f), 90.0f);
+	}
+
+	{
+		Settings.softClampElbowAngle = true;
+		const ArmSolver Solver(Settings);
+		const float SoftMin = Settings.minAngle + Settings.softClampRange;
+		const float SoftMax = Settings.maxAngle - Settings.softClampRange;
+
+		TestEqual(TEXT("Soft clamp leaves the middle alone"), Solver.ClampElbowAngle(90.0f), 90.0f);
+		TestEqual(TEXT("Soft clamp starts without a jump at the bottom"), Solver.ClampElbowAngle(SoftMin), SoftMin, KINDA_SMALL_NUMBER);
+		TestEqual(TEXT("Soft clamp starts without a jump at the top"), Solver.ClampElbowAngle(SoftMax), SoftMax, KINDA_SMALL_NUMBER);
+
+		// Never past the limits, and never turning back on itself
+		float Previous = -BIG_NUMBER;
+		bool bWithinLimits = true, bMonotonic = true;
+
+		for (float Angle = -720.0f; Angle <= 720.0f; Angle += 0.5f)
+		{
+			const float Clamped = Solver.ClampElbowAngle(Angle);
+			bWithinLimits &= Clamped >= Settings.minAngle && Clamped <= Settings.maxAngle;
+			bMonotonic &= Clamped >= Previous;
+			Previous = Clamped;
+		}
+
+		TestTrue(TEXT("Soft clamp stays within the limits"), bWithinLimits);
+		TestTrue(TEXT("Soft clamp never reverses"), bMonotonic);
+	}
+
+	{
+		Settings.clampElbowAngle = false;
+		const ArmSolver Solver(Settings);
+		TestEqual(TEXT("Without clamping angles pass through"), Solver.ClampElbowAngle(400.0f), 400.0f);
+		Settings.clampElbowAngle = true;
+	}
+
+	{
+		Settings.calcElbowAngle = false;
+		const ArmSolver Solver(Settings);
+		TestEqual(TEXT("Without calculating the offset angle is used as is"), Solver.GetElbowTargetAngle(FVector(0.3f, -0.2f, 0.5f), false), Settings.offsetAngle);
+		Settings.calcElbowAngle = true;
+	}
+
+	{
+		const ArmSolver Solver(Settings);
+		FRandomStream Random(0xE1B);
+		bool bWithinLimits = true;
+
+		for (int32 Iteration = 0; Iteration < 2000; ++Iteration)
+		{
+			const FVector LocalHand(Random.FRandRange(-1.5f, 1.5f), Random.FRandRange(-1.5f, 1.5f), Random.FRandRange(-1.5f, 1.5f));
+			const float Angle = Solver.GetElbowTargetAngle(LocalHand, Random.GetFraction() < 0.5f);
+			bWithinLimits &= Angle >= Settings.minAngle && Angle <= Settings.maxAngle;
+		}
+
+		TestTrue(TEXT("Target angles anywhere around the shoulder stay within the limits"), bWithinLimits);
+	}
+
+	{
+		// 0 puts the elbow above the shoulder to hand axis, 90 out to the side of the arm
+		FArmSolverElbowSettings Fixed;
+		Fixed.calcElbowAngle = false;
+		Fixed.clampElbowAngle = false;
+
+		FArmSolverBatch Batch;
+		const int32 Rig = AddRig(Batch, Fixed);
+		Batch.HandTransforms[0][Rig] = FTransform(FVector(30.0f, -18.0f, 145.0f));
+		Batch.HandTransforms[1][Rig] = FTransform(FVector(30.0f, 18.0f, 145.0f));
+
+		Batch.Settings[Rig].offsetAngle = 0.0f;
+		ArmSolver::SolveBatch(Batch, 0.0f);
+
+		for (int32 Side = 0; Side < 2; ++Side)
+		{
+			const FVector Middle = (Batch.ShoulderPositions[Side][Rig] + Batch.HandPositions[Side][Rig]) * 0.5f;
+			TestTrue(TEXT("An elbow angle of 0 points the elbow up"), Batch.ElbowPositions[Side][Rig].Z > Middle.Z);
+		}
+
+		Batch.Settings[Rig].offsetAngle = 90.0f;
+		Batch.ResetState(Rig);
+		ArmSolver::SolveBatch(Batch, 0.0f);
+
+		TestTrue(TEXT("An elbow angle of 90 points the left elbow out to the left"), Batch.ElbowPositions[0][Rig].Y < ((Batch.ShoulderPositions[0][Rig].Y + Batch.HandPositions[0][Rig].Y) * 0.5f));
+		TestTrue(TEXT("An elbow angle of 90 points the right elbow out to the right"), Batch.ElbowPositions[1][Rig].Y > ((Batch.ShoulderPositions[1][Rig].Y + Batch.HandPositions[1][Rig].Y) * 0.5f));
+	}
+
+	{
+		// With state the elbow turns towards a new target at the interp speed instead of snapping
+		FArmSolverBatch Batch;
+		const int32 Rig = AddRig(Batch);
+		const float DeltaTime = 1.0f / 90.0f;
+		const float MaxStep = Batch.Settings[Rig].elbowAngleInterpSpeed * DeltaTime;
+
+		Batch.HandTransforms[1][Rig] = FTransform(FVector(30.0f, 18.0f, 110.0f));
+		ArmSolver::SolveBatch(Batch, DeltaTime);
+		const float StartAngle = Batch.ElbowAngles[1][Rig];
+
+		// Low and close to reaching up and out front swings the target angle by far more than one step
+		Batch.HandTransforms[1][Rig] = FTransform(FVector(40.0f, 18.0f, 185.0f));
+		ArmSolver::SolveBatch(Batch, DeltaTime);
+		const float Step = FMath::Abs(Batch.ElbowAngles[1][Rig] - StartAngle);
+
+		TestTrue(FString::Printf(TEXT("The elbow angle moves at most its interp speed per solve (%.2f of %.2f)"), Step, MaxStep), Step > 0.0f && Step <= MaxStep + KINDA_SMALL_NUMBER);
+
+		Batch.ResetState(Rig);
+		ArmSolver::SolveBatch(Batch, DeltaTime);
+
+		TestTrue(TEXT("Resetting the state snaps the elbow to its clamped target"), Batch.ElbowAngles[1][Rig] >= Settings.minAngle && Batch.ElbowAngles[1][Rig] <= Settings.maxAngle && FMath::Abs(Batch.ElbowAngles[1][Rig] - StartAngle) > MaxStep);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FArmSolverContinuityTest, "VRExpansionPlugin.ArmSolver.Continuity", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FArmSolverContinuityTest::RunTest(const FString& Parameters)
+{
+	using namespace ArmSolverTests;
+
+	const uint32 Seeds[] = { 0xC0A, 0xC0B, 0xC0C };
+	for (uint32 Seed : Seeds)
+	{
+		const TArray<FPoseSample> Samples = RecordPoseStream(Seed);
+
+		// At the rate it was recorded, then with the frame times bouncing around and the odd hitch
+		const FContinuityResult Steady = ReplayStream(Samples, [](int32 Frame) { return 1.0f / RecordRate; });
+
+		FRandomStream Random(Seed);
+		const FContinuityResult Jittered = ReplayStream(Samples, [&Random](int32 Frame) { return Frame % 97 == 96 ? 0.1f : Random.FRandRange(1.0f / 144.0f, 1.0f / 45.0f); });
+
+		for (const FContinuityResult * Result : { &Steady, &Jittered })
+		{
+			const TCHAR * Name = Result == &Steady ? TEXT("steady") : TEXT("jittered");
+			AddInfo(FString::Printf(TEXT("Stream %x %s: %d frames, largest elbow step %.2f"), Seed, Name, Result->NumFrames, Result->MaxElbowStep));
+
+			TestFalse(FString::Printf(TEXT("Stream %x %s solves without NaNs"), Seed, Name), Result->bHasNaN);
+			TestEqual(FString::Printf(TEXT("Stream %x %s never turns the elbow faster than its interp speed"), Seed, Name), Result->NumAngleJumps, 0);
+			TestEqual(FString::Printf(TEXT("Stream %x %s never pops the elbow"), Seed, Name), Result->NumElbowPops, 0);
+		}
+
+		// Both replays end standing still on the same pose
+		for (int32 Side = 0; Side < 2; ++Side)
+		{
+			TestTrue(FString::Printf(TEXT("Stream %x settles the same at any frame rate"), Seed), Steady.FinalElbows[Side].Equals(Jittered.FinalElbows[Side], 0.1f));
+		}
+	}
+
+	{
+		// Rigs only touch their own index, splitting the batch up can't change the result
+		const TArray<FPoseSample> Samples = RecordPoseStream(0xC0D);
+		FArmSolverBatch Serial, Parallel;
+		for (int32 i = 0; i < 32; ++i)
+		{
+			AddRig(Serial);
+			AddRig(Parallel);
+		}
+
+		bool bMatches = true;
+		for (int32 Frame = 0; Frame < 180; ++Frame)
+		{
+			for (int32 Rig = 0; Rig < Serial.Num(); ++Rig)
+			{
+				const FPoseSample & Sample = Samples[(Frame + Rig * 17) % Samples.Num()];
+				ApplySample(Serial, Rig, Sample);
+				ApplySample(Parallel, Rig, Sample);
+			}
+
+			ArmSolver::SolveBatch(Serial, 1.0f / RecordRate, 0);
+			ArmSolver::SolveBatch(Parallel, 1.0f / RecordRate, 1);
+
+			for (int32 Rig = 0; Rig < Serial.Num(); ++Rig)
+			{
+				for (int32 Side = 0; Side < 2; ++Side)
+				{
+					bMatches &= Serial.ElbowPositions[Side][Rig] == Parallel.ElbowPositions[Side][Rig];
+					bMatches &= Serial.ShoulderPositions[Side][Rig] == Parallel.ShoulderPositions[Side][Rig];
+				}
+			}
+		}
+
+		TestTrue(TEXT("Parallel solves match the serial ones"), bMatches);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FArmSolverBenchmark, "VRExpansionPlugin.ArmSolver.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FArmSolverBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace ArmSolverTests;
+
+	const TArray<FPoseSample> Samples = RecordPoseStream(0xBE4);
+	const int32 RigCounts[] = { 1, 16, 128 };
+	const int32 NumFrames = 900;
+
+	// 16 is the vr.ArmSolver.ParallelThreshold default
+	const int32 Thresholds[] = { 0, 16 };
+
+	for (int32 NumRigs : RigCounts)
+	{
+		double MicrosecondsPerRig[2];
+
+		for (int32 Mode = 0; Mode < 2; ++Mode)
+		{
+			FArmSolverBatch Batch;
+			for (int32 i = 0; i < NumRigs; ++i)
+			{
+				AddRig(Batch);
+			}
+
+			double SolveSeconds = 0.0;
+			for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+			{
+				// Every rig at its own point of the stream so they don't all take the same branches
+				for (int32 Rig = 0; Rig < NumRigs; ++Rig)
+				{
+					ApplySample(Batch, Rig, Samples[(Frame + Rig * 37) % Samples.Num()]);
+				}
+
+				const double StartTime = FPlatformTime::Seconds();
+				ArmSolver::SolveBatch(Batch, 1.0f / RecordRate, Thresholds[Mode]);
+				SolveSeconds += FPlatformTime::Seconds() - StartTime;
+			}
+
+			MicrosecondsPerRig[Mode] = SolveSeconds * 1000000.0 / (double(NumFrames) * NumRigs);
+		}
+
+		AddInfo(FString::Printf(TEXT("%d rigs: %.3f us per rig on the game thread, %.3f us per rig at the default parallel threshold"), NumRigs, MicrosecondsPerRig[0], MicrosecondsPerRig[1]));
+		TestTrue(FString::Printf(TEXT("%d rigs: the solve is timed"), NumRigs), MicrosecondsPerRig[0] > 0.0 && MicrosecondsPerRig[1] > 0.0);
+	}
+
+	return true;
+}
+
+#endif
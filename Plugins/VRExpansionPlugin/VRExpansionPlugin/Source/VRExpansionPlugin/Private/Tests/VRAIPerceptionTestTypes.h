@@ -0,0 +1,42 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/VRAIPerceptionOverrides.h"
+#include "VRAIPerceptionTestTypes.generated.h"
+
+// Sight sense that lets the tests run the broadphase and sort steps without a perception system
+UCLASS(Transient, NotBlueprintable, NotBlueprintType, HideDropdown)
+class UAISense_Sight_VRTestDriver : public UAISense_Sight_VR
+{
+	GENERATED_BODY()
+public:
+
+	void SetBroadphase(bool bEnabled, float CellSize, float RangePadding)
+	{
+		bUseSightBroadphase = bEnabled;
+		BroadphaseCellSize = CellSize;
+		BroadphaseRangePadding = RangePadding;
+	}
+
+	float GetBroadphaseRangePadding() const { return BroadphaseRangePadding; }
+
+	bool IsInRange(const FVector & ListenerLocation, const FDigestedSightProperties & PropDigest, const FVector & TargetLocation) const
+	{
+		return IsInBroadphaseRange(ListenerLocation, PropDigest, TargetLocation);
+	}
+
+	bool CanDrop(const FAISightQueryVR & SightQuery, const FVector & ListenerLocation, const FDigestedSightProperties & PropDigest, const FVector & TargetLocation) const
+	{
+		return CanDropOutOfRangeQuery(SightQuery, ListenerLocation, PropDigest, TargetLocation);
+	}
+
+	// Sorts the given queue the way the sense sorts its own
+	void Sort(TArray<FAISightQueryVR> & Queries)
+	{
+		Swap(SightQueryQueue, Queries);
+		SortQueries();
+		Swap(SightQueryQueue, Queries);
+	}
+};
@@ -0,0 +1,410 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+#include "HAL/PlatformTime.h"
+#include "UObject/Package.h"
+#include "Misc/VRAIPerceptionOverrides.h"
+#include "Tests/VRAIPerceptionTestTypes.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace VRAIPerceptionTests
+{
+	typedef UAISense_Sight_VR::FDigestedSightProperties FSightDigest;
+
+	UAISense_Sight_VRTestDriver * MakeSense()
+	{
+		return NewObject<UAISense_Sight_VRTestDriver>(GetTransientPackage(), NAME_None, RF_Transient);
+	}
+
+	FSightDigest MakeDigest(float SightRadius, float LoseSightRadius, float AutoSuccessRange = FAISystem::InvalidRange)
+	{
+		UAISenseConfig_Sight_VR * Config = NewObject<UAISenseConfig_Sight_VR>(GetTransientPackage(), NAME_None, RF_Transient);
+		Config->SightRadius = SightRadius;
+		Config->LoseSightRadius = LoseSightRadius;
+		Config->AutoSuccessRangeFromLastSeenLocation = AutoSuccessRange;
+		return FSightDigest(*Config);
+	}
+
+	// Targets spread over a play area, Z kept low like characters on a few floors
+	TArray<FVector> MakeLocations(FRandomStream & Random, int32 Num, float HalfExtent)
+	{
+		TArray<FVector> Locations;
+		for (int32 i = 0; i < Num; ++i)
+		{
+			Locations.Add(FVector(Random.FRandRange(-HalfExtent, HalfExtent), Random.FRandRange(-HalfExtent, HalfExtent), Random.FRandRange(-500.f, 1500.f)));
+		}
+		return Locations;
+	}
+
+	void BuildGrid(FAISightTargetGridVR & Grid, float CellSize, const TArray<FVector> & Targets)
+	{
+		Grid.Reset(CellSize);
+		for (int32 i = 0; i < Targets.Num(); ++i)
+		{
+			Grid.AddTarget(i, Targets[i]);
+		}
+	}
+
+	// What the sense would have created without the broadphase, every pair in range
+	int32 CountPairsBruteForce(const UAISense_Sight_VRTestDriver * Sense, const FSightDigest & Digest, const TArray<FVector> & Listeners, const TArray<FVector> & Targets, TSet<uint64> * OutPairs = nullptr)
+	{
+		int32 NumPairs = 0;
+		for (int32 ListenerIndex = 0; ListenerIndex < Listeners.Num(); ++ListenerIndex)
+		{
+			for (int32 TargetIndex = 0; TargetIndex < Targets.Num(); ++TargetIndex)
+			{
+				if (Sense->IsInRange(Listeners[ListenerIndex], Digest, Targets[TargetIndex]))
+				{
+					++NumPairs;
+					if (OutPairs)
+						OutPairs->Add(((uint64)ListenerIndex << 32) | (uint64)TargetIndex);
+				}
+			}
+		}
+		return NumPairs;
+	}
+
+	// What UpdateBroadphase does, grid candidates followed by the exact check
+	int32 CountPairsWithGrid(const UAISense_Sight_VRTestDriver * Sense, const FSightDigest & Digest, const FAISightTargetGridVR & Grid, const TArray<FVector> & Listeners, const TArray<FVector> & Targets, TArray<FAISightTargetVR::FTargetId> & Candidates, TSet<uint64> * OutPairs = nullptr)
+	{
+		const float Radius = Digest.BroadphaseRadius + Sense->GetBroadphaseRangePadding();
+
+		int32 NumPairs = 0;
+		for (int32 ListenerIndex = 0; ListenerIndex < Listeners.Num(); ++ListenerIndex)
+		{
+			Candidates.Reset();
+			Grid.GatherTargetsInRadius(Listeners[ListenerIndex], Radius, Candidates);
+
+			for (FAISightTargetVR::FTargetId TargetIndex : Candidates)
+			{
+				if (Sense->IsInRange(Listeners[ListenerIndex], Digest, Targets[TargetIndex]))
+				{
+					++NumPairs;
+					if (OutPairs)
+						OutPairs->Add(((uint64)ListenerIndex << 32) | (uint64)TargetIndex);
+				}
+			}
+		}
+		return NumPairs;
+	}
+
+	// Scores the way queries see them, whole tick ages plus a clamped importance, with a few starved past the last bucket
+	TArray<FAISightQueryVR> MakeQueries(FRandomStream & Random, int32 Num)
+	{
+		TArray<FAISightQueryVR> Queries;
+		Queries.Reserve(Num);
+		for (int32 i = 0; i < Num; ++i)
+		{
+			FAISightQueryVR & Query = Queries.AddDefaulted_GetRef();
+			Query.TargetId = i;
+			Query.Age = (Random.RandRange(0, 99) == 0) ? Random.FRandRange(300.f, 1000.f) : (float)Random.RandRange(0, 40);
+			Query.Importance = Random.FRandRange(0.f, 60.f);
+			Query.RecalcScore();
+		}
+		return Queries;
+	}
+
+	int32 GetBucket(float Score)
+	{
+		return FMath::Clamp(FMath::FloorToInt(Score * UAISense_Sight_VR::SortBucketsPerScoreUnit), 0, UAISense_Sight_VR::NumSortBuckets - 1);
+	}
+}
+
+using namespace VRAIPerceptionTests;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRAISightGridGatherTest, "VRExpansionPlugin.AISightVR.GridGather", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRAISightGridGatherTest::RunTest(const FString& Parameters)
+{
+	FRandomStream Random(26);
+	const TArray<FVector> Targets = MakeLocations(Random, 500, 20000.f);
+
+	FAISightTargetGridVR Grid;
+	BuildGrid(Grid, 1000.f, Targets);
+
+	// Small radii walk the cells, huge ones walk the populated map instead, both have to return every target in range once
+	const float Radii[] = { 0.f, 250.f, 1000.f, 2750.f, 60000.f };
+	TArray<FAISightTargetVR::FTargetId> Gathered;
+
+	for (float Radius : Radii)
+	{
+		int32 NumMissed = 0;
+		int32 NumDuplicated = 0;
+
+		for (int32 Probe = 0; Probe < 50; ++Probe)
+		{
+			const FVector Center = (Probe & 1) ? Targets[Random.RandRange(0, Targets.Num() - 1)] : MakeLocations(Random, 1, 22000.f)[0];
+
+			Gathered.Reset();
+			Grid.GatherTargetsInRadius(Center, Radius, Gathered);
+
+			TSet<FAISightTargetVR::FTargetId> Unique;
+			for (FAISightTargetVR::FTargetId TargetId : Gathered)
+			{
+				bool bAlreadyIn = false;
+				Unique.Add(TargetId, &bAlreadyIn);
+				NumDuplicated += bAlreadyIn ? 1 : 0;
+			}
+
+			for (int32 i = 0; i < Targets.Num(); ++i)
+			{
+				if (FVector::Dist(Center, Targets[i]) <= Radius && !Unique.Contains(i))
+					++NumMissed;
+			}
+		}
+
+		TestEqual(FString::Printf(TEXT("Radius %.0f: targets in range missed"), Radius), NumMissed, 0);
+		TestEqual(FString::Printf(TEXT("Radius %.0f: targets gathered twice"), Radius), NumDuplicated, 0);
+	}
+
+	// Cells are floored, targets on either side of zero and exactly on a cell edge land in the right cell
+	TestTrue(TEXT("Negative locations floor down"), Grid.GetCell(FVector(-1.f, -999.f, -1001.f)) == FIntVector(-1, -1, -2));
+	TestTrue(TEXT("Cell edge belongs to the upper cell"), Grid.GetCell(FVector(1000.f, 0.f, 2000.f)) == FIntVector(1, 0, 2));
+
+	// Reset keeps cells around but empties them
+	BuildGrid(Grid, 500.f, TArray<FVector>());
+	Gathered.Reset();
+	Grid.GatherTargetsInRadius(FVector::ZeroVector, 60000.f, Gathered);
+	TestEqual(TEXT("Reset grid is empty"), Gathered.Num(), 0);
+	TestEqual(TEXT("Reset applies the new cell size"), Grid.CellSize, 500.f);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRAISightBroadphasePairsTest, "VRExpansionPlugin.AISightVR.BroadphasePairs", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRAISightBroadphasePairsTest::RunTest(const FString& Parameters)
+{
+	UAISense_Sight_VRTestDriver * Sense = MakeSense();
+	Sense->SetBroadphase(true, 1000.f, 250.f);
+
+	// Range comes from whichever radius is larger, losing sight of something further out than noticing it has to keep working
+	const FSightDigest Digest = MakeDigest(1500.f, 2000.f);
+	TestEqual(TEXT("Broadphase radius is the larger radius"), Digest.BroadphaseRadius, 2000.f);
+	TestEqual(TEXT("Broadphase radius with a smaller lose radius"), MakeDigest(3000.f, 2000.f).BroadphaseRadius, 3000.f);
+
+	TestTrue(TEXT("Edge of range plus padding is in range"), Sense->IsInRange(FVector::ZeroVector, Digest, FVector(2249.f, 0.f, 0.f)));
+	TestFalse(TEXT("Past the padding is out of range"), Sense->IsInRange(FVector::ZeroVector, Digest, FVector(2251.f, 0.f, 0.f)));
+
+	FRandomStream Random(260);
+	const TArray<FVector> Listeners = MakeLocations(Random, 60, 15000.f);
+	const TArray<FVector> Targets = MakeLocations(Random, 400, 15000.f);
+
+	FAISightTargetGridVR Grid;
+	TArray<FAISightTargetVR::FTargetId> Candidates;
+	const float CellSizes[] = { 250.f, 1000.f, 5000.f };
+
+	TSet<uint64> ExpectedPairs;
+	CountPairsBruteForce(Sense, Digest, Listeners, Targets, &ExpectedPairs);
+	TestTrue(TEXT("Scenario has pairs in range"), ExpectedPairs.Num() > 0);
+	TestTrue(TEXT("Scenario has pairs out of range"), ExpectedPairs.Num() < Listeners.Num() * Targets.Num());
+
+	// Whatever the cell size, the grid finds exactly the pairs a full pass would
+	for (float CellSize : CellSizes)
+	{
+		BuildGrid(Grid, CellSize, Targets);
+
+		TSet<uint64> GridPairs;
+		CountPairsWithGrid(Sense, Digest, Grid, Listeners, Targets, Candidates, &GridPairs);
+
+		TestEqual(FString::Printf(TEXT("Cell size %.0f: pair count"), CellSize), GridPairs.Num(), ExpectedPairs.Num());
+		TestEqual(FString::Printf(TEXT("Cell size %.0f: pairs only found without the grid"), CellSize), ExpectedPairs.Difference(GridPairs).Num(), 0);
+	}
+
+	// Turned off, every pair gets a query like the stock sense
+	Sense->SetBroadphase(false, 1000.f, 250.f);
+	TestEqual(TEXT("Broadphase off pairs everything"), CountPairsBruteForce(Sense, Digest, Listeners, Targets), Listeners.Num() * Targets.Num());
+
+	// A listener without a digested radius is never culled
+	Sense->SetBroadphase(true, 1000.f, 250.f);
+	TestTrue(TEXT("Undigested listener is in range"), Sense->IsInRange(FVector::ZeroVector, FSightDigest(), FVector(1.0e6f, 0.f, 0.f)));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRAISightDropQueriesTest, "VRExpansionPlugin.AISightVR.DropQueries", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRAISightDropQueriesTest::RunTest(const FString& Parameters)
+{
+	UAISense_Sight_VRTestDriver * Sense = MakeSense();
+	Sense->SetBroadphase(true, 1000.f, 250.f);
+
+	const FSightDigest Digest = MakeDigest(1500.f, 2000.f);
+	const FSightDigest AutoSuccessDigest = MakeDigest(1500.f, 2000.f, 500.f);
+	const FVector Near(1000.f, 0.f, 0.f);
+	const FVector Far(5000.f, 0.f, 0.f);
+
+	FAISightQueryVR Idle;
+	TestFalse(TEXT("Idle query in range is kept"), Sense->CanDrop(Idle, FVector::ZeroVector, Digest, Near));
+	TestTrue(TEXT("Idle query out of range is dropped"), Sense->CanDrop(Idle, FVector::ZeroVector, Digest, Far));
+
+	// The target walked off while seen, the query has to run once more to report the loss
+	FAISightQueryVR Seen;
+	Seen.bLastResult = true;
+	Seen.LastSeenLocation = Far;
+	TestFalse(TEXT("Seen target out of range is kept"), Sense->CanDrop(Seen, FVector::ZeroVector, Digest, Far));
+
+	// Lost but with a last seen location, it can still be automatically seen while the auto success range is on
+	FAISightQueryVR Remembered;
+	Remembered.LastSeenLocation = Far;
+	TestFalse(TEXT("Remembered target is kept with auto success"), Sense->CanDrop(Remembered, FVector::ZeroVector, AutoSuccessDigest, Far));
+	TestTrue(TEXT("Remembered target is dropped without auto success"), Sense->CanDrop(Remembered, FVector::ZeroVector, Digest, Far));
+
+	Remembered.ForgetPreviousResult();
+	TestTrue(TEXT("Forgotten target is dropped"), Sense->CanDrop(Remembered, FVector::ZeroVector, AutoSuccessDigest, Far));
+
+	Sense->SetBroadphase(false, 1000.f, 250.f);
+	TestFalse(TEXT("Nothing is dropped with the broadphase off"), Sense->CanDrop(Idle, FVector::ZeroVector, Digest, Far));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRAISightSortQueriesTest, "VRExpansionPlugin.AISightVR.SortQueries", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRAISightSortQueriesTest::RunTest(const FString& Parameters)
+{
+	UAISense_Sight_VRTestDriver * Sense = MakeSense();
+	FRandomStream Random(2600);
+
+	const int32 QueryCounts[] = { 0, 1, 2, 37, 5000 };
+	for (int32 NumQueries : QueryCounts)
+	{
+		TArray<FAISightQueryVR> Queries = MakeQueries(Random, NumQueries);
+		TArray<FAISightQueryVR> Expected = Queries;
+		Expected.StableSort(FAISightQueryVR::FSortPredicate());
+
+		Sense->Sort(Queries);
+
+		TestEqual(FString::Printf(TEXT("%d queries: count kept"), NumQueries), Queries.Num(), NumQueries);
+
+		TBitArray<> Seen(false, NumQueries);
+		int32 NumOutOfOrder = 0;
+		int32 NumUnstable = 0;
+		int32 NumLost = 0;
+
+		for (int32 i = 0; i < Queries.Num(); ++i)
+		{
+			const int32 Original = (int32)Queries[i].TargetId;
+			if (Original >= 0 && Original < NumQueries && !Seen[Original])
+				Seen[Original] = true;
+			else
+				++NumLost;
+
+			if (i > 0)
+			{
+				const int32 PrevBucket = GetBucket(Queries[i - 1].Score);
+				const int32 Bucket = GetBucket(Queries[i].Score);
+				NumOutOfOrder += Bucket > PrevBucket ? 1 : 0;
+				NumUnstable += (Bucket == PrevBucket && Queries[i].TargetId < Queries[i - 1].TargetId) ? 1 : 0;
+			}
+
+			// Same bucket as the full sort at every position, only the order inside a bucket may differ
+			NumOutOfOrder += GetBucket(Queries[i].Score) != GetBucket(Expected[i].Score) ? 1 : 0;
+		}
+
+		TestEqual(FString::Printf(TEXT("%d queries: lost or duplicated"), NumQueries), NumLost, 0);
+		TestEqual(FString::Printf(TEXT("%d queries: out of bucket order"), NumQueries), NumOutOfOrder, 0);
+		TestEqual(FString::Printf(TEXT("%d queries: reordered inside a bucket"), NumQueries), NumUnstable, 0);
+	}
+
+	// Scores past either end are clamped to the first and last bucket, still ahead of or behind everything else
+	TArray<FAISightQueryVR> Queries;
+	const float Scores[] = { 5.f, -3.f, 1.0e6f, 12.5f };
+	for (int32 i = 0; i < ARRAY_COUNT(Scores); ++i)
+	{
+		FAISightQueryVR & Query = Queries.AddDefaulted_GetRef();
+		Query.TargetId = i;
+		Query.Score = Scores[i];
+	}
+
+	Sense->Sort(Queries);
+	TestEqual(TEXT("Starved query first"), (int32)Queries[0].TargetId, 2);
+	TestEqual(TEXT("Then the higher score"), (int32)Queries[1].TargetId, 3);
+	TestEqual(TEXT("Negative score last"), (int32)Queries[3].TargetId, 1);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRAISightBenchmark, "VRExpansionPlugin.AISightVR.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRAISightBenchmark::RunTest(const FString& Parameters)
+{
+	UAISense_Sight_VRTestDriver * Sense = MakeSense();
+	Sense->SetBroadphase(true, 1000.f, 250.f);
+	const FSightDigest Digest = MakeDigest(1500.f, 2000.f);
+
+	// Pair generation, a full listener x target pass against the grid the broadphase rebuilds every interval
+	const int32 ListenerCounts[] = { 50, 200 };
+	const int32 TargetCounts[] = { 200, 2000 };
+	const int32 NumRepeats = 10;
+
+	FAISightTargetGridVR Grid;
+	TArray<FAISightTargetVR::FTargetId> Candidates;
+
+	for (int32 NumListeners : ListenerCounts)
+	{
+		for (int32 NumTargets : TargetCounts)
+		{
+			FRandomStream Random(NumListeners * NumTargets);
+			const TArray<FVector> Listeners = MakeLocations(Random, NumListeners, 20000.f);
+			const TArray<FVector> Targets = MakeLocations(Random, NumTargets, 20000.f);
+
+			int32 BrutePairs = 0;
+			const double BruteStart = FPlatformTime::Seconds();
+			for (int32 Repeat = 0; Repeat < NumRepeats; ++Repeat)
+			{
+				BrutePairs = CountPairsBruteForce(Sense, Digest, Listeners, Targets);
+			}
+			const double BruteSeconds = (FPlatformTime::Seconds() - BruteStart) / NumRepeats;
+
+			int32 GridPairs = 0;
+			const double GridStart = FPlatformTime::Seconds();
+			for (int32 Repeat = 0; Repeat < NumRepeats; ++Repeat)
+			{
+				BuildGrid(Grid, 1000.f, Targets);
+				GridPairs = CountPairsWithGrid(Sense, Digest, Grid, Listeners, Targets, Candidates);
+			}
+			const double GridSeconds = (FPlatformTime::Seconds() - GridStart) / NumRepeats;
+
+			AddInfo(FString::Printf(TEXT("%d listeners x %d targets: %d live queries of %d pairs, all pairs %.3f ms, grid %.3f ms"),
+				NumListeners, NumTargets, GridPairs, NumListeners * NumTargets, BruteSeconds * 1000.0, GridSeconds * 1000.0));
+
+			TestEqual(TEXT("Grid finds the same pairs"), GridPairs, BrutePairs);
+		}
+	}
+
+	// Queue sort, buckets against the comparison sort it replaced
+	const int32 QueryCounts[] = { 1000, 10000, 100000 };
+	for (int32 NumQueries : QueryCounts)
+	{
+		FRandomStream Random(NumQueries);
+		const TArray<FAISightQueryVR> Source = MakeQueries(Random, NumQueries);
+		TArray<FAISightQueryVR> Queries;
+
+		double BucketSeconds = 0.0;
+		double CompareSeconds = 0.0;
+
+		for (int32 Repeat = 0; Repeat < NumRepeats; ++Repeat)
+		{
+			Queries = Source;
+			const double CompareStart = FPlatformTime::Seconds();
+			Queries.Sort(FAISightQueryVR::FSortPredicate());
+			CompareSeconds += FPlatformTime::Seconds() - CompareStart;
+
+			Queries = Source;
+			const double BucketStart = FPlatformTime::Seconds();
+			Sense->Sort(Queries);
+			BucketSeconds += FPlatformTime::Seconds() - BucketStart;
+		}
+
+		AddInfo(FString::Printf(TEXT("%d queries: comparison sort %.3f ms, bucket sort %.3f ms"),
+			NumQueries, CompareSeconds * 1000.0 / NumRepeats, BucketSeconds * 1000.0 / NumRepeats));
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
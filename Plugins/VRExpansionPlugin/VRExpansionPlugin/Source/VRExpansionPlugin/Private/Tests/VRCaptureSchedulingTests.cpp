@@ -0,0 +1,220 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/VRCaptureScheduling.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace VRCaptureSchedulingTests
+{
+	// Looking down +X from the origin with a 90 degree FOV
+	FVRCaptureScheduleView MakeView()
+	{
+		FVRCaptureScheduleView View;
+		View.bIsValid = true;
+		View.Location = FVector::ZeroVector;
+		View.Forward = FVector::ForwardVector;
+		View.TanHalfFOV = 1.0f;
+		return View;
+	}
+
+	// Already captured at time 0, only ranking decides unless a rate is given
+	FVRCaptureScheduleEntry MakeEntry(const FVector & Center, float Radius, float MinRefreshRate = 0.0f, float MaxRefreshRate = 0.0f)
+	{
+		FVRCaptureScheduleEntry Entry;
+		Entry.Center = Center;
+		Entry.Radius = Radius;
+		Entry.Settings.MinRefreshRate = MinRefreshRate;
+		Entry.Settings.MaxRefreshRate = MaxRefreshRate;
+		Entry.bHasCaptured = true;
+		Entry.LastCaptureTime = 0.0f;
+		return Entry;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRCaptureSchedulerOrderingTest, "VRExpansionPlugin.CaptureScheduler.Ordering", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRCaptureSchedulerOrderingTest::RunTest(const FString& Parameters)
+{
+	using namespace VRCaptureSchedulingTests;
+
+	const FVRCaptureScheduleView View = MakeView();
+	TArray<int32> Selected;
+
+	{
+		FVRCaptureScheduler Scheduler;
+		const int32 Near = Scheduler.Entries.Add(MakeEntry(FVector(200.0f, 0.0f, 0.0f), 50.0f));
+		const int32 Behind = Scheduler.Entries.Add(MakeEntry(FVector(-200.0f, 0.0f, 0.0f), 50.0f));
+		const int32 Far = Scheduler.Entries.Add(MakeEntry(FVector(1500.0f, 300.0f, 0.0f), 50.0f));
+
+		TestTrue(TEXT("A near centered surface outranks a far off center one"), FVRCaptureScheduler::GetViewRanking(View, Scheduler.Entries[Near]) > FVRCaptureScheduler::GetViewRanking(View, Scheduler.Entries[Far]));
+		TestEqual(TEXT("A surface behind the view has no ranking"), FVRCaptureScheduler::GetViewRanking(View, Scheduler.Entries[Behind]), 0.0f);
+
+		Scheduler.SelectCaptures(View, 1.0f, 1, Selected);
+		TestTrue(TEXT("A budget of one picks the highest ranked"), Selected.Num() == 1 && Selected[0] == Near);
+
+		Scheduler.SelectCaptures(View, 2.0f, 3, Selected);
+		// The far one has waited twice as long, which lifts it over the near one that was just captured
+		TestTrue(TEXT("Ranked captures are ordered by ranking times time waited and unranked ones are skipped"), Selected.Num() == 2 && Selected[0] == Far && Selected[1] == Near);
+
+		TestEqual(TEXT("Selected captures are marked"), Scheduler.Entries[Far].LastCaptureTime, 2.0f);
+		TestEqual(TEXT("Skipped captures are left alone"), Scheduler.Entries[Behind].LastCaptureTime, 0.0f);
+
+		Scheduler.SelectCaptures(View, 3.0f, 0, Selected);
+		TestEqual(TEXT("No budget selects nothing"), Selected.Num(), 0);
+	}
+
+	{
+		FVRCaptureScheduler Scheduler;
+		const int32 Ranked = Scheduler.Entries.Add(MakeEntry(FVector(200.0f, 0.0f, 0.0f), 50.0f));
+		const int32 SlightlyLate = Scheduler.Entries.Add(MakeEntry(FVector(-200.0f, 0.0f, 0.0f), 50.0f, 1.0f));
+		const int32 VeryLate = Scheduler.Entries.Add(MakeEntry(FVector(-400.0f, 0.0f, 0.0f), 50.0f, 4.0f));
+		const int32 Fresh = Scheduler.Entries.Add(MakeEntry(FVector(-600.0f, 0.0f, 0.0f), 50.0f));
+		Scheduler.Entries[Fresh].bHasCaptured = false;
+
+		// At 1.5 the 1hz capture is 1.5 intervals late, the 4hz one 6 intervals
+		Scheduler.SelectCaptures(View, 1.5f, 4, Selected);
+		TestTrue(TEXT("Never captured first, then overdue by lateness, then ranked"),
+			Selected.Num() == 4 && Selected[0] == Fresh && Selected[1] == VeryLate && Selected[2] == SlightlyLate && Selected[3] == Ranked);
+	}
+
+	{
+		FVRCaptureScheduler Scheduler;
+		const int32 Capped = Scheduler.Entries.Add(MakeEntry(FVector(200.0f, 0.0f, 0.0f), 50.0f, 0.0f, 10.0f));
+
+		Scheduler.SelectCaptures(View, 0.05f, 1, Selected);
+		TestEqual(TEXT("The max refresh rate holds back a capture"), Selected.Num(), 0);
+
+		Scheduler.SelectCaptures(View, 0.15f, 1, Selected);
+		TestTrue(TEXT("The capture is allowed again once its max rate interval is up"), Selected.Num() == 1 && Selected[0] == Capped);
+	}
+
+	{
+		FVRCaptureScheduler Scheduler;
+		Scheduler.Entries.Add(MakeEntry(FVector(200.0f, 0.0f, 0.0f), 50.0f));
+
+		Scheduler.SelectCaptures(FVRCaptureScheduleView(), 1.0f, 1, Selected);
+		TestEqual(TEXT("Without a view nothing is ranked"), Selected.Num(), 0);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRCaptureSchedulerStarvationTest, "VRExpansionPlugin.CaptureScheduler.Starvation", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRCaptureSchedulerStarvationTest::RunTest(const FString& Parameters)
+{
+	using namespace VRCaptureSchedulingTests;
+
+	const FVRCaptureScheduleView View = MakeView();
+	const float FrameTime = 1.0f / 90.0f;
+	const int32 NumFrames = 90 * 20;
+	TArray<int32> Selected;
+
+	// Budget of one with a crowd of highly ranked captures, the low ranked ones only get in through their min rate
+	FVRCaptureScheduler Scheduler;
+	for (int32 i = 0; i < 8; ++i)
+	{
+		Scheduler.Entries.Add(MakeEntry(FVector(150.0f + (i * 10.0f), (i - 4) * 10.0f, 0.0f), 60.0f));
+	}
+
+	const float MinRates[] = { 2.0f, 1.0f, 0.5f };
+	TArray<int32> Starved;
+	for (float MinRate : MinRates)
+	{
+		Starved.Add(Scheduler.Entries.Add(MakeEntry(FVector(-500.0f, 0.0f, 0.0f), 10.0f, MinRate)));
+	}
+
+	TArray<float> LastCaptured;
+	TArray<float> LongestGap;
+	LastCaptured.Init(0.0f, Scheduler.Entries.Num());
+	LongestGap.Init(0.0f, Scheduler.Entries.Num());
+
+	for (int32 Frame = 1; Frame <= NumFrames; ++Frame)
+	{
+		const float Time = Frame * FrameTime;
+		Scheduler.SelectCaptures(View, Time, 1, Selected);
+
+		if (!TestTrue(TEXT("The budget is never exceeded"), Selected.Num() <= 1))
+			return false;
+
+		for (int32 Index : Selected)
+		{
+			LongestGap[Index] = FMath::Max(LongestGap[Index], Time - LastCaptured[Index]);
+			LastCaptured[Index] = Time;
+		}
+	}
+
+	// Other overdue captures can be ahead in line, with a budget of one each of them costs a frame
+	const float Slack = (Starved.Num() + 1) * FrameTime;
+
+	for (int32 i = 0; i < Starved.Num(); ++i)
+	{
+		const int32 Index = Starved[i];
+		const float Interval = 1.0f / MinRates[i];
+		LongestGap[Index] = FMath::Max(LongestGap[Index], (NumFrames * FrameTime) - LastCaptured[Index]);
+
+		TestTrue(FString::Printf(TEXT("A %.1fhz capture is refreshed within its interval (longest gap %.3fs)"), MinRates[i], LongestGap[Index]), LongestGap[Index] <= Interval + Slack);
+	}
+
+	for (int32 Index = 0; Index < 8; ++Index)
+	{
+		TestTrue(FString::Printf(TEXT("Ranked capture %d shares the budget (longest gap %.3fs)"), Index, LongestGap[Index]), LastCaptured[Index] > 0.0f && LongestGap[Index] < 1.0f);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRCaptureSchedulerBenchmark, "VRExpansionPlugin.CaptureScheduler.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRCaptureSchedulerBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace VRCaptureSchedulingTests;
+
+	const int32 CaptureCounts[] = { 100, 250, 1000 };
+	const int32 Budgets[] = { 1, 4 };
+	const float FrameTime = 1.0f / 90.0f;
+	const int32 NumFrames = 900;
+	TArray<int32> Selected;
+
+	for (int32 NumCaptures : CaptureCounts)
+	{
+		for (int32 Budget : Budgets)
+		{
+			// Portals, mirrors and scopes scattered around a turning player, a quarter of them with a guaranteed rate
+			FRandomStream Random(NumCaptures + Budget);
+			FVRCaptureScheduler Scheduler;
+			for (int32 i = 0; i < NumCaptures; ++i)
+			{
+				Scheduler.Entries.Add(MakeEntry(Random.GetUnitVector() * Random.FRandRange(100.0f, 3000.0f), Random.FRandRange(20.0f, 150.0f), (i % 4) == 0 ? 1.0f : 0.0f, 90.0f));
+			}
+
+			FVRCaptureScheduleView View = MakeView();
+			int32 NumSelected = 0;
+			double SelectSeconds = 0.0;
+
+			for (int32 Frame = 1; Frame <= NumFrames; ++Frame)
+			{
+				View.Forward = FRotator(0.0f, Frame * 0.5f, 0.0f).Vector();
+
+				const double Start = FPlatformTime::Seconds();
+				Scheduler.SelectCaptures(View, Frame * FrameTime, Budget, Selected);
+				SelectSeconds += FPlatformTime::Seconds() - Start;
+
+				if (!TestTrue(TEXT("The budget is never exceeded"), Selected.Num() <= Budget))
+					return false;
+
+				NumSelected += Selected.Num();
+			}
+
+			AddInfo(FString::Printf(TEXT("%d captures, budget %d: %.2f us per frame (%.1f ns per capture), %.2f captures per frame"),
+				NumCaptures, Budget, SelectSeconds * 1e6 / NumFrames, SelectSeconds * 1e9 / ((double)NumFrames * NumCaptures), (float)NumSelected / NumFrames));
+		}
+	}
+
+	return true;
+}
+
+#endif
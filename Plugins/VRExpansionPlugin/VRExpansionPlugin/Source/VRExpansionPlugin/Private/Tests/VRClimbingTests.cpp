@@ -0,0 +1,325 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+#include "HAL/PlatformTime.h"
+#include "Serialization/BitWriter.h"
+#include "Serialization/BitReader.h"
+#include "UObject/Package.h"
+#include "Components/SceneComponent.h"
+#include "VRCharacterMovementComponent.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace VRClimbingTests
+{
+	// Tracked hand offsets from the capsule for one frame, and which hands are holding on
+	struct FClimbFrame
+	{
+		FVector HandOffsets[VR_CLIMBING_GRIP_COUNT];
+		bool bGripping[VR_CLIMBING_GRIP_COUNT];
+		FVector HandholdLocation;
+	};
+
+	// Hand over hand climb up a wall that starts moving half way through, one hand releases while the other pulls
+	void RecordClimb(int32 NumFrames, int32 Seed, TArray<FClimbFrame> & OutFrames)
+	{
+		FRandomStream Random(Seed);
+		OutFrames.Reset(NumFrames);
+
+		const int32 FramesPerReach = 45;
+		FVector HandholdLocation(100.0f, 0.0f, 0.0f);
+
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			FClimbFrame & Recorded = OutFrames.AddDefaulted_GetRef();
+			const int32 Reach = Frame / FramesPerReach;
+			const float Alpha = (Frame % FramesPerReach) / (float)FramesPerReach;
+
+			// Both hands hold still on their handholds for the hand over, then one pulls down while the other reaches back up
+			const float MoveAlpha = FMath::Max(0.0f, (Alpha - 0.1f) / 0.9f);
+
+			for (int32 i = 0; i < VR_CLIMBING_GRIP_COUNT; ++i)
+			{
+				const bool bPulling = (Reach % VR_CLIMBING_GRIP_COUNT) == i;
+				const float Height = bPulling ? FMath::Lerp(60.0f, 0.0f, MoveAlpha) : FMath::Lerp(0.0f, 60.0f, MoveAlpha);
+				const FVector Noise(Random.FRandRange(-0.01f, 0.01f), Random.FRandRange(-0.01f, 0.01f), Random.FRandRange(-0.01f, 0.01f));
+
+				Recorded.HandOffsets[i] = FVector(40.0f, i == 0 ? -20.0f : 20.0f, Height) + Noise;
+				Recorded.bGripping[i] = bPulling || Alpha < 0.1f;
+			}
+
+			if (Frame > NumFrames / 2)
+				HandholdLocation += FVector(0.0f, 0.1f, 0.25f);
+
+			Recorded.HandholdLocation = HandholdLocation;
+		}
+	}
+
+	// One side of the connection, the client solves and records moves, the server replays them
+	struct FClimbSim
+	{
+		UVRCharacterMovementComponent * Movement;
+		USceneComponent * Capsule;
+		USceneComponent * Hands[VR_CLIMBING_GRIP_COUNT];
+
+		// Template blueprint state, the world location each hand grabbed
+		FVector BPGripLocations[VR_CLIMBING_GRIP_COUNT];
+		bool bBPGripping[VR_CLIMBING_GRIP_COUNT];
+
+		FClimbSim()
+		{
+			Movement = NewObject<UVRCharacterMovementComponent>(GetTransientPackage(), NAME_None, RF_Transient);
+			Capsule = NewObject<USceneComponent>(GetTransientPackage(), NAME_None, RF_Transient);
+			Movement->UpdatedComponent = Capsule;
+
+			for (int32 i = 0; i < VR_CLIMBING_GRIP_COUNT; ++i)
+			{
+				Hands[i] = NewObject<USceneComponent>(GetTransientPackage(), NAME_None, RF_Transient);
+				BPGripLocations[i] = FVector::ZeroVector;
+				bBPGripping[i] = false;
+			}
+		}
+
+		~FClimbSim()
+		{
+			for (USceneComponent * Hand : Hands)
+				Hand->MarkPendingKill();
+
+			Capsule->MarkPendingKill();
+			Movement->MarkPendingKill();
+		}
+
+		void PlaceHands(const FClimbFrame & Frame)
+		{
+			for (int32 i = 0; i < VR_CLIMBING_GRIP_COUNT; ++i)
+				Hands[i]->SetWorldLocation(Capsule->GetComponentLocation() + Frame.HandOffsets[i]);
+		}
+
+		// What StartClimbingGrip / EndClimbingGrip do, minus the locally controlled check there is no character for
+		void UpdateNativeGrips(const FClimbFrame & Frame, USceneComponent * Handhold)
+		{
+			for (int32 i = 0; i < VR_CLIMBING_GRIP_COUNT; ++i)
+			{
+				FVRClimbingGripRep & Grip = Movement->LocalClimbingGrips.Grips[i];
+
+				if (Frame.bGripping[i] && !Grip.IsActive())
+				{
+					Grip.Handhold = Handhold;
+					Grip.LocalAnchor = Movement->RoundDirectMovement(Handhold->GetComponentTransform().InverseTransformPosition(Hands[i]->GetComponentLocation()));
+					Movement->ClimbingGripHands[i] = Hands[i];
+				}
+				else if (!Frame.bGripping[i] && Grip.IsActive())
+				{
+					Grip.Clear();
+					Movement->ClimbingGripHands[i].Reset();
+				}
+			}
+		}
+
+		// The usual template graph, AddCustomReplicatedMovement(GripLocation - HandLocation) for the latest hand that is holding on
+		FVector SolveBlueprintDelta(const FClimbFrame & Frame, USceneComponent * Handhold)
+		{
+			FVector Delta = FVector::ZeroVector;
+			for (int32 i = 0; i < VR_CLIMBING_GRIP_COUNT; ++i)
+			{
+				if (Frame.bGripping[i] && !bBPGripping[i])
+					BPGripLocations[i] = Handhold->GetComponentTransform().InverseTransformPosition(Hands[i]->GetComponentLocation());
+
+				bBPGripping[i] = Frame.bGripping[i];
+
+				if (bBPGripping[i])
+					Delta = Handhold->GetComponentTransform().TransformPosition(BPGripLocations[i]) - Hands[i]->GetComponentLocation();
+			}
+
+			return Movement->RoundDirectMovement(Delta);
+		}
+
+		void Move(const FVector & Delta)
+		{
+			Capsule->SetWorldLocation(Capsule->GetComponentLocation() + Delta);
+		}
+	};
+
+	// Sends the move the way the saved move does, FBitWriter has no package map so the handhold is resolved by hand as its net GUID would be
+	void SendNativeMove(const FVRClimbingMoveRep & ClientGrips, FVRClimbingMoveRep & OutServerGrips, int64 & InOutBits)
+	{
+		FVRClimbingMoveRep Sending = ClientGrips;
+		bool bSuccess = true;
+		FBitWriter Writer(256, true);
+		Sending.NetSerialize(Writer, nullptr, bSuccess);
+		InOutBits += Writer.GetNumBits();
+
+		FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+		OutServerGrips.Clear();
+		OutServerGrips.NetSerialize(Reader, nullptr, bSuccess);
+
+		for (int32 i = 0; i < VR_CLIMBING_GRIP_COUNT; ++i)
+		{
+			if (ClientGrips.Grips[i].IsActive())
+				OutServerGrips.Grips[i].Handhold = ClientGrips.Grips[i].Handhold;
+		}
+	}
+
+	FVector SendBlueprintMove(const FVector & ClientVector, int64 & InOutBits)
+	{
+		FVector Sending = ClientVector;
+		FBitWriter Writer(128, true);
+		SerializePackedVector<100, 22>(Sending, Writer);
+		InOutBits += Writer.GetNumBits();
+
+		FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+		FVector Received = FVector::ZeroVector;
+		SerializePackedVector<100, 22>(Received, Reader);
+		return Received;
+	}
+
+	struct FReplayResult
+	{
+		float MaxNativeDivergence = 0.0f;
+		float MaxBlueprintDivergence = 0.0f;
+		float MaxPathDifference = 0.0f;
+		float NativeDivergenceAfterNudge = 0.0f;
+		float BlueprintDivergenceAfterNudge = 0.0f;
+		int64 NativeBits = 0;
+		int64 BlueprintBits = 0;
+	};
+
+	/**
+	* Runs the climb through both paths, a client solving and sending every move and a server replaying it.
+	* NudgeFrame moves the server capsule by NudgeOffset once, as a server side depenetration would.
+	*/
+	FReplayResult ReplayClimb(const TArray<FClimbFrame> & Frames, int32 NudgeFrame, const FVector & NudgeOffset)
+	{
+		FReplayResult Result;
+
+		USceneComponent * Handhold = NewObject<USceneComponent>(GetTransientPackage(), NAME_None, RF_Transient);
+		FClimbSim NativeClient, NativeServer, BPClient, BPServer;
+
+		for (int32 FrameIndex = 0; FrameIndex < Frames.Num(); ++FrameIndex)
+		{
+			const FClimbFrame & Frame = Frames[FrameIndex];
+			Handhold->SetWorldLocation(Frame.HandholdLocation);
+
+			if (FrameIndex == NudgeFrame)
+			{
+				NativeServer.Move(NudgeOffset);
+				BPServer.Move(NudgeOffset);
+			}
+
+			// Native, the client refreshes the offsets and solves, the server solves again from what it received
+			NativeClient.PlaceHands(Frame);
+			NativeClient.UpdateNativeGrips(Frame, Handhold);
+			NativeClient.Movement->UpdateClimbingGripOffsets();
+
+			FVector ClientDelta = FVector::ZeroVector;
+			if (NativeClient.Movement->GetNativeClimbingDelta(ClientDelta))
+				NativeClient.Move(ClientDelta);
+
+			SendNativeMove(NativeClient.Movement->ClimbingGrips, NativeServer.Movement->ClimbingGrips, Result.NativeBits);
+
+			FVector ServerDelta = FVector::ZeroVector;
+			if (NativeServer.Movement->GetNativeClimbingDelta(ServerDelta))
+				NativeServer.Move(ServerDelta);
+
+			// Blueprint, the client solves and the server applies the vector it was sent
+			BPClient.PlaceHands(Frame);
+			const FVector BPDelta = BPClient.SolveBlueprintDelta(Frame, Handhold);
+			BPClient.Move(BPDelta);
+			BPServer.Move(SendBlueprintMove(BPDelta, Result.BlueprintBits));
+
+			const float NativeDivergence = FVector::Dist(NativeClient.Capsule->GetComponentLocation(), NativeServer.Capsule->GetComponentLocation());
+			const float BlueprintDivergence = FVector::Dist(BPClient.Capsule->GetComponentLocation(), BPServer.Capsule->GetComponentLocation());
+
+			if (FrameIndex < NudgeFrame)
+			{
+				Result.MaxNativeDivergence = FMath::Max(Result.MaxNativeDivergence, NativeDivergence);
+				Result.MaxBlueprintDivergence = FMath::Max(Result.MaxBlueprintDivergence, BlueprintDivergence);
+				Result.MaxPathDifference = FMath::Max(Result.MaxPathDifference, FVector::Dist(NativeClient.Capsule->GetComponentLocation(), BPClient.Capsule->GetComponentLocation()));
+			}
+			else
+			{
+				Result.NativeDivergenceAfterNudge = NativeDivergence;
+				Result.BlueprintDivergenceAfterNudge = BlueprintDivergence;
+			}
+		}
+
+		Handhold->MarkPendingKill();
+		return Result;
+	}
+}
+
+using namespace VRClimbingTests;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRClimbingReplayTest, "VRExpansionPlugin.Climbing.NativeReplay", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRClimbingReplayTest::RunTest(const FString& Parameters)
+{
+	TArray<FClimbFrame> Frames;
+	RecordClimb(900, 0xC11B, Frames);
+
+	const int32 NudgeFrame = 600;
+	const FReplayResult Result = ReplayClimb(Frames, NudgeFrame, FVector(0.0f, 0.0f, 1.5f));
+
+	AddInfo(FString::Printf(TEXT("Divergence native %.4f blueprint %.4f, path difference %.4f, after a server nudge native %.4f blueprint %.4f, bits per move native %.1f blueprint %.1f"),
+		Result.MaxNativeDivergence, Result.MaxBlueprintDivergence, Result.MaxPathDifference,
+		Result.NativeDivergenceAfterNudge, Result.BlueprintDivergenceAfterNudge,
+		Result.NativeBits / (double)Frames.Num(), Result.BlueprintBits / (double)Frames.Num()));
+
+	// Both sides solve from the same rounded values, only the packed vector float ulps may differ. The native server
+	// re-solves every move so those can't build up, the blueprint vector is applied as is and they can
+	TestTrue(TEXT("Native server replay matches the client"), Result.MaxNativeDivergence < 0.001f);
+	TestTrue(TEXT("Blueprint server replay matches the client"), Result.MaxBlueprintDivergence < 0.01f);
+
+	// Both put the hands back on the handholds every frame, the rounding and tracking noise are the only difference
+	TestTrue(TEXT("Native and blueprint climbs follow the same path"), Result.MaxPathDifference < 0.1f);
+
+	// The native server re-solves from the hands so it pulls back onto the client, the blueprint vector can't
+	TestTrue(TEXT("Native climbing recovers from a server side nudge"), Result.NativeDivergenceAfterNudge < 0.05f);
+	TestTrue(TEXT("Blueprint climbing keeps the nudge until corrected"), Result.BlueprintDivergenceAfterNudge > 1.0f);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRClimbingSolveBenchmark, "VRExpansionPlugin.Climbing.SolveBenchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRClimbingSolveBenchmark::RunTest(const FString& Parameters)
+{
+	TArray<FClimbFrame> Frames;
+	RecordClimb(10000, 0xBE4C, Frames);
+
+	USceneComponent * Handhold = NewObject<USceneComponent>(GetTransientPackage(), NAME_None, RF_Transient);
+	FClimbSim Native, Blueprint;
+
+	double NativeSeconds = 0.0;
+	double BlueprintSeconds = 0.0;
+
+	for (const FClimbFrame & Frame : Frames)
+	{
+		Handhold->SetWorldLocation(Frame.HandholdLocation);
+		Native.PlaceHands(Frame);
+		Native.UpdateNativeGrips(Frame, Handhold);
+		Blueprint.PlaceHands(Frame);
+
+		double StartTime = FPlatformTime::Seconds();
+		Native.Movement->UpdateClimbingGripOffsets();
+		FVector Delta;
+		if (Native.Movement->GetNativeClimbingDelta(Delta))
+			Native.Move(Delta);
+		NativeSeconds += FPlatformTime::Seconds() - StartTime;
+
+		StartTime = FPlatformTime::Seconds();
+		Blueprint.Move(Blueprint.SolveBlueprintDelta(Frame, Handhold));
+		BlueprintSeconds += FPlatformTime::Seconds() - StartTime;
+	}
+
+	Handhold->MarkPendingKill();
+
+	AddInfo(FString::Printf(TEXT("%d frames: native solve %.3f us per move, blueprint equivalent in C++ %.3f us per move"),
+		Frames.Num(), (NativeSeconds * 1e6) / Frames.Num(), (BlueprintSeconds * 1e6) / Frames.Num()));
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,225 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "UObject/Package.h"
+#include "VRGlobalSettings.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace VRGlobalSettingsTests
+{
+	// Transient settings object so the default object and the input settings are never touched
+	UVRGlobalSettings * MakeSettings()
+	{
+		UVRGlobalSettings * Settings = NewObject<UVRGlobalSettings>(GetTransientPackage(), NAME_None, RF_Transient);
+		Settings->ControllerProfiles.Reset();
+		Settings->MarkControllerProfilesDirty();
+		return Settings;
+	}
+
+	// Same search the profile functions did before the registry
+	int32 LinearFind(const UVRGlobalSettings * Settings, FName ControllerProfileName)
+	{
+		if (ControllerProfileName == NAME_None)
+			return INDEX_NONE;
+
+		return Settings->ControllerProfiles.IndexOfByPredicate([ControllerProfileName](const FBPVRControllerProfile & Profile) { return Profile.ControllerName == ControllerProfileName; });
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRControllerProfileRegistryLookupTest, "VRExpansionPlugin.GlobalSettings.ControllerProfileLookup", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRControllerProfileRegistryLookupTest::RunTest(const FString& Parameters)
+{
+	using namespace VRGlobalSettingsTests;
+
+	UVRGlobalSettings * Settings = MakeSettings();
+
+	const FTransform Offset(FRotator(-70.f, 0.f, 0.f), FVector(2.f, 0.f, -1.f));
+	const FTransform OffsetRight(FRotator(-60.f, 10.f, 0.f), FVector(2.f, 1.f, -1.f), FVector(1.f, 1.f, 2.f));
+
+	Settings->ControllerProfiles.Add(FBPVRControllerProfile(TEXT("Vive_Wands")));
+	Settings->ControllerProfiles.Add(FBPVRControllerProfile(TEXT("Oculus_Touch"), Offset));
+	Settings->ControllerProfiles.Add(FBPVRControllerProfile(TEXT("Knuckles"), Offset, OffsetRight));
+	Settings->ControllerProfiles.Add(FBPVRControllerProfile(NAME_None, Offset));
+	Settings->ControllerProfiles.Add(FBPVRControllerProfile(TEXT("Oculus_Touch"), OffsetRight));
+	Settings->MarkControllerProfilesDirty();
+
+	const FName Names[] = { TEXT("Vive_Wands"), TEXT("Oculus_Touch"), TEXT("Knuckles"), NAME_None, TEXT("Missing") };
+	for (const FName & Name : Names)
+	{
+		const FVRControllerProfileRecord * Record = Settings->FindControllerProfileRecord(Name);
+		const int32 Expected = LinearFind(Settings, Name);
+
+		TestEqual(FString::Printf(TEXT("%s resolves to the same profile as the array search"), *Name.ToString()), Record ? Record->ProfileIndex : INDEX_NONE, Expected);
+	}
+
+	const FTransform Socket(FRotator(10.f, 20.f, 30.f), FVector(5.f, -3.f, 8.f));
+
+	if (const FVRControllerProfileRecord * Touch = Settings->FindControllerProfileRecord(TEXT("Oculus_Touch")))
+	{
+		TestEqual(TEXT("The first of two profiles with the same name wins"), Touch->ProfileIndex, 1);
+		TestTrue(TEXT("Without seperate hand transforms the right hand uses the left offset"), Touch->GetTransform(true).Equals(Offset));
+		TestTrue(TEXT("Applying a profile matches the old socket times offset"), Touch->Apply(Socket, false).Equals(Socket * Offset));
+		TestTrue(TEXT("The inverse undoes the offset"), (Touch->GetTransform(false) * Touch->GetInverseTransform(false)).Equals(FTransform::Identity));
+	}
+
+	if (const FVRControllerProfileRecord * Knuckles = Settings->FindControllerProfileRecord(TEXT("Knuckles")))
+	{
+		TestTrue(TEXT("Seperate hand transforms keep the left offset"), Knuckles->GetTransform(false).Equals(Offset));
+		TestTrue(TEXT("Seperate hand transforms use the right offset for the right hand"), Knuckles->GetTransform(true).Equals(OffsetRight));
+		TestTrue(TEXT("Applying a right hand profile matches the old socket times right offset"), Knuckles->Apply(Socket, true).Equals(Socket * OffsetRight));
+		TestTrue(TEXT("The right inverse undoes the right offset"), (Knuckles->GetTransform(true) * Knuckles->GetInverseTransform(true)).Equals(FTransform::Identity));
+	}
+
+	Settings->MarkPendingKill();
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRControllerProfileRegistryGenerationTest, "VRExpansionPlugin.GlobalSettings.ControllerProfileGeneration", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRControllerProfileRegistryGenerationTest::RunTest(const FString& Parameters)
+{
+	using namespace VRGlobalSettingsTests;
+
+	UVRGlobalSettings * Settings = MakeSettings();
+
+	Settings->ControllerProfiles.Add(FBPVRControllerProfile(TEXT("Vive_Wands")));
+	Settings->ControllerProfiles.Add(FBPVRControllerProfile(TEXT("Oculus_Touch")));
+	Settings->MarkControllerProfilesDirty();
+
+	const uint32 StartGeneration = Settings->GetControllerProfileGeneration();
+	const FVRControllerProfileRecord * Touch = Settings->FindControllerProfileRecord(TEXT("Oculus_Touch"));
+
+	TestTrue(TEXT("The profile is found"), Touch != nullptr && Touch->ProfileIndex == 1);
+	TestTrue(TEXT("Lookups leave the generation alone"), Settings->GetControllerProfileGeneration() == StartGeneration);
+
+	// Reordering and renaming moves the profile to another index
+	Settings->ControllerProfiles.Insert(FBPVRControllerProfile(TEXT("WMR")), 0);
+	Settings->ControllerProfiles[1].ControllerName = TEXT("Vive_Cosmos");
+	Settings->MarkControllerProfilesDirty();
+
+	TestTrue(TEXT("Marking the profiles dirty changes the generation"), Settings->GetControllerProfileGeneration() != StartGeneration);
+
+	Touch = Settings->FindControllerProfileRecord(TEXT("Oculus_Touch"));
+	TestTrue(TEXT("A re-resolved profile follows its new index"), Touch != nullptr && Touch->ProfileIndex == 2);
+	TestNull(TEXT("A renamed profile is no longer found by its old name"), Settings->FindControllerProfileRecord(TEXT("Vive_Wands")));
+
+	if (const FVRControllerProfileRecord * Cosmos = Settings->FindControllerProfileRecord(TEXT("Vive_Cosmos")))
+		TestEqual(TEXT("A renamed profile is found by its new name"), Cosmos->ProfileIndex, 1);
+	else
+		AddError(TEXT("A renamed profile is found by its new name"));
+
+	// Removing every profile leaves nothing to find
+	const uint32 BeforeEmpty = Settings->GetControllerProfileGeneration();
+	Settings->ControllerProfiles.Reset();
+	Settings->MarkControllerProfilesDirty();
+
+	TestTrue(TEXT("Emptying the profiles changes the generation"), Settings->GetControllerProfileGeneration() != BeforeEmpty);
+	TestNull(TEXT("An emptied registry finds nothing"), Settings->FindControllerProfileRecord(TEXT("Oculus_Touch")));
+
+	Settings->MarkPendingKill();
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRControllerProfileRegistryBenchmark, "VRExpansionPlugin.GlobalSettings.ControllerProfileBenchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRControllerProfileRegistryBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace VRGlobalSettingsTests;
+
+	const int32 ProfileCounts[] = { 5, 20, 100, 500 };
+	const int32 NumQueries = 200000;
+
+	for (int32 NumProfiles : ProfileCounts)
+	{
+		UVRGlobalSettings * Settings = MakeSettings();
+		FRandomStream Random(NumProfiles);
+
+		for (int32 i = 0; i < NumProfiles; ++i)
+		{
+			const FTransform Offset(FRotator(Random.FRandRange(-90.f, 90.f), Random.FRandRange(-90.f, 90.f), 0.f), Random.GetUnitVector() * 5.f);
+			const FTransform OffsetRight(FRotator(Random.FRandRange(-90.f, 90.f), Random.FRandRange(-90.f, 90.f), 0.f), Random.GetUnitVector() * 5.f);
+
+			if (i % 2 == 0)
+				Settings->ControllerProfiles.Add(FBPVRControllerProfile(*FString::Printf(TEXT("Prop_%d"), i), Offset, OffsetRight));
+			else
+				Settings->ControllerProfiles.Add(FBPVRControllerProfile(*FString::Printf(TEXT("Prop_%d"), i), Offset));
+		}
+
+		const double RebuildStart = FPlatformTime::Seconds();
+		Settings->MarkControllerProfilesDirty();
+		Settings->FindControllerProfileRecord(Settings->ControllerProfiles[0].ControllerName);
+		const double RebuildSeconds = FPlatformTime::Seconds() - RebuildStart;
+
+		// Queries spread over every profile with one in ten missing, each left or right handed
+		TArray<FName> QueryNames;
+		TArray<bool> QueryHands;
+		for (int32 i = 0; i < 1024; ++i)
+		{
+			QueryNames.Add(Random.FRand() < 0.1f ? FName(TEXT("Missing"), i) : Settings->ControllerProfiles[Random.RandHelper(NumProfiles)].ControllerName);
+			QueryHands.Add(Random.FRand() < 0.5f);
+		}
+
+		int32 Checksum = 0;
+		int32 LinearChecksum = 0;
+
+		double Start = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumQueries; ++i)
+		{
+			const FVRControllerProfileRecord * Record = Settings->FindControllerProfileRecord(QueryNames[i & 1023]);
+			Checksum += Record ? Record->ProfileIndex : INDEX_NONE;
+		}
+		const double LookupSeconds = FPlatformTime::Seconds() - Start;
+
+		Start = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumQueries; ++i)
+		{
+			LinearChecksum += LinearFind(Settings, QueryNames[i & 1023]);
+		}
+		const double LinearLookupSeconds = FPlatformTime::Seconds() - Start;
+
+		TestEqual(FString::Printf(TEXT("%d profiles, lookups agree with the array search"), NumProfiles), Checksum, LinearChecksum);
+
+		const FTransform Socket(FRotator(10.f, 20.f, 30.f), FVector(5.f, -3.f, 8.f));
+		FVector Accumulated = FVector::ZeroVector;
+		FVector LinearAccumulated = FVector::ZeroVector;
+
+		Start = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumQueries; ++i)
+		{
+			if (const FVRControllerProfileRecord * Record = Settings->FindControllerProfileRecord(QueryNames[i & 1023]))
+				Accumulated += Record->Apply(Socket, QueryHands[i & 1023]).GetTranslation();
+		}
+		const double AdjustSeconds = FPlatformTime::Seconds() - Start;
+
+		// What AdjustTransformByControllerProfile did before, search then pick and multiply the offset
+		Start = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumQueries; ++i)
+		{
+			const FName ControllerProfileName = QueryNames[i & 1023];
+			const FBPVRControllerProfile * FoundProfile = Settings->ControllerProfiles.FindByPredicate([ControllerProfileName](const FBPVRControllerProfile & ArrayItem)
+			{
+				return ArrayItem.ControllerName == ControllerProfileName;
+			});
+
+			if (FoundProfile)
+				LinearAccumulated += (Socket * ((QueryHands[i & 1023] && FoundProfile->bUseSeperateHandOffsetTransforms) ? FoundProfile->SocketOffsetTransformRightHand : FoundProfile->SocketOffsetTransform)).GetTranslation();
+		}
+		const double LinearAdjustSeconds = FPlatformTime::Seconds() - Start;
+
+		TestTrue(FString::Printf(TEXT("%d profiles, adjustments agree with the array search"), NumProfiles), Accumulated.Equals(LinearAccumulated, FMath::Max(1.f, LinearAccumulated.Size() * 1.e-4f)));
+
+		AddInfo(FString::Printf(TEXT("%d profiles: %.2fM lookups/s (array search %.2fM), %.2fM adjustments/s (array search %.2fM), rebuild %.2f us"),
+			NumProfiles, NumQueries / LookupSeconds * 1.e-6, NumQueries / LinearLookupSeconds * 1.e-6, NumQueries / AdjustSeconds * 1.e-6, NumQueries / LinearAdjustSeconds * 1.e-6, RebuildSeconds * 1.e6));
+
+		Settings->MarkPendingKill();
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,235 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+#include "HAL/PlatformTime.h"
+#include "UObject/Package.h"
+#include "GameFramework/Actor.h"
+#include "Engine/ActorChannel.h"
+#include "GripScripts/VRGripScriptBase.h"
+#include "Tests/VRGripScriptTestTypes.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace VRGripScriptReplicationTests
+{
+	// The tracker only needs the channel to have an actor and an open packet, no connection behind it
+	UActorChannel * MakeChannel(int32 OpenPacketId)
+	{
+		UActorChannel * Channel = NewObject<UActorChannel>(GetTransientPackage(), NAME_None, RF_Transient);
+		Channel->Actor = GetMutableDefault<AActor>();
+		Channel->OpenPacketId.First = OpenPacketId;
+		return Channel;
+	}
+
+	TArray<UVRGripScriptBase*> MakeScripts(int32 NumScripts)
+	{
+		TArray<UVRGripScriptBase*> Scripts;
+		for (int32 i = 0; i < NumScripts; ++i)
+		{
+			Scripts.Add(NewObject<UVRGripScriptTickRecorder>(GetTransientPackage(), NAME_None, RF_Transient));
+		}
+		return Scripts;
+	}
+
+	// The revision is cached for the frame, every replication pass in the tests is its own frame
+	void NextReplicationFrame()
+	{
+		++GFrameCounter;
+	}
+
+	// What ReplicateScripts does on one channel, with the send assumed to be acknowledged straight away
+	bool ReplicateToChannel(FVRGripScriptReplicationTracker & Tracker, const TArray<UVRGripScriptBase*> & Scripts, const FVRGripScriptReplicationSettings & Settings, UActorChannel * Channel, bool bNetInitial = false, bool bAcknowledged = true)
+	{
+		if (!Tracker.BeginReplication(Scripts, Settings, Channel, bNetInitial))
+			return false;
+
+		Tracker.EndReplication(Channel, bAcknowledged);
+		return true;
+	}
+
+	int32 ReplicatePass(FVRGripScriptReplicationTracker & Tracker, const TArray<UVRGripScriptBase*> & Scripts, const FVRGripScriptReplicationSettings & Settings, const TArray<UActorChannel*> & Channels)
+	{
+		NextReplicationFrame();
+
+		int32 NumSent = 0;
+		for (UActorChannel * Channel : Channels)
+		{
+			NumSent += ReplicateToChannel(Tracker, Scripts, Settings, Channel) ? 1 : 0;
+		}
+		return NumSent;
+	}
+}
+
+using namespace VRGripScriptReplicationTests;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRGripScriptReplicationLateJoinTest, "VRExpansionPlugin.GripScriptReplication.LateJoin", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRGripScriptReplicationLateJoinTest::RunTest(const FString& Parameters)
+{
+	for (int32 bOnce = 0; bOnce < 2; ++bOnce)
+	{
+		const TCHAR * Mode = bOnce ? TEXT("once") : TEXT("tracked");
+
+		FVRGripScriptReplicationSettings Settings;
+		Settings.bReplicateScriptsOnce = bOnce != 0;
+
+		FVRGripScriptReplicationTracker Tracker;
+		TArray<UVRGripScriptBase*> Scripts = MakeScripts(3);
+		TArray<UActorChannel*> Channels = { MakeChannel(10), MakeChannel(11) };
+
+		TestEqual(FString::Printf(TEXT("%s: first pass sends to every connection"), Mode), ReplicatePass(Tracker, Scripts, Settings, Channels), 2);
+		TestEqual(FString::Printf(TEXT("%s: acknowledged connections are skipped"), Mode), ReplicatePass(Tracker, Scripts, Settings, Channels), 0);
+
+		// A client joins while the others are settled, it has never seen the scripts
+		UActorChannel * LateChannel = MakeChannel(40);
+		NextReplicationFrame();
+		TestFalse(FString::Printf(TEXT("%s: settled connection still skipped"), Mode), ReplicateToChannel(Tracker, Scripts, Settings, Channels[0]));
+		TestTrue(FString::Printf(TEXT("%s: late joiner gets the scripts"), Mode), ReplicateToChannel(Tracker, Scripts, Settings, LateChannel, true));
+		TestFalse(FString::Printf(TEXT("%s: settled connection skipped after the join"), Mode), ReplicateToChannel(Tracker, Scripts, Settings, Channels[1]));
+
+		Channels.Add(LateChannel);
+		TestEqual(FString::Printf(TEXT("%s: late joiner skipped once acknowledged"), Mode), ReplicatePass(Tracker, Scripts, Settings, Channels), 0);
+
+		// Scripts changed before the join, the joiner still needs everything
+		Scripts[1]->MarkScriptReplicationDirty();
+		UActorChannel * LaterChannel = MakeChannel(55);
+		NextReplicationFrame();
+		TestTrue(FString::Printf(TEXT("%s: joiner after a change gets the scripts"), Mode), ReplicateToChannel(Tracker, Scripts, Settings, LaterChannel, true));
+
+		int32 NumResent = 0;
+		for (UActorChannel * Channel : Channels)
+		{
+			NumResent += ReplicateToChannel(Tracker, Scripts, Settings, Channel) ? 1 : 0;
+		}
+		TestEqual(FString::Printf(TEXT("%s: settled connections after a change"), Mode), NumResent, bOnce ? 0 : 3);
+
+		// A pooled channel re-opening for the same actor is a new client as far as the scripts go
+		NextReplicationFrame();
+		Channels[0]->OpenPacketId.First = 90;
+		TestTrue(FString::Printf(TEXT("%s: re-opened channel gets the scripts"), Mode), ReplicateToChannel(Tracker, Scripts, Settings, Channels[0]));
+
+		// bNetInitial on a channel the tracker thought was settled, the client lost its copy
+		NextReplicationFrame();
+		TestTrue(FString::Printf(TEXT("%s: net initial always sends"), Mode), ReplicateToChannel(Tracker, Scripts, Settings, Channels[1], true));
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRGripScriptReplicationAcknowledgeTest, "VRExpansionPlugin.GripScriptReplication.Acknowledge", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRGripScriptReplicationAcknowledgeTest::RunTest(const FString& Parameters)
+{
+	FVRGripScriptReplicationSettings Settings;
+	Settings.bReplicateScriptsOnce = true;
+
+	FVRGripScriptReplicationTracker Tracker;
+	TArray<UVRGripScriptBase*> Scripts = MakeScripts(2);
+	UActorChannel * Channel = MakeChannel(7);
+
+	// Lost packets, the replicators still have changes in flight so the channel keeps being sent to
+	NextReplicationFrame();
+	TestTrue(TEXT("First send"), ReplicateToChannel(Tracker, Scripts, Settings, Channel, true, false));
+	NextReplicationFrame();
+	TestTrue(TEXT("Unacknowledged send is repeated"), ReplicateToChannel(Tracker, Scripts, Settings, Channel, false, false));
+	NextReplicationFrame();
+	TestTrue(TEXT("Repeated until acknowledged"), ReplicateToChannel(Tracker, Scripts, Settings, Channel, false, true));
+	NextReplicationFrame();
+	TestFalse(TEXT("Skipped once acknowledged"), ReplicateToChannel(Tracker, Scripts, Settings, Channel));
+
+	// Back to tracked, adding a script changes the set
+	Settings.bReplicateScriptsOnce = false;
+	Scripts.Add(NewObject<UVRGripScriptTickRecorder>(GetTransientPackage(), NAME_None, RF_Transient));
+	NextReplicationFrame();
+	TestTrue(TEXT("Added script is sent"), ReplicateToChannel(Tracker, Scripts, Settings, Channel));
+
+	// Changes inside the frame are picked up next frame, the pass shares one revision
+	Scripts[0]->MarkScriptReplicationDirty();
+	TestFalse(TEXT("Same frame keeps the cached revision"), ReplicateToChannel(Tracker, Scripts, Settings, Channel));
+	NextReplicationFrame();
+	TestTrue(TEXT("Next frame sees the change"), ReplicateToChannel(Tracker, Scripts, Settings, Channel));
+
+	// Closed channels drop their actor and their record
+	UActorChannel * ClosedChannel = MakeChannel(8);
+	ReplicateToChannel(Tracker, Scripts, Settings, ClosedChannel, true);
+	TestEqual(TEXT("Both channels tracked"), Tracker.GetNumTrackedChannels(), 2);
+	ClosedChannel->Actor = nullptr;
+	NextReplicationFrame();
+	ReplicateToChannel(Tracker, Scripts, Settings, Channel);
+	TestEqual(TEXT("Closed channel pruned"), Tracker.GetNumTrackedChannels(), 1);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRGripScriptReplicationBenchmark, "VRExpansionPlugin.GripScriptReplication.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRGripScriptReplicationBenchmark::RunTest(const FString& Parameters)
+{
+	const int32 GrippableCounts[] = { 100, 1000 };
+	const int32 ConnectionCounts[] = { 16, 64 };
+	const int32 NumPasses = 60;
+	const int32 ScriptsPerGrippable = 2;
+
+	FVRGripScriptReplicationSettings Settings;
+
+	for (int32 NumGrippables : GrippableCounts)
+	{
+		for (int32 NumConnections : ConnectionCounts)
+		{
+			FRandomStream Random(NumGrippables * NumConnections);
+
+			TArray<UActorChannel*> Channels;
+			for (int32 i = 0; i < NumConnections; ++i)
+			{
+				Channels.Add(MakeChannel(i + 1));
+			}
+
+			TArray<FVRGripScriptReplicationTracker> Trackers;
+			Trackers.SetNum(NumGrippables);
+			TArray<TArray<UVRGripScriptBase*>> Scripts;
+			for (int32 i = 0; i < NumGrippables; ++i)
+			{
+				Scripts.Add(MakeScripts(ScriptsPerGrippable));
+			}
+
+			int64 NumSent = 0;
+			double Seconds = 0.0;
+
+			for (int32 Pass = 0; Pass < NumPasses; ++Pass)
+			{
+				// A couple percent of the held props change script state each pass, every few passes a connection re-opens its channels
+				for (int32 i = 0; i < NumGrippables / 50; ++i)
+				{
+					Scripts[Random.RandRange(0, NumGrippables - 1)][Random.RandRange(0, ScriptsPerGrippable - 1)]->MarkScriptReplicationDirty();
+				}
+
+				UActorChannel * Joiner = (Pass % 10) == 5 ? Channels[Random.RandRange(0, NumConnections - 1)] : nullptr;
+				if (Joiner)
+					Joiner->OpenPacketId.First += NumConnections;
+
+				NextReplicationFrame();
+				const double Start = FPlatformTime::Seconds();
+				for (int32 i = 0; i < NumGrippables; ++i)
+				{
+					for (UActorChannel * Channel : Channels)
+					{
+						NumSent += ReplicateToChannel(Trackers[i], Scripts[i], Settings, Channel) ? 1 : 0;
+					}
+				}
+				Seconds += FPlatformTime::Seconds() - Start;
+			}
+
+			const int64 NumChecks = (int64)NumGrippables * NumConnections * NumPasses;
+			AddInfo(FString::Printf(TEXT("%d grippables x %d connections: %.1f script sets sent per pass tracked, %d untracked, %.1f ns bookkeeping per check"),
+				NumGrippables, NumConnections, (double)NumSent / NumPasses, NumGrippables * NumConnections, Seconds * 1e9 / NumChecks));
+
+			TestTrue(TEXT("Tracking skips most sends"), NumSent * 4 < NumChecks);
+		}
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
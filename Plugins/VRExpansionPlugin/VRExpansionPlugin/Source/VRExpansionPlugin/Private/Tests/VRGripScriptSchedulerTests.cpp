@@ -0,0 +1,376 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+#include "HAL/PlatformTime.h"
+#include "UObject/Package.h"
+#include "GripScripts/VRGripScriptScheduler.h"
+#include "Tests/VRGripScriptTestTypes.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace VRGripScriptSchedulerTests
+{
+	UVRGripScriptScheduler * MakeScheduler()
+	{
+		return NewObject<UVRGripScriptScheduler>(GetTransientPackage(), NAME_None, RF_Transient);
+	}
+
+	// Scripts are created the way BeginPlay would see them, they only tick once registered
+	UVRGripScriptTickRecorder * MakeScript(UClass * ScriptClass, int32 Id, EVRGripScriptTickPhase Phase, TArray<int32> * Log, bool bAwake = true)
+	{
+		UVRGripScriptTickRecorder * Script = NewObject<UVRGripScriptTickRecorder>(GetTransientPackage(), ScriptClass, NAME_None, RF_Transient);
+		Script->RecorderId = Id;
+		Script->TickLog = Log;
+		Script->bCanEverTick = true;
+		Script->bAllowTicking = bAwake;
+		Script->TickPhase = Phase;
+		return Script;
+	}
+
+	FString Describe(const TArray<int32> & Log)
+	{
+		FString Result;
+		for (int32 Id : Log)
+		{
+			Result += FString::Printf(Result.IsEmpty() ? TEXT("%d") : TEXT(", %d"), Id);
+		}
+		return Result;
+	}
+
+	// Ticks a phase and returns the ids in the order they ticked
+	TArray<int32> TickAndTake(UVRGripScriptScheduler * Scheduler, EVRGripScriptTickPhase Phase, TArray<int32> & Log)
+	{
+		Log.Reset();
+		Scheduler->TickPhase(Phase, 1.0f / 90.0f);
+		return Log;
+	}
+
+	// Same seed, same operations, same tick order. Ids ticked are logged per phase with -1 between phases
+	TArray<int32> RunScenario(int32 Seed, int32 NumScripts, int32 NumFrames, int32 & OutViolations)
+	{
+		FRandomStream Random(Seed);
+		TArray<int32> Log;
+		TArray<int32> Result;
+		OutViolations = 0;
+
+		UClass * Classes[] = { UVRGripScriptTickRecorder::StaticClass(), UVRGripScriptTickRecorderB::StaticClass(), UVRGripScriptTickRecorderC::StaticClass() };
+		UVRGripScriptScheduler * Scheduler = MakeScheduler();
+		TArray<UVRGripScriptTickRecorder *> Scripts;
+		TArray<bool> Registered;
+
+		for (int32 i = 0; i < NumScripts; ++i)
+		{
+			const EVRGripScriptTickPhase Phase = (EVRGripScriptTickPhase)Random.RandRange(0, (int32)EVRGripScriptTickPhase::MAX - 1);
+			UVRGripScriptTickRecorder * Script = MakeScript(Classes[Random.RandRange(0, 2)], i, Phase, &Log, Random.FRand() < 0.5f);
+			Script->bTickWhileHeld = Random.FRand() < 0.25f;
+			Scripts.Add(Script);
+			Registered.Add(Random.FRand() < 0.8f);
+
+			if (Registered.Last())
+				Scheduler->RegisterScript(Script);
+		}
+
+		// Some scripts flip others from inside their tick, registering and waking mid phase
+		for (UVRGripScriptTickRecorder * Script : Scripts)
+		{
+			if (Random.FRand() < 0.2f)
+			{
+				Script->OnTick = [&Random, &Scripts, &Registered, Scheduler](UVRGripScriptTickRecorder & Self)
+				{
+					const int32 Other = Random.RandRange(0, Scripts.Num() - 1);
+					if (!Registered[Other])
+					{
+						Scheduler->RegisterScript(Scripts[Other]);
+						Registered[Other] = true;
+					}
+					else
+						Scripts[Other]->SetTickEnabled(!Scripts[Other]->bAllowTicking);
+				};
+			}
+		}
+
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			for (int32 Op = 0; Op < 8; ++Op)
+			{
+				const int32 Index = Random.RandRange(0, Scripts.Num() - 1);
+				UVRGripScriptTickRecorder * Script = Scripts[Index];
+
+				switch (Random.RandRange(0, 3))
+				{
+				case 0:
+				{
+					if (Registered[Index])
+						Scheduler->UnregisterScript(Script);
+					else
+						Scheduler->RegisterScript(Script);
+
+					Registered[Index] = !Registered[Index];
+				}break;
+				case 1: Script->SetTickEnabled(!Script->bAllowTicking); break;
+				case 2: Script->SetOwnerHeld(true); break;
+				default: Script->SetOwnerHeld(false); break;
+				}
+			}
+
+			for (int32 PhaseIndex = 0; PhaseIndex < (int32)EVRGripScriptTickPhase::MAX; ++PhaseIndex)
+			{
+				const EVRGripScriptTickPhase Phase = (EVRGripScriptTickPhase)PhaseIndex;
+
+				TArray<bool> WasAwake;
+				for (int32 i = 0; i < Scripts.Num(); ++i)
+				{
+					WasAwake.Add(Registered[i] && Scripts[i]->TickPhase == Phase && Scripts[i]->ShouldBeAwake());
+					Scripts[i]->NumTicks = 0;
+				}
+
+				Result.Append(TickAndTake(Scheduler, Phase, Log));
+				Result.Add(-1);
+
+				// Asleep at the start of a phase or in another phase never ticks, nothing ticks twice
+				for (int32 i = 0; i < Scripts.Num(); ++i)
+				{
+					if (Scripts[i]->NumTicks > (WasAwake[i] ? 1 : 0))
+						++OutViolations;
+				}
+			}
+		}
+
+		for (UVRGripScriptTickRecorder * Script : Scripts)
+		{
+			Scheduler->UnregisterScript(Script);
+			Script->MarkPendingKill();
+		}
+
+		Scheduler->MarkPendingKill();
+		return Result;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRGripScriptSchedulerOrderingTest, "VRExpansionPlugin.GripScriptScheduler.Ordering", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRGripScriptSchedulerOrderingTest::RunTest(const FString& Parameters)
+{
+	using namespace VRGripScriptSchedulerTests;
+
+	TArray<int32> Log;
+	UVRGripScriptScheduler * Scheduler = MakeScheduler();
+	UClass * ClassA = UVRGripScriptTickRecorder::StaticClass();
+	UClass * ClassB = UVRGripScriptTickRecorderB::StaticClass();
+
+	UVRGripScriptTickRecorder * A1 = MakeScript(ClassA, 1, EVRGripScriptTickPhase::PostPhysics, &Log);
+	UVRGripScriptTickRecorder * B1 = MakeScript(ClassB, 2, EVRGripScriptTickPhase::PostPhysics, &Log);
+	UVRGripScriptTickRecorder * A2 = MakeScript(ClassA, 3, EVRGripScriptTickPhase::PostPhysics, &Log);
+	UVRGripScriptTickRecorder * B2 = MakeScript(ClassB, 4, EVRGripScriptTickPhase::PreGrip, &Log);
+	UVRGripScriptTickRecorder * A3 = MakeScript(ClassA, 5, EVRGripScriptTickPhase::PostPhysics, &Log, false);
+	UVRGripScriptTickRecorder * Scripts[] = { A1, B1, A2, B2, A3 };
+
+	for (UVRGripScriptTickRecorder * Script : Scripts)
+		Scheduler->RegisterScript(Script);
+
+	TestEqual(TEXT("Awake post physics scripts are counted"), Scheduler->GetNumAwakeScripts(EVRGripScriptTickPhase::PostPhysics), 3);
+	TestEqual(TEXT("Awake pre grip scripts are counted"), Scheduler->GetNumAwakeScripts(EVRGripScriptTickPhase::PreGrip), 1);
+
+	TArray<int32> Ticked = TickAndTake(Scheduler, EVRGripScriptTickPhase::PostPhysics, Log);
+	TestTrue(FString::Printf(TEXT("Batches tick in class registration order, scripts in wake order (%s)"), *Describe(Ticked)), Ticked == TArray<int32>({ 1, 3, 2 }));
+
+	Ticked = TickAndTake(Scheduler, EVRGripScriptTickPhase::PreGrip, Log);
+	TestTrue(TEXT("A phase only ticks its own scripts"), Ticked == TArray<int32>({ 4 }));
+
+	Ticked = TickAndTake(Scheduler, EVRGripScriptTickPhase::PostGrip, Log);
+	TestEqual(TEXT("An empty phase ticks nothing"), Ticked.Num(), 0);
+
+	// Sleeping outside of a phase swaps the last script into the slot
+	A1->SetTickEnabled(false);
+	A3->SetTickEnabled(true);
+	Ticked = TickAndTake(Scheduler, EVRGripScriptTickPhase::PostPhysics, Log);
+	TestTrue(FString::Printf(TEXT("Sleeping and waking re-orders within the batch only (%s)"), *Describe(Ticked)), Ticked == TArray<int32>({ 3, 5, 2 }));
+
+	A1->SetTickEnabled(true);
+	Ticked = TickAndTake(Scheduler, EVRGripScriptTickPhase::PostPhysics, Log);
+	TestTrue(FString::Printf(TEXT("A re-woken script goes to the back of its batch (%s)"), *Describe(Ticked)), Ticked == TArray<int32>({ 3, 5, 1, 2 }));
+
+	// Held scripts tick while held even with ticking off
+	B1->bTickWhileHeld = true;
+	B1->SetTickEnabled(false);
+	B1->SetOwnerHeld(true);
+	Ticked = TickAndTake(Scheduler, EVRGripScriptTickPhase::PostPhysics, Log);
+	TestTrue(TEXT("A held script with bTickWhileHeld ticks"), Ticked.Contains(2));
+
+	B1->SetOwnerHeld(false);
+	Scheduler->UnregisterScript(A3);
+	Ticked = TickAndTake(Scheduler, EVRGripScriptTickPhase::PostPhysics, Log);
+	TestTrue(FString::Printf(TEXT("Released and unregistered scripts stop ticking (%s)"), *Describe(Ticked)), Ticked == TArray<int32>({ 3, 1 }));
+	TestEqual(TEXT("The awake count follows"), Scheduler->GetNumAwakeScripts(EVRGripScriptTickPhase::PostPhysics), 2);
+
+	for (UVRGripScriptTickRecorder * Script : Scripts)
+	{
+		Scheduler->UnregisterScript(Script);
+		Script->MarkPendingKill();
+	}
+
+	Scheduler->MarkPendingKill();
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRGripScriptSchedulerMidPhaseTest, "VRExpansionPlugin.GripScriptScheduler.MidPhaseChanges", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRGripScriptSchedulerMidPhaseTest::RunTest(const FString& Parameters)
+{
+	using namespace VRGripScriptSchedulerTests;
+
+	TArray<int32> Log;
+	UVRGripScriptScheduler * Scheduler = MakeScheduler();
+	UClass * ClassA = UVRGripScriptTickRecorder::StaticClass();
+	UClass * ClassB = UVRGripScriptTickRecorderB::StaticClass();
+	UClass * ClassC = UVRGripScriptTickRecorderC::StaticClass();
+
+	TArray<UVRGripScriptTickRecorder *> Scripts;
+
+	// Fill the other phases first so the batch array has to grow when the new class shows up mid phase
+	for (int32 PhaseIndex = 0; PhaseIndex < (int32)EVRGripScriptTickPhase::PostPhysics; ++PhaseIndex)
+	{
+		Scripts.Add(MakeScript(ClassA, 10 + PhaseIndex, (EVRGripScriptTickPhase)PhaseIndex, &Log));
+		Scripts.Add(MakeScript(ClassB, 20 + PhaseIndex, (EVRGripScriptTickPhase)PhaseIndex, &Log));
+		Scripts.Add(MakeScript(ClassC, 30 + PhaseIndex, (EVRGripScriptTickPhase)PhaseIndex, &Log));
+	}
+
+	UVRGripScriptTickRecorder * A1 = Scripts.Add_GetRef(MakeScript(ClassA, 1, EVRGripScriptTickPhase::PostPhysics, &Log));
+	UVRGripScriptTickRecorder * A2 = Scripts.Add_GetRef(MakeScript(ClassA, 2, EVRGripScriptTickPhase::PostPhysics, &Log));
+	UVRGripScriptTickRecorder * B1 = Scripts.Add_GetRef(MakeScript(ClassB, 3, EVRGripScriptTickPhase::PostPhysics, &Log));
+	UVRGripScriptTickRecorder * B2 = Scripts.Add_GetRef(MakeScript(ClassB, 4, EVRGripScriptTickPhase::PostPhysics, &Log, false));
+
+	for (UVRGripScriptTickRecorder * Script : Scripts)
+		Scheduler->RegisterScript(Script);
+
+	// Not registered yet, the first of its class and phase
+	UVRGripScriptTickRecorder * C1 = Scripts.Add_GetRef(MakeScript(ClassC, 5, EVRGripScriptTickPhase::PostPhysics, &Log));
+
+	bool bChanged = false;
+	A1->OnTick = [&](UVRGripScriptTickRecorder & Self)
+	{
+		if (bChanged)
+			return;
+
+		bChanged = true;
+		Scheduler->RegisterScript(C1);
+		B2->SetTickEnabled(true);
+		B1->SetTickEnabled(false);
+		A2->SetTickEnabled(false);
+		A2->SetTickEnabled(true);
+	};
+
+	TArray<int32> Ticked = TickAndTake(Scheduler, EVRGripScriptTickPhase::PostPhysics, Log);
+	TestTrue(FString::Printf(TEXT("Scripts slept, woken or registered mid phase wait for the next frame (%s)"), *Describe(Ticked)), Ticked == TArray<int32>({ 1 }));
+
+	Ticked = TickAndTake(Scheduler, EVRGripScriptTickPhase::PostPhysics, Log);
+	TestTrue(FString::Printf(TEXT("Next frame they tick in batch order with the slept script gone (%s)"), *Describe(Ticked)), Ticked == TArray<int32>({ 1, 2, 4, 5 }));
+	TestEqual(TEXT("The awake count matches after compacting"), Scheduler->GetNumAwakeScripts(EVRGripScriptTickPhase::PostPhysics), 4);
+
+	Ticked = TickAndTake(Scheduler, EVRGripScriptTickPhase::PreGrip, Log);
+	TestTrue(FString::Printf(TEXT("Other phases are left alone (%s)"), *Describe(Ticked)), Ticked == TArray<int32>({ 10, 20, 30 }));
+
+	// A script killed mid phase is skipped
+	A1->OnTick = [A2](UVRGripScriptTickRecorder & Self) { A2->MarkPendingKill(); };
+	Ticked = TickAndTake(Scheduler, EVRGripScriptTickPhase::PostPhysics, Log);
+	TestFalse(TEXT("A script pending kill does not tick"), Ticked.Contains(2));
+
+	for (UVRGripScriptTickRecorder * Script : Scripts)
+	{
+		Scheduler->UnregisterScript(Script);
+		Script->MarkPendingKill();
+	}
+
+	Scheduler->MarkPendingKill();
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRGripScriptSchedulerDeterminismTest, "VRExpansionPlugin.GripScriptScheduler.Determinism", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRGripScriptSchedulerDeterminismTest::RunTest(const FString& Parameters)
+{
+	using namespace VRGripScriptSchedulerTests;
+
+	const int32 Seeds[] = { 0x6419, 0x51, 0x7E57 };
+	for (int32 Seed : Seeds)
+	{
+		int32 FirstViolations = 0;
+		int32 SecondViolations = 0;
+		const TArray<int32> First = RunScenario(Seed, 64, 120, FirstViolations);
+		const TArray<int32> Second = RunScenario(Seed, 64, 120, SecondViolations);
+
+		TestTrue(FString::Printf(TEXT("Seed %d ticks in the same order on every run"), Seed), First == Second);
+		TestEqual(FString::Printf(TEXT("Seed %d never ticks a script that was asleep or ticks one twice"), Seed), FirstViolations, 0);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRGripScriptSchedulerBenchmark, "VRExpansionPlugin.GripScriptScheduler.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRGripScriptSchedulerBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace VRGripScriptSchedulerTests;
+
+	UClass * Classes[] = { UVRGripScriptTickRecorder::StaticClass(), UVRGripScriptTickRecorderB::StaticClass(), UVRGripScriptTickRecorderC::StaticClass() };
+	const int32 ScriptCounts[] = { 100, 1000, 5000 };
+	const int32 NumFrames = 200;
+
+	for (int32 NumScripts : ScriptCounts)
+	{
+		FRandomStream Random(NumScripts);
+		UVRGripScriptScheduler * Scheduler = MakeScheduler();
+		TArray<UVRGripScriptTickRecorder *> Scripts;
+
+		// Half of them awake, the usual mix of props that only tick while held
+		for (int32 i = 0; i < NumScripts; ++i)
+		{
+			UVRGripScriptTickRecorder * Script = MakeScript(Classes[i % 3], i, EVRGripScriptTickPhase::PostPhysics, nullptr, (i & 1) == 0);
+			Scheduler->RegisterScript(Script);
+			Scripts.Add(Script);
+		}
+
+		double TickSeconds = 0.0;
+		double ChurnSeconds = 0.0;
+		int32 NumChurns = 0;
+
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			const double ChurnStart = FPlatformTime::Seconds();
+			for (int32 i = 0; i < 16; ++i)
+			{
+				UVRGripScriptTickRecorder * Script = Scripts[Random.RandRange(0, NumScripts - 1)];
+				Script->SetTickEnabled(!Script->bAllowTicking);
+				++NumChurns;
+			}
+			ChurnSeconds += FPlatformTime::Seconds() - ChurnStart;
+
+			const double TickStart = FPlatformTime::Seconds();
+			Scheduler->TickPhase(EVRGripScriptTickPhase::PostPhysics, 1.0f / 90.0f);
+			TickSeconds += FPlatformTime::Seconds() - TickStart;
+		}
+
+		int32 NumTicks = 0;
+		for (UVRGripScriptTickRecorder * Script : Scripts)
+			NumTicks += Script->NumTicks;
+
+		AddInfo(FString::Printf(TEXT("%d scripts: %.2f us per phase, %.3f us per awake script tick, %.3f us per wake or sleep"),
+			NumScripts, (TickSeconds * 1000000.0) / NumFrames, NumTicks ? (TickSeconds * 1000000.0) / NumTicks : 0.0, (ChurnSeconds * 1000000.0) / NumChurns));
+
+		TestTrue(FString::Printf(TEXT("%d scripts ticked"), NumScripts), NumTicks > 0);
+
+		for (UVRGripScriptTickRecorder * Script : Scripts)
+		{
+			Scheduler->UnregisterScript(Script);
+			Script->MarkPendingKill();
+		}
+
+		Scheduler->MarkPendingKill();
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GripScripts/VRGripScriptBase.h"
+#include "GripScripts/GS_Melee.h"
+#include "VRGripScriptTestTypes.generated.h"
+
+// Grip script that records when it ticks, only created by the scheduler tests
+UCLASS(Transient, NotBlueprintable, NotBlueprintType, HideDropdown)
+class UVRGripScriptTickRecorder : public UVRGripScriptBase
+{
+	GENERATED_BODY()
+public:
+
+	int32 RecorderId = 0;
+
+	// Shared between the recorders of a test, null to only count
+	TArray<int32> * TickLog = nullptr;
+	int32 NumTicks = 0;
+
+	// Runs inside of the tick, lets a test change the scheduler mid phase
+	TFunction<void(UVRGripScriptTickRecorder &)> OnTick;
+
+	virtual void Tick(float DeltaTime) override
+	{
+		++NumTicks;
+
+		if (TickLog)
+			TickLog->Add(RecorderId);
+
+		if (OnTick)
+			OnTick(*this);
+	}
+};
+
+// Second class so the tests get more than one batch
+UCLASS(Transient, NotBlueprintable, NotBlueprintType, HideDropdown)
+class UVRGripScriptTickRecorderB : public UVRGripScriptTickRecorder
+{
+	GENERATED_BODY()
+};
+
+UCLASS(Transient, NotBlueprintable, NotBlueprintType, HideDropdown)
+class UVRGripScriptTickRecorderC : public UVRGripScriptTickRecorder
+{
+	GENERATED_BODY()
+};
+
+// Melee script that lets the strike tests build and sweep chains without a gripping controller
+UCLASS(Transient, NotBlueprintable, NotBlueprintType, HideDropdown)
+class UGS_MeleeStrikeDriver : public UGS_Melee
+{
+	GENERATED_BODY()
+public:
+
+	typedef FMeleeSweepSegment FSegment;
+	typedef FMeleeSweepHit FHit;
+
+	void BuildChain(const FTransform & From, const FTransform & To, TArray<FSegment> & OutSegments) const
+	{
+		BuildSweepChain(From, To, OutSegments);
+	}
+
+	void Sweep(TArray<FSegment> & Segments, UPrimitiveComponent * Root, const FComponentQueryParams & Params, TArray<FHit> & OutHits)
+	{
+		SweepChain(Segments, Root, Params, OutHits);
+	}
+
+	bool HandleHits(const TArray<FHit> & Hits, const TArray<FSegment> & Segments, UPrimitiveComponent * Root)
+	{
+		return HandleStrikeHits(Hits, Segments, Root);
+	}
+};
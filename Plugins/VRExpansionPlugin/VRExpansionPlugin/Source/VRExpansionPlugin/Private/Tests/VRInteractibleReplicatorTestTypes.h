@@ -0,0 +1,25 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Interactibles/VRInteractibleReplicatorComponent.h"
+#include "VRInteractibleReplicatorTestTypes.generated.h"
+
+// Replicator that lets the tests run a replication pass and look at the array it produced
+UCLASS(Transient, NotBlueprintable, NotBlueprintType, HideDropdown)
+class UVRInteractibleReplicatorTestDriver : public UVRInteractibleReplicatorComponent
+{
+	GENERATED_BODY()
+public:
+
+	const FVRInteractibleStateArray & GetReplicatedStates() const { return ReplicatedStates; }
+
+	// What PreReplication runs once per replication pass
+	void GatherStates() { UpdateReplicatedStates(false); }
+
+	int32 GetInteractibleIndex(USceneComponent * Interactible) const
+	{
+		return Interactibles.IndexOfByPredicate([Interactible](const TWeakObjectPtr<USceneComponent> & Entry) { return Entry.Get() == Interactible; });
+	}
+};
@@ -0,0 +1,465 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+#include "HAL/PlatformTime.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/WorldSettings.h"
+#include "Serialization/BitWriter.h"
+#include "Serialization/BitReader.h"
+#include "Interactibles/VRLeverComponent.h"
+#include "Interactibles/VRDialComponent.h"
+#include "Interactibles/VRSliderComponent.h"
+#include "Interactibles/VRButtonComponent.h"
+#include "Tests/VRInteractibleReplicatorTestTypes.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace VRInteractibleReplicatorTests
+{
+	typedef UVRInteractibleReplicatorComponent FReplicator;
+
+	struct FReplicatorTestWorld
+	{
+		UWorld * World;
+
+		FReplicatorTestWorld()
+		{
+			World = UWorld::CreateWorld(EWorldType::Game, false);
+			FWorldContext & Context = GEngine->CreateNewWorldContext(EWorldType::Game);
+			Context.SetCurrentWorld(World);
+			World->InitializeActorsForPlay(FURL());
+			World->GetWorldSettings()->NotifyBeginPlay();
+		}
+
+		~FReplicatorTestWorld()
+		{
+			GEngine->DestroyWorldContext(World);
+			World->DestroyWorld(false);
+		}
+
+		AActor * SpawnPanel(ENetRole Role = ROLE_Authority)
+		{
+			AActor * Actor = World->SpawnActor<AActor>();
+			Actor->Role = Role;
+
+			USceneComponent * Root = NewObject<USceneComponent>(Actor, TEXT("Root"));
+			Actor->SetRootComponent(Root);
+			Root->RegisterComponent();
+			return Actor;
+		}
+	};
+
+	// Net addressable so it is gathered the same way a component from the actor class would be
+	template<class T>
+	T * AddInteractible(AActor * Actor, const FString & Name)
+	{
+		T * Interactible = NewObject<T>(Actor, T::StaticClass(), FName(*Name));
+		Interactible->SetNetAddressable();
+		Interactible->SetupAttachment(Actor->GetRootComponent());
+		Interactible->RegisterComponent();
+		return Interactible;
+	}
+
+	UVRInteractibleReplicatorTestDriver * AddReplicator(AActor * Actor)
+	{
+		UVRInteractibleReplicatorTestDriver * Replicator = NewObject<UVRInteractibleReplicatorTestDriver>(Actor, TEXT("InteractibleReplicator"));
+		Replicator->RegisterComponent();
+		Replicator->RefreshInteractibles();
+		return Replicator;
+	}
+
+	UVRDialComponent * AddDial(AActor * Actor, const FString & Name, float Clockwise, float CClockwise)
+	{
+		UVRDialComponent * Dial = AddInteractible<UVRDialComponent>(Actor, Name);
+		Dial->ClockwiseMaximumDialAngle = Clockwise;
+		Dial->CClockwiseMaximumDialAngle = CClockwise;
+		Dial->bDialUsesAngleSnap = false;
+		return Dial;
+	}
+
+	TMap<int32, int32> SnapshotKeys(const UVRInteractibleReplicatorTestDriver * Replicator)
+	{
+		TMap<int32, int32> Keys;
+		for (const FVRInteractibleStateItem & Item : Replicator->GetReplicatedStates().Items)
+			Keys.Add(Item.State.ComponentIndex, Item.ReplicationKey);
+
+		return Keys;
+	}
+
+	// Runs a replication pass and returns the interactible indices whose entries were marked dirty
+	TArray<int32> GatherChanged(UVRInteractibleReplicatorTestDriver * Replicator)
+	{
+		const TMap<int32, int32> Before = SnapshotKeys(Replicator);
+		Replicator->GatherStates();
+
+		TArray<int32> Changed;
+		for (const FVRInteractibleStateItem & Item : Replicator->GetReplicatedStates().Items)
+		{
+			const int32 * OldKey = Before.Find(Item.State.ComponentIndex);
+			if (!OldKey || *OldKey != Item.ReplicationKey)
+				Changed.Add(Item.State.ComponentIndex);
+		}
+
+		return Changed;
+	}
+
+	int64 SerializeState(FVRInteractibleQuantizedState & State, FVRInteractibleQuantizedState & OutRead)
+	{
+		FBitWriter Writer(256, true);
+		bool bSuccess = false;
+		State.NetSerialize(Writer, nullptr, bSuccess);
+
+		FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+		OutRead.NetSerialize(Reader, nullptr, bSuccess);
+
+		return (Reader.IsError() || Reader.GetBitsLeft() != 0) ? -1 : Writer.GetNumBits();
+	}
+}
+
+using namespace VRInteractibleReplicatorTests;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRInteractibleReplicatorQuantizationTest, "VRExpansionPlugin.InteractibleReplicator.Quantization", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRInteractibleReplicatorQuantizationTest::RunTest(const FString& Parameters)
+{
+	TestEqual(TEXT("1 step is 1 bit"), FReplicator::GetBitsForSteps(1), 1u);
+	TestEqual(TEXT("8 steps are 4 bits"), FReplicator::GetBitsForSteps(8), 4u);
+	TestEqual(TEXT("1023 steps are 10 bits"), FReplicator::GetBitsForSteps(1023), 10u);
+	TestEqual(TEXT("1024 steps are 11 bits"), FReplicator::GetBitsForSteps(1024), 11u);
+	TestEqual(TEXT("65535 steps are 16 bits"), FReplicator::GetBitsForSteps(65535), 16u);
+
+	struct FRange
+	{
+		float Min;
+		float Max;
+		uint32 Steps;
+	};
+
+	// Slider, lever, limited dial, full dial and a snapping dial
+	const FRange Ranges[] = { { 0.0f, 1.0f, 1023 }, { -30.0f, 90.0f, 1023 }, { -60.0f, 120.0f, 1023 }, { 0.0f, 360.0f, 1023 }, { 0.0f, 360.0f, 8 }, { -45.0f, 45.0f, 65535 } };
+
+	FRandomStream Random(39);
+	for (const FRange & Range : Ranges)
+	{
+		const FString Name = FString::Printf(TEXT("[%.0f, %.0f] over %u steps"), Range.Min, Range.Max, Range.Steps);
+		const float HalfStep = ((Range.Max - Range.Min) / Range.Steps) * 0.5f;
+		const float Tolerance = HalfStep + (Range.Max - Range.Min) * KINDA_SMALL_NUMBER;
+
+		TestEqual(Name + TEXT(" min is exact"), FReplicator::DequantizeValue(FReplicator::QuantizeValue(Range.Min, Range.Min, Range.Max, Range.Steps), Range.Min, Range.Max, Range.Steps), Range.Min);
+		TestEqual(Name + TEXT(" max is exact"), FReplicator::DequantizeValue(FReplicator::QuantizeValue(Range.Max, Range.Min, Range.Max, Range.Steps), Range.Min, Range.Max, Range.Steps), Range.Max);
+		TestEqual(Name + TEXT(" below the range clamps"), FReplicator::QuantizeValue(Range.Min - 10.0f, Range.Min, Range.Max, Range.Steps), 0u);
+		TestEqual(Name + TEXT(" above the range clamps"), FReplicator::QuantizeValue(Range.Max + 10.0f, Range.Min, Range.Max, Range.Steps), Range.Steps);
+
+		float MaxError = 0.0f;
+		uint32 LastQuantized = 0;
+		int32 NumNonMonotonic = 0;
+		int32 NumOverflows = 0;
+		const uint32 MaxEncodable = (1u << FReplicator::GetBitsForSteps(Range.Steps)) - 1u;
+
+		for (int32 i = 0; i <= 4096; ++i)
+		{
+			const float Value = FMath::Lerp(Range.Min, Range.Max, i / 4096.0f);
+			const uint32 Quantized = FReplicator::QuantizeValue(Value, Range.Min, Range.Max, Range.Steps);
+			MaxError = FMath::Max(MaxError, FMath::Abs(FReplicator::DequantizeValue(Quantized, Range.Min, Range.Max, Range.Steps) - Value));
+
+			if (Quantized < LastQuantized)
+				++NumNonMonotonic;
+			if (Quantized > MaxEncodable)
+				++NumOverflows;
+
+			LastQuantized = Quantized;
+		}
+
+		// Off grid random values as well as the sweep
+		for (int32 i = 0; i < 1024; ++i)
+		{
+			const float Value = Random.FRandRange(Range.Min, Range.Max);
+			MaxError = FMath::Max(MaxError, FMath::Abs(FReplicator::DequantizeValue(FReplicator::QuantizeValue(Value, Range.Min, Range.Max, Range.Steps), Range.Min, Range.Max, Range.Steps) - Value));
+		}
+
+		TestTrue(FString::Printf(TEXT("%s error %f within half a step %f"), *Name, MaxError, HalfStep), MaxError <= Tolerance);
+		TestEqual(Name + TEXT(" is monotonic"), NumNonMonotonic, 0);
+		TestEqual(Name + TEXT(" fits its bits"), NumOverflows, 0);
+	}
+
+	// NetSerialize round trips every value count and width, and costs the packed index, the 7 bit header and the values
+	for (int32 NumValues = 1; NumValues <= FVRInteractibleQuantizedState::MaxValues; ++NumValues)
+	{
+		for (uint32 Bits : { 1u, 4u, 10u, 16u, 32u })
+		{
+			FVRInteractibleQuantizedState State;
+			State.ComponentIndex = (uint16)Random.RandRange(0, 300);
+			State.NumValues = (uint8)NumValues;
+			State.BitsPerValue = (uint8)Bits;
+			for (int32 i = 0; i < NumValues; ++i)
+				State.Values[i] = (Bits == 32) ? (uint32)Random.GetUnsignedInt() : ((uint32)Random.GetUnsignedInt() & ((1u << Bits) - 1u));
+
+			FVRInteractibleQuantizedState Read;
+			const int64 NumBits = SerializeState(State, Read);
+			const int64 PayloadBits = 7 + NumValues * Bits;
+
+			TestTrue(FString::Printf(TEXT("%d values of %u bits read back cleanly"), NumValues, Bits), NumBits >= 0);
+			TestTrue(FString::Printf(TEXT("%d values of %u bits round trip"), NumValues, Bits), Read == State);
+			TestTrue(FString::Printf(TEXT("%d values of %u bits cost %lld bits"), NumValues, Bits, NumBits), NumBits >= PayloadBits + 1 && NumBits <= PayloadBits + 16);
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRInteractibleReplicatorChangeDetectionTest, "VRExpansionPlugin.InteractibleReplicator.ChangeDetection", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRInteractibleReplicatorChangeDetectionTest::RunTest(const FString& Parameters)
+{
+	FReplicatorTestWorld TestWorld;
+	AActor * Panel = TestWorld.SpawnPanel();
+
+	UVRSliderComponent * Slider = AddInteractible<UVRSliderComponent>(Panel, TEXT("Slider_A"));
+	UVRSliderComponent * OtherSlider = AddInteractible<UVRSliderComponent>(Panel, TEXT("Slider_B"));
+	UVRDialComponent * Dial = AddDial(Panel, TEXT("Dial_A"), 120.0f, 60.0f);
+	UVRDialComponent * SnapDial = AddDial(Panel, TEXT("Dial_B"), 180.0f, 180.0f);
+	SnapDial->bDialUsesAngleSnap = true;
+	SnapDial->SnapAngleIncrement = 45.0f;
+	SnapDial->SnapAngleThreshold = 45.0f;
+	UVRButtonComponent * Button = AddInteractible<UVRButtonComponent>(Panel, TEXT("Button_A"));
+	UVRLeverComponent * Lever = AddInteractible<UVRLeverComponent>(Panel, TEXT("Lever_A"));
+	Lever->LeverRotationAxis = EVRInteractibleLeverAxis::Axis_X;
+	Lever->LeverLimitNegative = 0.0f;
+	Lever->LeverLimitPositive = 90.0f;
+
+	Slider->CurrentSliderProgress = 0.5f;
+	OtherSlider->CurrentSliderProgress = 0.25f;
+	Dial->CurRotBackEnd = 10.0f;
+	SnapDial->CurRotBackEnd = 90.0f;
+	Button->bButtonState = false;
+	Lever->FullCurrentAngle = 0.0f;
+
+	UVRInteractibleReplicatorTestDriver * Replicator = AddReplicator(Panel);
+	TestEqual(TEXT("Every interactible is gathered"), Replicator->GetNumInteractibles(), 6);
+	TestEqual(TEXT("Every interactible has an entry"), Replicator->GetReplicatedStates().Items.Num(), 6);
+
+	const int32 SliderIndex = Replicator->GetInteractibleIndex(Slider);
+	const int32 DialIndex = Replicator->GetInteractibleIndex(Dial);
+	const int32 ButtonIndex = Replicator->GetInteractibleIndex(Button);
+	const int32 LeverIndex = Replicator->GetInteractibleIndex(Lever);
+	TestTrue(TEXT("Sorted by name"), Replicator->GetInteractibleIndex(Button) == 0 && Replicator->GetInteractibleIndex(OtherSlider) == 5);
+
+	for (const FVRInteractibleStateItem & Item : Replicator->GetReplicatedStates().Items)
+	{
+		if (Item.State.ComponentIndex == Replicator->GetInteractibleIndex(SnapDial))
+			TestEqual(TEXT("Always snapping dial sends its 8 snap steps in 4 bits"), (int32)Item.State.BitsPerValue, 4);
+		else if (Item.State.ComponentIndex == ButtonIndex)
+			TestEqual(TEXT("Button is a single bit"), (int32)Item.State.BitsPerValue, 1);
+		else
+			TestEqual(TEXT("Unsnapped interactibles use the default step count"), (int32)Item.State.BitsPerValue, 10);
+	}
+
+	TestEqual(TEXT("Nothing moved, nothing is dirtied"), GatherChanged(Replicator).Num(), 0);
+
+	// Movement inside of the same step is not worth a packet
+	Slider->CurrentSliderProgress = 0.5002f;
+	TestEqual(TEXT("Sub step slider movement is not sent"), GatherChanged(Replicator).Num(), 0);
+
+	Slider->CurrentSliderProgress = 0.6f;
+	TArray<int32> Changed = GatherChanged(Replicator);
+	TestTrue(TEXT("Slider movement dirties only the slider"), Changed.Num() == 1 && Changed[0] == SliderIndex);
+
+	// Off the clockwise end of the back end range is the counter clockwise side of the dial
+	Dial->CurRotBackEnd = 330.0f;
+	Lever->FullCurrentAngle = 45.0f;
+	Changed = GatherChanged(Replicator);
+	TestTrue(TEXT("Dial and lever movement dirty both of them"), Changed.Num() == 2 && Changed.Contains(DialIndex) && Changed.Contains(LeverIndex));
+
+	// Held interactibles are driven locally everywhere and go out once released
+	Slider->bIsHeld = true;
+	Slider->CurrentSliderProgress = 0.9f;
+	TestEqual(TEXT("Held slider is not sent"), GatherChanged(Replicator).Num(), 0);
+	Slider->bIsHeld = false;
+	Changed = GatherChanged(Replicator);
+	TestTrue(TEXT("Released slider is sent"), Changed.Num() == 1 && Changed[0] == SliderIndex);
+
+	Button->bButtonState = true;
+	Changed = GatherChanged(Replicator);
+	TestTrue(TEXT("Button toggle dirties only the button"), Changed.Num() == 1 && Changed[0] == ButtonIndex);
+
+	TestEqual(TEXT("Settled again"), GatherChanged(Replicator).Num(), 0);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRInteractibleReplicatorApplyTest, "VRExpansionPlugin.InteractibleReplicator.ServerToClient", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRInteractibleReplicatorApplyTest::RunTest(const FString& Parameters)
+{
+	FReplicatorTestWorld TestWorld;
+	AActor * ServerPanel = TestWorld.SpawnPanel(ROLE_Authority);
+	AActor * ClientPanel = TestWorld.SpawnPanel(ROLE_SimulatedProxy);
+
+	UVRSliderComponent * ServerSlider = AddInteractible<UVRSliderComponent>(ServerPanel, TEXT("Slider_A"));
+	UVRDialComponent * ServerDial = AddDial(ServerPanel, TEXT("Dial_A"), 120.0f, 60.0f);
+	UVRSliderComponent * ClientSlider = AddInteractible<UVRSliderComponent>(ClientPanel, TEXT("Slider_A"));
+	UVRDialComponent * ClientDial = AddDial(ClientPanel, TEXT("Dial_A"), 120.0f, 60.0f);
+
+	UVRInteractibleReplicatorTestDriver * ServerReplicator = AddReplicator(ServerPanel);
+	UVRInteractibleReplicatorTestDriver * ClientReplicator = AddReplicator(ClientPanel);
+
+	const float SliderStep = 1.0f / ServerReplicator->DefaultStepCount;
+	const float DialStep = 180.0f / ServerReplicator->DefaultStepCount;
+
+	FRandomStream Random(390);
+	float MaxSliderError = 0.0f;
+	float MaxDialError = 0.0f;
+
+	for (int32 i = 0; i < 256; ++i)
+	{
+		ServerSlider->CurrentSliderProgress = Random.FRand();
+
+		// Back end angles, 0 - 120 clockwise and 300 - 360 counter clockwise
+		const float DialAngle = Random.FRandRange(-60.0f, 120.0f);
+		ServerDial->CurRotBackEnd = DialAngle < 0.0f ? DialAngle + 360.0f : DialAngle;
+
+		ServerReplicator->GatherStates();
+
+		for (const FVRInteractibleStateItem & Item : ServerReplicator->GetReplicatedStates().Items)
+		{
+			FVRInteractibleQuantizedState State = Item.State;
+			FVRInteractibleQuantizedState Received;
+			SerializeState(State, Received);
+			ClientReplicator->ApplyState(Received, false);
+		}
+
+		MaxSliderError = FMath::Max(MaxSliderError, FMath::Abs(ClientSlider->CurrentSliderProgress - ServerSlider->CurrentSliderProgress));
+
+		float AngleError = FMath::Abs(ClientDial->CurRotBackEnd - ServerDial->CurRotBackEnd);
+		MaxDialError = FMath::Max(MaxDialError, FMath::Min(AngleError, 360.0f - AngleError));
+	}
+
+	TestTrue(FString::Printf(TEXT("Slider error %f within half a step"), MaxSliderError), MaxSliderError <= SliderStep * 0.5f + KINDA_SMALL_NUMBER);
+	TestTrue(FString::Printf(TEXT("Dial error %f within half a step"), MaxDialError), MaxDialError <= DialStep * 0.5f + 0.01f);
+
+	// The client drives its own held interactibles
+	ClientSlider->bIsHeld = true;
+	const float HeldProgress = ClientSlider->CurrentSliderProgress;
+	ServerSlider->CurrentSliderProgress = HeldProgress > 0.5f ? 0.1f : 0.9f;
+	ServerReplicator->GatherStates();
+	for (const FVRInteractibleStateItem & Item : ServerReplicator->GetReplicatedStates().Items)
+		ClientReplicator->ApplyState(Item.State, false);
+
+	TestEqual(TEXT("Held client slider is left alone"), ClientSlider->CurrentSliderProgress, HeldProgress);
+
+	// Mismatched configuration is dropped rather than applied at the wrong scale
+	ClientSlider->bIsHeld = false;
+	ClientReplicator->DefaultStepCount = 255;
+	for (const FVRInteractibleStateItem & Item : ServerReplicator->GetReplicatedStates().Items)
+		ClientReplicator->ApplyState(Item.State, false);
+
+	TestEqual(TEXT("Mismatched step count is dropped"), ClientSlider->CurrentSliderProgress, HeldProgress);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRInteractibleReplicatorBenchmark, "VRExpansionPlugin.InteractibleReplicator.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRInteractibleReplicatorBenchmark::RunTest(const FString& Parameters)
+{
+	// A control panel up to a whole cockpit, about a tenth of them moving at any one time at a 30hz net update
+	const int32 InteractibleCounts[] = { 10, 100, 500 };
+	const int32 NumPasses = 300;
+	const float NetUpdateRate = 30.0f;
+
+	for (int32 NumInteractibles : InteractibleCounts)
+	{
+		FReplicatorTestWorld TestWorld;
+		AActor * Panel = TestWorld.SpawnPanel();
+		FRandomStream Random(NumInteractibles);
+
+		TArray<UVRSliderComponent *> Sliders;
+		TArray<UVRDialComponent *> Dials;
+		TArray<UVRButtonComponent *> Buttons;
+
+		for (int32 i = 0; i < NumInteractibles; ++i)
+		{
+			const FString Name = FString::Printf(TEXT("Interactible_%04d"), i);
+			switch (i % 4)
+			{
+			case 0:
+			case 1: Sliders.Add(AddInteractible<UVRSliderComponent>(Panel, Name)); break;
+			case 2: Dials.Add(AddDial(Panel, Name, 135.0f, 135.0f)); break;
+			default: Buttons.Add(AddInteractible<UVRButtonComponent>(Panel, Name)); break;
+			}
+		}
+
+		UVRInteractibleReplicatorTestDriver * Replicator = AddReplicator(Panel);
+
+		double GatherSeconds = 0.0;
+		int64 NumChanged = 0;
+		int64 QuantizedBits = 0;
+		int64 TransformBits = 0;
+
+		for (int32 Pass = 0; Pass < NumPasses; ++Pass)
+		{
+			for (UVRSliderComponent * Slider : Sliders)
+			{
+				if (Random.FRand() < 0.1f)
+					Slider->CurrentSliderProgress = FMath::Clamp(Slider->CurrentSliderProgress + Random.FRandRange(-0.05f, 0.05f), 0.0f, 1.0f);
+			}
+
+			for (UVRDialComponent * Dial : Dials)
+			{
+				if (Random.FRand() < 0.1f)
+					Dial->CurRotBackEnd = FRotator::ClampAxis(Dial->CurRotBackEnd + Random.FRandRange(-10.0f, 10.0f));
+			}
+
+			for (UVRButtonComponent * Button : Buttons)
+			{
+				if (Random.FRand() < 0.02f)
+					Button->bButtonState = !Button->bButtonState;
+			}
+
+			const TMap<int32, int32> Before = SnapshotKeys(Replicator);
+
+			const double Start = FPlatformTime::Seconds();
+			Replicator->GatherStates();
+			GatherSeconds += FPlatformTime::Seconds() - Start;
+
+			for (const FVRInteractibleStateItem & Item : Replicator->GetReplicatedStates().Items)
+			{
+				const int32 * OldKey = Before.Find(Item.State.ComponentIndex);
+				if (OldKey && *OldKey == Item.ReplicationKey)
+					continue;
+
+				++NumChanged;
+
+				FBitWriter Writer(256, true);
+				FVRInteractibleQuantizedState State = Item.State;
+				bool bSuccess = false;
+				State.NetSerialize(Writer, nullptr, bSuccess);
+				QuantizedBits += Writer.GetNumBits();
+
+				// What movement replication sent for the same change, the relative location and rotation properties
+				// without the per component object and property headers, so the old cost is understated
+				FBitWriter TransformWriter(256, true);
+				FVector RelativeLocation = FVector::ZeroVector;
+				FRotator RelativeRotation = FRotator::ZeroRotator;
+				TransformWriter << RelativeLocation;
+				TransformWriter << RelativeRotation;
+				TransformBits += TransformWriter.GetNumBits();
+			}
+		}
+
+		const double Seconds = NumPasses / NetUpdateRate;
+		AddInfo(FString::Printf(TEXT("%d interactibles: %.2f changed per pass, %.1f bytes/s quantized vs %.1f bytes/s of raw relative transforms, %.2f us per gather"),
+			NumInteractibles, (double)NumChanged / NumPasses, (QuantizedBits / 8.0) / Seconds, (TransformBits / 8.0) / Seconds, (GatherSeconds * 1000000.0) / NumPasses));
+
+		TestTrue(FString::Printf(TEXT("%d interactibles changed"), NumInteractibles), NumChanged > 0);
+		TestTrue(FString::Printf(TEXT("%d interactibles cost under a quarter of their raw transforms"), NumInteractibles), QuantizedBits * 4 < TransformBits);
+	}
+
+	return true;
+}
+
+#endif
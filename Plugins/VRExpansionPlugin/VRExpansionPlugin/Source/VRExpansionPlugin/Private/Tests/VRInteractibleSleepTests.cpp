@@ -0,0 +1,248 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/WorldSettings.h"
+#include "Interactibles/VRInteractibleFunctionLibrary.h"
+#include "Interactibles/VRLeverComponent.h"
+#include "Interactibles/VRDialComponent.h"
+#include "Interactibles/VRSliderComponent.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace VRInteractibleSleepTests
+{
+	const float SleepTestFrameTime = 1.0f / 90.0f;
+
+	struct FSleepTestWorld
+	{
+		UWorld * World;
+		AActor * Owner;
+
+		FSleepTestWorld()
+		{
+			World = UWorld::CreateWorld(EWorldType::Game, false);
+			FWorldContext & Context = GEngine->CreateNewWorldContext(EWorldType::Game);
+			Context.SetCurrentWorld(World);
+			World->InitializeActorsForPlay(FURL());
+			World->GetWorldSettings()->NotifyBeginPlay();
+
+			Owner = World->SpawnActor<AActor>();
+			USceneComponent * Root = NewObject<USceneComponent>(Owner, TEXT("Root"));
+			Owner->SetRootComponent(Root);
+			Root->RegisterComponent();
+		}
+
+		~FSleepTestWorld()
+		{
+			GEngine->DestroyWorldContext(World);
+			World->DestroyWorld(false);
+		}
+
+		template<class T>
+		T * AddInteractible()
+		{
+			T * Interactible = NewObject<T>(Owner);
+			Interactible->SetupAttachment(Owner->GetRootComponent());
+			Interactible->RegisterComponent();
+			return Interactible;
+		}
+	};
+
+	struct FSleepCounts
+	{
+		int32 NumAwake;
+		int32 NumSleeping;
+
+		FSleepCounts() :
+			NumAwake(FVRInteractibleSleepState::GetNumAwake()),
+			NumSleeping(FVRInteractibleSleepState::GetNumSleeping())
+		{}
+	};
+
+	// Ticks the way the tick manager would, only while the tick is enabled, returns how many ticks it took to fall asleep
+	int32 TickUntilAsleep(UActorComponent * Interactible, int32 MaxTicks)
+	{
+		for (int32 NumTicks = 0; NumTicks < MaxTicks; ++NumTicks)
+		{
+			if (!Interactible->IsComponentTickEnabled())
+				return NumTicks;
+
+			Interactible->TickComponent(SleepTestFrameTime, LEVELTICK_All, nullptr);
+		}
+
+		return Interactible->IsComponentTickEnabled() ? -1 : MaxTicks;
+	}
+}
+
+using namespace VRInteractibleSleepTests;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRInteractibleSleepCountsTest, "VRExpansionPlugin.InteractibleSleep.Counts", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRInteractibleSleepCountsTest::RunTest(const FString& Parameters)
+{
+	FSleepTestWorld TestWorld;
+	const FSleepCounts Baseline;
+
+	// Interactibles start with their tick off, they register as sleeping
+	UVRDialComponent * Dial = TestWorld.AddInteractible<UVRDialComponent>();
+	TestFalse(TEXT("Registered dial is not ticking"), Dial->IsComponentTickEnabled());
+	TestEqual(TEXT("Registered dial counts as sleeping"), FVRInteractibleSleepState::GetNumSleeping(), Baseline.NumSleeping + 1);
+	TestEqual(TEXT("Registered dial is not awake"), FVRInteractibleSleepState::GetNumAwake(), Baseline.NumAwake);
+
+	Dial->SleepState.Wake(Dial);
+	Dial->SleepState.Wake(Dial);
+	TestTrue(TEXT("Woken dial ticks"), Dial->IsComponentTickEnabled());
+	TestEqual(TEXT("Waking twice counts once"), FVRInteractibleSleepState::GetNumAwake(), Baseline.NumAwake + 1);
+	TestEqual(TEXT("Woken dial left the sleeping count"), FVRInteractibleSleepState::GetNumSleeping(), Baseline.NumSleeping);
+
+	Dial->SleepState.Sleep(Dial);
+	TestFalse(TEXT("Slept dial stops ticking"), Dial->IsComponentTickEnabled());
+	TestEqual(TEXT("Slept dial counts as sleeping"), FVRInteractibleSleepState::GetNumSleeping(), Baseline.NumSleeping + 1);
+
+	// Unregistered while awake, both counts go back to where they were
+	Dial->SleepState.Wake(Dial);
+	Dial->DestroyComponent();
+	TestEqual(TEXT("Destroyed dial leaves the awake count"), FVRInteractibleSleepState::GetNumAwake(), Baseline.NumAwake);
+	TestEqual(TEXT("Destroyed dial leaves the sleeping count"), FVRInteractibleSleepState::GetNumSleeping(), Baseline.NumSleeping);
+
+	// A state that was never registered toggles the tick without touching the counts
+	UVRDialComponent * Unregistered = NewObject<UVRDialComponent>(TestWorld.Owner);
+	FVRInteractibleSleepState LooseState;
+	LooseState.Wake(Unregistered);
+	TestTrue(TEXT("Unregistered state is awake"), LooseState.IsAwake());
+	TestEqual(TEXT("Unregistered state is not counted"), FVRInteractibleSleepState::GetNumAwake(), Baseline.NumAwake);
+
+	int32 NumAwake = 0;
+	int32 NumSleeping = 0;
+	UVRInteractibleFunctionLibrary::Interactible_GetSleepCounts(NumAwake, NumSleeping);
+	TestEqual(TEXT("Blueprint awake count"), NumAwake, FVRInteractibleSleepState::GetNumAwake());
+	TestEqual(TEXT("Blueprint sleeping count"), NumSleeping, FVRInteractibleSleepState::GetNumSleeping());
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRInteractibleSleepSettleTest, "VRExpansionPlugin.InteractibleSleep.Settle", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRInteractibleSleepSettleTest::RunTest(const FString& Parameters)
+{
+	FSleepTestWorld TestWorld;
+	const FSleepCounts Baseline;
+
+	// Dial released off center lerps back at DialReturnSpeed and goes to sleep when it arrives
+	UVRDialComponent * Dial = TestWorld.AddInteractible<UVRDialComponent>();
+	Dial->bLerpBackOnRelease = true;
+	Dial->SetDialAngle(90.f);
+	Dial->OnGripRelease_Implementation(nullptr, FBPActorGripInformation(), false);
+	TestTrue(TEXT("Released dial lerps"), Dial->bIsLerping && Dial->IsComponentTickEnabled());
+
+	const int32 ExpectedDialTicks = FMath::CeilToInt(90.f / (Dial->DialReturnSpeed * SleepTestFrameTime));
+	const int32 DialTicks = TickUntilAsleep(Dial, ExpectedDialTicks * 2);
+	TestTrue(FString::Printf(TEXT("Dial slept after lerping back (%d ticks, %d expected)"), DialTicks, ExpectedDialTicks), DialTicks > 0 && DialTicks <= ExpectedDialTicks + 1);
+	TestFalse(TEXT("Dial done lerping"), Dial->bIsLerping);
+
+	// Released without a lerp, the dial never needs a tick
+	Dial->bLerpBackOnRelease = false;
+	Dial->SleepState.Wake(Dial);
+	Dial->OnGripRelease_Implementation(nullptr, FBPActorGripInformation(), false);
+	TestFalse(TEXT("Dial released without lerp sleeps"), Dial->IsComponentTickEnabled());
+
+	// Lever that stays where it was dropped sleeps on release, and wakes for a single tick when replicated movement comes in
+	UVRLeverComponent * Lever = TestWorld.AddInteractible<UVRLeverComponent>();
+	Lever->LeverReturnTypeWhenReleased = EVRInteractibleLeverReturnType::Stay;
+	Lever->SleepState.Wake(Lever);
+	Lever->OnGripRelease_Implementation(nullptr, FBPActorGripInformation(), false);
+	TestFalse(TEXT("Staying lever sleeps on release"), Lever->IsComponentTickEnabled());
+
+	Lever->bReplicateMovement = true;
+	Lever->PostRepNotifies();
+	TestTrue(TEXT("Replicated movement wakes the lever"), Lever->IsComponentTickEnabled());
+	TestEqual(TEXT("Lever settles after refreshing its angle"), TickUntilAsleep(Lever, 10), 1);
+
+	// Held levers ignore replicated movement, the holder drives them
+	Lever->bIsHeld = true;
+	Lever->PostRepNotifies();
+	TestFalse(TEXT("Held lever is not woken by replication"), Lever->IsComponentTickEnabled());
+	Lever->bIsHeld = false;
+
+	// Lerping back to zero, it only ticks until it gets there
+	Lever->LeverReturnTypeWhenReleased = EVRInteractibleLeverReturnType::ReturnToZero;
+	Lever->OnGripRelease_Implementation(nullptr, FBPActorGripInformation(), false);
+	TestTrue(TEXT("Lerping lever is awake"), Lever->IsComponentTickEnabled());
+	TestTrue(TEXT("Lerping lever sleeps once it settles"), TickUntilAsleep(Lever, 600) > 0);
+
+	// Something woke the slider while it had nothing to do, it goes back to sleep on its next tick
+	UVRSliderComponent * Slider = TestWorld.AddInteractible<UVRSliderComponent>();
+	Slider->SetComponentTickEnabled(true);
+	TestEqual(TEXT("Idle slider sleeps on its next tick"), TickUntilAsleep(Slider, 10), 1);
+
+	const FSleepCounts Settled;
+	TestEqual(TEXT("Nothing left awake"), Settled.NumAwake, Baseline.NumAwake);
+	TestEqual(TEXT("All three sleeping"), Settled.NumSleeping, Baseline.NumSleeping + 3);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRInteractibleSleepBenchmark, "VRExpansionPlugin.InteractibleSleep.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRInteractibleSleepBenchmark::RunTest(const FString& Parameters)
+{
+	const int32 InteractibleCounts[] = { 100, 1000, 5000 };
+	const int32 NumFrames = 60;
+
+	for (int32 NumInteractibles : InteractibleCounts)
+	{
+		FSleepTestWorld TestWorld;
+		TArray<UVRLeverComponent *> Levers;
+
+		for (int32 i = 0; i < NumInteractibles; ++i)
+		{
+			UVRLeverComponent * Lever = TestWorld.AddInteractible<UVRLeverComponent>();
+			Lever->LeverReturnTypeWhenReleased = EVRInteractibleLeverReturnType::Stay;
+			Levers.Add(Lever);
+		}
+
+		// Every lever awake for the frame, what an idle scene cost when levers ticked until grabbed again
+		double AwakeSeconds = 0.0;
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			for (UVRLeverComponent * Lever : Levers)
+			{
+				Lever->SleepState.Wake(Lever);
+			}
+
+			const double Start = FPlatformTime::Seconds();
+			TestWorld.World->Tick(LEVELTICK_All, SleepTestFrameTime);
+			AwakeSeconds += FPlatformTime::Seconds() - Start;
+		}
+
+		int32 NumStillAwake = 0;
+		for (UVRLeverComponent * Lever : Levers)
+		{
+			NumStillAwake += Lever->IsComponentTickEnabled() ? 1 : 0;
+		}
+
+		// Settled, the tick manager has nothing of ours to run
+		double SleepingSeconds = 0.0;
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			const double Start = FPlatformTime::Seconds();
+			TestWorld.World->Tick(LEVELTICK_All, SleepTestFrameTime);
+			SleepingSeconds += FPlatformTime::Seconds() - Start;
+		}
+
+		AddInfo(FString::Printf(TEXT("%d idle levers: world tick %.3f ms awake, %.3f ms asleep (%d awake / %d sleeping)"),
+			NumInteractibles, AwakeSeconds * 1000.0 / NumFrames, SleepingSeconds * 1000.0 / NumFrames,
+			FVRInteractibleSleepState::GetNumAwake(), FVRInteractibleSleepState::GetNumSleeping()));
+
+		TestEqual(TEXT("Idle levers fell asleep after one tick"), NumStillAwake, 0);
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
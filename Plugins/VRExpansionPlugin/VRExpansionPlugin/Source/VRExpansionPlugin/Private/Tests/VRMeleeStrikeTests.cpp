@@ -0,0 +1,306 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+#include "HAL/PlatformTime.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Engine/CollisionProfile.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/WorldSettings.h"
+#include "Components/BoxComponent.h"
+#include "Tests/VRGripScriptTestTypes.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/**
+* A staff held at its center is spun StrikeArc degrees around the vertical while the hand moves StrikeReach forward,
+* posts stand where the staff passes through during the swing. One sweep at the final rotation only finds what is
+* there at the end of the swing, a substepped chain has to find every post along the arc in the order it reached them.
+*/
+namespace VRMeleeStrikeTests
+{
+	const float StrikeArc = 120.0f;
+	const float StrikeReach = 10.0f;
+	const float StaffHalfLength = 60.0f;
+	const float StaffHalfThickness = 1.5f;
+	const float PostRadius = 45.0f;
+	const float PostHalfWidth = 8.0f;
+
+	FTransform GetStaffPose(float Alpha)
+	{
+		return FTransform(FRotator(0.0f, StrikeArc * Alpha, 0.0f), FVector(StrikeReach * Alpha, 0.0f, 0.0f));
+	}
+
+	// Makes a box block everything, query only so nothing simulates
+	UBoxComponent * MakeBox(AActor * Actor, const FVector & Extent, const FTransform & Transform)
+	{
+		UBoxComponent * Box = NewObject<UBoxComponent>(Actor);
+		Box->SetMobility(EComponentMobility::Movable);
+		Box->SetBoxExtent(Extent, false);
+		Box->SetCollisionProfileName(UCollisionProfile::BlockAllDynamic_ProfileName);
+		Box->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+		Box->SetWorldTransform(Transform);
+		Actor->SetRootComponent(Box);
+		Box->RegisterComponent();
+		return Box;
+	}
+
+	struct FStrikeTestWorld
+	{
+		UWorld * World;
+		AActor * StaffActor;
+		UBoxComponent * Staff;
+		UGS_MeleeStrikeDriver * Melee;
+
+		FStrikeTestWorld()
+		{
+			World = UWorld::CreateWorld(EWorldType::Game, false);
+			FWorldContext & Context = GEngine->CreateNewWorldContext(EWorldType::Game);
+			Context.SetCurrentWorld(World);
+			World->InitializeActorsForPlay(FURL());
+			World->GetWorldSettings()->NotifyBeginPlay();
+
+			StaffActor = World->SpawnActor<AActor>();
+			Staff = MakeBox(StaffActor, FVector(StaffHalfLength, StaffHalfThickness, StaffHalfThickness), GetStaffPose(0.0f));
+
+			// Outered to the staff so it sweeps in this world
+			Melee = NewObject<UGS_MeleeStrikeDriver>(StaffActor, NAME_None, RF_Transient);
+		}
+
+		~FStrikeTestWorld()
+		{
+			GEngine->DestroyWorldContext(World);
+			World->DestroyWorld(false);
+		}
+
+		// Stands where the staffs far end passes at AngleDeg into the swing
+		UBoxComponent * SpawnPost(float AngleDeg)
+		{
+			const float Alpha = AngleDeg / StrikeArc;
+			const FVector Location = GetStaffPose(Alpha).GetLocation() + FRotator(0.0f, AngleDeg, 0.0f).RotateVector(FVector(PostRadius, 0.0f, 0.0f));
+
+			FActorSpawnParameters SpawnParams;
+			SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+			AActor * PostActor = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParams);
+			return MakeBox(PostActor, FVector(PostHalfWidth, PostHalfWidth, 50.0f), FTransform(Location));
+		}
+
+		void SetSubsteps(int32 MaxSubsteps)
+		{
+			Melee->bSubstepTrace = MaxSubsteps > 1;
+			Melee->MaxSubsteps = MaxSubsteps;
+			Melee->SubstepAngle = 1.0f;
+		}
+
+		TArray<UGS_MeleeStrikeDriver::FHit> Strike(TArray<UGS_MeleeStrikeDriver::FSegment> & OutSegments, UPrimitiveComponent * IgnoredPost = nullptr)
+		{
+			FComponentQueryParams Params(NAME_None, StaffActor);
+			Params.bReturnPhysicalMaterial = true;
+			if (IgnoredPost)
+				Params.AddIgnoredComponent(IgnoredPost);
+
+			Melee->BuildChain(GetStaffPose(0.0f), GetStaffPose(1.0f), OutSegments);
+
+			TArray<UGS_MeleeStrikeDriver::FHit> Hits;
+			Melee->Sweep(OutSegments, Staff, Params, Hits);
+			return Hits;
+		}
+	};
+
+	bool AllHitsOn(const TArray<UGS_MeleeStrikeDriver::FHit> & Hits, UPrimitiveComponent * Post)
+	{
+		for (const UGS_MeleeStrikeDriver::FHit & Hit : Hits)
+		{
+			if (Hit.Hit.Component.Get() != Post)
+				return false;
+		}
+
+		return Hits.Num() > 0;
+	}
+}
+
+using namespace VRMeleeStrikeTests;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRMeleeStrikeChainTest, "VRExpansionPlugin.MeleeStrike.SweepChain", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRMeleeStrikeChainTest::RunTest(const FString& Parameters)
+{
+	UGS_MeleeStrikeDriver * Melee = NewObject<UGS_MeleeStrikeDriver>(GetTransientPackage(), NAME_None, RF_Transient);
+	const FTransform From = GetStaffPose(0.0f);
+	const FTransform To = GetStaffPose(1.0f);
+	TArray<UGS_MeleeStrikeDriver::FSegment> Segments;
+
+	Melee->bSubstepTrace = false;
+	Melee->BuildChain(From, To, Segments);
+	TestEqual(TEXT("Without substepping the strike is one sweep"), Segments.Num(), 1);
+
+	struct FCase
+	{
+		float SubstepAngle;
+		int32 MaxSubsteps;
+		int32 Expected;
+	};
+
+	// 120 degrees of swing: 15 degree steps, clamped by the cap, finer than the cap allows, and coarser than the swing
+	const FCase Cases[] = { { 15.0f, 8, 8 }, { 7.0f, 8, 8 }, { 7.0f, 32, 18 }, { 200.0f, 8, 1 } };
+
+	for (const FCase & Case : Cases)
+	{
+		Melee->bSubstepTrace = true;
+		Melee->SubstepAngle = Case.SubstepAngle;
+		Melee->MaxSubsteps = Case.MaxSubsteps;
+		Melee->BuildChain(From, To, Segments);
+
+		const FString Name = FString::Printf(TEXT("%.0f degree steps capped at %d"), Case.SubstepAngle, Case.MaxSubsteps);
+		TestEqual(Name + TEXT(" segment count"), Segments.Num(), Case.Expected);
+
+		if (!Segments.Num())
+			continue;
+
+		TestTrue(Name + TEXT(" starts at the current transform"), Segments[0].Start.Equals(From, 0.0f));
+		TestTrue(Name + TEXT(" ends exactly at the target"), Segments.Last().End.Equals(To, 0.0f));
+
+		const float ExpectedStep = StrikeArc / Segments.Num();
+		int32 NumGaps = 0;
+		int32 NumUneven = 0;
+		for (int32 i = 0; i < Segments.Num(); ++i)
+		{
+			if (i > 0 && !Segments[i].Start.Equals(Segments[i - 1].End, 0.0f))
+				++NumGaps;
+
+			const float StepAngle = FMath::RadiansToDegrees(Segments[i].Start.GetRotation().AngularDistance(Segments[i].End.GetRotation()));
+			if (!FMath::IsNearlyEqual(StepAngle, ExpectedStep, 0.05f))
+				++NumUneven;
+		}
+
+		TestEqual(Name + TEXT(" segments are chained end to start"), NumGaps, 0);
+		TestEqual(Name + TEXT(" segments split the rotation evenly"), NumUneven, 0);
+	}
+
+	Melee->MarkPendingKill();
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRMeleeStrikeArcTest, "VRExpansionPlugin.MeleeStrike.ArcCoverage", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRMeleeStrikeArcTest::RunTest(const FString& Parameters)
+{
+	FStrikeTestWorld TestWorld;
+	TArray<UGS_MeleeStrikeDriver::FSegment> Segments;
+
+	for (float PostAngle : { 30.0f, 50.0f, 70.0f, 95.0f })
+	{
+		UBoxComponent * Post = TestWorld.SpawnPost(PostAngle);
+
+		TestWorld.SetSubsteps(1);
+		TArray<UGS_MeleeStrikeDriver::FHit> Hits = TestWorld.Strike(Segments);
+		TestEqual(FString::Printf(TEXT("A single sweep misses the post at %.0f degrees"), PostAngle), Hits.Num(), 0);
+
+		TestWorld.SetSubsteps(8);
+		Hits = TestWorld.Strike(Segments);
+		TestTrue(FString::Printf(TEXT("The substepped arc hits the post at %.0f degrees"), PostAngle), AllHitsOn(Hits, Post));
+
+		// Contact is found by the first segment whose rotation reaches the post, within a segment of where it stands
+		const float ExpectedImpact = PostAngle / StrikeArc;
+		for (const UGS_MeleeStrikeDriver::FHit & Hit : Hits)
+		{
+			TestTrue(FString::Printf(TEXT("Post at %.0f degrees is reached at %.3f of the swing"), PostAngle, Hit.TimeOfImpact),
+				Hit.TimeOfImpact <= ExpectedImpact + (1.0f / Segments.Num()) && Hit.TimeOfImpact >= ExpectedImpact - (2.0f / Segments.Num()));
+			TestTrue(TEXT("Time of impact matches its segment"), FMath::FloorToInt(Hit.TimeOfImpact * Segments.Num() + KINDA_SMALL_NUMBER) == Hit.Segment);
+		}
+
+		Post->GetOwner()->Destroy();
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRMeleeStrikeOrderTest, "VRExpansionPlugin.MeleeStrike.TimeOfImpactOrder", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRMeleeStrikeOrderTest::RunTest(const FString& Parameters)
+{
+	FStrikeTestWorld TestWorld;
+	TestWorld.SetSubsteps(8);
+
+	UBoxComponent * NearPost = TestWorld.SpawnPost(50.0f);
+	UBoxComponent * FarPost = TestWorld.SpawnPost(95.0f);
+	const FTransform FarPostTransform = FarPost->GetComponentTransform();
+
+	// The chain stops at the first segment that hit something, the far post is behind it
+	TArray<UGS_MeleeStrikeDriver::FSegment> Segments;
+	TArray<UGS_MeleeStrikeDriver::FHit> NearHits = TestWorld.Strike(Segments);
+	TestTrue(TEXT("Only the near post is reported"), AllHitsOn(NearHits, NearPost));
+
+	TArray<UGS_MeleeStrikeDriver::FSegment> FarSegments;
+	TArray<UGS_MeleeStrikeDriver::FHit> FarHits = TestWorld.Strike(FarSegments, NearPost);
+	TestTrue(TEXT("The far post is found with the near one out of the way"), AllHitsOn(FarHits, FarPost));
+
+	if (!NearHits.Num() || !FarHits.Num())
+		return false;
+
+	TestTrue(TEXT("The near post is reached first"), NearHits[0].TimeOfImpact < FarHits[0].TimeOfImpact);
+
+	for (const UGS_MeleeStrikeDriver::FHit & Hit : NearHits)
+		TestTrue(TEXT("Hits carry a physical material to lodge with"), Hit.Hit.PhysMaterial.IsValid());
+
+	// Handed over in the wrong order the strike still lodges in what the arc reached first, and only in that
+	TArray<UGS_MeleeStrikeDriver::FHit> Unordered = FarHits;
+	Unordered.Append(NearHits);
+
+	TestWorld.Melee->HandleHits(Unordered, Segments, TestWorld.Staff);
+	TestTrue(TEXT("Strike lodged"), TestWorld.Melee->bLodged);
+	TestTrue(TEXT("Lodged in the near post"), TestWorld.Melee->LodgeParent.Get() == NearPost);
+	TestTrue(TEXT("The far post was left alone"), FarPost->GetComponentTransform().Equals(FarPostTransform, 0.0f));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRMeleeStrikeBenchmark, "VRExpansionPlugin.MeleeStrike.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRMeleeStrikeBenchmark::RunTest(const FString& Parameters)
+{
+	// Detection rate against cost, one post at a random point of the swing per strike
+	const int32 SubstepCounts[] = { 1, 4, 8, 16 };
+	const int32 NumStrikes = 200;
+
+	FStrikeTestWorld TestWorld;
+	float LastDetectionRate = 0.0f;
+
+	for (int32 Substeps : SubstepCounts)
+	{
+		TestWorld.SetSubsteps(Substeps);
+		FRandomStream Random(40);
+
+		int32 NumDetected = 0;
+		double StrikeSeconds = 0.0;
+		TArray<UGS_MeleeStrikeDriver::FSegment> Segments;
+
+		for (int32 i = 0; i < NumStrikes; ++i)
+		{
+			UBoxComponent * Post = TestWorld.SpawnPost(Random.FRandRange(20.0f, StrikeArc - 20.0f));
+
+			const double Start = FPlatformTime::Seconds();
+			TArray<UGS_MeleeStrikeDriver::FHit> Hits = TestWorld.Strike(Segments);
+			StrikeSeconds += FPlatformTime::Seconds() - Start;
+
+			if (AllHitsOn(Hits, Post))
+				++NumDetected;
+
+			Post->GetOwner()->Destroy();
+		}
+
+		const float DetectionRate = (float)NumDetected / NumStrikes;
+		AddInfo(FString::Printf(TEXT("%d segments: %.0f%% of posts hit, %.2f us per strike"), Substeps, DetectionRate * 100.0f, (StrikeSeconds * 1000000.0) / NumStrikes));
+
+		TestTrue(FString::Printf(TEXT("%d segments detect at least as much as fewer"), Substeps), DetectionRate >= LastDetectionRate);
+		LastDetectionRate = DetectionRate;
+	}
+
+	TestEqual(TEXT("16 segments find every post"), LastDetectionRate, 1.0f);
+
+	return true;
+}
+
+#endif
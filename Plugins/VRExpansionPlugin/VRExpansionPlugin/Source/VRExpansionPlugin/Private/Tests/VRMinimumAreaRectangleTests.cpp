@@ -0,0 +1,358 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Misc/VRMinimumAreaRectangle.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace VRMinimumAreaRectangleTests
+{
+	// Smallest area over every direction between two of the points, one of them is always a side of the optimal rectangle
+	float BruteForceArea(TArrayView<const FVector2D> Points)
+	{
+		float BestArea = -1.0f;
+
+		for (int32 i = 0; i < Points.Num(); ++i)
+		{
+			for (int32 j = i + 1; j < Points.Num(); ++j)
+			{
+				const FVector2D U = (Points[j] - Points[i]).GetSafeNormal();
+				if (U.IsNearlyZero())
+					continue;
+
+				const FVector2D V(-U.Y, U.X);
+				float MinU = BIG_NUMBER, MaxU = -BIG_NUMBER, MinV = BIG_NUMBER, MaxV = -BIG_NUMBER;
+
+				for (const FVector2D & Point : Points)
+				{
+					MinU = FMath::Min(MinU, Point | U);
+					MaxU = FMath::Max(MaxU, Point | U);
+					MinV = FMath::Min(MinV, Point | V);
+					MaxV = FMath::Max(MaxV, Point | V);
+				}
+
+				const float Area = (MaxU - MinU) * (MaxV - MinV);
+				if (BestArea < 0.0f || Area < BestArea)
+					BestArea = Area;
+			}
+		}
+
+		return FMath::Max(BestArea, 0.0f);
+	}
+
+	// Area of the rectangle aligned to one hull edge
+	float EdgeArea(const TArray<FVector2D> & Hull, int32 Edge)
+	{
+		const FVector2D U = (Hull[(Edge + 1) % Hull.Num()] - Hull[Edge]).GetSafeNormal();
+		const FVector2D V(-U.Y, U.X);
+		float MinU = BIG_NUMBER, MaxU = -BIG_NUMBER, MinV = BIG_NUMBER, MaxV = -BIG_NUMBER;
+
+		for (const FVector2D & Point : Hull)
+		{
+			MinU = FMath::Min(MinU, Point | U);
+			MaxU = FMath::Max(MaxU, Point | U);
+			MinV = FMath::Min(MinV, Point | V);
+			MaxV = FMath::Max(MaxV, Point | V);
+		}
+
+		return (MaxU - MinU) * (MaxV - MinV);
+	}
+
+	bool ContainsAll(const FMinAreaRect2D & Rect, TArrayView<const FVector2D> Points, float Tolerance)
+	{
+		const FVector2D AxisY(-Rect.Axis.Y, Rect.Axis.X);
+
+		for (const FVector2D & Point : Points)
+		{
+			const FVector2D Local = Point - Rect.Center;
+			if (FMath::Abs(Local | Rect.Axis) > Rect.Extent.X + Tolerance || FMath::Abs(Local | AxisY) > Rect.Extent.Y + Tolerance)
+				return false;
+		}
+
+		return true;
+	}
+
+	bool AreasMatch(float A, float B)
+	{
+		return FMath::Abs(A - B) <= FMath::Max(1.e-2f, FMath::Max(A, B) * 1.e-3f);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRMinimumAreaRectangleBruteForceTest, "VRExpansionPlugin.MinimumAreaRectangle.BruteForce", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRMinimumAreaRectangleBruteForceTest::RunTest(const FString& Parameters)
+{
+	using namespace VRMinimumAreaRectangleTests;
+
+	FRandomStream Random(0x3EC7);
+	FMinAreaRectScratch Scratch;
+	TArray<FVector2D> Points;
+	int32 NumFailures = 0;
+
+	for (int32 Iteration = 0; Iteration < 500 && NumFailures < 10; ++Iteration)
+	{
+		// Stretched and rotated clouds so the best edge is anywhere on the hull
+		const int32 NumPoints = Random.RandRange(3, 40);
+		const FVector2D Scale(Random.FRandRange(1.0f, 100.0f), Random.FRandRange(1.0f, 100.0f));
+		const float Angle = Random.FRandRange(0.0f, 2.0f * PI);
+		const FVector2D Offset(Random.FRandRange(-500.0f, 500.0f), Random.FRandRange(-500.0f, 500.0f));
+
+		Points.Reset();
+		for (int32 i = 0; i < NumPoints; ++i)
+		{
+			const FVector2D Local(Random.FRandRange(-1.0f, 1.0f) * Scale.X, Random.FRandRange(-1.0f, 1.0f) * Scale.Y);
+			Points.Add(Offset + Local.GetRotated(FMath::RadiansToDegrees(Angle)));
+		}
+
+		const FMinAreaRect2D Rect = MinimumAreaRectangle::Fit(Points, Scratch);
+		const float Expected = BruteForceArea(Points);
+
+		if (!Rect.bIsValid || !AreasMatch(Rect.GetArea(), Expected) || !ContainsAll(Rect, Points, 1.e-2f) || !FMath::IsNearlyEqual(Rect.Axis.Size(), 1.0f, 1.e-3f))
+		{
+			AddError(FString::Printf(TEXT("Iteration %d with %d points fit an area of %f, brute force %f"), Iteration, NumPoints, Rect.GetArea(), Expected));
+			++NumFailures;
+		}
+	}
+
+	return NumFailures == 0;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRMinimumAreaRectangleClosingEdgeTest, "VRExpansionPlugin.MinimumAreaRectangle.ClosingEdge", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRMinimumAreaRectangleClosingEdgeTest::RunTest(const FString& Parameters)
+{
+	using namespace VRMinimumAreaRectangleTests;
+
+	FMinAreaRectScratch Scratch;
+	TArray<FVector2D> Points;
+	int32 NumClosingEdgeBest = 0;
+
+	// A long flat quad spun all the way around, its long side lands on every hull edge in turn including the one back to the start
+	const FVector2D Shape[] = { FVector2D(-50.0f, -5.0f), FVector2D(50.0f, -5.0f), FVector2D(10.0f, 5.0f), FVector2D(-10.0f, 6.0f) };
+
+	for (int32 Degrees = 0; Degrees < 360; ++Degrees)
+	{
+		Points.Reset();
+		for (const FVector2D & Point : Shape)
+		{
+			Points.Add(Point.GetRotated((float)Degrees));
+		}
+
+		const FMinAreaRect2D Rect = MinimumAreaRectangle::Fit(Points, Scratch);
+		const TArray<FVector2D> & Hull = Scratch.Hull;
+
+		if (!TestEqual(TEXT("Hull keeps every corner"), Hull.Num(), 4))
+			return false;
+
+		float BestWithoutClosing = -1.0f;
+		for (int32 Edge = 0; Edge < Hull.Num() - 1; ++Edge)
+		{
+			const float Area = EdgeArea(Hull, Edge);
+			BestWithoutClosing = BestWithoutClosing < 0.0f ? Area : FMath::Min(BestWithoutClosing, Area);
+		}
+
+		const float ClosingArea = EdgeArea(Hull, Hull.Num() - 1);
+		if (ClosingArea < BestWithoutClosing * 0.99f)
+		{
+			++NumClosingEdgeBest;
+			TestTrue(FString::Printf(TEXT("At %d degrees the closing edge is used (area %f, closing edge %f)"), Degrees, Rect.GetArea(), ClosingArea), AreasMatch(Rect.GetArea(), ClosingArea));
+		}
+
+		TestTrue(FString::Printf(TEXT("At %d degrees the fit matches brute force"), Degrees), AreasMatch(Rect.GetArea(), BruteForceArea(Points)));
+	}
+
+	TestTrue(TEXT("Some rotation has its best side on the closing edge"), NumClosingEdgeBest > 0);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRMinimumAreaRectangleDegenerateTest, "VRExpansionPlugin.MinimumAreaRectangle.Degenerate", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRMinimumAreaRectangleDegenerateTest::RunTest(const FString& Parameters)
+{
+	using namespace VRMinimumAreaRectangleTests;
+
+	FMinAreaRectScratch Scratch;
+	TArray<FVector2D> Points;
+
+	TestFalse(TEXT("No points is not a rectangle"), MinimumAreaRectangle::Fit(Points, Scratch).bIsValid);
+
+	{
+		Points.Init(FVector2D(3.0f, -2.0f), 5);
+		const FMinAreaRect2D Rect = MinimumAreaRectangle::Fit(Points, Scratch);
+		TestTrue(TEXT("Duplicates of one point collapse to that point"), Rect.bIsValid && Rect.Center.Equals(FVector2D(3.0f, -2.0f)) && Rect.Extent.IsNearlyZero());
+		TestEqual(TEXT("Duplicates of one point leave a single hull point"), Scratch.Hull.Num(), 1);
+	}
+
+	{
+		// Out of order along a diagonal with repeats
+		Points.Reset();
+		const float Steps[] = { 4.0f, 0.0f, 2.0f, 10.0f, 2.0f, 7.0f, 10.0f };
+		for (float Step : Steps)
+		{
+			Points.Add(FVector2D(Step, Step * 0.5f));
+		}
+
+		const FMinAreaRect2D Rect = MinimumAreaRectangle::Fit(Points, Scratch);
+		const float Length = FVector2D(10.0f, 5.0f).Size();
+
+		TestEqual(TEXT("Collinear points reduce to the two end points"), Scratch.Hull.Num(), 2);
+		TestTrue(TEXT("Collinear points fit a flat rectangle along the line"), Rect.bIsValid && FMath::IsNearlyEqual(Rect.Extent.X, Length * 0.5f, 1.e-3f) && FMath::IsNearlyZero(Rect.Extent.Y, 1.e-3f));
+		TestTrue(TEXT("Collinear points are centered on the line"), Rect.Center.Equals(FVector2D(5.0f, 2.5f), 1.e-3f));
+		TestTrue(TEXT("Collinear points lie on the axis"), FMath::IsNearlyEqual(FMath::Abs(Rect.Axis | FVector2D(10.0f, 5.0f).GetSafeNormal()), 1.0f, 1.e-3f));
+	}
+
+	{
+		// Square with extra points along its sides and repeated corners
+		Points.Reset();
+		for (int32 i = 0; i <= 4; ++i)
+		{
+			const float T = i * 5.0f;
+			Points.Add(FVector2D(T, 0.0f));
+			Points.Add(FVector2D(20.0f, T));
+			Points.Add(FVector2D(20.0f - T, 20.0f));
+			Points.Add(FVector2D(0.0f, 20.0f - T));
+		}
+		Points.Add(FVector2D(10.0f, 10.0f));
+
+		const FMinAreaRect2D Rect = MinimumAreaRectangle::Fit(Points, Scratch);
+		TestEqual(TEXT("Collinear and duplicate points are dropped from the hull"), Scratch.Hull.Num(), 4);
+		TestTrue(TEXT("A square with points along its sides fits itself"), Rect.bIsValid && AreasMatch(Rect.GetArea(), 400.0f) && Rect.Center.Equals(FVector2D(10.0f, 10.0f), 1.e-3f));
+		TestTrue(TEXT("A square with points along its sides contains them all"), ContainsAll(Rect, Points, 1.e-3f));
+	}
+
+	{
+		// Repeating every point changes nothing
+		FRandomStream Random(0x51D);
+		Points.Reset();
+		for (int32 i = 0; i < 20; ++i)
+		{
+			Points.Add(FVector2D(Random.FRandRange(-30.0f, 30.0f), Random.FRandRange(-10.0f, 10.0f)));
+		}
+
+		const FMinAreaRect2D Rect = MinimumAreaRectangle::Fit(Points, Scratch);
+		Points.Append(TArray<FVector2D>(Points));
+		const FMinAreaRect2D Doubled = MinimumAreaRectangle::Fit(Points, Scratch);
+
+		TestTrue(TEXT("Duplicated input fits the same rectangle"), AreasMatch(Rect.GetArea(), Doubled.GetArea()) && Rect.Center.Equals(Doubled.Center, 1.e-3f));
+		TestTrue(TEXT("Duplicated input matches brute force"), AreasMatch(Doubled.GetArea(), BruteForceArea(Points)));
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRMinimumAreaRectangleBenchmark, "VRExpansionPlugin.MinimumAreaRectangle.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRMinimumAreaRectangleBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace VRMinimumAreaRectangleTests;
+
+	const int32 PointCounts[] = { 10, 100, 1000, 10000, 100000 };
+
+	// Every hull edge against every hull vertex like the old fit, past this it takes too long to bother
+	const int32 MaxQuadraticHull = 4096;
+
+	FRandomStream Random(0xB3AC);
+	FMinAreaRectScratch Scratch;
+	TArray<FVector2D> Points;
+	TArray<FVector> Verts;
+
+	for (int32 NumPoints : PointCounts)
+	{
+		// Keep the work per count roughly level, at least a couple of runs for the large sets
+		const int32 NumRuns = FMath::Max(1000000 / NumPoints, 2);
+
+		// A scanned floor patch has a small hull, points on a circle are all hull and the worst case for the edge search
+		for (int32 Shape = 0; Shape < 2; ++Shape)
+		{
+			const bool bAllOnHull = Shape == 1;
+
+			Points.Reset();
+			for (int32 i = 0; i < NumPoints; ++i)
+			{
+				if (bAllOnHull)
+					Points.Add(FVector2D(300.0f, 0.0f).GetRotated(360.0f * i / NumPoints));
+				else
+					Points.Add(FVector2D(Random.FRandRange(-400.0f, 400.0f), Random.FRandRange(-200.0f, 200.0f)).GetRotated(30.0f));
+			}
+
+			double HullSeconds = 0.0;
+			double CalipersSeconds = 0.0;
+			float Area = 0.0f;
+
+			for (int32 Run = 0; Run < NumRuns; ++Run)
+			{
+				const double HullStart = FPlatformTime::Seconds();
+				MinimumAreaRectangle::ComputeHull(Points, Scratch.Sorted, Scratch.Hull);
+				const double CalipersStart = FPlatformTime::Seconds();
+				Area = MinimumAreaRectangle::FitHull(Scratch.Hull).GetArea();
+				const double End = FPlatformTime::Seconds();
+
+				HullSeconds += CalipersStart - HullStart;
+				CalipersSeconds += End - CalipersStart;
+			}
+
+			const int32 HullSize = Scratch.Hull.Num();
+			FString QuadraticInfo(TEXT("skipped"));
+
+			if (HullSize <= MaxQuadraticHull)
+			{
+				const int32 NumQuadraticRuns = FMath::Max(NumRuns / FMath::Max(HullSize, 1), 1);
+				float QuadraticArea = 0.0f;
+
+				const double QuadraticStart = FPlatformTime::Seconds();
+				for (int32 Run = 0; Run < NumQuadraticRuns; ++Run)
+				{
+					QuadraticArea = EdgeArea(Scratch.Hull, 0);
+					for (int32 Edge = 1; Edge < HullSize; ++Edge)
+					{
+						QuadraticArea = FMath::Min(QuadraticArea, EdgeArea(Scratch.Hull, Edge));
+					}
+				}
+				const double QuadraticSeconds = FPlatformTime::Seconds() - QuadraticStart;
+
+				TestTrue(FString::Printf(TEXT("%d points, the calipers match the edge search"), NumPoints), AreasMatch(Area, QuadraticArea));
+				QuadraticInfo = FString::Printf(TEXT("%.2f us"), QuadraticSeconds * 1e6 / NumQuadraticRuns);
+			}
+
+			AddInfo(FString::Printf(TEXT("%d points%s (hull %d): hull %.2f us, calipers %.2f us, edge against vertex search %s"),
+				NumPoints, bAllOnHull ? TEXT(" on a circle") : TEXT(""), HullSize, HullSeconds * 1e6 / NumRuns, CalipersSeconds * 1e6 / NumRuns, *QuadraticInfo));
+		}
+
+		// The blueprint path end to end, with the scratch kept around and with fresh buffers every call like before
+		Verts.Reset();
+		for (int32 i = 0; i < NumPoints; ++i)
+		{
+			Verts.Add(FVector(Random.FRandRange(-400.0f, 400.0f), Random.FRandRange(-200.0f, 200.0f), Random.FRandRange(-1.0f, 1.0f)));
+		}
+
+		const FMatrix Basis = MinimumAreaRectangle::ComputeBasis(Verts, FVector::UpVector);
+		FVRMinimumAreaRectangle Rect;
+
+		const double ReusedStart = FPlatformTime::Seconds();
+		for (int32 Run = 0; Run < NumRuns; ++Run)
+		{
+			MinimumAreaRectangle::Fit(Verts, Basis, Rect, Scratch);
+		}
+		const double ReusedSeconds = FPlatformTime::Seconds() - ReusedStart;
+
+		const double FreshStart = FPlatformTime::Seconds();
+		for (int32 Run = 0; Run < NumRuns; ++Run)
+		{
+			FMinAreaRectScratch FreshScratch;
+			MinimumAreaRectangle::Fit(Verts, Basis, Rect, FreshScratch);
+		}
+		const double FreshSeconds = FPlatformTime::Seconds() - FreshStart;
+
+		TestTrue(FString::Printf(TEXT("%d points fit a rectangle"), NumPoints), Rect.bIsValid);
+		AddInfo(FString::Printf(TEXT("%d points in 3D: %.2f us with re-used scratch, %.2f us with fresh buffers"),
+			NumPoints, ReusedSeconds * 1e6 / NumRuns, FreshSeconds * 1e6 / NumRuns));
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,385 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+#include "HAL/PlatformTime.h"
+#include "Serialization/BitWriter.h"
+#include "Misc/VRNetCorrectionPolicy.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace VRNetCorrectionTests
+{
+	// Engine defaults for the values the harness mirrors
+	const float ServerTickRate = 90.0f;
+	const float MaxPositionErrorSquared = 3.0f;
+	const float MinTimeBetweenClientAdjustments = 0.1f;
+	const float MinTimeBetweenClientAdjustmentsLargeCorrection = 0.05f;
+	const float MinTimeBetweenClientAckGoodMoves = 0.1f;
+
+	// Parameter payload of the client RPCs, written the way the property serializer would so the sizes stay honest
+	int32 GetAdjustPositionBits(const FVector & NewLoc, const FVector & NewVel)
+	{
+		FBitWriter Writer(256, true);
+		float TimeStamp = 1.0f;
+		FVector Loc = NewLoc;
+		uint16 Yaw = 0;
+		uint32 BaseGUID = 0;
+		int32 BoneNameIndex = 0;
+		uint8 MovementMode = 1;
+
+		Writer << TimeStamp;
+		Writer << Loc;
+		Writer << Yaw;
+
+		// ClientVeryShortAdjustPositionVR is used when the server has no velocity to send
+		if (!NewVel.IsZero())
+		{
+			FVector Vel = NewVel;
+			Writer << Vel;
+		}
+
+		Writer << BaseGUID;
+		Writer << BoneNameIndex;
+		Writer.WriteBit(0);
+		Writer.WriteBit(0);
+		Writer << MovementMode;
+		return (int32)Writer.GetNumBits();
+	}
+
+	int32 GetAckGoodMoveBits()
+	{
+		FBitWriter Writer(32, true);
+		float TimeStamp = 1.0f;
+		Writer << TimeStamp;
+		return (int32)Writer.GetNumBits();
+	}
+
+	struct FHarnessStats
+	{
+		int32 NumMoves = 0;
+		int32 NumCorrections = 0;
+		int32 NumCoalesced = 0;
+		int32 NumRateLimited = 0;
+		int32 NumAcks = 0;
+		int32 NumForced = 0;
+		int32 NumForcedHeld = 0;
+		int64 Bits = 0;
+		float MaxHeldTime = 0.0f;
+		float MaxSnap = 0.0f;
+		float TotalSnap = 0.0f;
+		float MaxVisualStep = 0.0f;
+		float MaxVisualOffset = 0.0f;
+	};
+
+	/**
+	* Headless server / client pair for one character.
+	* The server side follows ServerMoveHandleClientErrorVR and SendClientAdjustment step for step, including the force
+	* flag being cleared before the adjustment goes out. The client drifts away from the server and snaps back on
+	* correction, a simulated proxy on a third machine smooths those snaps with the adaptive settings.
+	*/
+	struct FCorrectionHarness
+	{
+		FVRCorrectionThrottleSettings ThrottleSettings;
+		FVRAdaptiveSmoothingSettings SmoothingSettings;
+
+		FVRCorrectionThrottle Throttle;
+		FVRCorrectionHistory ProxyHistory;
+		FHarnessStats Stats;
+
+		FVector ServerLocation = FVector::ZeroVector;
+		FVector ClientLocation = FVector::ZeroVector;
+		FVector Velocity = FVector::ZeroVector;
+		FVector ProxyMeshOffset = FVector::ZeroVector;
+
+		bool bForceClientUpdate = false;
+		float ServerLastClientErrorDistance = 0.0f;
+		float ServerLastClientAdjustmentTime = -1.0f;
+		float ServerLastClientGoodMoveAckTime = -1.0f;
+		float HeldSince = -1.0f;
+		float CurrentTime = 0.0f;
+
+		// Client moved by ClientDelta while the server moved by ServerDelta
+		void ServerMove(const FVector & ServerDelta, const FVector & ClientDelta)
+		{
+			const float DeltaTime = 1.0f / ServerTickRate;
+			CurrentTime += DeltaTime;
+			ServerLocation += ServerDelta;
+			ClientLocation += ClientDelta;
+			Velocity = ServerDelta / DeltaTime;
+			++Stats.NumMoves;
+
+			// ServerMoveHandleClientErrorVR
+			const bool bForced = bForceClientUpdate;
+			const bool bNetworkLargeClientCorrection = bForced;
+			bool bNeedsCorrection = bForced;
+
+			if (bForced)
+			{
+				ServerLastClientErrorDistance = BIG_NUMBER;
+				Throttle.MarkForcedCorrection();
+				++Stats.NumForced;
+			}
+			else
+			{
+				// ServerCheckClientErrorVR
+				ServerLastClientErrorDistance = BIG_NUMBER;
+				const FVector LocDiff = ServerLocation - ClientLocation;
+				if (LocDiff.SizeSquared() > MaxPositionErrorSquared)
+				{
+					ServerLastClientErrorDistance = LocDiff.Size();
+					bNeedsCorrection = true;
+				}
+			}
+
+			bForceClientUpdate = false;
+
+			// SendClientAdjustment
+			if (!bNeedsCorrection)
+			{
+				Throttle.Reset();
+				HeldSince = -1.0f;
+
+				if (CurrentTime - ServerLastClientGoodMoveAckTime > MinTimeBetweenClientAckGoodMoves)
+				{
+					ServerLastClientGoodMoveAckTime = CurrentTime;
+					Stats.Bits += GetAckGoodMoveBits();
+					++Stats.NumAcks;
+				}
+				return;
+			}
+
+			if (!Throttle.ShouldSendCorrection(ThrottleSettings, ServerLastClientErrorDistance, bForceClientUpdate, CurrentTime))
+			{
+				if (HeldSince < 0.0f)
+					HeldSince = CurrentTime;
+
+				Stats.MaxHeldTime = FMath::Max(Stats.MaxHeldTime, CurrentTime - HeldSince);
+				++Stats.NumCoalesced;
+
+				if (bForced)
+					++Stats.NumForcedHeld;
+				return;
+			}
+
+			HeldSince = -1.0f;
+
+			const float AdjustmentTimeThreshold = bNetworkLargeClientCorrection ?
+				FMath::Min(MinTimeBetweenClientAdjustmentsLargeCorrection, MinTimeBetweenClientAdjustments) :
+				FMath::Max(MinTimeBetweenClientAdjustmentsLargeCorrection, MinTimeBetweenClientAdjustments);
+
+			if (CurrentTime - ServerLastClientAdjustmentTime <= AdjustmentTimeThreshold)
+			{
+				++Stats.NumRateLimited;
+				return;
+			}
+
+			ServerLastClientAdjustmentTime = CurrentTime;
+			++Stats.NumCorrections;
+			Stats.Bits += GetAdjustPositionBits(ServerLocation, Velocity);
+
+			// The owning client snaps, the proxy picks the same snap up as a mesh offset to smooth out
+			const float Snap = FVector::Dist(ServerLocation, ClientLocation);
+			Stats.MaxSnap = FMath::Max(Stats.MaxSnap, Snap);
+			Stats.TotalSnap += Snap;
+			ProxyMeshOffset += ClientLocation - ServerLocation;
+			ClientLocation = ServerLocation;
+
+			ProxyHistory.AddCorrection(CurrentTime, SmoothingSettings.HistoryDecayTime);
+		}
+
+		// One render frame on the simulated proxy, closes the mesh offset the way SmoothCorrection does
+		void TickProxy(float DeltaTime)
+		{
+			const float Offset = ProxyMeshOffset.Size();
+			if (Offset <= KINDA_SMALL_NUMBER)
+				return;
+
+			float SmoothTime = 0.1f;
+			float MaxCorrectionSpeed = 0.0f;
+			if (SmoothingSettings.bUseAdaptiveSmoothing)
+				SmoothingSettings.Evaluate(Offset, ProxyHistory.GetWeight(CurrentTime, SmoothingSettings.HistoryDecayTime), SmoothTime, MaxCorrectionSpeed);
+
+			float Step = SmoothTime > DeltaTime ? Offset * (DeltaTime / SmoothTime) : Offset;
+			if (MaxCorrectionSpeed > 0.0f)
+				Step = FMath::Min(Step, MaxCorrectionSpeed * DeltaTime);
+
+			Stats.MaxVisualStep = FMath::Max(Stats.MaxVisualStep, Step);
+			Stats.MaxVisualOffset = FMath::Max(Stats.MaxVisualOffset, Offset);
+			ProxyMeshOffset -= ProxyMeshOffset.GetSafeNormal() * Step;
+		}
+	};
+
+	/**
+	* Walks the harness through a scripted session.
+	* The client slowly drifts (leaning into geometry), gets the occasional large desync, and every ForceInterval moves the
+	* server forces an update (teleport or mode change) that moves it without the client knowing.
+	*/
+	void RunSession(FCorrectionHarness & Harness, int32 NumMoves, int32 ForceInterval, int32 Seed)
+	{
+		FRandomStream Random(Seed);
+		const float DeltaTime = 1.0f / ServerTickRate;
+
+		for (int32 Move = 0; Move < NumMoves; ++Move)
+		{
+			const FVector Walk = FVector(150.0f, 0.0f, 0.0f) * DeltaTime;
+			FVector Drift = FVector(Random.FRandRange(-0.4f, 0.4f), Random.FRandRange(-0.4f, 0.4f), 0.0f);
+
+			if (Random.FRand() < 0.005f)
+				Drift += Random.GetUnitVector() * Random.FRandRange(20.0f, 60.0f);
+
+			if (ForceInterval > 0 && Move > 0 && Move % ForceInterval == 0)
+			{
+				Harness.bForceClientUpdate = true;
+				Harness.ServerLocation += FVector(0.0f, 0.0f, Random.FRandRange(0.0f, 1.0f));
+			}
+
+			Harness.ServerMove(Walk, Walk + Drift);
+			Harness.TickProxy(DeltaTime);
+		}
+	}
+}
+
+using namespace VRNetCorrectionTests;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRNetCorrectionThrottleTest, "VRExpansionPlugin.NetCorrection.Throttle", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRNetCorrectionThrottleTest::RunTest(const FString& Parameters)
+{
+	FVRCorrectionThrottleSettings Settings;
+	Settings.bCoalesceSmallCorrections = true;
+	Settings.SmallCorrectionDistance = 10.0f;
+	Settings.CoalesceWindow = 0.15f;
+
+	// Disabled sends everything
+	{
+		FVRCorrectionThrottleSettings Disabled = Settings;
+		Disabled.bCoalesceSmallCorrections = false;
+		FVRCorrectionThrottle Throttle;
+		TestTrue(TEXT("Disabled sends small errors"), Throttle.ShouldSendCorrection(Disabled, 1.0f, false, 0.0f));
+	}
+
+	// Small errors are held for the window then sent, large ones go straight out
+	{
+		FVRCorrectionThrottle Throttle;
+		TestFalse(TEXT("First small error is held"), Throttle.ShouldSendCorrection(Settings, 2.0f, false, 0.0f));
+		TestFalse(TEXT("Small error inside the window is held"), Throttle.ShouldSendCorrection(Settings, 3.0f, false, 0.1f));
+		TestEqual(TEXT("Both were coalesced"), Throttle.NumCoalesced, 2);
+		TestTrue(TEXT("Small error past the window is sent"), Throttle.ShouldSendCorrection(Settings, 3.0f, false, 0.16f));
+		TestFalse(TEXT("Sending clears the held state"), Throttle.bHasDeferredCorrection);
+		TestTrue(TEXT("Large error is sent"), Throttle.ShouldSendCorrection(Settings, 25.0f, false, 0.2f));
+	}
+
+	// A forced update is latched past the force flag being cleared
+	{
+		FVRCorrectionThrottle Throttle;
+		TestFalse(TEXT("Small error is held"), Throttle.ShouldSendCorrection(Settings, 2.0f, false, 0.0f));
+		Throttle.MarkForcedCorrection();
+		TestTrue(TEXT("Forced correction is sent with the flag already cleared"), Throttle.ShouldSendCorrection(Settings, 2.0f, false, 0.01f));
+		TestFalse(TEXT("Latch is consumed by the send"), Throttle.bForcedCorrectionPending);
+		TestFalse(TEXT("Next small error is held again"), Throttle.ShouldSendCorrection(Settings, 2.0f, false, 0.02f));
+	}
+
+	// A good move clears the latch along with anything held
+	{
+		FVRCorrectionThrottle Throttle;
+		Throttle.MarkForcedCorrection();
+		Throttle.Reset();
+		TestFalse(TEXT("Reset clears the latch"), Throttle.bForcedCorrectionPending);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRNetCorrectionForcedUpdateTest, "VRExpansionPlugin.NetCorrection.ForcedUpdates", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRNetCorrectionForcedUpdateTest::RunTest(const FString& Parameters)
+{
+	// Everything counts as small so only the force path can get a correction out early
+	FCorrectionHarness Harness;
+	Harness.ThrottleSettings.bCoalesceSmallCorrections = true;
+	Harness.ThrottleSettings.SmallCorrectionDistance = 10000.0f;
+	Harness.ThrottleSettings.CoalesceWindow = 1.0f;
+
+	RunSession(Harness, 900, 45, 1234);
+
+	TestTrue(TEXT("Session forced updates"), Harness.Stats.NumForced > 0);
+	TestEqual(TEXT("No forced update is coalesced"), Harness.Stats.NumForcedHeld, 0);
+	TestTrue(TEXT("Small errors are held no longer than the window"), Harness.Stats.MaxHeldTime <= Harness.ThrottleSettings.CoalesceWindow + (1.0f / ServerTickRate));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRNetCorrectionHarnessTest, "VRExpansionPlugin.NetCorrection.Harness", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRNetCorrectionHarnessTest::RunTest(const FString& Parameters)
+{
+	const int32 NumMoves = FMath::RoundToInt(ServerTickRate * 60.0f);
+
+	struct FConfig
+	{
+		const TCHAR* Name;
+		bool bCoalesce;
+		bool bAdaptive;
+	};
+
+	const FConfig Configs[] =
+	{
+		{ TEXT("Baseline"), false, false },
+		{ TEXT("Coalesced"), true, false },
+		{ TEXT("Adaptive"), false, true },
+		{ TEXT("Coalesced+Adaptive"), true, true }
+	};
+
+	FHarnessStats Results[ARRAY_COUNT(Configs)];
+
+	for (int32 i = 0; i < ARRAY_COUNT(Configs); ++i)
+	{
+		FCorrectionHarness Harness;
+		Harness.ThrottleSettings.bCoalesceSmallCorrections = Configs[i].bCoalesce;
+		Harness.SmoothingSettings.bUseAdaptiveSmoothing = Configs[i].bAdaptive;
+
+		RunSession(Harness, NumMoves, 270, 4242);
+		Results[i] = Harness.Stats;
+
+		const FHarnessStats & Stats = Harness.Stats;
+		AddInfo(FString::Printf(TEXT("%-20s moves %d corrections %d coalesced %d rate limited %d acks %d forced %d bytes %lld (%.1f bytes/s) snap max %.2f avg %.2f proxy step max %.2f offset max %.2f"),
+			Configs[i].Name, Stats.NumMoves, Stats.NumCorrections, Stats.NumCoalesced, Stats.NumRateLimited, Stats.NumAcks, Stats.NumForced,
+			(Stats.Bits + 7) / 8, ((Stats.Bits + 7) / 8) / 60.0f,
+			Stats.MaxSnap, Stats.NumCorrections > 0 ? Stats.TotalSnap / Stats.NumCorrections : 0.0f, Stats.MaxVisualStep, Stats.MaxVisualOffset));
+
+		TestEqual(FString::Printf(TEXT("%s never holds a forced update"), Configs[i].Name), Stats.NumForcedHeld, 0);
+	}
+
+	TestTrue(TEXT("Coalescing sends fewer corrections"), Results[1].NumCorrections < Results[0].NumCorrections);
+	TestTrue(TEXT("Coalescing sends fewer bytes"), Results[1].Bits < Results[0].Bits);
+	TestTrue(TEXT("Adaptive smoothing caps the per frame proxy step"), Results[2].MaxVisualStep <= Results[0].MaxVisualStep);
+
+	// Throttle cost per move, it sits on the server move path for every connection
+	{
+		FVRCorrectionThrottleSettings Settings;
+		Settings.bCoalesceSmallCorrections = true;
+		FVRCorrectionThrottle Throttle;
+		FRandomStream Random(7);
+
+		const int32 NumDecisions = 1000000;
+		int32 NumSent = 0;
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumDecisions; ++i)
+		{
+			if ((i & 63) == 0)
+				Throttle.MarkForcedCorrection();
+
+			if (Throttle.ShouldSendCorrection(Settings, Random.FRandRange(0.0f, 15.0f), false, i / ServerTickRate))
+				++NumSent;
+		}
+		const double Elapsed = FPlatformTime::Seconds() - StartTime;
+
+		AddInfo(FString::Printf(TEXT("Throttle: %d decisions, %d sent, %.2f ns per decision"), NumDecisions, NumSent, (Elapsed * 1e9) / NumDecisions));
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,589 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "VRBPDatatypes.h"
+#include "VRBaseCharacterMovementComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Serialization/BitWriter.h"
+#include "Serialization/BitReader.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/**
+* Round trips the VR NetSerialize structs through FBitWriter / FBitReader pairs and checks the precision lost per
+* compression mode against its quantization bound, that every stream is consumed exactly, and that truncated streams
+* are flagged by the reader instead of being read past. Bits, timing and garbage stream acceptance are reported.
+*/
+namespace VRNetSerializeTests
+{
+	struct FModeResult
+	{
+		FString StructName;
+		FString ModeName;
+
+		int32 NumSamples;
+		int32 NumOutOfRange;
+		int32 NumBoundViolations;
+		int32 NumRoundTripErrors;
+
+		int64 TotalBits;
+		int32 MaxBits;
+
+		float MaxPositionError;
+		float PositionBound;
+		float MaxAngleError;
+		float AngleBound;
+
+		double SerializeNsPerOp;
+		double DeserializeNsPerOp;
+
+		int32 NumTruncated;
+		int32 NumTruncatedFlagged;
+		int32 NumGarbage;
+		int32 NumGarbageAccepted;
+
+		FModeResult() :
+			NumSamples(0),
+			NumOutOfRange(0),
+			NumBoundViolations(0),
+			NumRoundTripErrors(0),
+			TotalBits(0),
+			MaxBits(0),
+			MaxPositionError(0.0f),
+			PositionBound(0.0f),
+			MaxAngleError(0.0f),
+			AngleBound(0.0f),
+			SerializeNsPerOp(0.0),
+			DeserializeNsPerOp(0.0),
+			NumTruncated(0),
+			NumTruncatedFlagged(0),
+			NumGarbage(0),
+			NumGarbageAccepted(0)
+		{}
+
+		static FString GetCSVHeader()
+		{
+			return TEXT("Struct,Mode,Samples,OutOfRange,RoundTripErrors,MeanBits,MaxBits,MaxPositionError,PositionBound,MaxAngleError,AngleBound,BoundViolations,SerializeNsPerOp,DeserializeNsPerOp,Truncated,TruncatedFlagged,Garbage,GarbageAccepted");
+		}
+
+		FString ToCSVRow() const
+		{
+			const double MeanBits = NumSamples > 0 ? (double)TotalBits / (double)NumSamples : 0.0;
+
+			return FString::Printf(TEXT("%s,%s,%d,%d,%d,%.2f,%d,%.6f,%.6f,%.6f,%.6f,%d,%.1f,%.1f,%d,%d,%d,%d"),
+				*StructName, *ModeName, NumSamples, NumOutOfRange, NumRoundTripErrors, MeanBits, MaxBits,
+				MaxPositionError, PositionBound, MaxAngleError, AngleBound, NumBoundViolations,
+				SerializeNsPerOp, DeserializeNsPerOp, NumTruncated, NumTruncatedFlagged, NumGarbage, NumGarbageAccepted);
+		}
+	};
+
+	// Measured error of a single round trip, bInRange is false for samples that are expected to be clamped
+	struct FSampleError
+	{
+		bool bInRange;
+		float PositionError;
+		float PositionBound;
+		float AngleError;
+
+		FSampleError() :
+			bInRange(true),
+			PositionError(0.0f),
+			PositionBound(0.0f),
+			AngleError(0.0f)
+		{}
+	};
+
+	// Largest value a SerializePackedVector<Scale, MaxBits> can represent
+	static float GetPackedVectorRange(int32 ScaleFactor, int32 MaxBitsPerComponent)
+	{
+		return (float)(1ll << (MaxBitsPerComponent - 1)) / (float)ScaleFactor;
+	}
+
+	// Quantization error of a packed vector component plus the float precision at its magnitude
+	static float GetPackedVectorBound(int32 ScaleFactor, const FVector & Value)
+	{
+		return (0.5f / (float)ScaleFactor) + (Value.GetAbsMax() * FLT_EPSILON * 4.0f) + KINDA_SMALL_NUMBER;
+	}
+
+	static bool IsVectorInRange(const FVector & Value, float Range)
+	{
+		return !Value.ContainsNaN() && Value.GetAbsMax() < Range;
+	}
+
+	static float GetAngleError(const FRotator & Original, const FRotator & Result)
+	{
+		return FMath::RadiansToDegrees(Original.Quaternion().AngularDistance(Result.Quaternion()));
+	}
+
+	static FVector RandomVector(FRandomStream & Stream, float Range)
+	{
+		return FVector(Stream.FRandRange(-Range, Range), Stream.FRandRange(-Range, Range), Stream.FRandRange(-Range, Range));
+	}
+
+	static FRotator RandomRotator(FRandomStream & Stream)
+	{
+		return FRotator(Stream.FRandRange(-90.0f, 90.0f), Stream.FRandRange(-180.0f, 180.0f), Stream.FRandRange(-180.0f, 180.0f));
+	}
+
+	// Values sitting on or just past the edges of a quantization range, plus values that are invalid outright
+	static void GetAdversarialVectors(float Range, TArray<FVector> & OutVectors)
+	{
+		const float Edges[] = { 0.0f, 0.004f, 0.005f, 0.006f, Range * 0.5f, Range * 0.999f, Range * 1.001f, Range * 4.0f, 1.0e10f };
+
+		for (float Edge : Edges)
+		{
+			OutVectors.Add(FVector(Edge));
+			OutVectors.Add(FVector(-Edge));
+			OutVectors.Add(FVector(Edge, -Edge, 0.0f));
+		}
+
+		OutVectors.Add(FVector(NAN, 0.0f, 0.0f));
+		OutVectors.Add(FVector(INFINITY, -INFINITY, 0.0f));
+	}
+
+	static void GetAdversarialRotators(TArray<FRotator> & OutRotators)
+	{
+		const float Angles[] = { 0.0f, 0.0027f, 89.999f, 90.0f, -90.0f, 179.999f, 180.0f, -180.0f, 359.999f, 360.0f, -720.0f, 1.0e6f };
+
+		for (float Angle : Angles)
+		{
+			OutRotators.Add(FRotator(Angle, 0.0f, 0.0f));
+			OutRotators.Add(FRotator(0.0f, Angle, 0.0f));
+			OutRotators.Add(FRotator(0.0f, 0.0f, Angle));
+			OutRotators.Add(FRotator(FMath::Clamp(Angle, -90.0f, 90.0f), Angle, -Angle));
+		}
+	}
+
+	/**
+	* Runs a corpus through a structs NetSerialize
+	* ErrorFunc(const T& Original, const T& Result) -> FSampleError
+	*/
+	template<typename T, typename ErrorFuncType>
+	FModeResult RunCorpus(const FString & StructName, const FString & ModeName, const TArray<T> & Corpus, float AngleBound, FRandomStream & Stream, ErrorFuncType ErrorFunc)
+	{
+		FModeResult Result;
+		Result.StructName = StructName;
+		Result.ModeName = ModeName;
+		Result.NumSamples = Corpus.Num();
+		Result.AngleBound = AngleBound;
+
+		if (Corpus.Num() < 1)
+			return Result;
+
+		TArray<TArray<uint8>> Streams;
+		TArray<int64> StreamBits;
+		Streams.Reserve(Corpus.Num());
+		StreamBits.Reserve(Corpus.Num());
+
+		// Per sample round trip for size and accuracy
+		for (const T & Sample : Corpus)
+		{
+			T Original = Sample;
+			bool bWriteSuccess = true;
+
+			FBitWriter Writer(0, true);
+			Original.NetSerialize(Writer, nullptr, bWriteSuccess);
+
+			const int64 NumBits = Writer.GetNumBits();
+			Result.TotalBits += NumBits;
+			Result.MaxBits = FMath::Max(Result.MaxBits, (int32)NumBits);
+
+			Streams.Add(*Writer.GetBuffer());
+			StreamBits.Add(NumBits);
+
+			FBitReader Reader(Writer.GetData(), NumBits);
+			T Decoded;
+			bool bReadSuccess = true;
+			Decoded.NetSerialize(Reader, nullptr, bReadSuccess);
+
+			// Has to consume exactly what was written
+			if (Reader.IsError() || Reader.GetBitsLeft() != 0)
+			{
+				++Result.NumRoundTripErrors;
+				continue;
+			}
+
+			const FSampleError SampleError = ErrorFunc(Sample, Decoded);
+
+			if (!bWriteSuccess || !SampleError.bInRange)
+			{
+				++Result.NumOutOfRange;
+				continue;
+			}
+
+			Result.MaxPositionError = FMath::Max(Result.MaxPositionError, SampleError.PositionError);
+			Result.MaxAngleError = FMath::Max(Result.MaxAngleError, SampleError.AngleError);
+			Result.PositionBound = FMath::Max(Result.PositionBound, SampleError.PositionBound);
+
+			if (SampleError.PositionError > SampleError.PositionBound || SampleError.AngleError > AngleBound)
+			{
+				++Result.NumBoundViolations;
+			}
+		}
+
+		// Throughput, the whole corpus through a single writer and reader so allocation stays out of the timing
+		{
+			FBitWriter Writer(Result.TotalBits + 8, true);
+			bool bSuccess = true;
+
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			for (const T & Sample : Corpus)
+			{
+				T Original = Sample;
+				Original.NetSerialize(Writer, nullptr, bSuccess);
+			}
+			const uint64 WriteCycles = FPlatformTime::Cycles64() - StartCycles;
+
+			FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+			T Decoded;
+
+			const uint64 ReadStartCycles = FPlatformTime::Cycles64();
+			for (int32 i = 0; i < Corpus.Num() && !Reader.IsError(); ++i)
+			{
+				Decoded.NetSerialize(Reader, nullptr, bSuccess);
+			}
+			const uint64 ReadCycles = FPlatformTime::Cycles64() - ReadStartCycles;
+
+			Result.SerializeNsPerOp = FPlatformTime::ToMilliseconds64(WriteCycles) * 1.0e6 / (double)Corpus.Num();
+			Result.DeserializeNsPerOp = FPlatformTime::ToMilliseconds64(ReadCycles) * 1.0e6 / (double)Corpus.Num();
+		}
+
+		// Truncated streams, every read has to end flagged as an error instead of running off the end of the data
+		for (int32 i = 0; i < Streams.Num(); ++i)
+		{
+			if (StreamBits[i] < 2)
+				continue;
+
+			const int64 TruncatedBits = Stream.RandRange(0, (int32)StreamBits[i] - 1);
+
+			FBitReader Reader(Streams[i].GetData(), TruncatedBits);
+			T Decoded;
+			bool bSuccess = true;
+			Decoded.NetSerialize(Reader, nullptr, bSuccess);
+
+			++Result.NumTruncated;
+			if (Reader.IsError())
+				++Result.NumTruncatedFlagged;
+		}
+
+		// Garbage streams, these can legitimately decode to something so they are only reported
+		TArray<uint8> Garbage;
+		for (int32 i = 0; i < Streams.Num(); ++i)
+		{
+			const int32 NumBytes = Stream.RandRange(0, 32);
+			Garbage.SetNumUninitialized(NumBytes);
+
+			for (uint8 & Byte : Garbage)
+			{
+				Byte = (uint8)Stream.RandRange(0, 255);
+			}
+
+			FBitReader Reader(Garbage.GetData(), (int64)NumBytes * 8);
+			T Decoded;
+			bool bSuccess = true;
+			Decoded.NetSerialize(Reader, nullptr, bSuccess);
+
+			++Result.NumGarbage;
+			if (!Reader.IsError() && bSuccess)
+				++Result.NumGarbageAccepted;
+		}
+
+		return Result;
+	}
+
+	static void RunTransformNetQuantize(int32 NumSamples, FRandomStream & Stream, TArray<FModeResult> & OutResults)
+	{
+		IConsoleVariable * HighPrecisionCVar = IConsoleManager::Get().FindConsoleVariable(TEXT("vrexp.RepHighPrecisionTransforms"));
+		const int32 OriginalHighPrecision = HighPrecisionCVar ? HighPrecisionCVar->GetInt() : 0;
+
+		const float Range = GetPackedVectorRange(100, 30);
+
+		TArray<FVector> AdversarialVectors;
+		GetAdversarialVectors(Range, AdversarialVectors);
+		TArray<FRotator> AdversarialRotators;
+		GetAdversarialRotators(AdversarialRotators);
+
+		TArray<FTransform_NetQuantize> Corpus;
+		Corpus.Reserve(NumSamples + AdversarialVectors.Num() + AdversarialRotators.Num() + 2);
+
+		for (int32 i = 0; i < NumSamples; ++i)
+		{
+			Corpus.Add(FTransform_NetQuantize(RandomRotator(Stream), RandomVector(Stream, 10000.0f), FVector(Stream.FRandRange(0.01f, 10.0f))));
+		}
+
+		for (const FVector & Vector : AdversarialVectors)
+		{
+			Corpus.Add(FTransform_NetQuantize(FRotator::ZeroRotator, Vector, FVector::OneVector));
+		}
+
+		for (const FRotator & Rotator : AdversarialRotators)
+		{
+			Corpus.Add(FTransform_NetQuantize(Rotator, FVector::ZeroVector, FVector::OneVector));
+		}
+
+		// Degenerate quaternions, zero and far from normalized
+		FTransform_NetQuantize Degenerate(FTransform::Identity);
+		Degenerate.SetRotation(FQuat(0.0f, 0.0f, 0.0f, 0.0f));
+		Corpus.Add(Degenerate);
+		Degenerate.SetRotation(FQuat(10.0f, -3.0f, 0.5f, 2.0f));
+		Corpus.Add(Degenerate);
+
+		auto ErrorFunc = [Range](const FTransform_NetQuantize & Original, const FTransform_NetQuantize & Decoded)
+		{
+			FSampleError Error;
+			Error.bInRange = IsVectorInRange(Original.GetTranslation(), Range) && IsVectorInRange(Original.GetScale3D(), Range) &&
+				!Original.GetRotation().ContainsNaN() && FMath::IsNearlyEqual(Original.GetRotation().SizeSquared(), 1.0f, KINDA_SMALL_NUMBER);
+
+			if (Error.bInRange)
+			{
+				Error.PositionError = FMath::Max(
+					(Original.GetTranslation() - Decoded.GetTranslation()).GetAbsMax(),
+					(Original.GetScale3D() - Decoded.GetScale3D()).GetAbsMax());
+				Error.PositionBound = FMath::Max(GetPackedVectorBound(100, Original.GetTranslation()), GetPackedVectorBound(100, Original.GetScale3D()));
+				Error.AngleError = FMath::RadiansToDegrees(Original.GetRotation().AngularDistance(Decoded.GetRotation()));
+			}
+
+			return Error;
+		};
+
+		// Short compression is 360 / 65536 per axis, rounded, on three axis, plus the rotator conversion
+		const float ShortAngleBound = 3.0f * (180.0f / 65536.0f) + 0.01f;
+
+		if (HighPrecisionCVar)
+			HighPrecisionCVar->Set(0, ECVF_SetByConsole);
+		OutResults.Add(RunCorpus(TEXT("FTransform_NetQuantize"), TEXT("Quantized"), Corpus, ShortAngleBound, Stream, ErrorFunc));
+
+		if (HighPrecisionCVar)
+		{
+			HighPrecisionCVar->Set(1, ECVF_SetByConsole);
+
+			// Full floats, only the rotator conversion loses anything
+			FModeResult HighPrecisionResult = RunCorpus(TEXT("FTransform_NetQuantize"), TEXT("HighPrecision"), Corpus, 0.01f, Stream, ErrorFunc);
+			OutResults.Add(HighPrecisionResult);
+
+			HighPrecisionCVar->Set(OriginalHighPrecision, ECVF_SetByConsole);
+		}
+	}
+
+	static void RunComponentPosRep(int32 NumSamples, FRandomStream & Stream, TArray<FModeResult> & OutResults)
+	{
+		struct FPosRepMode
+		{
+			EVRVectorQuantization VectorQuantization;
+			EVRRotationQuantization RotationQuantization;
+			const TCHAR * Name;
+			int32 ScaleFactor;
+			int32 MaxBits;
+			float AngleBound;
+		};
+
+		const FPosRepMode Modes[] =
+		{
+			{ EVRVectorQuantization::RoundTwoDecimals, EVRRotationQuantization::RoundToShort, TEXT("TwoDecimals_Short"), 100, 22, 3.0f * (180.0f / 65536.0f) + 0.01f },
+			{ EVRVectorQuantization::RoundTwoDecimals, EVRRotationQuantization::RoundTo10Bits, TEXT("TwoDecimals_10Bit"), 100, 22, 3.0f * (180.0f / 1024.0f) + 0.01f },
+			{ EVRVectorQuantization::RoundOneDecimal, EVRRotationQuantization::RoundToShort, TEXT("OneDecimal_Short"), 10, 18, 3.0f * (180.0f / 65536.0f) + 0.01f },
+			{ EVRVectorQuantization::RoundOneDecimal, EVRRotationQuantization::RoundTo10Bits, TEXT("OneDecimal_10Bit"), 10, 18, 3.0f * (180.0f / 1024.0f) + 0.01f },
+		};
+
+		for (const FPosRepMode & Mode : Modes)
+		{
+			const float Range = GetPackedVectorRange(Mode.ScaleFactor, Mode.MaxBits);
+
+			TArray<FVector> AdversarialVectors;
+			GetAdversarialVectors(Range, AdversarialVectors);
+			TArray<FRotator> AdversarialRotators;
+			GetAdversarialRotators(AdversarialRotators);
+
+			TArray<FBPVRComponentPosRep> Corpus;
+			Corpus.Reserve(NumSamples + AdversarialVectors.Num() + AdversarialRotators.Num());
+
+			FBPVRComponentPosRep PosRep;
+			PosRep.QuantizationLevel = Mode.VectorQuantization;
+			PosRep.RotationQuantizationLevel = Mode.RotationQuantization;
+
+			for (int32 i = 0; i < NumSamples; ++i)
+			{
+				// Tracked components are in relative space, a play area is a few meters
+				PosRep.Position = RandomVector(Stream, 500.0f);
+				PosRep.Rotation = RandomRotator(Stream);
+				Corpus.Add(PosRep);
+			}
+
+			PosRep.Rotation = FRotator::ZeroRotator;
+			for (const FVector & Vector : AdversarialVectors)
+			{
+				PosRep.Position = Vector;
+				Corpus.Add(PosRep);
+			}
+
+			PosRep.Position = FVector::ZeroVector;
+			for (const FRotator & Rotator : AdversarialRotators)
+			{
+				PosRep.Rotation = Rotator;
+				Corpus.Add(PosRep);
+			}
+
+			const int32 ScaleFactor = Mode.ScaleFactor;
+			OutResults.Add(RunCorpus(TEXT("FBPVRComponentPosRep"), Mode.Name, Corpus, Mode.AngleBound, Stream,
+				[Range, ScaleFactor](const FBPVRComponentPosRep & Original, const FBPVRComponentPosRep & Decoded)
+			{
+				FSampleError Error;
+				Error.bInRange = IsVectorInRange(Original.Position, Range) && !Original.Rotation.ContainsNaN();
+
+				if (Error.bInRange)
+				{
+					Error.PositionError = (Original.Position - Decoded.Position).GetAbsMax();
+					Error.PositionBound = GetPackedVectorBound(ScaleFactor, Original.Position);
+					Error.AngleError = GetAngleError(Original.Rotation, Decoded.Rotation);
+				}
+
+				return Error;
+			}));
+		}
+	}
+
+	static void RunConditionalMoveReps(int32 NumSamples, FRandomStream & Stream, TArray<FModeResult> & OutResults)
+	{
+		const float Range = GetPackedVectorRange(100, 22);
+
+		{
+			TArray<FVector> AdversarialVectors;
+			GetAdversarialVectors(Range, AdversarialVectors);
+
+			TArray<FVRConditionalMoveRep> Corpus;
+			Corpus.Reserve(NumSamples + AdversarialVectors.Num() + 1);
+
+			for (int32 i = 0; i < NumSamples; ++i)
+			{
+				FVRConditionalMoveRep MoveRep;
+
+				// Most moves carry nothing, keep that ratio in the corpus so the mean bits mean something
+				if (Stream.FRand() < 0.5f)
+					MoveRep.CustomVRInputVector = RandomVector(Stream, 100.0f);
+
+				if (Stream.FRand() < 0.1f)
+					MoveRep.RequestedVelocity = RandomVector(Stream, 600.0f);
+
+				if (Stream.FRand() < 0.05f)
+				{
+					FVRMoveActionContainer MoveAction;
+					MoveAction.MoveAction = (EVRMoveAction)Stream.RandRange((int32)EVRMoveAction::VRMOVEACTION_SnapTurn, (int32)EVRMoveAction::VRMOVEACTION_CUSTOM10);
+					MoveAction.MoveActionDataReq = EVRMoveActionDataReq::VRMOVEACTIONDATA_LOC_AND_ROT;
+					MoveAction.MoveActionLoc = RandomVector(Stream, 10000.0f);
+					MoveAction.MoveActionRot = FRotator(0.0f, Stream.FRandRange(-180.0f, 180.0f), 0.0f);
+					MoveRep.MoveActionArray.MoveActions.Add(MoveAction);
+				}
+
+				Corpus.Add(MoveRep);
+			}
+
+			for (const FVector & Vector : AdversarialVectors)
+			{
+				FVRConditionalMoveRep MoveRep;
+				MoveRep.CustomVRInputVector = Vector;
+				MoveRep.RequestedVelocity = Vector;
+				Corpus.Add(MoveRep);
+			}
+
+			// The move action count is a byte
+			FVRConditionalMoveRep MaxActions;
+			MaxActions.MoveActionArray.MoveActions.AddDefaulted(255);
+			Corpus.Add(MaxActions);
+
+			OutResults.Add(RunCorpus(TEXT("FVRConditionalMoveRep"), TEXT("Default"), Corpus, 0.01f, Stream,
+				[Range](const FVRConditionalMoveRep & Original, const FVRConditionalMoveRep & Decoded)
+			{
+				FSampleError Error;
+				Error.bInRange = IsVectorInRange(Original.CustomVRInputVector, Range) && IsVectorInRange(Original.RequestedVelocity, Range) &&
+					Original.MoveActionArray.MoveActions.Num() == Decoded.MoveActionArray.MoveActions.Num();
+
+				if (Error.bInRange)
+				{
+					Error.PositionError = FMath::Max(
+						(Original.CustomVRInputVector - Decoded.CustomVRInputVector).GetAbsMax(),
+						(Original.RequestedVelocity - Decoded.RequestedVelocity).GetAbsMax());
+					Error.PositionBound = FMath::Max(GetPackedVectorBound(100, Original.CustomVRInputVector), GetPackedVectorBound(100, Original.RequestedVelocity));
+				}
+
+				return Error;
+			}));
+		}
+
+		{
+			TArray<FVRConditionalMoveRep2> Corpus;
+			Corpus.Reserve(NumSamples + 4);
+
+			for (int32 i = 0; i < NumSamples; ++i)
+			{
+				FVRConditionalMoveRep2 MoveRep;
+				MoveRep.ClientYaw = (uint16)Stream.RandRange(0, 65535);
+
+				if (Stream.FRand() < 0.25f)
+				{
+					MoveRep.ClientPitch = (uint16)Stream.RandRange(0, 65535);
+					MoveRep.ClientRoll = (uint8)Stream.RandRange(0, 255);
+				}
+
+				Corpus.Add(MoveRep);
+			}
+
+			// Packed int boundaries
+			const uint16 Edges[] = { 0, 127, 128, 65535 };
+			for (uint16 Edge : Edges)
+			{
+				FVRConditionalMoveRep2 MoveRep;
+				MoveRep.ClientYaw = Edge;
+				MoveRep.ClientPitch = Edge;
+				MoveRep.ClientRoll = (uint8)FMath::Min<uint16>(Edge, 255);
+				Corpus.Add(MoveRep);
+			}
+
+			// Integer rotations, anything other than an exact match is an error
+			OutResults.Add(RunCorpus(TEXT("FVRConditionalMoveRep2"), TEXT("Default"), Corpus, 0.0f, Stream,
+				[](const FVRConditionalMoveRep2 & Original, const FVRConditionalMoveRep2 & Decoded)
+			{
+				FSampleError Error;
+				Error.AngleError = (Original.ClientYaw != Decoded.ClientYaw || Original.ClientPitch != Decoded.ClientPitch || Original.ClientRoll != Decoded.ClientRoll) ? 1.0f : 0.0f;
+				return Error;
+			}));
+		}
+	}
+}
+
+using namespace VRNetSerializeTests;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRNetSerializeRoundTripTest, "VRExpansionPlugin.NetSerialize.RoundTrip", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRNetSerializeRoundTripTest::RunTest(const FString& Parameters)
+{
+	const int32 NumSamples = 10000;
+	const int32 Seed = 0x5652;
+
+	FRandomStream Stream(Seed);
+	TArray<FModeResult> Results;
+
+	RunTransformNetQuantize(NumSamples, Stream, Results);
+	RunComponentPosRep(NumSamples, Stream, Results);
+	RunConditionalMoveReps(NumSamples, Stream, Results);
+
+	AddInfo(FModeResult::GetCSVHeader());
+
+	for (const FModeResult & Result : Results)
+	{
+		AddInfo(Result.ToCSVRow());
+
+		const FString Name = Result.StructName + TEXT(" ") + Result.ModeName;
+		TestEqual(Name + TEXT(" round trips consume exactly what was written"), Result.NumRoundTripErrors, 0);
+		TestEqual(Name + TEXT(" stays inside its quantization bounds"), Result.NumBoundViolations, 0);
+
+		// Truncated streams that decode without flagging an error mean the reader read past its data
+		TestEqual(Name + TEXT(" flags every truncated stream"), Result.NumTruncatedFlagged, Result.NumTruncated);
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,383 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/IConsoleManager.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/WorldSettings.h"
+#include "Components/CapsuleComponent.h"
+#include "NavigationData.h"
+#include "VRPathFollowingComponent.h"
+#include "Misc/VRPathFollowingCrowd.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace VRPathFollowingCrowdTests
+{
+	const float CrowdFrameTime = 1.0f / 60.0f;
+
+	/*
+	* HasReachedCurrentTarget written out on plain values. The engine has used both the sum and the max of the acceptance and agent radii,
+	* the sum is the larger of the two so it is the one the batched bound has to cover.
+	*/
+	bool ExactReachTest(const FVector & Feet, const FVector & Target, const FVector & Direction, float AcceptanceRadius, float AgentRadius, float AgentHalfHeight, float HalfHeightPct)
+	{
+		const FVector ToTarget = Target - Feet;
+		if (FVector::DotProduct(ToTarget, Direction) < 0.0f)
+			return true;
+
+		if (ToTarget.SizeSquared2D() > FMath::Square(AcceptanceRadius + AgentRadius * 0.05f))
+			return false;
+
+		return FMath::Abs(ToTarget.Z) <= AgentHalfHeight * HalfHeightPct;
+	}
+
+	// Same padding GetCrowdSegment adds
+	float GetCrowdReachRadius(float AcceptanceRadius, float AgentRadius)
+	{
+		return AcceptanceRadius + (AgentRadius * 0.05f) + KINDA_SMALL_NUMBER;
+	}
+
+	struct FScopedBatchedCVar
+	{
+		IConsoleVariable * Variable;
+		int32 OldValue;
+
+		FScopedBatchedCVar(int32 Value)
+		{
+			Variable = IConsoleManager::Get().FindConsoleVariable(TEXT("vr.PathFollowingCrowd.Batched"));
+			OldValue = Variable ? Variable->GetInt() : 1;
+
+			if (Variable)
+				Variable->Set(Value, ECVF_SetByCode);
+		}
+
+		~FScopedBatchedCVar()
+		{
+			if (Variable)
+				Variable->Set(OldValue, ECVF_SetByCode);
+		}
+	};
+
+	// Standalone game world, nothing ticks on its own so the crowd manager is driven by hand
+	struct FCrowdTestWorld
+	{
+		UWorld * World;
+
+		FCrowdTestWorld()
+		{
+			World = UWorld::CreateWorld(EWorldType::Game, false);
+			FWorldContext & Context = GEngine->CreateNewWorldContext(EWorldType::Game);
+			Context.SetCurrentWorld(World);
+			World->InitializeActorsForPlay(FURL());
+			World->GetWorldSettings()->NotifyBeginPlay();
+		}
+
+		~FCrowdTestWorld()
+		{
+			GEngine->DestroyWorldContext(World);
+			World->DestroyWorld(false);
+		}
+	};
+
+	struct FCrowdTestAgent
+	{
+		ACharacter * Character;
+		UVRPathFollowingComponent * PathFollowing;
+		float Speed;
+	};
+
+	// Zig zag of NumSegments segments starting at the feet, the turns come at different points for every agent
+	TArray<FVector> MakeZigZagPath(const FVector & Start, int32 NumSegments, FRandomStream & Random)
+	{
+		TArray<FVector> Points;
+		Points.Add(Start);
+
+		for (int32 i = 0; i < NumSegments; ++i)
+		{
+			const float Length = Random.FRandRange(150.0f, 400.0f);
+			Points.Add(Points.Last() + ((i % 2) ? FVector(0.0f, (i % 4 == 1) ? Length : -Length, 0.0f) : FVector(Length, 0.0f, 0.0f)));
+		}
+
+		return Points;
+	}
+
+	FCrowdTestAgent SpawnAgent(UWorld * World, const FVector & Feet, int32 NumSegments, FRandomStream & Random)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		FCrowdTestAgent Agent;
+		Agent.Character = World->SpawnActor<ACharacter>(FVector::ZeroVector, FRotator::ZeroRotator, SpawnParams);
+		Agent.Character->SetActorLocation(Feet + FVector(0.0f, 0.0f, Agent.Character->GetCapsuleComponent()->GetScaledCapsuleHalfHeight()));
+		Agent.Speed = Random.FRandRange(200.0f, 400.0f);
+
+		Agent.PathFollowing = NewObject<UVRPathFollowingComponent>(Agent.Character);
+		Agent.PathFollowing->bUseCrowdPathFollowing = true;
+		Agent.PathFollowing->RegisterComponent();
+		Agent.PathFollowing->SetMovementComponent(Agent.Character->GetCharacterMovement());
+
+		const TArray<FVector> Points = MakeZigZagPath(Feet, NumSegments, Random);
+		FNavPathSharedPtr Path = MakeShareable(new FNavigationPath(Points, nullptr));
+
+		FAIMoveRequest Request(Points.Last());
+		Request.SetAcceptanceRadius(5.0f);
+		Agent.PathFollowing->RequestMove(Request, Path);
+
+		return Agent;
+	}
+
+	// Applies the move each agent asked for, the same way for both runs so only the path following can differ
+	void MoveAgents(const TArray<FCrowdTestAgent> & Agents, float DeltaTime)
+	{
+		for (const FCrowdTestAgent & Agent : Agents)
+		{
+			const FVector MoveInput = Agent.Character->ConsumeMovementInputVector();
+			Agent.Character->SetActorLocation(Agent.Character->GetActorLocation() + MoveInput.GetClampedToMaxSize(1.0f) * Agent.Speed * DeltaTime);
+		}
+	}
+
+	struct FAgentFrame
+	{
+		EPathFollowingStatus::Type Status;
+		int32 PathIndex;
+		FVector MoveInput;
+		FVector Location;
+	};
+
+	// Walks a crowd down their paths, recording what every agent did on every frame
+	TArray<TArray<FAgentFrame>> RunCrowd(int32 NumAgents, int32 NumSegments, int32 NumFrames, bool bBatched, uint32 Seed)
+	{
+		FScopedBatchedCVar ScopedBatched(bBatched ? 1 : 0);
+		FCrowdTestWorld TestWorld;
+		FRandomStream Random(Seed);
+
+		TArray<FCrowdTestAgent> Agents;
+		for (int32 i = 0; i < NumAgents; ++i)
+		{
+			Agents.Add(SpawnAgent(TestWorld.World, FVector((i % 8) * 2000.0f, (i / 8) * 2000.0f, 0.0f), NumSegments, Random));
+		}
+
+		UVRPathFollowingCrowdManager * Manager = UVRPathFollowingCrowdManager::Get(TestWorld.World, false);
+
+		TArray<TArray<FAgentFrame>> Frames;
+		Frames.SetNum(NumFrames);
+
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			TestWorld.World->TimeSeconds += CrowdFrameTime;
+			Manager->TickCrowd(CrowdFrameTime);
+
+			for (const FCrowdTestAgent & Agent : Agents)
+			{
+				FAgentFrame & Recorded = Frames[Frame].AddDefaulted_GetRef();
+				Recorded.Status = Agent.PathFollowing->GetStatus();
+				Recorded.PathIndex = Agent.PathFollowing->GetCurrentPathIndex();
+				Recorded.MoveInput = Agent.Character->GetPendingMovementInputVector();
+				Recorded.Location = Agent.Character->GetActorLocation();
+			}
+
+			MoveAgents(Agents, CrowdFrameTime);
+		}
+
+		return Frames;
+	}
+}
+
+using namespace VRPathFollowingCrowdTests;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRPathFollowingCrowdReachBoundTest, "VRExpansionPlugin.PathFollowingCrowd.ReachBound", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRPathFollowingCrowdReachBoundTest::RunTest(const FString& Parameters)
+{
+	FRandomStream Random(0xC40);
+	FVRPathFollowingCrowdBatch Batch;
+
+	TArray<float> AcceptanceRadii, AgentRadii, AgentHalfHeights;
+	const int32 NumSamples = 20000;
+
+	for (int32 i = 0; i < NumSamples; ++i)
+	{
+		const float AcceptanceRadius = Random.FRandRange(0.0f, 50.0f);
+		const float AgentRadius = Random.FRandRange(20.0f, 60.0f);
+		const float UseRadius = AcceptanceRadius + AgentRadius * 0.05f;
+
+		const FVector Target(Random.FRandRange(-1000.0f, 1000.0f), Random.FRandRange(-1000.0f, 1000.0f), Random.FRandRange(-50.0f, 50.0f));
+		const FVector Direction = FVector(Random.FRandRange(-1.0f, 1.0f), Random.FRandRange(-1.0f, 1.0f), 0.0f).GetSafeNormal();
+
+		// Around the radius and a quarter right on its edge, where the bound and the exact test could disagree
+		FVector Offset = Random.VRand() * Random.FRandRange(0.0f, UseRadius * 3.0f);
+		if (i % 4 == 0)
+		{
+			const FVector Flat = FVector(Random.FRandRange(-1.0f, 1.0f), Random.FRandRange(-1.0f, 1.0f), 0.0f).GetSafeNormal();
+			Offset = Flat * UseRadius + FVector(0.0f, 0.0f, Random.FRandRange(-5.0f, 5.0f));
+		}
+
+		Batch.FeetLocations.Add(Target - Offset);
+		Batch.SegmentTargets.Add(Target);
+		Batch.SegmentDirections.Add(Direction);
+		Batch.ReachRadii.Add(GetCrowdReachRadius(AcceptanceRadius, AgentRadius));
+
+		AcceptanceRadii.Add(AcceptanceRadius);
+		AgentRadii.Add(AgentRadius);
+		AgentHalfHeights.Add(Random.FRandRange(40.0f, 100.0f));
+	}
+
+	Batch.Evaluate();
+
+	int32 NumReached = 0, NumNotReached = 0, NumExact = 0, NumWrong = 0, NumBadDirections = 0;
+	for (int32 i = 0; i < NumSamples; ++i)
+	{
+		const bool bExact = ExactReachTest(Batch.FeetLocations[i], Batch.SegmentTargets[i], Batch.SegmentDirections[i], AcceptanceRadii[i], AgentRadii[i], AgentHalfHeights[i], 0.05f);
+		const EVRCrowdReachResult Result = Batch.ReachResults[i];
+
+		if (Result == EVRCrowdReachResult::Reached)
+		{
+			++NumReached;
+			NumWrong += bExact ? 0 : 1;
+		}
+		else if (Result == EVRCrowdReachResult::NotReached)
+		{
+			++NumNotReached;
+			NumWrong += bExact ? 1 : 0;
+		}
+		else
+		{
+			++NumExact;
+		}
+
+		const FVector ToTarget = Batch.SegmentTargets[i] - Batch.FeetLocations[i];
+		if (!Batch.ToTargets[i].Equals(ToTarget, 0.0f) || !Batch.MoveDirections[i].Equals(ToTarget.GetSafeNormal(), 0.0f))
+			++NumBadDirections;
+	}
+
+	AddInfo(FString::Printf(TEXT("%d samples: %d reached, %d not reached, %d left to the exact test"), NumSamples, NumReached, NumNotReached, NumExact));
+
+	TestEqual(TEXT("The batched reach test never decides against the exact test"), NumWrong, 0);
+	TestEqual(TEXT("Batched move directions match the per agent ones"), NumBadDirections, 0);
+	TestTrue(TEXT("Most agents are decided without the exact test"), NumExact < NumSamples / 2);
+
+	{
+		// Right on the padded radius is still handed to the exact test
+		FVRPathFollowingCrowdBatch Edge;
+		Edge.FeetLocations.Add(FVector(-10.0f, 0.0f, 0.0f));
+		Edge.SegmentTargets.Add(FVector::ZeroVector);
+		Edge.SegmentDirections.Add(FVector(1.0f, 0.0f, 0.0f));
+		Edge.ReachRadii.Add(10.0f);
+
+		// Past the target along the segment
+		Edge.FeetLocations.Add(FVector(0.01f, 500.0f, 0.0f));
+		Edge.SegmentTargets.Add(FVector::ZeroVector);
+		Edge.SegmentDirections.Add(FVector(1.0f, 0.0f, 0.0f));
+		Edge.ReachRadii.Add(10.0f);
+
+		Edge.Evaluate();
+
+		TestTrue(TEXT("A point on the radius goes to the exact test"), Edge.ReachResults[0] == EVRCrowdReachResult::NeedsExactTest);
+		TestTrue(TEXT("A point past the target is reached however far away it is"), Edge.ReachResults[1] == EVRCrowdReachResult::Reached);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRPathFollowingCrowdConformanceTest, "VRExpansionPlugin.PathFollowingCrowd.Conformance", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRPathFollowingCrowdConformanceTest::RunTest(const FString& Parameters)
+{
+	// Enough frames for the slowest agent to reach the end of its path
+	const int32 NumAgents = 16;
+	const int32 NumSegments = 6;
+	const int32 NumFrames = 600;
+
+	const TArray<TArray<FAgentFrame>> PerAgent = RunCrowd(NumAgents, NumSegments, NumFrames, false, 0xC41);
+	const TArray<TArray<FAgentFrame>> Batched = RunCrowd(NumAgents, NumSegments, NumFrames, true, 0xC41);
+
+	int32 FirstMismatchFrame = INDEX_NONE;
+	int32 NumSegmentChanges = 0;
+
+	for (int32 Frame = 0; Frame < NumFrames && FirstMismatchFrame == INDEX_NONE; ++Frame)
+	{
+		for (int32 i = 0; i < NumAgents; ++i)
+		{
+			const FAgentFrame & Expected = PerAgent[Frame][i];
+			const FAgentFrame & Actual = Batched[Frame][i];
+
+			if (Expected.Status != Actual.Status || Expected.PathIndex != Actual.PathIndex || !Expected.MoveInput.Equals(Actual.MoveInput, KINDA_SMALL_NUMBER) || !Expected.Location.Equals(Actual.Location, KINDA_SMALL_NUMBER))
+			{
+				AddError(FString::Printf(TEXT("Agent %d differs on frame %d: per agent status %d segment %d input %s, batched status %d segment %d input %s"), i, Frame,
+					(int32)Expected.Status, Expected.PathIndex, *Expected.MoveInput.ToString(), (int32)Actual.Status, Actual.PathIndex, *Actual.MoveInput.ToString()));
+				FirstMismatchFrame = Frame;
+				break;
+			}
+
+			if (Frame > 0 && Expected.PathIndex != PerAgent[Frame - 1][i].PathIndex)
+				++NumSegmentChanges;
+		}
+	}
+
+	TestEqual(TEXT("The batched crowd follows the same paths as the per agent update"), FirstMismatchFrame, (int32)INDEX_NONE);
+	TestTrue(TEXT("The agents move through their segments"), NumSegmentChanges >= NumAgents * (NumSegments - 1));
+
+	bool bAllFinished = true;
+	for (const FAgentFrame & Final : Batched.Last())
+	{
+		bAllFinished &= Final.Status == EPathFollowingStatus::Idle;
+	}
+	TestTrue(TEXT("Every batched agent finishes its path"), bAllFinished);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRPathFollowingCrowdBenchmark, "VRExpansionPlugin.PathFollowingCrowd.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRPathFollowingCrowdBenchmark::RunTest(const FString& Parameters)
+{
+	const int32 AgentCounts[] = { 10, 100, 500 };
+	const int32 NumFrames = 120;
+
+	for (int32 NumAgents : AgentCounts)
+	{
+		double MicrosecondsPerAgent[2];
+
+		for (int32 Mode = 0; Mode < 2; ++Mode)
+		{
+			FScopedBatchedCVar ScopedBatched(Mode);
+			FCrowdTestWorld TestWorld;
+			FRandomStream Random(0xC42);
+
+			TArray<FCrowdTestAgent> Agents;
+			for (int32 i = 0; i < NumAgents; ++i)
+			{
+				Agents.Add(SpawnAgent(TestWorld.World, FVector((i % 32) * 3000.0f, (i / 32) * 3000.0f, 0.0f), 20, Random));
+			}
+
+			UVRPathFollowingCrowdManager * Manager = UVRPathFollowingCrowdManager::Get(TestWorld.World, false);
+
+			double TickSeconds = 0.0;
+			for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+			{
+				TestWorld.World->TimeSeconds += CrowdFrameTime;
+
+				const double StartTime = FPlatformTime::Seconds();
+				Manager->TickCrowd(CrowdFrameTime);
+				TickSeconds += FPlatformTime::Seconds() - StartTime;
+
+				MoveAgents(Agents, CrowdFrameTime);
+			}
+
+			MicrosecondsPerAgent[Mode] = TickSeconds * 1000000.0 / (double(NumFrames) * NumAgents);
+		}
+
+		AddInfo(FString::Printf(TEXT("%d agents: per agent %.3f us, batched %.3f us per agent per frame"), NumAgents, MicrosecondsPerAgent[0], MicrosecondsPerAgent[1]));
+		TestTrue(FString::Printf(TEXT("%d agents: both updates ran"), NumAgents), MicrosecondsPerAgent[0] > 0.0 && MicrosecondsPerAgent[1] > 0.0);
+	}
+
+	return true;
+}
+
+#endif
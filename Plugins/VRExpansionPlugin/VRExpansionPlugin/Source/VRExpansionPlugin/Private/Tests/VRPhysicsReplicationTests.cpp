@@ -0,0 +1,384 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "UObject/Package.h"
+#include "Components/StaticMeshComponent.h"
+#include "Grippables/GrippablePhysicsReplication.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_PHYSX
+
+namespace VRPhysicsReplicationTests
+{
+	// Runs the server correction solve on states the test hands it, no physics scene or bodies involved
+	class FPhysicsReplicationVRTestDriver : public FPhysicsReplicationVR
+	{
+	public:
+
+		FPhysicsReplicationVRTestDriver(const FRigidBodyErrorCorrection & ErrorCorrection) :
+			FPhysicsReplicationVR(nullptr)
+		{
+			CachedSettings.Gather(ErrorCorrection);
+		}
+
+		void BeginBatch() { Batch.Reset(); }
+
+		int32 AddTarget(UPrimitiveComponent * Key, FReplicatedPhysicsTarget & Target, const FRigidBodyState & CurrentState, float PingSecondsOneWay)
+		{
+			return Batch.Add(Key, nullptr, nullptr, &Target, PingSecondsOneWay, CurrentState);
+		}
+
+		void Solve(float DeltaSeconds) { SolveBatch(DeltaSeconds); }
+
+		// What resolving the tunables costs, the old path did it for every object
+		void GatherSettings(const FRigidBodyErrorCorrection & ErrorCorrection) { CachedSettings.Gather(ErrorCorrection); }
+
+		bool IsUntouched(int32 Index) const { return Batch.Results[Index] == Correction_None; }
+		bool IsRestored(int32 Index) const { return (Batch.Results[Index] & Correction_Restored) != 0; }
+		bool IsHardSnap(int32 Index) const { return (Batch.Results[Index] & Correction_HardSnap) != 0; }
+		bool IsInterpolated(int32 Index) const { return (Batch.Results[Index] & Correction_Interpolate) != 0; }
+		bool IsSleep(int32 Index) const { return (Batch.Results[Index] & Correction_Sleep) != 0; }
+		bool HasNewState(int32 Index) const { return (Batch.Results[Index] & (Correction_HardSnap | Correction_Interpolate)) != 0; }
+
+		const FVector & GetTargetPosition(int32 Index) const { return Batch.TargetPositions[Index]; }
+		const FQuat & GetTargetRotation(int32 Index) const { return Batch.TargetRotations[Index]; }
+		const FTransform & GetNewTransform(int32 Index) const { return Batch.NewTransforms[Index]; }
+		const FVector & GetNewLinearVelocity(int32 Index) const { return Batch.NewLinearVelocities[Index]; }
+
+		const FVRPhysicsReplicationErrorStats * GetStats(UPrimitiveComponent * Key) const { return ErrorStats.Find(Key); }
+	};
+
+	UPrimitiveComponent * MakeKey()
+	{
+		return NewObject<UStaticMeshComponent>(GetTransientPackage(), NAME_None, RF_Transient);
+	}
+
+	FRigidBodyState MakeState(const FVector & Position, const FVector & LinVel = FVector::ZeroVector, const FQuat & Rotation = FQuat::Identity, const FVector & AngVel = FVector::ZeroVector)
+	{
+		FRigidBodyState State;
+		State.Position = Position;
+		State.Quaternion = Rotation;
+		State.LinVel = LinVel;
+		State.AngVel = AngVel;
+		State.Flags = ERigidBodyFlags::NeedsUpdate;
+		return State;
+	}
+
+	FReplicatedPhysicsTarget MakeTarget(const FRigidBodyState & TargetState)
+	{
+		FReplicatedPhysicsTarget Target;
+		Target.TargetState = TargetState;
+		Target.PrevPosTarget = FVector::ZeroVector;
+		Target.PrevPos = FVector::ZeroVector;
+		return Target;
+	}
+
+	// The authoritative client's motion, location and velocity at a time
+	enum class EClientMotion
+	{
+		Carry,	// Walking with the object at a constant velocity
+		Swing,	// Swung around in a circle at arms length
+		Stop	// Thrown and caught, moves then stops dead
+	};
+
+	const TCHAR * GetMotionName(EClientMotion Motion)
+	{
+		switch (Motion)
+		{
+		case EClientMotion::Carry: return TEXT("Carry");
+		case EClientMotion::Swing: return TEXT("Swing");
+		default: return TEXT("Stop");
+		}
+	}
+
+	void SampleClientMotion(EClientMotion Motion, float Time, FVector & OutPosition, FVector & OutVelocity)
+	{
+		switch (Motion)
+		{
+		case EClientMotion::Carry:
+		{
+			OutVelocity = FVector(150.f, 0.f, 0.f);
+			OutPosition = OutVelocity * Time;
+		}break;
+		case EClientMotion::Swing:
+		{
+			const float Radius = 60.f;
+			const float AngularSpeed = PI; // Half a turn a second
+			OutPosition = FVector(FMath::Cos(Time * AngularSpeed), FMath::Sin(Time * AngularSpeed), 0.f) * Radius;
+			OutVelocity = FVector(-FMath::Sin(Time * AngularSpeed), FMath::Cos(Time * AngularSpeed), 0.f) * Radius * AngularSpeed;
+		}break;
+		case EClientMotion::Stop:
+		{
+			const float StopTime = 1.0f;
+			OutVelocity = Time < StopTime ? FVector(300.f, 0.f, 0.f) : FVector::ZeroVector;
+			OutPosition = FVector(300.f, 0.f, 0.f) * FMath::Min(Time, StopTime);
+		}break;
+		}
+	}
+
+	struct FLatencyRunResult
+	{
+		float MeanError;
+		float MaxError;
+		int32 NumHardSnaps;
+	};
+
+	// Headless server: the client sends its state at the net rate, it arrives half the round trip later and the server
+	// corrects its copy of the body with the batch solve before moving it on by its own velocity every physics tick
+	FLatencyRunResult RunLatencyScenario(const FRigidBodyErrorCorrection & ErrorCorrection, EClientMotion Motion, float RoundTripMs, bool bExtrapolateByPing)
+	{
+		const float ServerTickSeconds = 1.0f / 60.0f;
+		const float ClientSendSeconds = 1.0f / 30.0f;
+		const float DurationSeconds = 3.0f;
+		const float WarmupSeconds = 0.5f;
+		const float OneWaySeconds = RoundTripMs * 0.5f * 0.001f;
+
+		FPhysicsReplicationVRTestDriver Replication(ErrorCorrection);
+		UPrimitiveComponent * Key = MakeKey();
+
+		FVector ServerPosition;
+		FVector ServerVelocity;
+		SampleClientMotion(Motion, 0.f, ServerPosition, ServerVelocity);
+
+		TArray<TPair<float, FRigidBodyState>> InFlight;
+		FReplicatedPhysicsTarget Target = MakeTarget(MakeState(ServerPosition));
+		bool bHasTarget = false;
+		float NextSendTime = 0.f;
+
+		FLatencyRunResult Result;
+		Result.MeanError = 0.f;
+		Result.MaxError = 0.f;
+		Result.NumHardSnaps = 0;
+		int32 NumSamples = 0;
+
+		for (float Time = 0.f; Time < DurationSeconds; Time += ServerTickSeconds)
+		{
+			while (NextSendTime <= Time)
+			{
+				FVector SentPosition;
+				FVector SentVelocity;
+				SampleClientMotion(Motion, NextSendTime, SentPosition, SentVelocity);
+				InFlight.Emplace(NextSendTime + OneWaySeconds, MakeState(SentPosition, SentVelocity));
+				NextSendTime += ClientSendSeconds;
+			}
+
+			// Latest arrived state replaces the target, the same as a replicated movement update would
+			while (InFlight.Num() > 0 && InFlight[0].Key <= Time)
+			{
+				Target.TargetState = InFlight[0].Value;
+				Target.ArrivedTimeSeconds = Time;
+				bHasTarget = true;
+				InFlight.RemoveAt(0, 1, false);
+			}
+
+			if (bHasTarget)
+			{
+				Replication.BeginBatch();
+				const int32 Index = Replication.AddTarget(Key, Target, MakeState(ServerPosition, ServerVelocity), bExtrapolateByPing ? OneWaySeconds : 0.f);
+				Replication.Solve(ServerTickSeconds);
+
+				if (Replication.HasNewState(Index))
+				{
+					ServerPosition = Replication.GetNewTransform(Index).GetLocation();
+					ServerVelocity = Replication.GetNewLinearVelocity(Index);
+				}
+
+				Result.NumHardSnaps += Replication.IsHardSnap(Index) ? 1 : 0;
+
+				// Restored targets are removed until the next update arrives
+				if (Replication.IsRestored(Index))
+					bHasTarget = false;
+			}
+
+			ServerPosition += ServerVelocity * ServerTickSeconds;
+
+			if (Time >= WarmupSeconds)
+			{
+				FVector ClientPosition;
+				FVector ClientVelocity;
+				SampleClientMotion(Motion, Time + ServerTickSeconds, ClientPosition, ClientVelocity);
+
+				const float Error = FVector::Dist(ServerPosition, ClientPosition);
+				Result.MeanError += Error;
+				Result.MaxError = FMath::Max(Result.MaxError, Error);
+				++NumSamples;
+			}
+		}
+
+		Result.MeanError /= FMath::Max(NumSamples, 1);
+		return Result;
+	}
+}
+
+using namespace VRPhysicsReplicationTests;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRPhysicsReplicationSolveTest, "VRExpansionPlugin.PhysicsReplication.Solve", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRPhysicsReplicationSolveTest::RunTest(const FString& Parameters)
+{
+	FRigidBodyErrorCorrection ErrorCorrection;
+	ErrorCorrection.PingExtrapolation = 1.0f;
+	ErrorCorrection.PingLimit = 200.f;
+	FPhysicsReplicationVRTestDriver Replication(ErrorCorrection);
+
+	UPrimitiveComponent * Keys[] = { MakeKey(), MakeKey(), MakeKey(), MakeKey(), MakeKey(), MakeKey() };
+
+	FReplicatedPhysicsTarget Close = MakeTarget(MakeState(FVector(0.2f, 0.f, 0.f)));
+	FReplicatedPhysicsTarget Far = MakeTarget(MakeState(FVector(ErrorCorrection.MaxLinearHardSnapDistance + 50.f, 0.f, 0.f)));
+	FReplicatedPhysicsTarget Drifting = MakeTarget(MakeState(FVector(40.f, 0.f, 0.f)));
+	FReplicatedPhysicsTarget Moving = MakeTarget(MakeState(FVector::ZeroVector, FVector(100.f, 0.f, 0.f), FQuat::Identity, FVector(0.f, 0.f, 90.f)));
+	FReplicatedPhysicsTarget BadRotation = MakeTarget(MakeState(FVector(40.f, 0.f, 0.f), FVector::ZeroVector, FQuat(0.f, 0.f, 0.f, 0.f)));
+	FReplicatedPhysicsTarget Sleeping = MakeTarget(MakeState(FVector(0.1f, 0.f, 0.f)));
+	Sleeping.TargetState.Flags |= ERigidBodyFlags::Sleeping;
+
+	const FRigidBodyState AtOrigin = MakeState(FVector::ZeroVector);
+
+	Replication.BeginBatch();
+	const int32 CloseIndex = Replication.AddTarget(Keys[0], Close, AtOrigin, 0.f);
+	const int32 FarIndex = Replication.AddTarget(Keys[1], Far, AtOrigin, 0.f);
+	const int32 DriftingIndex = Replication.AddTarget(Keys[2], Drifting, AtOrigin, 0.f);
+	// 400ms round trip, clamped to the 200ms limit so 0.1s one way
+	const int32 MovingIndex = Replication.AddTarget(Keys[3], Moving, AtOrigin, 0.2f);
+	const int32 BadIndex = Replication.AddTarget(Keys[4], BadRotation, AtOrigin, 0.f);
+	const int32 SleepingIndex = Replication.AddTarget(Keys[5], Sleeping, AtOrigin, 0.f);
+	Replication.Solve(1.0f / 60.0f);
+
+	TestTrue(TEXT("Close target is restored without moving the body"), Replication.IsRestored(CloseIndex) && !Replication.HasNewState(CloseIndex));
+
+	TestTrue(TEXT("Far target hard snaps"), Replication.IsHardSnap(FarIndex));
+	TestTrue(TEXT("Hard snap goes straight to the target"), Replication.GetNewTransform(FarIndex).GetLocation().Equals(Far.TargetState.Position, 0.01f));
+
+	TestTrue(TEXT("Drifting target interpolates"), Replication.IsInterpolated(DriftingIndex) && !Replication.IsRestored(DriftingIndex));
+	TestTrue(TEXT("Interpolation pushes the body towards the target"), Replication.GetNewLinearVelocity(DriftingIndex).X > 0.f);
+
+	TestTrue(TEXT("Moving target is extrapolated by the clamped ping"), Replication.GetTargetPosition(MovingIndex).Equals(FVector(10.f, 0.f, 0.f), 0.01f));
+	TestEqual(TEXT("Extrapolated rotation"), Replication.GetTargetRotation(MovingIndex).Rotator().Yaw, 9.f, 0.01f);
+
+	TestTrue(TEXT("Bad rotation leaves the body alone"), Replication.IsUntouched(BadIndex));
+	TestTrue(TEXT("Sleeping target puts the body to sleep"), Replication.IsSleep(SleepingIndex));
+
+	const FVRPhysicsReplicationErrorStats * FarStats = Replication.GetStats(Keys[1]);
+	const FVRPhysicsReplicationErrorStats * MovingStats = Replication.GetStats(Keys[3]);
+	if (TestTrue(TEXT("Stats kept for corrected targets"), FarStats != nullptr && MovingStats != nullptr))
+	{
+		TestEqual(TEXT("Hard snaps counted"), FarStats->NumHardSnaps, 1);
+		TestEqual(TEXT("Linear error"), FarStats->LinearError, ErrorCorrection.MaxLinearHardSnapDistance + 50.f, 0.01f);
+		TestEqual(TEXT("Ping used is the clamped one"), MovingStats->PingSecondsOneWay, 0.1f, 0.0001f);
+	}
+	TestTrue(TEXT("No stats for an untouched target"), Replication.GetStats(Keys[4]) == nullptr);
+
+	// The same far target again, peak error is kept while the last error follows the body
+	Replication.BeginBatch();
+	const int32 SecondIndex = Replication.AddTarget(Keys[1], Far, MakeState(Far.TargetState.Position - FVector(5.f, 0.f, 0.f)), 0.f);
+	Replication.Solve(1.0f / 60.0f);
+	TestTrue(TEXT("Small remaining error interpolates"), Replication.IsInterpolated(SecondIndex));
+	TestEqual(TEXT("Peak error kept"), FarStats->MaxLinearError, ErrorCorrection.MaxLinearHardSnapDistance + 50.f, 0.01f);
+	TestEqual(TEXT("Corrections counted"), FarStats->NumCorrections, 2);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRPhysicsReplicationLatencyTest, "VRExpansionPlugin.PhysicsReplication.Latency", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRPhysicsReplicationLatencyTest::RunTest(const FString& Parameters)
+{
+	const EClientMotion Motions[] = { EClientMotion::Carry, EClientMotion::Swing, EClientMotion::Stop };
+	const float RoundTrips[] = { 0.f, 50.f, 100.f, 200.f };
+
+	FRigidBodyErrorCorrection ErrorCorrection;
+	ErrorCorrection.PingExtrapolation = 1.0f;
+	ErrorCorrection.PingLimit = 300.f;
+
+	for (EClientMotion Motion : Motions)
+	{
+		for (float RoundTrip : RoundTrips)
+		{
+			const FLatencyRunResult WithPing = RunLatencyScenario(ErrorCorrection, Motion, RoundTrip, true);
+			const FLatencyRunResult WithoutPing = RunLatencyScenario(ErrorCorrection, Motion, RoundTrip, false);
+
+			AddInfo(FString::Printf(TEXT("%s at %.0fms: mean / max error %.2f / %.2f cm extrapolated, %.2f / %.2f cm without, %d / %d hard snaps"),
+				GetMotionName(Motion), RoundTrip, WithPing.MeanError, WithPing.MaxError, WithoutPing.MeanError, WithoutPing.MaxError, WithPing.NumHardSnaps, WithoutPing.NumHardSnaps));
+
+			// Never far enough off to need the hard snap, and carrying at a steady speed is where extrapolation has to pay off
+			TestTrue(FString::Printf(TEXT("%s at %.0fms stays under the snap distance"), GetMotionName(Motion), RoundTrip), WithPing.MaxError < ErrorCorrection.MaxLinearHardSnapDistance);
+
+			if (Motion == EClientMotion::Carry && RoundTrip >= 100.f)
+				TestTrue(FString::Printf(TEXT("Carry at %.0fms is closer with extrapolation"), RoundTrip), WithPing.MeanError < WithoutPing.MeanError);
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRPhysicsReplicationBenchmark, "VRExpansionPlugin.PhysicsReplication.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRPhysicsReplicationBenchmark::RunTest(const FString& Parameters)
+{
+	const int32 TargetCounts[] = { 100, 1000, 10000 };
+	const int32 NumTicks = 30;
+
+	FRigidBodyErrorCorrection ErrorCorrection;
+	FPhysicsReplicationVRTestDriver Replication(ErrorCorrection);
+
+	for (int32 NumTargets : TargetCounts)
+	{
+		FRandomStream Random(NumTargets);
+		TArray<UPrimitiveComponent *> Keys;
+		TArray<FReplicatedPhysicsTarget> Targets;
+		TArray<FRigidBodyState> States;
+
+		for (int32 i = 0; i < NumTargets; ++i)
+		{
+			Keys.Add(MakeKey());
+			const FVector Position = Random.GetUnitVector() * Random.FRandRange(0.f, 1000.f);
+			Targets.Add(MakeTarget(MakeState(Position + Random.GetUnitVector() * Random.FRandRange(0.f, 60.f), Random.GetUnitVector() * 100.f)));
+			States.Add(MakeState(Position));
+		}
+
+		double SolveSeconds = 0.0;
+		for (int32 Tick = 0; Tick < NumTicks; ++Tick)
+		{
+			Replication.BeginBatch();
+			for (int32 i = 0; i < NumTargets; ++i)
+			{
+				Replication.AddTarget(Keys[i], Targets[i], States[i], 0.05f);
+			}
+
+			const double Start = FPlatformTime::Seconds();
+			Replication.Solve(1.0f / 60.0f);
+			SolveSeconds += FPlatformTime::Seconds() - Start;
+		}
+
+		// Resolving the tunables (and their p.* overrides) for every object, what the per object path paid on top
+		const double GatherStart = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumTargets; ++i)
+		{
+			Replication.GatherSettings(ErrorCorrection);
+		}
+		const double GatherSeconds = FPlatformTime::Seconds() - GatherStart;
+
+		AddInfo(FString::Printf(TEXT("%d targets: batch solve %.1f ns per target, resolving settings per target would add %.1f ns"),
+			NumTargets, SolveSeconds * 1e9 / ((double)NumTargets * NumTicks), GatherSeconds * 1e9 / NumTargets));
+	}
+
+	// Error the server is left with per round trip, the extrapolation the owner ping buys
+	FRigidBodyErrorCorrection FullExtrapolation;
+	FullExtrapolation.PingExtrapolation = 1.0f;
+	FullExtrapolation.PingLimit = 300.f;
+
+	const float RoundTrips[] = { 50.f, 100.f, 200.f };
+	for (float RoundTrip : RoundTrips)
+	{
+		const FLatencyRunResult ProjectDefaults = RunLatencyScenario(ErrorCorrection, EClientMotion::Swing, RoundTrip, true);
+		const FLatencyRunResult Full = RunLatencyScenario(FullExtrapolation, EClientMotion::Swing, RoundTrip, true);
+		const FLatencyRunResult None = RunLatencyScenario(FullExtrapolation, EClientMotion::Swing, RoundTrip, false);
+
+		AddInfo(FString::Printf(TEXT("Swing at %.0fms: mean error %.2f cm zero latency assumed, %.2f cm default extrapolation, %.2f cm full extrapolation"),
+			RoundTrip, None.MeanError, ProjectDefaults.MeanError, Full.MeanError));
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS && WITH_PHYSX
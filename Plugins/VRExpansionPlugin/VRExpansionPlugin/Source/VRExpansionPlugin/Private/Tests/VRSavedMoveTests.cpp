@@ -0,0 +1,328 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+#include "HAL/PlatformTime.h"
+#include "Serialization/BitWriter.h"
+#include "UObject/Package.h"
+#include "VRCharacterMovementComponent.h"
+#include "VRRootComponent.h"
+#include "VRExpansionFunctionLibrary.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace VRSavedMoveTests
+{
+	// Everything the client writes into a saved move for one frame
+	struct FRecordedFrame
+	{
+		EVRConjoinedMovementModes Mode;
+		FVector CapsuleLocation;
+		FRotator CapsuleRotation;
+		FVector LFDiff;
+		FVector CustomVRInputVector;
+		FVector RequestedVelocity;
+		FVector Acceleration;
+		FRotator CameraRotation;
+		TArray<FVRMoveActionContainer> MoveActions;
+	};
+
+	// Mostly plain walking frames, with the occasional move action burst that spills past the inline storage
+	void RecordFrames(int32 NumFrames, int32 Seed, TArray<FRecordedFrame> & OutFrames)
+	{
+		FRandomStream Random(Seed);
+		OutFrames.Reset(NumFrames);
+
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			FRecordedFrame & Recorded = OutFrames.AddDefaulted_GetRef();
+			const float Roll = Random.FRand();
+
+			Recorded.Mode = Roll < 0.05f ? EVRConjoinedMovementModes::C_VRMOVE_Climbing : EVRConjoinedMovementModes::C_MOVE_MAX;
+			Recorded.CapsuleLocation = Random.GetUnitVector() * Random.FRandRange(0.0f, 2000.0f);
+			Recorded.CapsuleRotation = FRotator(0.0f, Random.FRandRange(-180.0f, 180.0f), 0.0f);
+			Recorded.LFDiff = FVector(Random.FRandRange(-2.0f, 2.0f), Random.FRandRange(-2.0f, 2.0f), Frame % 30 == 0 ? Random.FRandRange(-5.0f, 5.0f) : 0.0f);
+			Recorded.CustomVRInputVector = Roll > 0.9f ? Random.GetUnitVector() * 50.0f : FVector::ZeroVector;
+			Recorded.RequestedVelocity = Roll > 0.95f ? Random.GetUnitVector() * 300.0f : FVector::ZeroVector;
+			Recorded.Acceleration = FVector(Random.FRandRange(-1.0f, 1.0f), Random.FRandRange(-1.0f, 1.0f), 0.0f) * 2048.0f;
+			Recorded.CameraRotation = FRotator(Random.FRandRange(-80.0f, 80.0f), Random.FRandRange(-180.0f, 180.0f), Random.FRandRange(-30.0f, 30.0f));
+
+			const int32 NumActions = Roll > 0.97f ? 3 : (Roll > 0.85f ? 1 : 0);
+			for (int32 i = 0; i < NumActions; ++i)
+			{
+				FVRMoveActionContainer & Action = Recorded.MoveActions.AddDefaulted_GetRef();
+				Action.MoveAction = (EVRMoveAction)Random.RandRange(0, (int32)EVRMoveAction::VRMOVEACTION_CUSTOM10);
+				Action.MoveActionDataReq = (EVRMoveActionDataReq)Random.RandRange(0, 3);
+				Action.MoveActionLoc = Random.GetUnitVector() * Random.FRandRange(0.0f, 1000.0f);
+				Action.MoveActionRot = FRotator(Random.FRandRange(-90.0f, 90.0f), Random.FRandRange(-180.0f, 180.0f), 0.0f);
+			}
+		}
+	}
+
+	// The part of SetInitialPosition and PostUpdate that copies component state into the move
+	void FillMove(FSavedMove_VRBaseCharacter & Move, const FRecordedFrame & Recorded)
+	{
+		Move.VRReplicatedMovementMode = Recorded.Mode;
+		Move.VRCapsuleLocation = Recorded.CapsuleLocation;
+		Move.VRCapsuleRotation = Recorded.CapsuleRotation;
+		Move.LFDiff = Recorded.LFDiff;
+		Move.Acceleration = Recorded.Acceleration;
+		Move.ConditionalValues.CustomVRInputVector = Recorded.CustomVRInputVector;
+		Move.ConditionalValues.RequestedVelocity = Recorded.RequestedVelocity;
+		Move.ConditionalValues.MoveActionArray.MoveActions.Append(Recorded.MoveActions);
+	}
+
+	// What ServerMoveVR sends for a move, the conditional values and the packed flags
+	void WriteMove(FSavedMove_VRBaseCharacter & Move, FBitWriter & Writer)
+	{
+		bool bSuccess = true;
+		uint8 Flags = Move.GetCompressedFlags();
+		Writer << Flags;
+		Writer << Move.VRCapsuleLocation;
+		Writer << Move.LFDiff;
+		Move.ConditionalValues.NetSerialize(Writer, nullptr, bSuccess);
+	}
+
+	// The VR half of CanCombineWith, the character half needs a spawned character
+	bool CanCombineVR(const FSavedMove_VRBaseCharacter & Pending, const FSavedMove_VRBaseCharacter & NewMove)
+	{
+		const FVRConditionalMoveRep & A = Pending.ConditionalValues;
+		const FVRConditionalMoveRep & B = NewMove.ConditionalValues;
+
+		return Pending.VRReplicatedMovementMode == NewMove.VRReplicatedMovementMode &&
+			A.MoveActionArray.MoveActions.Num() == 0 && B.MoveActionArray.MoveActions.Num() == 0 &&
+			A.CustomVRInputVector.IsZero() && B.CustomVRInputVector.IsZero() &&
+			A.RequestedVelocity.IsZero() && B.RequestedVelocity.IsZero() &&
+			FMath::IsNearlyEqual(Pending.LFDiff.Z, NewMove.LFDiff.Z);
+	}
+
+	bool BitsMatch(const FBitWriter & A, const FBitWriter & B)
+	{
+		return A.GetNumBits() == B.GetNumBits() && FMemory::Memcmp(A.GetData(), B.GetData(), A.GetNumBytes()) == 0;
+	}
+
+	// A project side saved move type, the pool has to hand these out and not the plugins own
+	class FDerivedSavedMove : public FSavedMove_VRCharacter
+	{
+	public:
+		static const uint32 Marker = 0x5A7EDu;
+		uint32 DerivedMarker;
+
+		FDerivedSavedMove() : FSavedMove_VRCharacter()
+		{
+			DerivedMarker = Marker;
+		}
+	};
+
+	// Counts every move that had to be allocated
+	class FCountingPredictionData : public FNetworkPredictionData_Client_VRCharacter
+	{
+	public:
+		int32 NumAllocated;
+
+		FCountingPredictionData(const UCharacterMovementComponent & ClientMovement)
+			: FNetworkPredictionData_Client_VRCharacter(ClientMovement)
+		{
+			NumAllocated = 0;
+		}
+
+		FSavedMovePtr AllocateNewMove() override
+		{
+			++NumAllocated;
+			return FSavedMovePtr(new FDerivedSavedMove());
+		}
+	};
+
+	UVRCharacterMovementComponent * MakeMovement()
+	{
+		return NewObject<UVRCharacterMovementComponent>(GetTransientPackage(), NAME_None, RF_Transient);
+	}
+
+	FSavedMove_VRBaseCharacter * AsVRMove(const FSavedMovePtr & Move)
+	{
+		return (FSavedMove_VRBaseCharacter *)Move.Get();
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRSavedMoveReplayBitIdentityTest, "VRExpansionPlugin.SavedMoves.ReplayBitIdentity", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRSavedMoveReplayBitIdentityTest::RunTest(const FString& Parameters)
+{
+	using namespace VRSavedMoveTests;
+
+	TArray<FRecordedFrame> Frames;
+	RecordFrames(512, 0x5AFE, Frames);
+
+	UVRCharacterMovementComponent * Movement = MakeMovement();
+	FCountingPredictionData ClientData(*Movement);
+	PrewarmVRSavedMovePool(ClientData);
+
+	TestTrue(TEXT("Prewarming allocates into the free pool"), ClientData.FreeMoves.Num() > 0 && ClientData.FreeMoves.Num() <= ClientData.MaxFreeMoveCount);
+	TestEqual(TEXT("Every prewarmed move came from the most derived AllocateNewMove"), ClientData.NumAllocated, ClientData.FreeMoves.Num());
+
+	bool bAllDerived = true;
+	for (const FSavedMovePtr & Move : ClientData.FreeMoves)
+		bAllDerived &= ((FDerivedSavedMove *)Move.Get())->DerivedMarker == FDerivedSavedMove::Marker;
+
+	TestTrue(TEXT("Prewarmed moves are the projects own saved move type"), bAllDerived);
+
+	// Pooled moves cycle through Clear() with their spilled move action storage kept, fresh moves are built from nothing
+	int32 NumMismatches = 0;
+	for (int32 Frame = 0; Frame < Frames.Num() && NumMismatches < 10; ++Frame)
+	{
+		FSavedMovePtr Pooled = ClientData.CreateSavedMove();
+		if (!Pooled.IsValid())
+		{
+			AddError(TEXT("The pool ran dry with moves being freed every frame"));
+			break;
+		}
+
+		FillMove(*AsVRMove(Pooled), Frames[Frame]);
+
+		FSavedMove_VRCharacter Fresh;
+		Fresh.Clear();
+		FillMove(Fresh, Frames[Frame]);
+
+		FBitWriter PooledWriter(256, true);
+		FBitWriter FreshWriter(256, true);
+		WriteMove(*AsVRMove(Pooled), PooledWriter);
+		WriteMove(Fresh, FreshWriter);
+
+		// Replaying reads the same move again after newer ones were saved
+		ClientData.SavedMoves.Add(Pooled);
+		FBitWriter ReplayWriter(256, true);
+		WriteMove(*AsVRMove(ClientData.SavedMoves.Last()), ReplayWriter);
+
+		if (!BitsMatch(PooledWriter, FreshWriter) || !BitsMatch(PooledWriter, ReplayWriter))
+		{
+			AddError(FString::Printf(TEXT("Frame %d serialized %lld bits from a pooled move, %lld fresh and %lld on replay"), Frame, PooledWriter.GetNumBits(), FreshWriter.GetNumBits(), ReplayWriter.GetNumBits()));
+			++NumMismatches;
+		}
+
+		// Ack a few frames behind, which hands the moves back to the pool
+		while (ClientData.SavedMoves.Num() > 4)
+		{
+			ClientData.FreeMove(ClientData.SavedMoves[0]);
+			ClientData.SavedMoves.RemoveAt(0, 1, false);
+		}
+	}
+
+	// The cached pure yaw has to hold up when a replay writes an older camera rotation back
+	UVRRootComponent * Root = NewObject<UVRRootComponent>(GetTransientPackage(), NAME_None, RF_Transient);
+	int32 NumYawMismatches = 0;
+	for (int32 Frame = 0; Frame < Frames.Num(); ++Frame)
+	{
+		Root->curCameraRot = Frames[Frame].CameraRotation;
+		Root->StoredCameraRotOffset = UVRExpansionFunctionLibrary::GetHMDPureYaw_I(Root->curCameraRot);
+		Root->StoredCameraRotSource = Root->curCameraRot;
+
+		const FRotator Live = Root->GetCurrentCameraPureYaw();
+		Root->curCameraRot = Frames[FMath::Max(Frame - 3, 0)].CameraRotation;
+		const FRotator Replayed = Root->GetCurrentCameraPureYaw();
+
+		if (Live != UVRExpansionFunctionLibrary::GetHMDPureYaw_I(Frames[Frame].CameraRotation) || Replayed != UVRExpansionFunctionLibrary::GetHMDPureYaw_I(Root->curCameraRot))
+			++NumYawMismatches;
+	}
+
+	TestEqual(TEXT("The cached pure yaw is bit identical to recomputing it, live and on replay"), NumYawMismatches, 0);
+
+	Root->MarkPendingKill();
+	Movement->MarkPendingKill();
+	return NumMismatches == 0;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRSavedMoveLifecycleBenchmark, "VRExpansionPlugin.SavedMoves.LifecycleBenchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRSavedMoveLifecycleBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace VRSavedMoveTests;
+
+	UVRCharacterMovementComponent * Movement = MakeMovement();
+	TArray<FRecordedFrame> Frames;
+	const int32 NumOutstandingCounts[] = { 64, 128, 256 };
+
+	for (int32 NumOutstanding : NumOutstandingCounts)
+	{
+		RecordFrames(NumOutstanding * 32, NumOutstanding, Frames);
+
+		FCountingPredictionData ClientData(*Movement);
+		ClientData.MaxSavedMoveCount = FMath::Max(ClientData.MaxSavedMoveCount, NumOutstanding + 1);
+		ClientData.MaxFreeMoveCount = FMath::Max(ClientData.MaxFreeMoveCount, NumOutstanding + 1);
+		PrewarmVRSavedMovePool(ClientData);
+
+		const int32 NumPrewarmed = ClientData.NumAllocated;
+		int32 NumAllocatedAfterFirstLap = INDEX_NONE;
+		int32 NumCombined = 0;
+		int32 NumReplays = 0;
+		int32 NumReplayedMoves = 0;
+		double ReplaySeconds = 0.0;
+		FSavedMovePtr PendingMove;
+		FBitWriter Writer(256, true);
+
+		const double StartTime = FPlatformTime::Seconds();
+
+		for (int32 Frame = 0; Frame < Frames.Num(); ++Frame)
+		{
+			// Create, a move is made for every frame
+			FSavedMovePtr NewMove = ClientData.CreateSavedMove();
+			FillMove(*AsVRMove(NewMove), Frames[Frame]);
+
+			// Combine, a pending move with nothing VR specific in it is folded into the new one and goes back to the pool
+			if (PendingMove.IsValid())
+			{
+				if (CanCombineVR(*AsVRMove(PendingMove), *AsVRMove(NewMove)))
+				{
+					ClientData.FreeMove(PendingMove);
+					++NumCombined;
+				}
+				else
+					ClientData.SavedMoves.Add(PendingMove);
+			}
+
+			PendingMove = NewMove;
+
+			// Ack, the server is always NumOutstanding moves behind
+			while (ClientData.SavedMoves.Num() > NumOutstanding)
+			{
+				ClientData.FreeMove(ClientData.SavedMoves[0]);
+				ClientData.SavedMoves.RemoveAt(0, 1, false);
+			}
+
+			// Replay, a correction every 16 frames re-sends everything still unacked
+			if (Frame % 16 == 15)
+			{
+				const double ReplayStart = FPlatformTime::Seconds();
+				for (const FSavedMovePtr & Move : ClientData.SavedMoves)
+				{
+					Writer.Reset();
+					WriteMove(*AsVRMove(Move), Writer);
+				}
+				ReplaySeconds += FPlatformTime::Seconds() - ReplayStart;
+				NumReplayedMoves += ClientData.SavedMoves.Num();
+				++NumReplays;
+			}
+
+			// Once the server is a full window behind the pool holds every move that can be live at once
+			if (NumAllocatedAfterFirstLap == INDEX_NONE && ClientData.SavedMoves.Num() == NumOutstanding)
+				NumAllocatedAfterFirstLap = ClientData.NumAllocated;
+		}
+
+		const double TotalSeconds = FPlatformTime::Seconds() - StartTime;
+
+		AddInfo(FString::Printf(TEXT("%d outstanding: %d moves (%d combined) in %.3f ms, %d allocations with %d prewarmed, %.2f us per replay of %.1f moves"),
+			NumOutstanding, Frames.Num(), NumCombined, TotalSeconds * 1000.0, ClientData.NumAllocated, NumPrewarmed,
+			NumReplays ? (ReplaySeconds * 1000000.0) / NumReplays : 0.0, NumReplays ? (float)NumReplayedMoves / NumReplays : 0.0f));
+
+		TestTrue(FString::Printf(TEXT("%d outstanding moves reach a full window"), NumOutstanding), NumAllocatedAfterFirstLap != INDEX_NONE);
+		TestEqual(FString::Printf(TEXT("%d outstanding moves stop allocating once the pool has filled"), NumOutstanding), ClientData.NumAllocated, NumAllocatedAfterFirstLap);
+
+		ClientData.FreeMove(PendingMove);
+		PendingMove.Reset();
+	}
+
+	Movement->MarkPendingKill();
+	return true;
+}
+
+#endif
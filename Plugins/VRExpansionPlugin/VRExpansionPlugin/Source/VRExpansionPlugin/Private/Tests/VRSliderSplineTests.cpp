@@ -0,0 +1,357 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+#include "HAL/PlatformTime.h"
+#include "UObject/Package.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/WorldSettings.h"
+#include "Components/SplineComponent.h"
+#include "Interactibles/VRSliderComponent.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace VRSliderSplineTests
+{
+	// Lookup results have to be as close to the curve as the engine search, give or take this much (cm)
+	const float ClosestPointTolerance = 0.05f;
+
+	enum class ESplineShape
+	{
+		Line,
+		SCurve,
+		Helix,
+		Circle
+	};
+
+	const TCHAR * GetShapeName(ESplineShape Shape)
+	{
+		switch (Shape)
+		{
+		case ESplineShape::Line: return TEXT("Line");
+		case ESplineShape::SCurve: return TEXT("SCurve");
+		case ESplineShape::Helix: return TEXT("Helix");
+		default: return TEXT("Circle");
+		}
+	}
+
+	USplineComponent * MakeSpline(ESplineShape Shape, int32 NumPoints, UObject * Outer = nullptr)
+	{
+		USplineComponent * Spline = NewObject<USplineComponent>(Outer ? Outer : GetTransientPackage(), NAME_None, RF_Transient);
+
+		TArray<FVector> Points;
+		for (int32 i = 0; i < NumPoints; ++i)
+		{
+			const float Alpha = (float)i / (float)(NumPoints - 1);
+			switch (Shape)
+			{
+			case ESplineShape::Line: Points.Add(FVector(Alpha * 200.f, 0.f, 0.f)); break;
+			case ESplineShape::SCurve: Points.Add(FVector(Alpha * 300.f, FMath::Sin(Alpha * 2.f * PI) * 60.f, 0.f)); break;
+			case ESplineShape::Helix: Points.Add(FVector(FMath::Cos(Alpha * 8.f * PI) * 50.f, FMath::Sin(Alpha * 8.f * PI) * 50.f, Alpha * 120.f)); break;
+			case ESplineShape::Circle:
+			{
+				// Last point would duplicate the first, the loop closes it
+				const float Angle = 2.f * PI * (float)i / (float)NumPoints;
+				Points.Add(FVector(FMath::Cos(Angle) * 80.f, FMath::Sin(Angle) * 80.f, 0.f));
+			}break;
+			}
+		}
+
+		Spline->SetSplinePoints(Points, ESplineCoordinateSpace::Local, true);
+		if (Shape == ESplineShape::Circle)
+			Spline->SetClosedLoop(true, true);
+
+		return Spline;
+	}
+
+	// A point near the spline and the key it was made from, offsets are kept well under the curve radius so the closest key is unambiguous
+	FVector MakeQuery(FRandomStream & Random, const USplineComponent * Spline, float MaxOffset, float * OutKey = nullptr)
+	{
+		const float Distance = Random.FRandRange(0.f, Spline->GetSplineLength());
+		const float Key = Spline->SplineCurves.ReparamTable.Eval(Distance, 0.0f);
+		if (OutKey)
+			*OutKey = Key;
+
+		return Spline->SplineCurves.Position.Eval(Key, FVector::ZeroVector) + Random.GetUnitVector() * Random.FRandRange(0.f, MaxOffset);
+	}
+
+	float DistanceToKey(const USplineComponent * Spline, const FVector & LocalLocation, float Key)
+	{
+		return FVector::Dist(Spline->SplineCurves.Position.Eval(Key, FVector::ZeroVector), LocalLocation);
+	}
+
+	// What the slider used before the table, the engines per segment search
+	float FindEngineKey(const USplineComponent * Spline, const FVector & LocalLocation)
+	{
+		float DistSq = 0.f;
+		return Spline->SplineCurves.Position.InaccurateFindNearest(LocalLocation, DistSq);
+	}
+
+	struct FSplineTestWorld
+	{
+		UWorld * World;
+		AActor * Owner;
+
+		FSplineTestWorld()
+		{
+			World = UWorld::CreateWorld(EWorldType::Game, false);
+			FWorldContext & Context = GEngine->CreateNewWorldContext(EWorldType::Game);
+			Context.SetCurrentWorld(World);
+			World->InitializeActorsForPlay(FURL());
+			World->GetWorldSettings()->NotifyBeginPlay();
+
+			Owner = World->SpawnActor<AActor>();
+			USceneComponent * Root = NewObject<USceneComponent>(Owner, TEXT("Root"));
+			Owner->SetRootComponent(Root);
+			Root->RegisterComponent();
+		}
+
+		~FSplineTestWorld()
+		{
+			GEngine->DestroyWorldContext(World);
+			World->DestroyWorld(false);
+		}
+	};
+}
+
+using namespace VRSliderSplineTests;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRSliderSplineClosestKeyTest, "VRExpansionPlugin.SliderSpline.ClosestKey", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRSliderSplineClosestKeyTest::RunTest(const FString& Parameters)
+{
+	const ESplineShape Shapes[] = { ESplineShape::Line, ESplineShape::SCurve, ESplineShape::Helix, ESplineShape::Circle };
+	const float Spacings[] = { 2.f, 10.f, 40.f };
+
+	for (ESplineShape Shape : Shapes)
+	{
+		USplineComponent * Spline = MakeSpline(Shape, 24);
+
+		for (float Spacing : Spacings)
+		{
+			FRandomStream Random(30 + (int32)Spacing);
+			FVRSliderSplineLookup Lookup;
+			Lookup.Build(Spline, Spacing);
+
+			if (!TestTrue(FString::Printf(TEXT("%s: table built"), GetShapeName(Shape)), Lookup.HasSamples()))
+				continue;
+
+			const float EndKey = Spline->SplineCurves.ReparamTable.Eval(Spline->GetSplineLength(), 0.0f);
+
+			int32 NumWorse = 0;
+			int32 NumHintMismatch = 0;
+			float WorstError = 0.f;
+
+			for (int32 Query = 0; Query < 500; ++Query)
+			{
+				float SourceKey = 0.f;
+				const FVector Location = MakeQuery(Random, Spline, 5.f, &SourceKey);
+				const float EngineDistance = DistanceToKey(Spline, Location, FindEngineKey(Spline, Location));
+
+				// Without a hint, with one from a frame ago, and with one from the wrong end of the spline
+				const float Hints[] = { -1.f, FMath::Max(0.f, SourceKey - 0.05f), SourceKey < EndKey * 0.5f ? EndKey : 0.f };
+				float HintedDistances[ARRAY_COUNT(Hints)];
+
+				for (int32 HintIndex = 0; HintIndex < ARRAY_COUNT(Hints); ++HintIndex)
+				{
+					HintedDistances[HintIndex] = DistanceToKey(Spline, Location, Lookup.FindInputKeyClosestToLocalLocation(Location, Hints[HintIndex]));
+				}
+
+				WorstError = FMath::Max(WorstError, HintedDistances[0] - EngineDistance);
+				NumWorse += HintedDistances[0] > EngineDistance + ClosestPointTolerance ? 1 : 0;
+
+				for (int32 HintIndex = 1; HintIndex < ARRAY_COUNT(Hints); ++HintIndex)
+				{
+					NumHintMismatch += !FMath::IsNearlyEqual(HintedDistances[HintIndex], HintedDistances[0], ClosestPointTolerance) ? 1 : 0;
+				}
+			}
+
+			TestEqual(FString::Printf(TEXT("%s spacing %.0f: further from the curve than the engine search (worst %.4f cm)"), GetShapeName(Shape), Spacing, WorstError), NumWorse, 0);
+			TestEqual(FString::Printf(TEXT("%s spacing %.0f: hint changed the answer"), GetShapeName(Shape), Spacing), NumHintMismatch, 0);
+		}
+	}
+
+	// Points past either end clamp to the ends
+	USplineComponent * Line = MakeSpline(ESplineShape::Line, 5);
+	FVRSliderSplineLookup Lookup;
+	Lookup.Build(Line, 10.f);
+	TestEqual(TEXT("Before the start"), Lookup.FindInputKeyClosestToLocalLocation(FVector(-50.f, 10.f, 0.f), -1.f), 0.f);
+	TestEqual(TEXT("Past the end"), Lookup.FindInputKeyClosestToLocalLocation(FVector(400.f, -10.f, 0.f), 2.f), 4.f);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRSliderSplineDistanceTest, "VRExpansionPlugin.SliderSpline.DistanceToKey", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRSliderSplineDistanceTest::RunTest(const FString& Parameters)
+{
+	const ESplineShape Shapes[] = { ESplineShape::Line, ESplineShape::SCurve, ESplineShape::Helix, ESplineShape::Circle };
+
+	for (ESplineShape Shape : Shapes)
+	{
+		USplineComponent * Spline = MakeSpline(Shape, 24);
+		const float SplineLength = Spline->GetSplineLength();
+
+		FVRSliderSplineLookup Lookup;
+		Lookup.Build(Spline, 10.f);
+		TestEqual(FString::Printf(TEXT("%s: length"), GetShapeName(Shape)), Lookup.GetSplineLength(), SplineLength);
+
+		// Snap points look keys up by distance, the location they land on has to match the engines reparam table
+		float WorstError = 0.f;
+		int32 NumBackwards = 0;
+		float LastKey = -1.f;
+
+		for (int32 Step = 0; Step <= 1000; ++Step)
+		{
+			const float Distance = SplineLength * (float)Step / 1000.f;
+			const float Key = Lookup.GetInputKeyAtDistance(Distance);
+			const float EngineKey = Spline->SplineCurves.ReparamTable.Eval(Distance, 0.0f);
+
+			WorstError = FMath::Max(WorstError, FVector::Dist(Spline->SplineCurves.Position.Eval(Key, FVector::ZeroVector), Spline->SplineCurves.Position.Eval(EngineKey, FVector::ZeroVector)));
+			NumBackwards += Key < LastKey ? 1 : 0;
+			LastKey = Key;
+		}
+
+		TestTrue(FString::Printf(TEXT("%s: keys by distance land within 0.5cm of the reparam table (worst %.4f cm)"), GetShapeName(Shape), WorstError), WorstError <= 0.5f);
+		TestEqual(FString::Printf(TEXT("%s: keys never go backwards"), GetShapeName(Shape)), NumBackwards, 0);
+		TestEqual(FString::Printf(TEXT("%s: start"), GetShapeName(Shape)), Lookup.GetInputKeyAtDistance(-10.f), Spline->SplineCurves.ReparamTable.Eval(0.f, 0.0f));
+		TestEqual(FString::Printf(TEXT("%s: end"), GetShapeName(Shape)), Lookup.GetInputKeyAtDistance(SplineLength + 10.f), Spline->SplineCurves.ReparamTable.Eval(SplineLength, 0.0f), 0.001f);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRSliderSplineRebuildTest, "VRExpansionPlugin.SliderSpline.Rebuild", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRSliderSplineRebuildTest::RunTest(const FString& Parameters)
+{
+	USplineComponent * Spline = MakeSpline(ESplineShape::SCurve, 12);
+
+	FVRSliderSplineLookup Lookup;
+	TestFalse(TEXT("Empty table is not valid"), Lookup.IsValidFor(Spline, 10.f));
+
+	Lookup.Build(Spline, 10.f);
+	TestTrue(TEXT("Built table is valid"), Lookup.IsValidFor(Spline, 10.f));
+	TestFalse(TEXT("Other spacing is not"), Lookup.IsValidFor(Spline, 5.f));
+	TestFalse(TEXT("Other spline is not"), Lookup.IsValidFor(MakeSpline(ESplineShape::SCurve, 12), 10.f));
+
+	Spline->SetLocationAtSplinePoint(3, FVector(100.f, 200.f, 50.f), ESplineCoordinateSpace::Local, true);
+	TestFalse(TEXT("Moved point invalidates"), Lookup.IsValidFor(Spline, 10.f));
+
+	Lookup.Build(Spline, 10.f);
+	Spline->AddSplinePoint(FVector(400.f, 0.f, 0.f), ESplineCoordinateSpace::Local, true);
+	TestFalse(TEXT("Added point invalidates"), Lookup.IsValidFor(Spline, 10.f));
+
+	Lookup.Build(Spline, 10.f);
+	Spline->SetClosedLoop(true, true);
+	TestFalse(TEXT("Closing the loop invalidates"), Lookup.IsValidFor(Spline, 10.f));
+
+	// A degenerate spline builds nothing but remembers it did, so it isn't rebuilt every frame
+	USplineComponent * Degenerate = NewObject<USplineComponent>(GetTransientPackage(), NAME_None, RF_Transient);
+	Degenerate->ClearSplinePoints(true);
+	Degenerate->AddSplinePoint(FVector::ZeroVector, ESplineCoordinateSpace::Local, true);
+	Lookup.Build(Degenerate, 10.f);
+	TestFalse(TEXT("Single point spline has no samples"), Lookup.HasSamples());
+	TestTrue(TEXT("Single point spline is not rebuilt"), Lookup.IsValidFor(Degenerate, 10.f));
+
+	// Through the slider, 0 spacing falls back to the engine search and the table is queried in the splines local space
+	FSplineTestWorld TestWorld;
+	USplineComponent * WorldSpline = MakeSpline(ESplineShape::Helix, 24, TestWorld.Owner);
+	WorldSpline->SetupAttachment(TestWorld.Owner->GetRootComponent());
+	WorldSpline->RegisterComponent();
+	WorldSpline->SetWorldTransform(FTransform(FRotator(0.f, 45.f, 20.f), FVector(1000.f, -500.f, 200.f), FVector(1.5f)));
+
+	UVRSliderComponent * Slider = NewObject<UVRSliderComponent>(TestWorld.Owner);
+	Slider->SetupAttachment(WorldSpline);
+	Slider->RegisterComponent();
+	Slider->SplineComponentToFollow = WorldSpline;
+
+	FRandomStream Random(3030);
+	int32 NumWorse = 0;
+	for (int32 Query = 0; Query < 200; ++Query)
+	{
+		const FVector WorldLocation = WorldSpline->GetComponentTransform().TransformPosition(MakeQuery(Random, WorldSpline, 5.f));
+
+		Slider->SplineLookupSampleSpacing = 10.f;
+		const float TableKey = Slider->FindSplineInputKeyClosestToWorldLocation(WorldLocation);
+		Slider->SplineLookupSampleSpacing = 0.f;
+		const float EngineKey = Slider->FindSplineInputKeyClosestToWorldLocation(WorldLocation);
+
+		const float TableDistance = FVector::Dist(WorldSpline->GetLocationAtSplineInputKey(TableKey, ESplineCoordinateSpace::World), WorldLocation);
+		const float EngineDistance = FVector::Dist(WorldSpline->GetLocationAtSplineInputKey(EngineKey, ESplineCoordinateSpace::World), WorldLocation);
+		NumWorse += TableDistance > EngineDistance + ClosestPointTolerance * 1.5f ? 1 : 0;
+	}
+
+	TestEqual(TEXT("Slider table search on a transformed spline"), NumWorse, 0);
+	TestFalse(TEXT("Zero spacing drops the table"), Slider->SplineLookup.HasSamples());
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRSliderSplineBenchmark, "VRExpansionPlugin.SliderSpline.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRSliderSplineBenchmark::RunTest(const FString& Parameters)
+{
+	const int32 PointCounts[] = { 4, 16, 64, 256 };
+	const int32 NumQueries = 20000;
+
+	for (int32 NumPoints : PointCounts)
+	{
+		USplineComponent * Spline = MakeSpline(ESplineShape::Helix, NumPoints);
+		FRandomStream Random(NumPoints);
+
+		// A hand dragging the slider along the spline, a little further each frame with some jitter off of it
+		TArray<FVector> Locations;
+		Locations.Reserve(NumQueries);
+		const float SplineLength = Spline->GetSplineLength();
+		for (int32 i = 0; i < NumQueries; ++i)
+		{
+			const float Distance = SplineLength * (0.5f + 0.5f * FMath::Sin((float)i * 0.002f));
+			const float Key = Spline->SplineCurves.ReparamTable.Eval(Distance, 0.0f);
+			Locations.Add(Spline->SplineCurves.Position.Eval(Key, FVector::ZeroVector) + Random.GetUnitVector() * Random.FRandRange(0.f, 3.f));
+		}
+
+		const double BuildStart = FPlatformTime::Seconds();
+		FVRSliderSplineLookup Lookup;
+		Lookup.Build(Spline, 10.f);
+		const double BuildSeconds = FPlatformTime::Seconds() - BuildStart;
+
+		float EngineSum = 0.f;
+		const double EngineStart = FPlatformTime::Seconds();
+		for (const FVector & Location : Locations)
+		{
+			EngineSum += FindEngineKey(Spline, Location);
+		}
+		const double EngineSeconds = FPlatformTime::Seconds() - EngineStart;
+
+		float LastKey = -1.f;
+		const double TableStart = FPlatformTime::Seconds();
+		for (const FVector & Location : Locations)
+		{
+			LastKey = Lookup.FindInputKeyClosestToLocalLocation(Location, LastKey);
+		}
+		const double TableSeconds = FPlatformTime::Seconds() - TableStart;
+
+		// Accuracy against the engine search over the same path
+		float WorstError = 0.f;
+		LastKey = -1.f;
+		for (const FVector & Location : Locations)
+		{
+			LastKey = Lookup.FindInputKeyClosestToLocalLocation(Location, LastKey);
+			WorstError = FMath::Max(WorstError, DistanceToKey(Spline, Location, LastKey) - DistanceToKey(Spline, Location, FindEngineKey(Spline, Location)));
+		}
+
+		AddInfo(FString::Printf(TEXT("%d point spline (%.0f cm): engine %.0f ns, table %.0f ns per closest key, build %.3f ms, worst extra distance %.4f cm"),
+			NumPoints, SplineLength, EngineSeconds * 1e9 / NumQueries, TableSeconds * 1e9 / NumQueries, BuildSeconds * 1000.0, WorstError));
+
+		TestTrue(TEXT("Engine search ran"), EngineSum > 0.f);
+		TestTrue(TEXT("Table is as close as the engine search"), WorstError <= ClosestPointTolerance);
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VRStereoWidgetComponent.h"
+#include "VRStereoWidgetTestTypes.generated.h"
+
+// Stereo widget that runs the redraw and upload half of its tick on demand, only created by the stereo widget tests
+UCLASS(Transient, NotBlueprintable, NotBlueprintType, HideDropdown)
+class UVRStereoWidgetFrameDriver : public UVRStereoWidgetComponent
+{
+	GENERATED_BODY()
+public:
+
+	UVRStereoWidgetFrameDriver(const FObjectInitializer& ObjectInitializer) :
+		Super(ObjectInitializer)
+	{}
+
+	// One frame of what TickComponent does around the widget draw, without needing Slate or a headset.
+	// The super draw bails without a window so only the bookkeeping runs, the counters see the same draws a real tick would.
+	void StepFrame(IStereoLayers & StereoLayers, float DeltaTime)
+	{
+		const bool bRequested = UpdateRedrawRequest();
+
+		// Hidden widgets are not drawn and have their layer torn down by the real tick
+		if (!IsVisible())
+			return;
+
+		// Without invalidation the widget draws on its RedrawTime cadence, every frame at the default of 0
+		if (bRedrawOnlyWhenInvalidated ? bRequested : true)
+			DrawWidgetToRenderTarget(DeltaTime);
+
+		IStereoLayers::FLayerDesc LayerDesc;
+		LayerDesc.QuadSize = FVector2D(DrawSize);
+		LayerDesc.Flags = !bRedrawOnlyWhenInvalidated ? IStereoLayers::LAYER_FLAG_TEX_CONTINUOUS_UPDATE : 0;
+		PushLayerDesc(&StereoLayers, LayerDesc);
+
+		UpdateLayerTexture(&StereoLayers);
+	}
+};
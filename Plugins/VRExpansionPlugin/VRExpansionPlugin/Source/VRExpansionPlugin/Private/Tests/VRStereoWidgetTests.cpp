@@ -0,0 +1,273 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+#include "HAL/PlatformTime.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/WorldSettings.h"
+#include "IStereoLayers.h"
+#include "Tests/VRStereoWidgetTestTypes.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace VRStereoWidgetTests
+{
+	const float WidgetFrameTime = 1.0f / 90.0f;
+
+	// Counts what the component asks of the runtime, ids start high so they never match a real layer
+	class FCountingStereoLayers : public IStereoLayers
+	{
+	public:
+		uint32 NextLayerId = 0x10000;
+		int32 NumCreates = 0;
+		int32 NumDescUpdates = 0;
+		int32 NumTextureMarks = 0;
+
+		virtual uint32 CreateLayer(const FLayerDesc& InLayerDesc) override
+		{
+			++NumCreates;
+			return NextLayerId++;
+		}
+
+		virtual void DestroyLayer(uint32 LayerId) override {}
+
+		virtual void SetLayerDesc(uint32 LayerId, const FLayerDesc& InLayerDesc) override
+		{
+			++NumDescUpdates;
+		}
+
+		virtual bool GetLayerDesc(uint32 LayerId, FLayerDesc& OutLayerDesc) override
+		{
+			return false;
+		}
+
+		virtual void MarkTextureForUpdate(uint32 LayerId) override
+		{
+			++NumTextureMarks;
+		}
+	};
+
+	struct FStereoWidgetTestWorld
+	{
+		UWorld * World;
+		AActor * Owner;
+
+		FStereoWidgetTestWorld()
+		{
+			World = UWorld::CreateWorld(EWorldType::Game, false);
+			FWorldContext & Context = GEngine->CreateNewWorldContext(EWorldType::Game);
+			Context.SetCurrentWorld(World);
+			World->InitializeActorsForPlay(FURL());
+			World->GetWorldSettings()->NotifyBeginPlay();
+
+			Owner = World->SpawnActor<AActor>();
+		}
+
+		~FStereoWidgetTestWorld()
+		{
+			GEngine->DestroyWorldContext(World);
+			World->DestroyWorld(false);
+		}
+
+		// Created with the actor as its outer so GetWorld works without registering it
+		UVRStereoWidgetFrameDriver * MakeWidget(bool bRedrawOnlyWhenInvalidated, float StaticRedrawInterval = 0.0f)
+		{
+			UVRStereoWidgetFrameDriver * Widget = NewObject<UVRStereoWidgetFrameDriver>(Owner, NAME_None, RF_Transient);
+			Widget->bRedrawOnlyWhenInvalidated = bRedrawOnlyWhenInvalidated;
+			Widget->StaticRedrawInterval = StaticRedrawInterval;
+			return Widget;
+		}
+
+		void Step(FCountingStereoLayers & StereoLayers, const TArray<UVRStereoWidgetFrameDriver *> & Widgets)
+		{
+			World->RealTimeSeconds += WidgetFrameTime;
+			World->TimeSeconds += WidgetFrameTime;
+
+			for (UVRStereoWidgetFrameDriver * Widget : Widgets)
+				Widget->StepFrame(StereoLayers, WidgetFrameTime);
+		}
+
+		void Step(FCountingStereoLayers & StereoLayers, UVRStereoWidgetFrameDriver * Widget, int32 NumFrames = 1)
+		{
+			for (int32 i = 0; i < NumFrames; ++i)
+				Step(StereoLayers, TArray<UVRStereoWidgetFrameDriver *>({ Widget }));
+		}
+	};
+}
+
+using namespace VRStereoWidgetTests;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRStereoWidgetInvalidationTest, "VRExpansionPlugin.StereoWidget.RedrawOnlyWhenInvalidated", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRStereoWidgetInvalidationTest::RunTest(const FString& Parameters)
+{
+	FStereoWidgetTestWorld TestWorld;
+	FCountingStereoLayers StereoLayers;
+	UVRStereoWidgetFrameDriver * Widget = TestWorld.MakeWidget(true);
+
+	// The first frame always draws, nothing has been drawn into the target yet
+	TestWorld.Step(StereoLayers, Widget);
+	TestEqual(TEXT("First frame draws"), Widget->GetRedrawCount(), 1);
+	TestEqual(TEXT("First draw is uploaded"), Widget->GetTextureUploadCount(), 1);
+	TestEqual(TEXT("Layer created once"), StereoLayers.NumCreates, 1);
+
+	// A static widget is left alone
+	TestWorld.Step(StereoLayers, Widget, 120);
+	TestEqual(TEXT("Static widget is not redrawn"), Widget->GetRedrawCount(), 1);
+	TestEqual(TEXT("Static widget is not re-uploaded"), Widget->GetTextureUploadCount(), 1);
+	TestEqual(TEXT("Unchanged layer description is not re-sent"), StereoLayers.NumDescUpdates, 0);
+
+	// One invalidation is one draw and one upload, however long until the next frame
+	Widget->InvalidateWidget();
+	Widget->InvalidateWidget();
+	TestWorld.Step(StereoLayers, Widget, 10);
+	TestEqual(TEXT("Invalidation redraws once"), Widget->GetRedrawCount(), 2);
+	TestEqual(TEXT("Invalidation uploads once"), Widget->GetTextureUploadCount(), 2);
+	TestEqual(TEXT("Uploads go through MarkTextureForUpdate"), StereoLayers.NumTextureMarks, 2);
+
+	// Draw size changes invalidate on their own
+	Widget->SetDrawSize(FVector2D(320.0f, 240.0f));
+	TestWorld.Step(StereoLayers, Widget, 10);
+	TestEqual(TEXT("Draw size change redraws once"), Widget->GetRedrawCount(), 3);
+	TestEqual(TEXT("Draw size change updates the description once"), StereoLayers.NumDescUpdates, 1);
+
+	// Turning it off goes back to drawing every frame with the runtime copying the texture
+	Widget->ResetRenderCounters();
+	Widget->bRedrawOnlyWhenInvalidated = false;
+	TestWorld.Step(StereoLayers, Widget, 30);
+	TestEqual(TEXT("Continuous widget redraws every frame"), Widget->GetRedrawCount(), 30);
+	TestEqual(TEXT("Continuous layer uploads every frame"), Widget->GetTextureUploadCount(), 30);
+	TestEqual(TEXT("Continuous layer is not marked by hand"), StereoLayers.NumTextureMarks, 3);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRStereoWidgetVisibilityTest, "VRExpansionPlugin.StereoWidget.BecomingVisibleInvalidates", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRStereoWidgetVisibilityTest::RunTest(const FString& Parameters)
+{
+	FStereoWidgetTestWorld TestWorld;
+	FCountingStereoLayers StereoLayers;
+
+	// Not pooled, the render target is kept while hidden so only the visibility tracking can catch this
+	UVRStereoWidgetFrameDriver * Widget = TestWorld.MakeWidget(true);
+	TestFalse(TEXT("Widget owns its render target"), Widget->bUseSharedRenderTargetPool);
+
+	TestWorld.Step(StereoLayers, Widget, 5);
+	TestEqual(TEXT("Drawn once while visible"), Widget->GetRedrawCount(), 1);
+
+	// Hidden frames never draw, even when invalidated
+	Widget->SetVisibility(false);
+	TestWorld.Step(StereoLayers, Widget, 5);
+	Widget->InvalidateWidget();
+	TestWorld.Step(StereoLayers, Widget, 5);
+	TestEqual(TEXT("Hidden widget is not drawn"), Widget->GetRedrawCount(), 1);
+
+	Widget->SetVisibility(true);
+	TestWorld.Step(StereoLayers, Widget, 5);
+	TestEqual(TEXT("Shown widget draws the pending invalidation once"), Widget->GetRedrawCount(), 2);
+
+	// Hidden and shown again with nothing invalidated while hidden still redraws
+	Widget->SetVisibility(false);
+	TestWorld.Step(StereoLayers, Widget, 5);
+	Widget->SetVisibility(true);
+	TestWorld.Step(StereoLayers, Widget, 5);
+	TestEqual(TEXT("Becoming visible redraws"), Widget->GetRedrawCount(), 3);
+	TestEqual(TEXT("Every redraw is uploaded"), Widget->GetTextureUploadCount(), 3);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRStereoWidgetStaticIntervalTest, "VRExpansionPlugin.StereoWidget.StaticRedrawInterval", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRStereoWidgetStaticIntervalTest::RunTest(const FString& Parameters)
+{
+	FStereoWidgetTestWorld TestWorld;
+	FCountingStereoLayers StereoLayers;
+
+	// Half a second at 90hz, 4 seconds is the first draw plus 8 interval draws
+	UVRStereoWidgetFrameDriver * Widget = TestWorld.MakeWidget(true, 0.5f);
+	TestWorld.Step(StereoLayers, Widget, 360);
+
+	TestTrue(FString::Printf(TEXT("Interval redraws (%d) are within one of 9"), Widget->GetRedrawCount()), FMath::Abs(Widget->GetRedrawCount() - 9) <= 1);
+	TestEqual(TEXT("Every interval redraw is uploaded"), Widget->GetTextureUploadCount(), Widget->GetRedrawCount());
+
+	// An invalidation resets the interval rather than adding to it
+	Widget->ResetRenderCounters();
+	Widget->InvalidateWidget();
+	TestWorld.Step(StereoLayers, Widget, 44);
+	TestEqual(TEXT("Invalidated draw, interval not yet elapsed"), Widget->GetRedrawCount(), 1);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRStereoWidgetBenchmark, "VRExpansionPlugin.StereoWidget.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVRStereoWidgetBenchmark::RunTest(const FString& Parameters)
+{
+	// A menu's worth of panels up to a whole cockpit, a few of them change each frame
+	const int32 WidgetCounts[] = { 1, 16, 128 };
+	const int32 NumFrames = 900;
+
+	for (int32 NumWidgets : WidgetCounts)
+	{
+		for (int32 Mode = 0; Mode < 2; ++Mode)
+		{
+			const bool bInvalidation = Mode == 1;
+			FStereoWidgetTestWorld TestWorld;
+			FCountingStereoLayers StereoLayers;
+			FRandomStream Random(NumWidgets);
+
+			TArray<UVRStereoWidgetFrameDriver *> Widgets;
+			for (int32 i = 0; i < NumWidgets; ++i)
+				Widgets.Add(TestWorld.MakeWidget(bInvalidation, 1.0f));
+
+			double StepSeconds = 0.0;
+			for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+			{
+				// About one change per widget per second
+				for (UVRStereoWidgetFrameDriver * Widget : Widgets)
+				{
+					if (Random.FRand() < 1.0f / 90.0f)
+						Widget->InvalidateWidget();
+				}
+
+				const double Start = FPlatformTime::Seconds();
+				TestWorld.Step(StereoLayers, Widgets);
+				StepSeconds += FPlatformTime::Seconds() - Start;
+			}
+
+			int32 NumRedraws = 0;
+			int32 NumUploads = 0;
+			for (UVRStereoWidgetFrameDriver * Widget : Widgets)
+			{
+				NumRedraws += Widget->GetRedrawCount();
+				NumUploads += Widget->GetTextureUploadCount();
+			}
+
+			AddInfo(FString::Printf(TEXT("%d widgets %s: %.2f redraws and %.2f uploads per frame, %.2f us of bookkeeping per frame"),
+				NumWidgets, bInvalidation ? TEXT("invalidation") : TEXT("continuous"), (float)NumRedraws / NumFrames, (float)NumUploads / NumFrames, (StepSeconds * 1000000.0) / NumFrames));
+
+			if (bInvalidation)
+			{
+				// Changes plus the one second interval, well under a tenth of the continuous path
+				TestTrue(FString::Printf(TEXT("%d invalidation widgets redraw rarely"), NumWidgets), NumRedraws < (NumWidgets * NumFrames) / 10);
+				TestEqual(FString::Printf(TEXT("%d invalidation widgets upload once per redraw"), NumWidgets), NumUploads, NumRedraws);
+			}
+			else
+			{
+				TestEqual(FString::Printf(TEXT("%d continuous widgets redraw every frame"), NumWidgets), NumRedraws, NumWidgets * NumFrames);
+			}
+
+			for (UVRStereoWidgetFrameDriver * Widget : Widgets)
+				Widget->MarkPendingKill();
+		}
+	}
+
+	return true;
+}
+
+#endif
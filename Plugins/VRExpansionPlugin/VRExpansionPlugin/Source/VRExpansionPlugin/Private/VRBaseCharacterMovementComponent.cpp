@@ -9,8 +9,43 @@
 #include "VRBPDatatypes.h"
 #include "VRBaseCharacter.h"
 #include "VRRootComponent.h"
+#include "Misc/VRClimbingHandholdComponent.h"
 #include "VRPlayerController.h"
 #include "GameFramework/PhysicsVolume.h"
+#include "Camera/PlayerCameraManager.h"
+#include "HAL/IConsoleManager.h"
+
+namespace VRSavedMoveCVars
+{
+	static int32 SavedMovePoolPrewarm = 32;
+	FAutoConsoleVariableRef CVarSavedMovePoolPrewarm(
+		TEXT("vr.SavedMovePoolPrewarm"),
+		SavedMovePoolPrewarm,
+		TEXT("Number of saved moves VR characters allocate into their free move pool before their first saved move, capped to MaxFreeMoveCount."),
+		ECVF_Default);
+}
+
+void PrewarmVRSavedMovePool(FNetworkPredictionData_Client_Character & ClientData)
+{
+	ClientData.SavedMoves.Reserve(ClientData.MaxSavedMoveCount);
+	ClientData.FreeMoves.Reserve(ClientData.MaxFreeMoveCount);
+
+	const int32 NumToAllocate = FMath::Clamp(VRSavedMoveCVars::SavedMovePoolPrewarm, 0, ClientData.MaxFreeMoveCount) - ClientData.FreeMoves.Num();
+	for (int32 i = 0; i < NumToAllocate; ++i)
+	{
+		ClientData.FreeMoves.Push(ClientData.AllocateNewMove());
+	}
+}
+
+void UVRBaseCharacterMovementComponent::PrewarmSavedMovePoolOnce(FNetworkPredictionData_Client_Character & ClientData)
+{
+	// Prediction data is deleted and re-created on resets, a new object gets its own pool
+	if (PrewarmedClientData == &ClientData)
+		return;
+
+	PrewarmedClientData = &ClientData;
+	PrewarmVRSavedMovePool(ClientData);
+}
 
 UVRBaseCharacterMovementComponent::UVRBaseCharacterMovementComponent(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
@@ -28,6 +63,8 @@ UVRBaseCharacterMovementComponent::UVRBaseCharacterMovementComponent(const FObje
 	*/
 
 
+	PrewarmedClientData = nullptr;
+
 	AdditionalVRInputVector = FVector::ZeroVector;	
 	CustomVRInputVector = FVector::ZeroVector;
 	bApplyAdditionalVRInputVectorAsNegative = true;
@@ -38,6 +75,8 @@ UVRBaseCharacterMovementComponent::UVRBaseCharacterMovementComponent(const FObje
 	VRClimbingStepUpMaxSize = 20.0f;
 
 	VRClimbingMaxReleaseVelocitySize = 800.0f;
+	VRClimbingMaxGripDistance = 100.0f;
+	bAppliedNativeClimbingDelta = false;
 	SetDefaultPostClimbMovementOnStepUp = true;
 	DefaultPostClimbMovement = EVRConjoinedMovementModes::C_MOVE_Falling;
 
@@ -56,6 +95,8 @@ UVRBaseCharacterMovementComponent::UVRBaseCharacterMovementComponent(const FObje
 	bWasInPushBack = false;
 	bIsInPushBack = false;
 
+	AdaptiveMaxCorrectionSpeed = 0.0f;
+
 	bRunControlRotationInMovementComponent = true;
 
 	// Allow merging dual movements, generally this is wanted for the perf increase
@@ -720,6 +761,175 @@ bool UVRBaseCharacterMovementComponent::VRClimbStepUp(const FVector& GravDir, co
 	return StepUp(GravDir, Delta, InHit, OutStepDownResult);
 }
 
+bool UVRBaseCharacterMovementComponent::SolveClimbingLedge(const FVector& Adjusted, const FHitResult& Hit, FStepDownResult& OutStepDownResult, float& OutStepUpHeight, bool& bOutHandledExternally)
+{
+	OutStepUpHeight = 0.0f;
+	bOutHandledExternally = false;
+
+	const FVector GravDir = FVector(0.f, 0.f, -1.f);
+	const FVector VelDir = Adjusted.GetSafeNormal();
+	const float UpDown = GravDir | VelDir;
+
+	if ((FMath::Abs(Hit.ImpactNormal.Z) >= 0.2f) || (UpDown >= 0.5f) || (UpDown <= -0.2f) || !CanStepUp(Hit))
+		return false;
+
+	// Scope our movement updates, and do not apply them until all intermediate moves are completed.
+	FVRCharacterScopedMovementUpdate ScopedStepUpMovement(UpdatedComponent, EScopedUpdate::DeferredUpdates);
+
+	const float StartZ = UpdatedComponent->GetComponentLocation().Z;
+
+	// Making it easier to step up here with the multiplier, helps avoid falling back off
+	const FVector StepAdjusted = bClampClimbingStepUp ? Adjusted.GetClampedToMaxSize2D(VRClimbingStepUpMaxSize) : Adjusted;
+	if (!VRClimbStepUp(GravDir, ((StepAdjusted * VRClimbingStepUpMultiplier) + AdditionalVRInputVector) * (1.f - Hit.Time), Hit, &OutStepDownResult))
+		return false;
+
+	if (OnPerformClimbingStepUp.IsBound())
+	{
+		FVector finalLoc = UpdatedComponent->GetComponentLocation();
+
+		// Rewind the step up, the end user wants to handle it instead
+		ScopedStepUpMovement.RevertMove();
+		bOutHandledExternally = true;
+
+		OnPerformClimbingStepUp.Broadcast(finalLoc);
+		return true;
+	}
+
+	OutStepUpHeight = UpdatedComponent->GetComponentLocation().Z - StartZ;
+	return true;
+}
+
+bool UVRBaseCharacterMovementComponent::StartClimbingGrip(USceneComponent* Hand, USceneComponent* Handhold, FVector WorldGripLocation)
+{
+	if (!Hand || !Handhold || !CharacterOwner || !CharacterOwner->IsLocallyControlled())
+		return false;
+
+	// The server has to be able to resolve the handhold from the move, otherwise every move would be corrected
+	if (GetNetMode() == NM_Client && !Handhold->IsSupportedForNetworking())
+		return false;
+
+	FVector LocalAnchor;
+	if (UVRClimbingHandholdComponent * ClimbingHandhold = Cast<UVRClimbingHandholdComponent>(Handhold))
+	{
+		if (!ClimbingHandhold->bCanBeClimbed)
+			return false;
+
+		LocalAnchor = ClimbingHandhold->GetLocalAnchor(WorldGripLocation);
+	}
+	else
+		LocalAnchor = Handhold->GetComponentTransform().InverseTransformPosition(WorldGripLocation);
+
+	// Re-gripping with the same hand moves its anchor
+	int32 Slot = INDEX_NONE;
+	for (int32 i = 0; i < VR_CLIMBING_GRIP_COUNT; ++i)
+	{
+		if (ClimbingGripHands[i].Get() == Hand)
+		{
+			Slot = i;
+			break;
+		}
+		else if (Slot == INDEX_NONE && !LocalClimbingGrips.Grips[i].IsActive())
+			Slot = i;
+	}
+
+	if (Slot == INDEX_NONE)
+		return false;
+
+	FVRClimbingGripRep & Grip = LocalClimbingGrips.Grips[Slot];
+	Grip.Handhold = Handhold;
+	Grip.LocalAnchor = RoundDirectMovement(LocalAnchor);
+	ClimbingGripHands[Slot] = Hand;
+	return true;
+}
+
+void UVRBaseCharacterMovementComponent::EndClimbingGrip(USceneComponent* Hand)
+{
+	for (int32 i = 0; i < VR_CLIMBING_GRIP_COUNT; ++i)
+	{
+		if (ClimbingGripHands[i].Get() == Hand)
+		{
+			LocalClimbingGrips.Grips[i].Clear();
+			ClimbingGripHands[i].Reset();
+		}
+	}
+}
+
+void UVRBaseCharacterMovementComponent::EndAllClimbingGrips()
+{
+	LocalClimbingGrips.Clear();
+
+	for (TWeakObjectPtr<USceneComponent> & GripHand : ClimbingGripHands)
+		GripHand.Reset();
+}
+
+bool UVRBaseCharacterMovementComponent::HasClimbingGrips() const
+{
+	if (CharacterOwner && CharacterOwner->IsLocallyControlled())
+		return LocalClimbingGrips.HasAnyGrips();
+
+	return ClimbingGrips.HasAnyGrips();
+}
+
+void UVRBaseCharacterMovementComponent::UpdateClimbingGripOffsets()
+{
+	if (!UpdatedComponent)
+		return;
+
+	const FVector CurrentLocation = UpdatedComponent->GetComponentLocation();
+
+	for (int32 i = 0; i < VR_CLIMBING_GRIP_COUNT; ++i)
+	{
+		FVRClimbingGripRep & Grip = LocalClimbingGrips.Grips[i];
+		if (!Grip.IsActive())
+			continue;
+
+		USceneComponent * Hand = ClimbingGripHands[i].Get();
+		if (!Hand)
+		{
+			Grip.Clear();
+			ClimbingGripHands[i].Reset();
+			continue;
+		}
+
+		// Rounded to what the server will receive so both sides solve the same delta
+		Grip.HandOffset = RoundDirectMovement(Hand->GetComponentLocation() - CurrentLocation);
+	}
+
+	ClimbingGrips = LocalClimbingGrips;
+}
+
+bool UVRBaseCharacterMovementComponent::GetNativeClimbingDelta(FVector & OutDelta) const
+{
+	if (!UpdatedComponent)
+		return false;
+
+	const FVector CurrentLocation = UpdatedComponent->GetComponentLocation();
+	const float MaxGripDistSq = FMath::Square(VRClimbingMaxGripDistance);
+
+	FVector TotalDelta = FVector::ZeroVector;
+	int32 NumGrips = 0;
+
+	for (const FVRClimbingGripRep & Grip : ClimbingGrips.Grips)
+	{
+		USceneComponent * Handhold = Grip.Handhold.Get();
+		if (!Handhold || Handhold->IsPendingKill())
+			continue;
+
+		const FVector GripDelta = Handhold->GetComponentTransform().TransformPosition(Grip.LocalAnchor) - (CurrentLocation + Grip.HandOffset);
+		if (GripDelta.SizeSquared() > MaxGripDistSq)
+			continue;
+
+		TotalDelta += GripDelta;
+		++NumGrips;
+	}
+
+	if (!NumGrips)
+		return false;
+
+	OutDelta = TotalDelta / NumGrips;
+	return true;
+}
+
 void UVRBaseCharacterMovementComponent::PhysCustom_Climbing(float deltaTime, int32 Iterations)
 {
 	if (deltaTime < MIN_TICK_TIME)
@@ -727,8 +937,19 @@ void UVRBaseCharacterMovementComponent::PhysCustom_Climbing(float deltaTime, int
 		return;
 	}
 
+	// Replays and the server use the offsets stored in the move
+	if (CharacterOwner->IsLocallyControlled() && !CharacterOwner->bClientUpdating)
+		UpdateClimbingGripOffsets();
+
+	FVector NativeClimbingDelta;
+	bAppliedNativeClimbingDelta = ClimbingGrips.HasAnyGrips() && GetNativeClimbingDelta(NativeClimbingDelta);
+
+	if (bAppliedNativeClimbingDelta)
+	{
+		CustomVRInputVector = NativeClimbingDelta;
+	}
 	// Skip calling into BP if we aren't locally controlled
-	if (CharacterOwner->IsLocallyControlled())
+	else if (CharacterOwner->IsLocallyControlled())
 	{
 		// Allow the player to run updates on the climb logic for CustomVRInputVector
 		if (AVRBaseCharacter * characterOwner = Cast<AVRBaseCharacter>(CharacterOwner))
@@ -753,60 +974,31 @@ void UVRBaseCharacterMovementComponent::PhysCustom_Climbing(float deltaTime, int
 	bool bZeroDelta = Delta.IsNearlyZero();
 
 	FStepDownResult StepDownResult;
-
-	// Instead of remaking the step up function, temp assign a custom step height and then fall back to the old one afterward
-	// This isn't the "proper" way to do it, but it saves on re-making stepup() for both vr characters seperatly (due to different hmd injection)
-	float OldMaxStepHeight = MaxStepHeight;
-	MaxStepHeight = VRClimbingStepHeight;
 	bool bSteppedUp = false;
 
 	if (!bZeroDelta)
 	{
+		// Instead of remaking the step up function, temp assign a custom step height and then fall back to the old one afterward
+		// This isn't the "proper" way to do it, but it saves on re-making stepup() for both vr characters seperatly (due to different hmd injection)
+		TGuardValue<float> StepHeightGuard(MaxStepHeight, VRClimbingStepHeight);
+
 		FHitResult Hit(1.f);
 		SafeMoveUpdatedComponent(Delta, UpdatedComponent->GetComponentQuat(), true, Hit);
 
 		if (Hit.Time < 1.f)
 		{
-			const FVector GravDir = FVector(0.f, 0.f, -1.f);
-			const FVector VelDir = (CustomVRInputVector).GetSafeNormal();//Velocity.GetSafeNormal();
-			const float UpDown = GravDir | VelDir;
+			float StepUpHeight = 0.0f;
+			bool bHandledExternally = false;
+			bSteppedUp = SolveClimbingLedge(Adjusted, Hit, StepDownResult, StepUpHeight, bHandledExternally);
 
-			//bool bSteppedUp = false;
-			if ((FMath::Abs(Hit.ImpactNormal.Z) < 0.2f) && (UpDown < 0.5f) && (UpDown > -0.2f) && CanStepUp(Hit))
-			{
-				// Scope our movement updates, and do not apply them until all intermediate moves are completed.
-				FVRCharacterScopedMovementUpdate ScopedStepUpMovement(UpdatedComponent, EScopedUpdate::DeferredUpdates);
+			if (bHandledExternally)
+				return;
 
-				float stepZ = UpdatedComponent->GetComponentLocation().Z;
-				
-				// Making it easier to step up here with the multiplier, helps avoid falling back off
-					if(bClampClimbingStepUp)
-						bSteppedUp = VRClimbStepUp(GravDir, ((Adjusted.GetClampedToMaxSize2D(VRClimbingStepUpMaxSize) * VRClimbingStepUpMultiplier) + AdditionalVRInputVector) * (1.f - Hit.Time), Hit, &StepDownResult);
-					else
-						bSteppedUp = VRClimbStepUp(GravDir, ((Adjusted * VRClimbingStepUpMultiplier) + AdditionalVRInputVector) * (1.f - Hit.Time), Hit, &StepDownResult);
-
-				if (bSteppedUp && OnPerformClimbingStepUp.IsBound())
-				{
-					FVector finalLoc = UpdatedComponent->GetComponentLocation();
-
-					// Rewind the step up, the end user wants to handle it instead
-					ScopedStepUpMovement.RevertMove();
-
-					// Revert to old max step height
-					MaxStepHeight = OldMaxStepHeight;
-					
-					OnPerformClimbingStepUp.Broadcast(finalLoc);
-					return;
-				}
-
-				if (bSteppedUp)
-				{
-					OldLocation.Z = UpdatedComponent->GetComponentLocation().Z + (OldLocation.Z - stepZ);
-				}
-			
+			if (bSteppedUp)
+			{
+				OldLocation.Z += StepUpHeight;
 			}
-
-			if (!bSteppedUp)
+			else
 			{
 				//adjust and try again
 				HandleImpact(Hit, deltaTime, Adjusted);
@@ -815,9 +1007,6 @@ void UVRBaseCharacterMovementComponent::PhysCustom_Climbing(float deltaTime, int
 		}
 	}
 
-	// Revert to old max step height
-	MaxStepHeight = OldMaxStepHeight;
-
 	if (bSteppedUp)
 	{
 		if (AVRBaseCharacter * ownerCharacter = Cast<AVRBaseCharacter>(CharacterOwner))
@@ -1138,6 +1327,7 @@ void UVRBaseCharacterMovementComponent::PerformMovement(float DeltaSeconds)
 
 	// Clear out this flag prior to movement so we can see if it gets changed
 	bIsInPushBack = false;
+	bAppliedNativeClimbingDelta = false;
 
 	Super::PerformMovement(DeltaSeconds);
 
@@ -1189,6 +1379,7 @@ void FSavedMove_VRBaseCharacter::SetInitialPosition(ACharacter* C)
 			VRReplicatedMovementMode = EVRConjoinedMovementModes::C_MOVE_MAX;//None;
 			ConditionalValues.CustomVRInputVector = FVector::ZeroVector;
 			ConditionalValues.RequestedVelocity = FVector::ZeroVector;
+			ConditionalValues.ClimbingGrips.Clear();
 		}
 	//}
 	//else
@@ -1241,9 +1432,20 @@ void FSavedMove_VRBaseCharacter::PostUpdate(ACharacter* C, EPostUpdateMode PostU
 	//{
 	if (UVRBaseCharacterMovementComponent * moveComp = Cast<UVRBaseCharacterMovementComponent>(C->GetMovementComponent()))
 	{
-		ConditionalValues.CustomVRInputVector = moveComp->CustomVRInputVector;
 		ConditionalValues.MoveActionArray = moveComp->MoveActionArray;
 		moveComp->MoveActionArray.Clear();
+
+		// Still sent with native climbing, the server solves the delta from the grips but falls back to this if it can't resolve a handhold
+		ConditionalValues.CustomVRInputVector = moveComp->CustomVRInputVector;
+
+		// Replays keep the grips they were recorded with, grips that didn't drive the move aren't sent at all
+		if (PostUpdateMode == PostUpdate_Record)
+		{
+			if (moveComp->bAppliedNativeClimbingDelta)
+				ConditionalValues.ClimbingGrips = moveComp->ClimbingGrips;
+			else
+				ConditionalValues.ClimbingGrips.Clear();
+		}
 	}
 	//}
 	/*if (ConditionalValues.MoveAction.MoveAction != EVRMoveAction::VRMOVEACTION_None)
@@ -1281,6 +1483,7 @@ void FSavedMove_VRBaseCharacter::Clear()
 	ConditionalValues.CustomVRInputVector = FVector::ZeroVector;
 	ConditionalValues.RequestedVelocity = FVector::ZeroVector;
 	ConditionalValues.MoveActionArray.Clear();
+	ConditionalValues.ClimbingGrips.Clear();
 	//ConditionalValues.MoveAction.Clear();
 
 	FSavedMove_Character::Clear();
@@ -1295,6 +1498,7 @@ void FSavedMove_VRBaseCharacter::PrepMoveFor(ACharacter* Character)
 		BaseCharMove->MoveActionArray = ConditionalValues.MoveActionArray;
 		//BaseCharMove->MoveAction = ConditionalValues.MoveAction; 
 		BaseCharMove->CustomVRInputVector = ConditionalValues.CustomVRInputVector;//this->CustomVRInputVector;
+		BaseCharMove->ClimbingGrips = ConditionalValues.ClimbingGrips;
 		BaseCharMove->VRReplicatedMovementMode = this->VRReplicatedMovementMode;
 	}
 	
@@ -1315,6 +1519,24 @@ void UVRBaseCharacterMovementComponent::OnClientCorrectionReceived(class FNetwor
 {
 	Super::OnClientCorrectionReceived(ClientData, TimeStamp, NewLocation, NewVelocity, NewBase, NewBaseBoneName, bHasBase, bBaseRelativePosition, ServerMovementMode);
 
+	// Called prior to the server location being applied, so we can still see how far we are about to be moved
+	if (ComfortCorrectionSettings.bUseComfortCorrections && UpdatedComponent && CharacterOwner && CharacterOwner->IsLocallyControlled())
+	{
+		const float CorrectionDistance = FVector::Dist(UpdatedComponent->GetComponentLocation(), NewLocation);
+		if (CorrectionDistance >= ComfortCorrectionSettings.MinCorrectionDistance)
+		{
+			if (ComfortCorrectionSettings.bFadeCamera)
+			{
+				APlayerController * OwningController = Cast<APlayerController>(CharacterOwner->GetController());
+				if (OwningController && OwningController->PlayerCameraManager)
+				{
+					OwningController->PlayerCameraManager->StartCameraFade(1.0f, 0.0f, ComfortCorrectionSettings.FadeDuration, ComfortCorrectionSettings.FadeColor, false, false);
+				}
+			}
+
+			OnComfortCorrection.Broadcast(CorrectionDistance);
+		}
+	}
 
 	// If we got corrected then lets teleport our grips, this means that we were out of sync with the server or the server moved us
 	AVRBaseCharacter* Basechar = Cast<AVRBaseCharacter>(CharacterOwner);
@@ -1392,6 +1614,23 @@ void UVRBaseCharacterMovementComponent::SmoothCorrection(const FVector& OldLocat
 			ClientData->MeshTranslationOffset = ClientData->MeshTranslationOffset + NewToOldVector;
 		}
 
+		if (AdaptiveSmoothingSettings.bUseAdaptiveSmoothing)
+		{
+			const float CurrentTime = MyWorld->GetTimeSeconds();
+			const float HistoryWeight = ProxyCorrectionHistory.GetWeight(CurrentTime, AdaptiveSmoothingSettings.HistoryDecayTime);
+
+			float SmoothTime = 0.0f;
+			AdaptiveSmoothingSettings.Evaluate(FMath::Sqrt(DistSq), HistoryWeight, SmoothTime, AdaptiveMaxCorrectionSpeed);
+			ProxyCorrectionHistory.AddCorrection(CurrentTime, AdaptiveSmoothingSettings.HistoryDecayTime);
+
+			// Exponential smoothing reads this directly, linear is limited by the correction speed instead
+			ClientData->SmoothNetUpdateTime = FMath::Max(SmoothTime, KINDA_SMALL_NUMBER);
+		}
+		else
+		{
+			AdaptiveMaxCorrectionSpeed = 0.0f;
+		}
+
 		//UE_LOG(LogCharacterNetSmoothing, Verbose, TEXT("Proxy %s SmoothCorrection(%.2f)"), *GetNameSafe(CharacterOwner), FMath::Sqrt(DistSq));
 		if (NetworkSmoothingMode == ENetworkSmoothingMode::Linear)
 		{
@@ -1511,8 +1750,26 @@ void UVRBaseCharacterMovementComponent::SmoothClientPosition(float DeltaSeconds)
 		return;
 	}
 
+	FNetworkPredictionData_Client_Character* ClientData = GetPredictionData_Client_Character();
+	const FVector PreviousTranslationOffset = ClientData ? ClientData->MeshTranslationOffset : FVector::ZeroVector;
+
 	SmoothClientPosition_Interpolate(DeltaSeconds);
 
+	// Replay stores an absolute location in the offset, it can't be speed limited
+	if (ClientData && AdaptiveMaxCorrectionSpeed > 0.0f && NetworkSmoothingMode != ENetworkSmoothingMode::Replay)
+	{
+		const FVector OffsetStep = ClientData->MeshTranslationOffset - PreviousTranslationOffset;
+		const float MaxStep = AdaptiveMaxCorrectionSpeed * DeltaSeconds;
+
+		if (OffsetStep.SizeSquared() > FMath::Square(MaxStep))
+		{
+			ClientData->MeshTranslationOffset = PreviousTranslationOffset + OffsetStep.GetClampedToMaxSize(MaxStep);
+
+			// Keep smoothing until the offset is actually closed out
+			bNetworkSmoothingComplete = false;
+		}
+	}
+
 	//SmoothClientPosition_UpdateVisuals(); No mesh, don't bother to run this
 	SmoothClientPosition_UpdateVRVisuals();
 }
@@ -385,7 +385,8 @@ void FSavedMove_VRCharacter::SetInitialPosition(ACharacter* C)
 		if (VRC->VRRootReference)
 		{
 			VRCapsuleLocation = VRC->VRRootReference->curCameraLoc;
-			VRCapsuleRotation = UVRExpansionFunctionLibrary::GetHMDPureYaw_I(VRC->VRRootReference->curCameraRot);
+			// Combined moves run this twice in a frame, the root has usually already done the yaw extraction for us
+			VRCapsuleRotation = VRC->VRRootReference->GetCurrentCameraPureYaw();
 			LFDiff = VRC->VRRootReference->DifferenceFromLastFrame;
 		}
 		else
@@ -605,6 +606,7 @@ void UVRCharacterMovementComponent::ServerMoveVROld_Implementation
 
 	CustomVRInputVector = ConditionalReps.CustomVRInputVector;
 	MoveActionArray = ConditionalReps.MoveActionArray;
+	ClimbingGrips = ConditionalReps.ClimbingGrips;
 
 	// Set capsule location prior to testing movement
 	// I am overriding the replicated value here when movement is made on purpose
@@ -732,6 +734,7 @@ void UVRCharacterMovementComponent::ServerMoveVR_Implementation(
 
 		CustomVRInputVector = ConditionalReps.CustomVRInputVector;
 		MoveActionArray = ConditionalReps.MoveActionArray;
+		ClimbingGrips = ConditionalReps.ClimbingGrips;
 
 		// Set capsule location prior to testing movement
 		// I am overriding the replicated value here when movement is made on purpose
@@ -1367,6 +1370,8 @@ void UVRCharacterMovementComponent::ReplicateMoveToServer(float DeltaTime, const
 		return;
 	}
 
+	PrewarmSavedMovePoolOnce(*ClientData);
+
 	// Update our delta time for physics simulation.
 	DeltaTime = ClientData->UpdateTimeStampAndDeltaTime(DeltaTime, *CharacterOwner, *this);
 
@@ -1561,6 +1566,7 @@ UVRCharacterMovementComponent::UVRCharacterMovementComponent(const FObjectInitia
 	bUseClientControlRotation = false;
 	bAllowMovementMerging = false;
 	bRequestedMoveUseAcceleration = false;
+	ServerLastClientErrorDistance = 0.0f;
 }
 
 
@@ -3964,6 +3970,9 @@ void UVRCharacterMovementComponent::SendClientAdjustment()
 	const float CurrentTime = GetWorld()->GetTimeSeconds();
 	if (ServerData->PendingAdjustment.bAckGoodMove)
 	{
+		// The client converged on its own, anything that was being held back no longer needs to go out
+		CorrectionThrottle.Reset();
+
 		// just notify client this move was received
 		if (CurrentTime - ServerLastClientGoodMoveAckTime > NetworkMinTimeBetweenClientAckGoodMoves)
 		{
@@ -3971,6 +3980,10 @@ void UVRCharacterMovementComponent::SendClientAdjustment()
 			ClientAckGoodMove(ServerData->PendingAdjustment.TimeStamp);
 		}
 	}
+	else if (!CorrectionThrottle.ShouldSendCorrection(CorrectionThrottleSettings, ServerLastClientErrorDistance, ServerData->bForceClientUpdate, CurrentTime))
+	{
+		// Small error held back, the next failed check after the window closes sends the servers state at that point
+	}
 	else
 	{
 		// We won't be back in here until the next client move and potential correction is received, so use the correct time now.
@@ -4233,6 +4246,9 @@ void UVRCharacterMovementComponent::ClientAdjustPositionVR_Implementation
 
 bool UVRCharacterMovementComponent::ServerCheckClientErrorVR(float ClientTimeStamp, float DeltaTime, const FVector& Accel, const FVector& ClientWorldLocation, float ClientYaw, const FVector& RelativeClientLocation, UPrimitiveComponent* ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode)
 {
+	// Anything other than a positional error is never coalesced
+	ServerLastClientErrorDistance = BIG_NUMBER;
+
 	// Check location difference against global setting
 	if (!bIgnoreClientMovementErrorChecksAndCorrection)
 	{
@@ -4251,6 +4267,7 @@ bool UVRCharacterMovementComponent::ServerCheckClientErrorVR(float ClientTimeSta
 		if (GameNetworkManager->ExceedsAllowablePositionError(LocDiff))
 		{
 			bNetworkLargeClientCorrection = (LocDiff.SizeSquared() > FMath::Square(NetworkLargeClientCorrectionDistance));
+			ServerLastClientErrorDistance = LocDiff.Size();
 			return true;
 
 		}
@@ -4340,6 +4357,14 @@ void UVRCharacterMovementComponent::ServerMoveHandleClientErrorVR(float ClientTi
 
 	if (ServerData->bForceClientUpdate || ServerCheckClientErrorVR(ClientTimeStamp, DeltaTime, Accel, ClientLoc, ClientYaw, RelativeClientLoc, ClientMovementBase, ClientBaseBoneName, ClientMovementMode))
 	{
+		if (ServerData->bForceClientUpdate)
+		{
+			// The error check was skipped so the last error distance is stale, and the force flag is cleared below before
+			// SendClientAdjustment runs, latch it so the throttle never holds a forced update back
+			ServerLastClientErrorDistance = BIG_NUMBER;
+			CorrectionThrottle.MarkForcedCorrection();
+		}
+
 		UPrimitiveComponent* MovementBase = CharacterOwner->GetMovementBase();
 		ServerData->PendingAdjustment.NewVel = Velocity;
 		ServerData->PendingAdjustment.NewBase = MovementBase;
@@ -4,6 +4,8 @@
 #include "Engine/Engine.h"
 #include "IXRTrackingSystem.h"
 #include "IHeadMountedDisplay.h"
+#include "Misc/VRGripSlotIndex.h"
+#include "Misc/VRMinimumAreaRectangle.h"
 
 #if WITH_EDITOR
 #include "Editor/UnrealEd/Classes/Editor/EditorEngine.h"
@@ -45,40 +47,9 @@ void UVRExpansionFunctionLibrary::GetGripSlotInRangeByTypeName(FName SlotType, A
 	if (!Actor)
 		return;
 
-	MaxRange = FMath::Square(MaxRange);
-
 	if (USceneComponent *rootComp = Actor->GetRootComponent())
 	{
-		FVector RelativeWorldLocation = rootComp->GetComponentTransform().InverseTransformPosition(WorldLocation);
-		float ClosestSlotDistance = -0.1f;
-
-		TArray<FName> SocketNames = rootComp->GetAllSocketNames();
-
-		FString GripIdentifier = SlotType.ToString();
-
-		int foundIndex = 0;
-
-		for (int i = 0; i < SocketNames.Num(); ++i)
-		{
-			if (SocketNames[i].ToString().Contains(GripIdentifier, ESearchCase::IgnoreCase, ESearchDir::FromStart))
-			{
-			
-				float vecLen = FVector::DistSquared(RelativeWorldLocation, rootComp->GetSocketTransform(SocketNames[i], ERelativeTransformSpace::RTS_Component).GetLocation());
-
-				if (MaxRange >= vecLen && (ClosestSlotDistance < 0.0f || vecLen < ClosestSlotDistance))
-				{
-					ClosestSlotDistance = vecLen;
-					bHadSlotInRange = true;
-					foundIndex = i;
-				}
-			}
-		}
-
-		if (bHadSlotInRange)
-		{
-			SlotWorldTransform = rootComp->GetSocketTransform(SocketNames[foundIndex]);
-			SlotWorldTransform.SetScale3D(FVector(1.0f));
-		}
+		bHadSlotInRange = FVRGripSlotIndexCache::GetClosestSlotInRange(SlotType, rootComp, WorldLocation, MaxRange, SlotWorldTransform);
 	}
 }
 
@@ -90,37 +61,18 @@ void UVRExpansionFunctionLibrary::GetGripSlotInRangeByTypeName_Component(FName S
 	if (!Component)
 		return;
 
-	FVector RelativeWorldLocation = Component->GetComponentTransform().InverseTransformPosition(WorldLocation);
-	MaxRange = FMath::Square(MaxRange);
-
-	float ClosestSlotDistance = -0.1f;
-
-	TArray<FName> SocketNames = Component->GetAllSocketNames();
-
-	FString GripIdentifier = SlotType.ToString();
-
-	int foundIndex = 0;
-
-	for (int i = 0; i < SocketNames.Num(); ++i)
-	{
-		if (SocketNames[i].ToString().Contains(GripIdentifier, ESearchCase::IgnoreCase, ESearchDir::FromStart))
-		{
-			float vecLen = FVector::DistSquared(RelativeWorldLocation, Component->GetSocketTransform(SocketNames[i], ERelativeTransformSpace::RTS_Component).GetLocation());
+	bHadSlotInRange = FVRGripSlotIndexCache::GetClosestSlotInRange(SlotType, Component, WorldLocation, MaxRange, SlotWorldTransform);
+}
 
-			if (MaxRange >= vecLen && (ClosestSlotDistance < 0.0f || vecLen < ClosestSlotDistance))
-			{
-				ClosestSlotDistance = vecLen;
-				bHadSlotInRange = true;
-				foundIndex = i;
-			}
-		}
-	}
+bool UVRExpansionFunctionLibrary::GetPhysicsReplicationErrorStats(UPrimitiveComponent * Component, FVRPhysicsReplicationErrorStats & ErrorStats)
+{
+	ErrorStats = FVRPhysicsReplicationErrorStats();
 
-	if (bHadSlotInRange)
-	{
-		SlotWorldTransform = Component->GetSocketTransform(SocketNames[foundIndex]);
-		SlotWorldTransform.SetScale3D(FVector(1.0f));
-	}
+#if WITH_PHYSX
+	return FPhysicsReplicationVR::GetErrorStats(Component, ErrorStats);
+#else
+	return false;
+#endif
 }
 
 FRotator UVRExpansionFunctionLibrary::GetHMDPureYaw(FRotator HMDRotation)
@@ -245,91 +197,28 @@ bool UVRExpansionFunctionLibrary::IsInVREditorPreview()
 
 void UVRExpansionFunctionLibrary::NonAuthorityMinimumAreaRectangle(class UObject* WorldContextObject, const TArray<FVector>& InVerts, const FVector& SampleSurfaceNormal, FVector& OutRectCenter, FRotator& OutRectRotation, float& OutSideLengthX, float& OutSideLengthY, bool bDebugDraw)
 {
-	float MinArea = -1.f;
-	float CurrentArea = -1.f;
-	FVector SupportVectorA, SupportVectorB;
-	FVector RectSideA, RectSideB;
-	float MinDotResultA, MinDotResultB, MaxDotResultA, MaxDotResultB;
-	FVector TestEdge;
-	float TestEdgeDot = 0.f;
-	FVector PolyNormal(0.f, 0.f, 1.f);
-	TArray<int32> PolyVertIndices;
-
 	// Bail if we receive an empty InVerts array
 	if (InVerts.Num() == 0)
 	{
 		return;
 	}
 
-	// Compute the approximate normal of the poly, using the direction of SampleSurfaceNormal for guidance
-	PolyNormal = (InVerts[InVerts.Num() / 3] - InVerts[0]) ^ (InVerts[InVerts.Num() * 2 / 3] - InVerts[InVerts.Num() / 3]);
-	if ((PolyNormal | SampleSurfaceNormal) < 0.f)
-	{
-		PolyNormal = -PolyNormal;
-	}
+	FMatrix SurfaceNormalMatrix = MinimumAreaRectangle::ComputeBasis(InVerts, SampleSurfaceNormal);
+	FMinAreaRectScratch Scratch;
+	FVRMinimumAreaRectangle Rect;
+	MinimumAreaRectangle::Fit(InVerts, SurfaceNormalMatrix, Rect, Scratch);
 
-	// Transform the sample points to 2D
-	FMatrix SurfaceNormalMatrix = FRotationMatrix::MakeFromZX(PolyNormal, FVector(1.f, 0.f, 0.f));
-	TArray<FVector> TransformedVerts;
+	// This node has always returned the average of the points rather than the center of the rectangle
 	OutRectCenter = FVector(0.f);
-	for (int32 Idx = 0; Idx < InVerts.Num(); ++Idx)
+	for (const FVector & Vert : InVerts)
 	{
-		OutRectCenter += InVerts[Idx];
-		TransformedVerts.Add(SurfaceNormalMatrix.InverseTransformVector(InVerts[Idx]));
+		OutRectCenter += Vert;
 	}
 	OutRectCenter /= InVerts.Num();
 
-	// Compute the convex hull of the sample points
-	ConvexHull2D::ComputeConvexHull(TransformedVerts, PolyVertIndices);
-
-	// Minimum area rectangle as computed by http://www.geometrictools.com/Documentation/MinimumAreaRectangle.pdf
-	for (int32 Idx = 1; Idx < PolyVertIndices.Num() - 1; ++Idx)
-	{
-		SupportVectorA = (TransformedVerts[PolyVertIndices[Idx]] - TransformedVerts[PolyVertIndices[Idx - 1]]).GetSafeNormal();
-		SupportVectorA.Z = 0.f;
-		SupportVectorB.X = -SupportVectorA.Y;
-		SupportVectorB.Y = SupportVectorA.X;
-		SupportVectorB.Z = 0.f;
-		MinDotResultA = MinDotResultB = MaxDotResultA = MaxDotResultB = 0.f;
-
-		for (int TestVertIdx = 1; TestVertIdx < PolyVertIndices.Num(); ++TestVertIdx)
-		{
-			TestEdge = TransformedVerts[PolyVertIndices[TestVertIdx]] - TransformedVerts[PolyVertIndices[0]];
-			TestEdgeDot = SupportVectorA | TestEdge;
-			if (TestEdgeDot < MinDotResultA)
-			{
-				MinDotResultA = TestEdgeDot;
-			}
-			else if (TestEdgeDot > MaxDotResultA)
-			{
-				MaxDotResultA = TestEdgeDot;
-			}
-
-			TestEdgeDot = SupportVectorB | TestEdge;
-			if (TestEdgeDot < MinDotResultB)
-			{
-				MinDotResultB = TestEdgeDot;
-			}
-			else if (TestEdgeDot > MaxDotResultB)
-			{
-				MaxDotResultB = TestEdgeDot;
-			}
-		}
-
-		CurrentArea = (MaxDotResultA - MinDotResultA) * (MaxDotResultB - MinDotResultB);
-		if (MinArea < 0.f || CurrentArea < MinArea)
-		{
-			MinArea = CurrentArea;
-			RectSideA = SupportVectorA * (MaxDotResultA - MinDotResultA);
-			RectSideB = SupportVectorB * (MaxDotResultB - MinDotResultB);
-		}
-	}
-
-	RectSideA = SurfaceNormalMatrix.TransformVector(RectSideA);
-	RectSideB = SurfaceNormalMatrix.TransformVector(RectSideB);
-	OutRectRotation = FRotationMatrix::MakeFromZX(PolyNormal, RectSideA).Rotator();
-	OutSideLengthX = RectSideA.Size();
-	OutSideLengthY = RectSideB.Size();
+	OutRectRotation = Rect.Rotation;
+	OutSideLengthX = Rect.SideLengthX;
+	OutSideLengthY = Rect.SideLengthY;
 
 #if ENABLE_DRAW_DEBUG
 	if (bDebugDraw)
@@ -337,6 +226,9 @@ void UVRExpansionFunctionLibrary::NonAuthorityMinimumAreaRectangle(class UObject
 		UWorld* World = (WorldContextObject) ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull) : nullptr;
 		if (World != nullptr)
 		{
+			const FVector RectSideA = Rect.Rotation.RotateVector(FVector(Rect.SideLengthX, 0.f, 0.f));
+			const FVector RectSideB = Rect.Rotation.RotateVector(FVector(0.f, Rect.SideLengthY, 0.f));
+
 			DrawDebugSphere(World, OutRectCenter, 10.f, 12, FColor::Yellow, true);
 			DrawDebugCoordinateSystem(World, OutRectCenter, SurfaceNormalMatrix.Rotator(), 100.f, true);
 			DrawDebugLine(World, OutRectCenter - RectSideA * 0.5f + FVector(0, 0, 10.f), OutRectCenter + RectSideA * 0.5f + FVector(0, 0, 10.f), FColor::Green, true, -1, 0, 5.f);
@@ -350,6 +242,31 @@ void UVRExpansionFunctionLibrary::NonAuthorityMinimumAreaRectangle(class UObject
 #endif
 }
 
+bool UVRExpansionFunctionLibrary::NonAuthorityMinimumAreaRectangleCorners(const TArray<FVector>& InVerts, const FVector& SampleSurfaceNormal, FVRMinimumAreaRectangle& OutRect)
+{
+	FMinAreaRectScratch Scratch;
+	return MinimumAreaRectangle::Fit(InVerts, MinimumAreaRectangle::ComputeBasis(InVerts, SampleSurfaceNormal), OutRect, Scratch);
+}
+
+bool UVRExpansionFunctionLibrary::NonAuthorityMinimumAreaRectangleWithBasis(const TArray<FVector>& InVerts, FRotator PlaneRotation, FVRMinimumAreaRectangle& OutRect)
+{
+	FMinAreaRectScratch Scratch;
+	return MinimumAreaRectangle::Fit(InVerts, FRotationMatrix(PlaneRotation), OutRect, Scratch);
+}
+
+void UVRExpansionFunctionLibrary::NonAuthorityMinimumAreaRectangleBatch(const TArray<FVRMinimumAreaRectanglePoints>& PointSets, const FVector& SampleSurfaceNormal, TArray<FVRMinimumAreaRectangle>& OutRects)
+{
+	OutRects.SetNum(PointSets.Num());
+
+	// One set of buffers for the whole batch, they end up sized for the largest set
+	FMinAreaRectScratch Scratch;
+	for (int32 i = 0; i < PointSets.Num(); ++i)
+	{
+		const TArray<FVector> & Points = PointSets[i].Points;
+		MinimumAreaRectangle::Fit(Points, MinimumAreaRectangle::ComputeBasis(Points, SampleSurfaceNormal), OutRects[i], Scratch);
+	}
+}
+
 bool UVRExpansionFunctionLibrary::EqualEqual_FBPActorGripInformation(const FBPActorGripInformation &A, const FBPActorGripInformation &B)
 {
 	return A == B;
@@ -7,6 +7,7 @@
 #endif
 
 #include "VRGlobalSettings.h"
+#include "Misc/VRGripSlotIndex.h"
 #include "ISettingsContainer.h"
 #include "ISettingsModule.h"
 #include "ISettingsSection.h"
@@ -17,6 +18,7 @@ void FVRExpansionPluginModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
 	RegisterSettings();
+	FVRGripSlotIndexCache::StartupCache();
 
 #if WITH_PHYSX
 	FPhysScene_PhysX::PhysicsReplicationFactory = MakeShared<IPhysicsReplicationFactoryVR>();
@@ -29,6 +31,7 @@ void FVRExpansionPluginModule::ShutdownModule()
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
 	UnregisterSettings();
+	FVRGripSlotIndexCache::ShutdownCache();
 }
 
 void FVRExpansionPluginModule::RegisterSettings()
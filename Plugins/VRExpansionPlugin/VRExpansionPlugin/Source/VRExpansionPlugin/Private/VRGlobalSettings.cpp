@@ -9,6 +9,62 @@ UVRGlobalSettings::UVRGlobalSettings(const FObjectInitializer& ObjectInitializer
 	CurrentControllerProfileInUse(NAME_None),
 	CurrentControllerProfileTransform(FTransform::Identity),
 	bUseSeperateHandTransforms(false),
-	CurrentControllerProfileTransformRight(FTransform::Identity)
+	CurrentControllerProfileTransformRight(FTransform::Identity),
+	bControllerProfileRegistryDirty(true),
+	ControllerProfileGeneration(0)
 {
-}
\ No newline at end of file
+}
+
+const FVRControllerProfileRecord * UVRGlobalSettings::FindControllerProfileRecord(FName ControllerProfileName) const
+{
+	if (ControllerProfileName == NAME_None)
+		return nullptr;
+
+	if (bControllerProfileRegistryDirty)
+		RebuildControllerProfileRegistry();
+
+	return ControllerProfileRegistry.Find(ControllerProfileName);
+}
+
+void UVRGlobalSettings::MarkControllerProfilesDirty()
+{
+	bControllerProfileRegistryDirty = true;
+	++ControllerProfileGeneration;
+}
+
+void UVRGlobalSettings::RebuildControllerProfileRegistry() const
+{
+	ControllerProfileRegistry.Reset();
+	ControllerProfileRegistry.Reserve(ControllerProfiles.Num());
+
+	for (int32 i = 0; i < ControllerProfiles.Num(); ++i)
+	{
+		const FBPVRControllerProfile & Profile = ControllerProfiles[i];
+
+		if (Profile.ControllerName == NAME_None || ControllerProfileRegistry.Contains(Profile.ControllerName))
+			continue;
+
+		FVRControllerProfileRecord & Record = ControllerProfileRegistry.Add(Profile.ControllerName);
+		Record.ProfileIndex = i;
+		Record.HandTransforms[0] = Profile.SocketOffsetTransform;
+		Record.HandTransforms[1] = Profile.bUseSeperateHandOffsetTransforms ? Profile.SocketOffsetTransformRightHand : Profile.SocketOffsetTransform;
+		Record.InverseHandTransforms[0] = Record.HandTransforms[0].Inverse();
+		Record.InverseHandTransforms[1] = Record.HandTransforms[1].Inverse();
+	}
+
+	bControllerProfileRegistryDirty = false;
+}
+
+void UVRGlobalSettings::PostReloadConfig(UProperty* PropertyThatWasLoaded)
+{
+	Super::PostReloadConfig(PropertyThatWasLoaded);
+	MarkControllerProfilesDirty();
+}
+
+#if WITH_EDITOR
+void UVRGlobalSettings::PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	MarkControllerProfilesDirty();
+}
+#endif
\ No newline at end of file
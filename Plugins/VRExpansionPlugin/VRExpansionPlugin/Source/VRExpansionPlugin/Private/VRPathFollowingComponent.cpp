@@ -12,6 +12,124 @@
 
 DEFINE_LOG_CATEGORY(LogPathFollowingVR);
 
+UVRPathFollowingComponent::UVRPathFollowingComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	bUseCrowdPathFollowing = false;
+	CrowdIndex = INDEX_NONE;
+}
+
+void UVRPathFollowingComponent::SetUseCrowdPathFollowing(bool bUseCrowd)
+{
+	if (bUseCrowdPathFollowing == bUseCrowd)
+		return;
+
+	bUseCrowdPathFollowing = bUseCrowd;
+
+	if (!IsRegistered())
+		return;
+
+	if (bUseCrowdPathFollowing)
+	{
+		if (UVRPathFollowingCrowdManager * Manager = UVRPathFollowingCrowdManager::Get(GetWorld()))
+			Manager->RegisterAgent(this);
+	}
+	else if (CrowdManager.IsValid())
+	{
+		CrowdManager->UnregisterAgent(this);
+	}
+}
+
+void UVRPathFollowingComponent::OnRegister()
+{
+	Super::OnRegister();
+
+	if (bUseCrowdPathFollowing)
+	{
+		if (UVRPathFollowingCrowdManager * Manager = UVRPathFollowingCrowdManager::Get(GetWorld()))
+			Manager->RegisterAgent(this);
+	}
+}
+
+void UVRPathFollowingComponent::OnUnregister()
+{
+	if (CrowdManager.IsValid())
+		CrowdManager->UnregisterAgent(this);
+
+	Super::OnUnregister();
+}
+
+void UVRPathFollowingComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction)
+{
+	// The crowd manager runs the update for its agents, skip straight past the path following tick
+	if (CrowdIndex != INDEX_NONE)
+	{
+		UActorComponent::TickComponent(DeltaTime, TickType, ThisTickFunction);
+		return;
+	}
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+}
+
+void UVRPathFollowingComponent::UpdatePerAgent(float DeltaTime)
+{
+	// Matches UPathFollowingComponent::TickComponent
+	if (Status == EPathFollowingStatus::Moving)
+	{
+		UpdatePathSegment();
+	}
+
+	if (Status == EPathFollowingStatus::Moving)
+	{
+		FollowPathSegment(DeltaTime);
+	}
+}
+
+bool UVRPathFollowingComponent::GetCrowdSegment(FVector& OutFeetLocation, FVector& OutTarget, FVector& OutDirection, float& OutReachRadius) const
+{
+	// Anything that would abort goes through the regular update instead
+	if (Status != EPathFollowingStatus::Moving || !Path.IsValid() || !Path->IsValid() || MovementComp == nullptr)
+	{
+		return false;
+	}
+
+	float AgentRadius = 0.0f;
+	float AgentHalfHeight = 0.0f;
+	MovementComp->GetOwner()->GetSimpleCollisionCylinder(AgentRadius, AgentHalfHeight);
+
+	OutFeetLocation = (VRMovementComp != nullptr ? VRMovementComp->GetActorFeetLocationVR() : MovementComp->GetActorFeetLocation());
+	OutTarget = GetCurrentTargetLocation();
+	OutDirection = GetCurrentDirection();
+
+	// Upper bound of the 2D radius HasReachedCurrentTarget accepts, padded so that rounding can't reject a point the exact test would take
+	OutReachRadius = CurrentAcceptanceRadius + (AgentRadius * 0.05f) + KINDA_SMALL_NUMBER;
+	return true;
+}
+
+void UVRPathFollowingComponent::UpdateFromCrowd(float DeltaTime, const FVector& FeetLocation, const FVector& SegmentTarget, EVRCrowdReachResult ReachResult, const FVector& ToTarget, const FVector& MoveDirection)
+{
+	if (Status == EPathFollowingStatus::Moving)
+	{
+		UpdatePathSegment_Internal(FeetLocation, ReachResult);
+	}
+
+	if (Status == EPathFollowingStatus::Moving)
+	{
+		const FVector CurrentTarget = GetCurrentTargetLocation();
+
+		if (CurrentTarget == SegmentTarget)
+		{
+			FollowPathSegment_Internal(DeltaTime, FeetLocation, ToTarget, MoveDirection);
+		}
+		else
+		{
+			// Moved on to another segment or straight to the goal, the batched direction is for the old target
+			const FVector NewToTarget = CurrentTarget - FeetLocation;
+			FollowPathSegment_Internal(DeltaTime, FeetLocation, NewToTarget, NewToTarget.GetSafeNormal());
+		}
+	}
+}
+
 void UVRPathFollowingComponent::SetMovementComponent(UNavMovementComponent* MoveComp)
 {
 	Super::SetMovementComponent(MoveComp);
@@ -246,6 +364,12 @@ bool UVRPathFollowingComponent::UpdateBlockDetection()
 }
 
 void UVRPathFollowingComponent::UpdatePathSegment()
+{
+	const FVector CurrentLocation = MovementComp ? (VRMovementComp != nullptr ? VRMovementComp->GetActorFeetLocationVR() : MovementComp->GetActorFeetLocation()) : FVector::ZeroVector;
+	UpdatePathSegment_Internal(CurrentLocation, EVRCrowdReachResult::NeedsExactTest);
+}
+
+void UVRPathFollowingComponent::UpdatePathSegment_Internal(const FVector& CurrentLocation, EVRCrowdReachResult ReachResult)
 {
 #if !UE_BUILD_SHIPPING
 	DEBUG_bMovingDirectlyToGoal = false;
@@ -272,7 +396,6 @@ void UVRPathFollowingComponent::UpdatePathSegment()
 	FMetaNavMeshPath* MetaNavPath = bIsUsingMetaPath ? Path->CastPath<FMetaNavMeshPath>() : nullptr;
 
 	// if agent has control over its movement, check finish conditions
-	const FVector CurrentLocation = (VRMovementComp != nullptr ? VRMovementComp->GetActorFeetLocationVR() : MovementComp->GetActorFeetLocation());
 	const bool bCanUpdateState = HasMovementAuthority();
 	if (bCanUpdateState && Status == EPathFollowingStatus::Moving)
 	{
@@ -316,7 +439,7 @@ void UVRPathFollowingComponent::UpdatePathSegment()
 #endif // !UE_BUILD_SHIPPING
 		}
 		// check if current move segment is finished
-		else if (HasReachedCurrentTarget(CurrentLocation))
+		else if (ReachResult == EVRCrowdReachResult::NeedsExactTest ? HasReachedCurrentTarget(CurrentLocation) : ReachResult == EVRCrowdReachResult::Reached)
 		{
 			OnSegmentFinished();
 			SetNextMoveSegment();
@@ -361,7 +484,16 @@ void UVRPathFollowingComponent::FollowPathSegment(float DeltaTime)
 	}
 
 	const FVector CurrentLocation = (VRMovementComp != nullptr ? VRMovementComp->GetActorFeetLocationVR() : MovementComp->GetActorFeetLocation());
-	const FVector CurrentTarget = GetCurrentTargetLocation();
+	const FVector ToTarget = GetCurrentTargetLocation() - CurrentLocation;
+	FollowPathSegment_Internal(DeltaTime, CurrentLocation, ToTarget, ToTarget.GetSafeNormal());
+}
+
+void UVRPathFollowingComponent::FollowPathSegment_Internal(float DeltaTime, const FVector& CurrentLocation, const FVector& ToTarget, const FVector& MoveDirection)
+{
+	if (!Path.IsValid() || MovementComp == nullptr)
+	{
+		return;
+	}
 
 	// set to false by default, we will set set this back to true if appropriate
 	bIsDecelerating = false;
@@ -369,7 +501,7 @@ void UVRPathFollowingComponent::FollowPathSegment(float DeltaTime)
 	const bool bAccelerationBased = MovementComp->UseAccelerationForPathFollowing();
 	if (bAccelerationBased)
 	{
-		CurrentMoveInput = (CurrentTarget - CurrentLocation).GetSafeNormal();
+		CurrentMoveInput = MoveDirection;
 
 		if (MoveSegmentStartIndex >= DecelerationSegmentIndex)
 		{
@@ -390,7 +522,7 @@ void UVRPathFollowingComponent::FollowPathSegment(float DeltaTime)
 	}
 	else
 	{
-		FVector MoveVelocity = (CurrentTarget - CurrentLocation) / DeltaTime;
+		FVector MoveVelocity = ToTarget / DeltaTime;
 
 		const int32 LastSegmentStartIndex = Path->GetPathPoints().Num() - 2;
 		const bool bNotFollowingLastSegment = (MoveSegmentStartIndex < LastSegmentStartIndex);
@@ -411,7 +543,7 @@ bool UVRPathFollowingComponent::HasReachedCurrentTarget(const FVector& CurrentLo
 	const FVector CurrentDirection = GetCurrentDirection();
 
 	// check if moved too far
-	const FVector ToTarget = (CurrentTarget - (VRMovementComp != nullptr ? VRMovementComp->GetActorFeetLocationVR() : MovementComp->GetActorFeetLocation()));
+	const FVector ToTarget = (CurrentTarget - CurrentLocation);
 	const float SegmentDot = FVector::DotProduct(ToTarget, CurrentDirection);
 	if (SegmentDot < 0.0)
 	{
@@ -366,6 +366,7 @@ UVRRootComponent::UVRRootComponent(const FObjectInitializer& ObjectInitializer)
 	curCameraRot = FRotator::ZeroRotator;
 	curCameraLoc = FVector::ZeroVector;
 	StoredCameraRotOffset = FRotator::ZeroRotator;
+	StoredCameraRotSource = FRotator::ZeroRotator;
 	TargetPrimitiveComponent = NULL;
 	owningVRChar = NULL;
 	//VRCameraCollider = NULL;
@@ -552,6 +553,7 @@ void UVRRootComponent::TickComponent(float DeltaTime, enum ELevelTick TickType,
 
 		// Store a leveled yaw value here so it is only calculated once
 		StoredCameraRotOffset = UVRExpansionFunctionLibrary::GetHMDPureYaw_I(curCameraRot);
+		StoredCameraRotSource = curCameraRot;
 
 		// Can adjust the relative tolerances to remove jitter and some update processing
 		if (!curCameraLoc.Equals(lastCameraLoc, 0.01f) || !curCameraRot.Equals(lastCameraRot, 0.01f))
@@ -651,6 +653,7 @@ void UVRRootComponent::TickComponent(float DeltaTime, enum ELevelTick TickType,
 
 		// Store a leveled yaw value here so it is only calculated once
 		StoredCameraRotOffset = UVRExpansionFunctionLibrary::GetHMDPureYaw_I(curCameraRot);
+		StoredCameraRotSource = curCameraRot;
 
 		// Can adjust the relative tolerances to remove jitter and some update processing
 		if (!curCameraLoc.Equals(lastCameraLoc, 0.01f) || !curCameraRot.Equals(lastCameraRot, 0.01f))
@@ -1,7 +1,9 @@
 // Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
 
 #include "VRStereoWidgetComponent.h"
+#include "VRStereoWidgetRenderTargetPool.h"
 #include "VRExpansionFunctionLibrary.h"
+#include "Blueprint/UserWidget.h"
 #include "TextureResource.h"
 #include "Engine/Texture.h"
 #include "IStereoLayers.h"
@@ -39,6 +41,10 @@ namespace StereoWidgetCvars
 		ECVF_Default);
 }
 
+DECLARE_DWORD_COUNTER_STAT(TEXT("Widget Redraws"), STAT_StereoWidgetRedraws, STATGROUP_VRStereoWidget);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Layer Desc Updates"), STAT_StereoWidgetLayerUpdates, STATGROUP_VRStereoWidget);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Layer Texture Updates"), STAT_StereoWidgetTextureUpdates, STATGROUP_VRStereoWidget);
+
   //=============================================================================
 UVRStereoWidgetComponent::UVRStereoWidgetComponent(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
@@ -73,6 +79,19 @@ UVRStereoWidgetComponent::UVRStereoWidgetComponent(const FObjectInitializer& Obj
 	bDirtyRenderTarget = false;
 	bIsSleeping = false;
 	//Texture = nullptr;
+
+	bRedrawOnlyWhenInvalidated = false;
+	StaticRedrawInterval = 0.0f;
+	bUseSharedRenderTargetPool = false;
+	bWidgetInvalidated = true;
+	bForcedManualRedraw = false;
+	bRenderTargetIsPooled = false;
+	LastInvalidatedDrawTime = 0.0;
+	LastDrawnSize = FIntPoint::ZeroValue;
+	bWasHoveredOrFocused = false;
+	bWasVisibleForRedraw = false;
+	RedrawCount = 0;
+	TextureUploadCount = 0;
 }
 
 //=============================================================================
@@ -94,33 +113,150 @@ void UVRStereoWidgetComponent::BeginDestroy()
 
 
 void UVRStereoWidgetComponent::OnUnregister()
+{
+	DestroyStereoLayer();
+	ReleasePooledRenderTarget();
+
+	Super::OnUnregister();
+}
+
+void UVRStereoWidgetComponent::DestroyStereoLayer()
 {
 	IStereoLayers* StereoLayers;
 	if (LayerId && GEngine->StereoRenderingDevice.IsValid() && (StereoLayers = GEngine->StereoRenderingDevice->GetStereoLayers()) != nullptr)
 	{
 		StereoLayers->DestroyLayer(LayerId);
-		LayerId = 0;
 	}
 
-	Super::OnUnregister();
+	LayerId = 0;
+	LastLayerDesc = IStereoLayers::FLayerDesc();
 }
 
+void UVRStereoWidgetComponent::ReleasePooledRenderTarget()
+{
+	if (!bRenderTargetIsPooled || !RenderTarget)
+		return;
+
+	// The layer is still pointing at the texture
+	DestroyStereoLayer();
+
+	if (UVRStereoWidgetRenderTargetPool * Pool = UVRStereoWidgetRenderTargetPool::Get(GetWorld(), false))
+	{
+		Pool->Release(RenderTarget);
+	}
+
+	RenderTarget = nullptr;
+	bRenderTargetIsPooled = false;
+
+	if (MaterialInstance)
+	{
+		MaterialInstance->SetTextureParameterValue("SlateUI", nullptr);
+	}
+
+	// Needs a fresh draw into whatever target it gets next
+	bWidgetInvalidated = true;
+	bIsDirty = true;
+	MarkRenderStateDirty();
+}
+
+void UVRStereoWidgetComponent::InvalidateWidget()
+{
+	bWidgetInvalidated = true;
+}
+
+void UVRStereoWidgetComponent::SetWidget(UUserWidget* InWidget)
+{
+	Super::SetWidget(InWidget);
+	bWidgetInvalidated = true;
+}
+
+bool UVRStereoWidgetComponent::ShouldRedrawForInvalidation()
+{
+	if (bWidgetInvalidated || LastDrawnSize != DrawSize)
+		return true;
+
+	if (Widget && Widget->IsAnyAnimationPlaying())
+		return true;
+
+	// Hover and focus drive most button / text box visuals, keep drawing for one more frame after they end to clear them
+	bool bHoveredOrFocused = CurrentSlateWidget.IsValid() && (CurrentSlateWidget->IsHovered() || CurrentSlateWidget->HasAnyUserFocusOrFocusedDescendants());
+	if (bHoveredOrFocused || bWasHoveredOrFocused)
+	{
+		bWasHoveredOrFocused = bHoveredOrFocused;
+		return true;
+	}
+
+	if (StaticRedrawInterval > 0.0f && GetWorld() && GetWorld()->GetRealTimeSeconds() - LastInvalidatedDrawTime >= StaticRedrawInterval)
+		return true;
+
+	return false;
+}
+
+void UVRStereoWidgetComponent::ResetRenderCounters()
+{
+	RedrawCount = 0;
+	TextureUploadCount = 0;
+}
+
+bool UVRStereoWidgetComponent::UpdateRedrawRequest()
+{
+	// Tracked here rather than only when the pooled target is handed back, a hidden widget misses every invalidation in between
+	bool bVisibleForRedraw = IsVisible();
+	if (bVisibleForRedraw && !bWasVisibleForRedraw)
+		bWidgetInvalidated = true;
+	bWasVisibleForRedraw = bVisibleForRedraw;
+
+	if (bRedrawOnlyWhenInvalidated)
+	{
+		if (!bManuallyRedraw)
+		{
+			bManuallyRedraw = true;
+			bForcedManualRedraw = true;
+		}
+
+		if (ShouldRedrawForInvalidation())
+		{
+			RequestRedraw();
+			return true;
+		}
+	}
+	else if (bForcedManualRedraw)
+	{
+		bManuallyRedraw = false;
+		bForcedManualRedraw = false;
+	}
+
+	return false;
+}
 
 void UVRStereoWidgetComponent::DrawWidgetToRenderTarget(float DeltaTime)
 {
 	Super::DrawWidgetToRenderTarget(DeltaTime);
 
+	INC_DWORD_STAT(STAT_StereoWidgetRedraws);
+	++RedrawCount;
+
 	bDirtyRenderTarget = true;
+	bWidgetInvalidated = false;
+	LastDrawnSize = DrawSize;
+	LastInvalidatedDrawTime = GetWorld() ? GetWorld()->GetRealTimeSeconds() : 0.0;
 }
 
 void UVRStereoWidgetComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction)
 {
+	UpdateRedrawRequest();
 
 	// Precaching what the widget uses for draw time here as it gets modified in the super tick
 	bool bWidgetDrew = ShouldDrawWidget();
 
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
+	// Hand the target back while hidden, the next draw after being shown takes one again
+	if (bRenderTargetIsPooled && !IsVisible())
+	{
+		ReleasePooledRenderTarget();
+	}
+
 	bool bIsVisible = IsVisible() && !bIsSleeping && ((GetWorld()->TimeSince(GetLastRenderTime()) <= 0.5f));
 
 	if (StereoWidgetCvars::ForceNoStereoWithVRWidgets)
@@ -259,14 +395,18 @@ void UVRStereoWidgetComponent::TickComponent(float DeltaTime, enum ELevelTick Ti
 	}
 
 	// If the transform changed dirty the layer and push the new transform
-	
+	// A redraw alone doesn't change the description, continuous update layers pick it up on their own and the others are marked below
 	if (!bIsDirty)
 	{
 		if (bLastVisible != bIsVisible)
 		{
 			bIsDirty = true;
 		}
-		else if (bDirtyRenderTarget || FMemory::Memcmp(&LastTransform, &Transform, sizeof(Transform)) != 0)
+		else if (FMemory::Memcmp(&LastTransform, &Transform, sizeof(Transform)) != 0)
+		{
+			bIsDirty = true;
+		}
+		else if (RenderTarget && RenderTarget->Resource && LastLayerDesc.Texture != RenderTarget->Resource->TextureRHI)
 		{
 			bIsDirty = true;
 		}
@@ -284,8 +424,7 @@ void UVRStereoWidgetComponent::TickComponent(float DeltaTime, enum ELevelTick Ti
 		{
 			if (LayerId)
 			{
-				StereoLayers->DestroyLayer(LayerId);
-				LayerId = 0;
+				DestroyStereoLayer();
 			}
 		}
 		else
@@ -317,7 +456,8 @@ void UVRStereoWidgetComponent::TickComponent(float DeltaTime, enum ELevelTick Ti
 			// This needs to be auto set from variables, need to work on it
 			LayerDsec.CylinderHeight = GetDrawSize().Y;//CylinderHeight;
 
-			LayerDsec.Flags |= IStereoLayers::LAYER_FLAG_TEX_CONTINUOUS_UPDATE;// (/*bLiveTexture*/true) ? IStereoLayers::LAYER_FLAG_TEX_CONTINUOUS_UPDATE : 0;
+			// Invalidation driven widgets mark the texture themselves after a redraw instead of having it copied every frame
+			LayerDsec.Flags |= (!bRedrawOnlyWhenInvalidated) ? IStereoLayers::LAYER_FLAG_TEX_CONTINUOUS_UPDATE : 0;// (/*bLiveTexture*/true) ? IStereoLayers::LAYER_FLAG_TEX_CONTINUOUS_UPDATE : 0;
 			LayerDsec.Flags |= (bNoAlphaChannel) ? IStereoLayers::LAYER_FLAG_TEX_NO_ALPHA_CHANNEL : 0;
 			LayerDsec.Flags |= (bQuadPreserveTextureRatio) ? IStereoLayers::LAYER_FLAG_QUAD_PRESERVE_TEX_RATIO : 0;
 			LayerDsec.Flags |= (bSupportsDepth) ? IStereoLayers::LAYER_FLAG_SUPPORT_DEPTH : 0;
@@ -355,25 +495,58 @@ void UVRStereoWidgetComponent::TickComponent(float DeltaTime, enum ELevelTick Ti
 			}break;
 			}
 
-			if (LayerId)
-			{
-				StereoLayers->SetLayerDesc(LayerId, LayerDsec);
-			}
-			else
-			{
-				LayerId = StereoLayers->CreateLayer(LayerDsec);
-			}
+			PushLayerDesc(StereoLayers, LayerDsec);
 		}
 
 	}
 
+	UpdateLayerTexture(StereoLayers);
+
 	LastTransform = Transform;
 	bLastVisible = bCurrVisible;
 	bIsDirty = false;
-	bDirtyRenderTarget = false;
 #endif
 }
 
+void UVRStereoWidgetComponent::PushLayerDesc(IStereoLayers * StereoLayers, const IStereoLayers::FLayerDesc & LayerDesc)
+{
+	if (LayerId)
+	{
+		if (!LayerDescsMatch(LastLayerDesc, LayerDesc))
+		{
+			StereoLayers->SetLayerDesc(LayerId, LayerDesc);
+			LastLayerDesc = LayerDesc;
+			INC_DWORD_STAT(STAT_StereoWidgetLayerUpdates);
+		}
+	}
+	else
+	{
+		LayerId = StereoLayers->CreateLayer(LayerDesc);
+		LastLayerDesc = LayerDesc;
+		INC_DWORD_STAT(STAT_StereoWidgetLayerUpdates);
+	}
+}
+
+void UVRStereoWidgetComponent::UpdateLayerTexture(IStereoLayers * StereoLayers)
+{
+	if (LayerId)
+	{
+		// Continuous update layers are copied by the runtime every frame whether the widget redrew or not
+		if ((LastLayerDesc.Flags & IStereoLayers::LAYER_FLAG_TEX_CONTINUOUS_UPDATE) != 0)
+		{
+			++TextureUploadCount;
+		}
+		else if (bDirtyRenderTarget)
+		{
+			StereoLayers->MarkTextureForUpdate(LayerId);
+			INC_DWORD_STAT(STAT_StereoWidgetTextureUpdates);
+			++TextureUploadCount;
+		}
+	}
+
+	bDirtyRenderTarget = false;
+}
+
 
 void UVRStereoWidgetComponent::SetPriority(int32 InPriority)
 {
@@ -388,9 +561,51 @@ void UVRStereoWidgetComponent::SetPriority(int32 InPriority)
 
 void UVRStereoWidgetComponent::UpdateRenderTarget(FIntPoint DesiredRenderTargetSize)
 {
+	if (bUseSharedRenderTargetPool && DesiredRenderTargetSize.X > 0 && DesiredRenderTargetSize.Y > 0)
+	{
+		// Swap sizes through the pool rather than resizing a target another widget may want back at the old size
+		if (RenderTarget && bRenderTargetIsPooled && (RenderTarget->SizeX != DesiredRenderTargetSize.X || RenderTarget->SizeY != DesiredRenderTargetSize.Y))
+		{
+			ReleasePooledRenderTarget();
+		}
+
+		if (!RenderTarget)
+		{
+			if (UVRStereoWidgetRenderTargetPool * Pool = UVRStereoWidgetRenderTargetPool::Get(GetWorld()))
+			{
+				RenderTarget = Pool->Acquire(DesiredRenderTargetSize);
+				bRenderTargetIsPooled = true;
+
+				// The super only sets this when it creates the target itself
+				if (MaterialInstance)
+				{
+					MaterialInstance->SetTextureParameterValue("SlateUI", RenderTarget);
+				}
+
+				MarkRenderStateDirty();
+			}
+		}
+	}
+
 	Super::UpdateRenderTarget(DesiredRenderTargetSize);
 }
 
+bool UVRStereoWidgetComponent::LayerDescsMatch(const IStereoLayers::FLayerDesc & A, const IStereoLayers::FLayerDesc & B)
+{
+	return A.Priority == B.Priority &&
+		A.PositionType == B.PositionType &&
+		A.ShapeType == B.ShapeType &&
+		A.Flags == B.Flags &&
+		A.QuadSize == B.QuadSize &&
+		A.UVRect == B.UVRect &&
+		A.CylinderRadius == B.CylinderRadius &&
+		A.CylinderOverlayArc == B.CylinderOverlayArc &&
+		A.CylinderHeight == B.CylinderHeight &&
+		A.Texture == B.Texture &&
+		A.LeftTexture == B.LeftTexture &&
+		FMemory::Memcmp(&A.Transform, &B.Transform, sizeof(FTransform)) == 0;
+}
+
 /** Represents a billboard sprite to the scene manager. */
 class FStereoWidget3DSceneProxy final : public FPrimitiveSceneProxy
 {
@@ -756,6 +971,16 @@ void UVRStereoWidgetComponent::ApplyVRComponentInstanceData(FVRStereoWidgetCompo
 
 	RenderTarget = WidgetInstanceData->RenderTarget;
 
+	// The previous component handed a pooled target back when it unregistered, take it out of the free list again
+	bRenderTargetIsPooled = RenderTarget && RenderTarget->GetOuter() && RenderTarget->GetOuter()->IsA<UVRStereoWidgetRenderTargetPool>();
+	if (bRenderTargetIsPooled)
+	{
+		if (UVRStereoWidgetRenderTargetPool * Pool = UVRStereoWidgetRenderTargetPool::Get(GetWorld(), false))
+		{
+			Pool->Claim(RenderTarget);
+		}
+	}
+
 	// Also set the texture
 	//Texture = RenderTarget;
 	// Not needed anymore, just using the render target directly now
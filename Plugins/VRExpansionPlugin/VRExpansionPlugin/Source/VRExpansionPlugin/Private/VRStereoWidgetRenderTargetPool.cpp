@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "VRStereoWidgetRenderTargetPool.h"
+#include "VRStereoWidgetComponent.h"
+#include "Engine/World.h"
+#include "Engine/TextureRenderTarget2D.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pooled Free Render Targets"), STAT_StereoWidgetPooledTargets, STATGROUP_VRStereoWidget);
+
+namespace StereoWidgetPoolCvars
+{
+	static int32 MaxFreeTargetsPerSize = 4;
+	FAutoConsoleVariableRef CVarMaxFreeTargetsPerSize(
+		TEXT("vr.StereoWidget.MaxPooledTargetsPerSize"),
+		MaxFreeTargetsPerSize,
+		TEXT("How many unused render targets of each size the stereo widget pool holds on to before letting them be collected."),
+		ECVF_Default);
+}
+
+UVRStereoWidgetRenderTargetPool * UVRStereoWidgetRenderTargetPool::Get(UWorld * World, bool bCreateIfMissing)
+{
+	if (!World || !World->IsGameWorld())
+		return nullptr;
+
+	for (UObject * DataObject : World->PerModuleDataObjects)
+	{
+		if (UVRStereoWidgetRenderTargetPool * Pool = Cast<UVRStereoWidgetRenderTargetPool>(DataObject))
+			return Pool;
+	}
+
+	if (!bCreateIfMissing || World->bIsTearingDown)
+		return nullptr;
+
+	UVRStereoWidgetRenderTargetPool * NewPool = NewObject<UVRStereoWidgetRenderTargetPool>(World);
+	World->PerModuleDataObjects.Add(NewPool);
+	return NewPool;
+}
+
+UTextureRenderTarget2D * UVRStereoWidgetRenderTargetPool::Acquire(FIntPoint Size)
+{
+	for (FVRStereoWidgetRenderTargetBucket & Bucket : Buckets)
+	{
+		if (Bucket.Size == Size)
+		{
+			while (Bucket.FreeTargets.Num() > 0)
+			{
+				UTextureRenderTarget2D * RenderTarget = Bucket.FreeTargets.Pop(false);
+				DEC_DWORD_STAT(STAT_StereoWidgetPooledTargets);
+
+				if (RenderTarget && !RenderTarget->IsPendingKill())
+					return RenderTarget;
+			}
+			break;
+		}
+	}
+
+	// The widget component fixes up the format and clear color on the first draw
+	UTextureRenderTarget2D * NewRenderTarget = NewObject<UTextureRenderTarget2D>(this);
+	NewRenderTarget->InitCustomFormat(Size.X, Size.Y, PF_B8G8R8A8, false);
+	return NewRenderTarget;
+}
+
+void UVRStereoWidgetRenderTargetPool::Release(UTextureRenderTarget2D * RenderTarget)
+{
+	if (!RenderTarget || RenderTarget->IsPendingKill())
+		return;
+
+	const FIntPoint Size(RenderTarget->SizeX, RenderTarget->SizeY);
+
+	FVRStereoWidgetRenderTargetBucket * Bucket = Buckets.FindByPredicate([&Size](const FVRStereoWidgetRenderTargetBucket & Entry)
+	{
+		return Entry.Size == Size;
+	});
+
+	if (!Bucket)
+	{
+		Bucket = &Buckets.AddDefaulted_GetRef();
+		Bucket->Size = Size;
+	}
+
+	if (Bucket->FreeTargets.Num() < StereoWidgetPoolCvars::MaxFreeTargetsPerSize && !Bucket->FreeTargets.Contains(RenderTarget))
+	{
+		Bucket->FreeTargets.Add(RenderTarget);
+		INC_DWORD_STAT(STAT_StereoWidgetPooledTargets);
+	}
+}
+
+void UVRStereoWidgetRenderTargetPool::Claim(UTextureRenderTarget2D * RenderTarget)
+{
+	if (!RenderTarget)
+		return;
+
+	for (FVRStereoWidgetRenderTargetBucket & Bucket : Buckets)
+	{
+		if (Bucket.FreeTargets.RemoveSingleSwap(RenderTarget, false) > 0)
+		{
+			DEC_DWORD_STAT(STAT_StereoWidgetPooledTargets);
+			return;
+		}
+	}
+}
+
+int32 UVRStereoWidgetRenderTargetPool::GetNumFreeTargets() const
+{
+	int32 NumFree = 0;
+	for (const FVRStereoWidgetRenderTargetBucket & Bucket : Buckets)
+	{
+		NumFree += Bucket.FreeTargets.Num();
+	}
+	return NumFree;
+}
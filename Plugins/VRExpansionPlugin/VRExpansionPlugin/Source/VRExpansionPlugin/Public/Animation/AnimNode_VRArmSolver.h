@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BoneContainer.h"
+#include "BonePose.h"
+#include "BoneControllers/AnimNode_SkeletalControlBase.h"
+#include "Animation/VRArmSolverComponent.h"
+#include "AnimNode_VRArmSolver.generated.h"
+
+class UVRArmSolverComponent;
+
+USTRUCT(BlueprintType)
+struct VREXPANSIONPLUGIN_API FVRArmSolverArmBones
+{
+	GENERATED_BODY()
+public:
+
+	UPROPERTY(EditAnywhere, Category = "Bones")
+		FBoneReference Clavicle;
+
+	UPROPERTY(EditAnywhere, Category = "Bones")
+		FBoneReference UpperArm;
+
+	UPROPERTY(EditAnywhere, Category = "Bones")
+		FBoneReference LowerArm;
+
+	UPROPERTY(EditAnywhere, Category = "Bones")
+		FBoneReference Hand;
+
+	// Rotation from the motion controller to the hand bone
+	UPROPERTY(EditAnywhere, Category = "Bones")
+		FRotator HandRotationOffset;
+
+	FVRArmSolverArmBones() :
+		HandRotationOffset(FRotator::ZeroRotator)
+	{}
+
+	void Initialize(const FBoneContainer & RequiredBones)
+	{
+		Clavicle.Initialize(RequiredBones);
+		UpperArm.Initialize(RequiredBones);
+		LowerArm.Initialize(RequiredBones);
+		Hand.Initialize(RequiredBones);
+	}
+
+	bool IsValid(const FBoneContainer & RequiredBones) const
+	{
+		return Clavicle.IsValidToEvaluate(RequiredBones) && UpperArm.IsValidToEvaluate(RequiredBones) && LowerArm.IsValidToEvaluate(RequiredBones) && Hand.IsValidToEvaluate(RequiredBones);
+	}
+};
+
+/**
+* Applies the solve of the owners UVRArmSolverComponent to the arm bones.
+* The solve has already been done by the time animation runs, this node only aims the chain at the solved shoulder, elbow and hand
+* while keeping the meshes own bone lengths.
+*/
+USTRUCT(BlueprintInternalUseOnly)
+struct VREXPANSIONPLUGIN_API FAnimNode_VRArmSolver : public FAnimNode_SkeletalControlBase
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY(EditAnywhere, Category = "Arms")
+		FVRArmSolverArmBones LeftArm;
+
+	UPROPERTY(EditAnywhere, Category = "Arms")
+		FVRArmSolverArmBones RightArm;
+
+	// Rotates the hand bones to the controllers
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arms", meta = (PinHiddenByDefault))
+		bool bApplyHandRotation;
+
+	FAnimNode_VRArmSolver();
+
+	// FAnimNode_Base interface
+	virtual bool HasPreUpdate() const override { return true; }
+	virtual void PreUpdate(const UAnimInstance* InAnimInstance) override;
+	// End of FAnimNode_Base interface
+
+	// FAnimNode_SkeletalControlBase interface
+	virtual void EvaluateSkeletalControl_AnyThread(FComponentSpacePoseContext& Output, TArray<FBoneTransform>& OutBoneTransforms) override;
+	virtual bool IsValidToEvaluate(const USkeleton* Skeleton, const FBoneContainer& RequiredBones) override;
+	// End of FAnimNode_SkeletalControlBase interface
+
+private:
+
+	// FAnimNode_SkeletalControlBase interface
+	virtual void InitializeBoneReferences(const FBoneContainer& RequiredBones) override;
+	// End of FAnimNode_SkeletalControlBase interface
+
+	void SolveArm(FComponentSpacePoseContext& Output, const FVRArmSolverArmBones & Bones, int32 Side, TArray<FBoneTransform>& OutBoneTransforms) const;
+
+	// Copied over on the game thread so evaluation never touches the component
+	FVRArmSolverResult CachedResult;
+	FTransform CachedComponentTransform;
+	TWeakObjectPtr<UVRArmSolverComponent> SolverComponent;
+};
@@ -3,33 +3,190 @@
 #pragma once
 #include "CoreMinimal.h"
 #include "VRBPDatatypes.h"
-#include "ActorComponent.h"
-//#include "ArmSolver.generated.h"
+#include "ArmSolver.generated.h"
 
-
-class ArmSolver
+/**
+* Elbow and shoulder estimation settings, angles are in degrees.
+* The elbow angle is measured around the shoulder to hand axis, 0 points the elbow straight up, 90 out to the side and 180 straight down.
+* The weights are applied against the hand position relative to the shoulder in units of arm length:
+* y is up, z is forward and x is to the right, the same convention the original weights were tuned with.
+*/
+USTRUCT(BlueprintType, Category = "VRExpansionLibrary|ArmSolver")
+struct VREXPANSIONPLUGIN_API FArmSolverElbowSettings
 {
-
+	GENERATED_BODY()
 public:
 
-	bool calcElbowAngle;
-	bool clampElbowAngle;
-	bool softClampElbowAngle;
-	float maxAngle, minAngle, softClampRange;
-	float offsetAngle;
-	float yWeight;
-	float zWeightTop, zWeightBottom, zBorderY, zDistanceStart;
-	float xWeight, xDistanceStart;
+	// If false the elbow is always placed at offsetAngle
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Elbow")
+		bool calcElbowAngle;
 
-	ArmSolver()
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Elbow")
+		bool clampElbowAngle;
+
+	// Eases into the limits over softClampRange instead of stopping dead at them
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Elbow")
+		bool softClampElbowAngle;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Elbow")
+		float maxAngle;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Elbow")
+		float minAngle;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Elbow")
+		float softClampRange;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Elbow")
+		float offsetAngle;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Elbow")
+		float yWeight;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Elbow")
+		float zWeightTop;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Elbow")
+		float zWeightBottom;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Elbow")
+		float zBorderY;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Elbow")
+		float zDistanceStart;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Elbow")
+		float xWeight;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Elbow")
+		float xDistanceStart;
+
+	// Degrees per second the elbow angle moves towards its target, 0 snaps
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Elbow")
+		float elbowAngleInterpSpeed;
+
+	// How far the clavicle rotates per arm length that the hand is past half an arm length forward or up
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Shoulder")
+		float shoulderRotationMultiplier;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Shoulder")
+		float shoulderRotationLimitForward;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Shoulder")
+		float shoulderRotationLimitBackward;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Shoulder")
+		float shoulderRotationLimitUpward;
+
+	// Speed the body yaw follows the head yaw at, 0 snaps
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Shoulder")
+		float bodyYawInterpSpeed;
+
+	FArmSolverElbowSettings()
 	{
 		calcElbowAngle = true;
 		clampElbowAngle = true;
-		softClampElbowAngle = true;	
-		maxAngle = 175f, minAngle = 13f, softClampRange = 10f;
-		offsetAngle = 135f;
-		yWeight = -60f;                                                                
-		zWeightTop = 260, zWeightBottom = -100, zBorderY = -.25f, zDistanceStart = .6f;
-		xWeight = -50f, xDistanceStart = .1f;
+		softClampElbowAngle = true;
+		maxAngle = 175.f, minAngle = 13.f, softClampRange = 10.f;
+		offsetAngle = 135.f;
+		yWeight = -60.f;
+		zWeightTop = 260.f, zWeightBottom = -100.f, zBorderY = -.25f, zDistanceStart = .6f;
+		xWeight = -50.f, xDistanceStart = .1f;
+		elbowAngleInterpSpeed = 720.f;
+
+		shoulderRotationMultiplier = 30.f;
+		shoulderRotationLimitForward = 33.f, shoulderRotationLimitBackward = 0.f, shoulderRotationLimitUpward = 33.f;
+		bodyYawInterpSpeed = 10.f;
 	}
-};
\ No newline at end of file
+};
+
+/**
+* Structure of arrays input, state and output for solving many upper bodies in one pass.
+* Rig arrays are indexed by rig, arm arrays by rig within each side (0 left, 1 right). Everything is in world space and units.
+*/
+struct VREXPANSIONPLUGIN_API FArmSolverBatch
+{
+	// Inputs, per rig
+	TArray<FTransform> HeadTransforms;
+	TArray<FTransform> HandTransforms[2];
+	TArray<float> UpperArmLengths;
+	TArray<float> LowerArmLengths;
+	TArray<float> ShoulderHalfWidths;
+
+	// Distance of the shoulder line below the head, and behind it
+	TArray<float> NeckDrops;
+	TArray<float> NeckBackOffsets;
+	TArray<FArmSolverElbowSettings> Settings;
+
+	// State carried between solves, per rig
+	TArray<float> BodyYaws;
+	TArray<float> ElbowAngles[2];
+	TArray<bool> HasState;
+
+	// Outputs, per arm
+	TArray<FVector> ClaviclePositions[2];
+	TArray<FVector> ShoulderPositions[2];
+	TArray<FVector> ElbowPositions[2];
+	TArray<FVector> HandPositions[2];
+	TArray<bool> ReachClamped[2];
+
+	int32 Num() const { return HeadTransforms.Num(); }
+
+	// Adds a rig with default inputs, returns its index
+	int32 Add();
+
+	// Removes a rig by swapping the last one into its place
+	void RemoveAtSwap(int32 Index);
+
+	void Reset();
+
+	// Forgets the carried state so the next solve snaps
+	void ResetState(int32 Index) { HasState[Index] = false; }
+
+private:
+
+	template<typename FuncType>
+	void ForEachArray(FuncType Func)
+	{
+		Func(HeadTransforms); Func(HandTransforms[0]); Func(HandTransforms[1]);
+		Func(UpperArmLengths); Func(LowerArmLengths); Func(ShoulderHalfWidths); Func(NeckDrops); Func(NeckBackOffsets); Func(Settings);
+		Func(BodyYaws); Func(ElbowAngles[0]); Func(ElbowAngles[1]); Func(HasState);
+
+		for (int32 Side = 0; Side < 2; ++Side)
+		{
+			Func(ClaviclePositions[Side]); Func(ShoulderPositions[Side]); Func(ElbowPositions[Side]); Func(HandPositions[Side]); Func(ReachClamped[Side]);
+		}
+	}
+};
+
+/**
+* Estimates clavicle, shoulder and elbow placement from the HMD and controller transforms.
+* The body yaw follows the head, the clavicles rotate forward and up as the hands reach out past half an arm length,
+* and the elbow angle is picked from where the hand sits relative to the shoulder before the two bone solve places the elbow.
+*/
+class VREXPANSIONPLUGIN_API ArmSolver : public FArmSolverElbowSettings
+{
+
+public:
+
+	ArmSolver()
+	{
+	}
+
+	ArmSolver(const FArmSolverElbowSettings & InSettings) :
+		FArmSolverElbowSettings(InSettings)
+	{
+	}
+
+	// Target elbow angle for a hand position relative to the shoulder, LocalHandPosNormalized is in the settings y up / z forward / x right convention
+	float GetElbowTargetAngle(const FVector & LocalHandPosNormalized, bool bIsLeft) const;
+
+	// Keeps the angle within minAngle / maxAngle, softly if softClampElbowAngle is set
+	float ClampElbowAngle(float Angle) const;
+
+	// Solves a single rig of the batch
+	static void SolveRig(FArmSolverBatch & Batch, int32 RigIndex, float DeltaTime);
+
+	// Solves every rig, across task graph workers once there are at least ParallelThreshold of them (0 never goes parallel)
+	static void SolveBatch(FArmSolverBatch & Batch, float DeltaTime, int32 ParallelThreshold = 0);
+};
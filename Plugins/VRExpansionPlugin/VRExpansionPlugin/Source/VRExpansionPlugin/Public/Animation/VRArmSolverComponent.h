@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Animation/ArmSolver.h"
+#include "VRArmSolverComponent.generated.h"
+
+class USceneComponent;
+class USkeletalMeshComponent;
+class UVRArmSolverManager;
+
+// Latest solve of both arms, world space, 0 is the left arm and 1 the right
+struct VREXPANSIONPLUGIN_API FVRArmSolverResult
+{
+	bool bIsValid;
+	FVector ClaviclePositions[2];
+	FVector ShoulderPositions[2];
+	FVector ElbowPositions[2];
+	FVector HandPositions[2];
+	FQuat HandRotations[2];
+	bool bReachClamped[2];
+
+	FVRArmSolverResult() :
+		bIsValid(false)
+	{
+		for (int32 Side = 0; Side < 2; ++Side)
+		{
+			ClaviclePositions[Side] = ShoulderPositions[Side] = ElbowPositions[Side] = HandPositions[Side] = FVector::ZeroVector;
+			HandRotations[Side] = FQuat::Identity;
+			bReachClamped[Side] = false;
+		}
+	}
+};
+
+/**
+* Estimates the upper body of a VR character from its head and hands, for the VR Arm Solver anim node to apply.
+* All of the solver components in a world are solved together by the UVRArmSolverManager.
+* On a VRBaseCharacter the camera and motion controllers are used unless others are set.
+*/
+UCLASS(Blueprintable, meta = (BlueprintSpawnableComponent), ClassGroup = (VRExpansionPlugin))
+class VREXPANSIONPLUGIN_API UVRArmSolverComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UVRArmSolverComponent(const FObjectInitializer& ObjectInitializer);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRArmSolver")
+		FArmSolverElbowSettings ElbowSettings;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRArmSolver|Rig", meta = (ClampMin = "0.1", UIMin = "0.1"))
+		float UpperArmLength;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRArmSolver|Rig", meta = (ClampMin = "0.1", UIMin = "0.1"))
+		float LowerArmLength;
+
+	// Distance from the center of the chest to each shoulder
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRArmSolver|Rig", meta = (ClampMin = "0.0", UIMin = "0.0"))
+		float ShoulderHalfWidth;
+
+	// How far below the head the shoulder line sits
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRArmSolver|Rig")
+		float NeckDrop;
+
+	// How far behind the head the shoulder line sits
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRArmSolver|Rig")
+		float NeckBackOffset;
+
+	// Mesh that the solve is applied to, the owners first skeletal mesh if not set. Its animation waits on the solve.
+	UPROPERTY(BlueprintReadOnly, Category = "VRArmSolver")
+		USkeletalMeshComponent * TargetMesh;
+
+	UPROPERTY(BlueprintReadOnly, Category = "VRArmSolver")
+		USceneComponent * HeadComponent;
+
+	UPROPERTY(BlueprintReadOnly, Category = "VRArmSolver")
+		USceneComponent * LeftHandComponent;
+
+	UPROPERTY(BlueprintReadOnly, Category = "VRArmSolver")
+		USceneComponent * RightHandComponent;
+
+	UFUNCTION(BlueprintCallable, Category = "VRArmSolver")
+		void SetTrackedComponents(USceneComponent * NewHead, USceneComponent * NewLeftHand, USceneComponent * NewRightHand, USkeletalMeshComponent * NewTargetMesh = nullptr);
+
+	// Snaps the body yaw and elbows on the next solve, call after teleporting
+	UFUNCTION(BlueprintCallable, Category = "VRArmSolver")
+		void ResetSolverState();
+
+	UFUNCTION(BlueprintPure, Category = "VRArmSolver")
+		bool GetArmResult(bool bLeftArm, FVector & Clavicle, FVector & Shoulder, FVector & Elbow, FVector & Hand, bool & bReachClamped) const;
+
+	const FVRArmSolverResult & GetResult() const { return Result; }
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	friend class UVRArmSolverManager;
+
+	void FindDefaultComponents();
+
+	FVRArmSolverResult Result;
+
+	// Rig index in the managers batch, set by the manager
+	int32 SolverIndex;
+	bool bResetState;
+
+	TWeakObjectPtr<UVRArmSolverManager> Manager;
+};
@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Animation/ArmSolver.h"
+#include "VRArmSolverManager.generated.h"
+
+class UVRArmSolverComponent;
+class UVRArmSolverManager;
+
+/**
+* Tick function that runs the arm solver managers batch
+*/
+USTRUCT()
+struct VREXPANSIONPLUGIN_API FVRArmSolverTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	UVRArmSolverManager * Target;
+
+	FVRArmSolverTickFunction() :
+		Target(nullptr)
+	{}
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FVRArmSolverTickFunction> : public TStructOpsTypeTraitsBase2<FVRArmSolverTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+* Per world owner of the arm solver batch, every registered UVRArmSolverComponent is solved in one pass a frame.
+* Ticks after the heads and hands it reads from and before the meshes that consume the results.
+*/
+UCLASS(Transient)
+class VREXPANSIONPLUGIN_API UVRArmSolverManager : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UVRArmSolverManager(const FObjectInitializer& ObjectInitializer);
+
+	// Returns the manager for the world, only game worlds get one
+	static UVRArmSolverManager * Get(UWorld * World, bool bCreateIfMissing = true);
+
+	void RegisterSolver(UVRArmSolverComponent * Solver);
+	void UnregisterSolver(UVRArmSolverComponent * Solver);
+
+	void TickBatch(float DeltaTime);
+
+	int32 GetNumSolvers() const { return Solvers.Num(); }
+
+	virtual void BeginDestroy() override;
+
+private:
+
+	void AddPrerequisites(UVRArmSolverComponent * Solver);
+	void RemovePrerequisites(UVRArmSolverComponent * Solver);
+
+	// Same order as the batch rigs
+	UPROPERTY()
+	TArray<UVRArmSolverComponent *> Solvers;
+
+	FArmSolverBatch Batch;
+	FVRArmSolverTickFunction BatchTickFunction;
+};
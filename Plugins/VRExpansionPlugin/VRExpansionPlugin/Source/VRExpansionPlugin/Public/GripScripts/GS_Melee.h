@@ -3,6 +3,7 @@
 #include "CoreMinimal.h"
 #include "VRGripScriptBase.h"
 #include "GameFramework/WorldSettings.h"
+#include "WorldCollision.h"
 #include "GS_Melee.generated.h"
 
 
@@ -47,8 +48,24 @@ public:
 	bool bLodged;
 
 	FVector StrikeVelocity;
-	bool bSubstepTrace;
-	float MaxSubsteps;
+
+	// Splits the strike sweep into a time ordered chain along the interpolated arc, one segment per SubstepAngle degrees of rotation.
+	// A single sweep only moves the weapon in a straight line at its final rotation so fast swings skip over anything the arc passed through.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MeleeSettings|Strike")
+		bool bSubstepTrace;
+
+	// Upper limit on the segments of a single strike
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MeleeSettings|Strike", meta = (editcondition = "bSubstepTrace", ClampMin = "1", UIMin = "1"))
+		int32 MaxSubsteps;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MeleeSettings|Strike", meta = (editcondition = "bSubstepTrace", ClampMin = "1.00", UIMin = "1.00"))
+		float SubstepAngle;
+
+	// Queues the strike sweeps with the worlds async trace interface and handles their hits on the next frame instead of sweeping on the game thread.
+	// The world runs every async trace queued in a frame as one batch. Each sphere, box and capsule of the roots body is swept on its own,
+	// roots with convex elements, skinned roots and complex traces sweep on the game thread as the async interface can't take their geometry.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MeleeSettings|Strike")
+		bool bUseAsyncTraces;
 
 	float BaseDamage;
 	float VelocityDamageScaler;
@@ -106,10 +123,47 @@ public:
 	virtual void OnGripRelease_Implementation(UGripMotionControllerComponent * ReleasingController, const FBPActorGripInformation & GripInformation, bool bWasSocketed = false) override
 	{
 		//GetOwner()->OnActorHit.RemoveDynamic(this, &UGS_Melee::OnActorHit);
+		PendingSweeps.Reset();
 	}
 
 	//virtual void BeginPlay_Implementation() override;
 	virtual bool GetWorldTransform_Implementation(UGripMotionControllerComponent * GrippingController, float DeltaTime, FTransform & WorldTransform, const FTransform &ParentTransform, FBPActorGripInformation &Grip, AActor * actor, UPrimitiveComponent * root, bool bRootHasInterface, bool bActorHasInterface, bool bIsForTeleport) override;
 
+protected:
+
+	struct FMeleeSweepSegment
+	{
+		FTransform Start;
+		FTransform End;
+		// One per shape of the body when queued async
+		TArray<FTraceHandle, TInlineAllocator<4>> Handles;
+	};
+
+	// A simple element of the roots body, relative to the unscaled component transform
+	struct FMeleeSweepShape
+	{
+		FCollisionShape Shape;
+		FTransform LocalTransform;
+	};
+
+	struct FMeleeSweepHit
+	{
+		FHitResult Hit;
+		int32 Segment;
+		float TimeOfImpact;
+	};
+
+	// Async sweeps queued last frame, consumed on the next one
+	TArray<FMeleeSweepSegment> PendingSweeps;
+
+	void BuildSweepChain(const FTransform & From, const FTransform & To, TArray<FMeleeSweepSegment> & OutSegments) const;
+	void SweepChain(TArray<FMeleeSweepSegment> & Segments, UPrimitiveComponent * root, const FComponentQueryParams & Params, TArray<FMeleeSweepHit> & OutHits);
+	// Returns false if the body has geometry that the async interface can't sweep
+	bool GetAsyncSweepShapes(UPrimitiveComponent * root, const FComponentQueryParams & Params, TArray<FMeleeSweepShape, TInlineAllocator<4>> & OutShapes) const;
+	void QueueAsyncSweeps(TArray<FMeleeSweepSegment> & Segments, const TArray<FMeleeSweepShape, TInlineAllocator<4>> & Shapes, UPrimitiveComponent * root, const FComponentQueryParams & Params);
+	bool GatherAsyncHits(TArray<FMeleeSweepHit> & OutHits);
+
+	// Returns false if the weapon lodged into something and the grip transform shouldn't be applied
+	bool HandleStrikeHits(const TArray<FMeleeSweepHit> & Hits, const TArray<FMeleeSweepSegment> & Segments, UPrimitiveComponent * root);
 
 };
@@ -7,12 +7,16 @@
 #include "VRBPDatatypes.h"
 #include "Components/PrimitiveComponent.h"
 #include "GameFramework/Actor.h"
-#include "Tickable.h"
+#include "GripScripts/VRGripScriptScheduler.h"
 #include "Net/UnrealNetwork.h"
 
 #include "VRGripScriptBase.generated.h"
 
 class UGripMotionControllerComponent;
+class UVRGripScriptScheduler;
+class UActorChannel;
+class FOutBunch;
+struct FReplicationFlags;
 
 UENUM(Blueprintable)
 enum class EGSTransformOverrideType : uint8
@@ -27,10 +31,72 @@ enum class EGSTransformOverrideType : uint8
 	ModifiesWorldTransform
 };
 
+USTRUCT(BlueprintType, Category = "VRExpansionLibrary")
+struct VREXPANSIONPLUGIN_API FVRGripScriptReplicationSettings
+{
+	GENERATED_BODY()
+public:
+
+	// If true then the scripts are only sent until each connection acknowledges them, later changes are not replicated
+	// The stable named script references in GripLogicScripts act as the manifest, settings come from the archetype
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "VRGripScriptReplication")
+		bool bReplicateScriptsOnce;
+
+	FVRGripScriptReplicationSettings() :
+		bReplicateScriptsOnce(false)
+	{}
+};
+
+/**
+* Tracks what each connection has already received of a grippables GripLogicScripts so unchanged scripts are skipped.
+* Scripts are re-examined once a frame, a changed replicated property or MarkScriptReplicationDirty moves their revision.
+* Runtime only state, grippables keep it outside of their properties.
+*/
+struct VREXPANSIONPLUGIN_API FVRGripScriptReplicationTracker
+{
+	FVRGripScriptReplicationTracker() :
+		CachedRevision(0),
+		CachedRevisionFrame(0)
+	{}
+
+	// Call from ReplicateSubobjects in place of replicating each script directly
+	bool ReplicateScripts(const TArray<UVRGripScriptBase*> & Scripts, const FVRGripScriptReplicationSettings & Settings, UActorChannel * Channel, FOutBunch * Bunch, FReplicationFlags * RepFlags);
+
+	// The bookkeeping half of ReplicateScripts, returns false if the channel already has the current scripts.
+	// If it returns true the scripts are sent and EndReplication is told whether every one of them is acknowledged.
+	bool BeginReplication(const TArray<UVRGripScriptBase*> & Scripts, const FVRGripScriptReplicationSettings & Settings, UActorChannel * Channel, bool bNetInitial);
+	void EndReplication(UActorChannel * Channel, bool bAllAcknowledged);
+
+	int32 GetNumTrackedChannels() const { return ChannelRecords.Num(); }
+
+private:
+
+	struct FChannelRecord
+	{
+		// Channels are pooled, a re-opened channel has a new open packet and fresh replicators
+		int32 OpenPacketId;
+		uint32 Revision;
+		bool bAcknowledged;
+
+		FChannelRecord() :
+			OpenPacketId(INDEX_NONE),
+			Revision(0),
+			bAcknowledged(false)
+		{}
+	};
+
+	uint32 GetRevision(const TArray<UVRGripScriptBase*> & Scripts);
+
+	TMap<TWeakObjectPtr<UActorChannel>, FChannelRecord> ChannelRecords;
+	uint32 CachedRevision;
+	uint64 CachedRevisionFrame;
+};
+
 UCLASS(NotBlueprintable, BlueprintType, EditInlineNew, DefaultToInstanced, Abstract, ClassGroup = (VRExpansionPlugin), HideCategories = DefaultSettings)
-class VREXPANSIONPLUGIN_API UVRGripScriptBase : public UObject, public FTickableGameObject
+class VREXPANSIONPLUGIN_API UVRGripScriptBase : public UObject
 {
 	GENERATED_BODY()
+	friend class UVRGripScriptScheduler;
 public:
 
 	UVRGripScriptBase(const FObjectInitializer& ObjectInitializer);
@@ -90,13 +156,23 @@ public:
 	virtual bool Wants_DenyTeleport_Implementation();*/
 
 	virtual void GetLifetimeReplicatedProps(TArray< class FLifetimeProperty > & OutLifetimeProps) const override;
+
+	// Changes to replicated properties are picked up on their own, this forces the scripts to be re-sent anyway
+	UFUNCTION(BlueprintCallable, Category = "VRGripScript|Replication")
+		void MarkScriptReplicationDirty();
+
+	// Compares the replicated properties against what they were on the last call and bumps the revision if any changed
+	// Grippables call it once a frame before looking at the revision
+	void RefreshReplicationRevision();
+
+	uint32 GetReplicationRevision() const { return ReplicationRevision; }
 	
 	// doesn't currently compile in editor builds, not sure why the linker is screwing up there but works elsewhere
 	//virtual void PreReplication(IRepChangedPropertyTracker & ChangedPropertyTracker);
 	virtual bool CallRemoteFunction(UFunction * Function, void * Parms, FOutParmRec * OutParms, FFrame * Stack) override;
 	virtual int32 GetFunctionCallspace(UFunction * Function, FFrame * Stack) override;
 
-	// FTickableGameObject functions
+	// Tick functions, scripts are ticked in batches by the worlds UVRGripScriptScheduler
 	
 	
 	// If true then this scrip can tick when bAllowticking is true
@@ -104,28 +180,38 @@ public:
 		bool bCanEverTick;
 
 	// If true and we bCanEverTick, then will fire off the tick function
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Tick Settings")
+	// Blueprint sets go through SetTickEnabled, C++ should call it too as the scheduler isn't notified of direct changes
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, BlueprintSetter = SetTickEnabled, Category = "Tick Settings")
 		bool bAllowTicking;
 
+	// If true and we bCanEverTick, then will also tick while the owning object is held by a controller
+	UPROPERTY(BlueprintReadOnly, EditDefaultsOnly, Category = "Tick Settings")
+		bool bTickWhileHeld;
+
+	// When this script ticks relative to the controllers grip handling, read once when the script registers on BeginPlay
+	UPROPERTY(BlueprintReadOnly, EditDefaultsOnly, Category = "Tick Settings")
+		EVRGripScriptTickPhase TickPhase;
+
 	// Set whether the grip script can tick or not
 	UFUNCTION(BlueprintCallable, Category = "Tick Settings")
 		void SetTickEnabled(bool bTickEnabled);
 
 	/**
 	 * Function called every frame on this GripScript. Override this function to implement custom logic to be executed every frame.
-	 * Only executes if bCanEverTick is true and bAllowTicking is true
+	 * Only executes if bCanEverTick is true and bAllowTicking is true (or bTickWhileHeld is true and we are held)
 	 *
 	 * @param DeltaTime - The time since the last tick.
 	 */
-	virtual void Tick(float DeltaTime) override;
-	virtual bool IsTickable() const override;
-	virtual UWorld* GetTickableGameObjectWorld() const override;
-	virtual bool IsTickableInEditor() const;
-	virtual bool IsTickableWhenPaused() const override;
-	virtual ETickableTickType GetTickableTickType() const;
-	virtual TStatId GetStatId() const override;
+	virtual void Tick(float DeltaTime);
+	virtual bool IsTickable() const;
 
-	// End tickable object information
+	// Returns if the scheduler should currently have us in its awake list
+	bool ShouldBeAwake() const;
+
+	// Called by the gripping controller before OnGrip / OnGripRelease, tracks held state for bTickWhileHeld
+	void SetOwnerHeld(bool bIsHeld);
+
+	// End tick functions
 
 
 	// Returns the expected grip transform (relative * controller + addition)
@@ -201,6 +287,36 @@ public:
 	{
 		return GetWorldTransform_Implementation(OwningController, DeltaTime, WorldTransform, ParentTransform, Grip, actor, root, bRootHasInterface, bActorHasInterface, bIsForTeleport);
 	}
+
+	virtual void BeginDestroy() override;
+
+private:
+
+	// Scheduler bookkeeping, the batch is fixed once registered and the slot is INDEX_NONE while asleep
+	TWeakObjectPtr<UVRGripScriptScheduler> Scheduler;
+	int32 SchedulerBatchIndex;
+	int32 SchedulerSlot;
+
+	// Number of controllers currently holding our owner
+	int32 HeldCount;
+
+	// Bumped by MarkScriptReplicationDirty and RefreshReplicationRevision
+	uint32 ReplicationRevision;
+
+	// Copy of the replicated (blueprint) properties as of the last RefreshReplicationRevision
+	struct FReplicationShadowProperty
+	{
+		UProperty * Property;
+		int32 Offset;
+	};
+
+	TArray<FReplicationShadowProperty> ReplicationShadowProperties;
+	TArray<uint8> ReplicationShadow;
+	bool bReplicationShadowInitialized;
+
+	void DestroyReplicationShadow();
+
+	void RefreshTickState();
 };
 
 
@@ -0,0 +1,134 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "Engine/EngineBaseTypes.h"
+#include "VRGripScriptScheduler.generated.h"
+
+class UVRGripScriptBase;
+class UGripMotionControllerComponent;
+class UVRGripScriptScheduler;
+
+// When a grip script ticks relative to the motion controllers grip handling
+UENUM(BlueprintType)
+enum class EVRGripScriptTickPhase : uint8
+{
+	/** Before any motion controller has ticked its grips this frame */
+	PreGrip,
+
+	/** After every motion controller has ticked its grips this frame */
+	PostGrip,
+
+	/** After physics has run, closest to the old end of frame tickable timing */
+	PostPhysics,
+
+	MAX UMETA(Hidden)
+};
+
+/**
+* Tick function that runs one phase of the grip script scheduler
+*/
+USTRUCT()
+struct VREXPANSIONPLUGIN_API FVRGripScriptPhaseTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	UVRGripScriptScheduler * Target;
+	EVRGripScriptTickPhase Phase;
+
+	FVRGripScriptPhaseTickFunction() :
+		Target(nullptr),
+		Phase(EVRGripScriptTickPhase::PostPhysics)
+	{}
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FVRGripScriptPhaseTickFunction> : public TStructOpsTypeTraitsBase2<FVRGripScriptPhaseTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+* The awake scripts of a single class and phase, kept contiguous so a phase is a tight loop over each class in turn
+* Instances of one class with differing phases get a batch each. Batches are never removed, scripts cache their batch index when they register
+*/
+USTRUCT()
+struct VREXPANSIONPLUGIN_API FVRGripScriptClassBatch
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	UClass * ScriptClass;
+
+	EVRGripScriptTickPhase Phase;
+
+	// Entries are nulled instead of removed while the batch is ticking and compacted afterwards
+	UPROPERTY()
+	TArray<UVRGripScriptBase *> AwakeScripts;
+
+	FVRGripScriptClassBatch() :
+		ScriptClass(nullptr),
+		Phase(EVRGripScriptTickPhase::PostPhysics)
+	{}
+};
+
+/**
+* Per world scheduler for grip script ticking, replaces each script being its own tickable object.
+* Scripts register once on BeginPlay and then only move in and out of their class batch when they wake or sleep.
+* Phases are ordered against the motion controllers tick with prerequisites so the order no longer depends on registration.
+*/
+UCLASS(Transient)
+class VREXPANSIONPLUGIN_API UVRGripScriptScheduler : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UVRGripScriptScheduler(const FObjectInitializer& ObjectInitializer);
+
+	// Returns the scheduler for the world, only game worlds get one
+	static UVRGripScriptScheduler * Get(UWorld * World, bool bCreateIfMissing = true);
+
+	// Assigns the script its class batch and wakes it if it wants to tick
+	void RegisterScript(UVRGripScriptBase * Script);
+
+	// Removes the script for good, safe to call mid phase, it will not tick again
+	void UnregisterScript(UVRGripScriptBase * Script);
+
+	// Moves the script in or out of its batch depending on UVRGripScriptBase::ShouldBeAwake
+	void RefreshScript(UVRGripScriptBase * Script);
+
+	// Orders the phases around the controllers tick
+	void RegisterController(UGripMotionControllerComponent * Controller);
+	void UnregisterController(UGripMotionControllerComponent * Controller);
+
+	void TickPhase(EVRGripScriptTickPhase Phase, float DeltaTime);
+
+	int32 GetNumAwakeScripts(EVRGripScriptTickPhase Phase) const;
+
+	virtual void BeginDestroy() override;
+
+private:
+
+	void WakeScript(UVRGripScriptBase * Script);
+	void SleepScript(UVRGripScriptBase * Script);
+	void CompactBatches();
+	void UpdatePhaseTickEnabled(EVRGripScriptTickPhase Phase);
+
+	UPROPERTY()
+	TArray<FVRGripScriptClassBatch> Batches;
+
+	FVRGripScriptPhaseTickFunction PhaseTickFunctions[(uint8)EVRGripScriptTickPhase::MAX];
+	int32 NumAwakeScripts[(uint8)EVRGripScriptTickPhase::MAX];
+
+	bool bIsTickingPhase;
+	bool bHasNulledEntries;
+};
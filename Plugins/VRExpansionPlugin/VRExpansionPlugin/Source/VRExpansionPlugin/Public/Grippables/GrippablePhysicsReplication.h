@@ -30,112 +30,128 @@
 	TEXT(" 1: use the valve input controller. You will have to define input bindings for the controllers you want to support."),
 	ECVF_ReadOnly);*/
 
+// Per object error correction statistics for server side physics replication of client authed objects
+USTRUCT(BlueprintType, Category = "VRExpansionLibrary")
+struct VREXPANSIONPLUGIN_API FVRPhysicsReplicationErrorStats
+{
+	GENERATED_BODY()
+public:
+
+	// Linear distance to the extrapolated target on the last correction
+	UPROPERTY(BlueprintReadOnly, Category = "VRReplication")
+		float LinearError;
+
+	// Angle in degrees to the extrapolated target on the last correction
+	UPROPERTY(BlueprintReadOnly, Category = "VRReplication")
+		float AngularError;
+
+	// Largest linear error seen since the object started replicating
+	UPROPERTY(BlueprintReadOnly, Category = "VRReplication")
+		float MaxLinearError;
+
+	// One way ping that was used to extrapolate the target, in seconds
+	UPROPERTY(BlueprintReadOnly, Category = "VRReplication")
+		float PingSecondsOneWay;
+
+	// Time that the error has failed to resolve, hard snaps once it reaches the limit
+	UPROPERTY(BlueprintReadOnly, Category = "VRReplication")
+		float AccumulatedErrorSeconds;
+
+	UPROPERTY(BlueprintReadOnly, Category = "VRReplication")
+		int32 NumCorrections;
+
+	UPROPERTY(BlueprintReadOnly, Category = "VRReplication")
+		int32 NumHardSnaps;
+
+	FVRPhysicsReplicationErrorStats() :
+		LinearError(0.0f),
+		AngularError(0.0f),
+		MaxLinearError(0.0f),
+		PingSecondsOneWay(0.0f),
+		AccumulatedErrorSeconds(0.0f),
+		NumCorrections(0),
+		NumHardSnaps(0)
+	{}
+};
+
 #if WITH_PHYSX
 class FPhysicsReplicationVR : public FPhysicsReplication
 {
 public:
 
 	FPhysicsReplicationVR(FPhysScene* PhysScene);
+	virtual ~FPhysicsReplicationVR();
 	static bool IsInitialized();
 
-	virtual void OnTick(float DeltaSeconds, TMap<TWeakObjectPtr<UPrimitiveComponent>, FReplicatedPhysicsTarget>& ComponentsToTargets) override
-	{
-		// Skip all of the custom logic if we aren't the server
-		if (const UWorld* World = GetOwningWorld())
-		{
-			if (World->GetNetMode() == ENetMode::NM_Client)
-			{
-				return FPhysicsReplication::OnTick(DeltaSeconds, ComponentsToTargets);
-			}
-		}
+	// Returns the last correction statistics for the component while the worlds replication is correcting it
+	static bool GetErrorStats(const UPrimitiveComponent * Component, FVRPhysicsReplicationErrorStats & OutStats);
 
-		const FRigidBodyErrorCorrection& PhysicErrorCorrection = UPhysicsSettings::Get()->PhysicErrorCorrection;
+	virtual void OnTick(float DeltaSeconds, TMap<TWeakObjectPtr<UPrimitiveComponent>, FReplicatedPhysicsTarget>& ComponentsToTargets) override;
 
-		// Get the ping between this PC & the server
-		const float LocalPing = 0.0f;//GetLocalPing();
+protected:
 
-		float CurrentTimeSeconds = 0.0f;
-
-		if (UWorld* OwningWorld = GetOwningWorld())
-		{
-			CurrentTimeSeconds = OwningWorld->GetTimeSeconds();
-		}
+	// Error correction tunables, resolved once per tick instead of per object
+	struct FCachedErrorCorrection
+	{
+		float PingExtrapolation;
+		float PingLimit;
+		float ErrorPerLinearDiff;
+		float ErrorPerAngularDiff;
+		float MaxRestoredStateError;
+		float ErrorAccumulationSeconds;
+		float ErrorAccumulationDistanceSq;
+		float ErrorAccumulationSimilarity;
+		float PositionLerp;
+		float LinearVelocityCoefficient;
+		float AngleLerp;
+		float AngularVelocityCoefficient;
+		float MaxLinearHardSnapDistance;
+		bool bAlwaysHardSnap;
+		bool bSkipSkeletalRepOptimization;
+
+		void Gather(const FRigidBodyErrorCorrection & ErrorCorrection);
+	};
 
-		for (auto Itr = ComponentsToTargets.CreateIterator(); Itr; ++Itr)
-		{
+	enum ECorrectionResult : uint8
+	{
+		Correction_None = 0,
+		Correction_Interpolate = 1 << 0,
+		Correction_HardSnap = 1 << 1,
+		Correction_Restored = 1 << 2,
+		Correction_Sleep = 1 << 3
+	};
 
-			// Its been more than half a second since the last update, lets cease using the target as a failsafe
-			// Clients will never update with that much latency, and if they somehow are, then they are dropping so many
-			// packets that it will be useless to use their data anyway
-			if ((CurrentTimeSeconds - Itr.Value().ArrivedTimeSeconds) > 0.5f)
-			{
-				OnTargetRestored(Itr.Key().Get(), Itr.Value());
-				Itr.RemoveCurrent();
-			}
-			else if (UPrimitiveComponent* PrimComp = Itr.Key().Get())
-			{
-				bool bRemoveItr = false;
+	// Structure of arrays for every target being corrected this tick, gathered, solved, then applied in separate passes
+	struct FCorrectionBatch
+	{
+		TArray<TWeakObjectPtr<UPrimitiveComponent>> Keys;
+		TArray<UPrimitiveComponent *> Components;
+		TArray<FBodyInstance *> Bodies;
+		TArray<FReplicatedPhysicsTarget *> Targets;
+		TArray<float> PingSecondsOneWay;
+		TArray<FRigidBodyState> CurrentStates;
+		TArray<FVector> TargetPositions;
+		TArray<FQuat> TargetRotations;
+		TArray<FTransform> NewTransforms;
+		TArray<FVector> NewLinearVelocities;
+		TArray<FVector> NewAngularVelocities;
+		TArray<uint8> Results;
+
+		void Reset();
+		int32 Add(const TWeakObjectPtr<UPrimitiveComponent> & Key, UPrimitiveComponent * Component, FBodyInstance * Body, FReplicatedPhysicsTarget * Target, float PingOneWay, const FRigidBodyState & CurrentState);
+	};
 
-				if (FBodyInstance* BI = PrimComp->GetBodyInstance(Itr.Value().BoneName))
-				{
-					FReplicatedPhysicsTarget& PhysicsTarget = Itr.Value();
-					FRigidBodyState& UpdatedState = PhysicsTarget.TargetState;
-					bool bUpdated = false;
-					if (AActor* OwningActor = PrimComp->GetOwner())
-					{
-						// Deleted everything here, we will always be the server, I already filtered out clients to default logic
-						{
-							/*const*/ float OwnerPing = 0.0f;// GetOwnerPing(OwningActor, PhysicsTarget);
-					
-							/*if (UPlayer* OwningPlayer = OwningActor->GetNetOwningPlayer())
-							{
-								if (APlayerController* PlayerController = OwningPlayer->GetPlayerController(nullptr))
-								{
-									if (APlayerState* PlayerState = PlayerController->PlayerState)
-									{
-										OwnerPing = PlayerState->ExactPing;
-									}
-								}
-							}*/
-
-							// Get the total ping - this approximates the time since the update was
-							// actually generated on the machine that is doing the authoritative sim.
-							// NOTE: We divide by 2 to approximate 1-way ping from 2-way ping.
-							const float PingSecondsOneWay = 0.0f;// (LocalPing + OwnerPing) * 0.5f * 0.001f;
-
-
-							if (UpdatedState.Flags & ERigidBodyFlags::NeedsUpdate)
-							{
-								const bool bRestoredState = ApplyRigidBodyState(DeltaSeconds, BI, PhysicsTarget, PhysicErrorCorrection, PingSecondsOneWay);
-
-								// Need to update the component to match new position.
-								static const auto CVarSkipSkeletalRepOptimization = IConsoleManager::Get().FindConsoleVariable(TEXT("p.SkipSkeletalRepOptimization"));
-								if (/*PhysicsReplicationCVars::SkipSkeletalRepOptimization*/CVarSkipSkeletalRepOptimization->GetInt() == 0 || Cast<USkeletalMeshComponent>(PrimComp) == nullptr)	//simulated skeletal mesh does its own polling of physics results so we don't need to call this as it'll happen at the end of the physics sim
-								{
-									PrimComp->SyncComponentToRBPhysics();
-								}
-
-								// Added a sleeping check from the input state as well, we always want to cease activity on sleep
-								if (bRestoredState || ((UpdatedState.Flags & ERigidBodyFlags::Sleeping) != 0))
-								{
-									bRemoveItr = true;
-								}
-							}
-						}
-					}
-				}
+	float GetCachedOwnerPing(const AActor * OwningActor);
 
-				if (bRemoveItr)
-				{
-					OnTargetRestored(Itr.Key().Get(), Itr.Value());
-					Itr.RemoveCurrent();
-				}
-			}
-		}
+	// Only reads the gathered states and targets, the bodies are left alone until ApplyBatch
+	void SolveBatch(float DeltaSeconds);
+	void ApplyBatch();
 
-		//GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Red, TEXT("Phys Rep Tick!"));
-		//FPhysicsReplication::OnTick(DeltaSeconds, ComponentsToTargets);
-	}
+	FCachedErrorCorrection CachedSettings;
+	FCorrectionBatch Batch;
+	TArray<TWeakObjectPtr<UPrimitiveComponent>> TargetsToRemove;
+	TMap<const UPlayer *, float> CachedOwnerPings;
+	TMap<TWeakObjectPtr<UPrimitiveComponent>, FVRPhysicsReplicationErrorStats> ErrorStats;
 };
 
 class IPhysicsReplicationFactoryVR : public IPhysicsReplicationFactory
@@ -37,6 +37,13 @@ public:
 	UPROPERTY(EditAnywhere, Replicated, BlueprintReadOnly, Instanced, Category = "VRGripInterface")
 		TArray<class UVRGripScriptBase *> GripLogicScripts;
 
+	// How the GripLogicScripts are replicated
+	UPROPERTY(EditAnywhere, Category = "VRGripInterface")
+		FVRGripScriptReplicationSettings GripScriptReplication;
+
+	// Per connection tracking of the GripLogicScripts replication
+	FVRGripScriptReplicationTracker GripScriptReplicationTracker;
+
 	bool ReplicateSubobjects(UActorChannel* Channel, class FOutBunch *Bunch, FReplicationFlags *RepFlags) override;
 
 	// Sets the Deny Gripping variable on the FBPInterfaceSettings struct
@@ -15,6 +15,8 @@
 //General Advanced Sessions Log
 DECLARE_LOG_CATEGORY_EXTERN(VRInteractibleFunctionLibraryLog, Log, All);
 
+DECLARE_STATS_GROUP(TEXT("VRInteractibles"), STATGROUP_VRInteractibles, STATCAT_Advanced);
+
 // Declares our interactible axis's
 UENUM(Blueprintable)
 enum class EVRInteractibleAxis : uint8
@@ -55,6 +57,46 @@ public:
 	FTransform ReversedRelativeTransform;
 };
 
+// Tick sleep state of an interactible component
+// Interactibles put their tick to sleep once they have settled (not held and done lerping) and are woken back up by
+// grips, overlaps and replicated state changes. A global count of awake / sleeping interactibles is kept for profiling.
+struct VREXPANSIONPLUGIN_API FVRInteractibleSleepState
+{
+public:
+
+	FVRInteractibleSleepState() :
+		bIsRegistered(false),
+		bIsAwake(false)
+	{}
+
+	// Starts counting the interactible, call from OnRegister
+	void Register(UActorComponent * Interactible);
+
+	// Stops counting the interactible, call from OnUnregister
+	void Unregister();
+
+	// Enables the interactibles tick
+	void Wake(UActorComponent * Interactible);
+
+	// Disables the interactibles tick
+	void Sleep(UActorComponent * Interactible);
+
+	FORCEINLINE bool IsAwake() const { return bIsAwake; }
+
+	static int32 GetNumAwake() { return NumAwake; }
+	static int32 GetNumSleeping() { return NumSleeping; }
+
+private:
+
+	void SetAwake(bool bNewAwake);
+
+	bool bIsRegistered;
+	bool bIsAwake;
+
+	static int32 NumAwake;
+	static int32 NumSleeping;
+};
+
 UCLASS()
 class VREXPANSIONPLUGIN_API UVRInteractibleFunctionLibrary : public UBlueprintFunctionLibrary
 {
@@ -182,6 +224,14 @@ public:
 		return vec;
 	}
 
+	// Returns how many interactibles are currently ticking (awake) and how many have put their tick to sleep
+	UFUNCTION(BlueprintPure, Category = "VRInteractibleFunctions")
+	static void Interactible_GetSleepCounts(int32 & NumAwake, int32 & NumSleeping)
+	{
+		NumAwake = FVRInteractibleSleepState::GetNumAwake();
+		NumSleeping = FVRInteractibleSleepState::GetNumSleeping();
+	}
+
 	// Get current parent transform
 	UFUNCTION(BlueprintPure, Category = "VRInteractibleFunctions", meta = (bIgnoreSelf = "true"))
 	static FTransform Interactible_GetCurrentParentTransform(USceneComponent * SceneComponentToCheck)
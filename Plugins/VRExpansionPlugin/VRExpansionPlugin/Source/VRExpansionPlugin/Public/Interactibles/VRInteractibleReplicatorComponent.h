@@ -0,0 +1,174 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Engine/NetSerialization.h"
+#include "VRInteractibleReplicatorComponent.generated.h"
+
+class UVRInteractibleReplicatorComponent;
+struct FVRInteractibleStateArray;
+
+// Quantized state of a single interactible, the meaning of the values depends on the interactible type
+//	Lever	: primary axis angle, or the pitch / roll (/ yaw for flight sticks) of the dual axis modes
+//	Dial	: dial angle, signed within its clockwise / counter clockwise limits unless it can turn all the way around
+//	Slider	: slider progress
+//	Button	: button state
+USTRUCT()
+struct VREXPANSIONPLUGIN_API FVRInteractibleQuantizedState
+{
+	GENERATED_BODY()
+public:
+
+	static const int32 MaxValues = 3;
+
+	// Sorted position of the interactible under the actor
+	uint16 ComponentIndex;
+	uint8 NumValues;
+	uint8 BitsPerValue;
+	uint32 Values[MaxValues];
+
+	FVRInteractibleQuantizedState() :
+		ComponentIndex(0),
+		NumValues(0),
+		BitsPerValue(1)
+	{
+		FMemory::Memzero(Values);
+	}
+
+	bool operator==(const FVRInteractibleQuantizedState & Other) const
+	{
+		if (ComponentIndex != Other.ComponentIndex || NumValues != Other.NumValues || BitsPerValue != Other.BitsPerValue)
+			return false;
+
+		for (int32 i = 0; i < NumValues; ++i)
+		{
+			if (Values[i] != Other.Values[i])
+				return false;
+		}
+
+		return true;
+	}
+
+	bool operator!=(const FVRInteractibleQuantizedState & Other) const
+	{
+		return !(*this == Other);
+	}
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits< FVRInteractibleQuantizedState > : public TStructOpsTypeTraitsBase2<FVRInteractibleQuantizedState>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+USTRUCT()
+struct VREXPANSIONPLUGIN_API FVRInteractibleStateItem : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+public:
+
+	UPROPERTY()
+	FVRInteractibleQuantizedState State;
+
+	void PostReplicatedAdd(const FVRInteractibleStateArray & InArraySerializer);
+	void PostReplicatedChange(const FVRInteractibleStateArray & InArraySerializer);
+};
+
+USTRUCT()
+struct VREXPANSIONPLUGIN_API FVRInteractibleStateArray : public FFastArraySerializer
+{
+	GENERATED_BODY()
+public:
+
+	UPROPERTY()
+	TArray<FVRInteractibleStateItem> Items;
+
+	// Not replicated, set by the owning replicator on both ends
+	UVRInteractibleReplicatorComponent * Owner;
+
+	FVRInteractibleStateArray() :
+		Owner(nullptr)
+	{}
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo & DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FVRInteractibleStateItem, FVRInteractibleStateArray>(Items, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits< FVRInteractibleStateArray > : public TStructOpsTypeTraitsBase2<FVRInteractibleStateArray>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true
+	};
+};
+
+/**
+* Replicates the state of every lever, dial, slider and button under its actor as a single fast array of quantized values.
+* Only entries whose quantized value changed are sent, and late joiners get the full array with the actor.
+* Values are quantized over each interactibles own configured range, with its snap increment as the step when it always snaps,
+* so the interactibles need to be configured identically on the server and clients (as they are when they come from the actor class).
+* Interactibles are matched up by sorting them by name, only ones with net stable names are gathered.
+*/
+UCLASS(Blueprintable, meta = (BlueprintSpawnableComponent), ClassGroup = (VRExpansionPlugin))
+class VREXPANSIONPLUGIN_API UVRInteractibleReplicatorComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UVRInteractibleReplicatorComponent(const FObjectInitializer& ObjectInitializer);
+
+	// Number of steps that a value is split into when the interactible has no snap increment to go by
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "VRInteractibleReplicator", meta = (ClampMin = "1", ClampMax = "65535", UIMin = "1", UIMax = "65535"))
+		int32 DefaultStepCount;
+
+	// If true the interactibles stop replicating their movement and, unless they replicate gameplay tags, stop replicating entirely.
+	// Their initial relative transforms are then no longer sent, so any runtime change to them has to be made on the clients as well.
+	// Buttons have no gameplay tags and keep replicating, only their movement is turned off.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "VRInteractibleReplicator")
+		bool bTakeOverComponentReplication;
+
+	// Re-gathers the interactibles under the actor, call on the server and the clients after adding or removing one
+	UFUNCTION(BlueprintCallable, Category = "VRInteractibleReplicator")
+		void RefreshInteractibles();
+
+	UFUNCTION(BlueprintPure, Category = "VRInteractibleReplicator")
+		int32 GetNumInteractibles() const { return Interactibles.Num(); }
+
+	virtual void BeginPlay() override;
+	virtual void PreReplication(IRepChangedPropertyTracker & ChangedPropertyTracker) override;
+
+	// Quantizes the current state of an interactible, returns false if it is not a supported type
+	bool QuantizeInteractible(USceneComponent * Interactible, FVRInteractibleQuantizedState & OutState) const;
+
+	// Applies a received state to the matching interactible, non server authority buttons only take their initial state
+	void ApplyState(const FVRInteractibleQuantizedState & State, bool bIsInitial);
+
+	static uint32 GetBitsForSteps(uint32 Steps);
+	static uint32 QuantizeValue(float Value, float MinValue, float MaxValue, uint32 Steps);
+	static float DequantizeValue(uint32 Quantized, float MinValue, float MaxValue, uint32 Steps);
+
+protected:
+
+	UPROPERTY(Replicated)
+		FVRInteractibleStateArray ReplicatedStates;
+
+	TArray<TWeakObjectPtr<USceneComponent>> Interactibles;
+
+	// Re-quantizes every interactible that isn't held and marks the entries that changed, bForceAll rebuilds the array
+	void UpdateReplicatedStates(bool bForceAll);
+
+private:
+
+	// Steps used for an interactible, the snap count if it always snaps, otherwise DefaultStepCount
+	uint32 GetStepCount(USceneComponent * Interactible) const;
+};
@@ -177,6 +177,10 @@ public:
 
 	// Resetting the initial transform here so that it comes in prior to BeginPlay and save loading.
 	virtual void OnRegister() override;
+	virtual void PostRepNotifies() override;
+
+	// Tick sleep tracking, the tick is disabled whenever we have settled
+	FVRInteractibleSleepState SleepState;
 
 	// Now replicating this so that it works correctly over the network
 	UPROPERTY(BlueprintReadOnly, ReplicatedUsing = OnRep_InitialRelativeTransform, Category = "VRLeverComponent")
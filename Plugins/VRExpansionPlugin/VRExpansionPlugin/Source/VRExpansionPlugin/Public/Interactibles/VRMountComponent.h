@@ -48,6 +48,9 @@ public:
 	// Resetting the initial transform here so that it comes in prior to BeginPlay and save loading.
 	virtual void OnRegister() override;
 
+	// Tick sleep tracking, the tick is disabled whenever we have settled
+	FVRInteractibleSleepState SleepState;
+
 	FTransform InitialRelativeTransform;
 	FVector InitialInteractorLocation;
 	FVector InitialInteractorDropLocation;
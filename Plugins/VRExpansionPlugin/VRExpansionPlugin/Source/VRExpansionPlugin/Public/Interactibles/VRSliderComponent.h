@@ -36,6 +36,65 @@ enum class EVRInteractibleSliderDropBehavior : uint8
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FVRSliderHitPointSignature, float, SliderProgressPoint);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FVRSliderFinishedLerpingSignature, float, FinalProgress);
 
+/**
+* Arc length lookup table for a spline, sampled at uniform distances along it in the splines local space.
+* The segments between the samples are kept in an implicit bounding volume hierarchy so that closest point
+* queries don't have to walk the entire spline, and a hint key lets queries start from last frames result.
+* Only rebuilt when the spline curves change.
+*/
+struct VREXPANSIONPLUGIN_API FVRSliderSplineLookup
+{
+public:
+
+	FVRSliderSplineLookup() :
+		SplineLength(0.0f),
+		SampleSpacing(0.0f),
+		SplineVersion(0),
+		NumSplinePoints(0),
+		bClosedLoop(false)
+	{}
+
+	// Returns true if the table was built from the current state of the spline
+	bool IsValidFor(const USplineComponent * Spline, float DesiredSampleSpacing) const;
+
+	void Build(const USplineComponent * Spline, float DesiredSampleSpacing);
+	void Reset();
+
+	// Closest input key to a location in the splines local space, HintKey < 0 skips the temporal coherence seed
+	float FindInputKeyClosestToLocalLocation(const FVector & LocalLocation, float HintKey) const;
+
+	// Input key at a distance along the spline, constant time as the samples are uniform in distance
+	float GetInputKeyAtDistance(float Distance) const;
+
+	FORCEINLINE float GetSplineLength() const { return SplineLength; }
+	FORCEINLINE bool HasSamples() const { return SampleKeys.Num() > 1; }
+
+private:
+
+	struct FBVHNode
+	{
+		FBox Bounds;
+		int32 FirstSegment;
+		int32 NumSegments;
+		int32 ChildIndex; // Left child, right child follows it, INDEX_NONE for leaves
+	};
+
+	void BuildNode(int32 NodeIndex, int32 FirstSegment, int32 NumSegments);
+	void TestSegment(int32 SegmentIndex, const FVector & LocalLocation, float & BestDistSq, int32 & BestSegment, float & BestAlpha) const;
+	int32 FindSegmentForKey(float InputKey) const;
+
+	TArray<FVector> SampleLocations;
+	TArray<float> SampleKeys;
+	TArray<FBVHNode> Nodes;
+
+	TWeakObjectPtr<const USplineComponent> SourceSpline;
+	float SplineLength;
+	float SampleSpacing;
+	uint32 SplineVersion;
+	int32 NumSplinePoints;
+	bool bClosedLoop;
+};
+
 /**
 * A slider component, can act like a scroll bar, or gun bolt, or spline following component
 */
@@ -134,6 +193,19 @@ public:
 	float LastInputKey;
 	float LerpedKey;
 
+	// Distance between the samples of the spline lookup table used for closest point queries while following a spline
+	// Smaller values are more accurate for tightly curved splines, 0 disables the table and uses the default spline searches
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRSliderComponent", meta = (ClampMin = "0", UIMin = "0"))
+		float SplineLookupSampleSpacing;
+
+	FVRSliderSplineLookup SplineLookup;
+
+	// Rebuilds the lookup table if the spline has changed, returns false if it can't be used
+	bool UpdateSplineLookup();
+
+	float FindSplineInputKeyClosestToWorldLocation(const FVector & WorldLocation, float HintKey = -1.0f);
+	float GetSplineInputKeyAtDistance(float Distance);
+
 	// Type of lerp to use when following a spline
 	// For lerping I would suggest using ConstantTo in general as it will be the smoothest.
 	// Normal Interp will change speed based on distance, that may also have its uses.
@@ -158,6 +230,10 @@ public:
 
 	// Resetting the initial transform here so that it comes in prior to BeginPlay and save loading.
 	virtual void OnRegister() override;
+	virtual void OnUnregister() override;
+
+	// Tick sleep tracking, the tick is disabled whenever we have settled
+	FVRInteractibleSleepState SleepState;
 
 	// Now replicating this so that it works correctly over the network
 	UPROPERTY(BlueprintReadOnly, ReplicatedUsing = OnRep_InitialRelativeTransform, Category = "VRSliderComponent")
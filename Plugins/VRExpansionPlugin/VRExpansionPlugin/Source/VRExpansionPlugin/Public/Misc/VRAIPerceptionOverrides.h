@@ -159,6 +159,36 @@ struct FAISightQueryVR
 	};
 };
 
+// Uniform grid over observed target locations, used by the sight broadphase to only
+// gather targets that are near a listener instead of pairing it with every target
+struct FAISightTargetGridVR
+{
+	float CellSize;
+	TMap<FIntVector, TArray<FAISightTargetVR::FTargetId>> Cells;
+
+	FAISightTargetGridVR() : CellSize(1000.f) {}
+
+	FORCEINLINE FIntVector GetCell(const FVector& Location) const
+	{
+		return FIntVector(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize), FMath::FloorToInt(Location.Z / CellSize));
+	}
+
+	void Reset(float InCellSize);
+	void AddTarget(FAISightTargetVR::FTargetId TargetId, const FVector& Location);
+
+	// Returns all targets in cells overlapping the sphere, callers still need to do an exact distance check
+	void GatherTargetsInRadius(const FVector& Center, float Radius, TArray<FAISightTargetVR::FTargetId>& OutTargets) const;
+};
+
+// Live query counts for the sight sense, theoretical pairs is what the sense would have generated without the broadphase
+struct FAISightQueryStatsVR
+{
+	int32 LiveQueries;
+	int32 TheoreticalPairs;
+
+	FAISightQueryStatsVR() : LiveQueries(0), TheoreticalPairs(0) {}
+};
+
 UCLASS(ClassGroup = AI, config = Game)
 class VREXPANSIONPLUGIN_API UAISense_Sight_VR : public UAISense
 {
@@ -169,6 +199,7 @@ public:
 	{
 		float PeripheralVisionAngleCos;
 		float SightRadiusSq;
+		float BroadphaseRadius;
 		float AutoSuccessRangeSqFromLastSeenLocation;
 		float LoseSightRadiusSq;
 		uint8 AffiliationFlags;
@@ -177,6 +208,12 @@ public:
 		FDigestedSightProperties(const UAISenseConfig_Sight_VR& SenseConfig);
 	};
 
+	// Query scores are sorted into fixed width buckets instead of being fully compared
+	// Age grows by whole ticks and Importance is clamped to MaxQueryImportance so scores stay in a small range,
+	// anything past the last bucket has been starved long enough that its exact order doesn't matter
+	static const int32 SortBucketsPerScoreUnit = 4;
+	static const int32 NumSortBuckets = 1024;
+
 	typedef TMap<FAISightTargetVR::FTargetId, FAISightTargetVR> FTargetsContainer;
 	FTargetsContainer ObservedTargets;
 	TMap<FPerceptionListenerID, FDigestedSightProperties> DigestedProperties;
@@ -206,8 +243,38 @@ protected:
 
 	ECollisionChannel DefaultSightCollisionChannel;
 
+	// If true then sight queries are only created for listener / target pairs that are within LoseSightRadius (plus padding)
+	// Pairs are re-evaluated on the BroadphaseUpdateInterval so targets moving into range get their queries then
+	UPROPERTY(EditDefaultsOnly, Category = "AI Perception|Broadphase", config)
+		bool bUseSightBroadphase;
+
+	// Size of the uniform grid cells used to gather targets near a listener
+	UPROPERTY(EditDefaultsOnly, Category = "AI Perception|Broadphase", config, meta = (ClampMin = "1.0", UIMin = "1.0"))
+		float BroadphaseCellSize;
+
+	// Extra distance added to LoseSightRadius so targets moving between broadphase updates still have a query ready
+	UPROPERTY(EditDefaultsOnly, Category = "AI Perception|Broadphase", config, meta = (ClampMin = "0.0", UIMin = "0.0"))
+		float BroadphaseRangePadding;
+
+	// How often (in seconds) pairs are re-evaluated against the grid
+	UPROPERTY(EditDefaultsOnly, Category = "AI Perception|Broadphase", config, meta = (ClampMin = "0.0", UIMin = "0.0"))
+		float BroadphaseUpdateInterval;
+
+	double LastBroadphaseUpdateTime;
+	FAISightTargetGridVR TargetGrid;
+	FAISightQueryStatsVR QueryStats;
+
+	// Scratch buffers kept around to avoid re-allocating them every sort / broadphase pass
+	TArray<int32> SortBucketOffsets;
+	TArray<FAISightQueryVR> SortScratchQueue;
+	TSet<uint64> BroadphaseExistingPairs;
+	TArray<FAISightTargetVR::FTargetId> BroadphaseCandidates;
+
 public:
 
+	// Returns the current live query count vs the count of all possible listener / target pairs
+	FORCEINLINE const FAISightQueryStatsVR& GetQueryStats() const { return QueryStats; }
+
 	virtual void PostInitProperties() override;
 
 	void RegisterEvent(const FAISightEventVR& Event);
@@ -245,7 +312,18 @@ protected:
 	bool RegisterTarget(AActor& TargetActor, FQueriesOperationPostProcess PostProcess);
 	bool RegisterTarget(AActor& TargetActor, FQueriesOperationPostProcess PostProcess, TFunctionRef<void(FAISightQueryVR&)> OnAddedFunc);
 
-	FORCEINLINE void SortQueries() { SightQueryQueue.Sort(FAISightQueryVR::FSortPredicate()); }
+	// Bucketed (counting) sort of the queue by score, ordering matches FAISightQueryVR::FSortPredicate down to the bucket resolution
+	void SortQueries();
+
+	// Creates queries for pairs that moved into range and drops idle queries for pairs that moved out of it
+	void UpdateBroadphase();
+	bool IsInBroadphaseRange(const FPerceptionListener& Listener, const FDigestedSightProperties& PropDigest, const FVector& TargetLocation) const;
+	bool IsInBroadphaseRange(const FVector& ListenerLocation, const FDigestedSightProperties& PropDigest, const FVector& TargetLocation) const;
+
+	// Out of range queries are kept while the target is still seen (the query has to run to report the loss)
+	// or while it can still be automatically seen from its last seen location
+	bool CanDropOutOfRangeQuery(const FAISightQueryVR& SightQuery, const FVector& ListenerLocation, const FDigestedSightProperties& PropDigest, const FVector& TargetLocation) const;
+	void UpdateQueryStats();
 
 	float CalcQueryImportance(const FPerceptionListener& Listener, const FVector& TargetLocation, const float SightRadiusSq) const;
 };
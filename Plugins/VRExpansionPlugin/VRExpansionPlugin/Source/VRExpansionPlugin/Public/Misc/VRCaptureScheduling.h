@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VRCaptureScheduling.generated.h"
+
+/**
+* How a scheduled scene capture competes for the per frame capture budget.
+* Captures are ranked by how much of the view the displaying surface covers, how close to the center of the view it is and how
+* near it is, each weighted here. The ranking is multiplied by the time since the last capture so that low ranked captures still refresh eventually.
+*/
+USTRUCT(BlueprintType, Category = "VRExpansionLibrary")
+struct VREXPANSIONPLUGIN_API FVRCaptureScheduleSettings
+{
+	GENERATED_BODY()
+public:
+
+	// Captures per second that are guaranteed regardless of ranking, 0 only captures when ranked high enough
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "CaptureSchedule", meta = (ClampMin = "0.0", UIMin = "0"))
+		float MinRefreshRate;
+
+	// Captures per second that are never exceeded, 0 is unlimited
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "CaptureSchedule", meta = (ClampMin = "0.0", UIMin = "0"))
+		float MaxRefreshRate;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "CaptureSchedule", meta = (ClampMin = "0.0", UIMin = "0"))
+		float CoverageWeight;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "CaptureSchedule", meta = (ClampMin = "0.0", UIMin = "0"))
+		float ViewAngleWeight;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "CaptureSchedule", meta = (ClampMin = "0.0", UIMin = "0"))
+		float DistanceWeight;
+
+	// Distance at which the distance ranking falls off to nothing
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "CaptureSchedule", meta = (ClampMin = "1.0", UIMin = "1"))
+		float MaxRankingDistance;
+
+	FVRCaptureScheduleSettings() :
+		MinRefreshRate(2.0f),
+		MaxRefreshRate(90.0f),
+		CoverageWeight(1.0f),
+		ViewAngleWeight(0.5f),
+		DistanceWeight(0.25f),
+		MaxRankingDistance(2000.0f)
+	{}
+};
+
+// The view that captures are ranked against, gathered once a frame
+struct VREXPANSIONPLUGIN_API FVRCaptureScheduleView
+{
+	bool bIsValid;
+	FVector Location;
+	FVector Forward;
+	float TanHalfFOV;
+
+	FVRCaptureScheduleView() :
+		bIsValid(false),
+		Location(FVector::ZeroVector),
+		Forward(FVector::ForwardVector),
+		TanHalfFOV(1.0f)
+	{}
+};
+
+struct VREXPANSIONPLUGIN_API FVRCaptureScheduleEntry
+{
+	FVRCaptureScheduleSettings Settings;
+
+	// Bounding sphere of the surface that displays the capture
+	FVector Center;
+	float Radius;
+
+	bool bHasCaptured;
+	float LastCaptureTime;
+
+	FVRCaptureScheduleEntry() :
+		Center(FVector::ZeroVector),
+		Radius(0.0f),
+		bHasCaptured(false),
+		LastCaptureTime(0.0f)
+	{}
+};
+
+/**
+* Picks which captures get to update each frame, knows nothing of the components or the renderer.
+* Overdue captures (past their min refresh rate, or never captured) go first, most overdue first, the rest of the budget goes to the
+* highest ranked. A capture with a min refresh rate is therefore never starved for longer than its interval plus the time it takes the
+* budget to work through the other overdue captures.
+*/
+class VREXPANSIONPLUGIN_API FVRCaptureScheduler
+{
+public:
+
+	TArray<FVRCaptureScheduleEntry> Entries;
+
+	// Fills OutSelected with the entries to capture this frame in submission order and marks them as captured
+	void SelectCaptures(const FVRCaptureScheduleView & View, float CurrentTime, int32 MaxCaptures, TArray<int32> & OutSelected);
+
+	// Ranking of an entry for the view, without the time since its last capture
+	static float GetViewRanking(const FVRCaptureScheduleView & View, const FVRCaptureScheduleEntry & Entry);
+
+private:
+
+	struct FCandidate
+	{
+		int32 Index;
+		float Urgency;
+		bool bOverdue;
+
+		bool operator<(const FCandidate & Other) const
+		{
+			if (bOverdue != Other.bOverdue)
+				return bOverdue;
+
+			return Urgency > Other.Urgency;
+		}
+	};
+
+	// Kept between frames to avoid re-allocating
+	TArray<FCandidate> Candidates;
+};
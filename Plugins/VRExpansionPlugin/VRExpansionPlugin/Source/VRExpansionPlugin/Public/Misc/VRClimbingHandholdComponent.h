@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SceneComponent.h"
+#include "VRClimbingHandholdComponent.generated.h"
+
+/**
+* Marks a climbable area of a surface for the native climbing in UVRBaseCharacterMovementComponent.
+* Grips are anchored to this component, so it must be net addressable (part of a replicated actor or a static level actor)
+* for the server to resolve the same handhold as the client.
+*/
+UCLASS(Blueprintable, meta = (BlueprintSpawnableComponent), ClassGroup = (VRExpansionPlugin))
+class VREXPANSIONPLUGIN_API UVRClimbingHandholdComponent : public USceneComponent
+{
+	GENERATED_BODY()
+
+public:
+	UVRClimbingHandholdComponent(const FObjectInitializer& ObjectInitializer);
+
+	// If false grips can not be started on this handhold, existing grips are not released
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRClimbing")
+		bool bCanBeClimbed;
+
+	// Half size of the grabbable box in component space, grip points outside of it are pulled onto its surface
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRClimbing", meta = (ClampMin = "0.0", UIMin = "0"))
+		FVector HandholdExtent;
+
+	// Returns the component space anchor for a grip at this world location
+	UFUNCTION(BlueprintPure, Category = "VRClimbing")
+		FVector GetLocalAnchor(FVector WorldGripLocation) const;
+};
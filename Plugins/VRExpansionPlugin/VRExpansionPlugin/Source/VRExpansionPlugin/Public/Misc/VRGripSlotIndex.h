@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtr.h"
+
+class USceneComponent;
+
+/**
+* The sockets of a single mesh that match a slot type (substring match, ignoring case, same as the old socket name walk)
+* Locations are only cached for meshes whose socket transforms don't change at runtime (static meshes), they are
+* kept sorted on X so that range queries only have to test the sockets that overlap the query range on that axis.
+*/
+struct VREXPANSIONPLUGIN_API FVRGripSlotTypeIndex
+{
+	FName SlotType;
+	TArray<FName> SocketNames;
+	TArray<FVector> ComponentSpaceLocations;
+
+	// Returns the index of the closest slot to the location within the range, or INDEX_NONE
+	int32 FindClosestInRange(const FVector& ComponentSpaceLocation, float MaxRangeSq) const;
+};
+
+/**
+* Per mesh slot index, built on first query and re-used for every component using that mesh
+*/
+struct VREXPANSIONPLUGIN_API FVRGripSlotMeshIndex
+{
+	TWeakObjectPtr<const UObject> Mesh;
+
+	// Used to detect socket additions / removals on the asset
+	int32 NumSockets;
+
+	// If false socket transforms depend on the component (bone attached sockets) and have to be queried from it
+	bool bHasStaticSocketTransforms;
+
+	TArray<FVRGripSlotTypeIndex> SlotTypes;
+
+	FVRGripSlotMeshIndex() :
+		NumSockets(0),
+		bHasStaticSocketTransforms(false)
+	{}
+};
+
+class VREXPANSIONPLUGIN_API FVRGripSlotIndexCache
+{
+public:
+
+	// Finds the closest slot of the given type to the world location that is within MaxRange of it
+	// Falls back to walking the sockets directly for components that don't have a mesh asset to index
+	static bool GetClosestSlotInRange(FName SlotType, USceneComponent * Component, const FVector& WorldLocation, float MaxRange, FTransform & SlotWorldTransform);
+
+	// Builds the index for the slot type on the components mesh ahead of the first query
+	static void PrewarmComponent(USceneComponent * Component, FName SlotType);
+
+	// Drops the cached index for the mesh, it will be rebuilt on the next query
+	static void InvalidateMesh(const UObject * Mesh);
+
+	static void Reset();
+
+	static void StartupCache();
+	static void ShutdownCache();
+
+private:
+
+	static const UObject * GetIndexableMesh(const USceneComponent * Component, bool & bOutHasStaticSocketTransforms, int32 & OutNumSockets);
+	static const FVRGripSlotTypeIndex * FindOrBuildSlotTypeIndex(USceneComponent * Component, FName SlotType, bool & bOutHasStaticSocketTransforms);
+
+#if WITH_EDITOR
+	static void OnObjectPropertyChanged(UObject * Object, struct FPropertyChangedEvent & PropertyChangedEvent);
+	static FDelegateHandle OnObjectPropertyChangedHandle;
+#endif
+
+	static TMap<const UObject *, FVRGripSlotMeshIndex> MeshIndices;
+};
@@ -8,6 +8,9 @@
 #include "Engine/Console.h"
 #include "Containers/UnrealString.h"
 #include "Core/Public/Misc/OutputDeviceHelper.h"
+#include "Containers/Queue.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Containers/Ticker.h"
 #include "VRLogComponent.generated.h"
 
 /**
@@ -23,40 +26,63 @@ enum class EBPVRConsoleDrawType : uint8
 
 
 /**
-* A single log message for the output log, holding a message and
+* A single (already wrapped) line of the output log, holding the line, the text to draw for it and
 * a style, for color and bolding of the message.
 */
 struct FVRLogMessage
 {
-	TSharedRef<FString> Message;
+	FString Message;
+	FText DisplayText;
 	ELogVerbosity::Type Verbosity;
 	FName Category;
 	FName Style;
 
-	FVRLogMessage(const TSharedRef<FString>& NewMessage, FName NewCategory, FName NewStyle = NAME_None)
-		: Message(NewMessage)
-		, Verbosity(ELogVerbosity::Log)
+	FVRLogMessage()
+		: Verbosity(ELogVerbosity::Log)
+	{
+	}
+
+	FVRLogMessage(FString&& NewMessage, ELogVerbosity::Type NewVerbosity, FName NewCategory, FName NewStyle = NAME_None)
+		: Message(MoveTemp(NewMessage))
+		, Verbosity(NewVerbosity)
 		, Category(NewCategory)
 		, Style(NewStyle)
 	{
+		DisplayText = FText::FromString(Message);
 	}
+};
+
+/**
+* A raw message as it came in from the log, queued until the game thread wraps it into lines
+*/
+struct FVRPendingLogMessage
+{
+	FString Message;
+	ELogVerbosity::Type Verbosity;
+	FName Category;
 
-	FVRLogMessage(const TSharedRef<FString>& NewMessage, ELogVerbosity::Type NewVerbosity, FName NewCategory, FName NewStyle = NAME_None)
+	FVRPendingLogMessage()
+		: Verbosity(ELogVerbosity::Log)
+	{
+	}
+
+	FVRPendingLogMessage(const TCHAR* NewMessage, ELogVerbosity::Type NewVerbosity, FName NewCategory)
 		: Message(NewMessage)
 		, Verbosity(NewVerbosity)
 		, Category(NewCategory)
-		, Style(NewStyle)
 	{
 	}
 };
 
 // Custom Log output history class to hold the VR logs.
-/** This class is to capture all log output even if the log window is closed */
+/** This class is to capture all log output even if the log window is closed
+*	Serialize can be called from any thread, it only pushes into a lock free queue which the game thread drains
+*	into a fixed size ring of pre-wrapped lines off of the core ticker every frame (FlushPendingMessages), whether or not anything is drawn.
+*/
 class FVROutputLogHistory : public FOutputDevice
 {
 public:
 
-	int32 MaxStoredMessages;
 	bool bIsDirty;
 	int32 MaxLineLength;
 
@@ -65,12 +91,18 @@ public:
 		MaxLineLength = 130;
 		bIsDirty = false;
 		MaxStoredMessages = 1000;
+		PendingMessageLimit.Set(MaxStoredMessages);
+		RingHead = 0;
+		RingCount = 0;
 		GLog->AddOutputDevice(this);
 		GLog->SerializeBacklog(this);
+		TickHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FVROutputLogHistory::Tick), 0.0f);
 	}
 
 	~FVROutputLogHistory()
 	{
+		FTicker::GetCoreTicker().RemoveTicker(TickHandle);
+
 		// At shutdown, GLog may already be null
 		if (GLog != NULL)
 		{
@@ -78,115 +110,221 @@ public:
 		}
 	}
 
-	/** Gets all captured messages */
-	const TArray< TSharedPtr<FVRLogMessage> >& GetMessages() const
+	/** Game thread only, the ring is resized on the next flush */
+	void SetMaxStoredMessages(int32 NewMaxStoredMessages)
 	{
-		return Messages;
+		MaxStoredMessages = FMath::Max(NewMaxStoredMessages, 1);
+
+		// Logging threads only ever read this copy
+		PendingMessageLimit.Set(MaxStoredMessages);
 	}
 
-protected:
+	FORCEINLINE int32 GetMaxStoredMessages() const
+	{
+		return MaxStoredMessages;
+	}
 
-	virtual void Serialize(const TCHAR* V, ELogVerbosity::Type Verbosity, const class FName& Category) override
+	// We only enqueue in Serialize so we can take messages directly from other threads
+	virtual bool CanBeUsedOnAnyThread() const override
+	{
+		return true;
+	}
+
+	/** Moves all messages logged since the last call into the line history, game thread only
+	*	Returns true if new lines were added */
+	bool FlushPendingMessages()
 	{
-		// Capture all incoming messages and store them in history
-		CreateLogMessages(V, Verbosity, Category, Messages);
+		check(IsInGameThread());
+
+		if (LineRing.Num() != MaxStoredMessages)
+		{
+			// Capacity changed, start over with the new size
+			LineRing.Reset();
+			LineRing.SetNum(FMath::Max(MaxStoredMessages, 1));
+			RingHead = 0;
+			RingCount = 0;
+		}
+
+		bool bAddedLines = false;
+
+		const int32 NumDropped = NumDroppedMessages.Reset();
+		if (NumDropped > 0)
+		{
+			AddLine(FString::Printf(TEXT("VRLog: %d messages dropped, history was not flushed in time"), NumDropped), ELogVerbosity::Warning, NAME_None, FName(TEXT("Log.Warning")));
+			bAddedLines = true;
+		}
+
+		FVRPendingLogMessage PendingMessage;
+		while (PendingMessages.Dequeue(PendingMessage))
+		{
+			NumPendingMessages.Decrement();
+			bAddedLines |= CreateLogMessages(PendingMessage);
+		}
+
+		if (bAddedLines)
+			bIsDirty = true;
+
+		return bAddedLines;
 	}
 
-	bool CreateLogMessages(const TCHAR* V, ELogVerbosity::Type Verbosity, const class FName& Category, TArray< TSharedPtr<FVRLogMessage> >& OutMessages)
+	/** Number of stored lines */
+	FORCEINLINE int32 NumLines() const
+	{
+		return RingCount;
+	}
+
+	/** Gets a stored line, 0 is the oldest one */
+	FORCEINLINE const FVRLogMessage& GetLine(int32 Index) const
+	{
+		check(Index >= 0 && Index < RingCount);
+		return LineRing[(RingHead + Index) % LineRing.Num()];
+	}
+
+protected:
+
+	virtual void Serialize(const TCHAR* V, ELogVerbosity::Type Verbosity, const class FName& Category) override
 	{
 		if (Verbosity == ELogVerbosity::SetColor)
 		{
 			// Skip Color Events
-			return false;
+			return;
+		}
+
+		// The game thread isn't draining the queue (hitched or shutting down), don't let it grow without bounds
+		if (NumPendingMessages.GetValue() >= PendingMessageLimit.GetValue())
+		{
+			NumDroppedMessages.Increment();
+			return;
+		}
+
+		NumPendingMessages.Increment();
+		PendingMessages.Enqueue(FVRPendingLogMessage(V, Verbosity, Category));
+	}
+
+	void AddLine(FString&& Line, ELogVerbosity::Type Verbosity, FName Category, FName Style)
+	{
+		int32 Index;
+		if (RingCount < LineRing.Num())
+		{
+			Index = (RingHead + RingCount) % LineRing.Num();
+			++RingCount;
 		}
 		else
 		{
-			FName Style;
-			if (Category == NAME_Cmd)
-			{
-				Style = FName(TEXT("Log.Command"));
-			}
-			else if (Verbosity == ELogVerbosity::Error)
-			{
-				Style = FName(TEXT("Log.Error"));
-			}
-			else if (Verbosity == ELogVerbosity::Warning)
-			{
-				Style = FName(TEXT("Log.Warning"));
-			}
-			else
-			{
-				Style = FName(TEXT("Log.Normal"));
-			}
+			// Full, overwrite the oldest line
+			Index = RingHead;
+			RingHead = (RingHead + 1) % LineRing.Num();
+		}
 
-			// Forget timestamps, I don't care about them and we have limited texture space to draw too
-			// Determine how to format timestamps
-			static ELogTimes::Type LogTimestampMode = ELogTimes::None;
-			/*if (UObjectInitialized() && !GExitPurge)
-			{
-			// Logging can happen very late during shutdown, even after the UObject system has been torn down, hence the init check above
-			LogTimestampMode = GetDefault<UEditorStyleSettings>()->LogTimestampMode;
-			}*/
+		LineRing[Index] = FVRLogMessage(MoveTemp(Line), Verbosity, Category, Style);
+	}
 
-			const int32 OldNumMessages = OutMessages.Num();
+	bool CreateLogMessages(const FVRPendingLogMessage& PendingMessage)
+	{
+		const ELogVerbosity::Type Verbosity = PendingMessage.Verbosity;
+		const FName Category = PendingMessage.Category;
+
+		FName Style;
+		if (Category == NAME_Cmd)
+		{
+			Style = FName(TEXT("Log.Command"));
+		}
+		else if (Verbosity == ELogVerbosity::Error)
+		{
+			Style = FName(TEXT("Log.Error"));
+		}
+		else if (Verbosity == ELogVerbosity::Warning)
+		{
+			Style = FName(TEXT("Log.Warning"));
+		}
+		else
+		{
+			Style = FName(TEXT("Log.Normal"));
+		}
+
+		// Forget timestamps, I don't care about them and we have limited texture space to draw too
+		// Determine how to format timestamps
+		static ELogTimes::Type LogTimestampMode = ELogTimes::None;
+		/*if (UObjectInitialized() && !GExitPurge)
+		{
+		// Logging can happen very late during shutdown, even after the UObject system has been torn down, hence the init check above
+		LogTimestampMode = GetDefault<UEditorStyleSettings>()->LogTimestampMode;
+		}*/
 
-			// handle multiline strings by breaking them apart by line
-			TArray<FTextRange> LineRanges;
-			FString CurrentLogDump = V;
-			FTextRange::CalculateLineRangesFromString(CurrentLogDump, LineRanges);
+		bool bAddedLines = false;
 
-			bool bIsFirstLineInMessage = true;
-			for (const FTextRange& LineRange : LineRanges)
+		// handle multiline strings by breaking them apart by line
+		TArray<FTextRange> LineRanges;
+		const FString& CurrentLogDump = PendingMessage.Message;
+		FTextRange::CalculateLineRangesFromString(CurrentLogDump, LineRanges);
+
+		bool bIsFirstLineInMessage = true;
+		for (const FTextRange& LineRange : LineRanges)
+		{
+			if (!LineRange.IsEmpty())
 			{
-				if (!LineRange.IsEmpty())
+				FString Line = CurrentLogDump.Mid(LineRange.BeginIndex, LineRange.Len());
+				Line = Line.ConvertTabsToSpaces(4);
+
+				// Hard-wrap lines to avoid them being too long
+				/*static const */int32 HardWrapLen = MaxLineLength;
+				for (int32 CurrentStartIndex = 0; CurrentStartIndex < Line.Len();)
 				{
-					FString Line = CurrentLogDump.Mid(LineRange.BeginIndex, LineRange.Len());
-					Line = Line.ConvertTabsToSpaces(4);
+					int32 HardWrapLineLen = 0;
+					if (bIsFirstLineInMessage)
+					{
+						FString MessagePrefix = FOutputDeviceHelper::FormatLogLine(Verbosity, Category, nullptr, LogTimestampMode);
 
-					// Hard-wrap lines to avoid them being too long
-					/*static const */int32 HardWrapLen = MaxLineLength;
-					for (int32 CurrentStartIndex = 0; CurrentStartIndex < Line.Len();)
+						HardWrapLineLen = FMath::Min(HardWrapLen - MessagePrefix.Len(), Line.Len() - CurrentStartIndex);
+						FString HardWrapLine = Line.Mid(CurrentStartIndex, HardWrapLineLen);
+
+						AddLine(MessagePrefix + HardWrapLine, Verbosity, Category, Style);
+					}
+					else
 					{
-						int32 HardWrapLineLen = 0;
-						if (bIsFirstLineInMessage)
-						{
-							FString MessagePrefix = FOutputDeviceHelper::FormatLogLine(Verbosity, Category, nullptr, LogTimestampMode);
-
-							HardWrapLineLen = FMath::Min(HardWrapLen - MessagePrefix.Len(), Line.Len() - CurrentStartIndex);
-							FString HardWrapLine = Line.Mid(CurrentStartIndex, HardWrapLineLen);
-
-							OutMessages.Add(MakeShareable(new FVRLogMessage(MakeShareable(new FString(MessagePrefix + HardWrapLine)), Verbosity, Category, Style)));
-						}
-						else
-						{
-							HardWrapLineLen = FMath::Min(HardWrapLen, Line.Len() - CurrentStartIndex);
-							FString HardWrapLine = Line.Mid(CurrentStartIndex, HardWrapLineLen);
-
-							OutMessages.Add(MakeShareable(new FVRLogMessage(MakeShareable(new FString(MoveTemp(HardWrapLine))), Verbosity, Category, Style)));
-						}
-
-						bIsFirstLineInMessage = false;
-						CurrentStartIndex += HardWrapLineLen;
+						HardWrapLineLen = FMath::Min(HardWrapLen, Line.Len() - CurrentStartIndex);
+						FString HardWrapLine = Line.Mid(CurrentStartIndex, HardWrapLineLen);
+
+						AddLine(MoveTemp(HardWrapLine), Verbosity, Category, Style);
 					}
-				}
-			}
 
-			int numMessages = OutMessages.Num();
-			if (numMessages > MaxStoredMessages)
-			{
-				OutMessages.RemoveAt(0, numMessages - MaxStoredMessages, true);
+					bAddedLines = true;
+					bIsFirstLineInMessage = false;
+					CurrentStartIndex += HardWrapLineLen;
+				}
 			}
-			if (OldNumMessages != numMessages)
-				bIsDirty = true;
-
-			return OldNumMessages != numMessages;//OutMessages.Num();
 		}
+
+		return bAddedLines;
 	}
 
 private:
 
-	/** All log messages since this module has been started */
-	TArray< TSharedPtr<FVRLogMessage> > Messages;
+	bool Tick(float DeltaTime)
+	{
+		if (NumPendingMessages.GetValue() > 0 || NumDroppedMessages.GetValue() > 0)
+			FlushPendingMessages();
+
+		return true;
+	}
+
+	/** Ring capacity, game thread only */
+	int32 MaxStoredMessages;
+
+	/** Copy of MaxStoredMessages for Serialize to read from any thread */
+	FThreadSafeCounter PendingMessageLimit;
+
+	FDelegateHandle TickHandle;
+
+	/** Messages logged since the last flush, filled from any thread */
+	TQueue<FVRPendingLogMessage, EQueueMode::Mpsc> PendingMessages;
+	FThreadSafeCounter NumPendingMessages;
+	FThreadSafeCounter NumDroppedMessages;
+
+	/** Fixed size ring of wrapped lines, RingHead is the oldest */
+	TArray<FVRLogMessage> LineRing;
+	int32 RingHead;
+	int32 RingCount;
 };
 
 /**
@@ -209,7 +347,7 @@ public:
 	virtual void PostInitProperties() override
 	{
 		Super::PostInitProperties();
-		OutputLogHistory.MaxStoredMessages = FMath::Clamp(MaxStoredMessages, 100, 100000);
+		OutputLogHistory.SetMaxStoredMessages(FMath::Clamp(MaxStoredMessages, 100, 100000));
 		OutputLogHistory.MaxLineLength = FMath::Clamp(MaxLineLength, 50, 1000);
 	}
 
@@ -239,4 +377,11 @@ public:
 	void DrawConsole(bool bLowerHalfOnly, UCanvas* Canvas);
 	void DrawOutputLog(bool bUpperHalfOnly, UCanvas* Canvas, float ScrollOffset);
 
+private:
+
+	int32 GetOutputLogScrollPos(float ScrollOffset) const;
+
+	// Scroll position of the last output log draw, a change requires a redraw even without new lines
+	int32 LastDrawnScrollPos;
+
 };
\ No newline at end of file
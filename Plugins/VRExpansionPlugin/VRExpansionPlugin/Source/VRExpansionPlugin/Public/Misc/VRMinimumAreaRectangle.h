@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/ArrayView.h"
+#include "VRMinimumAreaRectangle.generated.h"
+
+// Enclosing rectangle of a point set, world space
+USTRUCT(BlueprintType, Category = "VRExpansionLibrary")
+struct VREXPANSIONPLUGIN_API FVRMinimumAreaRectangle
+{
+	GENERATED_BODY()
+public:
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MinimumAreaRectangle")
+		bool bIsValid;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MinimumAreaRectangle")
+		FVector Center;
+
+	// X runs along SideLengthX and Z is the plane normal
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MinimumAreaRectangle")
+		FRotator Rotation;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MinimumAreaRectangle")
+		float SideLengthX;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MinimumAreaRectangle")
+		float SideLengthY;
+
+	// Counter clockwise around the plane normal
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MinimumAreaRectangle")
+		TArray<FVector> Corners;
+
+	FVRMinimumAreaRectangle() :
+		bIsValid(false),
+		Center(FVector::ZeroVector),
+		Rotation(FRotator::ZeroRotator),
+		SideLengthX(0.0f),
+		SideLengthY(0.0f)
+	{}
+};
+
+// Blueprint wrapper for a point set, nested arrays can't be exposed directly
+USTRUCT(BlueprintType, Category = "VRExpansionLibrary")
+struct VREXPANSIONPLUGIN_API FVRMinimumAreaRectanglePoints
+{
+	GENERATED_BODY()
+public:
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MinimumAreaRectangle")
+		TArray<FVector> Points;
+};
+
+// Fit in the 2D space of the plane, Axis is the unit direction of the X side and the Y side is its counter clockwise perpendicular
+struct VREXPANSIONPLUGIN_API FMinAreaRect2D
+{
+	bool bIsValid;
+	FVector2D Center;
+	FVector2D Axis;
+	FVector2D Extent;
+
+	FMinAreaRect2D() :
+		bIsValid(false),
+		Center(FVector2D::ZeroVector),
+		Axis(1.0f, 0.0f),
+		Extent(FVector2D::ZeroVector)
+	{}
+
+	float GetArea() const { return 4.0f * Extent.X * Extent.Y; }
+};
+
+// Buffers re-used across fits, keep one around when fitting repeatedly
+struct VREXPANSIONPLUGIN_API FMinAreaRectScratch
+{
+	TArray<FVector2D> Points;
+	TArray<FVector2D> Sorted;
+	TArray<FVector2D> Hull;
+};
+
+namespace MinimumAreaRectangle
+{
+	/**
+	* Convex hull of the points counter clockwise, without duplicate or collinear points (monotone chain, O(n log n)).
+	* SortScratch receives a sorted copy of the points, OutHull is only grown when needed.
+	*/
+	VREXPANSIONPLUGIN_API void ComputeHull(TArrayView<const FVector2D> Points, TArray<FVector2D> & SortScratch, TArray<FVector2D> & OutHull);
+
+	// Rotating calipers over a hull from ComputeHull, O(h). Every edge is tested, including the closing one.
+	VREXPANSIONPLUGIN_API FMinAreaRect2D FitHull(const TArray<FVector2D> & Hull);
+
+	VREXPANSIONPLUGIN_API FMinAreaRect2D Fit(TArrayView<const FVector2D> Points, FMinAreaRectScratch & Scratch);
+
+	// Plane basis the existing blueprint node has always used, Z is the approximate normal of the points facing SampleSurfaceNormal
+	VREXPANSIONPLUGIN_API FMatrix ComputeBasis(const TArray<FVector> & InVerts, const FVector & SampleSurfaceNormal);
+
+	// Projects the points onto the XY plane of Basis and fits them there
+	VREXPANSIONPLUGIN_API bool Fit(const TArray<FVector> & InVerts, const FMatrix & Basis, FVRMinimumAreaRectangle & OutRect, FMinAreaRectScratch & Scratch);
+}
@@ -0,0 +1,194 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VRNetCorrectionPolicy.generated.h"
+
+/**
+* Scales network smoothing of simulated characters by how large the correction was and how many arrived recently.
+* Small frequent corrections (leaning into walls) are stretched out so they don't chatter, large ones are allowed to
+* resolve faster but never above the max correction speed.
+*/
+USTRUCT(BlueprintType, Category = "VRExpansionLibrary")
+struct VREXPANSIONPLUGIN_API FVRAdaptiveSmoothingSettings
+{
+	GENERATED_BODY()
+public:
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AdaptiveSmoothing")
+		bool bUseAdaptiveSmoothing;
+
+	// Errors at or below this distance use the small error values
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AdaptiveSmoothing", meta = (ClampMin = "0.0", UIMin = "0"))
+		float SmallErrorDistance;
+
+	// Errors at or above this distance use the large error values, between the two they are blended
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AdaptiveSmoothing", meta = (ClampMin = "0.0", UIMin = "0"))
+		float LargeErrorDistance;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AdaptiveSmoothing", meta = (ClampMin = "0.0", UIMin = "0"))
+		float SmallErrorSmoothTime;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AdaptiveSmoothing", meta = (ClampMin = "0.0", UIMin = "0"))
+		float LargeErrorSmoothTime;
+
+	// Max speed in cm/s the visual offset is allowed to close at for small errors, 0 is unlimited
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AdaptiveSmoothing", meta = (ClampMin = "0.0", UIMin = "0"))
+		float SmallErrorMaxCorrectionSpeed;
+
+	// Max speed in cm/s the visual offset is allowed to close at for large errors, 0 is unlimited
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AdaptiveSmoothing", meta = (ClampMin = "0.0", UIMin = "0"))
+		float LargeErrorMaxCorrectionSpeed;
+
+	// Time in seconds it takes the correction history to fall off to nothing
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AdaptiveSmoothing", meta = (ClampMin = "0.01", UIMin = "0.01"))
+		float HistoryDecayTime;
+
+	// Smooth time is multiplied by 1 + (this * recent corrections)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AdaptiveSmoothing", meta = (ClampMin = "0.0", UIMin = "0"))
+		float HistorySmoothTimeScale;
+
+	// Cap on the number of recent corrections that count towards the history scale
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AdaptiveSmoothing", meta = (ClampMin = "0.0", UIMin = "0"))
+		float MaxHistoryWeight;
+
+	FVRAdaptiveSmoothingSettings() :
+		bUseAdaptiveSmoothing(false),
+		SmallErrorDistance(5.0f),
+		LargeErrorDistance(100.0f),
+		SmallErrorSmoothTime(0.08f),
+		LargeErrorSmoothTime(0.3f),
+		SmallErrorMaxCorrectionSpeed(150.0f),
+		LargeErrorMaxCorrectionSpeed(600.0f),
+		HistoryDecayTime(1.0f),
+		HistorySmoothTimeScale(0.5f),
+		MaxHistoryWeight(4.0f)
+	{}
+
+	// Gets the smoothing time and max correction speed to use for an error of this size
+	void Evaluate(float ErrorDistance, float HistoryWeight, float & OutSmoothTime, float & OutMaxCorrectionSpeed) const;
+};
+
+/**
+* Decaying count of recent corrections
+*/
+struct VREXPANSIONPLUGIN_API FVRCorrectionHistory
+{
+	float Weight;
+	float LastCorrectionTime;
+
+	FVRCorrectionHistory() :
+		Weight(0.0f),
+		LastCorrectionTime(0.0f)
+	{}
+
+	float GetWeight(float CurrentTime, float DecayTime) const;
+	void AddCorrection(float CurrentTime, float DecayTime);
+
+	void Reset()
+	{
+		Weight = 0.0f;
+		LastCorrectionTime = 0.0f;
+	}
+};
+
+/**
+* Resolves large corrections of the locally controlled character with a blink instead of a visible slide or pop.
+*/
+USTRUCT(BlueprintType, Category = "VRExpansionLibrary")
+struct VREXPANSIONPLUGIN_API FVRComfortCorrectionSettings
+{
+	GENERATED_BODY()
+public:
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ComfortCorrection")
+		bool bUseComfortCorrections;
+
+	// Corrections shorter than this are applied as normal
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ComfortCorrection", meta = (ClampMin = "0.0", UIMin = "0"))
+		float MinCorrectionDistance;
+
+	// If false only the OnComfortCorrection event is fired so that the game can run its own vignette / blink
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ComfortCorrection")
+		bool bFadeCamera;
+
+	// Time to fade back in from the fade color
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ComfortCorrection", meta = (ClampMin = "0.0", UIMin = "0"))
+		float FadeDuration;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ComfortCorrection")
+		FLinearColor FadeColor;
+
+	FVRComfortCorrectionSettings() :
+		bUseComfortCorrections(false),
+		MinCorrectionDistance(15.0f),
+		bFadeCamera(true),
+		FadeDuration(0.2f),
+		FadeColor(FLinearColor::Black)
+	{}
+};
+
+/**
+* Server side coalescing of small client corrections.
+* Positional errors below the small distance are held back for up to the window, if the client converges on its own in
+* that time nothing is sent, otherwise the servers state at the end of the window goes out as a single adjustment.
+*/
+USTRUCT(BlueprintType, Category = "VRExpansionLibrary")
+struct VREXPANSIONPLUGIN_API FVRCorrectionThrottleSettings
+{
+	GENERATED_BODY()
+public:
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "CorrectionThrottle")
+		bool bCoalesceSmallCorrections;
+
+	// Positional errors below this distance are coalesced, anything larger is sent immediately
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "CorrectionThrottle", meta = (ClampMin = "0.0", UIMin = "0"))
+		float SmallCorrectionDistance;
+
+	// Max time in seconds a small correction is held back for
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "CorrectionThrottle", meta = (ClampMin = "0.0", UIMin = "0", ClampMax = "1.0", UIMax = "1.0"))
+		float CoalesceWindow;
+
+	FVRCorrectionThrottleSettings() :
+		bCoalesceSmallCorrections(false),
+		SmallCorrectionDistance(10.0f),
+		CoalesceWindow(0.15f)
+	{}
+};
+
+struct VREXPANSIONPLUGIN_API FVRCorrectionThrottle
+{
+	bool bHasDeferredCorrection;
+	float DeferredSince;
+	int32 NumCoalesced;
+
+	// Latched when a forced client update queued the pending adjustment, the force flag itself is cleared before it is sent
+	bool bForcedCorrectionPending;
+
+	FVRCorrectionThrottle() :
+		bHasDeferredCorrection(false),
+		DeferredSince(0.0f),
+		NumCoalesced(0),
+		bForcedCorrectionPending(false)
+	{}
+
+	// Returns true if the pending correction should be sent now, false if it is being held back
+	bool ShouldSendCorrection(const FVRCorrectionThrottleSettings & Settings, float ErrorDistance, bool bForceUpdate, float CurrentTime);
+
+	// The next pending correction goes out no matter its size
+	void MarkForcedCorrection()
+	{
+		bForcedCorrectionPending = true;
+	}
+
+	// The client reported a good move, anything being held back is no longer needed
+	void Reset()
+	{
+		bHasDeferredCorrection = false;
+		DeferredSince = 0.0f;
+		NumCoalesced = 0;
+		bForcedCorrectionPending = false;
+	}
+};
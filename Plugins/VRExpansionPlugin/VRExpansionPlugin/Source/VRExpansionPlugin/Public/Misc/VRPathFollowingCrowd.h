@@ -0,0 +1,117 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "Engine/EngineBaseTypes.h"
+#include "VRPathFollowingCrowd.generated.h"
+
+class UVRPathFollowingComponent;
+class UVRPathFollowingCrowdManager;
+
+// Result of the batched segment reach test
+enum class EVRCrowdReachResult : uint8
+{
+	NotReached,
+	Reached,
+	// Close enough that the agents own reach test has to decide
+	NeedsExactTest
+};
+
+/**
+* Current segment of every moving crowd agent, stored contiguously so that the reach tests and move directions run in one pass.
+* No engine types beyond the math library, it can be filled and evaluated outside of a world.
+*/
+struct VREXPANSIONPLUGIN_API FVRPathFollowingCrowdBatch
+{
+	// Inputs
+	TArray<FVector> FeetLocations;
+	TArray<FVector> SegmentTargets;
+	TArray<FVector> SegmentDirections;
+	// 2D distance past which the segment target is never reached
+	TArray<float> ReachRadii;
+
+	// Outputs of Evaluate
+	TArray<FVector> ToTargets;
+	TArray<FVector> MoveDirections;
+	TArray<EVRCrowdReachResult> ReachResults;
+
+	void Reset()
+	{
+		FeetLocations.Reset();
+		SegmentTargets.Reset();
+		SegmentDirections.Reset();
+		ReachRadii.Reset();
+	}
+
+	int32 Num() const { return FeetLocations.Num(); }
+
+	void Evaluate();
+};
+
+/**
+* Tick function that runs the crowd managers frame
+*/
+USTRUCT()
+struct VREXPANSIONPLUGIN_API FVRPathFollowingCrowdTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	UVRPathFollowingCrowdManager * Target;
+
+	FVRPathFollowingCrowdTickFunction() :
+		Target(nullptr)
+	{}
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FVRPathFollowingCrowdTickFunction> : public TStructOpsTypeTraitsBase2<FVRPathFollowingCrowdTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+* Per world owner of the path following components that have bUseCrowdPathFollowing set.
+* Gathers every moving agents feet location and segment once a frame, evaluates them together and then hands the results back to each agent
+* to finish its segment update and request its move, in place of the agents own tick.
+*/
+UCLASS(Transient)
+class VREXPANSIONPLUGIN_API UVRPathFollowingCrowdManager : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UVRPathFollowingCrowdManager(const FObjectInitializer& ObjectInitializer);
+
+	// Returns the manager for the world, only game worlds get one
+	static UVRPathFollowingCrowdManager * Get(UWorld * World, bool bCreateIfMissing = true);
+
+	void RegisterAgent(UVRPathFollowingComponent * Agent);
+	void UnregisterAgent(UVRPathFollowingComponent * Agent);
+
+	void TickCrowd(float DeltaTime);
+
+	int32 GetNumAgents() const { return Agents.Num(); }
+
+	virtual void BeginDestroy() override;
+
+private:
+
+	UPROPERTY()
+	TArray<UVRPathFollowingComponent *> Agents;
+
+	// Agent of each batch entry, agents can unregister while results are handed out
+	TArray<UVRPathFollowingComponent *> BatchAgents;
+	TArray<UVRPathFollowingComponent *> FallbackAgents;
+	FVRPathFollowingCrowdBatch Batch;
+
+	FVRPathFollowingCrowdTickFunction CrowdTickFunction;
+};
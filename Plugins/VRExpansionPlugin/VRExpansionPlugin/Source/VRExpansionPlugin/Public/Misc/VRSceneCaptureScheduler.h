@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Misc/VRCaptureScheduling.h"
+#include "VRSceneCaptureScheduler.generated.h"
+
+class UVRScheduledSceneCaptureComponent2D;
+class UVRSceneCaptureScheduler;
+
+/**
+* Tick function that runs the capture schedulers frame
+*/
+USTRUCT()
+struct VREXPANSIONPLUGIN_API FVRSceneCaptureSchedulerTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	UVRSceneCaptureScheduler * Target;
+
+	FVRSceneCaptureSchedulerTickFunction() :
+		Target(nullptr)
+	{}
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FVRSceneCaptureSchedulerTickFunction> : public TStructOpsTypeTraitsBase2<FVRSceneCaptureSchedulerTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+* Per world owner of the scheduled scene captures, issues at most vr.CaptureScheduler.MaxCapturesPerFrame captures a frame.
+* Ticks after the camera has been updated so that the view it ranks against, and that captures can read with GetCachedView, is final.
+*/
+UCLASS(Transient)
+class VREXPANSIONPLUGIN_API UVRSceneCaptureScheduler : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UVRSceneCaptureScheduler(const FObjectInitializer& ObjectInitializer);
+
+	// Returns the scheduler for the world, only game worlds get one
+	static UVRSceneCaptureScheduler * Get(UWorld * World, bool bCreateIfMissing = true);
+
+	void RegisterCapture(UVRScheduledSceneCaptureComponent2D * Capture);
+	void UnregisterCapture(UVRScheduledSceneCaptureComponent2D * Capture);
+
+	// Moves the capture to the front of the next schedule
+	void RequestCapture(UVRScheduledSceneCaptureComponent2D * Capture);
+
+	// Negative if the capture hasn't been scheduled yet
+	float GetTimeSinceLastCapture(const UVRScheduledSceneCaptureComponent2D * Capture) const;
+
+	void TickScheduler(float DeltaTime);
+
+	int32 GetNumCaptures() const { return Captures.Num(); }
+
+	// View of the first local player as of this frames schedule, world space
+	const FVRCaptureScheduleView & GetCachedView() const { return CachedView; }
+	const FTransform & GetCachedViewTransform() const { return CachedViewTransform; }
+
+	virtual void BeginDestroy() override;
+
+private:
+
+	void UpdateCachedView();
+
+	// Same order as the schedulers entries
+	UPROPERTY()
+	TArray<UVRScheduledSceneCaptureComponent2D *> Captures;
+
+	FVRCaptureScheduler Scheduler;
+	FVRCaptureScheduleView CachedView;
+	FTransform CachedViewTransform;
+	TArray<int32> SelectedCaptures;
+
+	FVRSceneCaptureSchedulerTickFunction SchedulerTickFunction;
+};
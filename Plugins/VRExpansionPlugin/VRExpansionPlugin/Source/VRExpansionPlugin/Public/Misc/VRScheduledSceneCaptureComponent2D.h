@@ -0,0 +1,53 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SceneCaptureComponent2D.h"
+#include "Misc/VRCaptureScheduling.h"
+#include "VRScheduledSceneCaptureComponent2D.generated.h"
+
+class UPrimitiveComponent;
+class UVRSceneCaptureScheduler;
+
+/**
+* Scene capture that is updated by the worlds UVRSceneCaptureScheduler under a shared per frame budget instead of every frame.
+* Meant for portals, mirrors and scopes, set DisplaySurface to the mesh showing the capture so that it is ranked by what the player sees.
+*/
+UCLASS(Blueprintable, meta = (BlueprintSpawnableComponent), ClassGroup = (VRExpansionPlugin))
+class VREXPANSIONPLUGIN_API UVRScheduledSceneCaptureComponent2D : public USceneCaptureComponent2D
+{
+	GENERATED_BODY()
+
+public:
+	UVRScheduledSceneCaptureComponent2D(const FObjectInitializer& ObjectInitializer);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "CaptureSchedule")
+		FVRCaptureScheduleSettings ScheduleSettings;
+
+	// Surface the capture is displayed on, ranked by its bounds. If not set the capture itself is used with DefaultDisplayRadius.
+	UPROPERTY(BlueprintReadWrite, Category = "CaptureSchedule")
+		UPrimitiveComponent * DisplaySurface;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "CaptureSchedule", meta = (ClampMin = "0.0", UIMin = "0"))
+		float DefaultDisplayRadius;
+
+	// Gets a capture on the next schedule regardless of ranking, for when the contents are known to have changed
+	UFUNCTION(BlueprintCallable, Category = "CaptureSchedule")
+		void RequestCapture();
+
+	// Time since the scheduler last captured this, negative if it hasn't yet
+	UFUNCTION(BlueprintPure, Category = "CaptureSchedule")
+		float GetTimeSinceLastCapture() const;
+
+	virtual void OnRegister() override;
+	virtual void OnUnregister() override;
+
+private:
+	friend class UVRSceneCaptureScheduler;
+
+	// Entry index in the schedulers list, set by the scheduler
+	int32 ScheduleIndex;
+
+	TWeakObjectPtr<UVRSceneCaptureScheduler> Scheduler;
+};
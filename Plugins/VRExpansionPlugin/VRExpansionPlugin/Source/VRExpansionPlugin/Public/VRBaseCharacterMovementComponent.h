@@ -9,14 +9,24 @@
 #include "GameFramework/Character.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Components/SkeletalMeshComponent.h"
+#include "Misc/VRNetCorrectionPolicy.h"
 #include "VRBaseCharacterMovementComponent.generated.h"
 
 /** Delegate for notification when to handle a climbing step up, will override default step up logic if is bound to. */
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FVROnPerformClimbingStepUp, FVector, FinalStepUpLocation);
 
+/** Delegate for notification when a large correction of the local character is being hidden by the comfort settings. */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FVROnComfortCorrection, float, CorrectionDistance);
+
 /** Shared pointer for easy memory management of FSavedMove_Character, for accumulating and replaying network moves. */
 //typedef TSharedPtr<class FSavedMove_Character> FSavedMovePtr;
 
+/**
+* Fills the free saved move pool of a VR characters client prediction data up front (vr.SavedMovePoolPrewarm moves).
+* Only call on fully constructed prediction data, from its constructor AllocateNewMove would not resolve to a derived move type.
+*/
+VREXPANSIONPLUGIN_API void PrewarmVRSavedMovePool(class FNetworkPredictionData_Client_Character & ClientData);
+
 
 //=============================================================================
 /**
@@ -172,17 +182,23 @@ struct TStructOpsTypeTraits< FVRMoveActionContainer > : public TStructOpsTypeTra
 	};
 };
 
+// Number of move actions stored inline, saved moves are copied around every frame and almost never carry more than one
+#define VR_INLINE_MOVE_ACTION_COUNT 2
+
 USTRUCT()
 struct VREXPANSIONPLUGIN_API FVRMoveActionArray
 {
 	GENERATED_USTRUCT_BODY()
 public:
-	UPROPERTY()
-		TArray<FVRMoveActionContainer> MoveActions;
+
+	// Not a UPROPERTY as reflection doesn't support custom allocators, the struct is replicated with its NetSerialize
+	// and the containers hold no object references.
+	TArray<FVRMoveActionContainer, TInlineAllocator<VR_INLINE_MOVE_ACTION_COUNT>> MoveActions;
 
 	void Clear()
 	{
-		MoveActions.Empty();
+		// Keep the storage, the saved move pool re-uses these
+		MoveActions.Reset();
 	}
 	/** Network serialization */
 	// Doing a custom NetSerialize here because this is sent via RPCs and should change on every update
@@ -223,6 +239,8 @@ public:
 				else
 					MoveActionCount = 1;
 
+				MoveActions.Reserve(MoveActions.Num() + MoveActionCount);
+
 				for (int i = 0; i < MoveActionCount; i++)
 				{
 					FVRMoveActionContainer MoveAction;
@@ -245,6 +263,105 @@ struct TStructOpsTypeTraits< FVRMoveActionArray > : public TStructOpsTypeTraitsB
 };
 
 
+#define VR_CLIMBING_GRIP_COUNT 2
+
+// A single hand anchored to a handhold for native climbing
+USTRUCT()
+struct VREXPANSIONPLUGIN_API FVRClimbingGripRep
+{
+	GENERATED_USTRUCT_BODY()
+public:
+
+	// Replicated as a net object reference, StartClimbingGrip only accepts net addressable handholds
+	// Weak as copies of this live on in saved moves where the GC can't see them
+	UPROPERTY(Transient)
+		TWeakObjectPtr<USceneComponent> Handhold;
+
+	// Anchor in the handholds component space
+	UPROPERTY(Transient)
+		FVector LocalAnchor;
+
+	// Hand location relative to the updated component, in world space orientation
+	UPROPERTY(Transient)
+		FVector HandOffset;
+
+	FVRClimbingGripRep()
+	{
+		Clear();
+	}
+
+	FORCEINLINE bool IsActive() const
+	{
+		return Handhold.IsValid();
+	}
+
+	void Clear()
+	{
+		Handhold.Reset();
+		LocalAnchor = FVector::ZeroVector;
+		HandOffset = FVector::ZeroVector;
+	}
+};
+
+USTRUCT()
+struct VREXPANSIONPLUGIN_API FVRClimbingMoveRep
+{
+	GENERATED_USTRUCT_BODY()
+public:
+
+	UPROPERTY(Transient)
+		FVRClimbingGripRep Grips[VR_CLIMBING_GRIP_COUNT];
+
+	bool HasAnyGrips() const
+	{
+		for (const FVRClimbingGripRep & Grip : Grips)
+		{
+			if (Grip.IsActive())
+				return true;
+		}
+
+		return false;
+	}
+
+	void Clear()
+	{
+		for (FVRClimbingGripRep & Grip : Grips)
+			Grip.Clear();
+	}
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+	{
+		for (FVRClimbingGripRep & Grip : Grips)
+		{
+			bool bIsActive = Grip.IsActive();
+			Ar.SerializeBits(&bIsActive, 1);
+
+			if (bIsActive)
+			{
+				UObject * HandholdObject = Grip.Handhold.Get();
+				Ar << HandholdObject;
+
+				if (Ar.IsLoading())
+					Grip.Handhold = Cast<USceneComponent>(HandholdObject);
+
+				bOutSuccess &= SerializePackedVector<100, 30>(Grip.LocalAnchor, Ar);
+				bOutSuccess &= SerializePackedVector<100, 22>(Grip.HandOffset, Ar);
+			}
+		}
+
+		return bOutSuccess;
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits< FVRClimbingMoveRep > : public TStructOpsTypeTraitsBase2<FVRClimbingMoveRep>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
 USTRUCT()
 struct VREXPANSIONPLUGIN_API FVRConditionalMoveRep
 {
@@ -258,6 +375,8 @@ public:
 	UPROPERTY(Transient)
 		FVRMoveActionArray MoveActionArray;
 		//FVRMoveActionContainer MoveAction;
+	UPROPERTY(Transient)
+		FVRClimbingMoveRep ClimbingGrips;
 
 	FVRConditionalMoveRep()
 	{
@@ -274,14 +393,16 @@ public:
 		bool bHasVRinput = !CustomVRInputVector.IsZero();
 		bool bHasRequestedVelocity = !RequestedVelocity.IsZero();
 		bool bHasMoveAction = MoveActionArray.MoveActions.Num() > 0;//MoveAction.MoveAction != EVRMoveAction::VRMOVEACTION_None;
+		bool bHasClimbingGrips = ClimbingGrips.HasAnyGrips();
 
-		bool bHasAnyProperties = bHasVRinput || bHasRequestedVelocity || bHasMoveAction;
+		bool bHasAnyProperties = bHasVRinput || bHasRequestedVelocity || bHasMoveAction || bHasClimbingGrips;
 		Ar.SerializeBits(&bHasAnyProperties, 1);
 
 		if (bHasAnyProperties)
 		{
 			Ar.SerializeBits(&bHasVRinput, 1);
 			Ar.SerializeBits(&bHasRequestedVelocity, 1);
+			Ar.SerializeBits(&bHasClimbingGrips, 1);
 			//Ar.SerializeBits(&bHasMoveAction, 1);
 
 			if (bHasVRinput)
@@ -292,6 +413,9 @@ public:
 
 			//if (bHasMoveAction)
 			MoveActionArray.NetSerialize(Ar, Map, bOutSuccess);
+
+			if (bHasClimbingGrips)
+				ClimbingGrips.NetSerialize(Ar, Map, bOutSuccess);
 		}
 
 		return bOutSuccess;
@@ -503,6 +627,10 @@ public:
 		if (!ConditionalValues.CustomVRInputVector.IsZero() || !nMove->ConditionalValues.CustomVRInputVector.IsZero())
 			return false;
 
+		// Each move carries its own hand offsets
+		if (ConditionalValues.ClimbingGrips.HasAnyGrips() || nMove->ConditionalValues.ClimbingGrips.HasAnyGrips())
+			return false;
+
 		if (!ConditionalValues.RequestedVelocity.IsZero() || !nMove->ConditionalValues.RequestedVelocity.IsZero())
 			return false;
 
@@ -526,6 +654,9 @@ public:
 		if (!ConditionalValues.CustomVRInputVector.IsZero())	
 			return true;
 
+		if (ConditionalValues.ClimbingGrips.HasAnyGrips())
+			return true;
+
 		if (!ConditionalValues.RequestedVelocity.IsZero())
 			return true;
 
@@ -718,6 +849,23 @@ public:
 	/** Update mesh location based on interpolated values. */
 	void SmoothClientPosition_UpdateVRVisuals();
 
+	// Scales smoothing of simulated proxies by error size and recent correction history, only used with Linear or Exponential smoothing
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRMovement|Smoothing")
+		FVRAdaptiveSmoothingSettings AdaptiveSmoothingSettings;
+
+	// Hides large corrections of the locally controlled character behind a blink
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRMovement|Smoothing")
+		FVRComfortCorrectionSettings ComfortCorrectionSettings;
+
+	// Called on the owning client when a correction is large enough to trigger the comfort settings
+	UPROPERTY(BlueprintAssignable, Category = "VRMovement|Smoothing")
+		FVROnComfortCorrection OnComfortCorrection;
+
+	FVRCorrectionHistory ProxyCorrectionHistory;
+
+	// Set by the adaptive smoothing on each correction, 0 is unlimited
+	float AdaptiveMaxCorrectionSpeed;
+
 	// Added in 4.16
 	///* Allow custom handling when character hits a wall while swimming. */
 	//virtual void HandleSwimmingWallHit(const FHitResult& Hit, float DeltaTime);
@@ -749,6 +897,10 @@ public:
 	// Need to use actual capsule location for step up
 	virtual bool VRClimbStepUp(const FVector& GravDir, const FVector& Delta, const FHitResult &InHit, FStepDownResult* OutStepDownResult = nullptr);
 
+	// Tries to climb up and over the ledge that a climbing move ran into, returns true if the capsule ended up on top of it.
+	// bOutHandledExternally is set when OnPerformClimbingStepUp is bound, the step up is then reverted and left to the event.
+	virtual bool SolveClimbingLedge(const FVector& Adjusted, const FHitResult& Hit, FStepDownResult& OutStepDownResult, float& OutStepUpHeight, bool& bOutHandledExternally);
+
 	// Height to auto step up
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRMovement|Climbing")
 		float VRClimbingStepHeight;
@@ -796,6 +948,45 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRMovement|Climbing")
 		EVRConjoinedMovementModes DefaultPostClimbMovement;
 
+	// Anchors a hand to a handhold for native climbing, while any hand is anchored the climbing delta is solved from the hands
+	// instead of UpdateClimbingMovement. Does not change the movement mode, use SetClimbingMode as before.
+	// Only valid on the locally controlled character, returns false if the handhold can't be climbed or both hands are in use.
+	UFUNCTION(BlueprintCallable, Category = "VRMovement|Climbing")
+		bool StartClimbingGrip(USceneComponent* Hand, USceneComponent* Handhold, FVector WorldGripLocation);
+
+	UFUNCTION(BlueprintCallable, Category = "VRMovement|Climbing")
+		void EndClimbingGrip(USceneComponent* Hand);
+
+	UFUNCTION(BlueprintCallable, Category = "VRMovement|Climbing")
+		void EndAllClimbingGrips();
+
+	UFUNCTION(BlueprintPure, Category = "VRMovement|Climbing")
+		bool HasClimbingGrips() const;
+
+	// Grips with the hand further than this from its anchor are ignored by the native climbing (handhold moved away, lost tracking)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRMovement|Climbing", meta = (ClampMin = "0.0", UIMin = "0"))
+		float VRClimbingMaxGripDistance;
+
+	// Grips of the move being simulated, sent with the saved moves and restored from them on replay
+	UPROPERTY(Transient)
+		FVRClimbingMoveRep ClimbingGrips;
+
+	// Grips as the local player currently holds them, copied into ClimbingGrips at the start of each new move
+	UPROPERTY(Transient)
+		FVRClimbingMoveRep LocalClimbingGrips;
+
+	// Hands that the grip offsets are read from, matches the slots of LocalClimbingGrips
+	TWeakObjectPtr<USceneComponent> ClimbingGripHands[VR_CLIMBING_GRIP_COUNT];
+
+	// Drops grips whose hand or handhold went away and refreshes the hand offsets of the rest
+	void UpdateClimbingGripOffsets();
+
+	// Average movement that puts the anchored hands back on their handholds, returns false if no grip applies
+	bool GetNativeClimbingDelta(FVector & OutDelta) const;
+
+	// If the last climbing update was solved from the grips, only then does the saved move record them
+	bool bAppliedNativeClimbingDelta;
+
 	// Overloading this to handle an edge case
 	virtual void ApplyNetworkMovementMode(const uint8 ReceivedMode) override;
 
@@ -875,5 +1066,16 @@ public:
 
 		Super::ClientVeryShortAdjustPosition_Implementation(TimeStamp, NewLoc, NewBase, NewBaseBoneName, bHasBase, bBaseRelativePosition, ServerMovementMode);
 	}
+
+protected:
+
+	// Prewarms the free move pool the first time it sees a prediction data object, call before saving moves.
+	// Goes through whatever GetPredictionData_Client returns so that projects with their own saved move type get their own moves.
+	void PrewarmSavedMovePoolOnce(FNetworkPredictionData_Client_Character & ClientData);
+
+private:
+
+	// Prediction data the pool was last prewarmed for, only compared against
+	const FNetworkPredictionData_Client_Character * PrewarmedClientData;
 };
 
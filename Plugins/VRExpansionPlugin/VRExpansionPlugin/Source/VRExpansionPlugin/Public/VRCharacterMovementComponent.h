@@ -126,6 +126,16 @@ public:
 	///////////////////////////
 
 	virtual void SendClientAdjustment() override;
+
+	// Server side coalescing of small client corrections
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRMovement|Smoothing")
+		FVRCorrectionThrottleSettings CorrectionThrottleSettings;
+
+	FVRCorrectionThrottle CorrectionThrottle;
+
+	// Positional error of the last failed client check, BIG_NUMBER when the check failed on something other than position
+	float ServerLastClientErrorDistance;
+
 	/**
 	* Have the server check if the client is outside an error tolerance, and queue a client adjustment if so.
 	* If either GetPredictionData_Server_Character()->bForceClientUpdate or ServerCheckClientError() are true, the client adjustment will be sent.
@@ -15,6 +15,8 @@
 #include "VRBPDatatypes.h"
 #include "GameplayTagContainer.h"
 #include "XRMotionControllerBase.h" // for GetHandEnumForSourceName()
+#include "Grippables/GrippablePhysicsReplication.h"
+#include "Misc/VRMinimumAreaRectangle.h"
 
 #include "VRExpansionFunctionLibrary.generated.h"
 
@@ -136,7 +138,7 @@ public:
 	/**
 	* Finds the minimum area rectangle that encloses all of the points in InVerts
 	* Engine default version is server only for some reason
-	* Uses algorithm found in http://www.geometrictools.com/Documentation/MinimumAreaRectangle.pdf
+	* Uses algorithm found in http://www.geometrictools.com/Documentation/MinimumAreaRectangle.pdf (rotating calipers)
 	*
 	* @param		InVerts	- Points to enclose in the rectangle
 	* @outparam	OutRectCenter - Center of the enclosing rectangle
@@ -146,6 +148,24 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "VRExpansionFunctions", meta = (WorldContext = "WorldContextObject", CallableWithoutWorldContext))
 	static void NonAuthorityMinimumAreaRectangle(UObject* WorldContextObject, const TArray<FVector>& InVerts, const FVector& SampleSurfaceNormal, FVector& OutRectCenter, FRotator& OutRectRotation, float& OutSideLengthX, float& OutSideLengthY, bool bDebugDraw = false);
 
+	/**
+	* Same fit as NonAuthorityMinimumAreaRectangle but returns the true center of the rectangle and its corners
+	* Returns false if there were no points to fit
+	*/
+	UFUNCTION(BlueprintCallable, Category = "VRExpansionFunctions")
+	static bool NonAuthorityMinimumAreaRectangleCorners(const TArray<FVector>& InVerts, const FVector& SampleSurfaceNormal, FVRMinimumAreaRectangle& OutRect);
+
+	/**
+	* Fits the rectangle on a known plane instead of estimating it from the points
+	* @param	PlaneRotation - The points are projected onto the XY plane of this rotation
+	*/
+	UFUNCTION(BlueprintCallable, Category = "VRExpansionFunctions")
+	static bool NonAuthorityMinimumAreaRectangleWithBasis(const TArray<FVector>& InVerts, FRotator PlaneRotation, FVRMinimumAreaRectangle& OutRect);
+
+	// Fits every point set in one call, OutRects lines up with PointSets
+	UFUNCTION(BlueprintCallable, Category = "VRExpansionFunctions")
+	static void NonAuthorityMinimumAreaRectangleBatch(const TArray<FVRMinimumAreaRectanglePoints>& PointSets, const FVector& SampleSurfaceNormal, TArray<FVRMinimumAreaRectangle>& OutRects);
+
 	// A Rolling average low pass filter
 	UFUNCTION(BlueprintPure, Category = "VRExpansionFunctions", meta = (bIgnoreSelf = "true", DisplayName = "LowPassFilter_RollingAverage"))
 	static void LowPassFilter_RollingAverage(FVector lastAverage, FVector newSample, FVector & newAverage, int32 numSamples = 10);
@@ -166,6 +186,10 @@ public:
 	UFUNCTION(BlueprintPure, Category = "VRGrip", meta = (bIgnoreSelf = "true", DisplayName = "GetGripSlotInRangeByTypeName_Component"))
 	static void GetGripSlotInRangeByTypeName_Component(FName SlotType, UPrimitiveComponent * Component, FVector WorldLocation, float MaxRange, bool & bHadSlotInRange, FTransform & SlotWorldTransform);
 
+	// Gets the servers last error correction stats for a client authed simulating component, false if it hasn't been corrected
+	UFUNCTION(BlueprintCallable, Category = "VRReplication", meta = (bIgnoreSelf = "true"))
+	static bool GetPhysicsReplicationErrorStats(UPrimitiveComponent * Component, FVRPhysicsReplicationErrorStats & ErrorStats);
+
 	/* Returns true if the values are equal (A == B) */
 	UFUNCTION(BlueprintPure, meta = (DisplayName = "Equal VR Grip", CompactNodeTitle = "==", Keywords = "== equal"), Category = "VRExpansionFunctions")
 	static bool EqualEqual_FBPActorGripInformation(const FBPActorGripInformation &A, const FBPActorGripInformation &B);
@@ -100,6 +100,39 @@ public:
 	}
 };
 
+// Runtime registry entry for a controller profile, built from UVRGlobalSettings::ControllerProfiles
+struct VREXPANSIONPLUGIN_API FVRControllerProfileRecord
+{
+	// Index of the profile in ControllerProfiles
+	int32 ProfileIndex;
+
+	// Left and right hand offsets with bUseSeperateHandOffsetTransforms already resolved, and their inverses
+	FTransform HandTransforms[2];
+	FTransform InverseHandTransforms[2];
+
+	FVRControllerProfileRecord() :
+		ProfileIndex(INDEX_NONE)
+	{
+		HandTransforms[0] = HandTransforms[1] = FTransform::Identity;
+		InverseHandTransforms[0] = InverseHandTransforms[1] = FTransform::Identity;
+	}
+
+	FORCEINLINE const FTransform & GetTransform(bool bIsRightHand) const
+	{
+		return HandTransforms[bIsRightHand ? 1 : 0];
+	}
+
+	FORCEINLINE const FTransform & GetInverseTransform(bool bIsRightHand) const
+	{
+		return InverseHandTransforms[bIsRightHand ? 1 : 0];
+	}
+
+	FORCEINLINE FTransform Apply(const FTransform & SocketTransform, bool bIsRightHand) const
+	{
+		return SocketTransform * GetTransform(bIsRightHand);
+	}
+};
+
 UCLASS(config = Engine, defaultconfig)
 class VREXPANSIONPLUGIN_API UVRGlobalSettings : public UObject
 {
@@ -161,6 +194,21 @@ public:
 	bool bUseSeperateHandTransforms;
 	FTransform CurrentControllerProfileTransformRight;
 
+	// Hashed lookup of a profile by name, first match wins like the array search did. Null if there isn't one.
+	// Records are only valid until the next change to the profiles, re-resolve when the generation changes.
+	const FVRControllerProfileRecord * FindControllerProfileRecord(FName ControllerProfileName) const;
+
+	// Changes whenever the profiles or the current profile change, cache it with anything resolved from a profile and compare to revalidate
+	uint32 GetControllerProfileGeneration() const { return ControllerProfileGeneration; }
+
+	// Call after altering ControllerProfiles directly, the registry is rebuilt on the next lookup
+	void MarkControllerProfilesDirty();
+
+	virtual void PostReloadConfig(UProperty* PropertyThatWasLoaded) override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
 	// Adjust the transform of a socket for a particular controller model, if a name is not sent in, it will use the currently loaded one
 	// If there is no currently loaded one, it will return the input transform as is.
 	// If bIsRightHand and the target profile uses seperate hand transforms it will use the right hand transform
@@ -182,14 +230,9 @@ public:
 		}
 
 		// Had an override, find it if possible and use its transform
-		const FBPVRControllerProfile * FoundProfile = VRSettings.ControllerProfiles.FindByPredicate([OptionalControllerProfileName](const FBPVRControllerProfile & ArrayItem)
+		if (const FVRControllerProfileRecord * FoundProfile = VRSettings.FindControllerProfileRecord(OptionalControllerProfileName))
 		{
-			return ArrayItem.ControllerName == OptionalControllerProfileName;
-		});
-
-		if (FoundProfile)
-		{
-			return SocketTransform * (((bIsRightHand && VRSettings.bUseSeperateHandTransforms) ? FoundProfile->SocketOffsetTransformRightHand : FoundProfile->SocketOffsetTransform));
+			return FoundProfile->Apply(SocketTransform, bIsRightHand);
 		}
 
 		// Couldn't find it, return base transform
@@ -232,6 +275,8 @@ public:
 			}
 		}
 
+		VRSettings.MarkControllerProfilesDirty();
+
 		if(bSaveOutToConfig)
 			SaveControllerProfiles();
 	}
@@ -243,6 +288,7 @@ public:
 		UVRGlobalSettings& VRSettings = *GetMutableDefault<UVRGlobalSettings>();
 
 		VRSettings.ControllerProfiles.Add(NewProfile);
+		VRSettings.MarkControllerProfilesDirty();
 
 		if (bSaveOutToConfig)
 			SaveControllerProfiles();
@@ -262,6 +308,8 @@ public:
 			}
 		}
 
+		VRSettings.MarkControllerProfilesDirty();
+
 		if (bSaveOutToConfig)
 			SaveControllerProfiles();
 	}
@@ -293,17 +341,13 @@ public:
 	{
 		const UVRGlobalSettings& VRSettings = *GetDefault<UVRGlobalSettings>();
 
-		FName ControllerProfileName = VRSettings.CurrentControllerProfileInUse;
-		const FBPVRControllerProfile * FoundProfile = VRSettings.ControllerProfiles.FindByPredicate([ControllerProfileName](const FBPVRControllerProfile & ArrayItem)
-		{
-			return ArrayItem.ControllerName == ControllerProfileName;
-		});
+		const FVRControllerProfileRecord * FoundProfile = VRSettings.FindControllerProfileRecord(VRSettings.CurrentControllerProfileInUse);
 
 		bHadLoadedProfile = FoundProfile != nullptr;
 
 		if (bHadLoadedProfile)
 		{
-			return *FoundProfile;
+			return VRSettings.ControllerProfiles[FoundProfile->ProfileIndex];
 		}
 		else
 			return FBPVRControllerProfile();
@@ -315,14 +359,9 @@ public:
 	{
 		const UVRGlobalSettings& VRSettings = *GetDefault<UVRGlobalSettings>();
 
-		const FBPVRControllerProfile * FoundProfile = VRSettings.ControllerProfiles.FindByPredicate([ControllerProfileName](const FBPVRControllerProfile & ArrayItem)
-		{
-			return ArrayItem.ControllerName == ControllerProfileName;
-		});
-
-		if (FoundProfile)
+		if (const FVRControllerProfileRecord * FoundProfile = VRSettings.FindControllerProfileRecord(ControllerProfileName))
 		{
-			OutProfile = *FoundProfile;
+			OutProfile = VRSettings.ControllerProfiles[FoundProfile->ProfileIndex];
 			return true;
 		}
 
@@ -341,14 +380,9 @@ public:
 	{
 		const UVRGlobalSettings& VRSettings = *GetDefault<UVRGlobalSettings>();
 
-		const FBPVRControllerProfile * FoundProfile = VRSettings.ControllerProfiles.FindByPredicate([ControllerProfileName](const FBPVRControllerProfile & ArrayItem)
-		{
-			return ArrayItem.ControllerName == ControllerProfileName;
-		});
-
-		if (FoundProfile)
+		if (const FVRControllerProfileRecord * FoundProfile = VRSettings.FindControllerProfileRecord(ControllerProfileName))
 		{
-			return LoadControllerProfile(*FoundProfile, bSetAsCurrentProfile);
+			return LoadControllerProfile(VRSettings.ControllerProfiles[FoundProfile->ProfileIndex], bSetAsCurrentProfile);
 		}
 
 		return false;
@@ -452,6 +486,7 @@ public:
 				VRSettings->bUseSeperateHandTransforms = ControllerProfile.bUseSeperateHandOffsetTransforms;
 				VRSettings->CurrentControllerProfileTransformRight = ControllerProfile.SocketOffsetTransformRightHand;
 				ensure(!VRSettings->CurrentControllerProfileTransformRight.ContainsNaN());
+				++VRSettings->ControllerProfileGeneration;
 				VRSettings->OnControllerProfileChangedEvent.Broadcast();
 			}
 			else
@@ -476,5 +511,15 @@ public:
 		}*/
 #endif
 		Super::PostInitProperties();
+		MarkControllerProfilesDirty();
 	}
+
+private:
+
+	void RebuildControllerProfileRegistry() const;
+
+	// Built lazily from ControllerProfiles, lookups happen through the const default object
+	mutable TMap<FName, FVRControllerProfileRecord> ControllerProfileRegistry;
+	mutable bool bControllerProfileRegistryDirty;
+	uint32 ControllerProfileGeneration;
 };
@@ -8,6 +8,7 @@
 #include "Navigation/PathFollowingComponent.h"
 #include "AbstractNavData.h"
 #include "Runtime/Launch/Resources/Version.h"
+#include "Misc/VRPathFollowingCrowd.h"
 #include "VRPathFollowingComponent.generated.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(LogPathFollowingVR, Warning, All);
@@ -18,9 +19,31 @@ class VREXPANSIONPLUGIN_API UVRPathFollowingComponent : public UPathFollowingCom
 	GENERATED_BODY()
 
 public:
+	UVRPathFollowingComponent(const FObjectInitializer& ObjectInitializer);
+
 	UPROPERTY(transient)
 	UVRBaseCharacterMovementComponent* VRMovementComp;
 
+	// Let the worlds UVRPathFollowingCrowdManager update this agent together with the rest of the crowd instead of ticking on its own
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "VRPathFollowing")
+	bool bUseCrowdPathFollowing;
+
+	UFUNCTION(BlueprintCallable, Category = "VRPathFollowing")
+	void SetUseCrowdPathFollowing(bool bUseCrowd);
+
+	virtual void OnRegister() override;
+	virtual void OnUnregister() override;
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction) override;
+
+	// Feet location and current segment for the crowd managers batch, false if the agent isn't moving along a path
+	bool GetCrowdSegment(FVector& OutFeetLocation, FVector& OutTarget, FVector& OutDirection, float& OutReachRadius) const;
+
+	// Finishes this frames update from the crowd managers results for the values GetCrowdSegment returned
+	void UpdateFromCrowd(float DeltaTime, const FVector& FeetLocation, const FVector& SegmentTarget, EVRCrowdReachResult ReachResult, const FVector& ToTarget, const FVector& MoveDirection);
+
+	// The regular tick update, run by the crowd manager when vr.PathFollowingCrowd.Batched is off
+	void UpdatePerAgent(float DeltaTime);
+
 	// Add link to VRMovementComp
 	void SetMovementComponent(UNavMovementComponent* MoveComp) override;
 
@@ -69,4 +92,18 @@ public:
 	*  @param bUseNavAgentGoalLocation - true: if the goal is a nav agent, we will use their nav agent location rather than their actual location
 	*/
 	bool HasReached(const AActor& TestGoal, EPathFollowingReachMode ReachMode, float AcceptanceRadius = UPathFollowingComponent::DefaultAcceptanceRadius, bool bUseNavAgentGoalLocation = true) const;
+
+protected:
+
+	// Shared by the per agent and crowd updates, ReachResult of NeedsExactTest runs HasReachedCurrentTarget
+	void UpdatePathSegment_Internal(const FVector& CurrentLocation, EVRCrowdReachResult ReachResult);
+	void FollowPathSegment_Internal(float DeltaTime, const FVector& CurrentLocation, const FVector& ToTarget, const FVector& MoveDirection);
+
+private:
+	friend class UVRPathFollowingCrowdManager;
+
+	// Index in the crowd managers agent list, set by the manager
+	int32 CrowdIndex;
+
+	TWeakObjectPtr<UVRPathFollowingCrowdManager> CrowdManager;
 };
\ No newline at end of file
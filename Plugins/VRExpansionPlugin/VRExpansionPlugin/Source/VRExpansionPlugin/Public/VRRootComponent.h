@@ -150,6 +150,15 @@ public:
 	FRotator curCameraRot;
 	FRotator StoredCameraRotOffset;
 
+	// The curCameraRot that StoredCameraRotOffset was generated from, move replay overwrites curCameraRot after the fact
+	FRotator StoredCameraRotSource;
+
+	// Pure yaw of curCameraRot, only re-calculated if curCameraRot was changed since it was last stored
+	FORCEINLINE FRotator GetCurrentCameraPureYaw() const
+	{
+		return curCameraRot == StoredCameraRotSource ? StoredCameraRotOffset : UVRExpansionFunctionLibrary::GetHMDPureYaw_I(curCameraRot);
+	}
+
 	FVector lastCameraLoc;
 	FRotator lastCameraRot;
 
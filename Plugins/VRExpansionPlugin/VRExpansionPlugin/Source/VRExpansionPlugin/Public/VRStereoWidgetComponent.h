@@ -7,9 +7,12 @@
 #include "VRGripInterface.h"
 #include "Components/WidgetComponent.h"
 #include "Components/StereoLayerComponent.h"
+#include "IStereoLayers.h"
 
 #include "VRStereoWidgetComponent.generated.h"
 
+DECLARE_STATS_GROUP(TEXT("VRStereoWidget"), STATGROUP_VRStereoWidget, STATCAT_Advanced);
+
 
 /**
 * A widget component that displays the widget in a stereo layer instead of in worldspace.
@@ -37,6 +40,7 @@ public:
 
 	virtual void UpdateRenderTarget(FIntPoint DesiredRenderTargetSize) override;
 	virtual FPrimitiveSceneProxy* CreateSceneProxy() override;
+	virtual void SetWidget(UUserWidget* InWidget) override;
 
 	/**
 	* Change the quad size. This is the unscaled height and width, before component scale is applied.
@@ -57,6 +61,37 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "StereoLayer")
 		bool bIsSleeping;
 
+	// If true the widget is only redrawn when invalidated instead of on the RedrawTime cadence, and the layer texture is only re-sent after a redraw.
+	// Draw size / widget changes, playing animations, hover, focus and the component becoming visible invalidate automatically.
+	// Widgets with bindings that change on their own need InvalidateWidget called on them or a StaticRedrawInterval.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "StereoLayer")
+		bool bRedrawOnlyWhenInvalidated;
+
+	// When only redrawing when invalidated, still redraw at least this often (seconds), 0 is never
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "StereoLayer", meta = (EditCondition = "bRedrawOnlyWhenInvalidated", ClampMin = "0.0", UIMin = "0.0"))
+		float StaticRedrawInterval;
+
+	// If true the render target comes from a per world pool shared with every other stereo widget of the same size
+	// and is handed back to it while the component is hidden. Off by default, each widget owns its own render target.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "StereoLayer")
+		bool bUseSharedRenderTargetPool;
+
+	// Redraws the widget on the next tick when only redrawing when invalidated
+	UFUNCTION(BlueprintCallable, Category = "Components|Stereo Layer")
+		void InvalidateWidget();
+
+	// Number of times the widget was drawn into its render target since the last reset
+	UFUNCTION(BlueprintCallable, Category = "Components|Stereo Layer")
+		int32 GetRedrawCount() const { return RedrawCount; }
+
+	// Number of frames the layer texture was sent to the runtime since the last reset, continuous update layers count every frame
+	UFUNCTION(BlueprintCallable, Category = "Components|Stereo Layer")
+		int32 GetTextureUploadCount() const { return TextureUploadCount; }
+
+	// Zeroes the redraw and upload counts
+	UFUNCTION(BlueprintCallable, Category = "Components|Stereo Layer")
+		void ResetRenderCounters();
+
 	/**
 	* Change the layer's render priority, higher priorities render on top of lower priorities
 	* @param	InPriority: Priority value
@@ -126,6 +161,17 @@ public:
 
 	bool bShouldCreateProxy;
 
+protected:
+
+	// Runs the invalidation checks and requests a redraw if needed, returns true if it requested one
+	bool UpdateRedrawRequest();
+
+	// Creates the layer or updates its description if it changed
+	void PushLayerDesc(IStereoLayers * StereoLayers, const IStereoLayers::FLayerDesc & LayerDesc);
+
+	// Marks the layer texture for update after a redraw
+	void UpdateLayerTexture(IStereoLayers * StereoLayers);
+
 private:
 	/** Dirty state determines whether the stereo layer needs updating **/
 	bool bIsDirty;
@@ -143,4 +189,31 @@ private:
 	/** Last frames visiblity state **/
 	bool bLastVisible;
 
+	/** Set by InvalidateWidget and the automatic triggers, cleared by the next draw **/
+	bool bWidgetInvalidated;
+
+	/** Whether we set bManuallyRedraw ourselves for bRedrawOnlyWhenInvalidated **/
+	bool bForcedManualRedraw;
+
+	/** Whether RenderTarget belongs to the shared pool **/
+	bool bRenderTargetIsPooled;
+
+	double LastInvalidatedDrawTime;
+	FIntPoint LastDrawnSize;
+	bool bWasHoveredOrFocused;
+
+	/** Visibility as of the last UpdateRedrawRequest, becoming visible invalidates **/
+	bool bWasVisibleForRedraw;
+
+	int32 RedrawCount;
+	int32 TextureUploadCount;
+
+	/** Last description sent to the stereo layer, identical ones are skipped **/
+	IStereoLayers::FLayerDesc LastLayerDesc;
+
+	bool ShouldRedrawForInvalidation();
+	void ReleasePooledRenderTarget();
+	void DestroyStereoLayer();
+	static bool LayerDescsMatch(const IStereoLayers::FLayerDesc & A, const IStereoLayers::FLayerDesc & B);
+
 };
\ No newline at end of file
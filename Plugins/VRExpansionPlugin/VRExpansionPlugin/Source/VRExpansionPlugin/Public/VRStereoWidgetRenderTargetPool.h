@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "VRStereoWidgetRenderTargetPool.generated.h"
+
+class UTextureRenderTarget2D;
+
+/**
+* Free render targets of a single size
+*/
+USTRUCT()
+struct VREXPANSIONPLUGIN_API FVRStereoWidgetRenderTargetBucket
+{
+	GENERATED_BODY()
+
+	FIntPoint Size;
+
+	UPROPERTY()
+	TArray<UTextureRenderTarget2D *> FreeTargets;
+
+	FVRStereoWidgetRenderTargetBucket() :
+		Size(FIntPoint::ZeroValue)
+	{}
+};
+
+/**
+* Per world pool of widget render targets, stereo widgets take one when they draw and hand it back when they are hidden.
+* Targets are bucketed by their exact size as the widget renders to, and the layer samples, the whole texture.
+*/
+UCLASS(Transient)
+class VREXPANSIONPLUGIN_API UVRStereoWidgetRenderTargetPool : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	// Returns the pool for the world, only game worlds get one
+	static UVRStereoWidgetRenderTargetPool * Get(UWorld * World, bool bCreateIfMissing = true);
+
+	// Returns a free target of the given size, creating one if the bucket is empty
+	UTextureRenderTarget2D * Acquire(FIntPoint Size);
+
+	// Hands the target back, it is left for garbage collection if the bucket is already full
+	void Release(UTextureRenderTarget2D * RenderTarget);
+
+	// Pulls the target back out of the free list if it is in it, for targets carried over by component instance data
+	void Claim(UTextureRenderTarget2D * RenderTarget);
+
+	int32 GetNumFreeTargets() const;
+
+private:
+
+	UPROPERTY()
+	TArray<FVRStereoWidgetRenderTargetBucket> Buckets;
+};